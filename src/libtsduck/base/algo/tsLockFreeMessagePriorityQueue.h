@@ -0,0 +1,86 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Template lock-free message queue for inter-thread communication with priority
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsLockFreeMessageQueue.h"
+
+namespace ts {
+    //!
+    //! Template lock-free message queue for inter-thread communication with priority.
+    //! @ingroup thread
+    //!
+    //! This class has the same interface and priority rules as ts::MessagePriorityQueue,
+    //! with the multi-producer single-consumer constraints of ts::LockFreeMessageQueue.
+    //!
+    //! The messages are sorted by the consumer thread, when they are extracted from
+    //! the circular buffer. Up to @a maxMessages messages are sorted at a time. Therefore,
+    //! the total number of messages in the queue may temporarily reach twice @a maxMessages.
+    //!
+    //! @tparam MSG The type of the messages to exchange.
+    //! @tparam MUTEX The type of mutex for synchronization of message pointers (ts::Mutex by default).
+    //! @tparam COMPARE A function object to sort @a MSG instances. By default,
+    //! the '<' operator on @a MSG is used.
+    //!
+    template <typename MSG, class MUTEX = Mutex, class COMPARE = std::less<MSG>>
+    class LockFreeMessagePriorityQueue: public LockFreeMessageQueue<MSG, MUTEX>
+    {
+        TS_NOCOPY(LockFreeMessagePriorityQueue);
+    public:
+        //!
+        //! Constructor.
+        //! @param [in] maxMessages Maximum number of messages in the circular buffer.
+        //! If @a maxMessages is 0, DEFAULT_MAX_MESSAGES is used.
+        //!
+        LockFreeMessagePriorityQueue(size_t maxMessages = 0);
+
+    protected:
+        //!
+        //! Explicit reference to superclass.
+        //!
+        typedef LockFreeMessageQueue<MSG, MUTEX> SuperClass;
+
+        //!
+        //! Get the next message in the context of the consumer thread.
+        //! All available messages are moved from the circular buffer to the sorted list of pending messages.
+        //! @param [out] msg The next message.
+        //! @param [in] remove If true, the message is removed from the queue.
+        //! @param [in,out] pending List of messages which were already extracted from the
+        //! circular buffer but not yet dequeued.
+        //! @return True if a message was found, false if the queue is empty.
+        //!
+        virtual bool nextMessage(typename SuperClass::MessagePtr& msg, bool remove, typename SuperClass::MessageList& pending) override;
+    };
+}
+
+#include "tsLockFreeMessagePriorityQueueTemplate.h"
@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX, class COMPARE>
+ts::LockFreeMessagePriorityQueue<MSG, MUTEX, COMPARE>::LockFreeMessagePriorityQueue(size_t maxMessages) :
+    SuperClass(maxMessages)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next message in the context of the consumer thread.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX, class COMPARE>
+bool ts::LockFreeMessagePriorityQueue<MSG, MUTEX, COMPARE>::nextMessage(typename SuperClass::MessagePtr& msg, bool remove, typename SuperClass::MessageList& pending)
+{
+    // Move all available messages from the circular buffer into the sorted list.
+    // Use the same placement as MessagePriorityQueue::enqueuePlacement().
+    typename SuperClass::MessagePtr next;
+    while (pending.size() < this->getMaxMessages() && this->popMessage(next)) {
+        typename SuperClass::MessageList::iterator loc(pending.end());
+        // Null pointers are stored at end.
+        if (!next.isNull()) {
+            // Loop until the previous element is lower that msg.
+            while (loc != pending.begin()) {
+                const typename SuperClass::MessageList::iterator cur(loc);
+                --loc;
+                if (!loc->isNull() && !COMPARE()(*next, **loc)) {
+                    loc = cur;
+                    break;
+                }
+            }
+        }
+        pending.insert(loc, next);
+    }
+
+    if (pending.empty()) {
+        return false;
+    }
+    else {
+        msg = pending.front();
+        if (remove) {
+            pending.pop_front();
+        }
+        return true;
+    }
+}
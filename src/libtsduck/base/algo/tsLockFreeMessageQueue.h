@@ -0,0 +1,246 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Template lock-free message queue for inter-thread communication
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+#include "tsSafePtr.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuardCondition.h"
+
+namespace ts {
+    //!
+    //! Template lock-free message queue for inter-thread communication.
+    //! @ingroup thread
+    //!
+    //! This class has the same interface as ts::MessageQueue. It can be used instead of
+    //! ts::MessageQueue when several producer threads send messages to one single consumer
+    //! thread, at a high rate. This is a multi-producer single-consumer (MPSC) queue.
+    //! Only one thread shall call dequeue(), peek() and clear().
+    //!
+    //! The messages are stored in a circular buffer with a fixed capacity. Enqueueing and
+    //! dequeueing messages are lock-free operations. A mutex is used only when a thread
+    //! must wait for a message or for free space in the queue, or when a message is forced
+    //! in a full queue.
+    //!
+    //! @tparam MSG The type of the messages to exchange.
+    //! @tparam MUTEX The type of mutex for synchronization of message pointers (ts::Mutex by default).
+    //!
+    template <typename MSG, class MUTEX = Mutex>
+    class LockFreeMessageQueue
+    {
+        TS_NOCOPY(LockFreeMessageQueue);
+    public:
+        //!
+        //! Safe pointer to messages.
+        //!
+        typedef SafePtr<MSG, MUTEX> MessagePtr;
+
+        //!
+        //! Default maximum number of messages in the queue.
+        //!
+        static constexpr size_t DEFAULT_MAX_MESSAGES = 1024;
+
+        //!
+        //! Constructor.
+        //!
+        //! @param [in] maxMessages Maximum number of messages in the queue.
+        //! When a thread attempts to enqueue a message and the queue is full,
+        //! the thread waits until at least one message is dequeued.
+        //! Unlike ts::MessageQueue, a lock-free queue cannot be unlimited.
+        //! If @a maxMessages is 0, DEFAULT_MAX_MESSAGES is used.
+        //!
+        LockFreeMessageQueue(size_t maxMessages = DEFAULT_MAX_MESSAGES);
+
+        //!
+        //! Destructor
+        //!
+        virtual ~LockFreeMessageQueue();
+
+        //!
+        //! Get the maximum allowed messages in the queue.
+        //! The capacity of a lock-free queue cannot be changed after construction.
+        //! @return The maximum allowed messages in the queue.
+        //!
+        size_t getMaxMessages() const { return _cells.size(); }
+
+        //!
+        //! Insert a message in the queue.
+        //!
+        //! If the queue is full, the calling thread waits until some space becomes
+        //! available in the queue or the timeout expires.
+        //!
+        //! @param [in,out] msg The message to enqueue. The ownership of the pointed object
+        //! is transfered to the message queue. Upon return, the @a msg safe pointer becomes
+        //! a null pointer if the message was successfully enqueued (no timeout).
+        //! @param [in] timeout Maximum time to wait in milliseconds.
+        //! @return True on success, false on error (queue still full after timeout).
+        //!
+        bool enqueue(MessagePtr& msg, MilliSecond timeout = Infinite);
+
+        //!
+        //! Insert a message in the queue.
+        //!
+        //! If the queue is full, the calling thread waits until some space becomes
+        //! available in the queue or the timeout expires.
+        //!
+        //! @param [in] msg A pointer to the message to enqueue. This pointer shall not
+        //! be owned by a safe pointer. When the message is successfully enqueued, the
+        //! pointer becomes owned by a safe pointer and will be deallocated when no
+        //! longer used. In case of timeout, the object is not equeued and immediately
+        //! deallocated.
+        //! @param [in] timeout Maximum time to wait in milliseconds.
+        //! @return True on success, false on error (queue still full after timeout).
+        //!
+        bool enqueue(MSG* msg, MilliSecond timeout = Infinite);
+
+        //!
+        //! Insert a message in the queue, even if the queue is full.
+        //!
+        //! This method immediately inserts the message, even if the queue is full.
+        //! When the queue is full, the message is stored in an overflow list and will
+        //! be dequeued after the messages which are currently in the queue. The queue
+        //! remains full until all messages in the overflow list are dequeued.
+        //!
+        //! @param [in,out] msg The message to enqueue. The ownership of the pointed object
+        //! is transfered to the message queue. Upon return, the @a msg safe pointer becomes
+        //! a null pointer.
+        //!
+        void forceEnqueue(MessagePtr& msg);
+
+        //!
+        //! Insert a message in the queue, even if the queue is full.
+        //! @param [in] msg A pointer to the message to enqueue. This pointer shall not
+        //! be owned by a safe pointer. When the message is enqueued, the pointer becomes
+        //! owned by a safe pointer and will be deallocated when no longer used.
+        //! @see forceEnqueue(MessagePtr&)
+        //!
+        void forceEnqueue(MSG* msg);
+
+        //!
+        //! Remove a message from the queue.
+        //! Must be called from the consumer thread only.
+        //!
+        //! Wait until a message is received or the timeout expires.
+        //!
+        //! @param [out] msg Received message.
+        //! @param [in] timeout Maximum time to wait in milliseconds.
+        //! If @a timeout is zero and the queue is empty, return immediately.
+        //! @return True on success, false on error (queue still empty after timeout).
+        //!
+        bool dequeue(MessagePtr& msg, MilliSecond timeout = Infinite);
+
+        //!
+        //! Peek the next message from the queue, without dequeueing it.
+        //! Must be called from the consumer thread only.
+        //!
+        //! @return A safe pointer to the first message in the queue or a null pointer
+        //! if the queue is empty.
+        //!
+        MessagePtr peek();
+
+        //!
+        //! Clear the content of the queue.
+        //! Must be called from the consumer thread only.
+        //!
+        void clear();
+
+    protected:
+        //!
+        //! List of smart pointers to messages.
+        //!
+        typedef std::list<MessagePtr> MessageList;
+
+        //!
+        //! Get the next message in the context of the consumer thread.
+        //!
+        //! The default implementation returns the first message in the list of pending
+        //! messages, if not empty, or the next message in the circular buffer.
+        //! Subclasses may override this method to reorder the messages in the list of
+        //! pending messages, using popMessage() to get them from the circular buffer.
+        //!
+        //! @param [out] msg The next message.
+        //! @param [in] remove If true, the message is removed from the queue.
+        //! If false, the message remains in the list of pending messages.
+        //! @param [in,out] pending List of messages which were already extracted from the
+        //! circular buffer but not yet dequeued.
+        //! @return True if a message was found, false if the queue is empty.
+        //!
+        virtual bool nextMessage(MessagePtr& msg, bool remove, MessageList& pending);
+
+        //!
+        //! Extract the next message from the circular buffer or the overflow list.
+        //! Must be called from the consumer thread only.
+        //! @param [out] msg The next message.
+        //! @return True if a message was found, false if the circular buffer and the overflow list are empty.
+        //!
+        bool popMessage(MessagePtr& msg);
+
+    private:
+        // A cell in the circular buffer. The sequence number indicates if the cell is
+        // free for the producer at position "sequence" or holds a message for the
+        // consumer at position "sequence - 1".
+        class Cell
+        {
+        public:
+            Cell() : sequence(0), msg() {}
+            std::atomic<uint64_t> sequence;
+            MessagePtr            msg;
+        };
+
+        std::vector<Cell>     _cells;              // Circular buffer.
+        std::atomic<uint64_t> _enqueue_pos;        // Next position to enqueue (producers).
+        uint64_t              _dequeue_pos;        // Next position to dequeue (consumer only).
+        MessageList           _pending;            // Extracted but not yet dequeued messages (consumer only).
+        Mutex                 _mutex;              // Protect waiting and overflow.
+        Condition             _enqueued;           // Signaled when some message is inserted.
+        Condition             _dequeued;           // Signaled when some message is removed.
+        std::atomic<bool>     _consumer_waiting;   // The consumer is waiting on _enqueued.
+        std::atomic<size_t>   _producers_waiting;  // Number of producers waiting on _dequeued.
+        std::atomic<size_t>   _overflow_count;     // Number of messages in _overflow.
+        MessageList           _overflow;           // Forced messages when the queue was full (under _mutex).
+
+        // Try to insert a message in the circular buffer, lock-free. Return false if full.
+        bool tryPush(MessagePtr& msg);
+
+        // Check if the circular buffer or the overflow list is not empty (consumer only).
+        bool available() const;
+
+        // Signal the consumer thread or a producer thread if waiting.
+        void signalConsumer();
+        void signalProducers();
+    };
+}
+
+#include "tsLockFreeMessageQueueTemplate.h"
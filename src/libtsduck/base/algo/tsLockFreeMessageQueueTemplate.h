@@ -0,0 +1,349 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsGuardMutex.h"
+#include "tsTime.h"
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+template <typename MSG, class MUTEX>
+constexpr size_t ts::LockFreeMessageQueue<MSG, MUTEX>::DEFAULT_MAX_MESSAGES;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+ts::LockFreeMessageQueue<MSG, MUTEX>::LockFreeMessageQueue(size_t maxMessages) :
+    _cells(maxMessages == 0 ? DEFAULT_MAX_MESSAGES : maxMessages),
+    _enqueue_pos(0),
+    _dequeue_pos(0),
+    _pending(),
+    _mutex(),
+    _enqueued(),
+    _dequeued(),
+    _consumer_waiting(false),
+    _producers_waiting(0),
+    _overflow_count(0),
+    _overflow()
+{
+    // Initially, each cell is free for the producer at the same position.
+    for (size_t i = 0; i < _cells.size(); ++i) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename MSG, class MUTEX>
+ts::LockFreeMessageQueue<MSG, MUTEX>::~LockFreeMessageQueue()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Try to insert a message in the circular buffer, lock-free.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+bool ts::LockFreeMessageQueue<MSG, MUTEX>::tryPush(MessagePtr& msg)
+{
+    // While forced messages are pending in the overflow list, the queue is considered as
+    // full. Otherwise, new messages in the circular buffer would overtake the forced ones.
+    if (_overflow_count.load(std::memory_order_acquire) > 0) {
+        return false;
+    }
+
+    const uint64_t size = _cells.size();
+    uint64_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+
+    // Reserve a position in the circular buffer.
+    for (;;) {
+        cell = &_cells[size_t(pos % size)];
+        const uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+        if (seq == pos) {
+            // The cell is free, try to reserve it.
+            if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+            // Another producer reserved it, pos was updated, retry.
+        }
+        else if (seq < pos) {
+            // The cell still contains the message from the previous round: queue full.
+            return false;
+        }
+        else {
+            // Another producer already reserved this position, retry with the new one.
+            pos = _enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Transfer the ownership of the message into the cell and publish it to the consumer.
+    cell->msg = MessagePtr(msg.release());
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Signal the consumer or a producer thread if waiting.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+void ts::LockFreeMessageQueue<MSG, MUTEX>::signalConsumer()
+{
+    // The fence orders the publication of the message before checking the waiting flag.
+    // The consumer sets the flag before checking for messages, under the mutex.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_consumer_waiting.load(std::memory_order_relaxed)) {
+        GuardMutex lock(_mutex);
+        _enqueued.signal();
+    }
+}
+
+template <typename MSG, class MUTEX>
+void ts::LockFreeMessageQueue<MSG, MUTEX>::signalProducers()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_producers_waiting.load(std::memory_order_relaxed) > 0) {
+        GuardMutex lock(_mutex);
+        _dequeued.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Insert a message in the queue with a timeout.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+bool ts::LockFreeMessageQueue<MSG, MUTEX>::enqueue(MessagePtr& msg, MilliSecond timeout)
+{
+    // Fast path, lock-free.
+    bool done = tryPush(msg);
+
+    // If the queue is full, wait for free space.
+    if (!done && timeout > 0) {
+        GuardCondition lock(_mutex, _dequeued);
+        _producers_waiting.fetch_add(1, std::memory_order_seq_cst);
+        Time start(Time::CurrentUTC());
+        while (!(done = tryPush(msg))) {
+            // Reduce timeout
+            if (timeout != Infinite) {
+                const Time now(Time::CurrentUTC());
+                timeout -= now - start;
+                start = now;
+                if (timeout <= 0) {
+                    break; // timeout
+                }
+            }
+            // Wait for a message to be dequeued.
+            if (!lock.waitCondition(timeout)) {
+                done = tryPush(msg);
+                break; // timeout
+            }
+        }
+        _producers_waiting.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    if (done) {
+        signalConsumer();
+    }
+    return done;
+}
+
+template <typename MSG, class MUTEX>
+bool ts::LockFreeMessageQueue<MSG, MUTEX>::enqueue(MSG* msg, MilliSecond timeout)
+{
+    MessagePtr ptr(msg);
+    // In case of timeout, the message is deallocated with ptr.
+    return enqueue(ptr, timeout);
+}
+
+
+//----------------------------------------------------------------------------
+// Insert a message in the queue, even if the queue is full.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+void ts::LockFreeMessageQueue<MSG, MUTEX>::forceEnqueue(MessagePtr& msg)
+{
+    if (!tryPush(msg)) {
+        // Queue full, use the overflow list.
+        GuardMutex lock(_mutex);
+        _overflow.push_back(MessagePtr(msg.release()));
+        _overflow_count.fetch_add(1, std::memory_order_release);
+    }
+    signalConsumer();
+}
+
+template <typename MSG, class MUTEX>
+void ts::LockFreeMessageQueue<MSG, MUTEX>::forceEnqueue(MSG* msg)
+{
+    MessagePtr ptr(msg);
+    forceEnqueue(ptr);
+}
+
+
+//----------------------------------------------------------------------------
+// Consumer side: extract messages from the circular buffer or overflow.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+bool ts::LockFreeMessageQueue<MSG, MUTEX>::available() const
+{
+    const Cell& cell(_cells[size_t(_dequeue_pos % _cells.size())]);
+    return cell.sequence.load(std::memory_order_acquire) == _dequeue_pos + 1 || _overflow_count.load(std::memory_order_acquire) > 0;
+}
+
+template <typename MSG, class MUTEX>
+bool ts::LockFreeMessageQueue<MSG, MUTEX>::popMessage(MessagePtr& msg)
+{
+    Cell& cell(_cells[size_t(_dequeue_pos % _cells.size())]);
+    if (cell.sequence.load(std::memory_order_acquire) == _dequeue_pos + 1) {
+        // A message is available in the circular buffer.
+        // Moving the message leaves the cell empty, without reallocation.
+        msg = std::move(cell.msg);
+        // Make the cell free for the producer in the next round.
+        cell.sequence.store(_dequeue_pos + _cells.size(), std::memory_order_release);
+        _dequeue_pos++;
+        return true;
+    }
+    else if (_overflow_count.load(std::memory_order_acquire) > 0) {
+        // Circular buffer empty, some messages were forced when the queue was full.
+        GuardMutex lock(_mutex);
+        msg = _overflow.front();
+        _overflow.pop_front();
+        _overflow_count.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+    else {
+        return false;
+    }
+}
+
+template <typename MSG, class MUTEX>
+bool ts::LockFreeMessageQueue<MSG, MUTEX>::nextMessage(MessagePtr& msg, bool remove, MessageList& pending)
+{
+    if (!pending.empty()) {
+        msg = pending.front();
+        if (remove) {
+            pending.pop_front();
+        }
+        return true;
+    }
+    else if (!popMessage(msg)) {
+        return false;
+    }
+    else {
+        if (!remove) {
+            // Keep the message for the next dequeue.
+            pending.push_back(msg);
+        }
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Remove a message from the queue.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+bool ts::LockFreeMessageQueue<MSG, MUTEX>::dequeue(MessagePtr& msg, MilliSecond timeout)
+{
+    // Fast path, lock-free.
+    bool done = nextMessage(msg, true, _pending);
+
+    // If the queue is empty, wait for a message.
+    if (!done && timeout > 0) {
+        GuardCondition lock(_mutex, _enqueued);
+        _consumer_waiting.store(true, std::memory_order_seq_cst);
+        Time start(Time::CurrentUTC());
+        while (!(done = nextMessage(msg, true, _pending))) {
+            // Reduce timeout
+            if (timeout != Infinite) {
+                const Time now(Time::CurrentUTC());
+                timeout -= now - start;
+                start = now;
+                if (timeout <= 0) {
+                    break; // timeout
+                }
+            }
+            // Wait for a message to be enqueued, unless one arrived in the meantime.
+            if (!available() && !lock.waitCondition(timeout)) {
+                done = nextMessage(msg, true, _pending);
+                break; // timeout
+            }
+        }
+        _consumer_waiting.store(false, std::memory_order_relaxed);
+    }
+
+    if (done) {
+        signalProducers();
+    }
+    return done;
+}
+
+
+//----------------------------------------------------------------------------
+// Peek the next message from the queue, without dequeueing it.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+typename ts::LockFreeMessageQueue<MSG, MUTEX>::MessagePtr ts::LockFreeMessageQueue<MSG, MUTEX>::peek()
+{
+    MessagePtr msg;
+    if (nextMessage(msg, false, _pending)) {
+        // The message may have been moved from the circular buffer to the pending list.
+        signalProducers();
+    }
+    return msg;
+}
+
+
+//----------------------------------------------------------------------------
+// Clear the queue.
+//----------------------------------------------------------------------------
+
+template <typename MSG, class MUTEX>
+void ts::LockFreeMessageQueue<MSG, MUTEX>::clear()
+{
+    MessagePtr msg;
+    size_t count = 0;
+    _pending.clear();
+    while (popMessage(msg)) {
+        count++;
+    }
+    // Signal that messages have been dequeued (dropped in fact), one waiting producer per free cell.
+    while (count-- > 0) {
+        signalProducers();
+    }
+}
@@ -29,6 +29,8 @@
 
 #include "tsUDPReceiver.h"
 #include "tsArgs.h"
+#include "tsIPProtocols.h"
+#include "tsNullReport.h"
 
 
 //----------------------------------------------------------------------------
@@ -47,11 +49,16 @@ ts::UDPReceiver::UDPReceiver(ts::Report& report, bool with_short_options, bool d
     _default_interface(false),
     _use_first_source(false),
     _recv_timestamps(true), // currently hardcoded, is there a reason to disable it?
+    _recv_offload(false),
     _recv_bufsize(0),
     _recv_timeout(-1),
     _use_source(),
     _first_source(),
-    _sources()
+    _sources(),
+    _gro_buffer(),
+    _gro_message(),
+    _gro_next(0),
+    _gro_active(false)
 {
 }
 
@@ -93,6 +100,13 @@ void ts::UDPReceiver::defineArgs(ts::Args& args)
               u"use option --source. Options --first-source and --source are mutually "
               u"exclusive.");
 
+    args.option(u"gro");
+    args.help(u"gro",
+              u"Use the generic receive offload (GRO) on the UDP socket (Linux only). "
+              u"The system may coalesce consecutive datagrams from the same source into larger messages, "
+              u"reducing the number of receive operations. Each message is split back into the original datagrams. "
+              u"When the kernel does not support it, the datagrams are received individually.");
+
     args.option(u"local-address", _with_short_options ? 'l' : 0, Args::STRING);
     args.help(u"local-address", u"address",
               u"Specify the IP address of the local interface on which to listen. "
@@ -151,6 +165,7 @@ bool ts::UDPReceiver::loadArgs(DuckContext& duck, Args& args)
     _default_interface = args.present(u"default-interface");
     _use_ssm = args.present(u"ssm");
     _use_first_source = args.present(u"first-source");
+    _recv_offload = args.present(u"gro");
     _recv_bufsize = args.intValue<size_t>(u"buffer-size", 0);
     _recv_timeout = args.intValue<MilliSecond>(u"receive-timeout", _recv_timeout); // preserve previous value
 
@@ -286,6 +301,13 @@ bool ts::UDPReceiver::open(ts::Report& report)
     _first_source.clear();
     _sources.clear();
 
+    // Reception buffer for coalesced datagrams.
+    _gro_buffer.resize(_recv_offload ? IP_MAX_PACKET_SIZE : 0);
+    _gro_message.data = _gro_buffer.data();
+    _gro_message.max_size = _gro_buffer.size();
+    _gro_message.size = 0;
+    _gro_next = 0;
+
     // The local socket address to bind is the optional local IP address and the destination port.
     // Except on Linux, macOS and probably most Unix, when listening to a multicast group.
     // In that case, we bind to the multicast group, not the local interface.
@@ -308,6 +330,15 @@ bool ts::UDPReceiver::open(ts::Report& report)
         (_recv_timeout < 0 || setReceiveTimeout(_recv_timeout, report)) &&
         bind(local_addr, report);
 
+    // Generic receive offload is not supported on old kernels, revert to individual datagrams.
+    _gro_active = false;
+    if (ok && _recv_offload) {
+        _gro_active = setReceiveOffload(true, NULLREP);
+        if (!_gro_active) {
+            report.warning(u"UDP generic receive offload not supported, receiving individual datagrams");
+        }
+    }
+
     // Optional SSM source address.
     IPv4Address ssm_source;
     if (_use_ssm) {
@@ -348,83 +379,180 @@ bool ts::UDPReceiver::receive(void* data,
                               ts::Report& report,
                               MicroSecond* timestamp)
 {
-    // Loop on packet reception until one matching filtering criteria is found.
-    for (;;) {
+    // With receive offload, get one datagram from the coalesced messages.
+    if (_gro_active) {
+        ReceiveBuffer buf(data, max_size);
+        size_t count = 0;
+        if (!receiveOffload(&buf, 1, count, abort, report)) {
+            return false;
+        }
+        ret_size = buf.size;
+        sender = buf.sender;
+        destination = buf.destination;
+        if (timestamp != nullptr) {
+            *timestamp = buf.timestamp;
+        }
+        return true;
+    }
 
+    // Loop on packet reception until one matching filtering criteria is found.
+    do {
         // Wait for a UDP message from the superclass.
         if (!UDPSocket::receive(data, max_size, ret_size, sender, destination, abort, report, timestamp)) {
             return false;
         }
+    } while (!acceptPacket(sender, destination, timestamp != nullptr ? *timestamp : -1, report));
+    return true;
+}
 
-        // Debug (level 2) message for each message.
-        if (report.maxSeverity() >= 2) {
-            // Prior report level checking to avoid evaluating parameters when not necessary.
-            report.log(2, u"received UDP packet, source: %s, destination: %s, timestamp: %'d", {sender, destination, timestamp != nullptr ? *timestamp : -1});
+
+//----------------------------------------------------------------------------
+// Receive several messages. Override UDPSocket::receiveBatch().
+//----------------------------------------------------------------------------
+
+bool ts::UDPReceiver::receiveBatch(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, const AbortInterface* abort, Report& report)
+{
+    // With receive offload, split the coalesced messages.
+    if (_gro_active) {
+        return receiveOffload(buffers, max_count, ret_count, abort, report);
+    }
+
+    // Loop on batch reception until at least one message matches the filtering criteria.
+    do {
+        // Wait for UDP messages from the superclass.
+        size_t count = 0;
+        if (!UDPSocket::receiveBatch(buffers, max_count, count, abort, report)) {
+            return false;
         }
 
-        // Check the destination address to exclude packets from other streams.
-        // When several multicast streams use the same destination port and several
-        // applications on the same system listen to these distinct streams,
-        // the multicast MAC address management is such that any socket which
-        // is bound to the common port will receive the traffic for all streams.
-        // This is why we need to check the destination address and exclude
-        // packets which are not from the intended stream.
-        //
-        // We accept a packet in any of:
-        // 1) Actual packet destination is unknown. Probably, the system cannot
-        //    report the destination address.
-        // 2) We listen to a multicast address and the actual destination is the same.
-        // 3) If we listen to unicast traffic and the actual destination is unicast.
-        //    In that case, unicast is by definition sent to us.
-
-        if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
-            // This is a spurious packet.
-            if (report.maxSeverity() >= Severity::Debug) {
-                // Prior report level checking to avoid evaluating parameters when not necessary.
-                report.debug(u"rejecting packet, destination: %s, expecting: %s", {destination, _dest_addr});
+        // Remove rejected messages, keep accepted ones in the same order.
+        ret_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            ReceiveBuffer& buf(buffers[i]);
+            if (acceptPacket(buf.sender, buf.destination, buf.timestamp, report)) {
+                if (ret_count < i) {
+                    MoveReceiveBuffer(buffers[ret_count], buf);
+                }
+                ret_count++;
             }
-            continue;
         }
+    } while (ret_count == 0);
+    return true;
+}
 
-        // Keep track of the first sender address.
-        if (!_first_source.hasAddress()) {
-            // First packet, keep address of the sender.
-            _first_source = sender;
-            _sources.insert(sender);
-
-            // With option --first-source, use this one to filter packets.
-            if (_use_first_source) {
-                assert(!_use_source.hasAddress());
-                _use_source = sender;
-                report.verbose(u"now filtering on source address %s", {sender});
-            }
+
+//----------------------------------------------------------------------------
+// Receive datagrams from coalesced messages (generic receive offload).
+//----------------------------------------------------------------------------
+
+bool ts::UDPReceiver::receiveOffload(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, const AbortInterface* abort, Report& report)
+{
+    ret_count = 0;
+
+    // When all datagrams from the previous message were returned, receive a new message.
+    while (_gro_next >= _gro_message.size) {
+        _gro_next = 0;
+        size_t count = 0;
+        if (!UDPSocket::receiveBatch(&_gro_message, 1, count, abort, report)) {
+            _gro_message.size = 0;
+            return false;
         }
+        if (!acceptPacket(_gro_message.sender, _gro_message.destination, _gro_message.timestamp, report)) {
+            _gro_message.size = 0;
+        }
+    }
 
-        // Keep track of senders (sources) to detect or filter multiple sources.
-        if (_sources.count(sender) == 0) {
-            // Detected an additional source, warn the user that distinct streams are potentially mixed.
-            // If no source filtering is applied, this is a warning since this may affect the resulting stream.
-            // With source filtering, this is just an informational verbose-level message.
-            const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
-            if (_sources.size() == 1) {
-                report.log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination});
-                report.log(level, u"detected source: %s", {_first_source});
-            }
-            report.log(level, u"detected source: %s", {sender});
-            _sources.insert(sender);
+    // Split the coalesced message into individual datagrams.
+    const size_t segment_size = _gro_message.segment_size > 0 ? _gro_message.segment_size : _gro_message.size;
+    while (ret_count < max_count && _gro_next < _gro_message.size) {
+        ReceiveBuffer& buf(buffers[ret_count++]);
+        const size_t size = std::min(segment_size, _gro_message.size - _gro_next);
+        buf.size = std::min(size, buf.max_size);
+        buf.sender = _gro_message.sender;
+        buf.destination = _gro_message.destination;
+        buf.timestamp = _gro_message.timestamp;
+        buf.segment_size = 0;
+        ::memcpy(buf.data, _gro_buffer.data() + _gro_next, buf.size);
+        _gro_next += size;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a received packet matches all filtering criteria.
+//----------------------------------------------------------------------------
+
+bool ts::UDPReceiver::acceptPacket(const IPv4SocketAddress& sender, const IPv4SocketAddress& destination, MicroSecond timestamp, Report& report)
+{
+    // Debug (level 2) message for each message.
+    if (report.maxSeverity() >= 2) {
+        // Prior report level checking to avoid evaluating parameters when not necessary.
+        report.log(2, u"received UDP packet, source: %s, destination: %s, timestamp: %'d", {sender, destination, timestamp});
+    }
+
+    // Check the destination address to exclude packets from other streams.
+    // When several multicast streams use the same destination port and several
+    // applications on the same system listen to these distinct streams,
+    // the multicast MAC address management is such that any socket which
+    // is bound to the common port will receive the traffic for all streams.
+    // This is why we need to check the destination address and exclude
+    // packets which are not from the intended stream.
+    //
+    // We accept a packet in any of:
+    // 1) Actual packet destination is unknown. Probably, the system cannot
+    //    report the destination address.
+    // 2) We listen to a multicast address and the actual destination is the same.
+    // 3) If we listen to unicast traffic and the actual destination is unicast.
+    //    In that case, unicast is by definition sent to us.
+
+    if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
+        // This is a spurious packet.
+        if (report.maxSeverity() >= Severity::Debug) {
+            // Prior report level checking to avoid evaluating parameters when not necessary.
+            report.debug(u"rejecting packet, destination: %s, expecting: %s", {destination, _dest_addr});
         }
+        return false;
+    }
 
-        // Filter packets based on source address if requested.
-        if (!sender.match(_use_source)) {
-            // Not the expected source, this is a spurious packet.
-            if (report.maxSeverity() >= Severity::Debug) {
-                // Prior report level checking to avoid evaluating parameters when not necessary.
-                report.debug(u"rejecting packet, source: %s, expecting: %s", {sender, _use_source});
-            }
-            continue;
+    // Keep track of the first sender address.
+    if (!_first_source.hasAddress()) {
+        // First packet, keep address of the sender.
+        _first_source = sender;
+        _sources.insert(sender);
+
+        // With option --first-source, use this one to filter packets.
+        if (_use_first_source) {
+            assert(!_use_source.hasAddress());
+            _use_source = sender;
+            report.verbose(u"now filtering on source address %s", {sender});
         }
+    }
 
-        // Now found a packet matching all criteria.
-        return true;
+    // Keep track of senders (sources) to detect or filter multiple sources.
+    if (_sources.count(sender) == 0) {
+        // Detected an additional source, warn the user that distinct streams are potentially mixed.
+        // If no source filtering is applied, this is a warning since this may affect the resulting stream.
+        // With source filtering, this is just an informational verbose-level message.
+        const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
+        if (_sources.size() == 1) {
+            report.log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination});
+            report.log(level, u"detected source: %s", {_first_source});
+        }
+        report.log(level, u"detected source: %s", {sender});
+        _sources.insert(sender);
     }
+
+    // Filter packets based on source address if requested.
+    if (!sender.match(_use_source)) {
+        // Not the expected source, this is a spurious packet.
+        if (report.maxSeverity() >= Severity::Debug) {
+            // Prior report level checking to avoid evaluating parameters when not necessary.
+            report.debug(u"rejecting packet, source: %s, expecting: %s", {sender, _use_source});
+        }
+        return false;
+    }
+
+    // Now found a packet matching all criteria.
+    return true;
 }
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsUDPSocket.h"
 #include "tsArgsSupplierInterface.h"
+#include "tsByteBlock.h"
 
 namespace ts {
     //!
@@ -91,6 +92,7 @@ namespace ts {
                              const AbortInterface* abort = nullptr,
                              Report& report = CERR,
                              MicroSecond* timestamp = nullptr) override;
+        virtual bool receiveBatch(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, const AbortInterface* abort = nullptr, Report& report = CERR) override;
 
     private:
         bool              _with_short_options;
@@ -103,10 +105,21 @@ namespace ts {
         bool              _default_interface;  // Use default local interface.
         bool              _use_first_source;   // Use socket address of first received packet to filter subsequent packets.
         bool              _recv_timestamps;    // Get receive timestamps.
+        bool              _recv_offload;       // Use generic receive offload (GRO).
         size_t            _recv_bufsize;       // Socket receive buffer size.
         MilliSecond       _recv_timeout;       // Receive timeout.
         IPv4SocketAddress _use_source;         // Filter on this socket address of sender (can be a simple filter of an SSM source).
         IPv4SocketAddress _first_source;       // Socket address of first received packet.
         IPv4SocketAddressSet _sources;         // Set of all detected packet sources.
+        ByteBlock         _gro_buffer;         // Reception buffer for coalesced datagrams.
+        ReceiveBuffer     _gro_message;        // Last received coalesced message, in _gro_buffer.
+        size_t            _gro_next;           // Index in _gro_buffer of next datagram to return.
+        bool              _gro_active;         // Generic receive offload is active on the open socket.
+
+        // Receive datagrams from coalesced messages.
+        bool receiveOffload(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, const AbortInterface* abort, Report& report);
+
+        // Check if a received packet matches all filtering criteria.
+        bool acceptPacket(const IPv4SocketAddress& sender, const IPv4SocketAddress& destination, MicroSecond timestamp, Report& report);
     };
 }
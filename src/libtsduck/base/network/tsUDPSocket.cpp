@@ -29,12 +29,29 @@
 
 #include "tsUDPSocket.h"
 #include "tsNullReport.h"
+#include "tsIPProtocols.h"
 
 // Network timestampting feature in Linux.
 #if defined(TS_LINUX)
 #include <linux/net_tstamp.h>
 #endif
 
+// UDP segmentation and receive offload in Linux (definitions are missing in older C libraries).
+#if defined(TS_LINUX)
+#include <netinet/udp.h>
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+#if !defined(UDP_GRO)
+#define UDP_GRO 104
+#endif
+#endif
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::UDPSocket::MAX_BATCH_SIZE;
+constexpr size_t ts::UDPSocket::MAX_SEGMENTS;
+#endif
+
 // Furiously idiotic Windows feature, see comment in receiveOne()
 #if defined(TS_WINDOWS)
 volatile ::LPFN_WSARECVMSG ts::UDPSocket::_wsaRevcMsg = 0;
@@ -50,7 +67,8 @@ ts::UDPSocket::UDPSocket(bool auto_open, Report& report) :
     _local_address(),
     _default_destination(),
     _mcast(),
-    _ssmcast()
+    _ssmcast(),
+    _no_gso(false)
 {
     if (auto_open) {
         // Returned value ignored on purpose, the socket is marked as closed in the object on error.
@@ -60,6 +78,18 @@ ts::UDPSocket::UDPSocket(bool auto_open, Report& report) :
 }
 
 
+ts::UDPSocket::ReceiveBuffer::ReceiveBuffer(void* data_, size_t max_size_) :
+    data(data_),
+    max_size(max_size_),
+    size(0),
+    sender(),
+    destination(),
+    timestamp(-1),
+    segment_size(0)
+{
+}
+
+
 //----------------------------------------------------------------------------
 // Destructor
 //----------------------------------------------------------------------------
@@ -81,6 +111,7 @@ bool ts::UDPSocket::open(Report& report)
     if (!createSocket(PF_INET, SOCK_DGRAM, IPPROTO_UDP, report)) {
         return false;
     }
+    _no_gso = false;
 
     // Set the IP_PKTINFO option. This option is used to get the destination address of all
     // UDP packets arriving on this socket. Actual socket option is an int.
@@ -243,6 +274,25 @@ bool ts::UDPSocket::setReceiveTimestamps(bool on, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Enable or disable the generic receive offload.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::setReceiveOffload(bool on, Report& report)
+{
+    // The option exists only on Linux and is silently ignored on other systems.
+#if defined(TS_LINUX)
+    int enable = int(on);
+    if (::setsockopt(getSocket(), IPPROTO_UDP, UDP_GRO, &enable, sizeof(enable)) != 0) {
+        report.error(u"socket option UDP_GRO: " + SysSocketErrorCodeMessage());
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Enable or disable the broadcast option.
 //----------------------------------------------------------------------------
@@ -423,6 +473,162 @@ bool ts::UDPSocket::send(const void* data, size_t size, const IPv4SocketAddress&
 }
 
 
+//----------------------------------------------------------------------------
+// Send several messages to a destination address and port.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::sendBatch(const void* const* data, const size_t* sizes, size_t count, Report& report)
+{
+    return sendBatch(data, sizes, count, _default_destination, report);
+}
+
+bool ts::UDPSocket::sendBatch(const void* const* data, const size_t* sizes, size_t count, const IPv4SocketAddress& dest, Report& report)
+{
+#if defined(TS_LINUX)
+
+    ::sockaddr addr;
+    dest.copy(addr);
+
+    // Send messages by groups of MAX_BATCH_SIZE.
+    ::iovec vec[MAX_BATCH_SIZE];
+    ::mmsghdr msg[MAX_BATCH_SIZE];
+
+    while (count > 0) {
+
+        // Build the message headers.
+        const size_t batch = std::min(count, MAX_BATCH_SIZE);
+        TS_ZERO(msg);
+        for (size_t i = 0; i < batch; ++i) {
+            vec[i].iov_base = const_cast<void*>(data[i]);
+            vec[i].iov_len = sizes[i];
+            msg[i].msg_hdr.msg_name = &addr;
+            msg[i].msg_hdr.msg_namelen = sizeof(addr);
+            msg[i].msg_hdr.msg_iov = &vec[i];
+            msg[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // Send as many messages as possible. The system may send less messages than requested.
+        const int sent = ::sendmmsg(getSocket(), msg, ::uint(batch), 0);
+        if (sent < 0) {
+            report.error(u"error sending UDP message: " + SysSocketErrorCodeMessage());
+            return false;
+        }
+        data += sent;
+        sizes += sent;
+        count -= size_t(sent);
+    }
+    return true;
+
+#else
+
+    // No batch system call, send messages one by one.
+    bool ok = true;
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = send(data[i], sizes[i], dest, report);
+    }
+    return ok;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Send a buffer containing several datagrams of identical size.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::sendSegments(const void* data, size_t size, size_t segment_size, Report& report)
+{
+    return sendSegments(data, size, segment_size, _default_destination, report);
+}
+
+bool ts::UDPSocket::sendSegments(const void* data, size_t size, size_t segment_size, const IPv4SocketAddress& dest, Report& report)
+{
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
+
+    if (segment_size == 0) {
+        report.error(u"invalid UDP segment size 0");
+        return false;
+    }
+
+#if defined(TS_LINUX)
+
+    // Maximum number of segments in one message: the total size is limited to the maximum UDP payload.
+    const size_t max_segments = std::min(MAX_SEGMENTS, (0xFFFF - IPv4_MIN_HEADER_SIZE - UDP_HEADER_SIZE) / segment_size);
+
+    if (!_no_gso && max_segments > 1) {
+
+        ::sockaddr addr;
+        dest.copy(addr);
+
+        // Ancillary data containing the segment size. Use a union to get an aligned buffer.
+        union {
+            ::cmsghdr hdr;
+            uint8_t data[CMSG_SPACE(sizeof(uint16_t))];
+        } ancil;
+        TS_ZERO(ancil);
+
+        while (size > segment_size) {
+
+            // Send as many segments as possible in one message.
+            const size_t msg_size = std::min(size, max_segments * segment_size);
+
+            ::iovec vec;
+            vec.iov_base = const_cast<uint8_t*>(ptr);
+            vec.iov_len = msg_size;
+
+            ::msghdr hdr;
+            TS_ZERO(hdr);
+            hdr.msg_name = &addr;
+            hdr.msg_namelen = sizeof(addr);
+            hdr.msg_iov = &vec;
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = ancil.data;
+            hdr.msg_controllen = sizeof(ancil.data);
+
+            // Because of invalid definition of CMSG_FIRSTHDR in musl libc (Alpine Linux)
+            TS_PUSH_WARNING()
+            TS_GCC_NOWARNING(zero-as-null-pointer-constant)
+            ::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+            TS_POP_WARNING()
+            cmsg->cmsg_level = IPPROTO_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            const uint16_t seg = uint16_t(segment_size);
+            ::memcpy(CMSG_DATA(cmsg), &seg, sizeof(seg));
+
+            if (::sendmsg(getSocket(), &hdr, 0) >= 0) {
+                ptr += msg_size;
+                size -= msg_size;
+            }
+            else {
+                const SysSocketErrorCode err = LastSysSocketErrorCode();
+                if (err != EINVAL && err != EIO && err != ENOPROTOOPT && err != EOPNOTSUPP) {
+                    report.error(u"error sending UDP message: " + SysSocketErrorCodeMessage(err));
+                    return false;
+                }
+                // Segmentation offload not supported by the kernel or the interface, revert to individual datagrams.
+                report.verbose(u"UDP segmentation offload not supported (%s), sending individual datagrams", {SysSocketErrorCodeMessage(err)});
+                _no_gso = true;
+                break;
+            }
+        }
+    }
+
+#endif
+
+    // Send remaining datagrams one by one.
+    while (size > 0) {
+        const size_t dg_size = std::min(size, segment_size);
+        if (!send(ptr, dg_size, dest, report)) {
+            return false;
+        }
+        ptr += dg_size;
+        size -= dg_size;
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Receive a message.
 // If abort interface is non-zero, invoke it when I/O is interrupted
@@ -479,6 +685,141 @@ bool ts::UDPSocket::receive(void* data,
 }
 
 
+//----------------------------------------------------------------------------
+// Receive several messages in one operation.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::receiveBatch(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, const AbortInterface* abort, Report& report)
+{
+    ret_count = 0;
+    if (buffers == nullptr || max_count == 0) {
+        report.error(u"no buffer for UDP reception");
+        return false;
+    }
+
+    // Loop on unsollicited interrupts
+    for (;;) {
+
+        // Wait for messages.
+        size_t count = 0;
+        const SysSocketErrorCode err = receiveMany(buffers, std::min(max_count, MAX_BATCH_SIZE), count, report);
+
+        if (abort != nullptr && abort->aborting()) {
+            // Aborting, no error message.
+            return false;
+        }
+        else if (err == SYS_SUCCESS) {
+            // Sometimes, we get "successful" empty message coming from nowhere. Ignore them.
+            for (size_t i = 0; i < count; ++i) {
+                if (buffers[i].size > 0 || buffers[i].sender.hasAddress()) {
+                    if (ret_count < i) {
+                        MoveReceiveBuffer(buffers[ret_count], buffers[i]);
+                    }
+                    ret_count++;
+                }
+            }
+            if (ret_count > 0) {
+                return true;
+            }
+        }
+        else if (abort != nullptr && abort->aborting()) {
+            // User-interrupt, end of processing but no error message
+            return false;
+        }
+#if !defined(TS_WINDOWS)
+        else if (err == EINTR) {
+            // Got a signal, not a user interrupt, will ignore it
+            report.debug(u"signal, not user interrupt");
+        }
+#endif
+        else {
+            // Abort on non-interrupt errors.
+            report.error(u"error receiving from UDP socket: %s", {SysSocketErrorCodeMessage(err)});
+            return false;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Move a received message into another reception buffer.
+//----------------------------------------------------------------------------
+
+void ts::UDPSocket::MoveReceiveBuffer(ReceiveBuffer& dest, const ReceiveBuffer& src)
+{
+    dest.size = std::min(src.size, dest.max_size);
+    dest.sender = src.sender;
+    dest.destination = src.destination;
+    dest.timestamp = src.timestamp;
+    dest.segment_size = src.segment_size;
+    ::memmove(dest.data, src.data, dest.size);
+}
+
+
+//----------------------------------------------------------------------------
+// Perform one batched receive operation.
+//----------------------------------------------------------------------------
+
+ts::SysSocketErrorCode ts::UDPSocket::receiveMany(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, Report& report)
+{
+#if defined(TS_LINUX)
+
+    // Reserve system structures for all messages, including ancillary data.
+    ::sockaddr sender_sock[MAX_BATCH_SIZE];
+    ::iovec vec[MAX_BATCH_SIZE];
+    ::mmsghdr msg[MAX_BATCH_SIZE];
+    uint8_t ancil_data[MAX_BATCH_SIZE][256];
+
+    assert(max_count <= MAX_BATCH_SIZE);
+    TS_ZERO(sender_sock);
+    TS_ZERO(msg);
+
+    for (size_t i = 0; i < max_count; ++i) {
+        vec[i].iov_base = buffers[i].data;
+        vec[i].iov_len = buffers[i].max_size;
+        msg[i].msg_hdr.msg_name = &sender_sock[i];
+        msg[i].msg_hdr.msg_namelen = sizeof(sender_sock[i]);
+        msg[i].msg_hdr.msg_iov = &vec[i];
+        msg[i].msg_hdr.msg_iovlen = 1;
+        msg[i].msg_hdr.msg_control = ancil_data[i];
+        msg[i].msg_hdr.msg_controllen = sizeof(ancil_data[i]);
+    }
+
+    // Wait for at least one message, then get all messages which are already available.
+    const int count = ::recvmmsg(getSocket(), msg, ::uint(max_count), MSG_WAITFORONE, nullptr);
+    if (count < 0) {
+        ret_count = 0;
+        return LastSysSocketErrorCode();
+    }
+
+    // Analyze all received messages.
+    ret_count = size_t(count);
+    for (size_t i = 0; i < ret_count; ++i) {
+        ReceiveBuffer& buf(buffers[i]);
+        buf.size = msg[i].msg_len;
+        buf.sender = IPv4SocketAddress(sender_sock[i]);
+        buf.destination.clear();
+        buf.timestamp = -1;
+        buf.segment_size = 0;
+        getAncillaryData(msg[i].msg_hdr, buf.destination, &buf.timestamp, &buf.segment_size);
+    }
+    return SYS_SUCCESS;
+
+#else
+
+    // No batch system call, receive one message only.
+    assert(max_count > 0);
+    ReceiveBuffer& buf(buffers[0]);
+    buf.timestamp = -1;
+    buf.segment_size = 0;
+    const SysSocketErrorCode err = receiveOne(buf.data, buf.max_size, buf.size, buf.sender, buf.destination, report, &buf.timestamp);
+    ret_count = err == SYS_SUCCESS ? 1 : 0;
+    return err;
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Perform one receive operation. Hide the system mud.
 //----------------------------------------------------------------------------
@@ -594,6 +935,27 @@ ts::SysSocketErrorCode ts::UDPSocket::receiveOne(void* data,
         return LastSysSocketErrorCode();
     }
 
+    // Browse returned ancillary data.
+    getAncillaryData(hdr, destination, timestamp, nullptr);
+
+#endif // Windows vs. UNIX
+
+    // Successfully received a message
+    ret_size = size_t(insize);
+    sender = IPv4SocketAddress(sender_sock);
+
+    return SYS_SUCCESS;
+}
+
+
+//----------------------------------------------------------------------------
+// Analyze the ancillary data of a received message (UNIX only).
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+
+void ts::UDPSocket::getAncillaryData(::msghdr& hdr, IPv4SocketAddress& destination, MicroSecond* timestamp, size_t* segment_size)
+{
     // Because of invalid definition of CMSG_NXTHDR in musl libc (Alpine Linux)
     TS_PUSH_WARNING()
     TS_GCC_NOWARNING(zero-as-null-pointer-constant)
@@ -618,16 +980,17 @@ ts::SysSocketErrorCode ts::UDPSocket::receiveOne(void* data,
                 *timestamp = nano / NanoSecPerMicroSec;
             }
         }
+
+        // On Linux, look for the size of coalesced datagrams (generic receive offload).
+        else if (segment_size != nullptr && cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO && cmsg->cmsg_len >= CMSG_LEN(sizeof(int))) {
+            int size = 0;
+            ::memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+            *segment_size = size_t(std::max(size, 0));
+        }
 #endif
     }
 
     TS_POP_WARNING()
-
-#endif // Windows vs. UNIX
-
-    // Successfully received a message
-    ret_size = size_t(insize);
-    sender = IPv4SocketAddress(sender_sock);
-
-    return SYS_SUCCESS;
 }
+
+#endif
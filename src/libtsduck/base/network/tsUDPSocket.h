@@ -56,6 +56,45 @@ namespace ts {
         //!
         UDPSocket(bool auto_open = false, Report& report = CERR);
 
+        //!
+        //! Maximum number of datagrams which are received in one system call by receiveBatch().
+        //!
+        static constexpr size_t MAX_BATCH_SIZE = 64;
+
+        //!
+        //! Maximum number of datagrams in one message using segmentation offload.
+        //! @see sendSegments()
+        //!
+        static constexpr size_t MAX_SEGMENTS = 64;
+
+        //!
+        //! Description of one datagram in a batched receive operation.
+        //! @see receiveBatch()
+        //!
+        class TSDUCKDLL ReceiveBuffer
+        {
+        public:
+            void*             data;        //!< [in] Address of the buffer for the received message.
+            size_t            max_size;    //!< [in] Size in bytes of the reception buffer.
+            size_t            size;        //!< [out] Size in bytes of the received message.
+            IPv4SocketAddress sender;      //!< [out] Socket address of the sender.
+            IPv4SocketAddress destination; //!< [out] Socket address of the packet destination.
+            MicroSecond       timestamp;   //!< [out] Receive timestamp in micro-seconds, negative if not available.
+            size_t            segment_size;  //!< [out] With receive offload, size of each coalesced datagram in the message, zero if none.
+
+            //!
+            //! Constructor.
+            //! @param [in] data Address of the buffer for the received message.
+            //! @param [in] max_size Size in bytes of the reception buffer.
+            //!
+            ReceiveBuffer(void* data = nullptr, size_t max_size = 0);
+
+            //! @cond nodoxygen
+            ReceiveBuffer(const ReceiveBuffer&) = default;
+            ReceiveBuffer& operator=(const ReceiveBuffer&) = default;
+            //! @endcond
+        };
+
         //!
         //! Destructor.
         //!
@@ -203,6 +242,23 @@ namespace ts {
         //!
         bool setReceiveTimestamps(bool on, Report& report = CERR);
 
+        //!
+        //! Enable or disable the generic receive offload (GRO) for UDP.
+        //!
+        //! When enabled, the system may coalesce several consecutive datagrams of identical
+        //! size from the same sender in one single large message. This reduces the number of
+        //! receive operations. The size of each original datagram is then returned in the
+        //! field @a segment_size of ReceiveBuffer by receiveBatch(). The method receive()
+        //! does not return this information and shall not be used when this option is enabled.
+        //!
+        //! This option is supported on Linux only and is silently ignored on other systems.
+        //!
+        //! @param [in] on If true, the receive offload is activated on the socket. Otherwise, it is disabled.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool setReceiveOffload(bool on, Report& report = CERR);
+
         //!
         //! Enable or disable the broadcast option.
         //!
@@ -303,6 +359,67 @@ namespace ts {
         //!
         virtual bool send(const void* data, size_t size, Report& report = CERR);
 
+        //!
+        //! Send several messages to a destination address and port.
+        //!
+        //! Each message is sent as one distinct datagram. When the operating system
+        //! supports it (Linux), all messages are sent using a minimum number of
+        //! system calls (sendmmsg()). Otherwise, the messages are sent one by one.
+        //!
+        //! @param [in] data Array of @a count addresses of messages to send.
+        //! @param [in] sizes Array of @a count sizes in bytes of the messages to send.
+        //! @param [in] count Number of messages to send.
+        //! @param [in] destination Socket address of the destination.
+        //! Both address and port are mandatory in the socket address, they cannot
+        //! be set to IPv4Address::AnyAddress or IPv4SocketAddress::AnyPort.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool sendBatch(const void* const* data, const size_t* sizes, size_t count, const IPv4SocketAddress& destination, Report& report = CERR);
+
+        //!
+        //! Send several messages to the default destination address and port.
+        //!
+        //! @param [in] data Array of @a count addresses of messages to send.
+        //! @param [in] sizes Array of @a count sizes in bytes of the messages to send.
+        //! @param [in] count Number of messages to send.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see sendBatch(const void* const*, const size_t*, size_t, const IPv4SocketAddress&, Report&)
+        //!
+        virtual bool sendBatch(const void* const* data, const size_t* sizes, size_t count, Report& report = CERR);
+
+        //!
+        //! Send a buffer containing several datagrams of identical size to a destination address and port.
+        //!
+        //! The buffer is split into datagrams of @a segment_size bytes. The last datagram may be shorter.
+        //! When the operating system supports it (Linux), the buffer is passed to the system in as few
+        //! system calls as possible and the segmentation is performed by the kernel or the network
+        //! interface (generic segmentation offload, GSO). Otherwise, the datagrams are sent one by one.
+        //!
+        //! @param [in] data Address of the datagrams to send.
+        //! @param [in] size Total size in bytes of the datagrams to send.
+        //! @param [in] segment_size Size in bytes of each datagram.
+        //! @param [in] destination Socket address of the destination.
+        //! Both address and port are mandatory in the socket address, they cannot
+        //! be set to IPv4Address::AnyAddress or IPv4SocketAddress::AnyPort.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool sendSegments(const void* data, size_t size, size_t segment_size, const IPv4SocketAddress& destination, Report& report = CERR);
+
+        //!
+        //! Send a buffer containing several datagrams of identical size to the default destination address and port.
+        //!
+        //! @param [in] data Address of the datagrams to send.
+        //! @param [in] size Total size in bytes of the datagrams to send.
+        //! @param [in] segment_size Size in bytes of each datagram.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see sendSegments(const void*, size_t, size_t, const IPv4SocketAddress&, Report&)
+        //!
+        virtual bool sendSegments(const void* data, size_t size, size_t segment_size, Report& report = CERR);
+
         //!
         //! Receive a message.
         //!
@@ -330,10 +447,45 @@ namespace ts {
                              Report& report = CERR,
                              MicroSecond* timestamp = nullptr);
 
+        //!
+        //! Receive several messages in one operation.
+        //!
+        //! This method waits for at least one message. Then, all messages which are
+        //! already available are returned, up to @a max_count messages. When the operating
+        //! system supports it (Linux), all messages are received using one single system
+        //! call (recvmmsg()). Otherwise, one message is received at a time.
+        //!
+        //! @param [in,out] buffers Array of @a max_count reception buffers. On input, the
+        //! fields @a data and @a max_size must be set. On output, the other fields describe
+        //! the received messages.
+        //! @param [in] max_count Maximum number of messages to receive. The actual number
+        //! of messages is also limited to MAX_BATCH_SIZE.
+        //! @param [out] ret_count Number of received messages in @a buffers.
+        //! @param [in] abort If non-zero, invoked when I/O is interrupted
+        //! (in case of user-interrupt, return, otherwise retry).
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error. On success, at least one message is returned.
+        //! The returned messages are always in the first @a ret_count elements of @a buffers and
+        //! the data buffer of each element is unchanged. Subclasses which filter messages move
+        //! the content of accepted messages to keep them contiguous in the array.
+        //! @see receive()
+        //!
+        virtual bool receiveBatch(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, const AbortInterface* abort = nullptr, Report& report = CERR);
+
         // Implementation of Socket interface.
         virtual bool open(Report& report = CERR) override;
         virtual bool close(Report& report = CERR) override;
 
+    protected:
+        //!
+        //! Move a received message into another reception buffer.
+        //! This is used to compact an array of reception buffers after removing some messages.
+        //! The message data are copied, the data buffer addresses remain unchanged in @a dest.
+        //! @param [in,out] dest Destination reception buffer. The message is truncated if larger than its buffer.
+        //! @param [in] src Source reception buffer.
+        //!
+        static void MoveReceiveBuffer(ReceiveBuffer& dest, const ReceiveBuffer& src);
+
     private:
         // Encapsulate a Plain Old C Structure.
         template <typename STRUCT>
@@ -389,9 +541,16 @@ namespace ts {
         IPv4SocketAddress _default_destination;
         MReqSet           _mcast;    // Current set of multicast memberships
         SSMReqSet         _ssmcast;  // Current set of source-specific multicast memberships
+        bool              _no_gso;   // Segmentation offload is not supported by the system
 
         // Perform one receive operation. Hide the system mud.
         SysSocketErrorCode receiveOne(void* data, size_t max_size, size_t& ret_size, IPv4SocketAddress& sender, IPv4SocketAddress& destination, Report& report, MicroSecond* timestamp);
+        SysSocketErrorCode receiveMany(ReceiveBuffer* buffers, size_t max_count, size_t& ret_count, Report& report);
+
+#if !defined(TS_WINDOWS)
+        // Analyze the ancillary data of a received message (UNIX only).
+        void getAncillaryData(::msghdr& hdr, IPv4SocketAddress& destination, MicroSecond* timestamp, size_t* segment_size);
+#endif
 
         // Furiously idiotic Windows feature, see comment in receiveOne()
 #if defined(TS_WINDOWS)
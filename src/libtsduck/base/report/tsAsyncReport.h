@@ -35,7 +35,7 @@
 #pragma once
 #include "tsReport.h"
 #include "tsAsyncReportArgs.h"
-#include "tsMessageQueue.h"
+#include "tsLockFreeMessageQueue.h"
 #include "tsNullMutex.h"
 #include "tsThread.h"
 
@@ -144,7 +144,7 @@ namespace ts {
             UString message;
         };
         typedef SafePtr <LogMessage, NullMutex> LogMessagePtr;
-        typedef MessageQueue <LogMessage, NullMutex> LogMessageQueue;
+        typedef LockFreeMessageQueue <LogMessage, NullMutex> LogMessageQueue;
 
         // Private members:
         LogMessageQueue _log_queue;
@@ -49,10 +49,14 @@ namespace ts {
         //!
         //! Constructor, based on required amount of elements.
         //! Abort application if memory allocation fails.
-        //! Do not abort if memory locking fails.
+        //! Do not abort if memory locking, huge pages or NUMA placement fail.
         //! @param [in] elem_count Number of @a T elements.
+        //! @param [in] huge_pages If true, try to back the buffer with huge memory pages
+        //! to reduce TLB misses. Currently implemented on Linux only.
+        //! @param [in] numa_node If not negative, allocate the buffer on this NUMA node.
+        //! Currently implemented on Linux only.
         //!
-        ResidentBuffer(size_t elem_count);
+        ResidentBuffer(size_t elem_count, bool huge_pages = false, int numa_node = -1);
 
         //!
         //! Destructor.
@@ -77,6 +81,27 @@ namespace ts {
             return _error_code;
         }
 
+        //!
+        //! Check if the buffer is backed by huge memory pages.
+        //! @return True if the buffer was successfully allocated using huge memory pages.
+        //! On Linux, when no huge page is reserved in the system, the buffer is allocated
+        //! using transparent huge pages when possible and this method returns true.
+        //!
+        bool isHugePages() const
+        {
+            return _huge_pages;
+        }
+
+        //!
+        //! Get the NUMA node of the buffer.
+        //! @return The NUMA node on which the buffer was allocated or a negative value
+        //! if no NUMA node was requested or the NUMA placement failed.
+        //!
+        int numaNode() const
+        {
+            return _numa_node;
+        }
+
         //!
         //! Return base address of the buffer.
         //! @return The address of the first @a T element in the buffer.
@@ -103,7 +128,13 @@ namespace ts {
         size_t    _locked_size;      // Locked size (mlock, multiple of page size)
         size_t    _elem_count;       // Element count in locked region
         bool      _is_locked;        // False if mlock failed.
+        bool      _is_mapped;        // Memory was directly mapped (mmap), not allocated in the heap.
+        bool      _huge_pages;       // Memory is backed by huge pages.
+        int       _numa_node;        // NUMA node of the memory or -1.
         SysErrorCode _error_code;       // Lock error code
+
+        // Directly map memory pages with huge pages and/or NUMA placement.
+        void mapPages(size_t requested_size, size_t page_size, bool huge_pages, int numa_node);
     };
 }
 
@@ -45,7 +45,7 @@
 //----------------------------------------------------------------------------
 
 template <typename T>
-ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count) :
+ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count, bool huge_pages, int numa_node) :
     _allocated_base(nullptr),
     _locked_base(nullptr),
     _base(nullptr),
@@ -53,23 +53,36 @@ ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count) :
     _locked_size(0),
     _elem_count(elem_count),
     _is_locked(false),
+    _is_mapped(false),
+    _huge_pages(false),
+    _numa_node(-1),
     _error_code(SYS_SUCCESS)
 {
     const size_t requested_size = elem_count * sizeof(T);
     const size_t page_size = SysInfo::Instance()->memoryPageSize();
 
-    // Allocate enough space to include memory pages around the requested size
-
-    _allocated_size = requested_size + 2 * page_size;
-    _allocated_base = new char[_allocated_size];
+    // With huge pages or NUMA placement, allocate whole pages from the system.
+    if (huge_pages || numa_node >= 0) {
+        mapPages(requested_size, page_size, huge_pages, numa_node);
+    }
 
-    // Locked space starts at next page boundary after allocated base:
-    // Its size is the next multiple of page size after requested_size:
-    // Be sure to use size_t (unsigned) instead of ptrdiff_t (signed)
-    // to perform arithmetics on pointers because we use modulo operations.
+    if (_is_mapped) {
+        // The mapped area is already aligned.
+        _locked_base = _allocated_base;
+    }
+    else {
+        // Allocate enough space to include memory pages around the requested size
+        _allocated_size = requested_size + 2 * page_size;
+        _allocated_base = new char[_allocated_size];
+
+        // Locked space starts at next page boundary after allocated base:
+        // Be sure to use size_t (unsigned) instead of ptrdiff_t (signed)
+        // to perform arithmetics on pointers because we use modulo operations.
+        assert(sizeof(size_t) == sizeof(char_ptr));
+        _locked_base = char_ptr(round_up(size_t(_allocated_base), page_size));
+    }
 
-    assert(sizeof(size_t) == sizeof(char_ptr));
-    _locked_base = char_ptr(round_up(size_t(_allocated_base), page_size));
+    // Locked size is the next multiple of page size after requested_size:
     _locked_size = round_up(requested_size, page_size);
 
     _base = new (_locked_base) T[elem_count];
@@ -77,7 +90,7 @@ ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count) :
     // Integrity checks
 
     assert(_allocated_base <= _locked_base);
-    assert(_locked_base < _allocated_base + page_size);
+    assert(_is_mapped || _locked_base < _allocated_base + page_size);
     assert(_locked_base + _locked_size <= _allocated_base + _allocated_size);
     assert(requested_size <= _locked_size);
     assert(_locked_size <= _allocated_size);
@@ -121,6 +134,61 @@ ts::ResidentBuffer<T>::ResidentBuffer(size_t elem_count) :
 }
 
 
+//----------------------------------------------------------------------------
+// Directly map memory pages with huge pages and/or NUMA placement.
+// Leave _allocated_base null on error, fallback to heap allocation.
+//----------------------------------------------------------------------------
+
+template <typename T>
+void ts::ResidentBuffer<T>::mapPages(size_t requested_size, size_t page_size, bool huge_pages, int numa_node)
+{
+#if defined(TS_LINUX)
+
+    const size_t huge_size = huge_pages ? SysInfo::Instance()->hugePageSize() : 0;
+    void* addr = MAP_FAILED;
+
+    // First, try explicit huge pages. This fails when no huge page is reserved in the system.
+    if (huge_size > 0) {
+        _allocated_size = round_up(requested_size, huge_size);
+        addr = ::mmap(nullptr, _allocated_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        _huge_pages = addr != MAP_FAILED;
+    }
+
+    // Then, use normal pages, aligned on huge page boundary for transparent huge pages.
+    if (addr == MAP_FAILED) {
+        const size_t align = std::max(huge_size, page_size);
+        _allocated_size = round_up(requested_size, align) + align - page_size;
+        addr = ::mmap(nullptr, _allocated_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            _allocated_size = 0;
+            return;
+        }
+        // Unmap the unaligned parts before and after the aligned area.
+        const size_t aligned = round_up(size_t(addr), align);
+        const size_t size = round_up(requested_size, align);
+        if (aligned > size_t(addr)) {
+            ::munmap(addr, aligned - size_t(addr));
+        }
+        if (size_t(addr) + _allocated_size > aligned + size) {
+            ::munmap(char_ptr(aligned + size), size_t(addr) + _allocated_size - aligned - size);
+        }
+        addr = char_ptr(aligned);
+        _allocated_size = size;
+        _huge_pages = huge_size > 0 && ::madvise(addr, _allocated_size, MADV_HUGEPAGE) == 0;
+    }
+
+    _allocated_base = char_ptr(addr);
+    _is_mapped = true;
+
+    // Set the NUMA node before touching the memory (the placement-new and mlock do).
+    if (numa_node >= 0 && SetMemoryNumaNode(addr, _allocated_size, numa_node)) {
+        _numa_node = numa_node;
+    }
+
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Destructor
 //----------------------------------------------------------------------------
@@ -138,9 +206,14 @@ ts::ResidentBuffer<T>::~ResidentBuffer<T>()
     }
 
     // Free memory
-    if (_allocated_base != nullptr) {
+    if (_allocated_base != nullptr && !_is_mapped) {
         delete[] _allocated_base;
     }
+#if defined(TS_LINUX)
+    if (_allocated_base != nullptr && _is_mapped) {
+        ::munmap(_allocated_base, _allocated_size);
+    }
+#endif
 
     // Reset state (it explicit call of destructor)
     _allocated_base = nullptr;
@@ -150,4 +223,7 @@ ts::ResidentBuffer<T>::~ResidentBuffer<T>()
     _locked_size = 0;
     _elem_count = 0;
     _is_locked = false;
+    _is_mapped = false;
+    _huge_pages = false;
+    _numa_node = -1;
 }
@@ -99,7 +99,8 @@ ts::SysInfo::SysInfo() :
 #else
     _cpuName(u"unknown CPU"),
 #endif
-    _memoryPageSize(0)
+    _memoryPageSize(0),
+    _hugePageSize(0)
 {
     //
     // Get operating system name and version.
@@ -241,5 +242,24 @@ ts::SysInfo::SysInfo() :
         _memoryPageSize = size_t(pageSize);
     }
 
+#endif
+
+    //
+    // Get default huge page size.
+    //
+#if defined(TS_LINUX)
+
+    // Line "Hugepagesize: 2048 kB" in /proc/meminfo.
+    UStringList meminfo;
+    if (UString::Load(meminfo, u"/proc/meminfo")) {
+        for (const auto& line : meminfo) {
+            size_t size = 0;
+            if (line.startWith(u"Hugepagesize:") && line.substr(13).toRemoved(u"kB").toInteger(size)) {
+                _hugePageSize = size * 1024;
+                break;
+            }
+        }
+    }
+
 #endif
 }
@@ -122,6 +122,12 @@ namespace ts {
         //! @return The system memory page size in bytes.
         //!
         size_t memoryPageSize() const { return _memoryPageSize; }
+        //!
+        //! Get the default size of huge memory pages.
+        //! @return The default size in bytes of huge memory pages or zero if huge pages
+        //! are not supported by TSDuck on this system (currently Linux only).
+        //!
+        size_t hugePageSize() const { return _hugePageSize; }
 
     private:
         bool    _isLinux;
@@ -139,5 +145,6 @@ namespace ts {
         UString _hostName;
         UString _cpuName;
         size_t  _memoryPageSize;
+        size_t  _hugePageSize;
     };
 }
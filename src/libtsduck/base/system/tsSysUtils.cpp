@@ -41,6 +41,8 @@
 
 #if defined(TS_LINUX)
 #include "tsFileUtils.h"
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
 #endif
 
 #if defined(TS_MAC)
@@ -408,6 +410,76 @@ void ts::GetProcessMetrics(ProcessMetrics& metrics)
 }
 
 
+//----------------------------------------------------------------------------
+// Get the CPU time of the calling thread.
+//----------------------------------------------------------------------------
+
+ts::NanoSecond ts::GetThreadCPUTime()
+{
+#if defined(TS_WINDOWS)
+    // Thread times are in units of 100 nanoseconds.
+    ::FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (::GetThreadTimes(::GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time) != 0) {
+        const uint64_t kernel = (uint64_t(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+        const uint64_t user = (uint64_t(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+        return NanoSecond(kernel + user) * 100;
+    }
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+    ::timespec ts;
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return NanoSecond(ts.tv_sec) * NanoSecPerSec + NanoSecond(ts.tv_nsec);
+    }
+#endif
+    return -1;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the NUMA node of a CPU.
+//----------------------------------------------------------------------------
+
+int ts::GetCPUNumaNode(size_t cpu)
+{
+#if defined(TS_LINUX)
+    // The CPU directory in sysfs contains a link "nodeN" to its NUMA node.
+    const UString dir(UString::Format(u"/sys/devices/system/cpu/cpu%d/", {cpu}));
+    UStringVector nodes;
+    int node = -1;
+    if (ExpandWildcard(nodes, dir + u"node*") && !nodes.empty() && nodes[0].substr(dir.size() + 4).toInteger(node) && node >= 0) {
+        return node;
+    }
+#endif
+    return -1;
+}
+
+
+//----------------------------------------------------------------------------
+// Set the preferred NUMA node of a memory area.
+//----------------------------------------------------------------------------
+
+bool ts::SetMemoryNumaNode(void* address, size_t size, int node)
+{
+#if defined(TS_LINUX) && defined(SYS_mbind)
+    // Use the system call directly, avoid a dependency on libnuma.
+    constexpr size_t bits_per_long = 8 * sizeof(unsigned long);
+    unsigned long mask[1024 / bits_per_long];
+    if (node < 0 || size_t(node) >= 8 * sizeof(mask)) {
+        errno = EINVAL;
+        return false;
+    }
+    TS_ZERO(mask);
+    mask[size_t(node) / bits_per_long] = 1UL << (size_t(node) % bits_per_long);
+    return ::syscall(SYS_mbind, address, size, MPOL_PREFERRED, mask, 8 * sizeof(mask), 0) == 0;
+#elif defined(TS_WINDOWS)
+    ::SetLastError(ERROR_NOT_SUPPORTED);
+    return false;
+#else
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Ignore SIGPIPE. On UNIX systems: writing to a broken pipe returns an
 // error instead of killing the process. On Windows systems: does nothing.
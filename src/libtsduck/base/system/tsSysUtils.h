@@ -320,6 +320,35 @@ namespace ts {
     //!
     TSDUCKDLL void GetProcessMetrics(ProcessMetrics& metrics);
 
+    //!
+    //! Get the CPU time of the calling thread.
+    //! @return CPU time of the calling thread in nanoseconds (user and system time)
+    //! or a negative value if not available on this system.
+    //!
+    TSDUCKDLL NanoSecond GetThreadCPUTime();
+
+    //!
+    //! Get the NUMA node of a CPU.
+    //! @param [in] cpu CPU index, as used in ts::ThreadAttributes::setCPUs().
+    //! @return The NUMA node of the CPU or a negative value if unknown or not supported
+    //! on this system (currently implemented on Linux only).
+    //!
+    TSDUCKDLL int GetCPUNumaNode(size_t cpu);
+
+    //!
+    //! Set the preferred NUMA node of a memory area.
+    //! The memory pages are allocated on this node when they are first accessed.
+    //! Pages which are already allocated are not moved. When the node runs out of
+    //! memory, the pages are allocated on other nodes.
+    //! @param [in] address Address of the memory area, must be aligned on a page boundary.
+    //! @param [in] size Size in bytes of the memory area.
+    //! @param [in] node NUMA node.
+    //! @return True on success, false on error. In case of error, use LastSysErrorCode()
+    //! to get the error code. Always return false on systems without NUMA support in TSDuck
+    //! (currently implemented on Linux only).
+    //!
+    TSDUCKDLL bool SetMemoryNumaNode(void* address, size_t size, int node);
+
     //!
     //! Ensure that writing to a broken pipe does not kill the current process.
     //!
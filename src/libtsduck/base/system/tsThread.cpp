@@ -213,6 +213,20 @@ bool ts::Thread::start()
         return false;
     }
 
+    // Set the CPU affinity (Windows affinity masks are limited to the first 64 CPU's).
+    if (!_attributes._cpus.empty()) {
+        ::DWORD_PTR mask = 0;
+        for (auto cpu : _attributes._cpus) {
+            if (cpu < 8 * sizeof(mask)) {
+                mask |= ::DWORD_PTR(1) << cpu;
+            }
+        }
+        if (mask != 0 && ::SetThreadAffinityMask(_handle, mask) == 0) {
+            ::CloseHandle(_handle);
+            return false;
+        }
+    }
+
     // Release the thread
     if (::ResumeThread(_handle) == ::DWORD(-1)) {
         ::CloseHandle(_handle);
@@ -263,6 +277,23 @@ bool ts::Thread::start()
     }
 #endif
 
+    // Set the CPU affinity. Not available on Android.
+#if defined(TS_LINUX) && !defined(__ANDROID__)
+    if (!_attributes._cpus.empty()) {
+        ::cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto cpu : _attributes._cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (::pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) != 0) {
+            ::pthread_attr_destroy(&attr);
+            return false;
+        }
+    }
+#endif
+
     // Create the thread
     if (::pthread_create(&_pthread, &attr, Thread::ThreadProc, this) != 0) {
         ::pthread_attr_destroy(&attr);
@@ -154,7 +154,8 @@ ts::ThreadAttributes::ThreadAttributes() :
     _stackSize(0),
     _deleteWhenTerminated(false),
     _priority(0),
-    _name()
+    _name(),
+    _cpus()
 {
     if (!_priorityInitialized) {
         InitializePriorities();
@@ -208,6 +208,38 @@ namespace ts {
             return _priority;
         }
 
+        //!
+        //! Set the CPU affinity of the thread.
+        //!
+        //! The thread will run only on the specified CPU's. CPU's are identified by their
+        //! index, starting at zero, as in the @c taskset command on Linux. An empty set
+        //! means no affinity: the thread can run on any CPU (the default).
+        //!
+        //! The CPU affinity is implemented on Linux and Windows (CPU's 0 to 63 only).
+        //! It is ignored on other systems. On Linux, starting a thread fails when none
+        //! of the specified CPU's is available to the process.
+        //!
+        //! @param [in] cpus Set of CPU indexes.
+        //! @return A reference to this object.
+        //!
+        ThreadAttributes& setCPUs(const std::set<size_t>& cpus)
+        {
+            _cpus = cpus;
+            return *this;
+        }
+
+        //!
+        //! Get the CPU affinity of the thread.
+        //!
+        //! @return The set of CPU indexes the thread can run on.
+        //! An empty set means no affinity.
+        //! @see setCPUs()
+        //!
+        std::set<size_t> getCPUs() const
+        {
+            return _cpus;
+        }
+
         //!
         //! Get the minimum priority for a thread in this context of the operating system.
         //! @return The minimum priority for a thread.
@@ -266,6 +298,7 @@ namespace ts {
         bool    _deleteWhenTerminated;
         int     _priority;
         UString _name;
+        std::set<size_t> _cpus;
 
         //
         // These fields describe the operating system priority range.
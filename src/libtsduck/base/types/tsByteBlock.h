@@ -35,6 +35,7 @@
 #pragma once
 #include "tsMemory.h"
 #include "tsSafePtr.h"
+#include "tsPoolAllocated.h"
 
 namespace ts {
 
@@ -45,9 +46,11 @@ namespace ts {
     //! Definition of a generic block of bytes.
     //!
     //! This is a subclass of @c std::vector on @c uint8_t.
+    //! The ByteBlock objects are allocated in the memory pool. The content of the
+    //! vector is allocated on the heap.
     //! @ingroup cpp
     //!
-    class ByteBlock : public std::vector<uint8_t>
+    class ByteBlock : public std::vector<uint8_t>, public PoolAllocated
     {
     public:
         // Implementation note: This class is exported out of the TSDuck library
@@ -0,0 +1,430 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "tsMemoryPool.h"
+#include "tsGuardMutex.h"
+#include "tsMutex.h"
+
+// Constructor of the allocation counters.
+ts::MemoryPool::Statistics::Statistics() :
+    allocations(0),
+    deallocations(0),
+    heap_allocations(0),
+    depot_transfers(0),
+    slab_bytes(0)
+{
+}
+
+#if defined(TS_NO_MEMORY_POOL)
+
+//----------------------------------------------------------------------------
+// Memory pool disabled at compile time, use the heap.
+//----------------------------------------------------------------------------
+
+namespace {
+    std::atomic<uint64_t> heap_allocations(0);
+}
+
+void* ts::MemoryPool::Allocate(size_t size)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void ts::MemoryPool::Deallocate(void* ptr, size_t size)
+{
+    ::operator delete(ptr);
+}
+
+ts::MemoryPool::Statistics ts::MemoryPool::GetStatistics()
+{
+    Statistics stats;
+    stats.heap_allocations = heap_allocations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+#else
+
+//----------------------------------------------------------------------------
+// Internal classes of the memory pool.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Number of size classes.
+    constexpr size_t CLASS_COUNT = ts::MemoryPool::MAX_BLOCK_SIZE / ts::MemoryPool::BLOCK_GRANULARITY;
+
+    // Number of blocks which are transferred at once between a thread cache and the depot.
+    constexpr size_t BATCH_SIZE = 32;
+
+    // Maximum number of free blocks per size class in a thread cache.
+    constexpr size_t CACHE_MAX = 4 * BATCH_SIZE;
+
+    // Size of the slabs which are allocated from the heap.
+    constexpr size_t SLAB_SIZE = 64 * 1024;
+
+    // Size class of a block and block size of a size class.
+    inline size_t SizeClass(size_t size)
+    {
+        return size == 0 ? 0 : (size - 1) / ts::MemoryPool::BLOCK_GRANULARITY;
+    }
+    inline size_t BlockSize(size_t cls)
+    {
+        return (cls + 1) * ts::MemoryPool::BLOCK_GRANULARITY;
+    }
+
+    // A free block is linked to the next one in its first bytes.
+    class FreeBlock
+    {
+    public:
+        FreeBlock* next;
+    };
+
+    // A counter which is incremented by one single thread and read from any thread.
+    // No need for an atomic read-modify-write operation, which is more expensive.
+    class Counter
+    {
+    public:
+        Counter() : _value(0) {}
+        void increment() { _value.store(_value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+        uint64_t value() const { return _value.load(std::memory_order_relaxed); }
+    private:
+        std::atomic<uint64_t> _value;
+    };
+
+    class ThreadCache;
+
+    // The global depot of free blocks, shared by all threads.
+    // There is one single instance which is never deleted. This is required since objects
+    // which are statically allocated can be deleted after the end of the main thread.
+    class Depot
+    {
+        TS_NOCOPY(Depot);
+    public:
+        // Get the instance of the depot.
+        static Depot* Instance();
+
+        // Get a list of up to BATCH_SIZE free blocks of a size class. Never empty.
+        FreeBlock* get(size_t cls, size_t& count);
+
+        // Return a list of free blocks of a size class.
+        void put(size_t cls, FreeBlock* first, FreeBlock* last);
+
+        // Allocate and deallocate one block when there is no thread cache.
+        void* allocate(size_t cls);
+        void deallocate(void* ptr, size_t cls);
+
+        // Register and unregister a thread cache for the statistics.
+        void registerCache(ThreadCache* cache);
+        void unregisterCache(ThreadCache* cache);
+
+        // Get the global statistics.
+        ts::MemoryPool::Statistics statistics();
+
+        // Number of allocations which use the heap.
+        std::atomic<uint64_t> heap_allocations;
+
+    private:
+        ts::Mutex                  _mutex;
+        FreeBlock*                 _free[CLASS_COUNT];   // lists of free blocks
+        uint8_t*                   _slab;                // current slab
+        size_t                     _slab_remain;         // remaining bytes in current slab
+        ts::MemoryPool::Statistics _stats;               // statistics of depot and terminated threads
+        std::set<ThreadCache*>     _caches;              // active thread caches
+
+        // Constructor.
+        Depot();
+
+        // Get a list of up to BATCH_SIZE free blocks, mutex already held.
+        FreeBlock* getLocked(size_t cls, size_t& count);
+    };
+
+    // A cache of free blocks per thread, used without synchronization.
+    class ThreadCache
+    {
+        TS_NOCOPY(ThreadCache);
+    public:
+        ThreadCache();
+        ~ThreadCache();
+
+        void* allocate(size_t cls);
+        void deallocate(void* ptr, size_t cls);
+
+        // Statistics of the thread.
+        Counter allocations;
+        Counter deallocations;
+        Counter depot_transfers;
+
+    private:
+        Depot*     _depot;
+        FreeBlock* _free[CLASS_COUNT];   // lists of free blocks
+        size_t     _count[CLASS_COUNT];  // number of blocks in each list
+    };
+
+    // The cache of the current thread. The boolean is set when the cache is destroyed
+    // at the end of the thread. After that, deallocations in the thread use the depot.
+    thread_local ThreadCache tls_cache;
+    thread_local bool tls_cache_deleted = false;
+}
+
+
+//----------------------------------------------------------------------------
+// Global depot of free blocks.
+//----------------------------------------------------------------------------
+
+Depot::Depot() :
+    heap_allocations(0),
+    _mutex(),
+    _free(),
+    _slab(nullptr),
+    _slab_remain(0),
+    _stats(),
+    _caches()
+{
+}
+
+Depot* Depot::Instance()
+{
+    // Thread-safe initialization, never deleted.
+    static Depot* const instance = new Depot;
+    return instance;
+}
+
+FreeBlock* Depot::getLocked(size_t cls, size_t& count)
+{
+    FreeBlock* first = _free[cls];
+    count = 0;
+
+    if (first != nullptr) {
+        // Detach up to BATCH_SIZE blocks from the free list.
+        FreeBlock* last = first;
+        count = 1;
+        while (count < BATCH_SIZE && last->next != nullptr) {
+            last = last->next;
+            count++;
+        }
+        _free[cls] = last->next;
+        last->next = nullptr;
+    }
+    else {
+        // Carve new blocks from the current slab, allocate a new slab if too small.
+        const size_t size = BlockSize(cls);
+        if (_slab_remain < size) {
+            _slab = reinterpret_cast<uint8_t*>(::operator new(SLAB_SIZE));
+            _slab_remain = SLAB_SIZE;
+            _stats.slab_bytes += SLAB_SIZE;
+        }
+        count = std::min(BATCH_SIZE, _slab_remain / size);
+        for (size_t i = 0; i < count; ++i) {
+            reinterpret_cast<FreeBlock*>(_slab + i * size)->next = i + 1 < count ? reinterpret_cast<FreeBlock*>(_slab + (i + 1) * size) : nullptr;
+        }
+        first = reinterpret_cast<FreeBlock*>(_slab);
+        _slab += count * size;
+        _slab_remain -= count * size;
+    }
+    return first;
+}
+
+FreeBlock* Depot::get(size_t cls, size_t& count)
+{
+    ts::GuardMutex lock(_mutex);
+    return getLocked(cls, count);
+}
+
+void Depot::put(size_t cls, FreeBlock* first, FreeBlock* last)
+{
+    ts::GuardMutex lock(_mutex);
+    last->next = _free[cls];
+    _free[cls] = first;
+}
+
+void* Depot::allocate(size_t cls)
+{
+    ts::GuardMutex lock(_mutex);
+    size_t count = 0;
+    FreeBlock* first = getLocked(cls, count);
+    if (first->next != nullptr) {
+        // Return the rest of the list to the depot.
+        FreeBlock* last = first->next;
+        while (last->next != nullptr) {
+            last = last->next;
+        }
+        last->next = _free[cls];
+        _free[cls] = first->next;
+    }
+    _stats.allocations++;
+    return first;
+}
+
+void Depot::deallocate(void* ptr, size_t cls)
+{
+    ts::GuardMutex lock(_mutex);
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(ptr);
+    block->next = _free[cls];
+    _free[cls] = block;
+    _stats.deallocations++;
+}
+
+void Depot::registerCache(ThreadCache* cache)
+{
+    ts::GuardMutex lock(_mutex);
+    _caches.insert(cache);
+}
+
+void Depot::unregisterCache(ThreadCache* cache)
+{
+    ts::GuardMutex lock(_mutex);
+    _caches.erase(cache);
+    _stats.allocations += cache->allocations.value();
+    _stats.deallocations += cache->deallocations.value();
+    _stats.depot_transfers += cache->depot_transfers.value();
+}
+
+ts::MemoryPool::Statistics Depot::statistics()
+{
+    ts::GuardMutex lock(_mutex);
+    ts::MemoryPool::Statistics stats(_stats);
+    stats.heap_allocations = heap_allocations.load(std::memory_order_relaxed);
+    for (const auto& cache : _caches) {
+        stats.allocations += cache->allocations.value();
+        stats.deallocations += cache->deallocations.value();
+        stats.depot_transfers += cache->depot_transfers.value();
+    }
+    return stats;
+}
+
+
+//----------------------------------------------------------------------------
+// Cache of free blocks per thread.
+//----------------------------------------------------------------------------
+
+ThreadCache::ThreadCache() :
+    allocations(),
+    deallocations(),
+    depot_transfers(),
+    _depot(Depot::Instance()),
+    _free(),
+    _count()
+{
+    _depot->registerCache(this);
+}
+
+ThreadCache::~ThreadCache()
+{
+    // Return all free blocks to the depot.
+    for (size_t cls = 0; cls < CLASS_COUNT; ++cls) {
+        if (_free[cls] != nullptr) {
+            FreeBlock* last = _free[cls];
+            while (last->next != nullptr) {
+                last = last->next;
+            }
+            _depot->put(cls, _free[cls], last);
+            _free[cls] = nullptr;
+            _count[cls] = 0;
+        }
+    }
+    _depot->unregisterCache(this);
+    tls_cache_deleted = true;
+}
+
+void* ThreadCache::allocate(size_t cls)
+{
+    FreeBlock* block = _free[cls];
+    if (block == nullptr) {
+        // Empty cache, get a batch of free blocks from the depot.
+        block = _depot->get(cls, _count[cls]);
+        depot_transfers.increment();
+    }
+    _free[cls] = block->next;
+    _count[cls]--;
+    allocations.increment();
+    return block;
+}
+
+void ThreadCache::deallocate(void* ptr, size_t cls)
+{
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(ptr);
+    block->next = _free[cls];
+    _free[cls] = block;
+    _count[cls]++;
+    deallocations.increment();
+
+    if (_count[cls] > CACHE_MAX) {
+        // Too many free blocks in the cache, return a batch of blocks to the depot.
+        FreeBlock* last = block;
+        for (size_t i = 1; i < BATCH_SIZE; ++i) {
+            last = last->next;
+        }
+        _free[cls] = last->next;
+        _count[cls] -= BATCH_SIZE;
+        _depot->put(cls, block, last);
+        depot_transfers.increment();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Public interface of the memory pool.
+//----------------------------------------------------------------------------
+
+void* ts::MemoryPool::Allocate(size_t size)
+{
+    if (size > MAX_BLOCK_SIZE) {
+        Depot::Instance()->heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    else if (tls_cache_deleted) {
+        return Depot::Instance()->allocate(SizeClass(size));
+    }
+    else {
+        return tls_cache.allocate(SizeClass(size));
+    }
+}
+
+void ts::MemoryPool::Deallocate(void* ptr, size_t size)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    else if (size > MAX_BLOCK_SIZE) {
+        ::operator delete(ptr);
+    }
+    else if (tls_cache_deleted) {
+        Depot::Instance()->deallocate(ptr, SizeClass(size));
+    }
+    else {
+        tls_cache.deallocate(ptr, SizeClass(size));
+    }
+}
+
+ts::MemoryPool::Statistics ts::MemoryPool::GetStatistics()
+{
+    return Depot::Instance()->statistics();
+}
+
+#endif
@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Pool allocator for small and frequently allocated objects.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Pool allocator for small and frequently allocated objects.
+    //! @ingroup cpp
+    //!
+    //! Demuxing sections or PES packets allocates and deallocates several small objects
+    //! per section or packet: the section object, its ByteBlock and the control blocks of
+    //! the corresponding safe pointers. This class is a slab allocator for these objects.
+    //! Classes which should use it derive from ts::PoolAllocated.
+    //!
+    //! Blocks are grouped by size classes, in multiples of BLOCK_GRANULARITY bytes, up to
+    //! MAX_BLOCK_SIZE bytes. Larger allocations are directly passed to the heap. Each thread
+    //! keeps a cache of free blocks per size class which is used without synchronization.
+    //! A block which is deallocated in a thread returns to the cache of this thread, even
+    //! if it was allocated by another thread. When a cache is empty or too large, blocks
+    //! are transferred in batches from or to a global depot. When the depot is empty,
+    //! new blocks are carved from large slabs which are allocated on the heap.
+    //!
+    //! The memory of the slabs is never returned to the system. The pool keeps the
+    //! high-water mark of the memory which was used by small objects.
+    //!
+    //! When TSDuck is compiled with @c TS_NO_MEMORY_POOL (<code>make NOMEMPOOL=1</code>),
+    //! all allocations are passed to the heap. This can be useful with memory checkers.
+    //!
+    class TSDUCKDLL MemoryPool
+    {
+    public:
+        //!
+        //! Granularity in bytes of the size classes.
+        //!
+        static constexpr size_t BLOCK_GRANULARITY = 16;
+        //!
+        //! Maximum size in bytes of the blocks in the pool. Larger allocations use the heap.
+        //!
+        static constexpr size_t MAX_BLOCK_SIZE = 512;
+
+        //!
+        //! Allocate a memory block.
+        //! @param [in] size Size in bytes of the block.
+        //! @return Address of the block. Never null, std::bad_alloc is thrown on error.
+        //!
+        static void* Allocate(size_t size);
+
+        //!
+        //! Deallocate a memory block.
+        //! @param [in] ptr Address of a block which was returned by Allocate(). Ignored if null.
+        //! @param [in] size Size in bytes of the block, same as in Allocate().
+        //!
+        static void Deallocate(void* ptr, size_t size);
+
+        //!
+        //! Allocation counters of the memory pool.
+        //! All counters are cumulated since the start of the application.
+        //!
+        class TSDUCKDLL Statistics
+        {
+        public:
+            uint64_t allocations;       //!< Number of allocations in the pool.
+            uint64_t deallocations;     //!< Number of deallocations in the pool.
+            uint64_t heap_allocations;  //!< Number of allocations which were too large for the pool and used the heap.
+            uint64_t depot_transfers;   //!< Number of batches of blocks which were transferred between a thread cache and the depot.
+            uint64_t slab_bytes;        //!< Total size in bytes of the slabs which were allocated from the heap.
+            //!
+            //! Constructor.
+            //!
+            Statistics();
+        };
+
+        //!
+        //! Get the allocation counters of the memory pool.
+        //! This is informational only. Counters from other threads may be slightly out of date.
+        //! @return The allocation counters of all threads.
+        //!
+        static Statistics GetStatistics();
+    };
+}
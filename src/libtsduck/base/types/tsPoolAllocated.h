@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Base class for objects which are allocated in the memory pool.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMemoryPool.h"
+
+namespace ts {
+    //!
+    //! Base class for objects which are allocated in the memory pool.
+    //! @ingroup cpp
+    //!
+    //! A subclass of PoolAllocated is allocated by the operator @c new in ts::MemoryPool instead of the heap.
+    //! This class has no data member and no virtual method. It does not modify the memory layout of its subclasses.
+    //! The size of the object is passed to the operator @c delete. When a subclass is deleted through a pointer
+    //! to one of its base classes, this base class must have a virtual destructor.
+    //!
+    //! Arrays of objects are not affected and still use the heap.
+    //!
+    class TSDUCKDLL PoolAllocated
+    {
+    public:
+        //!
+        //! Allocate an object in the memory pool.
+        //! @param [in] size Size in bytes of the object.
+        //! @return Address of the object.
+        //!
+        static void* operator new(size_t size) { return MemoryPool::Allocate(size); }
+
+        //!
+        //! Deallocate an object from the memory pool.
+        //! @param [in] ptr Address of the object.
+        //! @param [in] size Size in bytes of the object.
+        //!
+        static void operator delete(void* ptr, size_t size) { MemoryPool::Deallocate(ptr, size); }
+
+        //!
+        //! Placement new, the object is not allocated in the memory pool.
+        //! @param [in] ptr Address where to build the object.
+        //! @return @a ptr.
+        //!
+        static void* operator new(size_t, void* ptr) noexcept { return ptr; }
+
+        //!
+        //! Placement delete, matching the placement new.
+        //!
+        static void operator delete(void*, void*) noexcept {}
+
+    protected:
+        //!
+        //! Protected destructor, an object cannot be deleted through a pointer to PoolAllocated.
+        //!
+        ~PoolAllocated() = default;
+    };
+}
@@ -38,8 +38,68 @@
 #include "tsGuardMutex.h"
 #include "tsMutex.h"
 #include "tsNullMutex.h"
+#include "tsPoolAllocated.h"
 
 namespace ts {
+
+    //! @cond nodoxygen
+    // Internal state of a SafePtr, shared by all safe pointers to the same object: the
+    // pointer to the object and the reference count. The synchronization depends on the
+    // MUTEX type. The generic version uses the mutex. The specializations do not need
+    // synchronization (NullMutex) or use lock-free atomic variables (Mutex).
+    template <typename T, class MUTEX>
+    class SafePtrState
+    {
+        TS_NOBUILD_NOCOPY(SafePtrState);
+    public:
+        explicit SafePtrState(T* p) : _ptr(p), _ref_count(1), _mutex() {}
+        T* get() { GuardMutex lock(_mutex); return _ptr; }
+        T* exchange(T* p) { GuardMutex lock(_mutex); T* previous = _ptr; _ptr = p; return previous; }
+        bool clearIf(T* p) { GuardMutex lock(_mutex); const bool same = _ptr == p; if (same) { _ptr = nullptr; } return same; }
+        int count() { GuardMutex lock(_mutex); return _ref_count; }
+        void attach() { GuardMutex lock(_mutex); _ref_count++; }
+        int detach() { GuardMutex lock(_mutex); return --_ref_count; }
+    private:
+        T*    _ptr;        // pointer to actual object
+        int   _ref_count;  // reference counter
+        MUTEX _mutex;      // protect the state
+    };
+
+    template <typename T>
+    class SafePtrState<T, NullMutex>
+    {
+        TS_NOBUILD_NOCOPY(SafePtrState);
+    public:
+        explicit SafePtrState(T* p) : _ptr(p), _ref_count(1) {}
+        T* get() { return _ptr; }
+        T* exchange(T* p) { T* previous = _ptr; _ptr = p; return previous; }
+        bool clearIf(T* p) { const bool same = _ptr == p; if (same) { _ptr = nullptr; } return same; }
+        int count() { return _ref_count; }
+        void attach() { _ref_count++; }
+        int detach() { return --_ref_count; }
+    private:
+        T*  _ptr;        // pointer to actual object
+        int _ref_count;  // reference counter
+    };
+
+    template <typename T>
+    class SafePtrState<T, Mutex>
+    {
+        TS_NOBUILD_NOCOPY(SafePtrState);
+    public:
+        explicit SafePtrState(T* p) : _ptr(p), _ref_count(1) {}
+        T* get() { return _ptr.load(std::memory_order_acquire); }
+        T* exchange(T* p) { return _ptr.exchange(p, std::memory_order_acq_rel); }
+        bool clearIf(T* p) { return _ptr.compare_exchange_strong(p, nullptr, std::memory_order_acq_rel); }
+        int count() { return _ref_count.load(std::memory_order_relaxed); }
+        void attach() { _ref_count.fetch_add(1, std::memory_order_relaxed); }
+        int detach() { return _ref_count.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+    private:
+        std::atomic<T*>  _ptr;        // pointer to actual object
+        std::atomic<int> _ref_count;  // reference counter
+    };
+    //! @endcond
+
     //!
     //!  Template safe pointer (reference-counted, auto-delete, thread-safe).
     //!  @ingroup cpp
@@ -82,6 +142,11 @@ namespace ts {
     //!  safe pointers in a multi-thread environment, specify an actual
     //!  mutex implementation for the target environment.
     //!
+    //!  With ts::Mutex, the mutex is not actually used. The reference count and the
+    //!  pointer are lock-free atomic variables, with the same thread-safe semantics.
+    //!  With any other subclass of ts::MutexInterface, an instance of the mutex
+    //!  class protects the safe pointer internal state.
+    //!
     //!  @tparam T The type of the pointed object. Cannot be an array type.
     //!  @tparam MUTEX A subclass of ts::MutexInterface which is used to
     //!  synchronize access to the safe pointer internal state.
@@ -470,18 +535,17 @@ namespace ts {
 
     private:
         // All safe pointers which reference the same T object share one single SafePtrShared object.
-        class SafePtrShared
+        // The SafePtrShared objects are allocated in the memory pool.
+        class SafePtrShared: public PoolAllocated
         {
             TS_NOBUILD_NOCOPY(SafePtrShared);
         private:
             // Private members:
-            T*    _ptr;        // pointer to actual object
-            int   _ref_count;  // reference counter
-            MUTEX _mutex;      // protect the SafePtrShared
+            SafePtrState<T,MUTEX> _state;  // pointer to actual object and reference counter
 
         public:
             // Constructor. Initial reference count is 1.
-            SafePtrShared(T* p) : _ptr(p), _ref_count(1), _mutex() {}
+            SafePtrShared(T* p) : _state(p) {}
 
             // Destructor. Deallocate actual object (if any).
             ~SafePtrShared();
@@ -509,30 +573,27 @@ namespace ts {
             // Perform a class downcast (cast to a subclass).
             template <typename ST> SafePtr<ST,MUTEX> downcast()
             {
-                GuardMutex lock(_mutex);
-                ST* sp = dynamic_cast<ST*>(_ptr);
-                if (sp != nullptr) {
-                    // Successful downcast, the original safe pointer must be released.
-                    _ptr = nullptr;
+                T* p = _state.get();
+                ST* sp = dynamic_cast<ST*>(p);
+                if (sp != nullptr && !_state.clearIf(p)) {
+                    // The pointed object was changed in the meantime.
+                    sp = nullptr;
                 }
+                // On successful downcast, the original safe pointer was released.
                 return SafePtr<ST,MUTEX>(sp);
             }
 
             // Perform a class upcast.
             template <typename ST> SafePtr<ST,MUTEX> upcast()
             {
-                GuardMutex lock(_mutex);
-                ST* sp = _ptr;
-                _ptr = nullptr;
+                ST* sp = _state.exchange(nullptr);
                 return SafePtr<ST,MUTEX>(sp);
             }
 
             // Change mutex type.
             template <typename NEWMUTEX> SafePtr<T,NEWMUTEX> changeMutex()
             {
-                GuardMutex lock(_mutex);
-                T* sp = _ptr;
-                _ptr = nullptr;
+                T* sp = _state.exchange(nullptr);
                 return SafePtr<T,NEWMUTEX>(sp);
             }
         };
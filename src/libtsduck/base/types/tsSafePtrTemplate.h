@@ -91,9 +91,9 @@ ts::SafePtr<T,MUTEX>& ts::SafePtr<T,MUTEX>::operator=(T* p)
 template <typename T, class MUTEX>
 ts::SafePtr<T,MUTEX>::SafePtrShared::~SafePtrShared()
 {
-    if (_ptr != nullptr) {
-        delete _ptr;
-        _ptr = nullptr;
+    T* previous = _state.exchange(nullptr);
+    if (previous != nullptr) {
+        delete previous;
     }
 }
 
@@ -106,10 +106,7 @@ ts::SafePtr<T,MUTEX>::SafePtrShared::~SafePtrShared()
 template <typename T, class MUTEX>
 T* ts::SafePtr<T,MUTEX>::SafePtrShared::release()
 {
-    GuardMutex lock(_mutex);
-    T* previous = _ptr;
-    _ptr = nullptr;
-    return previous;
+    return _state.exchange(nullptr);
 }
 
 
@@ -120,11 +117,10 @@ T* ts::SafePtr<T,MUTEX>::SafePtrShared::release()
 template <typename T, class MUTEX>
 void ts::SafePtr<T,MUTEX>::SafePtrShared::reset(T* p)
 {
-    GuardMutex lock(_mutex);
-    if (_ptr != nullptr) {
-        delete _ptr;
+    T* previous = _state.exchange(p);
+    if (previous != nullptr) {
+        delete previous;
     }
-    _ptr = p;
 }
 
 
@@ -135,8 +131,7 @@ void ts::SafePtr<T,MUTEX>::SafePtrShared::reset(T* p)
 template <typename T, class MUTEX>
 T* ts::SafePtr<T,MUTEX>::SafePtrShared::pointer()
 {
-    GuardMutex lock(_mutex);
-    return _ptr;
+    return _state.get();
 }
 
 
@@ -147,8 +142,7 @@ T* ts::SafePtr<T,MUTEX>::SafePtrShared::pointer()
 template <typename T, class MUTEX>
 int ts::SafePtr<T,MUTEX>::SafePtrShared::count()
 {
-    GuardMutex lock(_mutex);
-    return _ref_count;
+    return _state.count();
 }
 
 
@@ -159,8 +153,7 @@ int ts::SafePtr<T,MUTEX>::SafePtrShared::count()
 template <typename T, class MUTEX>
 bool ts::SafePtr<T,MUTEX>::SafePtrShared::isNull()
 {
-    GuardMutex lock(_mutex);
-    return _ptr == nullptr;
+    return _state.get() == nullptr;
 }
 
 
@@ -171,8 +164,7 @@ bool ts::SafePtr<T,MUTEX>::SafePtrShared::isNull()
 template <typename T, class MUTEX>
 typename ts::SafePtr<T,MUTEX>::SafePtrShared* ts::SafePtr<T,MUTEX>::SafePtrShared::attach()
 {
-    GuardMutex lock(_mutex);
-    _ref_count++;
+    _state.attach();
     return this;
 }
 
@@ -185,12 +177,7 @@ typename ts::SafePtr<T,MUTEX>::SafePtrShared* ts::SafePtr<T,MUTEX>::SafePtrShare
 template <typename T, class MUTEX>
 bool ts::SafePtr<T,MUTEX>::SafePtrShared::detach()
 {
-    int refcount;
-    {
-        GuardMutex lock(_mutex);
-        refcount = --_ref_count;
-    }
-    if (refcount == 0) {
+    if (_state.detach() == 0) {
         delete this;
         return true;
     }
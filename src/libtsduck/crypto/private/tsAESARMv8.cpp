@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  AES using Arm v8 cryptographic extension.
+//  With GCC and clang, this module is compiled with the crypto extension.
+//
+//----------------------------------------------------------------------------
+
+#include "tsAESAccel.h"
+
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES)
+
+#include <arm_neon.h>
+
+namespace {
+
+    // Number of blocks which are processed in parallel to fill the AES pipeline.
+    constexpr size_t PARALLEL = 4;
+
+    // With Arm, AESE/AESD start with AddRoundKey and the last round key is a simple xor.
+    void Encrypt(const uint8_t* rk, size_t rounds, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        uint8x16_t k[15];
+        for (size_t r = 0; r <= rounds; ++r) {
+            k[r] = vld1q_u8(rk + 16 * r);
+        }
+        for (; count >= PARALLEL; count -= PARALLEL, in += 16 * PARALLEL, out += 16 * PARALLEL) {
+            uint8x16_t b0 = vld1q_u8(in);
+            uint8x16_t b1 = vld1q_u8(in + 16);
+            uint8x16_t b2 = vld1q_u8(in + 32);
+            uint8x16_t b3 = vld1q_u8(in + 48);
+            for (size_t r = 0; r < rounds - 1; ++r) {
+                b0 = vaesmcq_u8(vaeseq_u8(b0, k[r]));
+                b1 = vaesmcq_u8(vaeseq_u8(b1, k[r]));
+                b2 = vaesmcq_u8(vaeseq_u8(b2, k[r]));
+                b3 = vaesmcq_u8(vaeseq_u8(b3, k[r]));
+            }
+            vst1q_u8(out, veorq_u8(vaeseq_u8(b0, k[rounds - 1]), k[rounds]));
+            vst1q_u8(out + 16, veorq_u8(vaeseq_u8(b1, k[rounds - 1]), k[rounds]));
+            vst1q_u8(out + 32, veorq_u8(vaeseq_u8(b2, k[rounds - 1]), k[rounds]));
+            vst1q_u8(out + 48, veorq_u8(vaeseq_u8(b3, k[rounds - 1]), k[rounds]));
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            uint8x16_t b = vld1q_u8(in);
+            for (size_t r = 0; r < rounds - 1; ++r) {
+                b = vaesmcq_u8(vaeseq_u8(b, k[r]));
+            }
+            vst1q_u8(out, veorq_u8(vaeseq_u8(b, k[rounds - 1]), k[rounds]));
+        }
+    }
+
+    void Decrypt(const uint8_t* rk, size_t rounds, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        uint8x16_t k[15];
+        for (size_t r = 0; r <= rounds; ++r) {
+            k[r] = vld1q_u8(rk + 16 * r);
+        }
+        for (; count >= PARALLEL; count -= PARALLEL, in += 16 * PARALLEL, out += 16 * PARALLEL) {
+            uint8x16_t b0 = vld1q_u8(in);
+            uint8x16_t b1 = vld1q_u8(in + 16);
+            uint8x16_t b2 = vld1q_u8(in + 32);
+            uint8x16_t b3 = vld1q_u8(in + 48);
+            for (size_t r = 0; r < rounds - 1; ++r) {
+                b0 = vaesimcq_u8(vaesdq_u8(b0, k[r]));
+                b1 = vaesimcq_u8(vaesdq_u8(b1, k[r]));
+                b2 = vaesimcq_u8(vaesdq_u8(b2, k[r]));
+                b3 = vaesimcq_u8(vaesdq_u8(b3, k[r]));
+            }
+            vst1q_u8(out, veorq_u8(vaesdq_u8(b0, k[rounds - 1]), k[rounds]));
+            vst1q_u8(out + 16, veorq_u8(vaesdq_u8(b1, k[rounds - 1]), k[rounds]));
+            vst1q_u8(out + 32, veorq_u8(vaesdq_u8(b2, k[rounds - 1]), k[rounds]));
+            vst1q_u8(out + 48, veorq_u8(vaesdq_u8(b3, k[rounds - 1]), k[rounds]));
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            uint8x16_t b = vld1q_u8(in);
+            for (size_t r = 0; r < rounds - 1; ++r) {
+                b = vaesimcq_u8(vaesdq_u8(b, k[r]));
+            }
+            vst1q_u8(out, veorq_u8(vaesdq_u8(b, k[rounds - 1]), k[rounds]));
+        }
+    }
+}
+
+const ts::aesaccel::BlocksFunction ts::aesaccel::EncryptARMv8 = Encrypt;
+const ts::aesaccel::BlocksFunction ts::aesaccel::DecryptARMv8 = Decrypt;
+
+#else
+
+// The Arm v8 cryptographic extension is not supported by the compiler or the target CPU.
+const ts::aesaccel::BlocksFunction ts::aesaccel::EncryptARMv8 = nullptr;
+const ts::aesaccel::BlocksFunction ts::aesaccel::DecryptARMv8 = nullptr;
+
+#endif
@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Hardware-accelerated implementations of AES (internal).
+//!
+//!  This header is included by the AES module and its instruction set
+//!  specific variants. It shall not include other TSDuck headers than the
+//!  basic platform definitions: the variants are compiled with specific
+//!  instruction sets and all inline code from other headers would be
+//!  compiled with these instructions.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Internal implementation of hardware-accelerated AES.
+    //! This namespace is internal to the TSDuck library and cannot be called by applications.
+    //!
+    namespace aesaccel {
+
+        //!
+        //! Profile of a function which encrypts or decrypts contiguous AES blocks (ECB).
+        //! @param [in] rk Round keys, 16 bytes per round key, in the order of usage.
+        //! For decryption, this is the key schedule of the "equivalent inverse cipher"
+        //! (FIPS 197, section 5.3.5), with InvMixColumns applied to the middle round keys.
+        //! @param [in] rounds Number of rounds (10, 12 or 14). There are @a rounds + 1 round keys.
+        //! @param [in] in Address of input blocks.
+        //! @param [out] out Address of output blocks. Can be the same as @a in.
+        //! @param [in] count Number of 16-byte blocks.
+        //!
+        typedef void (*BlocksFunction)(const uint8_t* rk, size_t rounds, const uint8_t* in, uint8_t* out, size_t count);
+
+        //!
+        //! Encryption using Intel AES-NI instructions.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const BlocksFunction EncryptAESNI;
+
+        //!
+        //! Decryption using Intel AES-NI instructions.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const BlocksFunction DecryptAESNI;
+
+        //!
+        //! Encryption using Arm v8 cryptographic extension.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const BlocksFunction EncryptARMv8;
+
+        //!
+        //! Decryption using Arm v8 cryptographic extension.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const BlocksFunction DecryptARMv8;
+    }
+}
@@ -0,0 +1,122 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  AES using Intel AES-NI instructions.
+//  With GCC and clang, this module is compiled with AES-NI code generation.
+//  With MSVC, the AES-NI intrinsics are always available.
+//
+//----------------------------------------------------------------------------
+
+#include "tsAESAccel.h"
+
+#if defined(__AES__) || (defined(TS_MSC) && (defined(TS_X86_64) || defined(TS_I386)))
+
+#include <wmmintrin.h>
+
+namespace {
+
+    // Number of blocks which are processed in parallel to fill the AES pipeline.
+    constexpr size_t PARALLEL = 4;
+
+    inline __m128i Load(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    inline void Store(uint8_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+    void Encrypt(const uint8_t* rk, size_t rounds, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i k[15];
+        for (size_t r = 0; r <= rounds; ++r) {
+            k[r] = Load(rk + 16 * r);
+        }
+        for (; count >= PARALLEL; count -= PARALLEL, in += 16 * PARALLEL, out += 16 * PARALLEL) {
+            __m128i b0 = _mm_xor_si128(Load(in), k[0]);
+            __m128i b1 = _mm_xor_si128(Load(in + 16), k[0]);
+            __m128i b2 = _mm_xor_si128(Load(in + 32), k[0]);
+            __m128i b3 = _mm_xor_si128(Load(in + 48), k[0]);
+            for (size_t r = 1; r < rounds; ++r) {
+                b0 = _mm_aesenc_si128(b0, k[r]);
+                b1 = _mm_aesenc_si128(b1, k[r]);
+                b2 = _mm_aesenc_si128(b2, k[r]);
+                b3 = _mm_aesenc_si128(b3, k[r]);
+            }
+            Store(out, _mm_aesenclast_si128(b0, k[rounds]));
+            Store(out + 16, _mm_aesenclast_si128(b1, k[rounds]));
+            Store(out + 32, _mm_aesenclast_si128(b2, k[rounds]));
+            Store(out + 48, _mm_aesenclast_si128(b3, k[rounds]));
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            __m128i b = _mm_xor_si128(Load(in), k[0]);
+            for (size_t r = 1; r < rounds; ++r) {
+                b = _mm_aesenc_si128(b, k[r]);
+            }
+            Store(out, _mm_aesenclast_si128(b, k[rounds]));
+        }
+    }
+
+    void Decrypt(const uint8_t* rk, size_t rounds, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i k[15];
+        for (size_t r = 0; r <= rounds; ++r) {
+            k[r] = Load(rk + 16 * r);
+        }
+        for (; count >= PARALLEL; count -= PARALLEL, in += 16 * PARALLEL, out += 16 * PARALLEL) {
+            __m128i b0 = _mm_xor_si128(Load(in), k[0]);
+            __m128i b1 = _mm_xor_si128(Load(in + 16), k[0]);
+            __m128i b2 = _mm_xor_si128(Load(in + 32), k[0]);
+            __m128i b3 = _mm_xor_si128(Load(in + 48), k[0]);
+            for (size_t r = 1; r < rounds; ++r) {
+                b0 = _mm_aesdec_si128(b0, k[r]);
+                b1 = _mm_aesdec_si128(b1, k[r]);
+                b2 = _mm_aesdec_si128(b2, k[r]);
+                b3 = _mm_aesdec_si128(b3, k[r]);
+            }
+            Store(out, _mm_aesdeclast_si128(b0, k[rounds]));
+            Store(out + 16, _mm_aesdeclast_si128(b1, k[rounds]));
+            Store(out + 32, _mm_aesdeclast_si128(b2, k[rounds]));
+            Store(out + 48, _mm_aesdeclast_si128(b3, k[rounds]));
+        }
+        for (; count > 0; count--, in += 16, out += 16) {
+            __m128i b = _mm_xor_si128(Load(in), k[0]);
+            for (size_t r = 1; r < rounds; ++r) {
+                b = _mm_aesdec_si128(b, k[r]);
+            }
+            Store(out, _mm_aesdeclast_si128(b, k[rounds]));
+        }
+    }
+}
+
+const ts::aesaccel::BlocksFunction ts::aesaccel::EncryptAESNI = Encrypt;
+const ts::aesaccel::BlocksFunction ts::aesaccel::DecryptAESNI = Decrypt;
+
+#else
+
+// AES-NI is not supported by the compiler or the target CPU.
+const ts::aesaccel::BlocksFunction ts::aesaccel::EncryptAESNI = nullptr;
+const ts::aesaccel::BlocksFunction ts::aesaccel::DecryptAESNI = nullptr;
+
+#endif
@@ -0,0 +1,71 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  DVB CSA-2 batch engine using AVX2 instructions.
+//  With GCC and clang, this module is compiled with AVX2 code generation.
+//  With MSVC, the AVX2 intrinsics are always available.
+//
+//----------------------------------------------------------------------------
+
+#include "tsDVBCSA2Batch.h"
+
+#if defined(__AVX2__) || (defined(TS_MSC) && (defined(TS_X86_64) || defined(TS_I386)))
+
+#include <immintrin.h>
+
+namespace {
+    //
+    // A 256-bit AVX2 register, one bit per lane.
+    //
+    class WordAVX2
+    {
+    private:
+        __m256i _v;
+    public:
+        static constexpr size_t BITS = 256;
+        WordAVX2() : _v(_mm256_setzero_si256()) {}
+        WordAVX2(__m256i v) : _v(v) {}
+        static WordAVX2 Zero() { return WordAVX2(_mm256_setzero_si256()); }
+        static WordAVX2 Ones() { return WordAVX2(_mm256_set1_epi32(-1)); }
+        static WordAVX2 Load(const uint8_t* p) { __m256i v; std::memcpy(&v, p, sizeof(v)); return WordAVX2(v); }
+        void store(uint8_t* p) const { std::memcpy(p, &_v, sizeof(_v)); }
+        friend WordAVX2 operator^(WordAVX2 a, WordAVX2 b) { return WordAVX2(_mm256_xor_si256(a._v, b._v)); }
+        friend WordAVX2 operator&(WordAVX2 a, WordAVX2 b) { return WordAVX2(_mm256_and_si256(a._v, b._v)); }
+        friend WordAVX2 operator|(WordAVX2 a, WordAVX2 b) { return WordAVX2(_mm256_or_si256(a._v, b._v)); }
+    };
+}
+
+const ts::dvbcsa2::BatchFunction ts::dvbcsa2::ProcessAVX2 = ts::dvbcsa2::BatchEngine<WordAVX2>::Process;
+
+#else
+
+// AVX2 is not supported by the compiler or the target CPU.
+const ts::dvbcsa2::BatchFunction ts::dvbcsa2::ProcessAVX2 = nullptr;
+
+#endif
@@ -0,0 +1,656 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Bitsliced implementation of DVB CSA-2 on multiple packets (internal).
+//!
+//!  This header is included by the DVB CSA-2 module and its instruction set
+//!  specific variants. It shall not include other TSDuck headers than the
+//!  basic platform definitions: some variants are compiled with specific
+//!  instruction sets and all inline code from other headers would be
+//!  compiled with these instructions.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Internal implementation of DVB CSA-2.
+    //! This namespace is internal to the TSDuck library and cannot be called by applications.
+    //!
+    namespace dvbcsa2 {
+
+        //!
+        //! Maximum number of packets which are processed in parallel by a batch engine.
+        //!
+        constexpr size_t MAX_LANES = 256;
+
+        //! @cond nodoxygen
+        // Stream cipher S-boxes (5-bit input, 2-bit output).
+        constexpr int sbox1[32] = {2,0,1,1,2,3,3,0, 3,2,2,0,1,1,0,3, 0,3,3,0,2,2,1,1, 2,2,0,3,1,1,3,0};
+        constexpr int sbox2[32] = {3,1,0,2,2,3,3,0, 1,3,2,1,0,0,1,2, 3,1,0,3,3,2,0,2, 0,0,1,2,2,1,3,1};
+        constexpr int sbox3[32] = {2,0,1,2,2,3,3,1, 1,1,0,3,3,0,2,0, 1,3,0,1,3,0,2,2, 2,0,1,2,0,3,3,1};
+        constexpr int sbox4[32] = {3,1,2,3,0,2,1,2, 1,2,0,1,3,0,0,3, 1,0,3,1,2,3,0,3, 0,3,2,0,1,2,2,1};
+        constexpr int sbox5[32] = {2,0,0,1,3,2,3,2, 0,1,3,3,1,0,2,1, 2,3,2,0,0,3,1,1, 1,0,3,2,3,1,0,2};
+        constexpr int sbox6[32] = {0,1,2,3,1,2,2,0, 0,1,3,0,2,3,1,3, 2,3,0,2,3,0,1,1, 2,1,1,2,0,3,3,0};
+        constexpr int sbox7[32] = {0,3,2,2,3,0,0,1, 3,0,1,3,1,2,2,1, 1,0,3,3,0,1,1,2, 2,3,1,0,2,3,0,2};
+
+        // Block cipher S-box and permutation, defined in tsDVBCSA2.cpp.
+        extern const uint8_t block_sbox[256];
+        extern const uint8_t block_perm[256];
+        //! @endcond
+
+        //!
+        //! Profile of a function which processes a batch of packets.
+        //! @param [in] encrypt True to encrypt, false to decrypt.
+        //! @param [in] key Control word (after entropy reduction, if any).
+        //! @param [in] kk Block cipher key schedule, index 1 to 56.
+        //! @param [in,out] data Addresses of the messages to process.
+        //! @param [in] sizes Sizes in bytes of the messages, from 8 to 191 bytes (23 blocks and a residue).
+        //! @param [in] count Number of messages, from 1 to the number of lanes of the engine.
+        //!
+        typedef void (*BatchFunction)(bool encrypt, const uint8_t* key, const int* kk, uint8_t* const* data, const size_t* sizes, size_t count);
+
+        //!
+        //! Batch engine using the SSE2 instruction set, 128 lanes.
+        //! Null pointer when the SSE2 instruction set is not supported by the compiler.
+        //!
+        extern const BatchFunction ProcessSSE2;
+
+        //!
+        //! Batch engine using the AVX2 instruction set, 256 lanes.
+        //! Null pointer when the AVX2 instruction set is not supported by the compiler.
+        //!
+        extern const BatchFunction ProcessAVX2;
+
+        //!
+        //! Compute the truth table of one output bit of a stream cipher S-box.
+        //! @param [in] sbox Address of a 32-entry S-box.
+        //! @param [in] bit Output bit index, 0 or 1.
+        //! @param [in] index First S-box entry to consider (recursion).
+        //! @return A 32-bit truth table, bit @e n is the output bit for input @e n.
+        //!
+        constexpr uint32_t SBoxTruth(const int* sbox, int bit, int index = 0)
+        {
+            return index >= 32 ? 0 : (uint32_t((sbox[index] >> bit) & 1) << index) | SBoxTruth(sbox, bit, index + 1);
+        }
+
+        //!
+        //! A bitsliced word using a standard integer type, one bit per lane.
+        //! The lane @e n is bit @e n % 8 of byte @e n / 8 in memory.
+        //! @tparam INT An unsigned integer type.
+        //!
+        template <typename INT>
+        class IntWord
+        {
+        private:
+            INT _v;
+        public:
+            static constexpr size_t BITS = 8 * sizeof(INT);   //!< Number of lanes.
+            //! Constructor. @param [in] v Initial value.
+            IntWord(INT v = 0) : _v(v) {}
+            //! @return A word with all lanes set to zero.
+            static IntWord Zero() { return IntWord(0); }
+            //! @return A word with all lanes set to one.
+            static IntWord Ones() { return IntWord(INT(~INT(0))); }
+            //! Load a word from memory. @param [in] p Address of BITS/8 bytes. @return The word.
+            static IntWord Load(const uint8_t* p) { INT v; std::memcpy(&v, p, sizeof(v)); return IntWord(v); }
+            //! Store a word into memory. @param [out] p Address of BITS/8 bytes.
+            void store(uint8_t* p) const { std::memcpy(p, &_v, sizeof(_v)); }
+            //! @cond nodoxygen
+            friend IntWord operator^(IntWord a, IntWord b) { return IntWord(a._v ^ b._v); }
+            friend IntWord operator&(IntWord a, IntWord b) { return IntWord(a._v & b._v); }
+            friend IntWord operator|(IntWord a, IntWord b) { return IntWord(a._v | b._v); }
+            //! @endcond
+        };
+
+        //! @cond nodoxygen
+        template <class WORD, uint32_t TRUTH, int VARS> struct BoolFunction;
+        //! @endcond
+
+        //!
+        //! Bitsliced multiplexer: select one of two boolean functions using one variable.
+        //! @tparam WORD Bitsliced word type.
+        //! @tparam LOW Truth table of the function when x[VAR] is 0.
+        //! @tparam HIGH Truth table of the function when x[VAR] is 1.
+        //! @tparam VAR Index of the selection variable. The two functions use x[0] to x[VAR-1].
+        //! @tparam SAME True when the two functions are identical.
+        //!
+        template <class WORD, uint32_t LOW, uint32_t HIGH, int VAR, bool SAME = LOW == HIGH>
+        struct Mux
+        {
+            //! Evaluate. @param [in] x Input variables. @return Function result.
+            static WORD Eval(const WORD* x)
+            {
+                const WORD lo(BoolFunction<WORD, LOW, VAR>::Eval(x));
+                const WORD hi(BoolFunction<WORD, HIGH, VAR>::Eval(x));
+                return lo ^ ((lo ^ hi) & x[VAR]);
+            }
+        };
+
+        //! @cond nodoxygen
+        // When both halves are identical, the selection variable is not used.
+        template <class WORD, uint32_t LOW, uint32_t HIGH, int VAR>
+        struct Mux<WORD, LOW, HIGH, VAR, true>
+        {
+            static WORD Eval(const WORD* x) { return BoolFunction<WORD, LOW, VAR>::Eval(x); }
+        };
+        //! @endcond
+
+        //!
+        //! Bitsliced boolean function, built at compile time from its truth table.
+        //! @tparam WORD Bitsliced word type.
+        //! @tparam TRUTH Truth table, bit @e n is the result for the input value @e n.
+        //! @tparam VARS Number of input variables (up to 5).
+        //!
+        template <class WORD, uint32_t TRUTH, int VARS>
+        struct BoolFunction
+        {
+            //! Evaluate. @param [in] x Input variables, x[0] is the least significant bit of the input value. @return Function result.
+            static WORD Eval(const WORD* x)
+            {
+                return Mux<WORD, (TRUTH & ((uint32_t(1) << (1 << (VARS - 1))) - 1)), (TRUTH >> (1 << (VARS - 1))), VARS - 1>::Eval(x);
+            }
+        };
+
+        //! @cond nodoxygen
+        // Function without variable: a constant.
+        template <class WORD, uint32_t TRUTH>
+        struct BoolFunction<WORD, TRUTH, 0>
+        {
+            static WORD Eval(const WORD*) { return (TRUTH & 1) != 0 ? WORD::Ones() : WORD::Zero(); }
+        };
+        //! @endcond
+
+        //!
+        //! Bitsliced DVB CSA-2 engine, processing one packet per bit of a "word".
+        //!
+        //! The stream cipher, which is a bit-oriented algorithm, is bitsliced: each
+        //! bit of its state is a word containing that bit for all packets. The block
+        //! cipher, which is byte-oriented, is byte-sliced: each byte of its state is an
+        //! array of bytes, one per packet, which can be processed by vector instructions.
+        //!
+        //! @tparam WORD Bitsliced word type, with the same interface as IntWord.
+        //!
+        template <class WORD>
+        class BatchEngine
+        {
+        public:
+            //!
+            //! Number of packets which are processed in parallel.
+            //!
+            static constexpr size_t LANES = WORD::BITS;
+
+            //!
+            //! Process a batch of messages with the same key.
+            //! This function has the profile of a BatchFunction.
+            //! @param [in] encrypt True to encrypt, false to decrypt.
+            //! @param [in] key Control word (after entropy reduction, if any).
+            //! @param [in] kk Block cipher key schedule, index 1 to 56.
+            //! @param [in,out] data Addresses of the messages to process.
+            //! @param [in] sizes Sizes in bytes of the messages, from 8 to 191 bytes (23 blocks and a residue).
+            //! @param [in] count Number of messages, from 1 to LANES.
+            //!
+            static void Process(bool encrypt, const uint8_t* key, const int* kk, uint8_t* const* data, const size_t* sizes, size_t count);
+
+        private:
+            // The block cipher state: 8 rows of bytes, one byte per lane.
+            typedef uint8_t Rows[8][LANES];
+
+            // Transpose an 8x8 bit matrix: bit 8*r+c is swapped with bit 8*c+r.
+            static uint64_t Transpose(uint64_t x);
+
+            // Block cipher on all lanes. Return the index of the row containing the first byte.
+            static size_t Encipher(const int* kk, Rows& rows, size_t count);
+            static size_t Decipher(const int* kk, Rows& rows, size_t count);
+
+            // Bitsliced state of the stream cipher for all lanes.
+            // A[k] of the original algorithm (k = 1..10) is in a[(pos+k-1)%10], same for B.
+            // The shift of registers A and B is implemented as a rotation of pos.
+            class Stream
+            {
+            public:
+                WORD   a[10][4];
+                WORD   b[10][4];
+                WORD   X[4];
+                WORD   Y[4];
+                WORD   Z[4];
+                WORD   D[4];
+                WORD   E[4];
+                WORD   F[4];
+                WORD   p;
+                WORD   q;
+                WORD   r;
+                size_t pos;
+
+                // Initialize the state from the key, identical in all lanes.
+                Stream(const uint8_t* key);
+
+                // One iteration, 2 output bits. During initialization, in_A and in_B are the input nibbles.
+                template <bool INIT>
+                void step(const WORD* in_A, const WORD* in_B, WORD& out_hi, WORD& out_lo);
+            };
+
+            // Stream cipher on all lanes: initialized with the first 8 bytes of each
+            // message, it scrambles or descrambles the rest of the message.
+            static void StreamCipher(const uint8_t* key, uint8_t* const* data, const size_t* sizes, size_t count);
+        };
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Template definitions.
+//----------------------------------------------------------------------------
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+template <class WORD>
+constexpr size_t ts::dvbcsa2::BatchEngine<WORD>::LANES;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Transpose an 8x8 bit matrix.
+//----------------------------------------------------------------------------
+
+template <class WORD>
+uint64_t ts::dvbcsa2::BatchEngine<WORD>::Transpose(uint64_t x)
+{
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AA;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCC;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+
+//----------------------------------------------------------------------------
+// Byte-sliced block cipher.
+// Register R[k] (k = 1..8) of the original algorithm is in rows[(base+k-1)%8].
+// The register shifts of each round are implemented as a rotation of the base.
+//----------------------------------------------------------------------------
+
+template <class WORD>
+size_t ts::dvbcsa2::BatchEngine<WORD>::Encipher(const int* kk, Rows& rows, size_t count)
+{
+    uint8_t sbox_out[LANES];
+    uint8_t perm_out[LANES];
+    size_t base = 0;
+
+    // Loop over kk[1]..kk[56].
+    for (size_t i = 1; i <= 56; i++) {
+        const uint8_t key = uint8_t(kk[i]);
+        uint8_t* const r1 = rows[base];
+        uint8_t* const r3 = rows[(base + 2) & 7];
+        uint8_t* const r4 = rows[(base + 3) & 7];
+        uint8_t* const r5 = rows[(base + 4) & 7];
+        uint8_t* const r7 = rows[(base + 6) & 7];
+        const uint8_t* const r8 = rows[(base + 7) & 7];
+        for (size_t l = 0; l < count; ++l) {
+            sbox_out[l] = block_sbox[key ^ r8[l]];
+            perm_out[l] = block_perm[sbox_out[l]];
+        }
+        // Rows which become R2, R3, R4, R6, R8 after rotation.
+        for (size_t l = 0; l < count; ++l) {
+            r3[l] ^= r1[l];
+            r4[l] ^= r1[l];
+            r5[l] ^= r1[l];
+            r7[l] ^= perm_out[l];
+            r1[l] ^= sbox_out[l];
+        }
+        base = (base + 1) & 7;
+    }
+    return base;
+}
+
+template <class WORD>
+size_t ts::dvbcsa2::BatchEngine<WORD>::Decipher(const int* kk, Rows& rows, size_t count)
+{
+    uint8_t sbox_out[LANES];
+    uint8_t perm_out[LANES];
+    size_t base = 0;
+
+    // Loop over kk[56]..kk[1].
+    for (size_t i = 56; i > 0; i--) {
+        const uint8_t key = uint8_t(kk[i]);
+        uint8_t* const r2 = rows[(base + 1) & 7];
+        uint8_t* const r3 = rows[(base + 2) & 7];
+        uint8_t* const r4 = rows[(base + 3) & 7];
+        uint8_t* const r6 = rows[(base + 5) & 7];
+        const uint8_t* const r7 = rows[(base + 6) & 7];
+        uint8_t* const r8 = rows[(base + 7) & 7];
+        for (size_t l = 0; l < count; ++l) {
+            sbox_out[l] = block_sbox[key ^ r7[l]];
+            perm_out[l] = block_perm[sbox_out[l]];
+        }
+        // Rows which become R1, R3, R4, R5, R7 after rotation.
+        for (size_t l = 0; l < count; ++l) {
+            r8[l] ^= sbox_out[l];
+            r2[l] ^= r8[l];
+            r3[l] ^= r8[l];
+            r4[l] ^= r8[l];
+            r6[l] ^= perm_out[l];
+        }
+        base = (base + 7) & 7;
+    }
+    return base;
+}
+
+
+//----------------------------------------------------------------------------
+// Bitsliced stream cipher state.
+//----------------------------------------------------------------------------
+
+template <class WORD>
+ts::dvbcsa2::BatchEngine<WORD>::Stream::Stream(const uint8_t* key) :
+    a(),
+    b(),
+    X(),
+    Y(),
+    Z(),
+    D(),
+    E(),
+    F(),
+    p(),
+    q(),
+    r(),
+    pos(0)
+{
+    // Load first 32 bits of key into A[1]..A[8], last 32 bits into B[1]..B[8], all other registers are zero.
+    for (size_t k = 0; k < 8; ++k) {
+        const int na = (key[k / 2] >> (k % 2 == 0 ? 4 : 0)) & 0x0F;
+        const int nb = (key[4 + k / 2] >> (k % 2 == 0 ? 4 : 0)) & 0x0F;
+        for (size_t i = 0; i < 4; ++i) {
+            a[k][i] = ((na >> i) & 1) != 0 ? WORD::Ones() : WORD::Zero();
+            b[k][i] = ((nb >> i) & 1) != 0 ? WORD::Ones() : WORD::Zero();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// One iteration of the bitsliced stream cipher, producing 2 output bits.
+//----------------------------------------------------------------------------
+
+template <class WORD>
+template <bool INIT>
+void ts::dvbcsa2::BatchEngine<WORD>::Stream::step(const WORD* in_A, const WORD* in_B, WORD& out_hi, WORD& out_lo)
+{
+    // Truth tables of the S-boxes output bits.
+    constexpr uint32_t S1B0 = SBoxTruth(sbox1, 0), S1B1 = SBoxTruth(sbox1, 1);
+    constexpr uint32_t S2B0 = SBoxTruth(sbox2, 0), S2B1 = SBoxTruth(sbox2, 1);
+    constexpr uint32_t S3B0 = SBoxTruth(sbox3, 0), S3B1 = SBoxTruth(sbox3, 1);
+    constexpr uint32_t S4B0 = SBoxTruth(sbox4, 0), S4B1 = SBoxTruth(sbox4, 1);
+    constexpr uint32_t S5B0 = SBoxTruth(sbox5, 0), S5B1 = SBoxTruth(sbox5, 1);
+    constexpr uint32_t S6B0 = SBoxTruth(sbox6, 0), S6B1 = SBoxTruth(sbox6, 1);
+    constexpr uint32_t S7B0 = SBoxTruth(sbox7, 0), S7B1 = SBoxTruth(sbox7, 1);
+
+    // Current positions of the registers A[1]..A[10] and B[1]..B[10].
+    const WORD* A[11];
+    const WORD* B[11];
+    A[0] = B[0] = nullptr;
+    for (size_t k = 1; k <= 10; ++k) {
+        const size_t index = (pos + k - 1) % 10;
+        A[k] = a[index];
+        B[k] = b[index];
+    }
+
+    // From A[1]..A[10], 35 bits are selected as inputs to 7 s-boxes.
+    // 5 bits input per s-box, 2 bits output per s-box. The first input is the least significant bit.
+    const WORD in1[5] = {A[9][0], A[7][3], A[6][1], A[1][2], A[4][0]};
+    const WORD in2[5] = {A[9][1], A[7][0], A[6][3], A[3][2], A[2][1]};
+    const WORD in3[5] = {A[6][2], A[5][3], A[5][1], A[2][0], A[1][3]};
+    const WORD in4[5] = {A[8][0], A[4][2], A[2][3], A[1][1], A[3][3]};
+    const WORD in5[5] = {A[9][2], A[8][1], A[6][0], A[4][3], A[5][2]};
+    const WORD in6[5] = {A[9][3], A[7][2], A[5][0], A[4][1], A[3][1]};
+    const WORD in7[5] = {A[8][3], A[8][2], A[7][1], A[3][0], A[2][2]};
+
+    const WORD s1b0(BoolFunction<WORD, S1B0, 5>::Eval(in1));
+    const WORD s1b1(BoolFunction<WORD, S1B1, 5>::Eval(in1));
+    const WORD s2b0(BoolFunction<WORD, S2B0, 5>::Eval(in2));
+    const WORD s2b1(BoolFunction<WORD, S2B1, 5>::Eval(in2));
+    const WORD s3b0(BoolFunction<WORD, S3B0, 5>::Eval(in3));
+    const WORD s3b1(BoolFunction<WORD, S3B1, 5>::Eval(in3));
+    const WORD s4b0(BoolFunction<WORD, S4B0, 5>::Eval(in4));
+    const WORD s4b1(BoolFunction<WORD, S4B1, 5>::Eval(in4));
+    const WORD s5b0(BoolFunction<WORD, S5B0, 5>::Eval(in5));
+    const WORD s5b1(BoolFunction<WORD, S5B1, 5>::Eval(in5));
+    const WORD s6b0(BoolFunction<WORD, S6B0, 5>::Eval(in6));
+    const WORD s6b1(BoolFunction<WORD, S6B1, 5>::Eval(in6));
+    const WORD s7b0(BoolFunction<WORD, S7B0, 5>::Eval(in7));
+    const WORD s7b1(BoolFunction<WORD, S7B1, 5>::Eval(in7));
+
+    // Use 4x4 xor to produce extra nibble for T3.
+    const WORD extra_B[4] = {
+        B[9][2] ^ B[6][3] ^ B[3][1] ^ B[8][0],
+        B[5][3] ^ B[8][2] ^ B[4][0] ^ B[5][1],
+        B[6][0] ^ B[8][1] ^ B[3][3] ^ B[4][2],
+        B[3][0] ^ B[6][1] ^ B[7][2] ^ B[9][3]
+    };
+
+    // T1 = xor all inputs, T2 = xor all inputs.
+    // The input nibbles and D are only used during initialisation, not generation.
+    WORD next_A1[4], next_B1[4];
+    for (size_t k = 0; k < 4; ++k) {
+        next_A1[k] = A[10][k] ^ X[k];
+        next_B1[k] = B[7][k] ^ B[10][k] ^ Y[k];
+        if (INIT) {
+            next_A1[k] = next_A1[k] ^ D[k] ^ in_A[k];
+            next_B1[k] = next_B1[k] ^ in_B[k];
+        }
+    }
+
+    // If p=1, rotate next_B1 left.
+    const WORD rot_B1[4] = {next_B1[3], next_B1[0], next_B1[1], next_B1[2]};
+    for (size_t k = 0; k < 4; ++k) {
+        next_B1[k] = next_B1[k] ^ ((next_B1[k] ^ rot_B1[k]) & p);
+    }
+
+    // T3 = xor all inputs.
+    for (size_t k = 0; k < 4; ++k) {
+        D[k] = E[k] ^ Z[k] ^ extra_B[k];
+    }
+
+    // T4 = sum, carry of Z + E + r, only when q=1. Otherwise, F = E.
+    WORD carry(r);
+    for (size_t k = 0; k < 4; ++k) {
+        const WORD sum(Z[k] ^ E[k] ^ carry);
+        carry = (Z[k] & E[k]) | (carry & (Z[k] ^ E[k]));
+        const WORD next_E(F[k]);
+        F[k] = E[k] ^ ((E[k] ^ sum) & q);
+        E[k] = next_E;
+    }
+    r = r ^ ((r ^ carry) & q);
+
+    // Shift registers A and B: the previous A[10] and B[10] are replaced by the new A[1] and B[1].
+    pos = (pos + 9) % 10;
+    for (size_t k = 0; k < 4; ++k) {
+        a[pos][k] = next_A1[k];
+        b[pos][k] = next_B1[k];
+    }
+
+    X[3] = s4b0; X[2] = s3b0; X[1] = s2b1; X[0] = s1b1;
+    Y[3] = s6b0; Y[2] = s5b0; Y[1] = s4b1; Y[0] = s3b1;
+    Z[3] = s2b0; Z[2] = s1b0; Z[1] = s6b1; Z[0] = s5b1;
+    p = s7b1;
+    q = s7b0;
+
+    // 2 output bits are a function of the 4 bits of D.
+    if (!INIT) {
+        out_hi = D[2] ^ D[3];
+        out_lo = D[0] ^ D[1];
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Bitsliced stream cipher on all lanes.
+//----------------------------------------------------------------------------
+
+template <class WORD>
+void ts::dvbcsa2::BatchEngine<WORD>::StreamCipher(const uint8_t* key, uint8_t* const* data, const size_t* sizes, size_t count)
+{
+    Stream stream(key);
+
+    // Bit planes of bytes, one bit per lane, as bytes and as words.
+    uint8_t planes[8][LANES / 8];
+    WORD bits[8];
+
+    // Initialization phase with the first 8 bytes of all messages.
+    for (size_t i = 0; i < 8; ++i) {
+        for (size_t g = 0; g < LANES / 8; ++g) {
+            uint64_t x = 0;
+            for (size_t m = 0; m < 8 && 8 * g + m < count; ++m) {
+                x |= uint64_t(data[8 * g + m][i]) << (8 * m);
+            }
+            x = Transpose(x);
+            for (size_t bit = 0; bit < 8; ++bit) {
+                planes[bit][g] = uint8_t(x >> (8 * bit));
+            }
+        }
+        for (size_t bit = 0; bit < 8; ++bit) {
+            bits[bit] = WORD::Load(planes[bit]);
+        }
+        // The most significant nibble is first injected in A, the least significant one in B, then alternatively.
+        WORD unused;
+        for (size_t j = 0; j < 4; ++j) {
+            stream.template step<true>(bits + (j % 2 == 0 ? 4 : 0), bits + (j % 2 == 0 ? 0 : 4), unused, unused);
+        }
+    }
+
+    // Number of 8-byte keystream blocks. The first block of each message is not scrambled by the stream cipher.
+    size_t max_size = 0;
+    for (size_t l = 0; l < count; ++l) {
+        if (sizes[l] > max_size) {
+            max_size = sizes[l];
+        }
+    }
+
+    // Generation phase, one byte of keystream at a time, xor'ed into all messages.
+    for (size_t offset = 8; offset < max_size; ++offset) {
+        // 2 bits per iteration, 4 iterations per byte, most significant bits first.
+        for (size_t j = 0; j < 4; ++j) {
+            stream.template step<false>(nullptr, nullptr, bits[7 - 2 * j], bits[6 - 2 * j]);
+        }
+        for (size_t bit = 0; bit < 8; ++bit) {
+            bits[bit].store(planes[bit]);
+        }
+        for (size_t g = 0; 8 * g < count; ++g) {
+            uint64_t x = 0;
+            for (size_t bit = 0; bit < 8; ++bit) {
+                x |= uint64_t(planes[bit][g]) << (8 * bit);
+            }
+            x = Transpose(x);
+            for (size_t m = 0; m < 8 && 8 * g + m < count; ++m) {
+                const size_t l = 8 * g + m;
+                if (offset < sizes[l]) {
+                    data[l][offset] ^= uint8_t(x >> (8 * m));
+                }
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Process a batch of messages.
+//----------------------------------------------------------------------------
+
+template <class WORD>
+void ts::dvbcsa2::BatchEngine<WORD>::Process(bool encrypt, const uint8_t* key, const int* kk, uint8_t* const* data, const size_t* sizes, size_t count)
+{
+    Rows rows;
+    size_t nblocks[LANES];
+    size_t max_blocks = 0;
+
+    for (size_t l = 0; l < count; ++l) {
+        nblocks[l] = sizes[l] / 8;
+        if (nblocks[l] > max_blocks) {
+            max_blocks = nblocks[l];
+        }
+    }
+    std::memset(rows, 0, sizeof(rows));
+
+    if (encrypt) {
+        // Block cipher in reverse CBC mode, starting from the last block of each message.
+        // The IV after last block is zero. The intermediate blocks replace the message blocks.
+        for (size_t t = 0; t < max_blocks; ++t) {
+            for (size_t l = 0; l < count; ++l) {
+                if (t < nblocks[l]) {
+                    const uint8_t* const blk = data[l] + 8 * (nblocks[l] - 1 - t);
+                    for (size_t k = 0; k < 8; ++k) {
+                        rows[k][l] = t == 0 ? blk[k] : blk[k] ^ blk[k + 8];
+                    }
+                }
+            }
+            const size_t base = Encipher(kk, rows, count);
+            for (size_t l = 0; l < count; ++l) {
+                if (t < nblocks[l]) {
+                    uint8_t* const blk = data[l] + 8 * (nblocks[l] - 1 - t);
+                    for (size_t k = 0; k < 8; ++k) {
+                        blk[k] = rows[(base + k) & 7][l];
+                    }
+                }
+            }
+        }
+        // The first block is scrambled using the block cipher only.
+        // Its scrambled value is used to initialize the stream cipher.
+        StreamCipher(key, data, sizes, count);
+    }
+    else {
+        // Initialize the stream cipher with the first block and descramble the rest.
+        // The message now contains the intermediate blocks, followed by the clear residue.
+        StreamCipher(key, data, sizes, count);
+
+        // Decipher intermediate blocks: plain[i-1] = ib[i] ^ decipher(ib[i-1]) and the last IV is zero.
+        for (size_t i = 1; i <= max_blocks; ++i) {
+            for (size_t l = 0; l < count; ++l) {
+                if (i <= nblocks[l]) {
+                    const uint8_t* const blk = data[l] + 8 * (i - 1);
+                    for (size_t k = 0; k < 8; ++k) {
+                        rows[k][l] = blk[k];
+                    }
+                }
+            }
+            const size_t base = Decipher(kk, rows, count);
+            for (size_t l = 0; l < count; ++l) {
+                if (i <= nblocks[l]) {
+                    uint8_t* const blk = data[l] + 8 * (i - 1);
+                    for (size_t k = 0; k < 8; ++k) {
+                        blk[k] = i < nblocks[l] ? rows[(base + k) & 7][l] ^ blk[k + 8] : rows[(base + k) & 7][l];
+                    }
+                }
+            }
+        }
+    }
+}
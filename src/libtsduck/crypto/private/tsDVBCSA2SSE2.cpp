@@ -0,0 +1,71 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  DVB CSA-2 batch engine using SSE2 instructions.
+//  With GCC and clang, this module is compiled with SSE2 code generation.
+//  With MSVC, the SSE2 intrinsics are always available.
+//
+//----------------------------------------------------------------------------
+
+#include "tsDVBCSA2Batch.h"
+
+#if defined(__SSE2__) || (defined(TS_MSC) && (defined(TS_X86_64) || defined(TS_I386)))
+
+#include <emmintrin.h>
+
+namespace {
+    //
+    // A 128-bit SSE2 register, one bit per lane.
+    //
+    class WordSSE2
+    {
+    private:
+        __m128i _v;
+    public:
+        static constexpr size_t BITS = 128;
+        WordSSE2() : _v(_mm_setzero_si128()) {}
+        WordSSE2(__m128i v) : _v(v) {}
+        static WordSSE2 Zero() { return WordSSE2(_mm_setzero_si128()); }
+        static WordSSE2 Ones() { return WordSSE2(_mm_set1_epi32(-1)); }
+        static WordSSE2 Load(const uint8_t* p) { __m128i v; std::memcpy(&v, p, sizeof(v)); return WordSSE2(v); }
+        void store(uint8_t* p) const { std::memcpy(p, &_v, sizeof(_v)); }
+        friend WordSSE2 operator^(WordSSE2 a, WordSSE2 b) { return WordSSE2(_mm_xor_si128(a._v, b._v)); }
+        friend WordSSE2 operator&(WordSSE2 a, WordSSE2 b) { return WordSSE2(_mm_and_si128(a._v, b._v)); }
+        friend WordSSE2 operator|(WordSSE2 a, WordSSE2 b) { return WordSSE2(_mm_or_si128(a._v, b._v)); }
+    };
+}
+
+const ts::dvbcsa2::BatchFunction ts::dvbcsa2::ProcessSSE2 = ts::dvbcsa2::BatchEngine<WordSSE2>::Process;
+
+#else
+
+// SSE2 is not supported by the compiler or the target CPU.
+const ts::dvbcsa2::BatchFunction ts::dvbcsa2::ProcessSSE2 = nullptr;
+
+#endif
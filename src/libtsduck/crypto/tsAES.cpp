@@ -14,8 +14,20 @@
 //----------------------------------------------------------------------------
 
 #include "tsAES.h"
+#include "tsAESAccel.h"
 #include "tsRotate.h"
 
+#if (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_MSC)
+    #include <intrin.h>
+#elif (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_GCC)
+    #include <cpuid.h>
+#elif defined(TS_ARM64) && defined(TS_LINUX)
+    #include <sys/auxv.h>
+    #if !defined(HWCAP_AES)
+        #define HWCAP_AES (1 << 3)
+    #endif
+#endif
+
 #define BYTE(x,n) (((x) >> (8 * (n))) & 255)
 
 namespace {
@@ -1009,6 +1021,46 @@ namespace {
                (Te4_1[BYTE (temp, 0)]) ^
                (Te4_0[BYTE (temp, 3)]);
     }
+
+    // Check if the CPU supports AES instructions.
+    bool CPUHasAES()
+    {
+#if (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_MSC)
+        int info[4];
+        ::__cpuid(info, 1);
+        return (info[2] & (1 << 25)) != 0;
+#elif (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_GCC)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        return ::__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_AES) != 0;
+#elif defined(TS_ARM64) && defined(TS_LINUX)
+        return (::getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#elif defined(TS_ARM64) && defined(TS_MAC)
+        return true; // all Apple Arm processors
+#else
+        return false;
+#endif
+    }
+
+    // Hardware-accelerated functions, null pointers if not supported on this CPU.
+    // The CPU features are checked only once.
+    ts::aesaccel::BlocksFunction AccelEncrypt()
+    {
+        static const ts::aesaccel::BlocksFunction func =
+            !CPUHasAES() ? nullptr : (ts::aesaccel::EncryptAESNI != nullptr ? ts::aesaccel::EncryptAESNI : ts::aesaccel::EncryptARMv8);
+        return func;
+    }
+
+    ts::aesaccel::BlocksFunction AccelDecrypt()
+    {
+        static const ts::aesaccel::BlocksFunction func =
+            !CPUHasAES() ? nullptr : (ts::aesaccel::DecryptAESNI != nullptr ? ts::aesaccel::DecryptAESNI : ts::aesaccel::DecryptARMv8);
+        return func;
+    }
+}
+
+bool ts::AES::IsAccelerated()
+{
+    return AccelEncrypt() != nullptr && AccelDecrypt() != nullptr;
 }
 
 
@@ -1164,6 +1216,14 @@ bool ts::AES::setKeyImpl(const void* key_, size_t key_length, size_t rounds)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+    // Hardware acceleration uses the same key schedules as byte arrays.
+    if (IsAccelerated()) {
+        for (i = 0; i < 4 * (_Nr + 1); i++) {
+            PutUInt32(_eKb + 4 * i, _eK[i]);
+            PutUInt32(_dKb + 4 * i, _dK[i]);
+        }
+    }
+
     return true;
 }
 
@@ -1181,6 +1241,16 @@ bool ts::AES::encryptImpl(const void* plain, size_t plain_length, void* cipher,
     const uint8_t* pt = reinterpret_cast<const uint8_t*> (plain);
     uint8_t* ct = reinterpret_cast<uint8_t*> (cipher);
 
+    // Use hardware acceleration when available.
+    const aesaccel::BlocksFunction accel = AccelEncrypt();
+    if (accel != nullptr) {
+        accel(_eKb, size_t(_Nr), pt, ct, 1);
+        if (cipher_length != nullptr) {
+            *cipher_length = BLOCK_SIZE;
+        }
+        return true;
+    }
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1306,6 +1376,16 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
 
+    // Use hardware acceleration when available.
+    const aesaccel::BlocksFunction accel = AccelDecrypt();
+    if (accel != nullptr) {
+        accel(_dKb, size_t(_Nr), ct, pt, 1);
+        if (plain_length != nullptr) {
+            *plain_length = BLOCK_SIZE;
+        }
+        return true;
+    }
+
     uint32_t s0, s1, s2, s3, t0, t1, t2, t3, *rk;
     int Nr, r;
 
@@ -1426,8 +1506,37 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
 ts::AES::AES() :
     _Nr(0),
     _eK(),
-    _dK()
+    _dK(),
+    _eKb(),
+    _dKb()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Encryption and decryption of several blocks in ECB mode.
+//----------------------------------------------------------------------------
+
+bool ts::AES::encryptBlocksImpl(const void* plain, void* cipher, size_t count)
+{
+    // Process several blocks in parallel with hardware acceleration.
+    const aesaccel::BlocksFunction accel = AccelEncrypt();
+    if (accel == nullptr) {
+        return BlockCipher::encryptBlocksImpl(plain, cipher, count);
+    }
+    accel(_eKb, size_t(_Nr), reinterpret_cast<const uint8_t*>(plain), reinterpret_cast<uint8_t*>(cipher), count);
+    return true;
+}
+
+bool ts::AES::decryptBlocksImpl(const void* cipher, void* plain, size_t count)
 {
+    // Process several blocks in parallel with hardware acceleration.
+    const aesaccel::BlocksFunction accel = AccelDecrypt();
+    if (accel == nullptr) {
+        return BlockCipher::decryptBlocksImpl(cipher, plain, count);
+    }
+    accel(_dKb, size_t(_Nr), reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), count);
+    return true;
 }
 
 
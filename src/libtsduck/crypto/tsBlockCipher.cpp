@@ -185,3 +185,65 @@ bool ts::BlockCipher::decryptInPlaceImpl(void* data, size_t data_length, size_t*
     const size_t plain_max_size = max_actual_length != nullptr ? *max_actual_length : data_length;
     return decryptImpl(cipher.data(), cipher.size(), data, plain_max_size, max_actual_length);
 }
+
+
+//----------------------------------------------------------------------------
+// Encrypt several contiguous blocks of data.
+//----------------------------------------------------------------------------
+
+bool ts::BlockCipher::encryptBlocks(const void* plain, void* cipher, size_t count)
+{
+    return allowEncrypt() && encryptBlocksImpl(plain, cipher, count);
+}
+
+bool ts::BlockCipher::encryptBlocksImpl(const void* plain, void* cipher, size_t count)
+{
+    const size_t bsize = blockSize();
+    const uint8_t* pt = reinterpret_cast<const uint8_t*>(plain);
+    uint8_t* ct = reinterpret_cast<uint8_t*>(cipher);
+
+    // Use an intermediate block when encrypting in place.
+    ByteBlock work(pt == ct ? bsize : 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (pt == ct) {
+            work.copy(pt, bsize);
+        }
+        if (!encryptImpl(pt == ct ? work.data() : pt, bsize, ct, bsize, nullptr)) {
+            return false;
+        }
+        pt += bsize;
+        ct += bsize;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt several contiguous blocks of data.
+//----------------------------------------------------------------------------
+
+bool ts::BlockCipher::decryptBlocks(const void* cipher, void* plain, size_t count)
+{
+    return allowDecrypt() && decryptBlocksImpl(cipher, plain, count);
+}
+
+bool ts::BlockCipher::decryptBlocksImpl(const void* cipher, void* plain, size_t count)
+{
+    const size_t bsize = blockSize();
+    const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
+    uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
+
+    // Use an intermediate block when decrypting in place.
+    ByteBlock work(pt == ct ? bsize : 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (pt == ct) {
+            work.copy(ct, bsize);
+        }
+        if (!decryptImpl(pt == ct ? work.data() : ct, bsize, pt, bsize, nullptr)) {
+            return false;
+        }
+        pt += bsize;
+        ct += bsize;
+    }
+    return true;
+}
@@ -189,6 +189,34 @@ namespace ts {
         //!
         bool decryptInPlace(void* data, size_t data_length, size_t* max_actual_length = nullptr);
 
+        //!
+        //! Encrypt several contiguous blocks of data, independently from each other (ECB).
+        //!
+        //! This is equivalent to one call to encrypt() per block but some block ciphers
+        //! process several blocks in parallel. This is typically used by chaining modes.
+        //! The operation counts as one single encryption with the current key.
+        //!
+        //! @param [in] plain Address of plain text blocks.
+        //! @param [out] cipher Address of buffer for cipher text blocks. Can be the same as @a plain.
+        //! @param [in] count Number of blocks of blockSize() bytes.
+        //! @return True on success, false on error.
+        //!
+        bool encryptBlocks(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several contiguous blocks of data, independently from each other (ECB).
+        //!
+        //! This is equivalent to one call to decrypt() per block but some block ciphers
+        //! process several blocks in parallel. This is typically used by chaining modes.
+        //! The operation counts as one single decryption with the current key.
+        //!
+        //! @param [in] cipher Address of cipher text blocks.
+        //! @param [out] plain Address of buffer for plain text blocks. Can be the same as @a cipher.
+        //! @param [in] count Number of blocks of blockSize() bytes.
+        //! @return True on success, false on error.
+        //!
+        bool decryptBlocks(const void* cipher, void* plain, size_t count);
+
         //!
         //! Get the number of times the current key was used for encryption.
         //! @return The number of times the current key was used for encryption.
@@ -314,6 +342,42 @@ namespace ts {
         //!
         virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length);
 
+        //!
+        //! Encrypt several contiguous blocks of data (implementation of algorithm-specific part).
+        //! The default implementation is to call encryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] plain Address of plain text blocks.
+        //! @param [out] cipher Address of buffer for cipher text blocks. Can be the same as @a plain.
+        //! @param [in] count Number of blocks of blockSize() bytes.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocksImpl(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several contiguous blocks of data (implementation of algorithm-specific part).
+        //! The default implementation is to call decryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] cipher Address of cipher text blocks.
+        //! @param [out] plain Address of buffer for plain text blocks. Can be the same as @a cipher.
+        //! @param [in] count Number of blocks of blockSize() bytes.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptBlocksImpl(const void* cipher, void* plain, size_t count);
+
+        //!
+        //! Check if one encryption is allowed with the current key and count it.
+        //! Subclasses which encrypt several messages at once shall call it once per message.
+        //! @return True if the encryption is allowed.
+        //!
+        bool allowEncrypt();
+
+        //!
+        //! Check if one decryption is allowed with the current key and count it.
+        //! Subclasses which decrypt several messages at once shall call it once per message.
+        //! @return True if the decryption is allowed.
+        //!
+        bool allowDecrypt();
+
     private:
         bool      _key_set;                // Current key successfully set.
         int       _cipher_id;              // Cipher identity (from application).
@@ -323,9 +387,5 @@ namespace ts {
         size_t    _key_decrypt_max;        // Maximum number of times a key should be used for decryption.
         ByteBlock _current_key;            // Current unscheduled key.
         BlockCipherAlertInterface* _alert; // Alert handler.
-
-        // Check if encryption or decryption is allowed. Increment counters.
-        bool allowEncrypt();
-        bool allowDecrypt();
     };
 }
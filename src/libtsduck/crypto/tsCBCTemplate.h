@@ -88,7 +88,7 @@ bool ts::CBC<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
 {
     if (this->algo == nullptr ||
         this->iv.size() != this->block_size ||
-        this->work.size() < this->block_size ||
+        this->work.size() < 2 * this->block_size ||
         cipher_length % this->block_size != 0 ||
         plain_maxsize < cipher_length)
     {
@@ -98,28 +98,9 @@ bool ts::CBC<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
         *plain_length = cipher_length;
     }
 
+    // Unlike encryption, the block decryptions are independent and are processed several at a time.
     const uint8_t* previous = this->iv.data();
-    const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
-    uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
-
-    while (cipher_length > 0) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
-            return false;
-        }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
-    }
-
-    return true;
+    return this->decryptBlocksCBC(reinterpret_cast<const uint8_t*>(cipher), reinterpret_cast<uint8_t*>(plain), cipher_length / this->block_size, previous);
 }
 
 
@@ -37,7 +37,7 @@
 
 template<class CIPHER>
 ts::CTR<CIPHER>::CTR(size_t counter_bits) :
-    CipherChainingTemplate<CIPHER>(1, 1, 2),
+    CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS + 1),
     _counter_bits(0)
 {
     setCounterBits(counter_bits);
@@ -133,27 +133,34 @@ bool ts::CTR<CIPHER>::encryptImpl(const void* plain, size_t plain_length, void*
     // work[0] = iv
     ::memcpy(this->work.data(), this->iv.data(), this->block_size);
 
-    // Loop on all blocks, including last truncated one.
+    // Loop on all groups of blocks, including last truncated one.
+    // The key stream blocks are independent and are computed several at a time in work[1..n].
 
+    const size_t group_max = std::min(CipherChaining::PARALLEL_BLOCKS, this->work.size() / this->block_size - 1);
+    uint8_t* const stream = this->work.data() + this->block_size;
     const uint8_t* pt = reinterpret_cast<const uint8_t*>(plain);
     uint8_t* ct = reinterpret_cast<uint8_t*>(cipher);
 
     while (plain_length > 0) {
-        // work[1] = encrypt(work[0])
-        if (!this->algo->encrypt(this->work.data(), this->block_size, this->work.data() + this->block_size, this->block_size)) {
+        // work[1..n] = successive values of work[0], work[0] += n
+        size_t count = 0;
+        for (size_t len = 0; count < group_max && len < plain_length; len += this->block_size) {
+            ::memcpy(stream + count++ * this->block_size, this->work.data(), this->block_size);
+            if (!incrementCounter()) {
+                return false;
+            }
+        }
+        // work[1..n] = encrypt(work[1..n])
+        if (!this->algo->encryptBlocks(stream, stream, count)) {
             return false;
         }
-        // This block size:
-        const size_t size = std::min(plain_length, this->block_size);
-        // cipher-text = plain-text XOR work[1]
+        // This group size:
+        const size_t size = std::min(plain_length, count * this->block_size);
+        // cipher-text = plain-text XOR work[1..n]
         for (size_t i = 0; i < size; ++i) {
-            ct[i] = this->work[this->block_size + i] ^ pt[i];
-        }
-        // work[0] += 1
-        if (!incrementCounter()) {
-            return false;
+            ct[i] = stream[i] ^ pt[i];
         }
-        // advance one block
+        // advance one group
         ct += size;
         pt += size;
         plain_length -= size;
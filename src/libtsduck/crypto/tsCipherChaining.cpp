@@ -29,6 +29,10 @@
 
 #include "tsCipherChaining.h"
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::CipherChaining::PARALLEL_BLOCKS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor for subclasses
@@ -124,3 +128,45 @@ bool ts::CipherChaining::setIV(const void* iv_data, size_t iv_length)
         return true;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Decrypt contiguous blocks in CBC mode, several blocks at a time.
+//----------------------------------------------------------------------------
+
+bool ts::CipherChaining::decryptBlocksCBC(const uint8_t* cipher, uint8_t* plain, size_t count, const uint8_t*& previous)
+{
+    // The work buffer contains the decrypted blocks of a group, followed by a copy of the last cipher block.
+    const size_t group_max = block_size == 0 ? 0 : std::min(PARALLEL_BLOCKS, work.size() / block_size - 1);
+    if (algo == nullptr || group_max == 0 || previous == nullptr) {
+        return false;
+    }
+    uint8_t* const saved = work.data() + group_max * block_size;
+
+    while (count > 0) {
+        const size_t group = std::min(count, group_max);
+        const size_t group_size = group * block_size;
+
+        // work = decrypt (cipher-text), all blocks at once.
+        if (!algo->decryptBlocks(cipher, work.data(), group)) {
+            return false;
+        }
+        // First block: work XOR previous-cipher. The previous cipher block may be the saved one.
+        for (size_t i = 0; i < block_size; ++i) {
+            work[i] ^= previous[i];
+        }
+        // Save the last cipher block before overwriting it when decrypting in place.
+        ::memcpy(saved, cipher + group_size - block_size, block_size);
+        // Other blocks, backward: plain-text = work XOR previous-cipher.
+        for (size_t i = group_size; i-- > block_size; ) {
+            plain[i] = work[i] ^ cipher[i - block_size];
+        }
+        ::memcpy(plain, work.data(), block_size);
+
+        previous = saved;
+        cipher += group_size;
+        plain += group_size;
+        count -= group;
+    }
+    return true;
+}
@@ -92,6 +92,12 @@ namespace ts {
         virtual bool residueAllowed() const = 0;
 
     protected:
+        //!
+        //! Number of blocks which are processed at once by the chaining modes which
+        //! can process several independent blocks in parallel.
+        //!
+        static constexpr size_t PARALLEL_BLOCKS = 8;
+
         // Protected fields, for chaining mode subclass implementation.
         BlockCipher* algo;        //!< An instance of the block cipher.
         const size_t block_size;  //!< Shortcut for algo->blockSize().
@@ -112,6 +118,20 @@ namespace ts {
                        size_t iv_max_blocks = 1,
                        size_t work_blocks = 1);
 
+        //!
+        //! Decrypt contiguous blocks in CBC mode, using the work buffer.
+        //! The block decryptions are independent and are processed by groups of at most
+        //! PARALLEL_BLOCKS blocks, depending on the size of the work buffer. The work
+        //! buffer must contain at least two blocks.
+        //! @param [in] cipher Address of cipher text blocks.
+        //! @param [out] plain Address of buffer for plain text blocks. Can be the same as @a cipher.
+        //! @param [in] count Number of blocks.
+        //! @param [in,out] previous Previous cipher block, initially the IV. On output, point to
+        //! a copy of the last cipher block in the work buffer. Unmodified if @a count is zero.
+        //! @return True on success, false on error.
+        //!
+        bool decryptBlocksCBC(const uint8_t* cipher, uint8_t* plain, size_t count, const uint8_t*& previous);
+
         // Implementation of BlockCipher interface:
         virtual bool setKeyImpl(const void* key, size_t key_length, size_t rounds) override;
     };
@@ -10,6 +10,11 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#include "tsDVBCSA2Batch.h"
+
+#if defined(TS_MSC)
+    #include <intrin.h>
+#endif
 
 // Operations on 64-bit areas.
 
@@ -59,6 +64,7 @@ bool ts::DVBCSA2::IsReducedCW(const uint8_t *cw)
 ts::DVBCSA2::DVBCSA2(EntropyMode mode) :
     _init(false),
     _mode(mode),
+    _engine(BestBatchEngine()),
     _block(),
     _stream()
 {
@@ -86,54 +92,14 @@ namespace {
     // reg q,           1 bit
     // reg r,           1 bit
 
-    const int sbox1[32] = {
-        2,0,1,1,2,3,3,0,
-        3,2,2,0,1,1,0,3,
-        0,3,3,0,2,2,1,1,
-        2,2,0,3,1,1,3,0
-    };
-
-    const int sbox2[32] = {
-        3,1,0,2,2,3,3,0,
-        1,3,2,1,0,0,1,2,
-        3,1,0,3,3,2,0,2,
-        0,0,1,2,2,1,3,1
-    };
-
-    const int sbox3[32] = {
-        2,0,1,2,2,3,3,1,
-        1,1,0,3,3,0,2,0,
-        1,3,0,1,3,0,2,2,
-        2,0,1,2,0,3,3,1
-    };
-
-    const int sbox4[32] = {
-        3,1,2,3,0,2,1,2,
-        1,2,0,1,3,0,0,3,
-        1,0,3,1,2,3,0,3,
-        0,3,2,0,1,2,2,1
-    };
-
-    const int sbox5[32] = {
-        2,0,0,1,3,2,3,2,
-        0,1,3,3,1,0,2,1,
-        2,3,2,0,0,3,1,1,
-        1,0,3,2,3,1,0,2
-    };
-
-    const int sbox6[32] = {
-        0,1,2,3,1,2,2,0,
-        0,1,3,0,2,3,1,3,
-        2,3,0,2,3,0,1,1,
-        2,1,1,2,0,3,3,0
-    };
-
-    const int sbox7[32] = {
-        0,3,2,2,3,0,0,1,
-        3,0,1,3,1,2,2,1,
-        1,0,3,3,0,1,1,2,
-        2,3,1,0,2,3,0,2
-    };
+    // The S-boxes are shared with the batch engines.
+    using ts::dvbcsa2::sbox1;
+    using ts::dvbcsa2::sbox2;
+    using ts::dvbcsa2::sbox3;
+    using ts::dvbcsa2::sbox4;
+    using ts::dvbcsa2::sbox5;
+    using ts::dvbcsa2::sbox6;
+    using ts::dvbcsa2::sbox7;
 }
 
 
@@ -351,83 +317,87 @@ namespace {
         0x20, 0x3F, 0x2E, 0x0F, 0x03, 0x26, 0x10, 0x37
     };
 
-    // S-Box
-
-    const uint8_t block_sbox[256] = {
-        0x3A, 0xEA, 0x68, 0xFE, 0x33, 0xE9, 0x88, 0x1A,
-        0x83, 0xCF, 0xE1, 0x7F, 0xBA, 0xE2, 0x38, 0x12,
-        0xE8, 0x27, 0x61, 0x95, 0x0C, 0x36, 0xE5, 0x70,
-        0xA2, 0x06, 0x82, 0x7C, 0x17, 0xA3, 0x26, 0x49,
-        0xBE, 0x7A, 0x6D, 0x47, 0xC1, 0x51, 0x8F, 0xF3,
-        0xCC, 0x5B, 0x67, 0xBD, 0xCD, 0x18, 0x08, 0xC9,
-        0xFF, 0x69, 0xEF, 0x03, 0x4E, 0x48, 0x4A, 0x84,
-        0x3F, 0xB4, 0x10, 0x04, 0xDC, 0xF5, 0x5C, 0xC6,
-        0x16, 0xAB, 0xAC, 0x4C, 0xF1, 0x6A, 0x2F, 0x3C,
-        0x3B, 0xD4, 0xD5, 0x94, 0xD0, 0xC4, 0x63, 0x62,
-        0x71, 0xA1, 0xF9, 0x4F, 0x2E, 0xAA, 0xC5, 0x56,
-        0xE3, 0x39, 0x93, 0xCE, 0x65, 0x64, 0xE4, 0x58,
-        0x6C, 0x19, 0x42, 0x79, 0xDD, 0xEE, 0x96, 0xF6,
-        0x8A, 0xEC, 0x1E, 0x85, 0x53, 0x45, 0xDE, 0xBB,
-        0x7E, 0x0A, 0x9A, 0x13, 0x2A, 0x9D, 0xC2, 0x5E,
-        0x5A, 0x1F, 0x32, 0x35, 0x9C, 0xA8, 0x73, 0x30,
-
-        0x29, 0x3D, 0xE7, 0x92, 0x87, 0x1B, 0x2B, 0x4B,
-        0xA5, 0x57, 0x97, 0x40, 0x15, 0xE6, 0xBC, 0x0E,
-        0xEB, 0xC3, 0x34, 0x2D, 0xB8, 0x44, 0x25, 0xA4,
-        0x1C, 0xC7, 0x23, 0xED, 0x90, 0x6E, 0x50, 0x00,
-        0x99, 0x9E, 0x4D, 0xD9, 0xDA, 0x8D, 0x6F, 0x5F,
-        0x3E, 0xD7, 0x21, 0x74, 0x86, 0xDF, 0x6B, 0x05,
-        0x8E, 0x5D, 0x37, 0x11, 0xD2, 0x28, 0x75, 0xD6,
-        0xA7, 0x77, 0x24, 0xBF, 0xF0, 0xB0, 0x02, 0xB7,
-        0xF8, 0xFC, 0x81, 0x09, 0xB1, 0x01, 0x76, 0x91,
-        0x7D, 0x0F, 0xC8, 0xA0, 0xF2, 0xCB, 0x78, 0x60,
-        0xD1, 0xF7, 0xE0, 0xB5, 0x98, 0x22, 0xB3, 0x20,
-        0x1D, 0xA6, 0xDB, 0x7B, 0x59, 0x9F, 0xAE, 0x31,
-        0xFB, 0xD3, 0xB6, 0xCA, 0x43, 0x72, 0x07, 0xF4,
-        0xD8, 0x41, 0x14, 0x55, 0x0D, 0x54, 0x8B, 0xB9,
-        0xAD, 0x46, 0x0B, 0xAF, 0x80, 0x52, 0x2C, 0xFA,
-        0x8C, 0x89, 0x66, 0xFD, 0xB2, 0xA9, 0x9B, 0xC0
-    };
-
-    // Permutations
-
-    const int block_perm[256] = {
-        0x00, 0x02, 0x80, 0x82, 0x20, 0x22, 0xA0, 0xA2,
-        0x10, 0x12, 0x90, 0x92, 0x30, 0x32, 0xB0, 0xB2,
-        0x04, 0x06, 0x84, 0x86, 0x24, 0x26, 0xA4, 0xA6,
-        0x14, 0x16, 0x94, 0x96, 0x34, 0x36, 0xB4, 0xB6,
-        0x40, 0x42, 0xC0, 0xC2, 0x60, 0x62, 0xE0, 0xE2,
-        0x50, 0x52, 0xD0, 0xD2, 0x70, 0x72, 0xF0, 0xF2,
-        0x44, 0x46, 0xC4, 0xC6, 0x64, 0x66, 0xE4, 0xE6,
-        0x54, 0x56, 0xD4, 0xD6, 0x74, 0x76, 0xF4, 0xF6,
-        0x01, 0x03, 0x81, 0x83, 0x21, 0x23, 0xA1, 0xA3,
-        0x11, 0x13, 0x91, 0x93, 0x31, 0x33, 0xB1, 0xB3,
-        0x05, 0x07, 0x85, 0x87, 0x25, 0x27, 0xA5, 0xA7,
-        0x15, 0x17, 0x95, 0x97, 0x35, 0x37, 0xB5, 0xB7,
-        0x41, 0x43, 0xC1, 0xC3, 0x61, 0x63, 0xE1, 0xE3,
-        0x51, 0x53, 0xD1, 0xD3, 0x71, 0x73, 0xF1, 0xF3,
-        0x45, 0x47, 0xC5, 0xC7, 0x65, 0x67, 0xE5, 0xE7,
-        0x55, 0x57, 0xD5, 0xD7, 0x75, 0x77, 0xF5, 0xF7,
-
-        0x08, 0x0A, 0x88, 0x8A, 0x28, 0x2A, 0xA8, 0xAA,
-        0x18, 0x1A, 0x98, 0x9A, 0x38, 0x3A, 0xB8, 0xBA,
-        0x0C, 0x0E, 0x8C, 0x8E, 0x2C, 0x2E, 0xAC, 0xAE,
-        0x1C, 0x1E, 0x9C, 0x9E, 0x3C, 0x3E, 0xBC, 0xBE,
-        0x48, 0x4A, 0xC8, 0xCA, 0x68, 0x6A, 0xE8, 0xEA,
-        0x58, 0x5A, 0xD8, 0xDA, 0x78, 0x7A, 0xF8, 0xFA,
-        0x4C, 0x4E, 0xCC, 0xCE, 0x6C, 0x6E, 0xEC, 0xEE,
-        0x5C, 0x5E, 0xDC, 0xDE, 0x7C, 0x7E, 0xFC, 0xFE,
-        0x09, 0x0B, 0x89, 0x8B, 0x29, 0x2B, 0xA9, 0xAB,
-        0x19, 0x1B, 0x99, 0x9B, 0x39, 0x3B, 0xB9, 0xBB,
-        0x0D, 0x0F, 0x8D, 0x8F, 0x2D, 0x2F, 0xAD, 0xAF,
-        0x1D, 0x1F, 0x9D, 0x9F, 0x3D, 0x3F, 0xBD, 0xBF,
-        0x49, 0x4B, 0xC9, 0xCB, 0x69, 0x6B, 0xE9, 0xEB,
-        0x59, 0x5B, 0xD9, 0xDB, 0x79, 0x7B, 0xF9, 0xFB,
-        0x4D, 0x4F, 0xCD, 0xCF, 0x6D, 0x6F, 0xED, 0xEF,
-        0x5D, 0x5F, 0xDD, 0xDF, 0x7D, 0x7F, 0xFD, 0xFF
-    };
+    // The S-box and permutations are shared with the batch engines.
+    using ts::dvbcsa2::block_sbox;
+    using ts::dvbcsa2::block_perm;
 }
 
+// S-Box, shared with the batch engines.
+
+const uint8_t ts::dvbcsa2::block_sbox[256] = {
+    0x3A, 0xEA, 0x68, 0xFE, 0x33, 0xE9, 0x88, 0x1A,
+    0x83, 0xCF, 0xE1, 0x7F, 0xBA, 0xE2, 0x38, 0x12,
+    0xE8, 0x27, 0x61, 0x95, 0x0C, 0x36, 0xE5, 0x70,
+    0xA2, 0x06, 0x82, 0x7C, 0x17, 0xA3, 0x26, 0x49,
+    0xBE, 0x7A, 0x6D, 0x47, 0xC1, 0x51, 0x8F, 0xF3,
+    0xCC, 0x5B, 0x67, 0xBD, 0xCD, 0x18, 0x08, 0xC9,
+    0xFF, 0x69, 0xEF, 0x03, 0x4E, 0x48, 0x4A, 0x84,
+    0x3F, 0xB4, 0x10, 0x04, 0xDC, 0xF5, 0x5C, 0xC6,
+    0x16, 0xAB, 0xAC, 0x4C, 0xF1, 0x6A, 0x2F, 0x3C,
+    0x3B, 0xD4, 0xD5, 0x94, 0xD0, 0xC4, 0x63, 0x62,
+    0x71, 0xA1, 0xF9, 0x4F, 0x2E, 0xAA, 0xC5, 0x56,
+    0xE3, 0x39, 0x93, 0xCE, 0x65, 0x64, 0xE4, 0x58,
+    0x6C, 0x19, 0x42, 0x79, 0xDD, 0xEE, 0x96, 0xF6,
+    0x8A, 0xEC, 0x1E, 0x85, 0x53, 0x45, 0xDE, 0xBB,
+    0x7E, 0x0A, 0x9A, 0x13, 0x2A, 0x9D, 0xC2, 0x5E,
+    0x5A, 0x1F, 0x32, 0x35, 0x9C, 0xA8, 0x73, 0x30,
+
+    0x29, 0x3D, 0xE7, 0x92, 0x87, 0x1B, 0x2B, 0x4B,
+    0xA5, 0x57, 0x97, 0x40, 0x15, 0xE6, 0xBC, 0x0E,
+    0xEB, 0xC3, 0x34, 0x2D, 0xB8, 0x44, 0x25, 0xA4,
+    0x1C, 0xC7, 0x23, 0xED, 0x90, 0x6E, 0x50, 0x00,
+    0x99, 0x9E, 0x4D, 0xD9, 0xDA, 0x8D, 0x6F, 0x5F,
+    0x3E, 0xD7, 0x21, 0x74, 0x86, 0xDF, 0x6B, 0x05,
+    0x8E, 0x5D, 0x37, 0x11, 0xD2, 0x28, 0x75, 0xD6,
+    0xA7, 0x77, 0x24, 0xBF, 0xF0, 0xB0, 0x02, 0xB7,
+    0xF8, 0xFC, 0x81, 0x09, 0xB1, 0x01, 0x76, 0x91,
+    0x7D, 0x0F, 0xC8, 0xA0, 0xF2, 0xCB, 0x78, 0x60,
+    0xD1, 0xF7, 0xE0, 0xB5, 0x98, 0x22, 0xB3, 0x20,
+    0x1D, 0xA6, 0xDB, 0x7B, 0x59, 0x9F, 0xAE, 0x31,
+    0xFB, 0xD3, 0xB6, 0xCA, 0x43, 0x72, 0x07, 0xF4,
+    0xD8, 0x41, 0x14, 0x55, 0x0D, 0x54, 0x8B, 0xB9,
+    0xAD, 0x46, 0x0B, 0xAF, 0x80, 0x52, 0x2C, 0xFA,
+    0x8C, 0x89, 0x66, 0xFD, 0xB2, 0xA9, 0x9B, 0xC0
+};
+
+// Permutations, shared with the batch engines.
+
+const uint8_t ts::dvbcsa2::block_perm[256] = {
+    0x00, 0x02, 0x80, 0x82, 0x20, 0x22, 0xA0, 0xA2,
+    0x10, 0x12, 0x90, 0x92, 0x30, 0x32, 0xB0, 0xB2,
+    0x04, 0x06, 0x84, 0x86, 0x24, 0x26, 0xA4, 0xA6,
+    0x14, 0x16, 0x94, 0x96, 0x34, 0x36, 0xB4, 0xB6,
+    0x40, 0x42, 0xC0, 0xC2, 0x60, 0x62, 0xE0, 0xE2,
+    0x50, 0x52, 0xD0, 0xD2, 0x70, 0x72, 0xF0, 0xF2,
+    0x44, 0x46, 0xC4, 0xC6, 0x64, 0x66, 0xE4, 0xE6,
+    0x54, 0x56, 0xD4, 0xD6, 0x74, 0x76, 0xF4, 0xF6,
+    0x01, 0x03, 0x81, 0x83, 0x21, 0x23, 0xA1, 0xA3,
+    0x11, 0x13, 0x91, 0x93, 0x31, 0x33, 0xB1, 0xB3,
+    0x05, 0x07, 0x85, 0x87, 0x25, 0x27, 0xA5, 0xA7,
+    0x15, 0x17, 0x95, 0x97, 0x35, 0x37, 0xB5, 0xB7,
+    0x41, 0x43, 0xC1, 0xC3, 0x61, 0x63, 0xE1, 0xE3,
+    0x51, 0x53, 0xD1, 0xD3, 0x71, 0x73, 0xF1, 0xF3,
+    0x45, 0x47, 0xC5, 0xC7, 0x65, 0x67, 0xE5, 0xE7,
+    0x55, 0x57, 0xD5, 0xD7, 0x75, 0x77, 0xF5, 0xF7,
+
+    0x08, 0x0A, 0x88, 0x8A, 0x28, 0x2A, 0xA8, 0xAA,
+    0x18, 0x1A, 0x98, 0x9A, 0x38, 0x3A, 0xB8, 0xBA,
+    0x0C, 0x0E, 0x8C, 0x8E, 0x2C, 0x2E, 0xAC, 0xAE,
+    0x1C, 0x1E, 0x9C, 0x9E, 0x3C, 0x3E, 0xBC, 0xBE,
+    0x48, 0x4A, 0xC8, 0xCA, 0x68, 0x6A, 0xE8, 0xEA,
+    0x58, 0x5A, 0xD8, 0xDA, 0x78, 0x7A, 0xF8, 0xFA,
+    0x4C, 0x4E, 0xCC, 0xCE, 0x6C, 0x6E, 0xEC, 0xEE,
+    0x5C, 0x5E, 0xDC, 0xDE, 0x7C, 0x7E, 0xFC, 0xFE,
+    0x09, 0x0B, 0x89, 0x8B, 0x29, 0x2B, 0xA9, 0xAB,
+    0x19, 0x1B, 0x99, 0x9B, 0x39, 0x3B, 0xB9, 0xBB,
+    0x0D, 0x0F, 0x8D, 0x8F, 0x2D, 0x2F, 0xAD, 0xAF,
+    0x1D, 0x1F, 0x9D, 0x9F, 0x3D, 0x3F, 0xBD, 0xBF,
+    0x49, 0x4B, 0xC9, 0xCB, 0x69, 0x6B, 0xE9, 0xEB,
+    0x59, 0x5B, 0xD9, 0xDB, 0x79, 0x7B, 0xF9, 0xFB,
+    0x4D, 0x4F, 0xCD, 0xCF, 0x6D, 0x6F, 0xED, 0xEF,
+    0x5D, 0x5F, 0xDD, 0xDF, 0x7D, 0x7F, 0xFD, 0xFF
+};
+
 
 void ts::DVBCSA2::BlockCipher::init(const uint8_t *key)
 {
@@ -718,6 +688,190 @@ bool ts::DVBCSA2::decryptInPlaceImpl(void* addr, size_t size, size_t* max_actual
 }
 
 
+//----------------------------------------------------------------------------
+// Batch engines.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // The portable batch engine uses the largest integer type of the CPU.
+#if TS_ADDRESS_BITS >= 64
+    typedef ts::dvbcsa2::BatchEngine<ts::dvbcsa2::IntWord<uint64_t>> PortableEngine;
+#else
+    typedef ts::dvbcsa2::BatchEngine<ts::dvbcsa2::IntWord<uint32_t>> PortableEngine;
+#endif
+
+    // Below this number of messages, the bitsliced engines are slower than the byte-oriented implementation.
+    constexpr size_t MIN_BATCH_SIZE = 4;
+
+    // Check if the CPU supports SSE2 instructions.
+    bool CPUHasSSE2()
+    {
+#if defined(TS_X86_64)
+        return true; // part of the x86-64 architecture
+#elif defined(TS_I386) && defined(TS_MSC)
+        int info[4];
+        ::__cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+#elif defined(TS_I386) && defined(TS_GCC)
+        return __builtin_cpu_supports("sse2");
+#else
+        return false;
+#endif
+    }
+
+    // Check if the CPU and the operating system support AVX2 instructions.
+    bool CPUHasAVX2()
+    {
+#if (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_MSC)
+        int info[4];
+        ::__cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        // Need OSXSAVE and AVX, the operating system shall save the YMM registers.
+        ::__cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (::_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+        ::__cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_GCC)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+}
+
+bool ts::DVBCSA2::IsBatchEngineSupported(BatchEngine engine)
+{
+    // The CPU features are checked only once.
+    static const bool sse2 = dvbcsa2::ProcessSSE2 != nullptr && CPUHasSSE2();
+    static const bool avx2 = dvbcsa2::ProcessAVX2 != nullptr && CPUHasAVX2();
+
+    switch (engine) {
+        case BATCH_AUTO:
+        case BATCH_PORTABLE:
+            return true;
+        case BATCH_SSE2:
+            return sse2;
+        case BATCH_AVX2:
+            return avx2;
+        default:
+            return false;
+    }
+}
+
+ts::DVBCSA2::BatchEngine ts::DVBCSA2::BestBatchEngine()
+{
+    if (IsBatchEngineSupported(BATCH_AVX2)) {
+        return BATCH_AVX2;
+    }
+    else if (IsBatchEngineSupported(BATCH_SSE2)) {
+        return BATCH_SSE2;
+    }
+    else {
+        return BATCH_PORTABLE;
+    }
+}
+
+bool ts::DVBCSA2::setBatchEngine(BatchEngine engine)
+{
+    if (!IsBatchEngineSupported(engine)) {
+        return false;
+    }
+    _engine = engine == BATCH_AUTO ? BestBatchEngine() : engine;
+    return true;
+}
+
+size_t ts::DVBCSA2::batchSize() const
+{
+    switch (_engine) {
+        case BATCH_SSE2:
+            return 128;
+        case BATCH_AVX2:
+            return 256;
+        case BATCH_AUTO:
+        case BATCH_PORTABLE:
+        default:
+            return PortableEngine::LANES;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt or decrypt a batch of messages.
+//----------------------------------------------------------------------------
+
+bool ts::DVBCSA2::processPackets(bool encrypt, uint8_t* const* data, const size_t* sizes, size_t count)
+{
+    // Filter invalid parameters. No message is modified on error.
+    if (!_init || (count > 0 && (data == nullptr || sizes == nullptr))) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if ((data[i] == nullptr && sizes[i] > 0) || sizes[i] / 8 > MAX_NBLOCKS) {
+            return false;
+        }
+    }
+
+    // Same key usage accounting and alerts as one encryptInPlace() or decryptInPlace() per message.
+    for (size_t i = 0; i < count; ++i) {
+        if (!(encrypt ? allowEncrypt() : allowDecrypt())) {
+            return false;
+        }
+    }
+
+    // Select the batch engine.
+    dvbcsa2::BatchFunction process = PortableEngine::Process;
+    if (_engine == BATCH_AVX2) {
+        process = dvbcsa2::ProcessAVX2;
+    }
+    else if (_engine == BATCH_SSE2) {
+        process = dvbcsa2::ProcessSSE2;
+    }
+    const size_t lanes = batchSize();
+    assert(process != nullptr);
+    assert(lanes <= dvbcsa2::MAX_LANES);
+
+    // Process messages by groups of "lanes" messages. Messages smaller than 8 bytes are left unmodified.
+    uint8_t* group_data[dvbcsa2::MAX_LANES];
+    size_t group_sizes[dvbcsa2::MAX_LANES];
+    size_t group_count = 0;
+    size_t next = 0;
+
+    while (next < count || group_count > 0) {
+        if (next < count && group_count < lanes) {
+            // Add next message in the group.
+            if (sizes[next] >= 8) {
+                group_data[group_count] = data[next];
+                group_sizes[group_count++] = sizes[next];
+            }
+            next++;
+        }
+        else if (group_count >= MIN_BATCH_SIZE) {
+            // Full group or end of messages.
+            process(encrypt, _key, _block.schedule(), group_data, group_sizes, group_count);
+            group_count = 0;
+        }
+        else {
+            // Too few messages for a bitsliced engine.
+            for (size_t i = 0; i < group_count; ++i) {
+                if (encrypt) {
+                    encryptInPlaceImpl(group_data[i], group_sizes[i], nullptr);
+                }
+                else {
+                    decryptInPlaceImpl(group_data[i], group_sizes[i], nullptr);
+                }
+            }
+            group_count = 0;
+        }
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Wrappers for encrypt and decrypt.
 //----------------------------------------------------------------------------
@@ -45,7 +45,7 @@ TS_MSC_NOWARNING(4505) // warning C4505: 'ts::DVS042<ts::AES>::encrypt': unrefer
 
 template<class CIPHER>
 ts::DVS042<CIPHER>::DVS042() :
-    CipherChainingTemplate<CIPHER>(1, 1, 1),
+    CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS + 1),
     shortIV(this->block_size)
 {
 }
@@ -174,7 +174,7 @@ bool ts::DVS042<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, v
     if (this->algo == nullptr ||
         this->iv.size() != this->block_size ||
         this->shortIV.size() != this->block_size ||
-        this->work.size() < this->block_size ||
+        this->work.size() < 2 * this->block_size ||
         plain_maxsize < cipher_length)
     {
         return false;
@@ -188,26 +188,17 @@ bool ts::DVS042<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, v
     // Select IV depending on block size.
     const uint8_t* previous = cipher_length < this->block_size ? this->shortIV.data() : this->iv.data();
 
-    // Decrypt all blocks in CBC mode, except the last one if partial
+    // Decrypt all blocks in CBC mode, except the last one if partial, several blocks at a time.
     const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
+    const size_t count = cipher_length / this->block_size;
 
-    while (cipher_length >= this->block_size) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
-            return false;
-        }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+    if (!this->decryptBlocksCBC(ct, pt, count, previous)) {
+        return false;
     }
+    ct += count * this->block_size;
+    pt += count * this->block_size;
+    cipher_length -= count * this->block_size;
 
     // Process final block if incomplete
     if (cipher_length > 0) {
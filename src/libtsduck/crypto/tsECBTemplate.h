@@ -49,19 +49,8 @@ bool ts::ECB<CIPHER>::encryptImpl(const void* plain, size_t plain_length, void*
         *cipher_length = plain_length;
     }
 
-    const uint8_t* pt = reinterpret_cast<const uint8_t*>(plain);
-    uint8_t* ct = reinterpret_cast<uint8_t*>(cipher);
-
-    while (plain_length > 0) {
-        if (!this->algo->encrypt(pt, this->block_size, ct, this->block_size)) {
-            return false;
-        }
-        ct += this->block_size;
-        pt += this->block_size;
-        plain_length -= this->block_size;
-    }
-
-    return true;
+    // All blocks are independent and encrypted at once.
+    return this->algo->encryptBlocks(plain, cipher, plain_length / this->block_size);
 }
 
 
@@ -79,19 +68,8 @@ bool ts::ECB<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
         *plain_length = cipher_length;
     }
 
-    const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
-    uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
-
-    while (cipher_length > 0) {
-        if (!this->algo->decrypt(ct, this->block_size, pt, this->block_size)) {
-            return false;
-        }
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
-    }
-
-    return true;
+    // All blocks are independent and decrypted at once.
+    return this->algo->decryptBlocks(cipher, plain, cipher_length / this->block_size);
 }
 
 
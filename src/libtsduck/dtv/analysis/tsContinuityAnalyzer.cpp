@@ -30,6 +30,10 @@
 #include "tsContinuityAnalyzer.h"
 #include "tsNullReport.h"
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint16_t ts::ContinuityAnalyzer::NO_STATE;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructors and destructors
@@ -48,11 +52,14 @@ ts::ContinuityAnalyzer::ContinuityAnalyzer(const PIDSet& pid_filter, Report* rep
     _fix_count(0),
     _error_count(0),
     _pid_filter(pid_filter),
+    _pid_index(),
     _pid_states()
 {
+    _pid_index.fill(NO_STATE);
 }
 
-ts::ContinuityAnalyzer::PIDState::PIDState() :
+ts::ContinuityAnalyzer::PIDState::PIDState(PID pid_) :
+    pid(pid_),
     first_cc(INVALID_CC),
     last_cc_out(INVALID_CC),
     dup_count(0),
@@ -81,10 +88,44 @@ void ts::ContinuityAnalyzer::reset()
     _processed_packets = 0;
     _fix_count = 0;
     _error_count = 0;
+    _pid_index.fill(NO_STATE);
     _pid_states.clear();
 }
 
 
+//----------------------------------------------------------------------------
+// Get or create the state of a PID.
+//----------------------------------------------------------------------------
+
+ts::ContinuityAnalyzer::PIDState& ts::ContinuityAnalyzer::getState(PID pid)
+{
+    uint16_t& index(_pid_index[pid]);
+    if (index == NO_STATE) {
+        index = uint16_t(_pid_states.size());
+        _pid_states.emplace_back(pid);
+    }
+    return _pid_states[index];
+}
+
+
+//----------------------------------------------------------------------------
+// Forget the state of a PID. The last state is moved into the free slot.
+//----------------------------------------------------------------------------
+
+void ts::ContinuityAnalyzer::removeState(PID pid)
+{
+    if (pid < PID_MAX && _pid_index[pid] != NO_STATE) {
+        const uint16_t index = _pid_index[pid];
+        if (index + 1U < _pid_states.size()) {
+            _pid_states[index] = _pid_states.back();
+            _pid_index[_pid_states[index].pid] = index;
+        }
+        _pid_states.pop_back();
+        _pid_index[pid] = NO_STATE;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // PID filter management.
 //----------------------------------------------------------------------------
@@ -101,7 +142,7 @@ void ts::ContinuityAnalyzer::setPIDFilter(const PIDSet& pids)
     if (removed_pids.any()) {
         for (PID pid = 0; pid < PID_MAX; ++pid) {
             if (removed_pids[pid]) {
-                _pid_states.erase(pid);
+                removeState(pid);
             }
         }
     }
@@ -123,7 +164,7 @@ void ts::ContinuityAnalyzer::removePID(PID pid)
 {
     if (pid < _pid_filter.size() && _pid_filter[pid]) {
         _pid_filter.reset(pid);
-        _pid_states.erase(pid);
+        removeState(pid);
     }
 }
 
@@ -139,26 +180,26 @@ bool ts::ContinuityAnalyzer::hasPID(PID pid) const
 
 uint8_t ts::ContinuityAnalyzer::firstCC(PID pid) const
 {
-    auto it = _pid_states.find(pid);
-    return it == _pid_states.end() ? INVALID_CC : it->second.first_cc;
+    const PIDState* state = findState(pid);
+    return state == nullptr ? INVALID_CC : state->first_cc;
 }
 
 uint8_t ts::ContinuityAnalyzer::lastCC(PID pid) const
 {
-    auto it = _pid_states.find(pid);
-    return it == _pid_states.end() ? INVALID_CC : it->second.last_cc_out;
+    const PIDState* state = findState(pid);
+    return state == nullptr ? INVALID_CC : state->last_cc_out;
 }
 
 size_t ts::ContinuityAnalyzer::dupCount(PID pid) const
 {
-    auto it = _pid_states.find(pid);
-    return it == _pid_states.end() ? NPOS : it->second.dup_count;
+    const PIDState* state = findState(pid);
+    return state == nullptr ? NPOS : state->dup_count;
 }
 
 void ts::ContinuityAnalyzer::getLastPacket(PID pid, TSPacket& packet) const
 {
-    auto it = _pid_states.find(pid);
-    packet = it == _pid_states.end() ? NullPacket : it->second.last_pkt_in;
+    const PIDState* state = findState(pid);
+    packet = state == nullptr ? NullPacket : state->last_pkt_in;
 }
 
 ts::TSPacket ts::ContinuityAnalyzer::lastPacket(PID pid) const
@@ -203,7 +244,7 @@ bool ts::ContinuityAnalyzer::feedPacketInternal(TSPacket* pkt, bool update)
     if (pid != PID_NULL && _pid_filter.test(pid)) {
 
         // Get or create PID context.
-        PIDState& state(_pid_states[pid]);
+        PIDState& state(getState(pid));
         const bool new_pid = state.first_cc == INVALID_CC;
 
         // Remember initial characteristics of the input packet.
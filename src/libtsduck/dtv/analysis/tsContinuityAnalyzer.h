@@ -256,15 +256,20 @@ namespace ts {
         class PIDState
         {
         public:
-            PIDState();            // Constructor
+            PIDState(PID pid = PID_NULL);  // Constructor
+            PID      pid;          // PID value.
             uint8_t  first_cc;     // First CC value in a PID.
             uint8_t  last_cc_out;  // Last output CC value in a PID.
             size_t   dup_count;    // Consecutive duplicate count.
             TSPacket last_pkt_in;  // Last input packet (before modification, if any).
         };
 
-        // A map of PID state, indexed by PID.
-        typedef std::map<PID,PIDState> PIDStateMap;
+        // The PID states are stored in a compact vector, in order of appearance of the PID's.
+        // A direct 8192-entry table gives the index of each PID in the vector, so that a
+        // PID lookup is one array access and the states of the active PID's stay contiguous.
+        static constexpr uint16_t NO_STATE = 0xFFFF;
+        typedef std::array<uint16_t, PID_MAX> PIDStateIndex;
+        typedef std::vector<PIDState> PIDStateVector;
 
         // Private members.
         Report*       _report;            // Where to report errors, never null.
@@ -279,7 +284,17 @@ namespace ts {
         PacketCounter _fix_count;         // Number of fixed (modified) packets.
         PacketCounter _error_count;       // Number of discontinuity errors.
         PIDSet        _pid_filter;        // Current set of filtered PID's.
-        PIDStateMap   _pid_states;        // State of all PID's.
+        PIDStateIndex _pid_index;         // Index in _pid_states of each PID, NO_STATE if unused.
+        PIDStateVector _pid_states;       // State of all PID's.
+
+        // Get the state of a PID, null if not found.
+        const PIDState* findState(PID pid) const { return pid < PID_MAX && _pid_index[pid] != NO_STATE ? &_pid_states[_pid_index[pid]] : nullptr; }
+
+        // Get or create the state of a PID.
+        PIDState& getState(PID pid);
+
+        // Forget the state of a PID.
+        void removeState(PID pid);
 
         // Internal version of feedPacket.
         // The packet is modified only if update is true.
@@ -90,6 +90,7 @@ ts::TSAnalyzer::TSAnalyzer(DuckContext& duck, const BitRate& bitrate_hint, BitRa
     _tid_present(),
     _pids(),
     _services(),
+    _chunk_count(1),
     _modified(false),
     _ts_bitrate_sum(0),
     _ts_bitrate_cnt(0),
@@ -97,10 +98,12 @@ ts::TSAnalyzer::TSAnalyzer(DuckContext& duck, const BitRate& bitrate_hint, BitRa
     _preceding_suspects(0),
     _min_error_before_suspect(1),
     _max_consecutive_suspects(1),
+    _pid_table(),
     _demux(_duck, this, this),
     _pes_demux(_duck, this),
     _t2mi_demux(_duck, this)
 {
+    _pid_table.fill(nullptr);
     resetSectionDemux();
 }
 
@@ -162,8 +165,10 @@ void ts::TSAnalyzer::reset()
     _country_code.clear();
     _scrambled_services_cnt = 0;
     _tid_present.reset();
+    _pid_table.fill(nullptr);
     _pids.clear();
     _services.clear();
+    _chunk_count = 1;
     _ts_bitrate_sum = 0;
     _ts_bitrate_cnt = 0;
     _preceding_errors = 0;
@@ -279,6 +284,7 @@ ts::TSAnalyzer::PIDContext::PIDContext(PID pid_, const UString& description_) :
     sections(),
     ssu_oui(),
     t2mi_plp_ts(),
+    cc_valid(false),
     cur_continuity(0),
     audio2(),
     cur_ts_sc(0),
@@ -386,7 +392,11 @@ ts::UString ts::TSAnalyzer::ServiceContext::getName() const
 ts::TSAnalyzer::ETIDContextPtr ts::TSAnalyzer::getETID(const Section& section)
 {
     const ETID etid = section.etid();
-    const PIDContextPtr pc(getPID(section.sourcePID()));
+    const PID pid = section.sourcePID();
+    PIDContext* pc = pid < PID_MAX ? _pid_table[pid] : nullptr;
+    if (pc == nullptr) {
+        pc = getPID(pid).pointer();
+    }
     ETIDContextMap::const_iterator it(pc->sections.find(etid));
 
     if (it != pc->sections.end()) {
@@ -408,7 +418,7 @@ ts::TSAnalyzer::ETIDContextPtr ts::TSAnalyzer::getETID(const Section& section)
 
 bool ts::TSAnalyzer::pidExists(PID pid) const
 {
-    return Contains(_pids, pid);
+    return pid < PID_MAX && _pid_table[pid] != nullptr;
 }
 
 
@@ -421,7 +431,9 @@ ts::TSAnalyzer::PIDContextPtr ts::TSAnalyzer::getPID(PID pid, const UString& des
     const PIDContextPtr p(_pids[pid]);
     if (p.isNull()) {
         // The PID was not yet used, map entry just created.
-        return _pids[pid] = new PIDContext(pid, description);
+        PIDContext* pc = new PIDContext(pid, description);
+        _pid_table[pid] = pc;
+        return _pids[pid] = pc;
     }
     else {
         // If the PID was marked as unreferenced, now use actual description.
@@ -1454,8 +1466,11 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
     _pes_demux.feedPacket(pkt);
     _t2mi_demux.feedPacket(pkt);
 
-    // Get PID context
-    PIDContextPtr ps(getPID(pkt.getPID()));
+    // Get PID context, directly from the PID table when it already exists.
+    PIDContext* ps = _pid_table[pkt.getPID()];
+    if (ps == nullptr) {
+        ps = getPID(pkt.getPID()).pointer();
+    }
     ps->ts_pkt_cnt++;
 
     // Accumulate stat from packet
@@ -1500,9 +1515,9 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
     // Process discontinuities.
     // The continuity counter of null packets is undefined.
     if (ps->pid != PID_NULL) {
-        if (ps->ts_pkt_cnt == 1) {
+        if (!ps->cc_valid) {
             // First packet, initialize continuity
-            ps->cur_continuity = pkt.getCC();
+            ps->cc_valid = true;
         }
         else if (pkt.getDiscontinuityIndicator()) {
             // Expected discontinuity
@@ -1615,6 +1630,282 @@ void ts::TSAnalyzer::setBitrateHint(const BitRate& bitrate_hint, BitRateConfiden
 }
 
 
+//----------------------------------------------------------------------------
+// Set the index in the stream of the next packet to analyze.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::setPacketIndex(PacketCounter index)
+{
+    _ts_pkt_cnt = index;
+    _modified = true;
+}
+
+
+//----------------------------------------------------------------------------
+// Reset all statistics counters but keep the knowledge of the stream.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::resetStatistics()
+{
+    _invalid_sync = 0;
+    _transport_errors = 0;
+    _suspect_ignored = 0;
+    _ts_bitrate_sum = 0;
+    _ts_bitrate_cnt = 0;
+    _pcr_pid_cnt = 0;
+
+    for (auto& pci : _pids) {
+        PIDContext& pc(*pci.second);
+        pc.ts_pkt_cnt = 0;
+        pc.ts_af_cnt = 0;
+        pc.unit_start_cnt = 0;
+        pc.pl_start_cnt = 0;
+        pc.pmt_cnt = 0;
+        pc.unexp_discont = 0;
+        pc.exp_discont = 0;
+        pc.duplicated = 0;
+        pc.ts_sc_cnt = 0;
+        pc.inv_ts_sc_cnt = 0;
+        pc.inv_pes_start = 0;
+        pc.t2mi_cnt = 0;
+        pc.pcr_cnt = 0;
+        pc.ts_bitrate_sum = 0;
+        pc.ts_bitrate_cnt = 0;
+        // Keep track of a crypto-period start in the warm-up area: the durations
+        // of all crypto-periods in the chunk are then accumulated, except the
+        // first one if no transition was seen before.
+        pc.cryptop_cnt = std::min<uint64_t>(pc.cryptop_cnt, 1);
+        pc.cryptop_ts_cnt = 0;
+        for (auto& plp : pc.t2mi_plp_ts) {
+            plp.second = 0;
+        }
+        for (auto& eti : pc.sections) {
+            ETIDContext& etc(*eti.second);
+            etc.table_count = 0;
+            etc.section_count = 0;
+            etc.repetition_ts = 0;
+            etc.min_repetition_ts = 0;
+            etc.max_repetition_ts = 0;
+            etc.versions.reset();
+        }
+    }
+    _modified = true;
+}
+
+
+//----------------------------------------------------------------------------
+// Merge the analysis of the chunk of stream which immediately follows.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::merge(const TSAnalyzer& next)
+{
+    // Global counters and descriptions.
+    _ts_pkt_cnt = std::max(_ts_pkt_cnt, next._ts_pkt_cnt);
+    _invalid_sync += next._invalid_sync;
+    _transport_errors += next._transport_errors;
+    _suspect_ignored += next._suspect_ignored;
+    _ts_bitrate_sum += next._ts_bitrate_sum;
+    _ts_bitrate_cnt += next._ts_bitrate_cnt;
+    _preceding_errors = next._preceding_errors;
+    _preceding_suspects = next._preceding_suspects;
+    _tid_present |= next._tid_present;
+    _chunk_count += next._chunk_count;
+    if (next._ts_id_valid) {
+        _ts_id = next._ts_id;
+        _ts_id_valid = true;
+    }
+    if (!next._country_code.empty()) {
+        _country_code = next._country_code;
+    }
+
+    // The first times come from the first chunk, the last times from the last one.
+    if (_first_utc == Time::Epoch || (next._first_utc != Time::Epoch && next._first_utc < _first_utc)) {
+        _first_utc = next._first_utc;
+        _first_local = next._first_local;
+    }
+    if (_first_tdt == Time::Epoch) {
+        _first_tdt = next._first_tdt;
+    }
+    if (_first_tot == Time::Epoch) {
+        _first_tot = next._first_tot;
+    }
+    if (_first_stt == Time::Epoch) {
+        _first_stt = next._first_stt;
+    }
+    if (next._last_tdt != Time::Epoch) {
+        _last_tdt = next._last_tdt;
+    }
+    if (next._last_tot != Time::Epoch) {
+        _last_tot = next._last_tot;
+    }
+    if (next._last_stt != Time::Epoch) {
+        _last_stt = next._last_stt;
+    }
+
+    // Merge service descriptions. The most recent values are kept.
+    for (const auto& sci : next._services) {
+        const ServiceContext& ns(*sci.second);
+        ServiceContextPtr sv(getService(ns.service_id));
+        if (ns.orig_netw_id != 0) {
+            sv->orig_netw_id = ns.orig_netw_id;
+        }
+        if (ns.service_type != 0) {
+            sv->service_type = ns.service_type;
+        }
+        if (!ns.name.empty()) {
+            sv->name = ns.name;
+        }
+        if (!ns.provider.empty()) {
+            sv->provider = ns.provider;
+        }
+        if (ns.pmt_pid != 0) {
+            sv->pmt_pid = ns.pmt_pid;
+        }
+        if (ns.pcr_pid != 0) {
+            sv->pcr_pid = ns.pcr_pid;
+        }
+        sv->carry_ssu = sv->carry_ssu || ns.carry_ssu;
+        sv->carry_t2mi = sv->carry_t2mi || ns.carry_t2mi;
+    }
+
+    // Merge PID descriptions and statistics.
+    for (const auto& pci : next._pids) {
+        const PIDContext& np(*pci.second);
+        PIDContextPtr pc(getPID(np.pid, np.description));
+
+        if (!np.comment.empty()) {
+            pc->comment = np.comment;
+        }
+        for (const auto& lang : np.languages) {
+            AppendUnique(pc->languages, lang);
+        }
+        for (const auto& attr : np.attributes) {
+            AppendUnique(pc->attributes, attr);
+        }
+        pc->services.insert(np.services.begin(), np.services.end());
+        pc->is_pmt_pid = pc->is_pmt_pid || np.is_pmt_pid;
+        pc->is_pcr_pid = pc->is_pcr_pid || np.is_pcr_pid;
+        pc->referenced = pc->referenced || np.referenced;
+        pc->optional = pc->optional && np.optional;
+        pc->carry_pes = pc->carry_pes || np.carry_pes;
+        pc->carry_section = pc->carry_section || np.carry_section;
+        pc->carry_ecm = pc->carry_ecm || np.carry_ecm;
+        pc->carry_emm = pc->carry_emm || np.carry_emm;
+        pc->carry_audio = pc->carry_audio || np.carry_audio;
+        pc->carry_video = pc->carry_video || np.carry_video;
+        pc->carry_t2mi = pc->carry_t2mi || np.carry_t2mi;
+        pc->scrambled = pc->scrambled || np.scrambled;
+        if (pc->pes_stream_id == 0) {
+            pc->pes_stream_id = np.pes_stream_id;
+            pc->same_stream_id = np.same_stream_id;
+        }
+        else if (np.pes_stream_id != 0) {
+            pc->same_stream_id = pc->same_stream_id && np.same_stream_id && pc->pes_stream_id == np.pes_stream_id;
+        }
+        if (np.stream_type != 0) {
+            pc->stream_type = np.stream_type;
+        }
+        if (np.cas_id != 0) {
+            pc->cas_id = np.cas_id;
+        }
+        pc->cas_operators.insert(np.cas_operators.begin(), np.cas_operators.end());
+        pc->ssu_oui.insert(np.ssu_oui.begin(), np.ssu_oui.end());
+
+        // Add counters.
+        pc->ts_pkt_cnt += np.ts_pkt_cnt;
+        pc->ts_af_cnt += np.ts_af_cnt;
+        pc->unit_start_cnt += np.unit_start_cnt;
+        pc->pl_start_cnt += np.pl_start_cnt;
+        pc->pmt_cnt += np.pmt_cnt;
+        pc->unexp_discont += np.unexp_discont;
+        pc->exp_discont += np.exp_discont;
+        pc->duplicated += np.duplicated;
+        pc->ts_sc_cnt += np.ts_sc_cnt;
+        pc->inv_ts_sc_cnt += np.inv_ts_sc_cnt;
+        pc->inv_pes_start += np.inv_pes_start;
+        pc->t2mi_cnt += np.t2mi_cnt;
+        pc->pcr_cnt += np.pcr_cnt;
+        pc->ts_bitrate_sum += np.ts_bitrate_sum;
+        pc->ts_bitrate_cnt += np.ts_bitrate_cnt;
+        for (const auto& plp : np.t2mi_plp_ts) {
+            pc->t2mi_plp_ts[plp.first] += plp.second;
+        }
+
+        // In each analyzer, the number of accumulated crypto-period durations is cryptop_cnt - 1.
+        const uint64_t durations = (pc->cryptop_cnt > 0 ? pc->cryptop_cnt - 1 : 0) + (np.cryptop_cnt > 0 ? np.cryptop_cnt - 1 : 0);
+        pc->cryptop_cnt = pc->cryptop_cnt > 0 || np.cryptop_cnt > 0 ? durations + 1 : 0;
+        pc->cryptop_ts_cnt += np.cryptop_ts_cnt;
+
+        // If the next chunk saw packets in this PID, its analysis state is the most recent one.
+        if (np.ts_pkt_cnt > 0) {
+            pc->cc_valid = np.cc_valid;
+            pc->cur_continuity = np.cur_continuity;
+            pc->audio2 = np.audio2;
+            pc->cur_ts_sc = np.cur_ts_sc;
+            pc->cur_ts_sc_pkt = np.cur_ts_sc_pkt;
+            pc->last_pcr = np.last_pcr;
+            pc->last_pcr_pkt = np.last_pcr_pkt;
+        }
+
+        // Merge table descriptions.
+        for (const auto& eti : np.sections) {
+            const ETIDContext& ne(*eti.second);
+            ETIDContextPtr& etc(pc->sections[ne.etid]);
+            if (etc.isNull()) {
+                etc = new ETIDContext(ne.etid);
+                etc->first_version = ne.first_version;
+            }
+            etc->section_count += ne.section_count;
+            etc->versions |= ne.versions;
+            if (ne.table_count == 0) {
+                continue;
+            }
+            if (etc->table_count == 0) {
+                etc->first_pkt = ne.first_pkt;
+                etc->min_repetition_ts = ne.min_repetition_ts;
+                etc->max_repetition_ts = ne.max_repetition_ts;
+                etc->first_version = ne.first_version;
+            }
+            else {
+                // Repetition interval over the chunk boundary.
+                const uint64_t rep = ne.first_pkt - etc->last_pkt;
+                if (etc->table_count == 1) {
+                    etc->min_repetition_ts = etc->max_repetition_ts = rep;
+                }
+                else {
+                    etc->min_repetition_ts = std::min(etc->min_repetition_ts, rep);
+                    etc->max_repetition_ts = std::max(etc->max_repetition_ts, rep);
+                }
+                if (ne.table_count > 1) {
+                    etc->min_repetition_ts = std::min(etc->min_repetition_ts, ne.min_repetition_ts);
+                    etc->max_repetition_ts = std::max(etc->max_repetition_ts, ne.max_repetition_ts);
+                }
+            }
+            etc->table_count += ne.table_count;
+            etc->last_pkt = ne.last_pkt;
+            etc->last_version = ne.last_version;
+            if (etc->table_count > 1) {
+                etc->repetition_ts = (etc->last_pkt - etc->first_pkt + (etc->table_count - 1) / 2) / (etc->table_count - 1);
+            }
+        }
+    }
+
+    // Recount PID's with PCR's and scrambled PID's.
+    _pcr_pid_cnt = 0;
+    _scrambled_pid_cnt = 0;
+    for (const auto& pci : _pids) {
+        if (pci.second->pcr_cnt > 0) {
+            _pcr_pid_cnt++;
+        }
+        if (pci.second->scrambled) {
+            _scrambled_pid_cnt++;
+        }
+    }
+
+    _modified = true;
+}
+
+
 //----------------------------------------------------------------------------
 // Update the global statistics value if internal data were modified.
 //----------------------------------------------------------------------------
@@ -123,6 +123,38 @@ namespace ts {
             _max_consecutive_suspects = count;
         }
 
+        //!
+        //! Set the index in the stream of the next packet to analyze.
+        //! This is useful when the analysis starts in the middle of a file:
+        //! all packet indexes in the analysis (table repetitions, crypto-periods,
+        //! bitrates) remain relative to the start of the complete stream.
+        //! @param [in] index Index of the next packet, ie. number of packets before it.
+        //!
+        void setPacketIndex(PacketCounter index);
+
+        //!
+        //! Reset all statistics counters but keep the knowledge of the stream.
+        //! The PID, service and table descriptions, the demux states and the per-PID
+        //! analysis states (continuity counters, last PCR, current crypto-period)
+        //! are preserved. This is typically used after analyzing a "warm-up" area
+        //! before the start of a chunk of a stream which is analyzed in parallel
+        //! with the other chunks.
+        //!
+        void resetStatistics();
+
+        //!
+        //! Merge the analysis of the chunk of stream which immediately follows this one.
+        //! The two analyzers shall have used a common packet index base (see setPacketIndex())
+        //! and @a next shall have called resetStatistics() at the end of this chunk.
+        //! Counters are added, descriptions are merged, the analysis state of @a next is kept.
+        //! Most results are identical to a sequential analysis. Crypto-periods which span
+        //! over the chunk boundary and sections or PES packets which are longer than the
+        //! warm-up area of @a next are only approximated.
+        //! @param [in] next Analyzer of the chunk of stream immediately following this one.
+        //! It is no longer used after the merge, only its results.
+        //!
+        void merge(const TSAnalyzer& next);
+
         //!
         //! Get the list of service ids.
         //! @param [out] list The returned list of service ids.
@@ -347,6 +379,7 @@ namespace ts {
             std::map<uint8_t,uint64_t> t2mi_plp_ts;   //!< For T2-MI streams, map key = PLP (Physical Layer Pipe) to value = number of embedded TS packets.
 
             // Public members - Analysis data:
+            bool           cc_valid;        //!< The current continuity count is valid (a packet was already seen).
             uint8_t        cur_continuity;  //!< Current continuity count.
             MPEG2AudioAttributes audio2;    //!< Last MPEG-2 audio attributes.
 
@@ -478,6 +511,7 @@ namespace ts {
         std::bitset<TID_MAX> _tid_present;        //!< Array of detected tables.
         PIDContextMap        _pids;               //!< Description of PIDs.
         ServiceContextMap    _services;           //!< Description of services, map key: service id..
+        size_t               _chunk_count;        //!< Number of stream chunks in the analysis, more than one after merge().
 
     private:
         // Constant string "Unreferenced"
@@ -534,6 +568,7 @@ namespace ts {
         uint64_t     _preceding_suspects;        // Number of contiguous suspects packets before current packet
         uint64_t     _min_error_before_suspect;  // Required number of invalid packets before starting suspect
         uint64_t     _max_consecutive_suspects;  // Max number of consecutive suspect packets before clearing suspect
+        std::array<PIDContext*,PID_MAX> _pid_table;  // Direct-indexed PID contexts, owned by _pids, null when unused
         SectionDemux _demux;                     // PSI tables analysis
         PESDemux     _pes_demux;                 // Audio/video analysis
         T2MIDemux    _t2mi_demux;                // T2-MI analysis
@@ -289,6 +289,9 @@ void ts::TSAnalyzerReport::reportTS(Grid& grid, const UString& title)
     grid.putLine();
     grid.putLine(u"Note 1: C=Clear, S=Scrambled");
     grid.putMultiLine(u"Note 2: Unless specified otherwise, bitrates are based on 188 bytes/pkt");
+    if (_chunk_count > 1) {
+        grid.putMultiLine(UString::Format(u"Note 3: Stream analyzed in %d chunks in parallel, crypto-periods are approximated", {_chunk_count}));
+    }
 
     grid.closeTable();
 }
@@ -826,6 +829,9 @@ void ts::TSAnalyzerReport::reportNormalized(TSAnalyzerOptions& opt, std::ostream
     if (!_country_code.empty()) {
         stm << "country=" << _country_code << ":";
     }
+    if (_chunk_count > 1) {
+        stm << "chunks=" << _chunk_count << ":";
+    }
     stm << std::endl;
 
     // Print lines for first and last UTC and local time
@@ -1088,6 +1094,9 @@ void ts::TSAnalyzerReport::reportJSON(TSAnalyzerOptions& opt, std::ostream& stm,
     if (!_country_code.empty()) {
         root.query(u"ts", true).add(u"country", _country_code);
     }
+    if (_chunk_count > 1) {
+        root.query(u"ts", true).add(u"chunks", _chunk_count);
+    }
 
     root.query(u"ts.services", true).add(u"total", _services.size());
     root.query(u"ts.services", true).add(u"clear", _services.size() - _scrambled_services_cnt);
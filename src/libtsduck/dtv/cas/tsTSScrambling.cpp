@@ -51,7 +51,11 @@ ts::TSScrambling::TSScrambling(Report& report, uint8_t scrambling) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scrambler{nullptr, nullptr},
+    _batch_mode(false),
+    _batch_encrypt(true),
+    _batch_data(),
+    _batch_sizes()
 {
     setScramblingType(scrambling);
 }
@@ -71,7 +75,11 @@ ts::TSScrambling::TSScrambling(const TSScrambling& other) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scrambler{nullptr, nullptr},
+    _batch_mode(other._batch_mode),
+    _batch_encrypt(true),
+    _batch_data(),
+    _batch_sizes()
 {
     setScramblingType(_scrambling_type);
     _dvbcsa[0].setEntropyMode(other._dvbcsa[0].entropyMode());
@@ -93,7 +101,11 @@ ts::TSScrambling::TSScrambling(TSScrambling&& other) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scrambler{nullptr, nullptr},
+    _batch_mode(other._batch_mode),
+    _batch_encrypt(true),
+    _batch_data(),
+    _batch_sizes()
 {
     setScramblingType(_scrambling_type);
     _dvbcsa[0].setEntropyMode(other._dvbcsa[0].entropyMode());
@@ -109,6 +121,9 @@ bool ts::TSScrambling::setScramblingType(uint8_t scrambling, bool overrideExplic
 {
     if (overrideExplicit || !_explicit_type) {
 
+        // Pending packets in batch mode use the previous scramblers.
+        flushBatch();
+
         // Select the right pair of scramblers.
         switch (scrambling) {
             case SCRAMBLING_DVB_CSA1:
@@ -159,6 +174,7 @@ bool ts::TSScrambling::setScramblingType(uint8_t scrambling, bool overrideExplic
 
 void ts::TSScrambling::setEntropyMode(DVBCSA2::EntropyMode mode)
 {
+    flushBatch();
     _dvbcsa[0].setEntropyMode(mode);
     _dvbcsa[1].setEntropyMode(mode);
 }
@@ -356,6 +372,12 @@ bool ts::TSScrambling::start()
     // Point next CW to end of list. Will loop to first one.
     _next_cw = _cw_list.end();
 
+    // Forget packets from a previous session in batch mode.
+    for (int parity = 0; parity < 2; ++parity) {
+        _batch_data[parity].clear();
+        _batch_sizes[parity].clear();
+    }
+
     // Create the output file for control words.
     if (!_out_cw_name.empty()) {
         _out_cw_file.open(_out_cw_name.toUTF8().c_str(), std::ios::out);
@@ -375,11 +397,14 @@ bool ts::TSScrambling::start()
 
 bool ts::TSScrambling::stop()
 {
+    // Process pending packets in batch mode.
+    const bool success = flushBatch();
+
     // Close the output file for control words, if one was created.
     if (_out_cw_file.is_open()) {
         _out_cw_file.close();
     }
-    return true;
+    return success;
 }
 
 
@@ -461,6 +486,11 @@ bool ts::TSScrambling::setCW(const ByteBlock& cw, int parity)
     CipherChaining* algo = _scrambler[parity & 1];
     assert(algo != nullptr);
 
+    // Pending packets in batch mode use the previous key.
+    if (!flushBatch(parity & 1)) {
+        return false;
+    }
+
     if (algo->setKey(cw.data(), cw.size())) {
         _report.debug(u"using scrambling key: " + UString::Dump(cw, UString::SINGLE_LINE));
         return true;
@@ -522,8 +552,11 @@ bool ts::TSScrambling::encrypt(TSPacket& pkt)
         psize -= psize % algo->blockSize();
     }
 
-    // Encrypt the packet.
-    const bool ok = psize == 0 || algo->encryptInPlace(pkt.getPayload(), psize);
+    // Encrypt the packet, now or later in batch mode.
+    const bool ok = psize == 0 ||
+        (_batch_mode && algo == &_dvbcsa[_encrypt_scv & 1] ?
+         batchPayload(true, _encrypt_scv & 1, pkt.getPayload(), psize) :
+         algo->encryptInPlace(pkt.getPayload(), psize));
     if (ok) {
         pkt.setScrambling(_encrypt_scv);
     }
@@ -567,8 +600,11 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
         psize -= psize % algo->blockSize();
     }
 
-    // Decrypt the packet.
-    const bool ok = psize == 0 || algo->decryptInPlace(pkt.getPayload(), psize);
+    // Decrypt the packet, now or later in batch mode.
+    const bool ok = psize == 0 ||
+        (_batch_mode && algo == &_dvbcsa[_decrypt_scv & 1] ?
+         batchPayload(false, _decrypt_scv & 1, pkt.getPayload(), psize) :
+         algo->decryptInPlace(pkt.getPayload(), psize));
     if (ok) {
         pkt.setScrambling(SC_CLEAR);
     }
@@ -577,3 +613,57 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
     return ok;
 }
+
+
+//----------------------------------------------------------------------------
+// Batch mode for DVB-CSA2.
+//----------------------------------------------------------------------------
+
+void ts::TSScrambling::setBatchMode(bool on)
+{
+    if (_batch_mode && !on) {
+        flushBatch();
+    }
+    _batch_mode = on;
+}
+
+bool ts::TSScrambling::batchPayload(bool encrypt, int parity, uint8_t* payload, size_t size)
+{
+    // All pending packets are processed in the same direction.
+    if (encrypt != _batch_encrypt && !flushBatch()) {
+        return false;
+    }
+    _batch_encrypt = encrypt;
+
+    // Enqueue the payload. Process the queue when a full batch is ready.
+    _batch_data[parity].push_back(payload);
+    _batch_sizes[parity].push_back(size);
+    return _batch_data[parity].size() < _dvbcsa[parity].batchSize() || flushBatch(parity);
+}
+
+bool ts::TSScrambling::flushBatch()
+{
+    // Always flush both parities, even on error.
+    const bool ok0 = flushBatch(0);
+    const bool ok1 = flushBatch(1);
+    return ok0 && ok1;
+}
+
+bool ts::TSScrambling::flushBatch(int parity)
+{
+    std::vector<uint8_t*>& data(_batch_data[parity]);
+    std::vector<size_t>& sizes(_batch_sizes[parity]);
+    assert(data.size() == sizes.size());
+
+    bool ok = true;
+    if (!data.empty()) {
+        DVBCSA2& algo(_dvbcsa[parity]);
+        ok = _batch_encrypt ? algo.encryptPackets(data.data(), sizes.data(), data.size()) : algo.decryptPackets(data.data(), sizes.data(), data.size());
+        if (!ok) {
+            _report.error(u"packet %s error using %s", {_batch_encrypt ? u"encryption" : u"decryption", algo.name()});
+        }
+        data.clear();
+        sizes.clear();
+    }
+    return ok;
+}
@@ -192,6 +192,33 @@ namespace ts {
         //!
         bool decrypt(TSPacket& pkt);
 
+        //!
+        //! Set the batch mode for DVB-CSA2 scrambling and descrambling.
+        //! In batch mode, encrypt() and decrypt() immediately update the scrambling control
+        //! bits in the TS header but the payloads are processed later, in one single pass,
+        //! either when flushBatch() is invoked or when the control word changes. This is
+        //! much faster on large number of packets but the application shall make sure that
+        //! the packets are not moved or reused before flushBatch() is called.
+        //! Other scrambling algorithms are not affected by the batch mode.
+        //! @param [in] on If true, use batch mode. If false, return to immediate processing.
+        //! The pending packets, if any, are processed when the batch mode is switched off.
+        //!
+        void setBatchMode(bool on);
+
+        //!
+        //! Check if the batch mode is used.
+        //! @return True if the batch mode is used.
+        //! @see setBatchMode()
+        //!
+        bool batchMode() const { return _batch_mode; }
+
+        //!
+        //! Process all pending packets in batch mode.
+        //! @return True on success, false on error.
+        //! @see setBatchMode()
+        //!
+        bool flushBatch();
+
     private:
         // List of control words
         typedef std::list<ByteBlock> CWList;
@@ -211,10 +238,20 @@ namespace ts {
         CBC<AES>         _aescbc[2];
         CTR<AES>         _aesctr[2];
         CipherChaining*  _scrambler[2];
+        bool             _batch_mode;       // Batch mode for DVB-CSA2.
+        bool             _batch_encrypt;    // Direction of pending packets in batch mode.
+        std::vector<uint8_t*> _batch_data[2];   // Pending payloads in batch mode, per parity.
+        std::vector<size_t>   _batch_sizes[2];  // Sizes of pending payloads in batch mode, per parity.
 
         // Set the next fixed control word as scrambling key.
         bool setNextFixedCW(int parity);
 
+        // Process pending packets in batch mode for one parity.
+        bool flushBatch(int parity);
+
+        // Enqueue a payload in batch mode.
+        bool batchPayload(bool encrypt, int parity, uint8_t* payload, size_t size);
+
         // Implementation of BlockCipherAlertInterface.
         virtual bool handleBlockCipherAlert(BlockCipher& cipher, AlertReason reason) override;
 
@@ -118,7 +118,14 @@ void ts::DemuxedData::reload(const void* content, size_t content_size, PID sourc
 {
     _source_pid = source_pid;
     _first_pkt = _last_pkt = 0;
-    _data = new ByteBlock(content, content_size);
+    const uint8_t* const addr = reinterpret_cast<const uint8_t*>(content);
+    if (!_data.isNull() && _data.count() == 1 && (addr + content_size <= _data->data() || addr >= _data->data() + _data->size())) {
+        // Reuse the memory of the previous content when not shared and not overlapping.
+        _data->copy(content, content_size);
+    }
+    else {
+        _data = new ByteBlock(content, content_size);
+    }
 }
 
 void ts::DemuxedData::reload(const ByteBlock& content, PID source_pid)
@@ -35,13 +35,16 @@
 #pragma once
 #include "tsTS.h"
 #include "tsByteBlock.h"
+#include "tsPoolAllocated.h"
 
 namespace ts {
     //!
     //! Base class for all kinds of demuxed data.
     //! @ingroup mpeg
     //!
-    class TSDUCKDLL DemuxedData
+    //! All demuxed data (sections, PES packets, etc.) are allocated in the memory pool.
+    //!
+    class TSDUCKDLL DemuxedData: public PoolAllocated
     {
     public:
         //!
@@ -95,6 +98,7 @@ namespace ts {
 
         //!
         //! Reload from full binary content.
+        //! If the previous binary content is not shared, its memory is reused.
         //! @param [in] content Address of the binary packet data.
         //! @param [in] content_size Size in bytes of the packet.
         //! @param [in] source_pid PID from which the data were read.
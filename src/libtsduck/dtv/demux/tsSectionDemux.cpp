@@ -199,10 +199,26 @@ ts::SectionDemux::PIDContext::PIDContext() :
     continuity(0),
     sync(false),
     ts(),
-    tids()
+    tids(),
+    last_etid(),
+    last_tc(nullptr),
+    std_tid(TID_NULL),
+    standards(Standards::NONE)
 {
 }
 
+// Get the ETID context, create it if it did not exist.
+ts::SectionDemux::ETIDContext& ts::SectionDemux::PIDContext::etidContext(const ETID& etid)
+{
+    // Most of the time, consecutive sections in a PID belong to the same table.
+    // Addresses of elements in a std::map remain valid until they are erased.
+    if (last_tc == nullptr || etid != last_etid) {
+        last_tc = &tids[etid];
+        last_etid = etid;
+    }
+    return *last_tc;
+}
+
 // Called when packet synchronization is lost on the pid.
 void ts::SectionDemux::PIDContext::syncLost()
 {
@@ -221,6 +237,7 @@ ts::SectionDemux::SectionDemux(DuckContext& duck, TableHandlerInterface* table_h
     _section_handler(section_handler),
     _invalid_handler(nullptr),
     _pids(),
+    _recycled(),
     _status(),
     _get_current(true),
     _get_next(false),
@@ -229,6 +246,14 @@ ts::SectionDemux::SectionDemux(DuckContext& duck, TableHandlerInterface* table_h
 {
 }
 
+ts::SectionDemux::~SectionDemux()
+{
+    for (auto& pc : _pids) {
+        delete pc;
+        pc = nullptr;
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Reset the analysis context (partially built sections and tables).
@@ -237,13 +262,19 @@ ts::SectionDemux::SectionDemux(DuckContext& duck, TableHandlerInterface* table_h
 void ts::SectionDemux::immediateReset()
 {
     SuperClass::immediateReset();
-    _pids.clear();
+    for (auto& pc : _pids) {
+        delete pc;
+        pc = nullptr;
+    }
 }
 
 void ts::SectionDemux::immediateResetPID(PID pid)
 {
     SuperClass::immediateResetPID(pid);
-    _pids.erase(pid);
+    if (pid < _pids.size()) {
+        delete _pids[pid];
+        _pids[pid] = nullptr;
+    }
 }
 
 
@@ -270,7 +301,10 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
     // Get PID and reference to the PID context.
     // The PID context is created if did not exist.
     const PID pid = pkt.getPID();
-    PIDContext& pc(_pids[pid]);
+    if (_pids[pid] == nullptr) {
+        _pids[pid] = new PIDContext;
+    }
+    PIDContext& pc(*_pids[pid]);
 
     // If TS packet is scrambled, we cannot decode it and we loose synchronization
     // on this PID (usually, PID's carrying sections are not scrambled).
@@ -484,12 +518,17 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
         if (section_ok) {
 
             // Get the list of standards which define this table id and add them in context.
-            _duck.addStandards(PSIRepository::Instance()->getTableStandards(etid.tid(), pid));
+            // The standards are cached in the PID context for the last table id.
+            if (pc.std_tid != etid.tid()) {
+                pc.std_tid = etid.tid();
+                pc.standards = PSIRepository::Instance()->getTableStandards(etid.tid(), pid);
+            }
+            _duck.addStandards(pc.standards);
 
             // Get reference to the ETID context for this PID.
             // The ETID context is created if did not exist.
             // Avoid accumulating partial sections when there is no table handler.
-            ETIDContext* tc = _table_handler == nullptr ? nullptr : &pc.tids[etid];
+            ETIDContext* tc = _table_handler == nullptr ? nullptr : &pc.etidContext(etid);
 
             // If this is a new version of the table, reset the TID context.
             // Note that short sections do not have versions, so the version
@@ -535,7 +574,15 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             SectionPtr sect_ptr;
 
             if (section_ok && (_section_handler != nullptr || (tc != nullptr && tc->sects[section_number].isNull()))) {
-                sect_ptr = new Section(ts_start, section_length, pid, CRC32::CHECK);
+                if (_recycled.isNull()) {
+                    sect_ptr = new Section(ts_start, section_length, pid, CRC32::CHECK);
+                }
+                else {
+                    // Reuse a section object and its data buffer which were released by all handlers.
+                    sect_ptr = _recycled;
+                    _recycled.clear();
+                    sect_ptr->reload(ts_start, section_length, pid, CRC32::CHECK);
+                }
                 sect_ptr->setFirstTSPacketIndex(pusi_pkt_index);
                 sect_ptr->setLastTSPacketIndex(_packet_count);
                 if (!sect_ptr->isValid()) {
@@ -570,6 +617,10 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
                 afterCallingHandler(false);
                 throw;
             }
+            // If the section was not kept by any handler or table, keep it for the next section.
+            if (!sect_ptr.isNull() && sect_ptr.count() == 1) {
+                _recycled = sect_ptr;
+            }
             if (afterCallingHandler(true)) {
                 return;  // the PID of this packet or the complete demux was reset.
             }
@@ -622,9 +673,11 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
 void ts::SectionDemux::fixAndFlush(bool pack, bool fill_eit)
 {
     // Loop on all PID's.
-    for (auto it1 = _pids.begin(); it1 != _pids.end(); ++it1) {
-        const PID pid = it1->first;
-        PIDContext& pc(it1->second);
+    for (PID pid = 0; pid < _pids.size(); ++pid) {
+        if (_pids[pid] == nullptr) {
+            continue;
+        }
+        PIDContext& pc(*_pids[pid]);
 
         // Mark that we are in the context of a table or section handler.
         // This is used to prevent the destruction of PID contexts during
@@ -38,6 +38,8 @@
 #include "tsSectionHandlerInterface.h"
 #include "tsInvalidSectionHandlerInterface.h"
 #include "tsETID.h"
+#include "tsStandards.h"
+#include "tsTablesPtr.h"
 
 namespace ts {
     //!
@@ -70,6 +72,11 @@ namespace ts {
                               SectionHandlerInterface* section_handler = nullptr,
                               const PIDSet& pid_filter = NoPID);
 
+        //!
+        //! Destructor.
+        //!
+        virtual ~SectionDemux() override;
+
         // Inherited methods
         virtual void feedPacket(const TSPacket& pkt) override;
 
@@ -286,12 +293,24 @@ namespace ts {
             bool          sync;               // We are synchronous in this PID
             ByteBlock     ts;                 // TS payload buffer
             std::map<ETID,ETIDContext> tids;  // TID analysis contexts
+            ETID          last_etid;          // ETID of last section, fast path for consecutive sections of the same table
+            ETIDContext*  last_tc;            // Context of last_etid, null if none
+            TID           std_tid;            // TID of last section, fast path for standards lookup
+            Standards     standards;          // Standards for std_tid in this PID
 
             // Default constructor.
             PIDContext();
 
+            // Get the ETID context, create it if it did not exist.
+            ETIDContext& etidContext(const ETID& etid);
+
             // Called when packet synchronization is lost on the pid.
             void syncLost();
+
+        private:
+            // Inaccessible operations.
+            PIDContext(const PIDContext&) = delete;
+            PIDContext& operator=(const PIDContext&) = delete;
         };
 
         // Notify the application if the table is complete.
@@ -304,7 +323,8 @@ namespace ts {
         TableHandlerInterface*          _table_handler;
         SectionHandlerInterface*        _section_handler;
         InvalidSectionHandlerInterface* _invalid_handler;
-        std::map<PID,PIDContext>        _pids;
+        std::array<PIDContext*,PID_MAX> _pids;  // Direct-indexed PID contexts, null when unused
+        SectionPtr                      _recycled;  // Section object to reuse when released by all handlers
         Status _status;
         bool   _get_current;
         bool   _get_next;
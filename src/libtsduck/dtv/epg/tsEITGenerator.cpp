@@ -48,6 +48,7 @@ ts::EITGenerator::EITGenerator(DuckContext& duck, PID pid, EITOption options, co
     _max_bitrate(0),
     _ts_bitrate(0),
     _ref_time(),
+    _next_update(),
     _ref_time_pkt(0),
     _eit_inter_pkt(0),
     _last_eit_pkt(0),
@@ -86,6 +87,7 @@ void ts::EITGenerator::reset()
     _max_bitrate = 0;
     _ts_bitrate = 0;
     _ref_time.clear();
+    _next_update.clear();
     _ref_time_pkt = 0;
     _eit_inter_pkt = 0;
     _last_eit_pkt = 0;
@@ -223,6 +225,7 @@ ts::EITGenerator::ESegment::ESegment(const Time& seg_start_time) :
 
 ts::EITGenerator::EService::EService() :
     regenerate(false),
+    next_update(),
     pf(),
     segments()
 {
@@ -287,10 +290,7 @@ bool ts::EITGenerator::loadEvents(const ServiceIdTriplet& service_id, const uint
         // empty intermediate segments. This will be done in regenerateSchedule().
 
         const Time seg_start_time(EIT::SegmentStartTime(ev->start_time));
-        auto seg_iter = srv.segments.begin();
-        while (seg_iter != srv.segments.end() && (*seg_iter)->start_time < seg_start_time) {
-            ++seg_iter;
-        }
+        auto seg_iter = std::lower_bound(srv.segments.begin(), srv.segments.end(), seg_start_time, EService::SegmentStartsBefore);
         if (seg_iter == srv.segments.end() || (*seg_iter)->start_time != seg_start_time) {
             // The segment does not exist, create it.
             _duck.report().debug(u"creating EIT segment starting at %s for %s", {seg_start_time, service_id});
@@ -301,10 +301,7 @@ bool ts::EITGenerator::loadEvents(const ServiceIdTriplet& service_id, const uint
         ESegment& seg(**seg_iter);
 
         // Insert the binary event in the list of events for that segment.
-        auto ev_iter = seg.events.begin();
-        while (ev_iter != seg.events.end() && (*ev_iter)->start_time < ev->start_time) {
-            ++ev_iter;
-        }
+        auto ev_iter = std::lower_bound(seg.events.begin(), seg.events.end(), ev->start_time, ESegment::EventStartsBefore);
         if (ev_iter != seg.events.end() && (*ev_iter)->event_id == ev->event_id && (*ev_iter)->event_data == ev->event_data) {
             // Duplicate event, ignore it.
             continue;
@@ -318,8 +315,10 @@ bool ts::EITGenerator::loadEvents(const ServiceIdTriplet& service_id, const uint
     }
 
     // If some events were added, it may be necessary to regenerate the EIT p/f in this service.
+    // The next time-based update of the service must be recomputed.
     if (ev_count > 0) {
         regeneratePresentFollowing(service_id, srv, now);
+        forceUpdate(srv);
     }
     return success;
 }
@@ -641,6 +640,11 @@ ts::Time ts::EITGenerator::getCurrentTime()
 
 void ts::EITGenerator::setCurrentTime(Time current_utc)
 {
+    // If the time goes backward, the next update times of the services are no longer valid.
+    if (current_utc < getCurrentTime()) {
+        forceUpdate();
+    }
+
     // Store the current time.
     _ref_time = current_utc;
     _ref_time_pkt = _packet_index;
@@ -651,6 +655,19 @@ void ts::EITGenerator::setCurrentTime(Time current_utc)
 }
 
 
+//----------------------------------------------------------------------------
+// Force the update of all services on next updateForNewTime().
+//----------------------------------------------------------------------------
+
+void ts::EITGenerator::forceUpdate()
+{
+    for (auto& it : _services) {
+        it.second.next_update.clear();
+    }
+    _next_update.clear();
+}
+
+
 //----------------------------------------------------------------------------
 // Mark a segment or section as obsolete, garbage collect obsolete sections
 //----------------------------------------------------------------------------
@@ -675,15 +692,21 @@ void ts::EITGenerator::markObsoleteSection(ESection& sec)
         // accumulate because the EIT bandwidth is not large enough and low-priority
         // EIT schedule never get a chance to get selected (and discarded when marked
         // as obsolete). Do some garbage collecting to avoid infinite accumulation.
-        if (_obsolete_count > 100) {
+        // The threshold is proportional to the size of the injection queues so that
+        // regenerating a large EPG does not rescan all queues again and again.
+        size_t inject_count = 0;
+        for (size_t index = 0; index < _injects.size(); ++index) {
+            inject_count += _injects[index].size();
+        }
+        if (_obsolete_count > 100 && _obsolete_count > inject_count / 4) {
             // Loop on all injection queues.
             for (size_t index = 0; index < _injects.size(); ++index) {
                 // Loop on all sections in the queue.
-                ESectionList& list(_injects[index]);
-                auto it = list.begin();
-                while (it != list.end()) {
-                    if ((*it)->obsolete) {
-                        it = list.erase(it);
+                ESectionQueue& queue(_injects[index]);
+                auto it = queue.begin();
+                while (it != queue.end()) {
+                    if (it->second->obsolete) {
+                        it = queue.erase(it);
                     }
                     else {
                         ++it;
@@ -700,32 +723,13 @@ void ts::EITGenerator::markObsoleteSection(ESection& sec)
 // Enqueue a section for injection.
 //----------------------------------------------------------------------------
 
-void ts::EITGenerator::enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject, bool try_front)
+void ts::EITGenerator::enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject)
 {
     // Update section injection time.
     sec->next_inject = next_inject;
 
-    // Compute which injection queue to use.
-    ESectionList& list(_injects[size_t(_profile.sectionToProfile(*sec->section))]);
-
-    // Even start at from or back of the queue (possible optimization).
-    if (try_front) {
-        auto it = list.begin();
-        while (it != list.end() && (*it)->next_inject <= next_inject) {
-            ++it;
-        }
-        list.insert(it, sec);
-    }
-    else {
-        auto it = list.end();
-        while (it != list.begin() && (*--it)->next_inject > next_inject) {
-        }
-        if (it != list.end()) {
-            // it points to a section before sec, must insert after.
-            ++it;
-        }
-        list.insert(it, sec);
-    }
+    // Insert in the injection queue of the profile, after all sections with the same injection time.
+    _injects[size_t(_profile.sectionToProfile(*sec->section))].insert(std::make_pair(next_inject, sec));
 }
 
 
@@ -801,7 +805,7 @@ void ts::EITGenerator::regeneratePresentFollowingSection(const ServiceIdTriplet&
             sec->section->appendPayload(event->event_data, true);
         }
         // Place the section in the inject queue.
-        enqueueInjectSection(sec, inject_time, true);
+        enqueueInjectSection(sec, inject_time);
     }
     else if (event.isNull()) {
         // The section already exists. It must be already in an injection queue.
@@ -970,7 +974,7 @@ void ts::EITGenerator::regenerateSchedule(const Time& now)
 
                         // Section complete.
                         sec->section->recomputeCRC();
-                        enqueueInjectSection(sec, getCurrentTime(), true);
+                        enqueueInjectSection(sec, now);
 
                         // Move to next section (if it exists).
                         ++sec_iter;
@@ -988,7 +992,7 @@ void ts::EITGenerator::regenerateSchedule(const Time& now)
                         const ESectionPtr sec(new ESection(this, service_id, table_id, first_section_number, first_section_number));
                         CheckNonNull(sec.pointer());
                         seg.sections.push_back(sec);
-                        enqueueInjectSection(sec, getCurrentTime(), true);
+                        enqueueInjectSection(sec, now);
                     }
                 }
 
@@ -1066,18 +1070,29 @@ void ts::EITGenerator::regenerateSchedule(const Time& now)
 void ts::EITGenerator::updateForNewTime(const Time& now)
 {
     // We cannot regenerate EIT if the TS id or the current time is unknown.
-    if (!_actual_ts_id_set || now == Time::Epoch) {
+    // Nothing to do if no service reached its next update time.
+    if (!_actual_ts_id_set || now == Time::Epoch || (_next_update != Time::Epoch && now < _next_update)) {
         return;
     }
 
     // Reference time for EIT schedule.
     const Time last_midnight(now.thisDay());
+    const Time next_midnight(last_midnight + MilliSecPerDay);
+
+    // Recompute the next update time of all services.
+    _next_update = next_midnight;
 
     // Loop on all services.
     for (auto srv_iter = _services.begin(); srv_iter != _services.end(); ++srv_iter) {
 
         const ServiceIdTriplet& service_id(srv_iter->first);
         EService& srv(srv_iter->second);
+
+        // Skip services which cannot have changed since last time.
+        if (srv.next_update != Time::Epoch && now < srv.next_update) {
+            _next_update = std::min(_next_update, srv.next_update);
+            continue;
+        }
         assert(!srv.segments.empty());
 
         // If we changed day, mark the service as being regenerated (will remove obsolete segments or create missing ones).
@@ -1097,15 +1112,35 @@ void ts::EITGenerator::updateForNewTime(const Time& now)
             ++seg_iter;
         }
 
+        // The service will change again at next midnight or at the end of the current segment.
+        srv.next_update = next_midnight;
+        if (seg_iter != srv.segments.end()) {
+            srv.next_update = std::min(srv.next_update, (*seg_iter)->start_time + EIT::SEGMENT_DURATION);
+        }
+
         // Remove obsolete events in the first segments (containing "now").
         if (seg_iter != srv.segments.end()) {
             ESegment& seg(**seg_iter);
-            while (!seg.events.empty() && seg.events.front()->end_time <= now) {
-                seg.events.pop_front();
+            auto ev_iter = seg.events.begin();
+            while (ev_iter != seg.events.end() && (*ev_iter)->end_time <= now) {
+                ++ev_iter;
+            }
+            if (ev_iter != seg.events.begin()) {
+                seg.events.erase(seg.events.begin(), ev_iter);
                 _regenerate = srv.regenerate = seg.regenerate = true;
             }
         }
 
+        // The EIT p/f will change at the end of the first event or at its start when it is not yet current.
+        for (auto it = seg_iter; it != srv.segments.end(); ++it) {
+            if (!(*it)->events.empty()) {
+                const Event& ev(*(*it)->events.front());
+                srv.next_update = std::min(srv.next_update, now < ev.start_time ? ev.start_time : ev.end_time);
+                break;
+            }
+        }
+        _next_update = std::min(_next_update, srv.next_update);
+
         // Renew EIT p/f of the service when necessary.
         regeneratePresentFollowing(service_id, srv, now);
     }
@@ -1137,11 +1172,11 @@ void ts::EITGenerator::provideSection(SectionCounter counter, SectionPtr& sectio
 
         // Check if the first section in the queue is ready for injection.
         // Loop on obsolete events. Return on first injected event.
-        while (!_injects[index].empty() && _injects[index].front()->next_inject <= now) {
+        while (!_injects[index].empty() && _injects[index].begin()->first <= now) {
 
             // Remove the first section from the queue.
-            const ESectionPtr sec(_injects[index].front());
-            _injects[index].pop_front();
+            const ESectionPtr sec(_injects[index].begin()->second);
+            _injects[index].erase(_injects[index].begin());
 
             if (sec->obsolete) {
                 // This is an obsolete section, no longer in the base, drop it.
@@ -1154,7 +1189,7 @@ void ts::EITGenerator::provideSection(SectionCounter counter, SectionPtr& sectio
                 sec->injected = true;
 
                 // Requeue next iteration of that section.
-                enqueueInjectSection(sec, now + _profile.repetitionSeconds(*sec->section) * MilliSecPerSec, false);
+                enqueueInjectSection(sec, now + _profile.repetitionSeconds(*sec->section) * MilliSecPerSec);
                 _duck.report().log(2, u"inject section TID 0x%X (%<d), service 0x%X (%<d), at %s, requeue for %s",
                                    {section->tableId(), section->tableIdExtension(), now, sec->next_inject});
                 return;
@@ -1281,7 +1316,7 @@ void ts::EITGenerator::dumpInternalState(int lev) const
             rep.log(lev, u"");
             rep.log(lev, u"- Injection queue #%d: %d sections", {index, _injects[index].size()});
             for (auto it = _injects[index].begin(); it != _injects[index].end(); ++it) {
-                dumpSection(lev, u"  - ", *it);
+                dumpSection(lev, u"  - ", it->second);
             }
         }
         rep.log(lev, u"");
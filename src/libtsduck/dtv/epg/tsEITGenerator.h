@@ -184,8 +184,13 @@ namespace ts {
     //!   - When a new event is loaded, the "regenerate" flag is set 1) globally, 2) on the service
     //!     and 3) on the 3-hour segment.
     //!   - When an EIT section needs to be injected, we check the global "regenerate" flag. When
-    //!     set, all services and segments are inspected and regenerated when necessary. All "regenerate"
+    //!     set, the services and segments which are marked are regenerated. All "regenerate"
     //!     flags are then cleared.
+    //! - In each service, the segments and the events in each segment are stored in contiguous
+    //!   containers, sorted by start time. An event or a segment is located using a binary search.
+    //! - Each service records the next time at which its EIT p/f or segments may change because of
+    //!   the time (end of the present event, end of current segment, next midnight). When the time
+    //!   increases, only the services which reached that time are updated.
     //!
     //! @see ETSI EN 300 468, 5.2.4
     //! @see ETSI TS 101 211, 4.1.4
@@ -387,7 +392,7 @@ namespace ts {
         };
 
         typedef SafePtr<Event> EventPtr;
-        typedef std::list<EventPtr> EventList;
+        typedef std::vector<EventPtr> EventList;
 
         // -----------------------------
         // Description of an EIT section
@@ -435,10 +440,13 @@ namespace ts {
 
             // Constructor.
             ESegment(const Time& seg_start_time);
+
+            // Compare the start time of an event with a time, for binary searches.
+            static bool EventStartsBefore(const EventPtr& ev, const Time& time) { return ev->start_time < time; }
         };
 
         typedef SafePtr<ESegment> ESegmentPtr;
-        typedef std::list<ESegmentPtr> ESegmentList;
+        typedef std::deque<ESegmentPtr> ESegmentList;
 
         // ------------------------
         // Description of a service
@@ -449,11 +457,15 @@ namespace ts {
             TS_NOCOPY(EService);
         public:
             bool         regenerate;  // Some segments must be regenerated in the service.
+            Time         next_update; // Next time when the service may change (Epoch: update it now).
             ESectionPair pf;          // EIT p/f sections (0: present, 1: following).
             ESegmentList segments;    // List of 3-hour segments (EPG events and EIT schedule sections).
 
             // Constructor.
             EService();
+
+            // Compare the start time of a segment with a time, for binary searches.
+            static bool SegmentStartsBefore(const ESegmentPtr& seg, const Time& time) { return seg->start_time < time; }
         };
 
         // -------------------
@@ -468,12 +480,13 @@ namespace ts {
         // The injection lists are organized by repetition profile, in order of profile
         // priority (from EIT p/f actual to EID sched other/later). In each list, all
         // sections have the same profile and, consequently, the same repetition rate.
-        // The sections are sorted in order of next injection. When a section is ready
-        // to inject, it is passed to the packetizer and requeued at the end of the list
-        // for the next injection.
+        // The sections are sorted in order of next injection, sections with the same
+        // injection time are kept in insertion order. When a section is ready to inject,
+        // it is passed to the packetizer and requeued for the next injection.
 
         typedef std::map<ServiceIdTriplet, EService> EServiceMap;
-        typedef std::array<ESectionList, EITRepetitionProfile::PROFILE_COUNT> ESectionListArray;
+        typedef std::multimap<Time, ESectionPtr> ESectionQueue;
+        typedef std::array<ESectionQueue, EITRepetitionProfile::PROFILE_COUNT> ESectionQueueArray;
 
         // ---------------------------
         // EITGenerator private fields
@@ -488,6 +501,7 @@ namespace ts {
         BitRate              _max_bitrate;       // Max EIT bitrate.
         BitRate              _ts_bitrate;        // Declared TS bitrate.
         Time                 _ref_time;          // Last reference time.
+        Time                 _next_update;       // Next time when some service may change (Epoch: update all now).
         PacketCounter        _ref_time_pkt;      // Packet index at last reference time.
         PacketCounter        _eit_inter_pkt;     // Inter-packet distance in the EIT PID (zero if unbound).
         PacketCounter        _last_eit_pkt;      // Packet index at last EIT insertion.
@@ -496,7 +510,7 @@ namespace ts {
         SectionDemux         _demux;             // Section demux for input stream, get PAT, TDT, TOT, EIT.
         Packetizer           _packetizer;        // Packetizer for generated EIT's.
         EServiceMap          _services;          // Map of services -> segments -> events and sections.
-        ESectionListArray    _injects;           // Arrays of sections for injection.
+        ESectionQueueArray   _injects;           // Arrays of sections for injection.
         size_t               _obsolete_count;    // Number of obsolete sections in the injection lists.
         std::map<uint32_t,uint8_t> _versions;    // Last version of sections.
 
@@ -509,8 +523,13 @@ namespace ts {
         // Update the EIT database according to the current time.
         // Obsolete events, sections and segments are discarded.
         // Segments which must be regenerated are marked as such (will be actually regenerated later, when used).
+        // Only the services which reached their next update time are processed.
         void updateForNewTime(const Time& now);
 
+        // Force the update of a service, or all services, on next updateForNewTime().
+        void forceUpdate(EService& srv) { srv.next_update = _next_update = Time::Epoch; }
+        void forceUpdate();
+
         // Regenerate, if necessary, EIT p/f in a service.
         void regeneratePresentFollowing(const ServiceIdTriplet& service_id, EService& srv, const Time& now);
         void regeneratePresentFollowingSection(const ServiceIdTriplet& service_id, ESectionPtr& sec, TID tid, bool section_number, const EventPtr& event, const Time&inject_time);
@@ -524,7 +543,7 @@ namespace ts {
         void markObsoleteSegment(ESegment& seg);
 
         // Enqueue a section for injection.
-        void enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject, bool try_front);
+        void enqueueInjectSection(const ESectionPtr& sec, const Time& next_inject);
 
         // Helper for dumpInternalState()
         void dumpSection(int level, const UString& margin, const ESectionPtr& section) const;
@@ -0,0 +1,424 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tshlsSegmentPrefetcher.h"
+#include "tsGuardMutex.h"
+#include "tsGuardCondition.h"
+#include "tsMonotonic.h"
+
+
+//----------------------------------------------------------------------------
+// A download thread.
+//----------------------------------------------------------------------------
+
+//! @cond nodoxygen
+class ts::hls::SegmentPrefetcher::Worker: public Thread
+{
+    TS_NOBUILD_NOCOPY(Worker);
+public:
+    Worker(SegmentPrefetcher& parent) : Thread(), _parent(parent), _request(parent._report) {}
+    virtual ~Worker() override { waitForTermination(); }
+    void abortRequest() { _request.abort(); }
+private:
+    SegmentPrefetcher& _parent;
+    WebRequest _request;
+    virtual void main() override { _parent.download(_request); }
+};
+//! @endcond
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::hls::SegmentPrefetcher::Statistics::Statistics() :
+    segments(0),
+    bytes(0),
+    failures(0),
+    reloads(0),
+    stalls(0),
+    max_active(0),
+    max_ready(0),
+    download_time(0),
+    stall_time(0)
+{
+}
+
+ts::hls::SegmentPrefetcher::Segment::Segment(uint64_t idx, const UString& u) :
+    index(idx),
+    url(u),
+    state(SegmentState::PENDING),
+    data()
+{
+}
+
+ts::hls::SegmentPrefetcher::SegmentPrefetcher(Report& report) :
+    Thread(),
+    _report(report),
+    _playlist(),
+    _args(),
+    _depth(1),
+    _max_segments(0),
+    _workers(),
+    _mutex(),
+    _space(),
+    _pending(),
+    _ready(),
+    _queue(),
+    _next_index(0),
+    _active(0),
+    _started(false),
+    _end_list(false),
+    _terminate(false),
+    _delivered(false),
+    _stats()
+{
+}
+
+ts::hls::SegmentPrefetcher::~SegmentPrefetcher()
+{
+    stop();
+}
+
+
+//----------------------------------------------------------------------------
+// Start prefetching the media segments of a playlist.
+//----------------------------------------------------------------------------
+
+bool ts::hls::SegmentPrefetcher::start(const PlayList& playlist, const WebRequestArgs& args, size_t depth, size_t max_segments)
+{
+    if (_started) {
+        _report.error(u"HLS segment prefetch already started");
+        return false;
+    }
+    if (!playlist.isMedia()) {
+        _report.error(u"invalid HLS playlist type, expected a media playlist");
+        return false;
+    }
+
+    _playlist = playlist;
+    _args = args;
+    _depth = std::max<size_t>(depth, 1);
+    _max_segments = max_segments;
+    _queue.clear();
+    _next_index = 0;
+    _active = 0;
+    _end_list = false;
+    _terminate = false;
+    _delivered = false;
+    _stats = Statistics();
+
+    // Start the download threads, then the playlist thread.
+    _workers.clear();
+    for (size_t i = 0; i < _depth; ++i) {
+        _workers.push_back(new Worker(*this));
+        _workers.back()->start();
+    }
+    Thread::start();
+    _started = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Request termination of all threads.
+//----------------------------------------------------------------------------
+
+void ts::hls::SegmentPrefetcher::terminate()
+{
+    {
+        GuardMutex lock(_mutex);
+        _terminate = true;
+        // Wake up all threads, whatever they wait for.
+        for (size_t i = 0; i < _workers.size(); ++i) {
+            _pending.signal();
+        }
+        _space.signal();
+        _ready.signal();
+    }
+
+    // Interrupt the downloads in progress.
+    for (const auto& worker : _workers) {
+        worker->abortRequest();
+    }
+}
+
+void ts::hls::SegmentPrefetcher::abort()
+{
+    terminate();
+}
+
+void ts::hls::SegmentPrefetcher::stop()
+{
+    if (_started) {
+        terminate();
+        waitForTermination();
+        for (const auto& worker : _workers) {
+            worker->waitForTermination();
+        }
+        _workers.clear();
+        _started = false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get a snapshot of the prefetch statistics.
+//----------------------------------------------------------------------------
+
+ts::hls::SegmentPrefetcher::Statistics ts::hls::SegmentPrefetcher::statistics() const
+{
+    GuardMutex lock(_mutex);
+    return _stats;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the next media segment, in playlist order.
+//----------------------------------------------------------------------------
+
+bool ts::hls::SegmentPrefetcher::getNextSegment(ByteBlock& data, UString& url)
+{
+    GuardCondition lock(_mutex, _ready);
+
+    for (;;) {
+        // Deliver or skip the first segment in the queue when its download is completed.
+        if (!_queue.empty() && (_queue.front().state == SegmentState::READY || _queue.front().state == SegmentState::FAILED)) {
+            Segment& seg(_queue.front());
+            const bool ok = seg.state == SegmentState::READY;
+            if (ok) {
+                data.swap(seg.data);
+                url = seg.url;
+                _delivered = true;
+            }
+            else {
+                _report.warning(u"skipping HLS segment %s", {seg.url});
+            }
+            _queue.pop_front();
+            _space.signal();
+            if (ok) {
+                return true;
+            }
+            continue;
+        }
+
+        if (!_started || _terminate || (_end_list && _queue.empty())) {
+            return false;
+        }
+
+        // Wait for the download of the next segment. After the first segment, this is an underrun.
+        const Monotonic start(true);
+        while (!_terminate &&
+               (_queue.empty() || _queue.front().state == SegmentState::PENDING || _queue.front().state == SegmentState::DOWNLOADING) &&
+               !(_end_list && _queue.empty()))
+        {
+            lock.waitCondition();
+        }
+        if (_delivered) {
+            _stats.stalls++;
+            _stats.stall_time += Monotonic(true) - start;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Playlist thread: feed the queue with segments from the playlist.
+//----------------------------------------------------------------------------
+
+void ts::hls::SegmentPrefetcher::main()
+{
+    for (;;) {
+        // Wait for free space in the queue.
+        {
+            GuardCondition lock(_mutex, _space);
+            while (!_terminate && _queue.size() >= _depth) {
+                lock.waitCondition();
+            }
+            if (_terminate) {
+                break;
+            }
+        }
+
+        // Check if the playlist is completed. The playlist is used by this thread only, no need to lock.
+        if ((_max_segments > 0 && _next_index >= _max_segments) || !fillPlayList()) {
+            _report.verbose(u"HLS playlist completed");
+            break;
+        }
+
+        // Remove first segment from the playlist and queue it for download.
+        MediaSegment seg;
+        _playlist.popFirstSegment(seg);
+        _report.debug(u"prefetching segment %s", {seg.urlString()});
+
+        GuardCondition lock(_mutex, _pending);
+        _queue.push_back(Segment(_next_index++, seg.urlString()));
+        lock.signal();
+    }
+
+    // No more segment will be queued, wake up all download threads and the application.
+    GuardMutex lock(_mutex);
+    _end_list = true;
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        _pending.signal();
+    }
+    _ready.signal();
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for new segments in the playlist, reload it when necessary.
+// Return false when there is no more segment.
+//----------------------------------------------------------------------------
+
+bool ts::hls::SegmentPrefetcher::fillPlayList()
+{
+    // If there is only one or zero remaining segment, try to reload the playlist.
+    if (_playlist.segmentCount() < 2 && _playlist.isUpdatable()) {
+
+        // Reload the playlist, ignore errors, continue to play next segments.
+        reload();
+
+        // For live streams, new segments can be produced as late as the estimated end time
+        // of the previous playlist. Retry at regular intervals until we get new segments.
+        while (_playlist.segmentCount() == 0 && Time::CurrentUTC() <= _playlist.terminationUTC()) {
+
+            // The wait between two retries is half the target duration of a segment, with a minimum of 2 seconds.
+            // The wait is interrupted on termination request.
+            const Time end(Time::CurrentUTC() + std::max<MilliSecond>(2000, (MilliSecPerSec * _playlist.targetDuration()) / 2));
+            {
+                GuardCondition lock(_mutex, _space);
+                for (Time now(Time::CurrentUTC()); !_terminate && now < end; now = Time::CurrentUTC()) {
+                    lock.waitCondition(end - now);
+                }
+                if (_terminate) {
+                    return false;
+                }
+            }
+
+            // This time, we stop on reload error.
+            if (!reload()) {
+                break;
+            }
+        }
+    }
+    return _playlist.segmentCount() > 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Reload the playlist and count reloads (playlist thread).
+//----------------------------------------------------------------------------
+
+bool ts::hls::SegmentPrefetcher::reload()
+{
+    const bool ok = reloadPlayList(_playlist, _args);
+    GuardMutex lock(_mutex);
+    _stats.reloads++;
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Download threads.
+//----------------------------------------------------------------------------
+
+void ts::hls::SegmentPrefetcher::download(WebRequest& request)
+{
+    // Set common web request options.
+    request.setArgs(_args);
+    request.setAutoRedirect(true);
+
+    for (;;) {
+        uint64_t index = 0;
+        UString url;
+
+        // Wait for a segment to download.
+        {
+            GuardCondition lock(_mutex, _pending);
+            auto seg = _queue.end();
+            for (;;) {
+                seg = std::find_if(_queue.begin(), _queue.end(), [](const Segment& s) { return s.state == SegmentState::PENDING; });
+                if (_terminate || seg != _queue.end() || _end_list) {
+                    break;
+                }
+                lock.waitCondition();
+            }
+            if (_terminate || seg == _queue.end()) {
+                break;
+            }
+            seg->state = SegmentState::DOWNLOADING;
+            index = seg->index;
+            url = seg->url;
+            _active++;
+            _stats.max_active = std::max(_stats.max_active, _active);
+        }
+
+        // Download the segment without holding the mutex.
+        ByteBlock data;
+        const Monotonic start(true);
+        const bool ok = downloadSegment(request, url, data);
+        const NanoSecond duration = Monotonic(true) - start;
+
+        // Store the segment in the queue. The segment cannot be removed from the queue while it is downloaded.
+        GuardCondition lock(_mutex, _ready);
+        _active--;
+        _stats.download_time += duration;
+        if (ok) {
+            _stats.segments++;
+            _stats.bytes += data.size();
+        }
+        else {
+            _stats.failures++;
+        }
+        if (!_queue.empty() && index >= _queue.front().index && index - _queue.front().index < _queue.size()) {
+            Segment& seg(_queue[size_t(index - _queue.front().index)]);
+            seg.data.swap(data);
+            seg.state = ok ? SegmentState::READY : SegmentState::FAILED;
+        }
+        const size_t ready = size_t(std::count_if(_queue.begin(), _queue.end(), [](const Segment& s) { return s.state == SegmentState::READY; }));
+        _stats.max_ready = std::max(_stats.max_ready, ready);
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Default implementations of the download and reload operations.
+//----------------------------------------------------------------------------
+
+bool ts::hls::SegmentPrefetcher::downloadSegment(WebRequest& request, const UString& url, ByteBlock& data)
+{
+    return request.downloadBinaryContent(url, data);
+}
+
+bool ts::hls::SegmentPrefetcher::reloadPlayList(PlayList& playlist, const WebRequestArgs& args)
+{
+    return playlist.reload(false, args, _report);
+}
@@ -0,0 +1,205 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Concurrent prefetching of HLS media segments.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tshlsPlayList.h"
+#include "tsWebRequest.h"
+#include "tsWebRequestArgs.h"
+#include "tsByteBlock.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsSafePtr.h"
+
+namespace ts {
+    namespace hls {
+        //!
+        //! Concurrent prefetching of the media segments of an HLS media playlist.
+        //! @ingroup hls
+        //!
+        //! Up to @e depth media segments are simultaneously downloaded by a pool of
+        //! worker threads into a bounded memory queue. The segments are returned to
+        //! the application in playlist order, regardless of the order of download
+        //! completion. The reload of live playlists is performed by an internal thread,
+        //! in parallel with the downloads of the segments.
+        //!
+        //! Subclasses may redefine the download and reload operations, for instance
+        //! to use another transport. In that case, the subclass destructor must call
+        //! stop() since the virtual methods are invoked from the internal threads.
+        //!
+        class TSDUCKDLL SegmentPrefetcher: private Thread
+        {
+            TS_NOBUILD_NOCOPY(SegmentPrefetcher);
+        public:
+            //!
+            //! Statistics of the prefetch operations.
+            //!
+            struct TSDUCKDLL Statistics
+            {
+                Statistics();               //!< Constructor.
+                uint64_t   segments;        //!< Number of downloaded media segments.
+                uint64_t   bytes;           //!< Total downloaded bytes in media segments.
+                uint64_t   failures;        //!< Number of failed segment downloads.
+                uint64_t   reloads;         //!< Number of playlist reloads.
+                uint64_t   stalls;          //!< Number of times the application waited for a segment (underruns).
+                size_t     max_active;      //!< Maximum number of simultaneous downloads.
+                size_t     max_ready;       //!< Maximum number of downloaded segments waiting for the application.
+                NanoSecond download_time;   //!< Total time in segment downloads.
+                NanoSecond stall_time;      //!< Total time the application waited for a segment.
+            };
+
+            //!
+            //! Constructor.
+            //! @param [in,out] report Where to report errors. Must be thread-safe.
+            //!
+            SegmentPrefetcher(Report& report);
+
+            //!
+            //! Destructor. Stop all downloads.
+            //!
+            virtual ~SegmentPrefetcher() override;
+
+            //!
+            //! Start prefetching the media segments of a playlist.
+            //! @param [in] playlist A media playlist. A copy is used, the initial segments of the
+            //! copy are the first segments to prefetch. Live playlists are periodically reloaded.
+            //! @param [in] args Web request options for the downloads.
+            //! @param [in] depth Maximum number of segments which are simultaneously downloaded
+            //! or waiting in memory. This is also the number of download threads.
+            //! @param [in] max_segments Maximum number of segments to download. Zero means no limit.
+            //! @return True on success, false on error.
+            //!
+            bool start(const PlayList& playlist, const WebRequestArgs& args, size_t depth, size_t max_segments = 0);
+
+            //!
+            //! Get the next media segment, in playlist order.
+            //! Wait until the segment is downloaded when necessary. Segments which could not be
+            //! downloaded are reported and skipped.
+            //! @param [out] data Content of the media segment.
+            //! @param [out] url URL of the media segment.
+            //! @return True on success, false at end of playlist or after abort().
+            //!
+            bool getNextSegment(ByteBlock& data, UString& url);
+
+            //!
+            //! Abort all downloads in progress. This method can be called from any thread.
+            //! After abort(), getNextSegment() returns false.
+            //!
+            void abort();
+
+            //!
+            //! Abort all downloads and wait for the termination of all internal threads.
+            //!
+            void stop();
+
+            //!
+            //! Get a snapshot of the prefetch statistics.
+            //! @return The current statistics.
+            //!
+            Statistics statistics() const;
+
+        protected:
+            //!
+            //! Download a media segment. Invoked in the context of a download thread.
+            //! The default implementation downloads the URL using the Web request.
+            //! @param [in,out] request A Web request, owned by the calling thread, with options already set.
+            //! @param [in] url URL of the media segment.
+            //! @param [out] data Content of the media segment.
+            //! @return True on success, false on error.
+            //!
+            virtual bool downloadSegment(WebRequest& request, const UString& url, ByteBlock& data);
+
+            //!
+            //! Reload a live playlist. Invoked in the context of the playlist thread.
+            //! The default implementation calls PlayList::reload().
+            //! @param [in,out] playlist The playlist to reload.
+            //! @param [in] args Web request options.
+            //! @return True on success, false on error.
+            //!
+            virtual bool reloadPlayList(PlayList& playlist, const WebRequestArgs& args);
+
+        private:
+            // A download thread.
+            class Worker;
+            typedef SafePtr<Worker> WorkerPtr;
+
+            // State of a segment in the prefetch queue.
+            enum class SegmentState {PENDING, DOWNLOADING, READY, FAILED};
+
+            // A segment in the prefetch queue.
+            struct Segment
+            {
+                Segment(uint64_t index, const UString& url);
+                uint64_t     index;  // Index in the sequence of prefetched segments.
+                UString      url;    // Segment URL.
+                SegmentState state;  // Download state.
+                ByteBlock    data;   // Segment content, when ready.
+            };
+
+            Report&                _report;        // Where to report errors.
+            PlayList               _playlist;      // Media playlist, used by the playlist thread only.
+            WebRequestArgs         _args;          // Web request options.
+            size_t                 _depth;         // Maximum number of segments in the queue.
+            size_t                 _max_segments;  // Maximum number of segments to download, zero if unlimited.
+            std::vector<WorkerPtr> _workers;       // Download threads.
+            mutable Mutex          _mutex;         // Protect the fields below.
+            Condition              _space;         // Signaled when a segment is removed from the queue.
+            Condition              _pending;       // Signaled when a segment is added to the queue.
+            Condition              _ready;         // Signaled when a segment download is completed.
+            std::deque<Segment>    _queue;         // Prefetched segments, in playlist order.
+            uint64_t               _next_index;    // Index of next segment to add in the queue.
+            size_t                 _active;        // Number of downloads in progress.
+            bool                   _started;       // Internal threads are started.
+            bool                   _end_list;      // No more segment will be added in the queue.
+            bool                   _terminate;     // Request to terminate all threads.
+            bool                   _delivered;     // At least one segment was delivered to the application.
+            Statistics             _stats;         // Statistics.
+
+            // Playlist thread.
+            virtual void main() override;
+
+            // Wait for new segments in the playlist, reload it when necessary (playlist thread).
+            bool fillPlayList();
+
+            // Reload the playlist and count reloads (playlist thread).
+            bool reload();
+
+            // Main code of the download threads.
+            void download(WebRequest& request);
+
+            // Request termination of all threads.
+            void terminate();
+        };
+    }
+}
@@ -0,0 +1,230 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tshlsSegmentStore.h"
+#include "tsGuardMutex.h"
+#include "tsReportBuffer.h"
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::MilliSecond ts::hls::SegmentStore::DEFAULT_CLIENT_TIMEOUT;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::hls::SegmentStore::SegmentStore() :
+    Thread(),
+    _mutex(),
+    _files(),
+    _server(),
+    _report(&NULLREP),
+    _timeout(DEFAULT_CLIENT_TIMEOUT),
+    _started(false),
+    _terminate(false)
+{
+}
+
+ts::hls::SegmentStore::~SegmentStore()
+{
+    stopServer();
+}
+
+
+//----------------------------------------------------------------------------
+// Manage the stored files.
+//----------------------------------------------------------------------------
+
+void ts::hls::SegmentStore::store(const UString& name, const ByteBlockPtrMT& content)
+{
+    GuardMutex lock(_mutex);
+    _files[name] = content;
+}
+
+bool ts::hls::SegmentStore::remove(const UString& name)
+{
+    GuardMutex lock(_mutex);
+    return _files.erase(name) > 0;
+}
+
+ts::ByteBlockPtrMT ts::hls::SegmentStore::get(const UString& name) const
+{
+    GuardMutex lock(_mutex);
+    const auto it = _files.find(name);
+    return it == _files.end() ? ByteBlockPtrMT() : it->second;
+}
+
+size_t ts::hls::SegmentStore::fileCount() const
+{
+    GuardMutex lock(_mutex);
+    return _files.size();
+}
+
+void ts::hls::SegmentStore::clear()
+{
+    GuardMutex lock(_mutex);
+    _files.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Get the MIME type of an HLS file from its name.
+//----------------------------------------------------------------------------
+
+ts::UString ts::hls::SegmentStore::MimeType(const UString& name)
+{
+    if (name.endWith(u".m3u8", CASE_INSENSITIVE) || name.endWith(u".m3u", CASE_INSENSITIVE)) {
+        return u"application/vnd.apple.mpegurl";
+    }
+    else if (name.endWith(u".ts", CASE_INSENSITIVE)) {
+        return u"video/mp2t";
+    }
+    else {
+        return u"application/octet-stream";
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Start/stop the HTTP server.
+//----------------------------------------------------------------------------
+
+bool ts::hls::SegmentStore::startServer(const IPv4SocketAddress& address, Report& report, MilliSecond client_timeout)
+{
+    if (_started) {
+        report.error(u"HLS HTTP server already started");
+        return false;
+    }
+    if (!address.hasPort()) {
+        report.error(u"missing port number for HLS HTTP server");
+        return false;
+    }
+    if (!_server.open(report) || !_server.reusePort(true, report) || !_server.bind(address, report) || !_server.listen(16, report)) {
+        _server.close(NULLREP);
+        report.error(u"error starting HLS HTTP server on %s", {address});
+        return false;
+    }
+    _report = &report;
+    _timeout = client_timeout;
+    _terminate = false;
+    _started = true;
+    return start();
+}
+
+void ts::hls::SegmentStore::stopServer()
+{
+    if (_started) {
+        // Closing the TCP server forces the server thread to terminate.
+        _terminate = true;
+        _server.close(NULLREP);
+        waitForTermination();
+        _started = false;
+        _report = &NULLREP;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Server thread.
+//----------------------------------------------------------------------------
+
+void ts::hls::SegmentStore::main()
+{
+    _report->debug(u"HLS HTTP server started");
+
+    // Get accept errors in a buffer since some errors are normal on termination.
+    ReportBuffer<NullMutex> error(_report->maxSeverity());
+    IPv4SocketAddress client;
+    TelnetConnection conn;
+
+    // Serve one request per connection, one connection at a time.
+    while (_server.accept(conn, client, error)) {
+        serve(conn, client);
+        conn.closeWriter(NULLREP);
+        conn.close(NULLREP);
+    }
+
+    if (!_terminate && !error.emptyMessages()) {
+        _report->error(error.getMessages());
+    }
+    _report->debug(u"HLS HTTP server completed");
+}
+
+
+//----------------------------------------------------------------------------
+// Process one HTTP request from a client.
+//----------------------------------------------------------------------------
+
+void ts::hls::SegmentStore::serve(TelnetConnection& conn, const IPv4SocketAddress& client)
+{
+    // Read the request line and skip all headers, up to the empty line.
+    UString request;
+    UString header;
+    if (!conn.setReceiveTimeout(_timeout, *_report) || !conn.receiveLine(request, nullptr, NULLREP)) {
+        return;
+    }
+    do {
+        if (!conn.receiveLine(header, nullptr, NULLREP)) {
+            return;
+        }
+    } while (!header.empty());
+
+    // Analyze the request line: "GET /name?query HTTP/1.1".
+    UStringVector fields;
+    request.split(fields, u' ', true, true);
+    const UString method(fields.size() > 0 ? fields[0] : UString());
+    UString name(fields.size() > 1 ? fields[1] : UString());
+    name.resize(std::min(name.size(), name.find(u'?')));
+    while (name.startWith(u"/")) {
+        name.erase(0, 1);
+    }
+    _report->debug(u"HTTP request from %s: %s", {client, request});
+
+    // Build the response.
+    const bool head = method == u"HEAD";
+    ByteBlockPtrMT content;
+    UString status;
+    if (!head && method != u"GET") {
+        status = u"405 Method Not Allowed";
+    }
+    else if ((content = get(name)).isNull()) {
+        status = u"404 Not Found";
+    }
+    else {
+        status = u"200 OK";
+    }
+
+    const size_t size = content.isNull() ? 0 : content->size();
+    const std::string response(UString::Format(u"HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %d\r\nConnection: close\r\n\r\n",
+                                                {status, MimeType(name), size}).toUTF8());
+    if (conn.TCPConnection::send(response.data(), response.size(), NULLREP) && !head && size > 0) {
+        conn.TCPConnection::send(content->data(), size, NULLREP);
+    }
+}
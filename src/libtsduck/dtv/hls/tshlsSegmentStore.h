@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  In-memory store of HLS playlists and media segments.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsByteBlock.h"
+#include "tsTCPServer.h"
+#include "tsTelnetConnection.h"
+#include "tsIPv4SocketAddress.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsNullReport.h"
+
+namespace ts {
+    namespace hls {
+        //!
+        //! In-memory store of HLS playlists and media segments.
+        //! @ingroup hls
+        //!
+        //! An HLS producer can publish its playlists and media segments in this store
+        //! instead of files. The content of the store is served to HLS clients by an
+        //! embedded minimal HTTP server: each file is available at the URL path "/name"
+        //! where "name" is the file name in the store. All methods are thread-safe.
+        //!
+        class TSDUCKDLL SegmentStore: private Thread
+        {
+            TS_NOCOPY(SegmentStore);
+        public:
+            //!
+            //! Default timeout of HTTP client connections, in milliseconds.
+            //!
+            static constexpr MilliSecond DEFAULT_CLIENT_TIMEOUT = 5000;
+
+            //!
+            //! Constructor.
+            //!
+            SegmentStore();
+
+            //!
+            //! Destructor. Stop the HTTP server.
+            //!
+            virtual ~SegmentStore() override;
+
+            //!
+            //! Store a file, replace any previous file with the same name.
+            //! @param [in] name File name.
+            //! @param [in] content File content. The content shall not be modified after being stored.
+            //!
+            void store(const UString& name, const ByteBlockPtrMT& content);
+
+            //!
+            //! Remove a file from the store.
+            //! @param [in] name File name.
+            //! @return True if the file was removed, false if it did not exist.
+            //!
+            bool remove(const UString& name);
+
+            //!
+            //! Get the content of a file.
+            //! @param [in] name File name.
+            //! @return A shared pointer to the file content, null if the file does not exist.
+            //!
+            ByteBlockPtrMT get(const UString& name) const;
+
+            //!
+            //! Get the number of files in the store.
+            //! @return The number of files in the store.
+            //!
+            size_t fileCount() const;
+
+            //!
+            //! Remove all files from the store.
+            //!
+            void clear();
+
+            //!
+            //! Start the HTTP server.
+            //! @param [in] address Local socket address of the server. The port is required.
+            //! @param [in,out] report Where to report errors. Must be thread-safe, it is used by the server thread.
+            //! @param [in] client_timeout Timeout of client connections in milliseconds.
+            //! @return True on success, false on error.
+            //!
+            bool startServer(const IPv4SocketAddress& address, Report& report, MilliSecond client_timeout = DEFAULT_CLIENT_TIMEOUT);
+
+            //!
+            //! Stop the HTTP server. Files remain in the store.
+            //!
+            void stopServer();
+
+            //!
+            //! Get the MIME type of an HLS file from its name.
+            //! @param [in] name File name.
+            //! @return The corresponding MIME type.
+            //!
+            static UString MimeType(const UString& name);
+
+        private:
+            mutable Mutex                    _mutex;      // Protect the file map.
+            std::map<UString,ByteBlockPtrMT> _files;      // Stored files, indexed by name.
+            TCPServer                        _server;     // HTTP server socket.
+            Report*                          _report;     // Server thread reports.
+            MilliSecond                      _timeout;    // Client connection timeout.
+            volatile bool                    _started;    // Server thread is started.
+            volatile bool                    _terminate;  // Server termination request.
+
+            // Server thread.
+            virtual void main() override;
+
+            // Process one HTTP request from a client.
+            void serve(TelnetConnection& conn, const IPv4SocketAddress& client);
+        };
+    }
+}
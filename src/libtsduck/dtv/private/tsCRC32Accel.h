@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Hardware-accelerated implementations of CRC32 (internal).
+//!
+//!  This header is included by the CRC32 module and its instruction set
+//!  specific variants. It shall not include other TSDuck headers than the
+//!  basic platform definitions: the variants are compiled with specific
+//!  instruction sets and all inline code from other headers would be
+//!  compiled with these instructions.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Internal implementation of hardware-accelerated CRC32.
+    //! This namespace is internal to the TSDuck library and cannot be called by applications.
+    //!
+    namespace crc32accel {
+
+        //!
+        //! Minimum size of data areas which are processed by a folding function.
+        //!
+        constexpr size_t MIN_FOLD_SIZE = 64;
+
+        //!
+        //! Profile of a function which folds a large data area using carry-less multiplications.
+        //!
+        //! The data area is processed by chunks of 16 bytes and "folded" into one 16-byte residue
+        //! which has the same CRC32 as the processed data. The final CRC32 is the CRC32 of the
+        //! residue, starting from an initial value of zero, followed by the remaining bytes.
+        //!
+        //! @param [in] fcs Initial value of the CRC32.
+        //! @param [in] data Address of the data area.
+        //! @param [in] size Size in bytes of the data area. Must be at least MIN_FOLD_SIZE.
+        //! @param [out] residue Address of a 16-byte buffer receiving the folded residue.
+        //! @return Number of bytes which were processed from @a data, a multiple of 16.
+        //!
+        typedef size_t (*FoldFunction)(uint32_t fcs, const uint8_t* data, size_t size, uint8_t* residue);
+
+        //!
+        //! Folding using Intel PCLMULQDQ instructions.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const FoldFunction FoldPCLMUL;
+
+        //!
+        //! Folding using Arm v8 PMULL instructions.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const FoldFunction FoldPMULL;
+    }
+}
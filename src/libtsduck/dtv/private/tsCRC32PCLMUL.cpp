@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  CRC32 folding using Intel PCLMULQDQ instructions.
+//  With GCC and clang, this module is compiled with PCLMUL and SSSE3 code generation.
+//  With MSVC, the intrinsics are always available.
+//
+//  The MPEG CRC32 is not bit-reflected. The data are loaded in big-endian
+//  order in 128-bit registers so that bit N of a register is the coefficient
+//  of x^N. Folding a 128-bit value X = H.x^64 + L over a distance of D bits
+//  is computed as H.(x^(D+64) mod P) + L.(x^D mod P), which is congruent to
+//  X.x^D modulo the CRC32 polynomial P.
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32Accel.h"
+
+#if (defined(__PCLMUL__) && defined(__SSSE3__)) || (defined(TS_MSC) && (defined(TS_X86_64) || defined(TS_I386)))
+
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+namespace {
+
+    // Load and store 16 bytes in big-endian order.
+    inline __m128i Load(const uint8_t* p, __m128i swap)
+    {
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), swap);
+    }
+
+    inline void Store(uint8_t* p, __m128i v, __m128i swap)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_shuffle_epi8(v, swap));
+    }
+
+    // Fold a 128-bit value over a distance which is defined by the constants in k.
+    inline __m128i Fold(__m128i x, __m128i k)
+    {
+        return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+    }
+
+    size_t FoldData(uint32_t fcs, const uint8_t* data, size_t size, uint8_t* residue)
+    {
+        // Byte order reversal in a 128-bit register.
+        const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+        // Folding constants: (x^(D+64) mod P, x^D mod P) for D = 512 and 128 bits.
+        const __m128i k512 = _mm_set_epi64x(0x8833794C, 0xE6228B11);
+        const __m128i k128 = _mm_set_epi64x(0xC5B9CD4C, 0xE8A45605);
+
+        // Four independent accumulators to fill the multiplier pipeline.
+        // The initial CRC value is added to the first 32 bits of data.
+        __m128i x0 = _mm_xor_si128(Load(data, swap), _mm_set_epi32(int32_t(fcs), 0, 0, 0));
+        __m128i x1 = Load(data + 16, swap);
+        __m128i x2 = Load(data + 32, swap);
+        __m128i x3 = Load(data + 48, swap);
+        const uint8_t* const start = data;
+        data += 64;
+        size -= 64;
+
+        for (; size >= 64; data += 64, size -= 64) {
+            x0 = _mm_xor_si128(Fold(x0, k512), Load(data, swap));
+            x1 = _mm_xor_si128(Fold(x1, k512), Load(data + 16, swap));
+            x2 = _mm_xor_si128(Fold(x2, k512), Load(data + 32, swap));
+            x3 = _mm_xor_si128(Fold(x3, k512), Load(data + 48, swap));
+        }
+
+        // Reduce the four accumulators into one, then fold the remaining 16-byte chunks.
+        x0 = _mm_xor_si128(Fold(x0, k128), x1);
+        x0 = _mm_xor_si128(Fold(x0, k128), x2);
+        x0 = _mm_xor_si128(Fold(x0, k128), x3);
+        for (; size >= 16; data += 16, size -= 16) {
+            x0 = _mm_xor_si128(Fold(x0, k128), Load(data, swap));
+        }
+
+        Store(residue, x0, swap);
+        return size_t(data - start);
+    }
+}
+
+const ts::crc32accel::FoldFunction ts::crc32accel::FoldPCLMUL = FoldData;
+
+#else
+
+// PCLMULQDQ is not supported by the compiler or the target CPU.
+const ts::crc32accel::FoldFunction ts::crc32accel::FoldPCLMUL = nullptr;
+
+#endif
@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  CRC32 folding using Arm v8 PMULL instructions (cryptographic extension).
+//  With GCC and clang, this module is compiled with the crypto extension.
+//  See tsCRC32PCLMUL.cpp for a description of the algorithm.
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32Accel.h"
+
+#if defined(TS_ARM64) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+
+#include <arm_neon.h>
+
+namespace {
+
+    // Load and store 16 bytes in big-endian order.
+    inline uint64x2_t Load(const uint8_t* p)
+    {
+        const uint8x16_t v = vrev64q_u8(vld1q_u8(p));
+        return vreinterpretq_u64_u8(vextq_u8(v, v, 8));
+    }
+
+    inline void Store(uint8_t* p, uint64x2_t x)
+    {
+        const uint8x16_t v = vrev64q_u8(vreinterpretq_u8_u64(x));
+        vst1q_u8(p, vextq_u8(v, v, 8));
+    }
+
+    // Build a 128-bit value from two 64-bit halves.
+    inline uint64x2_t Make(uint64_t hi, uint64_t lo)
+    {
+        return vcombine_u64(vcreate_u64(lo), vcreate_u64(hi));
+    }
+
+    // Fold a 128-bit value over a distance which is defined by the constants in k.
+    inline uint64x2_t Fold(uint64x2_t x, uint64x2_t k)
+    {
+        const poly128_t lo = vmull_p64(poly64_t(vgetq_lane_u64(x, 0)), poly64_t(vgetq_lane_u64(k, 0)));
+        const poly128_t hi = vmull_p64(poly64_t(vgetq_lane_u64(x, 1)), poly64_t(vgetq_lane_u64(k, 1)));
+        return veorq_u64(vreinterpretq_u64_p128(lo), vreinterpretq_u64_p128(hi));
+    }
+
+    size_t FoldData(uint32_t fcs, const uint8_t* data, size_t size, uint8_t* residue)
+    {
+        // Folding constants: (x^(D+64) mod P, x^D mod P) for D = 512 and 128 bits.
+        const uint64x2_t k512 = Make(0x8833794C, 0xE6228B11);
+        const uint64x2_t k128 = Make(0xC5B9CD4C, 0xE8A45605);
+
+        // Four independent accumulators to fill the multiplier pipeline.
+        // The initial CRC value is added to the first 32 bits of data.
+        uint64x2_t x0 = veorq_u64(Load(data), Make(uint64_t(fcs) << 32, 0));
+        uint64x2_t x1 = Load(data + 16);
+        uint64x2_t x2 = Load(data + 32);
+        uint64x2_t x3 = Load(data + 48);
+        const uint8_t* const start = data;
+        data += 64;
+        size -= 64;
+
+        for (; size >= 64; data += 64, size -= 64) {
+            x0 = veorq_u64(Fold(x0, k512), Load(data));
+            x1 = veorq_u64(Fold(x1, k512), Load(data + 16));
+            x2 = veorq_u64(Fold(x2, k512), Load(data + 32));
+            x3 = veorq_u64(Fold(x3, k512), Load(data + 48));
+        }
+
+        // Reduce the four accumulators into one, then fold the remaining 16-byte chunks.
+        x0 = veorq_u64(Fold(x0, k128), x1);
+        x0 = veorq_u64(Fold(x0, k128), x2);
+        x0 = veorq_u64(Fold(x0, k128), x3);
+        for (; size >= 16; data += 16, size -= 16) {
+            x0 = veorq_u64(Fold(x0, k128), Load(data));
+        }
+
+        Store(residue, x0);
+        return size_t(data - start);
+    }
+}
+
+const ts::crc32accel::FoldFunction ts::crc32accel::FoldPMULL = FoldData;
+
+#else
+
+// PMULL is not supported by the compiler or the target CPU.
+const ts::crc32accel::FoldFunction ts::crc32accel::FoldPMULL = nullptr;
+
+#endif
@@ -0,0 +1,299 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileAsyncWriter.h"
+#include "tsGuardMutex.h"
+#include "tsGuardCondition.h"
+#include "tsMonotonic.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TSFileAsyncWriter::ALIGNMENT;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::TSFileAsyncWriter::Buffer::Buffer() :
+    storage(),
+    offset(0),
+    size(0)
+{
+}
+
+ts::TSFileAsyncWriter::TSFileAsyncWriter(FileHandle handle, const UString& name, size_t depth, size_t buffer_size, bool direct_io) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetHighPriority())),
+    _handle(handle),
+    _name(name),
+    _buffer_size(round_up(std::max<size_t>(buffer_size, 1), ALIGNMENT)),
+    _direct_io(direct_io),
+    _buffers(std::max<size_t>(depth, 1) + 1),
+    _fill(0),
+    _mutex(),
+    _to_write(),
+    _completed(),
+    _queue_first(0),
+    _queue_count(0),
+    _terminate(false),
+    _stopped(false),
+    _error(SYS_SUCCESS),
+    _error_reported(false),
+    _stats()
+{
+    // Allocate all buffers, aligned for direct I/O.
+    for (auto& buf : _buffers) {
+        buf.storage.resize(_buffer_size + ALIGNMENT);
+        const size_t misalign = size_t(reinterpret_cast<uintptr_t>(buf.storage.data()) % ALIGNMENT);
+        buf.offset = misalign == 0 ? 0 : ALIGNMENT - misalign;
+    }
+
+    // Start the writer thread.
+    start();
+}
+
+ts::TSFileAsyncWriter::~TSFileAsyncWriter()
+{
+    stop(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Report a previous write error (application thread, mutex held).
+//----------------------------------------------------------------------------
+
+bool ts::TSFileAsyncWriter::reportError(Report& report)
+{
+    if (_error == SYS_SUCCESS) {
+        return true;
+    }
+    if (!_error_reported) {
+        _error_reported = true;
+#if !defined(TS_WINDOWS)
+        // Don't report error on broken pipe, same as synchronous mode.
+        if (_error == EPIPE) {
+            return false;
+        }
+#endif
+        report.error(u"error writing %s: %s (%d)", {_name, SysErrorCodeMessage(_error), _error});
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Queue data for write.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileAsyncWriter::write(const void* data, size_t size, Report& report)
+{
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(data);
+
+    while (size > 0) {
+        // Copy as much as possible in the buffer being filled.
+        Buffer& buf(_buffers[_fill]);
+        const size_t count = std::min(size, _buffer_size - buf.size);
+        ::memcpy(buf.data() + buf.size, src, count);
+        buf.size += count;
+        src += count;
+        size -= count;
+
+        // Queue the buffer when full.
+        if (buf.size == _buffer_size && !submit(report)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Queue the buffer being filled.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileAsyncWriter::submit(Report& report)
+{
+    const size_t depth = _buffers.size() - 1;
+
+    // Wait for a free buffer. There is always one buffer being filled.
+    GuardCondition lock(_mutex, _completed);
+    if (_queue_count >= depth && _error == SYS_SUCCESS && !_stopped) {
+        const Monotonic start(true);
+        while (_queue_count >= depth && _error == SYS_SUCCESS && !_stopped) {
+            lock.waitCondition();
+        }
+        const NanoSecond stall = Monotonic(true) - start;
+        _stats.stall_time += stall;
+        _stats.stalls++;
+    }
+    if (_error != SYS_SUCCESS || _stopped) {
+        return reportError(report);
+    }
+
+    // Queue the buffer and move to next one.
+    _queue_count++;
+    _stats.max_queued = std::max(_stats.max_queued, _queue_count);
+    _fill = (_fill + 1) % _buffers.size();
+    _buffers[_fill].size = 0;
+    _to_write.signal();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Write all pending data and terminate the writer thread.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileAsyncWriter::stop(Report& report)
+{
+    {
+        GuardMutex lock(_mutex);
+        if (_stopped) {
+            return reportError(report);
+        }
+    }
+
+    // Queue the last partially filled buffer.
+    bool ok = _buffers[_fill].size == 0 || submit(report);
+
+    // Request termination of the writer thread, after all queued buffers are written.
+    {
+        GuardCondition lock(_mutex, _to_write);
+        _terminate = true;
+        lock.signal();
+    }
+    waitForTermination();
+
+    GuardMutex lock(_mutex);
+    _stopped = true;
+    return reportError(report) && ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Write one buffer, in the context of the writer thread.
+//----------------------------------------------------------------------------
+
+ts::SysErrorCode ts::TSFileAsyncWriter::writeBuffer(const Buffer& buffer)
+{
+    const uint8_t* data = buffer.data();
+    size_t remain = buffer.size;
+
+#if defined(TS_WINDOWS)
+
+    ::DWORD outsize = 0;
+    while (remain > 0) {
+        if (::WriteFile(_handle, data, ::DWORD(remain), &outsize, NULL) == 0) {
+            return LastSysErrorCode();
+        }
+        outsize = std::min<::DWORD>(outsize, ::DWORD(remain));
+        data += outsize;
+        remain -= outsize;
+    }
+
+#else
+
+    // With direct I/O, the size of each write must be aligned. The last buffer is
+    // usually partially filled. Revert to buffered I/O for the last write.
+#if defined(O_DIRECT)
+    if (_direct_io && remain % ALIGNMENT != 0) {
+        const int flags = ::fcntl(_handle, F_GETFL);
+        if (flags != -1) {
+            ::fcntl(_handle, F_SETFL, flags & ~O_DIRECT);
+        }
+        _direct_io = false;
+    }
+#endif
+
+    while (remain > 0) {
+        const ssize_t outsize = ::write(_handle, data, remain);
+        if (outsize > 0) {
+            const size_t size = std::min<size_t>(size_t(outsize), remain);
+            data += size;
+            remain -= size;
+        }
+        else {
+            const SysErrorCode error_code = LastSysErrorCode();
+            if (error_code != EINTR) {
+                return error_code;
+            }
+        }
+    }
+
+#endif
+
+    return SYS_SUCCESS;
+}
+
+
+//----------------------------------------------------------------------------
+// Writer thread.
+//----------------------------------------------------------------------------
+
+void ts::TSFileAsyncWriter::main()
+{
+    for (;;) {
+        size_t index = 0;
+
+        // Wait for a buffer to write or termination.
+        {
+            GuardCondition lock(_mutex, _to_write);
+            while (_queue_count == 0 && !_terminate) {
+                lock.waitCondition();
+            }
+            if (_queue_count == 0) {
+                break; // terminated, nothing left to write
+            }
+            index = _queue_first;
+        }
+
+        // Write the buffer without holding the mutex.
+        const Monotonic start(true);
+        const SysErrorCode err = writeBuffer(_buffers[index]);
+        const NanoSecond duration = Monotonic(true) - start;
+
+        // Release the buffer.
+        GuardCondition lock(_mutex, _completed);
+        _stats.writes++;
+        _stats.bytes += _buffers[index].size;
+        _stats.write_time += duration;
+        _stats.max_write_time = std::max(_stats.max_write_time, duration);
+        _queue_first = (_queue_first + 1) % _buffers.size();
+        _queue_count--;
+        if (err != SYS_SUCCESS) {
+            _error = err;
+        }
+        lock.signal();
+        if (err != SYS_SUCCESS) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//!
+//!  @file
+//!  Asynchronous writer thread for TS files (internal).
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSFile.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsByteBlock.h"
+
+namespace ts {
+    //!
+    //! Asynchronous writer thread for TS files.
+    //! This class is internal to the TSDuck library and cannot be called by applications.
+    //!
+    //! The application thread copies the data in a buffer. When a buffer is full, it is
+    //! queued and written by the writer thread. The application thread waits only when
+    //! all buffers are queued, i.e. when the disk is slower than the stream for too long.
+    //!
+    class TSFileAsyncWriter: private Thread
+    {
+        TS_NOBUILD_NOCOPY(TSFileAsyncWriter);
+    public:
+        //!
+        //! Alignment of buffers and write sizes, suitable for direct I/O.
+        //!
+        static constexpr size_t ALIGNMENT = 4096;
+
+#if defined(TS_WINDOWS)
+        //!
+        //! System file handle type.
+        //!
+        typedef ::HANDLE FileHandle;
+#else
+        //!
+        //! System file handle type.
+        //!
+        typedef int FileHandle;
+#endif
+
+        //!
+        //! Constructor, start the writer thread.
+        //! @param [in] handle Handle of the open file.
+        //! @param [in] name File name, for error messages.
+        //! @param [in] depth Maximum number of buffers which are queued for write.
+        //! @param [in] buffer_size Size in bytes of each buffer. Rounded up to a multiple of ALIGNMENT.
+        //! @param [in] direct_io True if the file was open with direct I/O (O_DIRECT on Linux).
+        //!
+        TSFileAsyncWriter(FileHandle handle, const UString& name, size_t depth, size_t buffer_size, bool direct_io);
+
+        //!
+        //! Destructor. The pending data are written before returning.
+        //!
+        virtual ~TSFileAsyncWriter() override;
+
+        //!
+        //! Queue data for write.
+        //! @param [in] data Address of data to write.
+        //! @param [in] size Size in bytes of data to write.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false if a previous write failed.
+        //!
+        bool write(const void* data, size_t size, Report& report);
+
+        //!
+        //! Write all pending data and terminate the writer thread.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false if a write failed.
+        //!
+        bool stop(Report& report);
+
+        //!
+        //! Get the statistics of the asynchronous write operations.
+        //! Accurate after stop() only.
+        //! @return A constant reference to the statistics.
+        //!
+        const TSFile::AsyncStatistics& statistics() const { return _stats; }
+
+    private:
+        // A buffer, aligned for direct I/O.
+        struct Buffer
+        {
+            Buffer();
+            ByteBlock storage;  // Actual storage, larger than the aligned area.
+            size_t    offset;   // Offset of aligned data area in storage.
+            size_t    size;     // Number of bytes in buffer.
+            uint8_t* data() { return storage.data() + offset; }
+            const uint8_t* data() const { return storage.data() + offset; }
+        };
+
+        FileHandle          _handle;       // File handle.
+        const UString       _name;         // File name, for error messages.
+        const size_t        _buffer_size;  // Size of each buffer.
+        bool                _direct_io;    // File is open with direct I/O.
+        std::vector<Buffer> _buffers;      // Circular array of depth + 1 buffers.
+        size_t              _fill;         // Index of buffer being filled by the application.
+        Mutex               _mutex;        // Protect the fields below.
+        Condition           _to_write;     // Signaled when a buffer is queued or on termination.
+        Condition           _completed;    // Signaled when a buffer is written.
+        size_t              _queue_first;  // Index of first queued buffer.
+        size_t              _queue_count;  // Number of queued buffers.
+        bool                _terminate;    // Request to terminate the writer thread.
+        bool                _stopped;      // The writer thread is terminated.
+        SysErrorCode        _error;        // Write error code, SYS_SUCCESS if none.
+        bool                _error_reported; // The write error was already reported.
+        TSFile::AsyncStatistics _stats;    // Statistics.
+
+        // Queue the buffer being filled.
+        bool submit(Report& report);
+
+        // Report a previous write error.
+        bool reportError(Report& report);
+
+        // Write one buffer, in the context of the writer thread.
+        SysErrorCode writeBuffer(const Buffer& buffer);
+
+        // Implementation of Thread.
+        virtual void main() override;
+    };
+}
@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TS sync byte scanning using AVX2 instructions.
+//  With GCC and clang, this module is compiled with AVX2 code generation.
+//  With MSVC, the AVX2 intrinsics are always available.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSSyncAccel.h"
+
+#if defined(__AVX2__) || (defined(TS_MSC) && (defined(TS_X86_64) || defined(TS_I386)))
+
+#include <immintrin.h>
+
+namespace {
+
+    // Bit mask of the sync bytes in 32 consecutive bytes.
+    inline uint32_t SyncMask(const uint8_t* p, __m256i sync)
+    {
+        return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), sync)));
+    }
+
+    size_t Scan(const uint8_t* data, size_t positions, size_t stride, size_t syncs)
+    {
+        const __m256i sync = _mm256_set1_epi8(char(ts::syncaccel::SYNC));
+        size_t i = 0;
+
+        // Check 32 positions at a time. Stop checking the next packets as soon as no position remains.
+        for (; i + 32 <= positions; i += 32) {
+            const uint8_t* p = data + i;
+            uint32_t mask = SyncMask(p, sync);
+            for (size_t k = 1; mask != 0 && k < syncs; ++k) {
+                p += stride;
+                mask &= SyncMask(p, sync);
+            }
+            if (mask != 0) {
+                while ((mask & 1) == 0) {
+                    mask >>= 1;
+                    ++i;
+                }
+                return i;
+            }
+        }
+        return ts::syncaccel::ScanBytes(data, i, positions, stride, syncs);
+    }
+}
+
+const ts::syncaccel::ScanFunction ts::syncaccel::ScanAVX2 = Scan;
+
+#else
+
+// AVX2 is not supported by the compiler or the target CPU.
+const ts::syncaccel::ScanFunction ts::syncaccel::ScanAVX2 = nullptr;
+
+#endif
@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Vectorized implementations of the TS sync byte scanner (internal).
+//!
+//!  This header is included by the TS sync scanner module and its instruction
+//!  set specific variants. It shall not include other TSDuck headers than the
+//!  basic platform definitions: the variants are compiled with specific
+//!  instruction sets and all inline code from other headers would be
+//!  compiled with these instructions.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Internal implementation of vectorized TS sync byte scanning.
+    //! This namespace is internal to the TSDuck library and cannot be called by applications.
+    //!
+    namespace syncaccel {
+
+        //!
+        //! Value of the sync byte at start of TS packets (same as ts::SYNC_BYTE).
+        //!
+        constexpr uint8_t SYNC = 0x47;
+
+        //!
+        //! Profile of a function which looks for sequences of sync bytes at regular intervals.
+        //!
+        //! The function returns the lowest index @a i in the range 0 to @a positions - 1 such that
+        //! all bytes @a data[i + k * @a stride] are 0x47 for @a k in the range 0 to @a syncs - 1.
+        //! Several consecutive values of @a i are checked in parallel.
+        //!
+        //! @param [in] data Address of the data area.
+        //! @param [in] positions Number of candidate positions to check. The caller guarantees that
+        //! all bytes up to @a data[@a positions - 1 + (@a syncs - 1) * @a stride] can be read.
+        //! @param [in] stride Distance in bytes between two sync bytes (the packet size).
+        //! @param [in] syncs Number of consecutive sync bytes to check. Must not be zero.
+        //! @return The index of the first matching position or @a positions if there is none.
+        //!
+        typedef size_t (*ScanFunction)(const uint8_t* data, size_t positions, size_t stride, size_t syncs);
+
+        //!
+        //! Portable scanning of a few positions, one at a time.
+        //! Used by the vectorized functions for the last positions which do not fill a vector.
+        //! @param [in] data Address of the data area.
+        //! @param [in] first First position to check.
+        //! @param [in] positions Number of candidate positions. See ScanFunction.
+        //! @param [in] stride Distance in bytes between two sync bytes.
+        //! @param [in] syncs Number of consecutive sync bytes to check.
+        //! @return The index of the first matching position or @a positions if there is none.
+        //!
+        inline size_t ScanBytes(const uint8_t* data, size_t first, size_t positions, size_t stride, size_t syncs)
+        {
+            for (size_t i = first; i < positions; ++i) {
+                size_t k = 0;
+                while (k < syncs && data[i + k * stride] == SYNC) {
+                    ++k;
+                }
+                if (k == syncs) {
+                    return i;
+                }
+            }
+            return positions;
+        }
+
+        //!
+        //! Scanning using Intel SSE2 instructions, 16 positions at a time.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const ScanFunction ScanSSE2;
+
+        //!
+        //! Scanning using Intel AVX2 instructions, 32 positions at a time.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const ScanFunction ScanAVX2;
+
+        //!
+        //! Scanning using Arm Neon instructions, 16 positions at a time.
+        //! Null pointer if not supported by the compiler.
+        //!
+        extern const ScanFunction ScanNEON;
+    }
+}
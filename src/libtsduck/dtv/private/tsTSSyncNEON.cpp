@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TS sync byte scanning using Arm Neon instructions.
+//  Neon is part of the Armv8 architecture. On 32-bit Arm, this module is
+//  empty when the compiler does not generate Neon code.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSSyncAccel.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || (defined(TS_MSC) && defined(TS_ARM64))
+
+#include <arm_neon.h>
+
+namespace {
+
+    // Compress the result of a 16-byte comparison into a 64-bit mask, 4 bits per byte.
+    inline uint64_t Mask(uint8x16_t cmp)
+    {
+        return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+    }
+
+    size_t Scan(const uint8_t* data, size_t positions, size_t stride, size_t syncs)
+    {
+        const uint8x16_t sync = vdupq_n_u8(ts::syncaccel::SYNC);
+        size_t i = 0;
+
+        // Check 16 positions at a time. Stop checking the next packets as soon as no position remains.
+        for (; i + 16 <= positions; i += 16) {
+            const uint8_t* p = data + i;
+            uint8x16_t found = vceqq_u8(vld1q_u8(p), sync);
+            uint64_t mask = Mask(found);
+            for (size_t k = 1; mask != 0 && k < syncs; ++k) {
+                p += stride;
+                found = vandq_u8(found, vceqq_u8(vld1q_u8(p), sync));
+                mask = Mask(found);
+            }
+            if (mask != 0) {
+                while ((mask & 0x0F) == 0) {
+                    mask >>= 4;
+                    ++i;
+                }
+                return i;
+            }
+        }
+        return ts::syncaccel::ScanBytes(data, i, positions, stride, syncs);
+    }
+}
+
+const ts::syncaccel::ScanFunction ts::syncaccel::ScanNEON = Scan;
+
+#else
+
+// Neon is not supported by the compiler or the target CPU.
+const ts::syncaccel::ScanFunction ts::syncaccel::ScanNEON = nullptr;
+
+#endif
@@ -28,6 +28,19 @@
 //----------------------------------------------------------------------------
 
 #include "tsCRC32.h"
+#include "tsCRC32Accel.h"
+#include "tsMemory.h"
+
+#if (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_MSC)
+    #include <intrin.h>
+#elif (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_GCC)
+    #include <cpuid.h>
+#elif defined(TS_ARM64) && defined(TS_LINUX)
+    #include <sys/auxv.h>
+    #if !defined(HWCAP_PMULL)
+        #define HWCAP_PMULL (1 << 4)
+    #endif
+#endif
 
 
 // The FCS-32 generator polynomial:
@@ -104,13 +117,129 @@ namespace {
     };
 }
 
-// Continue the computation of a data area, following a previous CRC32
+namespace {
+
+    // Tables for the "slicing-by-8" algorithm: slice8[n][b] is the CRC32 of
+    // byte b followed by n zero bytes. Built once from fcstab_32 on first use.
+    struct Slice8Tables
+    {
+        uint32_t tab[8][256];
+        Slice8Tables();
+    };
+
+    Slice8Tables::Slice8Tables()
+    {
+        for (size_t b = 0; b < 256; ++b) {
+            tab[0][b] = fcstab_32[b];
+        }
+        for (size_t n = 1; n < 8; ++n) {
+            for (size_t b = 0; b < 256; ++b) {
+                const uint32_t prev = tab[n-1][b];
+                tab[n][b] = (prev << 8) ^ fcstab_32[prev >> 24];
+            }
+        }
+    }
+
+    const Slice8Tables& Slice8()
+    {
+        static const Slice8Tables tables;
+        return tables;
+    }
+
+    // Process bytes one by one.
+    uint32_t AddBytewise(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        while (size-- > 0) {
+            fcs = (fcs << 8) ^ fcstab_32[((fcs >> 24) ^ (*cp++)) & 0xFF];
+        }
+        return fcs;
+    }
+
+    // Process 8 bytes at a time.
+    uint32_t AddSlicing8(uint32_t fcs, const uint8_t* cp, size_t size)
+    {
+        const Slice8Tables& t(Slice8());
+        for (; size >= 8; cp += 8, size -= 8) {
+            const uint32_t hi = fcs ^ ts::GetUInt32(cp);
+            const uint32_t lo = ts::GetUInt32(cp + 4);
+            fcs = t.tab[7][hi >> 24] ^ t.tab[6][(hi >> 16) & 0xFF] ^ t.tab[5][(hi >> 8) & 0xFF] ^ t.tab[4][hi & 0xFF] ^
+                  t.tab[3][lo >> 24] ^ t.tab[2][(lo >> 16) & 0xFF] ^ t.tab[1][(lo >> 8) & 0xFF] ^ t.tab[0][lo & 0xFF];
+        }
+        return AddBytewise(fcs, cp, size);
+    }
+
+    // Check if the CPU supports carry-less multiplication instructions.
+    bool CPUHasCLMUL()
+    {
+#if (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_MSC)
+        int info[4];
+        ::__cpuid(info, 1);
+        return (info[2] & (1 << 1)) != 0 && (info[2] & (1 << 9)) != 0;
+#elif (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_GCC)
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        return ::__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_PCLMUL) != 0 && (ecx & bit_SSSE3) != 0;
+#elif defined(TS_ARM64) && defined(TS_LINUX)
+        return (::getauxval(AT_HWCAP) & HWCAP_PMULL) != 0;
+#elif defined(TS_ARM64) && defined(TS_MAC)
+        return true; // all Apple Arm processors
+#else
+        return false;
+#endif
+    }
+
+    // Hardware-accelerated folding function, null pointer if not supported on this CPU.
+    // The CPU features are checked only once.
+    ts::crc32accel::FoldFunction AccelFold()
+    {
+        static const ts::crc32accel::FoldFunction func =
+            !CPUHasCLMUL() ? nullptr : (ts::crc32accel::FoldPCLMUL != nullptr ? ts::crc32accel::FoldPCLMUL : ts::crc32accel::FoldPMULL);
+        return func;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a CRC32 engine is supported.
+//----------------------------------------------------------------------------
+
+bool ts::CRC32::IsEngineSupported(Engine engine)
+{
+    return engine != ENGINE_CLMUL || AccelFold() != nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Continue the computation of a data area, following a previous CRC32.
+//----------------------------------------------------------------------------
+
+void ts::CRC32::add(const void* data, size_t size)
+{
+    add(data, size, ENGINE_AUTO);
+}
 
-void ts::CRC32::add (const void* data, size_t size)
+void ts::CRC32::add(const void* data, size_t size, Engine engine)
 {
-    const uint8_t* cp = static_cast <const uint8_t*> (data);
+    const uint8_t* cp = static_cast<const uint8_t*>(data);
 
-    while (size-- > 0) {
-        _fcs = (_fcs << 8) ^ fcstab_32 [((_fcs >> 24) ^ (*cp++)) & 0xFF];
+    switch (engine) {
+        case ENGINE_BYTEWISE:
+            _fcs = AddBytewise(_fcs, cp, size);
+            break;
+        case ENGINE_AUTO:
+        case ENGINE_CLMUL: {
+            // Small areas (most sections) are faster with slicing-by-8.
+            const crc32accel::FoldFunction fold = AccelFold();
+            if (fold != nullptr && size >= crc32accel::MIN_FOLD_SIZE) {
+                uint8_t residue[16];
+                const size_t done = fold(_fcs, cp, size, residue);
+                _fcs = AddSlicing8(AddSlicing8(0, residue, sizeof(residue)), cp + done, size - done);
+                break;
+            }
+            TS_FALLTHROUGH
+        }
+        case ENGINE_SLICING8:
+        default:
+            _fcs = AddSlicing8(_fcs, cp, size);
+            break;
     }
 }
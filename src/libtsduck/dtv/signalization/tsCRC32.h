@@ -68,6 +68,34 @@ namespace ts {
         //!
         void add(const void* data, size_t size);
 
+        //!
+        //! Implementations of the CRC32 computation.
+        //! All engines produce the same result. They differ only in performance.
+        //!
+        enum Engine {
+            ENGINE_AUTO,      //!< Automatically select the fastest engine which is supported by the CPU.
+            ENGINE_BYTEWISE,  //!< Portable implementation, one byte at a time with one 256-entry table.
+            ENGINE_SLICING8,  //!< Portable implementation, 8 bytes at a time with eight 256-entry tables ("slicing-by-8").
+            ENGINE_CLMUL      //!< Carry-less multiplication (Intel PCLMULQDQ or Arm PMULL instructions) on large areas.
+        };
+
+        //!
+        //! Check if a CRC32 engine is supported on this platform and this CPU.
+        //! @param [in] engine The engine to check.
+        //! @return True if @a engine is supported. All engines except ENGINE_CLMUL are always supported.
+        //!
+        static bool IsEngineSupported(Engine engine);
+
+        //!
+        //! Continue the computation of a data area using a specific engine.
+        //! This is typically used to test or benchmark the engines.
+        //! Applications should use the two-parameter version which uses the fastest engine.
+        //! @param [in] data Address of area to analyze.
+        //! @param [in] size Size in bytes of area to analyze.
+        //! @param [in] engine The engine to use. If not supported on this CPU, ENGINE_AUTO is used.
+        //!
+        void add(const void* data, size_t size, Engine engine);
+
         //!
         //! Get the value of the CRC32 as computed so far.
         //! @return The value of the CRC32 as computed so far.
@@ -28,9 +28,24 @@
 //----------------------------------------------------------------------------
 
 #include "tsTSFile.h"
+#include "tsTSFileAsyncWriter.h"
 #include "tsTSPacketMetadata.h"
 #include "tsNullReport.h"
 #include "tsSysUtils.h"
+#include "tsSysInfo.h"
+
+#if !defined(TS_WINDOWS)
+    #include <sys/mman.h>
+#endif
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TSFile::DEFAULT_ASYNC_BUFFER_SIZE;
+#endif
+
+namespace {
+    // Size of the sliding window in memory-mapped input mode.
+    constexpr size_t MMAP_WINDOW_SIZE = 64 * 1024 * 1024;
+}
 
 
 //----------------------------------------------------------------------------
@@ -55,10 +70,22 @@ ts::TSFile::TSFile() :
     _rewindable(false),
     _regular(false),
     _std_inout(false),
+    _mmap_request(false),
+    _async_depth(0),
+    _async_buffer_size(DEFAULT_ASYNC_BUFFER_SIZE),
+    _direct_io(false),
+    _async(nullptr),
+    _async_stats(),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
-    _fd(-1)
+    _fd(-1),
+    _mmap_active(false),
+    _mmap_base(nullptr),
+    _mmap_size(0),
+    _mmap_offset(0),
+    _mmap_pos(0),
+    _file_size(0)
 #endif
 {
 }
@@ -86,10 +113,22 @@ ts::TSFile::TSFile(const TSFile& other) :
     _rewindable(false),
     _regular(false),
     _std_inout(other._std_inout),
+    _mmap_request(other._mmap_request),
+    _async_depth(other._async_depth),
+    _async_buffer_size(other._async_buffer_size),
+    _direct_io(other._direct_io),
+    _async(nullptr),
+    _async_stats(),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
-    _fd(-1)
+    _fd(-1),
+    _mmap_active(false),
+    _mmap_base(nullptr),
+    _mmap_size(0),
+    _mmap_offset(0),
+    _mmap_pos(0),
+    _file_size(0)
 #endif
 {
 }
@@ -117,18 +156,34 @@ ts::TSFile::TSFile(TSFile&& other) noexcept :
     _rewindable(other._rewindable),
     _regular(other._regular),
     _std_inout(other._std_inout),
+    _mmap_request(other._mmap_request),
+    _async_depth(other._async_depth),
+    _async_buffer_size(other._async_buffer_size),
+    _direct_io(other._direct_io),
+    _async(other._async),
+    _async_stats(other._async_stats),
 #if defined(TS_WINDOWS)
     _handle(other._handle)
 #else
-    _fd(other._fd)
+    _fd(other._fd),
+    _mmap_active(other._mmap_active),
+    _mmap_base(other._mmap_base),
+    _mmap_size(other._mmap_size),
+    _mmap_offset(other._mmap_offset),
+    _mmap_pos(other._mmap_pos),
+    _file_size(other._file_size)
 #endif
 {
     // Mark other object as closed, just in case.
     other._is_open = false;
+    other._async = nullptr;
 #if defined(TS_WINDOWS)
     other._handle = INVALID_HANDLE_VALUE;
 #else
     other._fd = -1;
+    other._mmap_active = false;
+    other._mmap_base = nullptr;
+    other._mmap_size = 0;
 #endif
 }
 
@@ -177,6 +232,40 @@ void ts::TSFile::setStuffing(size_t initial, size_t final)
 }
 
 
+//----------------------------------------------------------------------------
+// Set asynchronous write mode.
+//----------------------------------------------------------------------------
+
+void ts::TSFile::setAsyncWrite(size_t depth, size_t buffer_size, bool direct_io)
+{
+    _async_depth = depth;
+    _async_buffer_size = buffer_size;
+    _direct_io = direct_io;
+}
+
+ts::TSFile::AsyncStatistics::AsyncStatistics() :
+    bytes(0),
+    writes(0),
+    stalls(0),
+    max_queued(0),
+    write_time(0),
+    max_write_time(0),
+    stall_time(0)
+{
+}
+
+void ts::TSFile::AsyncStatistics::add(const AsyncStatistics& other)
+{
+    bytes += other.bytes;
+    writes += other.writes;
+    stalls += other.stalls;
+    max_queued = std::max(max_queued, other.max_queued);
+    write_time += other.write_time;
+    max_write_time = std::max(max_write_time, other.max_write_time);
+    stall_time += other.stall_time;
+}
+
+
 //----------------------------------------------------------------------------
 // Open file for read in a rewindable mode.
 //----------------------------------------------------------------------------
@@ -271,6 +360,7 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
     const bool read_only = (_flags & (READ | WRITE)) == READ;
     const bool keep_file = (_flags & KEEP) != 0;
     const bool temporary = (_flags & TEMPORARY) != 0;
+    const bool async_write = write_access && !read_access && _async_depth > 0;
 
     // Use standard input/output if file name is empty or a dash.
     _std_inout = _filename.empty() || _filename == u"-";
@@ -379,6 +469,7 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
 
     // Close first if this is a reopen.
     if (reopen) {
+        unmapWindow();
         ::close(_fd);
         _fd = -1;
     }
@@ -399,13 +490,31 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
         uflags |= O_EXCL;
     }
 
+    // Direct I/O is used in asynchronous write mode only, where all buffers are aligned.
+    bool direct_io = false;
+#if defined(O_DIRECT)
+    if (async_write && _direct_io && !_std_inout) {
+        uflags |= O_DIRECT;
+        direct_io = true;
+    }
+#endif
+
     if (_std_inout) {
         // File is standard input or output. No need to open.
         _fd = read_access ? STDIN_FILENO : STDOUT_FILENO;
     }
     else {
         // Open a named file.
-        if ((_fd = ::open(_filename.toUTF8().c_str(), uflags, mode)) < 0) {
+        _fd = ::open(_filename.toUTF8().c_str(), uflags, mode);
+#if defined(O_DIRECT)
+        if (_fd < 0 && direct_io && LastSysErrorCode() == EINVAL) {
+            // Direct I/O not supported by the file system, use buffered I/O.
+            report.debug(u"direct I/O not supported on %s", {getDisplayFileName()});
+            direct_io = false;
+            _fd = ::open(_filename.toUTF8().c_str(), uflags & ~O_DIRECT, mode);
+        }
+#endif
+        if (_fd < 0) {
             const SysErrorCode err = LastSysErrorCode();
             report.log(_severity, u"cannot open file %s: %s", {getDisplayFileName(), SysErrorCodeMessage(err)});
             return false;
@@ -444,6 +553,14 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
         return false;
     }
 
+#if defined(O_DIRECT)
+    // Direct I/O requires aligned file offsets. Revert to buffered I/O when appending to an unaligned file.
+    if (direct_io && (!_regular || (append_access && st.st_size % TSFileAsyncWriter::ALIGNMENT != 0))) {
+        ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) & ~O_DIRECT);
+        direct_io = false;
+    }
+#endif
+
     // If an initial offset is specified, move here
     if (_start_offset != 0 && ::lseek(_fd, off_t(_start_offset), SEEK_SET) == off_t(-1)) {
         const SysErrorCode err = LastSysErrorCode();
@@ -454,8 +571,28 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
         return false;
     }
 
+    // Use memory-mapped input on regular files which are open for read only.
+    // The memory-mapped window is created on first read.
+    _mmap_active = _mmap_request && read_only && _regular;
+    if (_mmap_active) {
+        _file_size = uint64_t(st.st_size);
+        _mmap_pos = _start_offset;
+        report.debug(u"using memory-mapped input on %s", {getDisplayFileName()});
+    }
+
 #endif
 
+    // Start the asynchronous writer thread.
+    if (async_write) {
+        assert(_async == nullptr);
+#if defined(TS_WINDOWS)
+        _async = new TSFileAsyncWriter(_handle, getDisplayFileName(), _async_depth, _async_buffer_size, false);
+#else
+        _async = new TSFileAsyncWriter(_fd, getDisplayFileName(), _async_depth, _async_buffer_size, direct_io);
+#endif
+        report.debug(u"asynchronous write on %s, %d buffers of %'d bytes%s", {getDisplayFileName(), _async_depth, _async_buffer_size, direct_io ? u", direct I/O" : u""});
+    }
+
     // Reset counters only if not a reopen.
     if (!reopen) {
         _total_read = _total_write = 0;
@@ -513,6 +650,15 @@ bool ts::TSFile::seekInternal(uint64_t index, Report& report)
 
     report.debug(u"seeking %s at offset %'d", {_filename, _start_offset + index});
 
+#if !defined(TS_WINDOWS)
+    // In memory-mapped mode, simply move the read position.
+    if (_mmap_active) {
+        _mmap_pos = _start_offset + index;
+        _at_eof = false;
+        return true;
+    }
+#endif
+
 #if defined(TS_WINDOWS)
     // In Win32, LARGE_INTEGER is a 64-bit structure, not an integer type
     uint64_t where = _start_offset + index;
@@ -546,12 +692,42 @@ bool ts::TSFile::seek(PacketCounter packet_index, Report& report)
         report.log(_severity, u"file %s is not rewindable", {getDisplayFileName()});
         return false;
     }
+    else if (_async != nullptr) {
+        report.log(_severity, u"cannot seek file %s in asynchronous write mode", {getDisplayFileName()});
+        return false;
+    }
     else {
         return seekInternal(packet_index * (packetHeaderSize() + PKT_SIZE), report);
     }
 }
 
 
+//----------------------------------------------------------------------------
+// Flush written data to the storage device.
+//----------------------------------------------------------------------------
+
+bool ts::TSFile::flush(Report& report)
+{
+    if (!_is_open) {
+        report.log(_severity, u"not open");
+        return false;
+    }
+    if (_std_inout || (_flags & WRITE) == 0) {
+        return true;
+    }
+#if defined(TS_WINDOWS)
+    if (::FlushFileBuffers(_handle) == 0) {
+#else
+    if (::fsync(_fd) < 0) {
+#endif
+        const SysErrorCode err = LastSysErrorCode();
+        report.log(_severity, u"error flushing %s: %s", {getDisplayFileName(), SysErrorCodeMessage(err)});
+        return false;
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Close file.
 //----------------------------------------------------------------------------
@@ -568,6 +744,15 @@ bool ts::TSFile::close(Report& report)
         writeStuffing(_close_null, report);
     }
 
+    // Flush and terminate the asynchronous writer.
+    bool success = true;
+    if (_async != nullptr) {
+        success = _async->stop(_aborted ? NULLREP : report);
+        _async_stats.add(_async->statistics());
+        delete _async;
+        _async = nullptr;
+    }
+
     if (!_std_inout) {
 #if defined(TS_WINDOWS)
         ::CloseHandle(_handle);
@@ -576,12 +761,17 @@ bool ts::TSFile::close(Report& report)
 #endif
     }
 
+#if !defined(TS_WINDOWS)
+    unmapWindow();
+    _mmap_active = false;
+#endif
+
     _is_open = _at_eof = _aborted = false;
     _flags = NONE;
     _filename.clear();
     _std_inout = false;
 
-    return true;
+    return success;
 }
 
 
@@ -635,6 +825,14 @@ bool ts::TSFile::readStreamPartial(void* buffer, size_t request_size, size_t& re
 
 #else
 
+    // Memory-mapped input mode. Fallback to regular read if the mapping fails.
+    if (_mmap_active) {
+        const bool ok = readMapped(buffer, request_size, read_size, report);
+        if (ok || _mmap_active) {
+            return ok;
+        }
+    }
+
     // UNIX implementation
     for (;;) {
         const ssize_t insize = ::read(_fd, buffer, request_size);
@@ -663,6 +861,86 @@ bool ts::TSFile::readStreamPartial(void* buffer, size_t request_size, size_t& re
 }
 
 
+//----------------------------------------------------------------------------
+// Memory-mapped input mode.
+//----------------------------------------------------------------------------
+
+bool ts::TSFile::isMemoryMapped() const
+{
+#if defined(TS_WINDOWS)
+    return false;
+#else
+    return _is_open && _mmap_active;
+#endif
+}
+
+#if !defined(TS_WINDOWS)
+
+void ts::TSFile::unmapWindow()
+{
+    if (_mmap_base != nullptr) {
+        ::munmap(_mmap_base, _mmap_size);
+        _mmap_base = nullptr;
+        _mmap_size = 0;
+    }
+}
+
+bool ts::TSFile::readMapped(void* buffer, size_t request_size, size_t& read_size, Report& report)
+{
+    // Move the memory-mapped window when the read position is outside.
+    if (_mmap_base == nullptr || _mmap_pos < _mmap_offset || _mmap_pos >= _mmap_offset + _mmap_size) {
+
+        unmapWindow();
+
+        // At end of file, check if the file has grown since the last check.
+        if (_mmap_pos >= _file_size) {
+            struct stat st;
+            if (::fstat(_fd, &st) == 0) {
+                _file_size = uint64_t(st.st_size);
+            }
+            if (_mmap_pos >= _file_size) {
+                _at_eof = true;
+                return false;
+            }
+        }
+
+        // The window must start on a page boundary.
+        const uint64_t page_size = SysInfo::Instance()->memoryPageSize();
+        _mmap_offset = _mmap_pos - _mmap_pos % page_size;
+        _mmap_size = size_t(std::min<uint64_t>(MMAP_WINDOW_SIZE, _file_size - _mmap_offset));
+
+        void* base = ::mmap(nullptr, _mmap_size, PROT_READ, MAP_SHARED, _fd, off_t(_mmap_offset));
+        if (base == MAP_FAILED) {
+            // Cannot map the file, switch to regular read at the same position.
+            const SysErrorCode err = LastSysErrorCode();
+            report.debug(u"cannot map %s, reverting to regular read: %s", {getDisplayFileName(), SysErrorCodeMessage(err)});
+            _mmap_size = 0;
+            if (::lseek(_fd, off_t(_mmap_pos), SEEK_SET) == off_t(-1)) {
+                const SysErrorCode serr = LastSysErrorCode();
+                report.error(u"error seeking input file %s: %s", {getDisplayFileName(), SysErrorCodeMessage(serr)});
+            }
+            else {
+                _mmap_active = false;
+            }
+            return false;
+        }
+        _mmap_base = reinterpret_cast<uint8_t*>(base);
+
+        // Advise the system that the window will be read sequentially, in full.
+        ::madvise(base, _mmap_size, MADV_SEQUENTIAL);
+        ::madvise(base, _mmap_size, MADV_WILLNEED);
+    }
+
+    // Copy directly from the system file cache into the caller's buffer.
+    read_size = size_t(std::min<uint64_t>(request_size, _mmap_offset + _mmap_size - _mmap_pos));
+    ::memcpy(buffer, _mmap_base + (_mmap_pos - _mmap_offset), read_size);
+    _mmap_pos += read_size;
+    return true;
+}
+
+#endif
+
+
 //----------------------------------------------------------------------------
 // Read TS packets. Return the actual number of read packets.
 // Override TSPacketStream implementation
@@ -733,6 +1011,15 @@ bool ts::TSFile::writeStream(const void* buffer, size_t data_size, size_t& writt
     written_size = 0;
     SysErrorCode error_code = SYS_SUCCESS;
 
+    // Asynchronous write mode: data are queued and written by the writer thread.
+    if (_async != nullptr) {
+        if (!_async->write(buffer, data_size, report)) {
+            return false;
+        }
+        written_size = data_size;
+        return true;
+    }
+
 #if defined(TS_WINDOWS)
 
     // Windows implementation
@@ -41,6 +41,7 @@
 namespace ts {
 
     class TSPacketMetadata;
+    class TSFileAsyncWriter;
 
     //!
     //! Transport stream file, input and/or output.
@@ -160,6 +161,15 @@ namespace ts {
         //!
         bool close(Report& report);
 
+        //!
+        //! Flush the written data to the storage device (@c fsync() on Unix systems).
+        //! With an asynchronous writer, only the data which were already written by the
+        //! writer thread are flushed.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool flush(Report& report);
+
         //!
         //! Set initial and final artificial stuffing.
         //! This method shall be called before opening the file.
@@ -178,6 +188,87 @@ namespace ts {
         //!
         void setStuffing(size_t initial, size_t final);
 
+        //!
+        //! Set memory-mapped input mode.
+        //! This method shall be called before opening the file.
+        //!
+        //! When set, a regular file which is open for read only is accessed through
+        //! a sliding memory-mapped window instead of read system calls. The data are
+        //! directly copied from the system file cache into the packet buffers of the
+        //! application, without system call per read operation. The system is advised
+        //! that the file is sequentially accessed and aggressive read-ahead is used.
+        //! This is more efficient on large capture files, specially when packets are
+        //! read one by one or when the packets have a header (M2TS or timestamped formats).
+        //!
+        //! The memory-mapped mode is silently ignored on non-regular files (pipes, devices, etc.),
+        //! on files which are opened for write, and on Windows. Note that truncating a file
+        //! while it is memory-mapped may result in a crash of the application.
+        //!
+        //! @param [in] mapped If true, use memory-mapped input mode when possible.
+        //!
+        void setMemoryMapped(bool mapped) { _mmap_request = mapped; }
+
+        //!
+        //! Check if the file is currently read in memory-mapped mode.
+        //! @return True if the file is currently open and read in memory-mapped mode.
+        //! @see setMemoryMapped()
+        //!
+        bool isMemoryMapped() const;
+
+        //!
+        //! Default size in bytes of each buffer in asynchronous write mode.
+        //!
+        static constexpr size_t DEFAULT_ASYNC_BUFFER_SIZE = 1024 * 1024;
+
+        //!
+        //! Set asynchronous write mode.
+        //! This method shall be called before opening the file.
+        //!
+        //! When set, a file which is open for write only is written by a separate thread.
+        //! The written packets are copied in large buffers. When a buffer is full, it is
+        //! queued and the application immediately continues. The application is blocked
+        //! only when @a depth buffers are already queued, meaning that the file system
+        //! is durably slower than the stream. This smoothes the latency spikes of the
+        //! storage, typically when recording a live stream on a loaded disk.
+        //!
+        //! Write errors are reported on the next write operation after the error or on close.
+        //! The last partially filled buffer is written on close only.
+        //!
+        //! @param [in] depth Maximum number of queued buffers. Zero means synchronous write (the default).
+        //! @param [in] buffer_size Size in bytes of each buffer. Rounded up to a multiple of 4096 bytes.
+        //! @param [in] direct_io If true, bypass the system file cache (O_DIRECT). Linux only. Silently
+        //! ignored when not supported by the file system, on non-regular files or in synchronous mode.
+        //!
+        void setAsyncWrite(size_t depth, size_t buffer_size = DEFAULT_ASYNC_BUFFER_SIZE, bool direct_io = false);
+
+        //!
+        //! Statistics of asynchronous write operations.
+        //!
+        struct TSDUCKDLL AsyncStatistics
+        {
+            AsyncStatistics();          //!< Constructor.
+            uint64_t   bytes;           //!< Total written bytes.
+            uint64_t   writes;          //!< Number of write operations.
+            uint64_t   stalls;          //!< Number of times the application waited for a free buffer.
+            size_t     max_queued;      //!< Maximum number of simultaneously queued buffers.
+            NanoSecond write_time;      //!< Total time in write operations.
+            NanoSecond max_write_time;  //!< Maximum time of one write operation.
+            NanoSecond stall_time;      //!< Total time the application waited for a free buffer.
+            //!
+            //! Accumulate the statistics of another instance.
+            //! @param [in] other Statistics to add.
+            //!
+            void add(const AsyncStatistics& other);
+        };
+
+        //!
+        //! Get the statistics of asynchronous write operations.
+        //! The statistics are accumulated over all files which were successively closed
+        //! with this object. The statistics of the currently open file are not included.
+        //! @return A constant reference to the statistics.
+        //!
+        const AsyncStatistics& asyncStatistics() const { return _async_stats; }
+
         //!
         //! Abort any currenly read/write operation in progress.
         //! The file is left in a broken state and can be only closed.
@@ -224,10 +315,22 @@ namespace ts {
         bool          _rewindable;       //!< Opened in rewindable mode
         bool          _regular;          //!< Is a regular file (ie. not a pipe or special device)
         bool          _std_inout;        //!< File is standard input or output.
+        bool          _mmap_request;     //!< Use memory-mapped input mode when possible.
+        size_t        _async_depth;      //!< Number of queued buffers in asynchronous write mode, zero if synchronous.
+        size_t        _async_buffer_size;//!< Size of each buffer in asynchronous write mode.
+        bool          _direct_io;        //!< Use direct I/O in asynchronous write mode.
+        TSFileAsyncWriter* _async;       //!< Asynchronous writer, null if synchronous.
+        AsyncStatistics _async_stats;    //!< Accumulated statistics of asynchronous write operations.
 #if defined(TS_WINDOWS)
         ::HANDLE      _handle;           //!< File handle
 #else
         int           _fd;               //!< File descriptor
+        bool          _mmap_active;      //!< Currently reading in memory-mapped mode.
+        uint8_t*      _mmap_base;        //!< Address of current memory-mapped window, null if none.
+        size_t        _mmap_size;        //!< Size in bytes of current memory-mapped window.
+        uint64_t      _mmap_offset;      //!< File offset of current memory-mapped window.
+        uint64_t      _mmap_pos;         //!< Current read position in file in memory-mapped mode.
+        uint64_t      _file_size;        //!< File size in memory-mapped mode.
 #endif
 
         // Implementation of AbstractReadStreamInterface
@@ -245,6 +348,10 @@ namespace ts {
         bool openInternal(bool reopen, Report& report);
         bool seekCheck(Report& report);
         bool seekInternal(uint64_t index, Report& report);
+#if !defined(TS_WINDOWS)
+        bool readMapped(void* addr, size_t max_size, size_t& ret_size, Report& report);
+        void unmapWindow();
+#endif
 
         // Inaccessible operations.
         TSFile& operator=(TSFile&) = delete;
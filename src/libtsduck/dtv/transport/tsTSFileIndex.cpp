@@ -0,0 +1,411 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileIndex.h"
+#include "tsTSFile.h"
+#include "tsBinaryTable.h"
+#include "tsTDT.h"
+#include "tsTOT.h"
+#include "tsFileUtils.h"
+#include "tsNullReport.h"
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::MilliSecond ts::TSFileIndex::DEFAULT_INTERVAL;
+#endif
+
+const ts::UChar* const ts::TSFileIndex::SIDECAR_SUFFIX = u".tsidx";
+
+namespace {
+    // Layout of the sidecar file. All integers are big endian.
+    // Header:  magic (4 bytes), version (1 byte), packet size (2 bytes), interval in ms (4 bytes),
+    //          TS file size (8 bytes), TS file modification time in ms (8 bytes), entry count (4 bytes).
+    // Entries: packet index, PCR, PTS, UTC time in ms (8 bytes each).
+    constexpr uint8_t SIDECAR_MAGIC[4] = {'T', 'S', 'I', 'X'};
+    constexpr uint8_t SIDECAR_VERSION = 1;
+    constexpr size_t  SIDECAR_HEADER_SIZE = 31;
+    constexpr size_t  SIDECAR_ENTRY_SIZE = 32;
+
+    // Number of packets to read at a time when building the index.
+    constexpr size_t BUILD_PACKETS = 1024;
+}
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::TSFileIndex::Entry::Entry(PacketCounter pkt) :
+    packet(pkt),
+    pcr(INVALID_PCR),
+    pts(INVALID_PTS),
+    utc(Time::Epoch)
+{
+}
+
+ts::TSFileIndex::TSFileIndex(MilliSecond interval) :
+    _interval(interval),
+    _packet_size(PKT_SIZE),
+    _file_size(0),
+    _file_time(Time::Epoch),
+    _entries(),
+    _pcr_runs(),
+    _utc_runs(),
+    _duck(),
+    _demux(_duck, this),
+    _packet(0),
+    _pcr_pid(PID_NULL),
+    _last_pcr(INVALID_PCR),
+    _tdt_pcr(INVALID_PCR),
+    _tdt_utc(Time::Epoch)
+{
+}
+
+ts::TSFileIndex::~TSFileIndex()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Clear the content of the index.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::clear()
+{
+    _packet_size = PKT_SIZE;
+    _file_size = 0;
+    _file_time = Time::Epoch;
+    _entries.clear();
+    _pcr_runs.clear();
+    _utc_runs.clear();
+    _demux.reset();
+    _demux.setPIDFilter(NoPID);
+    _packet = 0;
+    _pcr_pid = PID_NULL;
+    _last_pcr = INVALID_PCR;
+    _tdt_pcr = INVALID_PCR;
+    _tdt_utc = Time::Epoch;
+}
+
+
+//----------------------------------------------------------------------------
+// Build the index by reading a TS file.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::build(const UString& filename, Report& report, TSPacketFormat format)
+{
+    clear();
+    _demux.addPID(PID_TDT);
+
+    TSFile file;
+    if (!file.openRead(filename, 0, report, format)) {
+        return false;
+    }
+    _file_size = GetFileSize(filename);
+    _file_time = GetFileModificationTimeUTC(filename);
+
+    std::vector<TSPacket> buffer(BUILD_PACKETS);
+    size_t count = 0;
+    while ((count = file.readPackets(buffer.data(), nullptr, buffer.size(), report)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            feedPacket(buffer[i]);
+            _packet++;
+        }
+    }
+
+    // The packet format is known after reading the first packets.
+    _packet_size = file.packetHeaderSize() + PKT_SIZE + file.packetTrailerSize();
+    buildRuns();
+    report.debug(u"indexed %'d packets in %s, %'d entries, %d PCR runs", {_packet, filename, _entries.size(), _pcr_runs.size()});
+    return file.close(report);
+}
+
+
+//----------------------------------------------------------------------------
+// Process one packet while building the index.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::feedPacket(const TSPacket& pkt)
+{
+    const PID pid = pkt.getPID();
+
+    // The reference PID is the first PID with a PCR.
+    if (pkt.hasPCR() && (_pcr_pid == PID_NULL || pid == _pcr_pid)) {
+        _pcr_pid = pid;
+        _last_pcr = pkt.getPCR();
+    }
+
+    if (pid == _pcr_pid && _last_pcr != INVALID_PCR) {
+        const uint64_t interval = uint64_t(_interval) * (SYSTEM_CLOCK_FREQ / MilliSecPerSec);
+        const uint64_t since = _entries.empty() ? INVALID_PCR : DiffPCR(_entries.back().pcr, _last_pcr);
+        if (pkt.getPUSI() && pkt.getRandomAccessIndicator() && pkt.hasPTS()) {
+            // Start of a key frame on the reference PID.
+            if (since >= interval) {
+                addEntry(pkt.getPTS());
+            }
+        }
+        else if (pkt.hasPCR() && since >= 2 * interval) {
+            // No key frame for some time, use the PCR.
+            addEntry(INVALID_PTS);
+        }
+    }
+
+    // Collect TDT and TOT.
+    _demux.feedPacket(pkt);
+}
+
+
+//----------------------------------------------------------------------------
+// Add an entry at current packet.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::addEntry(uint64_t pts)
+{
+    _entries.emplace_back(_packet);
+    Entry& entry(_entries.back());
+    entry.pcr = _last_pcr;
+    entry.pts = pts;
+    entry.utc = timeAtPCR(_last_pcr);
+}
+
+
+//----------------------------------------------------------------------------
+// Estimated UTC time at a given PCR.
+//----------------------------------------------------------------------------
+
+ts::Time ts::TSFileIndex::timeAtPCR(uint64_t pcr) const
+{
+    if (_tdt_utc == Time::Epoch || _tdt_pcr == INVALID_PCR || pcr == INVALID_PCR) {
+        return Time::Epoch;
+    }
+    const uint64_t forward = DiffPCR(_tdt_pcr, pcr);
+    if (forward < PCR_SCALE / 2) {
+        return _tdt_utc + MilliSecond(forward / (SYSTEM_CLOCK_FREQ / MilliSecPerSec));
+    }
+    else {
+        return _tdt_utc - MilliSecond(DiffPCR(pcr, _tdt_pcr) / (SYSTEM_CLOCK_FREQ / MilliSecPerSec));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Invoked by the demux when a TDT or TOT is received.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::handleTable(SectionDemux&, const BinaryTable& table)
+{
+    Time utc;
+    if (table.tableId() == TID_TDT) {
+        const TDT tdt(_duck, table);
+        if (!tdt.isValid()) {
+            return;
+        }
+        utc = tdt.utc_time;
+    }
+    else if (table.tableId() == TID_TOT) {
+        const TOT tot(_duck, table);
+        if (!tot.isValid()) {
+            return;
+        }
+        utc = tot.utc_time;
+    }
+    else {
+        return;
+    }
+
+    // The TDT or TOT can be located only after the first PCR.
+    if (_last_pcr != INVALID_PCR) {
+        const bool first = _tdt_utc == Time::Epoch;
+        _tdt_utc = utc;
+        _tdt_pcr = _last_pcr;
+        if (first) {
+            // Estimate the time of the previous entries.
+            for (auto& entry : _entries) {
+                entry.utc = timeAtPCR(entry.pcr);
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Split the entries in monotonic runs.
+//----------------------------------------------------------------------------
+
+void ts::TSFileIndex::buildRuns()
+{
+    _pcr_runs.clear();
+    _utc_runs.clear();
+
+    for (size_t i = 0; i < _entries.size(); ++i) {
+        const Entry& e(_entries[i]);
+
+        // A decreasing PCR is either a wrap-up or a discontinuity.
+        if (_pcr_runs.empty() || e.pcr < _entries[i - 1].pcr) {
+            _pcr_runs.push_back(Run(i, i + 1));
+        }
+        else {
+            _pcr_runs.back().second = i + 1;
+        }
+
+        // Entries with unknown time are not part of any run.
+        if (e.utc != Time::Epoch) {
+            if (_utc_runs.empty() || _utc_runs.back().second != i || e.utc < _entries[i - 1].utc) {
+                _utc_runs.push_back(Run(i, i + 1));
+            }
+            else {
+                _utc_runs.back().second = i + 1;
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Find the entry where to start reading to reach a PCR or a time.
+// Use the first run which starts before the searched value, then search the
+// last entry before the value in the run.
+//----------------------------------------------------------------------------
+
+bool ts::TSFileIndex::findPCR(uint64_t pcr, Entry& entry) const
+{
+    for (const auto& run : _pcr_runs) {
+        if (_entries[run.first].pcr <= pcr) {
+            const auto next = std::upper_bound(_entries.begin() + std::ptrdiff_t(run.first), _entries.begin() + std::ptrdiff_t(run.second), pcr,
+                                               [](uint64_t value, const Entry& e) { return value < e.pcr; });
+            entry = *(next - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ts::TSFileIndex::findTime(const Time& utc, Entry& entry) const
+{
+    for (const auto& run : _utc_runs) {
+        if (_entries[run.first].utc <= utc) {
+            const auto next = std::upper_bound(_entries.begin() + std::ptrdiff_t(run.first), _entries.begin() + std::ptrdiff_t(run.second), utc,
+                                               [](const Time& value, const Entry& e) { return value < e.utc; });
+            entry = *(next - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Sidecar file management.
+//----------------------------------------------------------------------------
+
+ts::UString ts::TSFileIndex::SidecarFileName(const UString& filename)
+{
+    return filename + SIDECAR_SUFFIX;
+}
+
+bool ts::TSFileIndex::matchFile(const UString& filename) const
+{
+    // Compare modification times with a one millisecond precision, as stored in sidecar files.
+    return GetFileSize(filename) == _file_size && GetFileModificationTimeUTC(filename) - _file_time == 0;
+}
+
+bool ts::TSFileIndex::save(const UString& filename, Report& report) const
+{
+    ByteBlock data;
+    data.reserve(SIDECAR_HEADER_SIZE + _entries.size() * SIDECAR_ENTRY_SIZE);
+    data.append(SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC));
+    data.appendUInt8(SIDECAR_VERSION);
+    data.appendUInt16(uint16_t(_packet_size));
+    data.appendUInt32(uint32_t(_interval));
+    data.appendUInt64(uint64_t(_file_size));
+    data.appendUInt64(uint64_t(_file_time - Time::Epoch));
+    data.appendUInt32(uint32_t(_entries.size()));
+    for (const auto& e : _entries) {
+        data.appendUInt64(e.packet);
+        data.appendUInt64(e.pcr);
+        data.appendUInt64(e.pts);
+        data.appendUInt64(uint64_t(e.utc - Time::Epoch));
+    }
+    return data.saveToFile(filename, &report);
+}
+
+bool ts::TSFileIndex::load(const UString& filename, Report& report)
+{
+    clear();
+
+    ByteBlock data;
+    if (!data.loadFromFile(filename, std::numeric_limits<size_t>::max(), &report)) {
+        return false;
+    }
+    if (data.size() < SIDECAR_HEADER_SIZE || ::memcmp(data.data(), SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC)) != 0 || data[4] != SIDECAR_VERSION) {
+        report.error(u"%s is not a valid TS index file", {filename});
+        return false;
+    }
+    const size_t count = GetUInt32(data.data() + 27);
+    if (data.size() != SIDECAR_HEADER_SIZE + count * SIDECAR_ENTRY_SIZE) {
+        report.error(u"invalid size of TS index file %s", {filename});
+        return false;
+    }
+
+    _packet_size = GetUInt16(data.data() + 5);
+    _interval = MilliSecond(GetUInt32(data.data() + 7));
+    _file_size = GetInt64(data.data() + 11);
+    _file_time = Time::Epoch + MilliSecond(GetInt64(data.data() + 19));
+    _entries.resize(count);
+    const uint8_t* p = data.data() + SIDECAR_HEADER_SIZE;
+    for (auto& e : _entries) {
+        e.packet = GetUInt64(p);
+        e.pcr = GetUInt64(p + 8);
+        e.pts = GetUInt64(p + 16);
+        e.utc = Time::Epoch + MilliSecond(GetInt64(p + 24));
+        p += SIDECAR_ENTRY_SIZE;
+    }
+    buildRuns();
+    return true;
+}
+
+bool ts::TSFileIndex::loadOrBuild(const UString& filename, Report& report, TSPacketFormat format)
+{
+    const UString sidecar(SidecarFileName(filename));
+
+    // Use the existing sidecar file if it matches the TS file.
+    if (FileExists(sidecar) && load(sidecar, NULLREP) && matchFile(filename)) {
+        report.debug(u"using TS index file %s", {sidecar});
+        return true;
+    }
+
+    // Build the index and try to save it.
+    report.verbose(u"building index of %s", {filename});
+    if (!build(filename, report, format)) {
+        return false;
+    }
+    if (!save(sidecar, NULLREP)) {
+        report.verbose(u"cannot save TS index file %s", {sidecar});
+    }
+    return true;
+}
@@ -0,0 +1,240 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Index of a transport stream file, for random access by time.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacketFormat.h"
+#include "tsSectionDemux.h"
+#include "tsTableHandlerInterface.h"
+#include "tsDuckContext.h"
+#include "tsTime.h"
+#include "tsReport.h"
+
+namespace ts {
+    //!
+    //! Index of a transport stream file, for random access by time.
+    //! @ingroup mpeg
+    //!
+    //! The index is a sparse list of entries, each entry containing the index of a TS packet
+    //! in the file, the PCR at this point, the PTS of the key frame which starts in this packet,
+    //! if any, and the estimated UTC time, based on the TDT or TOT and the PCR.
+    //!
+    //! The reference PID is the first PID carrying PCR's. An entry is preferably created on
+    //! a key frame (a packet with the random access indicator and a PTS) on the reference PID,
+    //! at least one interval after the previous entry. When the reference PID contains no key
+    //! frame indication, an entry is created on a PCR after two intervals.
+    //!
+    //! The index can be saved in a sidecar file, next to the TS file. The sidecar file
+    //! records the size and the modification time of the TS file so that an index is
+    //! rebuilt when the TS file is modified.
+    //!
+    class TSDUCKDLL TSFileIndex : private TableHandlerInterface
+    {
+        TS_NOCOPY(TSFileIndex);
+    public:
+        //!
+        //! Default interval between two index entries in milliseconds.
+        //!
+        static constexpr MilliSecond DEFAULT_INTERVAL = 1000;
+
+        //!
+        //! Default suffix of sidecar index files, added to the TS file name.
+        //!
+        static const UChar* const SIDECAR_SUFFIX;
+
+        //!
+        //! One entry in the index.
+        //!
+        class TSDUCKDLL Entry
+        {
+        public:
+            PacketCounter packet;  //!< Index of the TS packet in the file.
+            uint64_t      pcr;     //!< PCR on the reference PID at this packet, INVALID_PCR if unknown.
+            uint64_t      pts;     //!< PTS of the key frame starting in this packet, INVALID_PTS if not a key frame.
+            Time          utc;     //!< Estimated UTC time of this packet, Time::Epoch if unknown.
+
+            //!
+            //! Constructor.
+            //! @param [in] pkt Index of the TS packet in the file.
+            //!
+            Entry(PacketCounter pkt = 0);
+
+            //!
+            //! Check if the entry is on a key frame.
+            //! @return True if the entry is on a key frame.
+            //!
+            bool isKeyFrame() const { return pts != INVALID_PTS; }
+        };
+
+        //!
+        //! Constructor.
+        //! @param [in] interval Minimum interval between two index entries in milliseconds.
+        //!
+        TSFileIndex(MilliSecond interval = DEFAULT_INTERVAL);
+
+        //!
+        //! Destructor.
+        //!
+        virtual ~TSFileIndex() override;
+
+        //!
+        //! Clear the content of the index.
+        //!
+        void clear();
+
+        //!
+        //! Build the index by reading a TS file.
+        //! @param [in] filename Name of the TS file.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in] format Format of the TS file.
+        //! @return True on success, false on error.
+        //!
+        bool build(const UString& filename, Report& report, TSPacketFormat format = TSPacketFormat::AUTODETECT);
+
+        //!
+        //! Load the index from a sidecar file.
+        //! @param [in] filename Name of the sidecar index file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool load(const UString& filename, Report& report);
+
+        //!
+        //! Save the index in a sidecar file.
+        //! @param [in] filename Name of the sidecar index file.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool save(const UString& filename, Report& report) const;
+
+        //!
+        //! Load the index of a TS file from its sidecar file or build it.
+        //! If the sidecar file does not exist or does not match the TS file, the index is
+        //! built by reading the TS file and saved in the sidecar file for subsequent usages.
+        //! Failing to save the sidecar file is not an error.
+        //! @param [in] filename Name of the TS file.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in] format Format of the TS file.
+        //! @return True on success, false on error.
+        //!
+        bool loadOrBuild(const UString& filename, Report& report, TSPacketFormat format = TSPacketFormat::AUTODETECT);
+
+        //!
+        //! Get the name of the sidecar index file of a TS file.
+        //! @param [in] filename Name of the TS file.
+        //! @return Name of the sidecar index file.
+        //!
+        static UString SidecarFileName(const UString& filename);
+
+        //!
+        //! Check if the index matches the current state of a TS file.
+        //! @param [in] filename Name of the TS file.
+        //! @return True if the index was built from this file and the file was not modified since.
+        //!
+        bool matchFile(const UString& filename) const;
+
+        //!
+        //! Get the list of entries in the index.
+        //! @return A constant reference to the list of entries, in increasing packet order.
+        //!
+        const std::vector<Entry>& entries() const { return _entries; }
+
+        //!
+        //! Get the size in bytes of each packet in the TS file, including header and trailer.
+        //! @return The size in bytes of each packet in the TS file.
+        //!
+        size_t packetSize() const { return _packet_size; }
+
+        //!
+        //! Get the byte offset of an entry in the TS file.
+        //! @param [in] entry An index entry.
+        //! @return The byte offset of the packet of @a entry in the TS file.
+        //!
+        uint64_t byteOffset(const Entry& entry) const { return entry.packet * _packet_size; }
+
+        //!
+        //! Find the entry where to start reading in order to reach a given PCR.
+        //! In case of PCR wrap-up or discontinuity in the file, the first occurrence is used.
+        //! @param [in] pcr The PCR value to reach.
+        //! @param [out] entry The last entry before the first packet with a PCR greater than @a pcr.
+        //! @return True if found, false if @a pcr is before the start of the file or not in the index.
+        //!
+        bool findPCR(uint64_t pcr, Entry& entry) const;
+
+        //!
+        //! Find the entry where to start reading in order to reach a given UTC time.
+        //! In case of time discontinuity in the file, the first occurrence is used.
+        //! @param [in] utc The UTC time to reach, as broadcast in the TDT or TOT.
+        //! @param [out] entry The last entry before the first packet with a time greater than @a utc.
+        //! @return True if found, false if @a utc is before the start of the file or not in the index.
+        //!
+        bool findTime(const Time& utc, Entry& entry) const;
+
+    private:
+        MilliSecond        _interval;       // Minimum interval between entries.
+        size_t             _packet_size;    // Size of packets in the TS file.
+        int64_t            _file_size;      // Size of the TS file.
+        Time               _file_time;      // Last modification time of the TS file.
+        std::vector<Entry> _entries;        // Index entries.
+
+        // Runs of entries with increasing PCR or UTC time, as [first, last) indexes in _entries.
+        // The lookups use a binary search inside a run.
+        typedef std::pair<size_t, size_t> Run;
+        std::vector<Run>   _pcr_runs;       // A new run starts at each PCR wrap-up or discontinuity.
+        std::vector<Run>   _utc_runs;       // Same for UTC time, entries with unknown time are excluded.
+
+        // Working data while building the index.
+        DuckContext        _duck;
+        SectionDemux       _demux;
+        PacketCounter      _packet;         // Current packet index.
+        PID                _pcr_pid;        // Reference PID.
+        uint64_t           _last_pcr;       // Last PCR on reference PID.
+        uint64_t           _tdt_pcr;        // Last PCR at last TDT or TOT.
+        Time               _tdt_utc;        // Last UTC time in TDT or TOT.
+
+        // Process one packet while building the index.
+        void feedPacket(const TSPacket& pkt);
+
+        // Add an entry at current packet.
+        void addEntry(uint64_t pts);
+
+        // Estimated UTC time at a given PCR.
+        Time timeAtPCR(uint64_t pcr) const;
+
+        // Split the entries in monotonic runs, after building or loading the index.
+        void buildRuns();
+
+        // Implementation of TableHandlerInterface.
+        virtual void handleTable(SectionDemux&, const BinaryTable&) override;
+    };
+}
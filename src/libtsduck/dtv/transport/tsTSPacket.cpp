@@ -28,6 +28,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsTSPacket.h"
+#include "tsTSSyncScanner.h"
 #include "tsPES.h"
 #include "tsNames.h"
 #include "tsByteBlock.h"
@@ -947,23 +948,20 @@ bool ts::TSPacket::Locate(const uint8_t* buffer, size_t buffer_size, size_t& sta
     }
 
     // No TS packet found using the first method. Restart from the beginning of the message.
-    const uint8_t* const max = buffer_end - PKT_SIZE; // max address for a TS packet
-    for (p = buffer; p <= max; p++) {
-        if (*p == SYNC_BYTE) {
-            // Found something that could be the start of a TS packet.
-            // Verify that we get a 0x47 sync byte every 188 bytes up
-            // to the end of message (not leaving more than one truncated
-            // TS packet at the end of the message).
-            const uint8_t* end;
-            for (end = p; end <= max && *end == SYNC_BYTE; end += PKT_SIZE) {}
-            if (end > max) {
-                // End is after the start of the last possible packet.
-                // So, there are less than 188 bytes left in buffer after last packet.
-                // Consider that we have found a valid suite of packets.
-                start_index = p - buffer;
-                packet_count = (end - p) / PKT_SIZE;
-                return true;
-            }
+    // Look for the first suite of TS packets which extends up to the end of message (not
+    // leaving more than one truncated TS packet at the end of the message). The positions
+    // with N complete packets up to the end of message are 188 consecutive positions,
+    // they are searched in increasing order, with decreasing N.
+    TSSyncScanner scanner(TSSyncScanner::FormatVector{TSSyncScanner::Format(PKT_SIZE, 0)});
+    size_t offset = 0;
+    size_t format = 0;
+    for (size_t count = buffer_size / PKT_SIZE; count > 0; --count) {
+        const size_t low = buffer_size < (count + 1) * PKT_SIZE ? 0 : buffer_size - (count + 1) * PKT_SIZE + 1;
+        scanner.setMinimum(count);
+        if (scanner.find(buffer + low, buffer_size - low, offset, format)) {
+            start_index = low + offset;
+            packet_count = count;
+            return true;
         }
     }
 
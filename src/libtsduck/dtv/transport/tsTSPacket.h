@@ -35,6 +35,7 @@
 #pragma once
 #include "tsTS.h"
 #include "tsMemory.h"
+#include "tsMemoryPool.h"
 #include "tsCerrReport.h"
 #include "tsException.h"
 #include "tsResidentBuffer.h"
@@ -72,6 +73,21 @@ namespace ts {
         //!
         TSPacket() = default;
 
+        //!
+        //! Allocate a TS packet in the memory pool instead of the heap.
+        //! The packet remains an aggregate, it cannot derive from ts::PoolAllocated.
+        //! @param [in] size Size in bytes of the packet.
+        //! @return Address of the packet.
+        //!
+        static void* operator new(size_t size) { return MemoryPool::Allocate(size); }
+
+        //!
+        //! Deallocate a TS packet from the memory pool.
+        //! @param [in] ptr Address of the packet.
+        //! @param [in] size Size in bytes of the packet.
+        //!
+        static void operator delete(void* ptr, size_t size) { MemoryPool::Deallocate(ptr, size); }
+
         //!
         //! Copy constructor.
         //! @param [in] p Other packet to copy.
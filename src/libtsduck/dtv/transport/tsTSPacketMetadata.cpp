@@ -49,7 +49,9 @@ ts::TSPacketMetadata::TSPacketMetadata() :
     _flush(false),
     _bitrate_changed(false),
     _input_stuffing(false),
-    _nullified(false)
+    _nullified(false),
+    _drop_requested(false),
+    _null_requested(false)
 {
 }
 
@@ -66,6 +68,8 @@ void ts::TSPacketMetadata::reset()
     _bitrate_changed = false;
     _input_stuffing = false;
     _nullified = false;
+    _drop_requested = false;
+    _null_requested = false;
 }
 
 
@@ -220,6 +224,8 @@ bool ts::TSPacketMetadata::deserialize(const void* bin, size_t size)
     _bitrate_changed = false;
     _input_stuffing = size > 13 && (data[13] & 0x80) != 0;
     _nullified = size > 13 && (data[13] & 0x40) != 0;
+    _drop_requested = false;
+    _null_requested = false;
     _time_source = static_cast<TimeSource>(data[13] & 0x0F);
 
     return size >= 14;
@@ -148,6 +148,36 @@ namespace ts {
         //!
         bool getBitrateChanged() const { return _bitrate_changed; }
 
+        //!
+        //! Request to drop the packet.
+        //! This is used by packet processing plugins which process packets by batches.
+        //! This is the equivalent of returning TSP_DROP from the plugin's processPacket().
+        //! @param [in] on When true, the packet shall be dropped by tsp after processing the batch.
+        //! @see ProcessorPlugin::processPackets()
+        //!
+        void setDropRequested(bool on) { _drop_requested = on; }
+
+        //!
+        //! Check if the packet shall be dropped at the end of the processing of a batch of packets.
+        //! @return True when the packet shall be dropped.
+        //!
+        bool getDropRequested() const { return _drop_requested; }
+
+        //!
+        //! Request to replace the packet with a null packet.
+        //! This is used by packet processing plugins which process packets by batches.
+        //! This is the equivalent of returning TSP_NULL from the plugin's processPacket().
+        //! @param [in] on When true, the packet shall be replaced with a null packet by tsp after processing the batch.
+        //! @see ProcessorPlugin::processPackets()
+        //!
+        void setNullRequested(bool on) { _null_requested = on; }
+
+        //!
+        //! Check if the packet shall be replaced with a null packet at the end of the processing of a batch of packets.
+        //! @return True when the packet shall be nullified.
+        //!
+        bool getNullRequested() const { return _null_requested; }
+
         //!
         //! Check if the TS packet has a specific label set.
         //! @param [in] label The label to check.
@@ -334,6 +364,8 @@ namespace ts {
         bool       _bitrate_changed;  // Call getBitrate() callback as soon as possible.
         bool       _input_stuffing;   // Packet was artificially inserted as input stuffing.
         bool       _nullified;        // Packet was explicitly turned into a null packet by a plugin.
+        bool       _drop_requested;   // Drop the packet after a batch processing (transient, not serialized).
+        bool       _null_requested;   // Nullify the packet after a batch processing (transient, not serialized).
     };
 
     // Restore default packing after TSPacketMetadata.
@@ -0,0 +1,292 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSSyncScanner.h"
+#include "tsTSSyncAccel.h"
+#include "tsMemory.h"
+
+#if defined(TS_MSC) && (defined(TS_X86_64) || defined(TS_I386))
+#include <intrin.h>
+#endif
+
+// Number of sync bytes which are checked in parallel for several positions.
+// The candidate positions are then confirmed one by one for all required packets.
+#define PREFILTER_SYNCS 4
+
+
+//----------------------------------------------------------------------------
+// Portable engine and selection of the engines.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Check if the CPU supports SSE2 instructions.
+    bool CPUHasSSE2()
+    {
+#if defined(TS_X86_64)
+        return true; // part of the x86-64 architecture
+#elif defined(TS_I386) && defined(TS_MSC)
+        int info[4];
+        ::__cpuid(info, 1);
+        return (info[3] & (1 << 26)) != 0;
+#elif defined(TS_I386) && defined(TS_GCC)
+        return __builtin_cpu_supports("sse2");
+#else
+        return false;
+#endif
+    }
+
+    // Check if the CPU and the operating system support AVX2 instructions.
+    bool CPUHasAVX2()
+    {
+#if (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_MSC)
+        int info[4];
+        ::__cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        // Need OSXSAVE and AVX, the operating system shall save the YMM registers.
+        ::__cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (::_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+        ::__cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif (defined(TS_X86_64) || defined(TS_I386)) && defined(TS_GCC)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+
+    // Portable engine: check 8 positions at a time in 64-bit integers.
+    // The bytes of "diff" are zero for positions where all sync bytes are present.
+    size_t ScanPortable(const uint8_t* data, size_t positions, size_t stride, size_t syncs)
+    {
+        constexpr uint64_t sync8 = 0x0101010101010101 * ts::SYNC_BYTE;
+        constexpr uint64_t low7 = 0x7F7F7F7F7F7F7F7F;
+        size_t i = 0;
+
+        for (; i + 8 <= positions; i += 8) {
+            const uint8_t* p = data + i;
+            uint64_t diff = ts::GetUInt64LE(p) ^ sync8;
+            // Exactly one 0x80 bit in each zero byte of diff.
+            uint64_t zero = ~(((diff & low7) + low7) | diff | low7);
+            for (size_t k = 1; zero != 0 && k < syncs; ++k) {
+                p += stride;
+                diff |= ts::GetUInt64LE(p) ^ sync8;
+                zero = ~(((diff & low7) + low7) | diff | low7);
+            }
+            if (zero != 0) {
+                while ((zero & 0xFF) == 0) {
+                    zero >>= 8;
+                    ++i;
+                }
+                return i;
+            }
+        }
+        return ts::syncaccel::ScanBytes(data, i, positions, stride, syncs);
+    }
+
+    // Get the scan function for an engine, the fastest one if the engine is not supported.
+    // The CPU features are checked only once.
+    ts::syncaccel::ScanFunction ScanFunction(ts::TSSyncScanner::Engine engine)
+    {
+        static const ts::syncaccel::ScanFunction sse2 = CPUHasSSE2() ? ts::syncaccel::ScanSSE2 : nullptr;
+        static const ts::syncaccel::ScanFunction avx2 = CPUHasAVX2() ? ts::syncaccel::ScanAVX2 : nullptr;
+        static const ts::syncaccel::ScanFunction neon = ts::syncaccel::ScanNEON;
+
+        switch (engine) {
+            case ts::TSSyncScanner::ENGINE_PORTABLE:
+                return ScanPortable;
+            case ts::TSSyncScanner::ENGINE_SSE2:
+                if (sse2 != nullptr) {
+                    return sse2;
+                }
+                break;
+            case ts::TSSyncScanner::ENGINE_AVX2:
+                if (avx2 != nullptr) {
+                    return avx2;
+                }
+                break;
+            case ts::TSSyncScanner::ENGINE_NEON:
+                if (neon != nullptr) {
+                    return neon;
+                }
+                break;
+            case ts::TSSyncScanner::ENGINE_AUTO:
+            default:
+                break;
+        }
+        return avx2 != nullptr ? avx2 : (sse2 != nullptr ? sse2 : (neon != nullptr ? neon : ScanPortable));
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a scanner engine is supported.
+//----------------------------------------------------------------------------
+
+bool ts::TSSyncScanner::IsEngineSupported(Engine engine)
+{
+    switch (engine) {
+        case ENGINE_AUTO:
+        case ENGINE_PORTABLE:
+            return true;
+        case ENGINE_SSE2:
+            return ScanFunction(engine) == syncaccel::ScanSSE2;
+        case ENGINE_AVX2:
+            return ScanFunction(engine) == syncaccel::ScanAVX2;
+        case ENGINE_NEON:
+            return ScanFunction(engine) == syncaccel::ScanNEON;
+        default:
+            return false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Standard formats of TS files.
+//----------------------------------------------------------------------------
+
+const ts::TSSyncScanner::FormatVector& ts::TSSyncScanner::StandardFormats()
+{
+    static const FormatVector formats {
+        Format(PKT_SIZE, 0),                   // Plain TS packets.
+        Format(PKT_RS_SIZE, 0),                // Trailing 16-byte Reed-Solomon outer FEC.
+        Format(PKT_M2TS_SIZE, M2TS_HEADER_SIZE) // Leading 4-byte timestamp (M2TS format, blu-ray discs).
+    };
+    return formats;
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor and settings.
+//----------------------------------------------------------------------------
+
+ts::TSSyncScanner::TSSyncScanner(const FormatVector& formats, Engine engine) :
+    _formats(),
+    _engine(ENGINE_AUTO),
+    _min_packets(5),
+    _min_bytes(0)
+{
+    setFormats(formats);
+    setEngine(engine);
+}
+
+void ts::TSSyncScanner::setFormats(const FormatVector& formats)
+{
+    _formats.clear();
+    for (const auto& fmt : formats) {
+        if (fmt.packet_size >= PKT_SIZE && fmt.header_size <= fmt.packet_size - PKT_SIZE) {
+            _formats.push_back(fmt);
+        }
+    }
+}
+
+void ts::TSSyncScanner::setEngine(Engine engine)
+{
+    _engine = IsEngineSupported(engine) ? engine : ENGINE_AUTO;
+}
+
+void ts::TSSyncScanner::setMinimum(size_t packets, size_t bytes)
+{
+    _min_packets = packets;
+    _min_bytes = bytes;
+}
+
+
+//----------------------------------------------------------------------------
+// Find the first sequence of packets in a buffer.
+//----------------------------------------------------------------------------
+
+bool ts::TSSyncScanner::find(const uint8_t* data, size_t size, size_t& offset, size_t& format) const
+{
+    const syncaccel::ScanFunction scan = ScanFunction(_engine);
+    size_t best = NPOS;
+
+    // Each format is searched before the best position which was found with the previous formats.
+    for (size_t index = 0; index < _formats.size(); ++index) {
+
+        const Format& fmt(_formats[index]);
+        const size_t count = std::max<size_t>(1, std::max(_min_packets, _min_bytes / fmt.packet_size));
+        if (data == nullptr || count > size / fmt.packet_size) {
+            continue; // not enough data for this format
+        }
+
+        // The complete sequence of packets must fit in the buffer.
+        const size_t positions = std::min(best, size - count * fmt.packet_size + 1);
+        const size_t syncs = std::min<size_t>(count, PREFILTER_SYNCS);
+        const uint8_t* const sync = data + fmt.header_size;
+
+        // Look for candidate positions with a few sync bytes, then confirm all packets.
+        size_t pos = 0;
+        while (pos < positions) {
+            pos += scan(sync + pos, positions - pos, fmt.packet_size, syncs);
+            if (pos >= positions) {
+                break;
+            }
+            size_t k = syncs;
+            while (k < count && sync[pos + k * fmt.packet_size] == SYNC_BYTE) {
+                ++k;
+            }
+            if (k == count) {
+                best = pos;
+                format = index;
+                break;
+            }
+            ++pos;
+        }
+    }
+
+    if (best == NPOS) {
+        return false;
+    }
+    else {
+        offset = best;
+        return true;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Count the number of consecutive packets at the start of a buffer.
+//----------------------------------------------------------------------------
+
+size_t ts::TSSyncScanner::CountPackets(const uint8_t* data, size_t size, const Format& format)
+{
+    size_t count = 0;
+    if (data != nullptr && format.packet_size > format.header_size) {
+        const size_t max = size / format.packet_size;
+        while (count < max && data[count * format.packet_size + format.header_size] == SYNC_BYTE) {
+            ++count;
+        }
+    }
+    return count;
+}
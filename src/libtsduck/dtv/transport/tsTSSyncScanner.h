@@ -0,0 +1,167 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Scanner for sequences of TS packets in raw data.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTS.h"
+
+namespace ts {
+    //!
+    //! Scanner for sequences of TS packets in raw data.
+    //! @ingroup mpeg
+    //!
+    //! This class looks for the start of a sequence of TS packets in a buffer of raw
+    //! data, typically to resynchronize a damaged capture. A sequence of packets is
+    //! identified by 0x47 sync bytes at regular intervals. Several encapsulation formats
+    //! can be searched at the same time (plain 188-byte TS packets, 204-byte packets with
+    //! a Reed-Solomon trailer, 192-byte M2TS packets with a 4-byte header, etc.)
+    //!
+    //! Candidate positions are searched using SIMD instructions when supported by the CPU
+    //! (SSE2 or AVX2 on Intel, Neon on Arm), checking several consecutive positions for
+    //! several sync bytes in parallel. The candidates are then confirmed one by one.
+    //!
+    class TSDUCKDLL TSSyncScanner
+    {
+    public:
+        //!
+        //! Description of an encapsulation format of TS packets.
+        //!
+        class TSDUCKDLL Format
+        {
+        public:
+            size_t packet_size;  //!< Size in bytes of an encapsulated packet, including header and trailer.
+            size_t header_size;  //!< Size in bytes of the header before the sync byte.
+
+            //!
+            //! Constructor.
+            //! @param [in] psize Size in bytes of an encapsulated packet.
+            //! @param [in] hsize Size in bytes of the header before the sync byte.
+            //!
+            Format(size_t psize = PKT_SIZE, size_t hsize = 0) : packet_size(psize), header_size(hsize) {}
+        };
+
+        //!
+        //! Vector of encapsulation formats.
+        //!
+        typedef std::vector<Format> FormatVector;
+
+        //!
+        //! Standard formats of TS files, in order of preference.
+        //! These are plain TS packets (188 bytes), TS packets with a trailing 16-byte Reed-Solomon
+        //! outer FEC (204 bytes) and M2TS packets with a leading 4-byte timestamp (192 bytes).
+        //! @return A constant reference to the standard formats.
+        //!
+        static const FormatVector& StandardFormats();
+
+        //!
+        //! Implementations of the scanner.
+        //! All engines produce the same result. They differ only in performance.
+        //!
+        enum Engine {
+            ENGINE_AUTO,      //!< Automatically select the fastest engine which is supported by the CPU.
+            ENGINE_PORTABLE,  //!< Portable implementation, 8 positions at a time in 64-bit integers.
+            ENGINE_SSE2,      //!< Intel SSE2 instructions, 16 positions at a time.
+            ENGINE_AVX2,      //!< Intel AVX2 instructions, 32 positions at a time.
+            ENGINE_NEON       //!< Arm Neon instructions, 16 positions at a time.
+        };
+
+        //!
+        //! Check if a scanner engine is supported on this platform and this CPU.
+        //! @param [in] engine The engine to check.
+        //! @return True if @a engine is supported.
+        //!
+        static bool IsEngineSupported(Engine engine);
+
+        //!
+        //! Constructor.
+        //! @param [in] formats Encapsulation formats to search, in order of preference.
+        //! @param [in] engine The engine to use. If not supported on this CPU, ENGINE_AUTO is used.
+        //!
+        TSSyncScanner(const FormatVector& formats = StandardFormats(), Engine engine = ENGINE_AUTO);
+
+        //!
+        //! Set the encapsulation formats to search.
+        //! @param [in] formats Encapsulation formats to search, in order of preference.
+        //! When several formats are found at the same position, the first one in the list is used.
+        //! Formats with a packet size smaller than a TS packet are ignored.
+        //!
+        void setFormats(const FormatVector& formats);
+
+        //!
+        //! Get the encapsulation formats to search.
+        //! @return A constant reference to the encapsulation formats.
+        //!
+        const FormatVector& formats() const { return _formats; }
+
+        //!
+        //! Set the scanner engine.
+        //! @param [in] engine The engine to use. If not supported on this CPU, ENGINE_AUTO is used.
+        //!
+        void setEngine(Engine engine);
+
+        //!
+        //! Set the minimum length of a sequence of packets.
+        //! The number of consecutive packets which are required for a format is the maximum
+        //! of @a packets and @a bytes divided by the packet size of this format.
+        //! The default is 5 packets.
+        //! @param [in] packets Minimum number of consecutive packets.
+        //! @param [in] bytes Minimum number of bytes in consecutive packets.
+        //!
+        void setMinimum(size_t packets, size_t bytes = 0);
+
+        //!
+        //! Find the first sequence of packets in a buffer.
+        //! @param [in] data Address of the data area.
+        //! @param [in] size Size in bytes of the data area.
+        //! @param [out] offset Offset in @a data of the first packet (including its header).
+        //! @param [out] format Index in formats() of the format of the packets.
+        //! @return True if a sequence of packets was found, false otherwise.
+        //!
+        bool find(const uint8_t* data, size_t size, size_t& offset, size_t& format) const;
+
+        //!
+        //! Count the number of consecutive packets at the start of a buffer.
+        //! @param [in] data Address of the first packet (including its header).
+        //! @param [in] size Size in bytes of the data area.
+        //! @param [in] format Encapsulation format of the packets.
+        //! @return The number of complete consecutive packets, starting with a sync byte.
+        //!
+        static size_t CountPackets(const uint8_t* data, size_t size, const Format& format);
+
+    private:
+        FormatVector _formats;
+        Engine       _engine;
+        size_t       _min_packets;
+        size_t       _min_bytes;
+    };
+}
@@ -49,6 +49,7 @@ ts::InputSwitcherArgs::InputSwitcherArgs() :
     appName(),
     fastSwitch(false),
     delayedSwitch(false),
+    cleanSwitch(false),
     terminate(false),
     reusePort(false),
     firstInput(0),
@@ -112,6 +113,14 @@ void ts::InputSwitcherArgs::defineArgs(Args& args)
               u"Specify the size in TS packets of each input plugin buffer. "
               u"The default is " + UString::Decimal(DEFAULT_BUFFERED_PACKETS) + u" packets.");
 
+    args.option(u"clean-switch");
+    args.help(u"clean-switch",
+              u"With --fast-switch, monitor the continuity counters and PCR's of all standby input "
+              u"plugins. When switching, the output of the new input plugin starts on the latest "
+              u"buffered packet which carries a PCR and starts a random access point or a payload "
+              u"unit, instead of the oldest buffered packet. Packets before that boundary are dropped. "
+              u"If no such boundary was received, the switch occurs immediately, as without this option.");
+
     args.option(u"cycle", 'c', Args::POSITIVE);
     args.help(u"cycle",
               u"Specify how many times to repeat the cycle through all input plugins in sequence. "
@@ -238,6 +247,7 @@ bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
     appName = args.appName();
     fastSwitch = args.present(u"fast-switch");
     delayedSwitch = args.present(u"delayed-switch");
+    cleanSwitch = args.present(u"clean-switch");
     terminate = args.present(u"terminate");
     args.getIntValue(cycleCount, u"cycle", args.present(u"infinite") ? 0 : 1);
     args.getIntValue(bufferedPackets, u"buffer-packets", DEFAULT_BUFFERED_PACKETS);
@@ -263,6 +273,9 @@ bool ts::InputSwitcherArgs::loadArgs(DuckContext& duck, Args& args)
     if (fastSwitch && delayedSwitch) {
         args.error(u"options --delayed-switch and --fast-switch are mutually exclusive");
     }
+    if (cleanSwitch && !fastSwitch) {
+        args.error(u"option --clean-switch requires --fast-switch");
+    }
 
     // Resolve network names. The resolve() method reports error and set the args error state.
     if (!remoteName.empty() && remoteServer.resolve(remoteName, args) && !remoteServer.hasPort()) {
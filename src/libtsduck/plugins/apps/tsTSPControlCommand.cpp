@@ -56,6 +56,16 @@ ts::TSPControlCommand::TSPControlCommand(Report& report) :
 
     arg = command(u"list", u"List all running plugins", u"[options]", flags);
 
+    arg = command(u"stats", u"Display the instrumentation counters of all running plugins", u"[options]", flags);
+    arg->setIntro(u"For each plugin, display the number of processed packets, the number of packets per second, "
+                  u"the percentage of time in the plugin processing and in CPU usage, the percentage of time "
+                  u"which is spent waiting for packets from the previous plugin (or for free buffer space for the "
+                  u"input plugin), the current and maximum number of packets which are waiting in the plugin area "
+                  u"of the global buffer. A plugin with a high processing time and a low waiting time while "
+                  u"the next plugins are waiting is the bottleneck of the processing chain.");
+    arg->option(u"json", 'j');
+    arg->help(u"json", u"Display the counters as one line of JSON text.");
+
     arg = command(u"suspend", u"Suspend a plugin", u"[options] plugin-index", flags);
     arg->setIntro(u"Suspend a plugin. When a packet processing plugin is suspended, "
                   u"the TS packets are directly passed from the previous to the next plugin, "
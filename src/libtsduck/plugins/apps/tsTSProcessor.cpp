@@ -32,6 +32,7 @@
 #include "tstspOutputExecutor.h"
 #include "tstspProcessorExecutor.h"
 #include "tstspControlServer.h"
+#include "tstspStatisticsReporter.h"
 #include "tsMonotonic.h"
 #include "tsGuardMutex.h"
 
@@ -49,6 +50,7 @@ ts::TSProcessor::TSProcessor(Report& report) :
     _input(nullptr),
     _output(nullptr),
     _control(nullptr),
+    _stats(nullptr),
     _packet_buffer(nullptr),
     _metadata_buffer(nullptr)
 {
@@ -75,6 +77,12 @@ void ts::TSProcessor::cleanupInternal()
         _control = nullptr;
     }
 
+    // Same thing for the statistics report thread.
+    if (_stats != nullptr) {
+        delete _stats;
+        _stats = nullptr;
+    }
+
     // Abort and wait for threads to terminate
     tsp::PluginExecutor* proc = _input;
     do {
@@ -140,10 +148,19 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
         // plugin has a hight priority to make room in the buffer, but not as
         // high as the input which must remain the top-most priority?
 
-        _input = new tsp::InputExecutor(_args, *this, _args.input, ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()), _mutex, &_report);
+        // With --cpu-list, each plugin thread is pinned on one CPU, in order from input to output.
+
+        const auto attributes = [this](ThreadAttributes attr, size_t index) {
+            if (!_args.cpu_list.empty()) {
+                attr.setCPUs({_args.cpu_list[index % _args.cpu_list.size()]});
+            }
+            return attr;
+        };
+
+        _input = new tsp::InputExecutor(_args, *this, _args.input, attributes(ThreadAttributes().setPriority(ts::ThreadAttributes::GetMaximumPriority()), 0), _mutex, &_report);
         CheckNonNull(_input);
 
-        _output = new tsp::OutputExecutor(_args, *this, _args.output, ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), _mutex, &_report);
+        _output = new tsp::OutputExecutor(_args, *this, _args.output, attributes(ThreadAttributes().setPriority(ts::ThreadAttributes::GetHighPriority()), _args.plugins.size() + 1), _mutex, &_report);
         CheckNonNull(_output);
 
         _output->ringInsertAfter(_input);
@@ -151,11 +168,20 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
         // Check if at least one plugin prefers real-time defaults.
         bool realtime = _args.realtime == Tristate::TRUE || _input->isRealTime() || _output->isRealTime();
 
+        std::vector<tsp::PluginExecutor*> procs;
         for (size_t i = 0; i < _args.plugins.size(); ++i) {
-            tsp::PluginExecutor* p = new tsp::ProcessorExecutor(_args, *this, i, ThreadAttributes(), _mutex, &_report);
+            tsp::PluginExecutor* p = new tsp::ProcessorExecutor(_args, *this, i, attributes(ThreadAttributes(), i + 1), _mutex, &_report);
             CheckNonNull(p);
             p->ringInsertBefore(_output);
             realtime = realtime || p->isRealTime();
+            procs.push_back(p);
+        }
+
+        // Declare the groups of packet processors which run in parallel as monitors.
+        for (const auto& group : _args.monitor_groups) {
+            if (group.first < group.second && group.second < procs.size()) {
+                tsp::PluginExecutor::SetMonitorGroup(std::vector<tsp::PluginExecutor*>(procs.begin() + group.first, procs.begin() + group.second + 1));
+            }
         }
 
         // Check if realtime defaults are explicitly disabled.
@@ -187,18 +213,31 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
             }
         } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != _input);
 
+        // The global buffers are allocated on the NUMA node of the input thread, unless specified otherwise.
+        int numa_node = _args.numa_node;
+        if (numa_node < 0 && !_args.cpu_list.empty()) {
+            numa_node = GetCPUNumaNode(_args.cpu_list.front());
+        }
+
         // Allocate a memory-resident buffer of TS packets
-        _packet_buffer = new PacketBuffer(_args.ts_buffer_size / ts::PKT_SIZE);
+        _packet_buffer = new PacketBuffer(_args.ts_buffer_size / ts::PKT_SIZE, _args.huge_pages, numa_node);
         CheckNonNull(_packet_buffer);
         if (!_packet_buffer->isLocked()) {
             _report.debug(u"tsp: buffer failed to lock into physical memory (%d: %s), risk of real-time issue",
                           {_packet_buffer->lockErrorCode(), ts::SysErrorCodeMessage(_packet_buffer->lockErrorCode())});
         }
-        _report.debug(u"tsp: buffer size: %'d TS packets, %'d bytes", {_packet_buffer->count(), _packet_buffer->count() * ts::PKT_SIZE});
+        if (_args.huge_pages && !_packet_buffer->isHugePages()) {
+            _report.warning(u"tsp: huge pages not available for the buffer, using normal memory pages");
+        }
+        if (numa_node >= 0 && _packet_buffer->numaNode() != numa_node) {
+            _report.warning(u"tsp: cannot allocate the buffer on NUMA node %d", {numa_node});
+        }
+        _report.debug(u"tsp: buffer size: %'d TS packets, %'d bytes, huge pages: %s, NUMA node: %d",
+                      {_packet_buffer->count(), _packet_buffer->count() * ts::PKT_SIZE, _packet_buffer->isHugePages(), _packet_buffer->numaNode()});
 
         // Buffer for the packet metadata.
         // A packet and its metadata have the same index in their respective buffer.
-        _metadata_buffer = new PacketMetadataBuffer(_packet_buffer->count());
+        _metadata_buffer = new PacketMetadataBuffer(_packet_buffer->count(), _args.huge_pages, numa_node);
         CheckNonNull(_metadata_buffer);
 
         // End of locked section.
@@ -241,6 +280,11 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
     CheckNonNull(_control);
     _control->open();
 
+    // Create a statistics report thread. Display but ignore errors (not a fatal error).
+    _stats = new tsp::StatisticsReporter(_args, _report, _input);
+    CheckNonNull(_stats);
+    _stats->open();
+
     return true;
 }
 
@@ -294,6 +338,9 @@ void ts::TSProcessor::waitForTermination()
         // Make sure the control server thread is terminated before deleting plugins.
         _control->close();
 
+        // Final statistics report, after termination of all plugins.
+        _stats->close();
+
         // Deallocate all plugins and plugin executor
         cleanupInternal();
     }
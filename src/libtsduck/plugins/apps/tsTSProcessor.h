@@ -46,6 +46,7 @@ namespace ts {
         class InputExecutor;
         class OutputExecutor;
         class ControlServer;
+        class StatisticsReporter;
     }
     //! @endcond
 
@@ -116,6 +117,7 @@ namespace ts {
         tsp::InputExecutor*   _input;            // Input processor execution thread.
         tsp::OutputExecutor*  _output;           // Output processor execution thread.
         tsp::ControlServer*   _control;          // TSP control command server thread.
+        tsp::StatisticsReporter* _stats;         // Periodic statistics report thread.
         PacketBuffer*         _packet_buffer;    // Global TS packet buffer.
         PacketMetadataBuffer* _metadata_buffer;  // Global packet metabata buffer.
 
@@ -53,7 +53,10 @@ ts::TSProcessorArgs::TSProcessorArgs() :
     app_name(),
     ignore_jt(false),
     log_plugin_index(false),
+    lock_free_handoff(false),
     ts_buffer_size(DEFAULT_BUFFER_SIZE),
+    huge_pages(false),
+    numa_node(-1),
     max_flush_pkt(0),
     max_input_pkt(0),
     max_output_pkt(NPOS), // unlimited
@@ -73,10 +76,14 @@ ts::TSProcessorArgs::TSProcessorArgs() :
     control_reuse(false),
     control_sources(),
     control_timeout(DEF_CONTROL_TIMEOUT),
+    stats_interval(0),
+    stats_file(),
     duck_args(),
     input(),
     plugins(),
-    output()
+    output(),
+    monitor_groups(),
+    cpu_list()
 {
 }
 
@@ -155,11 +162,30 @@ void ts::TSProcessorArgs::defineArgs(Args& args)
               u"Specify the reception timeout in milliseconds for control commands. "
               u"The default timeout is " TS_STRINGIFY(DEF_CONTROL_TIMEOUT) u" ms.");
 
+    args.option(u"cpu-list", 0, Args::STRING);
+    args.help(u"cpu-list", u"list",
+              u"Pin the plugin threads on the specified CPU's. "
+              u"The list is a comma-separated list of CPU indexes or ranges of CPU indexes, "
+              u"as in the taskset command on Linux, for instance \"2-5,8\". "
+              u"The plugin threads, from input to output, are pinned on the CPU's of the list, "
+              u"one CPU per thread, in this order. If there are more plugins than CPU's in the list, "
+              u"the list is reused from the beginning. "
+              u"Unless --numa-node is specified, the global buffer is allocated on the NUMA node "
+              u"of the input plugin CPU. "
+              u"This option is supported on Linux and Windows only.");
+
     args.option(u"final-wait", 0, Args::INT64);
     args.help(u"final-wait", u"milliseconds",
               u"Wait the specified number of milliseconds after the last input packet. "
               u"Zero means wait forever.");
 
+    args.option(u"huge-pages");
+    args.help(u"huge-pages",
+              u"Try to allocate the global buffer using huge memory pages, reducing the TLB misses "
+              u"when the plugins access packets in a large buffer. "
+              u"When no huge page is reserved in the system, transparent huge pages are used when possible. "
+              u"This option is supported on Linux only.");
+
     args.option(u"ignore-joint-termination", 'i');
     args.help(u"ignore-joint-termination",
               u"Ignore all --joint-termination options in plugins. "
@@ -180,6 +206,15 @@ void ts::TSProcessorArgs::defineArgs(Args& args)
               u"a valid bitrate value from the beginning. "
               u"The default initial load is half the size of the global buffer.");
 
+    args.option(u"lock-free-handoff");
+    args.help(u"lock-free-handoff",
+              u"Use lock-free synchronization to pass packets from one plugin to the next one. "
+              u"By default, all plugin threads synchronize on one single global lock to "
+              u"exchange packets in the global buffer. With this option, each pair of "
+              u"adjacent plugins synchronizes independently and a plugin thread is woken up "
+              u"only when it is actually waiting for packets. This can reduce the "
+              u"synchronization overhead with long chains of plugins at high bitrates.");
+
     args.option(u"log-plugin-index");
     args.help(u"log-plugin-index",
               u"In log messages, add the plugin index to the plugin name. "
@@ -214,6 +249,24 @@ void ts::TSProcessorArgs::defineArgs(Args& args)
               u"This option is useful only when an output plugin or device has problems with large output requests. "
               u"This option forces multiple smaller send operations.");
 
+    args.option(u"monitor-group", 0, Args::STRING, 0, Args::UNLIMITED_COUNT);
+    args.help(u"monitor-group", u"first-last",
+              u"Run the packet processor plugins with indexes 'first' to 'last' in parallel, as a group of monitors. "
+              u"The plugins are numbered from 1 (the input plugin has index 0, like in option --log-plugin-index). "
+              u"All plugins in the group receive the same packets at the same time, each one in its own thread. "
+              u"The next plugin receives the packets when all plugins in the group have processed them. "
+              u"The plugins in a group shall only read the packets, typically analysis plugins such as "
+              u"analyze, continuity, pcrverify or tables. They cannot drop, nullify or modify packets. "
+              u"Several options --monitor-group can be specified, the groups shall not overlap and shall "
+              u"not be adjacent. This option cannot be used with --lock-free-handoff.");
+
+    args.option(u"numa-node", 0, Args::INTEGER, 0, 1, 0, 1023);
+    args.help(u"numa-node",
+              u"Allocate the global buffer on the specified NUMA node. "
+              u"By default, the global buffer is allocated on the NUMA node of the input plugin CPU "
+              u"when --cpu-list is specified, and on any node otherwise. "
+              u"This option is supported on Linux only.");
+
     args.option(u"realtime", 'r', Args::TRISTATE, 0, 1, -255, 256, true);
     args.help(u"realtime",
               u"Specifies if tsp and all plugins should use default values for real-time "
@@ -223,6 +276,22 @@ void ts::TSProcessorArgs::defineArgs(Args& args)
               u"are enforced. The explicit values 'no', 'false', 'off' are used to enforce "
               u"the offline defaults and the explicit values 'yes', 'true', 'on' are used "
               u"to enforce the real-time defaults.");
+
+    args.option(u"statistics-file", 0, Args::FILENAME);
+    args.help(u"statistics-file",
+              u"With --statistics-interval, save the statistics reports in the specified JSON file. "
+              u"The file contains an array of reports, one per interval. "
+              u"By default, each report is logged as one single line of JSON text.");
+
+    args.option(u"statistics-interval", 0, Args::POSITIVE);
+    args.help(u"statistics-interval", u"seconds",
+              u"Periodically report the instrumentation counters of all plugins in JSON format. "
+              u"For each plugin, report the number of processed packets and packets per second, "
+              u"the processing time and CPU time of the plugin thread, the time which is spent "
+              u"waiting for packets from the previous plugin (or for free buffer space for the input plugin), "
+              u"the current and maximum number of packets waiting in the plugin area of the global buffer. "
+              u"A final report is issued at the end of the processing. "
+              u"The same counters can be displayed at any time using the tspcontrol command 'stats'.");
 }
 
 
@@ -234,7 +303,10 @@ bool ts::TSProcessorArgs::loadArgs(DuckContext& duck, Args& args)
 {
     app_name = args.appName();
     log_plugin_index = args.present(u"log-plugin-index");
+    lock_free_handoff = args.present(u"lock-free-handoff");
     ts_buffer_size = args.intValue<size_t>(u"buffer-size-mb", DEFAULT_BUFFER_SIZE);
+    huge_pages = args.present(u"huge-pages");
+    args.getIntValue(numa_node, u"numa-node", -1);
     args.getValue(fixed_bitrate, u"bitrate", 0);
     bitrate_adj = MilliSecPerSec * args.intValue(u"bitrate-adjust-interval", DEF_BITRATE_INTERVAL);
     args.getIntValue(max_flush_pkt, u"max-flushed-packets", 0);
@@ -250,6 +322,8 @@ bool ts::TSProcessorArgs::loadArgs(DuckContext& duck, Args& args)
     args.getIntValue(control_port, u"control-port", 0);
     args.getIntValue(control_timeout, u"control-timeout", DEF_CONTROL_TIMEOUT);
     control_reuse = args.present(u"control-reuse-port");
+    stats_interval = MilliSecPerSec * args.intValue<MilliSecond>(u"statistics-interval", 0);
+    args.getValue(stats_file, u"statistics-file");
 
     // Convert MB in MiB for buffer size for compatibility with original versions.
     ts_buffer_size = size_t((uint64_t(ts_buffer_size) * 1024 * 1024) / 1000000);
@@ -297,6 +371,53 @@ bool ts::TSProcessorArgs::loadArgs(DuckContext& duck, Args& args)
         plugins.clear();
     }
 
+    // Decode --monitor-group first-last, using the plugin indexes which are displayed with --log-plugin-index.
+    monitor_groups.clear();
+    for (size_t i = 0; i < args.count(u"monitor-group"); ++i) {
+        const UString value(args.value(u"monitor-group", u"", i));
+        size_t first = 0;
+        size_t last = 0;
+        if (!value.scan(u"%d-%d", {&first, &last}) || first < 1 || last <= first) {
+            args.error(u"invalid value \"%s\" for --monitor-group, use \"first-last\" with at least two plugins", {value});
+        }
+        else if (last > plugins.size()) {
+            args.error(u"invalid --monitor-group %s, there are only %d packet processor plugins", {value, plugins.size()});
+        }
+        else {
+            monitor_groups.push_back(std::make_pair(first - 1, last - 1));
+        }
+    }
+    std::sort(monitor_groups.begin(), monitor_groups.end());
+    for (size_t i = 1; i < monitor_groups.size(); ++i) {
+        if (monitor_groups[i].first <= monitor_groups[i-1].second + 1) {
+            args.error(u"monitor groups %d-%d and %d-%d overlap or are adjacent",
+                       {monitor_groups[i-1].first + 1, monitor_groups[i-1].second + 1, monitor_groups[i].first + 1, monitor_groups[i].second + 1});
+        }
+    }
+    if (lock_free_handoff && !monitor_groups.empty()) {
+        args.error(u"--monitor-group and --lock-free-handoff are mutually exclusive");
+    }
+
+    // Decode --cpu-list, a comma-separated list of CPU indexes or ranges.
+    cpu_list.clear();
+    UStringVector cpus;
+    args.value(u"cpu-list").split(cpus, u',', true, true);
+    for (const auto& item : cpus) {
+        size_t first = 0;
+        size_t last = 0;
+        if (item.toInteger(first)) {
+            cpu_list.push_back(first);
+        }
+        else if (item.scan(u"%d-%d", {&first, &last}) && first <= last) {
+            for (size_t cpu = first; cpu <= last; ++cpu) {
+                cpu_list.push_back(cpu);
+            }
+        }
+        else {
+            args.error(u"invalid value \"%s\" in --cpu-list", {item});
+        }
+    }
+
     // Get default options for TSDuck contexts in each plugin.
     duck.saveArgs(duck_args);
 
@@ -49,7 +49,10 @@ namespace ts {
         UString           app_name;         //!< Application name, for help messages.
         bool              ignore_jt;        //!< Ignore "joint termination" options in plugins.
         bool              log_plugin_index; //!< Log plugin index with plugin name.
+        bool              lock_free_handoff;//!< Use lock-free synchronization between adjacent plugins instead of a global mutex.
         size_t            ts_buffer_size;   //!< Size in bytes of the global TS packet buffer.
+        bool              huge_pages;       //!< Try to allocate the global TS packet buffer using huge memory pages.
+        int               numa_node;        //!< NUMA node of the global buffers, negative means default.
         size_t            max_flush_pkt;    //!< Max processed packets before flush.
         size_t            max_input_pkt;    //!< Max packets per input operation.
         size_t            max_output_pkt;   //!< Max packets per outsput operation.
@@ -69,11 +72,26 @@ namespace ts {
         bool              control_reuse;    //!< Set the 'reuse port' socket option on the control TCP server port.
         IPv4AddressVector control_sources;  //!< Remote IP addresses which are allowed to send control commands.
         MilliSecond       control_timeout;  //!< Reception timeout in milliseconds for control commands.
+        MilliSecond       stats_interval;   //!< Interval between two reports of plugin statistics, zero means none.
+        UString           stats_file;       //!< Output JSON file for plugin statistics, empty means log them.
         DuckContext::SavedArgs duck_args;   //!< Default TSDuck context options for all plugins. Each plugin can override them in its context.
         PluginOptions          input;       //!< Input plugin description.
         PluginOptionsVector    plugins;     //!< Packet processor plugins descriptions.
         PluginOptions          output;      //!< Output plugin description.
 
+        //!
+        //! Groups of consecutive packet processors which run in parallel as read-only monitors.
+        //! Each group is described by the indexes of its first and last plugin in @a plugins.
+        //!
+        std::vector<std::pair<size_t,size_t>> monitor_groups;
+
+        //!
+        //! List of CPU's on which the plugin threads are pinned, empty means no CPU affinity.
+        //! The plugin threads, from input to output, are pinned on the CPU's of the list,
+        //! one CPU per thread, reusing the list from the beginning if there are more threads.
+        //!
+        std::vector<size_t> cpu_list;
+
         static constexpr size_t DEFAULT_BUFFER_SIZE = 16 * 1000000;  //!< Default size in bytes of global TS buffer.
         static constexpr size_t MIN_BUFFER_SIZE = 18800;             //!< Minimum size in bytes of global TS buffer.
 
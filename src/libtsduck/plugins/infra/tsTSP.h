@@ -216,7 +216,7 @@ namespace ts {
         BitRate           _tsp_bitrate;             //!< TSP input bitrate.
         BitRateConfidence _tsp_bitrate_confidence;  //!< TSP input bitrate confidence.
         MilliSecond       _tsp_timeout;             //!< Timeout when waiting for packets (infinite by default).
-        volatile bool     _tsp_aborting;            //!< TSP is currently aborting.
+        std::atomic<bool> _tsp_aborting;            //!< TSP is currently aborting.
 
         //!
         //! Constructor for subclasses.
@@ -31,6 +31,10 @@
 #include "tsSysUtils.h"
 #include "tsIPProtocols.h"
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::AbstractDatagramInputPlugin::MAX_DATAGRAM_BATCH;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Input constructor
@@ -42,9 +46,12 @@ ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_,
                                                              const UString& syntax,
                                                              const UString& system_time_name,
                                                              const UString& system_time_description,
-                                                             bool real_time) :
+                                                             bool real_time,
+                                                             bool allow_batch) :
     InputPlugin(tsp_, description, syntax),
     _real_time(real_time),
+    _allow_batch(allow_batch),
+    _batch(1),
     _eval_time(0),
     _display_time(0),
     _time_priority_enum(),
@@ -60,9 +67,22 @@ ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_,
     _inbuf_count(0),
     _inbuf_next(0),
     _mdata_next(0),
-    _inbuf(std::max(buffer_size, 7 * PKT_SIZE)),
-    _mdata(_inbuf.size() / PKT_SIZE)
+    _dgram_size(std::max(buffer_size, 7 * PKT_SIZE)),
+    _dgram_count(0),
+    _dgram_next(0),
+    _inbuf(),
+    _dgram_sizes(),
+    _dgram_timestamps(),
+    _mdata(_dgram_size / PKT_SIZE)
 {
+    if (_allow_batch) {
+        option(u"batch", 0, INTEGER, 0, 1, 1, MAX_DATAGRAM_BATCH);
+        help(u"batch",
+             u"Specify the maximum number of datagrams to receive in one system call, when supported by the system (Linux). "
+             u"All datagrams which are already available are returned at once, without waiting for more datagrams. "
+             u"The default is 1 (one datagram at a time), the maximum is " + UString::Decimal(MAX_DATAGRAM_BATCH) + u".");
+    }
+
     if (_real_time) {
         option(u"display-interval", 'd', POSITIVE);
         help(u"display-interval",
@@ -124,6 +144,9 @@ bool ts::AbstractDatagramInputPlugin::getOptions()
         _display_time = MilliSecPerSec * intValue<MilliSecond>(u"display-interval", 0);
     }
     getIntValue(_time_priority, u"timestamp-priority", _default_time_priority);
+    if (_allow_batch) {
+        getIntValue(_batch, u"batch", 1);
+    }
     return true;
 }
 
@@ -136,12 +159,31 @@ bool ts::AbstractDatagramInputPlugin::start()
 {
     // Initialize working data.
     _inbuf_count = _inbuf_next = _mdata_next = 0;
+    _dgram_count = _dgram_next = 0;
+    _inbuf.resize(_batch * _dgram_size);
+    _dgram_sizes.resize(_batch);
+    _dgram_timestamps.resize(_batch);
     _start = _start_0 = _start_1 = _next_display = Time::Epoch;
     _packets = _packets_0 = _packets_1 = 0;
     return true;
 }
 
 
+//----------------------------------------------------------------------------
+// Default implementation of batched reception: one datagram at a time.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps)
+{
+    ret_count = 0;
+    if (max_count == 0 || !receiveDatagram(buffer, buffer_size, ret_sizes[0], timestamps[0])) {
+        return false;
+    }
+    ret_count = 1;
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Input bitrate evaluation method
 //----------------------------------------------------------------------------
@@ -182,21 +224,36 @@ size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetada
     // Loop until we get some TS packets.
     while (_inbuf_count == 0) {
 
-        // Wait for a datagram message
-        size_t insize = 0;
-        if (!receiveDatagram(_inbuf.data(), _inbuf.size(), insize, timestamp)) {
-            return 0;
+        // When all previously received datagrams are processed, wait for new datagram messages.
+        if (_dgram_next >= _dgram_count) {
+            _dgram_count = _dgram_next = 0;
+            if (!receiveDatagrams(_inbuf.data(), _dgram_size, _batch, _dgram_count, _dgram_sizes.data(), _dgram_timestamps.data())) {
+                return 0;
+            }
+            assert(_dgram_count <= _batch);
+            if (_dgram_count == 0) {
+                continue;
+            }
         }
 
+        // Next datagram to process.
+        const size_t dgram_index = _dgram_next++;
+        const uint8_t* const dgram = _inbuf.data() + dgram_index * _dgram_size;
+        const size_t insize = std::min(_dgram_sizes[dgram_index], _dgram_size);
+        timestamp = _dgram_timestamps[dgram_index];
+
         // Look for TS packets in the UDP message.
-        new_packets = TSPacket::Locate(_inbuf.data(), insize, _inbuf_next, _inbuf_count);
+        new_packets = TSPacket::Locate(dgram, insize, _inbuf_next, _inbuf_count);
 
         if (new_packets) {
 
             // Look for an RTP header before the first packet. There is no clear proof of the presence of the RTP header.
             // We check if the header size is large enough for an RTP header and if the "RTP payload type" is MPEG-2 TS.
-            const bool rtp = _inbuf_next >= RTP_HEADER_SIZE && (_inbuf[1] & 0x7F) == RTP_PT_MP2T;
-            const uint32_t rtp_timestamp = rtp ? GetUInt32(_inbuf.data() + 4) : 0;
+            const bool rtp = _inbuf_next >= RTP_HEADER_SIZE && (dgram[1] & 0x7F) == RTP_PT_MP2T;
+            const uint32_t rtp_timestamp = rtp ? GetUInt32(dgram + 4) : 0;
+
+            // Make the packet index relative to the complete input buffer.
+            _inbuf_next += dgram_index * _dgram_size;
 
             // Use RTP time stamp if there is one and RTP is the preferred choice.
             bool use_rtp = false;
@@ -58,6 +58,11 @@ namespace ts {
         virtual BitRateConfidence getBitrateConfidence() override;
         virtual size_t receive(TSPacket*, TSPacketMetadata*, size_t) override;
 
+        //!
+        //! Maximum number of datagrams to receive in one operation (option -\-batch).
+        //!
+        static constexpr size_t MAX_DATAGRAM_BATCH = 64;
+
     protected:
         //!
         //! Constructor for subclasses.
@@ -71,6 +76,8 @@ namespace ts {
         //! @param [in] system_time_description Description of @a system_time_name for help text.
         //! @param [in] real_time If true, the reception occurs in real-time, typically from
         //! the network. When false, the "reception" can be reading a capture file.
+        //! @param [in] allow_batch If true, the option -\-batch is defined and the subclass
+        //! should override receiveDatagrams() to receive several datagrams in one operation.
         //!
         AbstractDatagramInputPlugin(TSP* tsp,
                                     size_t buffer_size,
@@ -78,7 +85,8 @@ namespace ts {
                                     const UString& syntax,
                                     const UString& system_time_name,
                                     const UString& system_time_description,
-                                    bool real_time);
+                                    bool real_time,
+                                    bool allow_batch = false);
 
         //!
         //! Receive a datagram message.
@@ -91,12 +99,30 @@ namespace ts {
         //!
         virtual bool receiveDatagram(uint8_t* buffer, size_t buffer_size, size_t& ret_size, MicroSecond& timestamp) = 0;
 
+        //!
+        //! Receive several datagram messages in one operation.
+        //! Wait for at least one datagram and return all datagrams which are immediately available.
+        //! The default implementation receives one single datagram using receiveDatagram().
+        //! @param [out] buffer Address of the buffer for the received messages. The buffer contains
+        //! @a max_count consecutive areas of @a buffer_size bytes each, one per received message.
+        //! @param [in] buffer_size Size in bytes of the reception area of one message.
+        //! @param [in] max_count Maximum number of messages to receive.
+        //! @param [out] ret_count Number of received messages.
+        //! @param [out] ret_sizes Array of @a max_count sizes. Receive the size in bytes of each message.
+        //! @param [out] timestamps Array of @a max_count timestamps. Receive the timestamp of each message
+        //! in micro-seconds or -1 if not available.
+        //! @return True on success, false on error.
+        //!
+        virtual bool receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps);
+
     private:
         // Order of priority for input timestamps. SYSTEM means lower layer from subclass (UDP, SRT, etc).
         enum TimePriority {RTP_SYSTEM_TSP, SYSTEM_RTP_TSP, RTP_TSP, SYSTEM_TSP, TSP_ONLY};
 
         // Configuration and command line options.
         bool          _real_time;             // Real-time reception.
+        bool          _allow_batch;           // Option --batch is allowed.
+        size_t        _batch;                 // Max number of datagrams per receive operation.
         MilliSecond   _eval_time;             // Bitrate evaluation interval in milli-seconds
         MilliSecond   _display_time;          // Bitrate display interval in milli-seconds
         Enumeration   _time_priority_enum;    // Enumeration values for _time_priority
@@ -114,7 +140,12 @@ namespace ts {
         size_t        _inbuf_count;           // Number of remaining TS packets in inbuf
         size_t        _inbuf_next;            // Byte index in _inbuf of next TS packet to return
         size_t        _mdata_next;            // Index in _mdata of next TS packet metadata to return
-        ByteBlock     _inbuf;                 // Input buffer
-        TSPacketMetadataVector _mdata;        // Metadata for packets in _inbuf
+        size_t        _dgram_size;            // Max size of one datagram in _inbuf
+        size_t        _dgram_count;           // Number of received datagrams in _inbuf
+        size_t        _dgram_next;            // Index of next datagram to process in _inbuf
+        ByteBlock     _inbuf;                 // Input buffer, contains _batch datagrams
+        std::vector<size_t>      _dgram_sizes;       // Size of each datagram in _inbuf
+        std::vector<MicroSecond> _dgram_timestamps;  // Receive timestamp of each datagram in _inbuf
+        TSPacketMetadataVector   _mdata;             // Metadata for packets in current datagram
     };
 }
@@ -34,6 +34,7 @@
 #if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
 constexpr size_t ts::AbstractDatagramOutputPlugin::DEFAULT_PACKET_BURST;
 constexpr size_t ts::AbstractDatagramOutputPlugin::MAX_PACKET_BURST;
+constexpr size_t ts::AbstractDatagramOutputPlugin::MAX_DATAGRAM_BATCH;
 #endif
 
 
@@ -54,6 +55,7 @@ ts::AbstractDatagramOutputPlugin::AbstractDatagramOutputPlugin(TSP* tsp_, const
     _rtp_user_ssrc(0),
     _pcr_user_pid(PID_NULL),
     _rs204_format(false),
+    _batch(1),
     _rtp_sequence(0),
     _rtp_ssrc(0),
     _pcr_pid(PID_NULL),
@@ -63,8 +65,20 @@ ts::AbstractDatagramOutputPlugin::AbstractDatagramOutputPlugin(TSP* tsp_, const
     _rtp_pcr_offset(0),
     _pkt_count(0),
     _out_count(0),
-    _out_buffer()
+    _out_buffer(),
+    _dgram_count(0),
+    _dgram_buffers(),
+    _dgram_addresses(),
+    _dgram_sizes()
 {
+    if ((_flags & ALLOW_BATCH) != 0) {
+        option(u"batch", 0, INTEGER, 0, 1, 1, MAX_DATAGRAM_BATCH);
+        help(u"batch",
+             u"Specify the maximum number of datagrams to send in one system call, when supported by the system (Linux). "
+             u"The datagrams are grouped within each chunk of TS packets which is passed to the output plugin. "
+             u"The default is 1 (one datagram at a time), the maximum is " + UString::Decimal(MAX_DATAGRAM_BATCH) + u".");
+    }
+
     option(u"enforce-burst", 'e');
     help(u"enforce-burst",
          u"Enforce that the number of TS packets per UDP packet is exactly what is specified "
@@ -113,6 +127,9 @@ bool ts::AbstractDatagramOutputPlugin::getOptions()
 {
     getIntValue(_pkt_burst, u"packet-burst", DEFAULT_PACKET_BURST);
     _enforce_burst = present(u"enforce-burst");
+    if ((_flags & ALLOW_BATCH) != 0) {
+        getIntValue(_batch, u"batch", 1);
+    }
 
     if ((_flags & ALLOW_RTP) != 0) {
         _use_rtp = present(u"rtp");
@@ -160,6 +177,12 @@ bool ts::AbstractDatagramOutputPlugin::start()
         }
     }
 
+    // Buffers for datagrams.
+    _dgram_count = 0;
+    _dgram_buffers.resize(_batch);
+    _dgram_addresses.resize(_batch);
+    _dgram_sizes.resize(_batch);
+
     // Other states.
     _pcr_pid = _pcr_user_pid;
     _last_pcr = INVALID_PCR;
@@ -184,7 +207,7 @@ bool ts::AbstractDatagramOutputPlugin::stop()
         success = sendPackets(_out_buffer.data(), _out_count);
         _out_count = 0;
     }
-    return success;
+    return flushDatagrams() && success;
 }
 
 
@@ -230,6 +253,12 @@ bool ts::AbstractDatagramOutputPlugin::send(const TSPacket* pkt, const TSPacketM
         packet_count -= count;
     }
 
+    // Send all pending datagrams in the current batch before returning:
+    // they may point to the packet buffer or to the output buffer.
+    if (!flushDatagrams()) {
+        return false;
+    }
+
     // If remaining packets are present, save them in output buffer.
     if (packet_count > 0) {
         assert(_enforce_burst);
@@ -261,7 +290,8 @@ bool ts::AbstractDatagramOutputPlugin::sendPackets(const TSPacket* pkt, size_t p
         // But never jump back in RTP timestamps, only increase "more slowly" when adjusting.
 
         // Build an RTP datagram. Use a simple RTP header without options nor extensions.
-        ByteBlock buffer(RTP_HEADER_SIZE + packet_count * PKT_RS_SIZE);
+        ByteBlock& buffer(_dgram_buffers[_dgram_count]);
+        buffer.resize(RTP_HEADER_SIZE + packet_count * PKT_RS_SIZE);
 
         // Build the RTP header, except the timestamp.
         buffer[0] = 0x80;             // Version = 2, P = 0, X = 0, CC = 0
@@ -339,10 +369,10 @@ bool ts::AbstractDatagramOutputPlugin::sendPackets(const TSPacket* pkt, size_t p
         // Copy the TS packets after the RTP header and send the packets.
         uint8_t* buf = buffer.data() + RTP_HEADER_SIZE;
         if (_rs204_format) {
-            // Copy TS packets one by one with RS204 zero trailer. Since the default initial value
-            // of the buffer vector is zero, there is no need to explicitly set the trailers.
+            // Copy TS packets one by one with RS204 zero trailer.
             for (size_t i = 0; i < packet_count; ++i) {
                 ::memcpy(buf, pkt++, PKT_SIZE);
+                ::memset(buf + PKT_SIZE, 0, RS_SIZE);
                 buf += PKT_SIZE + RS_SIZE;
             }
         }
@@ -351,22 +381,23 @@ bool ts::AbstractDatagramOutputPlugin::sendPackets(const TSPacket* pkt, size_t p
             ::memcpy(buf, pkt, packet_count * PKT_SIZE);
             buffer.resize(RTP_HEADER_SIZE + packet_count * PKT_SIZE);
         }
-        status = sendDatagram(buffer.data(), buffer.size());
+        status = emitDatagram(buffer.data(), buffer.size());
     }
     else if (_rs204_format) {
-        // No RTP header, add TS trailer after each packet. Since the default initial value
-        // of the buffer vector is zero, there is no need to explicitly set the trailers.
-        ByteBlock buffer(packet_count * PKT_RS_SIZE);
+        // No RTP header, add TS trailer after each packet.
+        ByteBlock& buffer(_dgram_buffers[_dgram_count]);
+        buffer.resize(packet_count * PKT_RS_SIZE);
         uint8_t* buf = buffer.data();
         for (size_t i = 0; i < packet_count; ++i) {
             ::memcpy(buf, pkt++, PKT_SIZE);
+            ::memset(buf + PKT_SIZE, 0, RS_SIZE);
             buf += PKT_SIZE + RS_SIZE;
         }
-        status = sendDatagram(buffer.data(), buffer.size());
+        status = emitDatagram(buffer.data(), buffer.size());
     }
     else {
         // No RTP, send TS packets directly as datagram.
-        status = sendDatagram(pkt, packet_count * PKT_SIZE);
+        status = emitDatagram(pkt, packet_count * PKT_SIZE);
     }
 
     // Count packets datagram per datagram.
@@ -374,3 +405,49 @@ bool ts::AbstractDatagramOutputPlugin::sendPackets(const TSPacket* pkt, size_t p
 
     return status;
 }
+
+
+//----------------------------------------------------------------------------
+// Send a datagram or queue it in the current batch.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramOutputPlugin::emitDatagram(const void* address, size_t size)
+{
+    if (_batch <= 1) {
+        // No batch, send datagram immediately.
+        return sendDatagram(address, size);
+    }
+    else {
+        // Queue the datagram, send the batch when full.
+        assert(_dgram_count < _batch);
+        _dgram_addresses[_dgram_count] = address;
+        _dgram_sizes[_dgram_count] = size;
+        return ++_dgram_count < _batch || flushDatagrams();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Send all datagrams in the current batch.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramOutputPlugin::flushDatagrams()
+{
+    const size_t count = _dgram_count;
+    _dgram_count = 0;
+    return count == 0 || sendDatagrams(_dgram_addresses.data(), _dgram_sizes.data(), count);
+}
+
+
+//----------------------------------------------------------------------------
+// Default implementation of batched send: one datagram at a time.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramOutputPlugin::sendDatagrams(const void* const* addresses, const size_t* sizes, size_t count)
+{
+    bool ok = true;
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = sendDatagram(addresses[i], sizes[i]);
+    }
+    return ok;
+}
@@ -64,6 +64,11 @@ namespace ts {
         //!
         static constexpr size_t MAX_PACKET_BURST = 128;
 
+        //!
+        //! Maximum number of datagrams to send in one operation (option -\-batch).
+        //!
+        static constexpr size_t MAX_DATAGRAM_BATCH = 64;
+
     protected:
         //!
         //! Options which alter the behavior of the output plugin.
@@ -71,7 +76,8 @@ namespace ts {
         //!
         enum Options {
             NONE      = 0x0000,  //!< No option.
-            ALLOW_RTP = 0x0001,  //!< Allow RTP options to build an RTP datagram.
+            ALLOW_RTP   = 0x0001,  //!< Allow RTP options to build an RTP datagram.
+            ALLOW_BATCH = 0x0002,  //!< Allow option -\-batch, the subclass should override sendDatagrams().
         };
 
         //!
@@ -98,6 +104,16 @@ namespace ts {
         //!
         virtual bool sendDatagram(const void* address, size_t size) = 0;
 
+        //!
+        //! Send several datagram messages in one operation.
+        //! The default implementation sends the datagrams one by one using sendDatagram().
+        //! @param [in] addresses Array of @a count addresses of datagrams.
+        //! @param [in] sizes Array of @a count sizes in bytes of datagrams.
+        //! @param [in] count Number of datagrams to send.
+        //! @return True on success, false on error.
+        //!
+        virtual bool sendDatagrams(const void* const* addresses, const size_t* sizes, size_t count);
+
     private:
         // Configuration and command line options.
         const Options  _flags;              // Configuration flags.
@@ -111,6 +127,7 @@ namespace ts {
         uint32_t       _rtp_user_ssrc;      // RTP user-specified SSRC id
         PID            _pcr_user_pid;       // User-specified PCR PID.
         bool           _rs204_format;       // Use 204-byte format with Reed Solomon placeholder.
+        size_t         _batch;              // Max number of datagrams per send operation.
 
         // Working data.
         uint16_t       _rtp_sequence;       // RTP current sequence number
@@ -123,8 +140,18 @@ namespace ts {
         PacketCounter  _pkt_count;          // Total packet counter for output packets
         size_t         _out_count;          // Number of packets in _out_buffer
         TSPacketVector _out_buffer;         // Buffered packets for output with --enforce-burst
+        size_t         _dgram_count;        // Number of datagrams waiting to be sent in a batch
+        std::vector<ByteBlock>   _dgram_buffers;    // Datagram buffers when the datagrams must be built
+        std::vector<const void*> _dgram_addresses;  // Address of datagrams waiting to be sent
+        std::vector<size_t>      _dgram_sizes;      // Size of datagrams waiting to be sent
 
         // Send a buffer of TS packets.
         bool sendPackets(const TSPacket* packet, size_t count);
+
+        // Send a datagram or queue it in the current batch.
+        bool emitDatagram(const void* address, size_t size);
+
+        // Send all datagrams in the current batch.
+        bool flushDatagrams();
     };
 }
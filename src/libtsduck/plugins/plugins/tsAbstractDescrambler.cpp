@@ -190,6 +190,8 @@ bool ts::AbstractDescrambler::start()
     _demux.reset();
 
     // Initialize the scrambling engine.
+    // DVB-CSA2 payloads are descrambled in one pass at the end of each batch of packets.
+    _scrambling.setBatchMode(true);
     if (!_scrambling.start()) {
         return false;
     }
@@ -596,3 +598,28 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     // Descramble the packet payload.
     return pecm->scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDescrambler::usePacketBatches()
+{
+    return true;
+}
+
+size_t ts::AbstractDescrambler::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    size_t i = 0;
+    while (i < count && SetPacketStatus(pkt_data[i], processPacket(pkt[i], pkt_data[i]))) {
+        i++;
+    }
+
+    // Descramble the payloads of all packets in the batch, using fixed control words or ECM streams.
+    bool ok = _scrambling.flushBatch();
+    for (auto it = _ecm_streams.begin(); it != _ecm_streams.end(); ++it) {
+        ok = it->second->scrambling.flushBatch() && ok;
+    }
+    return ok ? i : 0;
+}
@@ -62,6 +62,8 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool usePacketBatches() override;
+        virtual size_t processPackets(TSPacket*, TSPacketMetadata*, size_t) override;
 
     protected:
         //!
@@ -29,6 +29,7 @@
 
 #include "tsFileInputPlugin.h"
 #include "tsPluginRepository.h"
+#include "tsTSFileIndex.h"
 #include "tsAlgorithm.h"
 
 TS_REGISTER_INPUT_PLUGIN(u"file", ts::FileInputPlugin);
@@ -43,12 +44,15 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
     _aborted(true),
     _interleave(false),
     _first_terminate(false),
+    _memory_map(false),
     _interleave_chunk(0),
     _interleave_remain(0),
     _current_filename(0),
     _current_file(0),
     _repeat_count(1),
     _start_offset(0),
+    _start_pcr(INVALID_PCR),
+    _start_time(Time::Epoch),
     _base_label(0),
     _file_format(TSPacketFormat::AUTODETECT),
     _filenames(),
@@ -111,11 +115,36 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
          u"For a given file, if the computed label is above the maximum (" +
          UString::Decimal(TSPacketMetadata::LABEL_MAX) + u"), its packets are not labelled.");
 
+    option(u"memory-map");
+    help(u"memory-map",
+         u"Read regular files using memory mapping instead of read operations. "
+         u"This is usually faster on large files, especially in M2TS and other "
+         u"formats with packet headers. Ignored on non-regular files (pipes, devices) "
+         u"and on Windows. Do not use this option on files which may be truncated "
+         u"while being read.");
+
     option(u"packet-offset", 'p', UNSIGNED);
     help(u"packet-offset",
          u"Start reading each file at the specified TS packet (default: 0). "
          u"This option is allowed only if all input files are regular files.");
 
+    option(u"start-pcr", 0, UNSIGNED);
+    help(u"start-pcr",
+         u"Start reading each file at the specified PCR value. "
+         u"The file is positioned on the last index point (preferably a key frame on the "
+         u"first PID with PCR's) before the first packet with a greater PCR. "
+         u"The index of the file is read from a sidecar file with the same name as the "
+         u"input file and an additional \"" + UString(TSFileIndex::SIDECAR_SUFFIX) + u"\" suffix. "
+         u"If this sidecar file does not exist or is outdated, the index is built by reading "
+         u"the whole file once and saved in the sidecar file, when possible. "
+         u"This option is allowed only if all input files are regular files.");
+
+    option(u"start-time", 0, STRING);
+    help(u"start-time", u"year/month/day:hour:minute:second",
+         u"Start reading each file at the specified UTC time, as broadcast in the TDT or TOT. "
+         u"The time of each index point is estimated from the last TDT or TOT and the PCR. "
+         u"See option --start-pcr for the management of the file index.");
+
     option(u"repeat", 'r', POSITIVE);
     help(u"repeat",
          u"Repeat the playout of each file the specified number of times (default: only once). "
@@ -135,11 +164,19 @@ bool ts::FileInputPlugin::getOptions()
     _start_offset = intValue<uint64_t>(u"byte-offset", intValue<uint64_t>(u"packet-offset", 0) * PKT_SIZE);
     _interleave = present(u"interleave");
     _first_terminate = present(u"first-terminate");
+    _memory_map = present(u"memory-map");
     getIntValue(_interleave_chunk, u"interleave", 1);
     getIntValue(_base_label, u"label-base", TSPacketMetadata::LABEL_MAX + 1);
     getIntValues(_start_stuffing, u"add-start-stuffing");
     getIntValues(_stop_stuffing, u"add-stop-stuffing");
     _file_format = LoadTSPacketFormatInputOption(*this);
+    getIntValue(_start_pcr, u"start-pcr", INVALID_PCR);
+    _start_time = Time::Epoch;
+    const UString start_time(value(u"start-time"));
+    if (!start_time.empty() && !_start_time.decode(start_time)) {
+        tsp->error(u"invalid --start-time value \"%s\" (use \"year/month/day:hour:minute:second\")", {start_time});
+        return false;
+    }
 
     // If there is no file, then this is the standard input, an empty file name.
     if (_filenames.empty()) {
@@ -158,6 +195,10 @@ bool ts::FileInputPlugin::getOptions()
         tsp->error(u"specifying --infinite is meaningless with more than one file");
         return false;
     }
+    if (int(present(u"byte-offset")) + int(present(u"packet-offset")) + int(present(u"start-pcr")) + int(present(u"start-time")) > 1) {
+        tsp->error(u"options --byte-offset, --packet-offset, --start-pcr, --start-time are mutually exclusive");
+        return false;
+    }
 
     // Make sure start and stop stuffing vectors have the same size as the file vector.
     // If the vectors must be enlarged, repeat the last value in the array.
@@ -186,9 +227,48 @@ bool ts::FileInputPlugin::openFile(size_t name_index, size_t file_index)
 
     // Preset artificial stuffing.
     _files[file_index].setStuffing(_start_stuffing[name_index], _stop_stuffing[name_index]);
+    _files[file_index].setMemoryMapped(_memory_map);
+
+    // Compute the start offset from the file index, if necessary.
+    uint64_t start_offset = _start_offset;
+    if ((_start_pcr != INVALID_PCR || _start_time != Time::Epoch) && !indexedStartOffset(name, start_offset)) {
+        return false;
+    }
 
     // Actually open the file.
-    return _files[file_index].openRead(name, _repeat_count, _start_offset, *tsp, _file_format);
+    return _files[file_index].openRead(name, _repeat_count, start_offset, *tsp, _file_format);
+}
+
+
+//----------------------------------------------------------------------------
+// Compute the start offset of a file using its index.
+//----------------------------------------------------------------------------
+
+bool ts::FileInputPlugin::indexedStartOffset(const UString& name, uint64_t& offset)
+{
+    if (name.empty()) {
+        tsp->error(u"options --start-pcr and --start-time cannot be used on the standard input");
+        return false;
+    }
+
+    TSFileIndex index;
+    TSFileIndex::Entry entry;
+    if (!index.loadOrBuild(name, *tsp, _file_format)) {
+        return false;
+    }
+    else if (_start_pcr != INVALID_PCR && !index.findPCR(_start_pcr, entry)) {
+        tsp->error(u"PCR %'d not found in %s", {_start_pcr, name});
+        return false;
+    }
+    else if (_start_time != Time::Epoch && !index.findTime(_start_time, entry)) {
+        tsp->error(u"time %s not found in %s", {_start_time.format(Time::DATETIME), name});
+        return false;
+    }
+    else {
+        offset = index.byteOffset(entry);
+        tsp->verbose(u"starting %s at packet %'d, offset %'d", {name, entry.packet, offset});
+        return true;
+    }
 }
 
 
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsInputPlugin.h"
 #include "tsTSFile.h"
+#include "tsTime.h"
 
 namespace ts {
     //!
@@ -62,12 +63,15 @@ namespace ts {
         volatile bool  _aborted;            // Set when abortInput() is set.
         bool           _interleave;         // Read all files simultaneously with interleaving.
         bool           _first_terminate;    // With _interleave, terminate when the first file terminates.
+        bool           _memory_map;         // Use memory-mapped input on regular files.
         size_t         _interleave_chunk;   // Number of packets per chunk when _interleave.
         size_t         _interleave_remain;  // Remaining packets to read in current chunk of current file.
         size_t         _current_filename;   // Current file index in _filenames.
         size_t         _current_file;       // Current file index in _files. Depends on _interleave.
         size_t         _repeat_count;
         uint64_t       _start_offset;
+        uint64_t       _start_pcr;          // Start at this PCR using the file index (INVALID_PCR if none).
+        Time           _start_time;         // Start at this UTC time using the file index (Epoch if none).
         size_t         _base_label;
         TSPacketFormat _file_format;
         UStringVector  _filenames;
@@ -79,6 +83,9 @@ namespace ts {
         // Open one input file.
         bool openFile(size_t name_index, size_t file_index);
 
+        // Compute the start offset of a file using its index.
+        bool indexedStartOffset(const UString& name, uint64_t& offset);
+
         // Close all files which are currently open.
         bool closeAllFiles();
     };
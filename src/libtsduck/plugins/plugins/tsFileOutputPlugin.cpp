@@ -54,6 +54,9 @@ ts::FileOutputPlugin::FileOutputPlugin(TSP* tsp_) :
     _max_size(0),
     _max_duration(0),
     _multiple_files(false),
+    _async_depth(0),
+    _async_buffer_size(TSFile::DEFAULT_ASYNC_BUFFER_SIZE),
+    _direct_io(false),
     _file(),
     _name_gen(),
     _current_size(0),
@@ -77,6 +80,27 @@ ts::FileOutputPlugin::FileOutputPlugin(TSP* tsp_) :
     option(u"append", 'a');
     help(u"append", u"If the file already exists, append to the end of the file. By default, existing files are overwritten.");
 
+    option(u"async-buffer-size", 0, INTEGER, 0, 1, 4096, 1024 * 1024 * 1024);
+    help(u"async-buffer-size", u"bytes",
+         u"With --async-depth, specify the size in bytes of each asynchronous write buffer. "
+         u"The size is rounded up to a multiple of 4096 bytes. "
+         u"The default is " + UString::Decimal(TSFile::DEFAULT_ASYNC_BUFFER_SIZE) + u" bytes.");
+
+    option(u"async-depth", 0, POSITIVE);
+    help(u"async-depth", u"count",
+         u"Use asynchronous write mode. The packets are copied into large buffers which are written by a separate thread. "
+         u"The value is the maximum number of filled buffers which are queued for write. "
+         u"The packet processing chain is blocked only when all buffers are queued, i.e. when the disk is durably too slow. "
+         u"This smoothes the latency spikes of the storage when recording a live stream. "
+         u"Statistics on the write operations are displayed in verbose mode. "
+         u"Not applicable on standard output.");
+
+    option(u"direct-io");
+    help(u"direct-io",
+         u"With --async-depth, bypass the system file cache (O_DIRECT). "
+         u"This avoids the accumulation of dirty pages in memory when recording very large streams. "
+         u"Silently ignored when not supported by the operating system or the file system. Linux only.");
+
     option(u"keep", 'k');
     help(u"keep", u"Keep existing file (abort if the specified file already exists). By default, existing files are overwritten.");
 
@@ -134,6 +158,9 @@ bool ts::FileOutputPlugin::getOptions()
     getIntValue(_max_size, u"max-size", 0);
     getIntValue(_max_duration, u"max-duration", 0);
     _file_format = LoadTSPacketFormatOutputOption(*this);
+    getIntValue(_async_depth, u"async-depth", 0);
+    getIntValue(_async_buffer_size, u"async-buffer-size", TSFile::DEFAULT_ASYNC_BUFFER_SIZE);
+    _direct_io = present(u"direct-io");
     _multiple_files = _max_size > 0 || _max_duration > 0;
 
     _flags = TSFile::WRITE | TSFile::SHARED;
@@ -152,6 +179,10 @@ bool ts::FileOutputPlugin::getOptions()
         tsp->error(u"--max-duration and --max-size cannot be used on standard output");
         return false;
     }
+    if (_async_depth > 0 && (_name.empty() || _name == u"-")) {
+        tsp->error(u"--async-depth cannot be used on standard output");
+        return false;
+    }
 
     return true;
 }
@@ -171,6 +202,7 @@ bool ts::FileOutputPlugin::start()
     }
 
     _file.setStuffing(_start_stuffing, _stop_stuffing);
+    _file.setAsyncWrite(_async_depth, _async_buffer_size, _direct_io);
     size_t retry_allowed = _retry_max == 0 ? std::numeric_limits<size_t>::max() : _retry_max;
     return openAndRetry(false, retry_allowed);
 }
@@ -182,7 +214,20 @@ bool ts::FileOutputPlugin::start()
 
 bool ts::FileOutputPlugin::stop()
 {
-    return _file.close(*tsp);
+    const bool success = _file.close(*tsp);
+
+    // Report statistics of asynchronous write operations.
+    const TSFile::AsyncStatistics& stats(_file.asyncStatistics());
+    if (_async_depth > 0 && stats.writes > 0) {
+        const NanoSecond us = NanoSecPerMicroSec;
+        tsp->verbose(u"asynchronous write: %'d bytes in %'d writes, %'d MB/s, average write time: %'d us, max: %'d us",
+                     {stats.bytes, stats.writes,
+                      stats.write_time <= 0 ? 0 : (stats.bytes * 1000) / uint64_t(stats.write_time),
+                      stats.write_time / NanoSecond(stats.writes) / us, stats.max_write_time / us});
+        tsp->verbose(u"asynchronous write: max queued buffers: %d/%d, %'d stalls, total stall time: %'d ms",
+                     {stats.max_queued, _async_depth, stats.stalls, stats.stall_time / NanoSecPerMilliSec});
+    }
+    return success;
 }
 
 
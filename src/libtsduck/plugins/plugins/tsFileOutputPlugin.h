@@ -71,6 +71,9 @@ namespace ts {
         uint64_t          _max_size;
         Second            _max_duration;
         bool              _multiple_files;
+        size_t            _async_depth;
+        size_t            _async_buffer_size;
+        bool              _direct_io;
 
         // Working data:
         TSFile            _file;
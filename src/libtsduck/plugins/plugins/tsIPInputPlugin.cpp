@@ -42,8 +42,10 @@ TS_REGISTER_INPUT_PLUGIN(u"ip", ts::IPInputPlugin);
 ts::IPInputPlugin::IPInputPlugin(TSP* tsp_) :
     AbstractDatagramInputPlugin(tsp_, IP_MAX_PACKET_SIZE, u"Receive TS packets from UDP/IP, multicast or unicast", u"[options] [address:]port",
                                 u"kernel", u"A kernel-provided time-stamp for the packet, when available (Linux only)",
-                                true), // real-time network reception
-    _sock(*tsp_)
+                                true,  // real-time network reception
+                                true), // allow batched reception
+    _sock(*tsp_),
+    _recv_buffers()
 {
     // Add UDP receiver common options.
     _sock.defineArgs(*this);
@@ -118,3 +120,33 @@ bool ts::IPInputPlugin::receiveDatagram(uint8_t* buffer, size_t buffer_size, siz
     IPv4SocketAddress destination;
     return _sock.receive(buffer, buffer_size, ret_size, sender, destination, tsp, *tsp, &timestamp);
 }
+
+
+//----------------------------------------------------------------------------
+// Batched datagram reception method.
+//----------------------------------------------------------------------------
+
+bool ts::IPInputPlugin::receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps)
+{
+    // Use the simple reception method when possible.
+    if (max_count <= 1) {
+        return AbstractDatagramInputPlugin::receiveDatagrams(buffer, buffer_size, max_count, ret_count, ret_sizes, timestamps);
+    }
+
+    // Describe the reception areas in the input buffer.
+    _recv_buffers.resize(max_count);
+    for (size_t i = 0; i < max_count; ++i) {
+        _recv_buffers[i].data = buffer + i * buffer_size;
+        _recv_buffers[i].max_size = buffer_size;
+    }
+
+    // Receive as many datagrams as possible.
+    if (!_sock.receiveBatch(_recv_buffers.data(), max_count, ret_count, tsp, *tsp)) {
+        return false;
+    }
+    for (size_t i = 0; i < ret_count; ++i) {
+        ret_sizes[i] = _recv_buffers[i].size;
+        timestamps[i] = _recv_buffers[i].timestamp;
+    }
+    return true;
+}
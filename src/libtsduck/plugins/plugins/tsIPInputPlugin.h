@@ -61,8 +61,10 @@ namespace ts {
     protected:
         // Implementation of AbstractDatagramInputPlugin.
         virtual bool receiveDatagram(uint8_t* buffer, size_t buffer_size, size_t& ret_size, MicroSecond& timestamp) override;
+        virtual bool receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t& ret_count, size_t* ret_sizes, MicroSecond* timestamps) override;
 
     private:
-        UDPReceiver _sock; // Incoming socket with associated command line options.
+        UDPReceiver _sock;   // Incoming socket with associated command line options.
+        std::vector<UDPSocket::ReceiveBuffer> _recv_buffers;  // Reception buffers for batched reception.
     };
 }
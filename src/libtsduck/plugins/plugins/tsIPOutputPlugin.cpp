@@ -39,14 +39,16 @@ TS_REGISTER_OUTPUT_PLUGIN(u"ip", ts::IPOutputPlugin);
 //----------------------------------------------------------------------------
 
 ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
-    AbstractDatagramOutputPlugin(tsp_, u"Send TS packets using UDP/IP, multicast or unicast", u"[options] address:port", ALLOW_RTP),
+    AbstractDatagramOutputPlugin(tsp_, u"Send TS packets using UDP/IP, multicast or unicast", u"[options] address:port", Options(ALLOW_RTP | ALLOW_BATCH)),
     _destination(),
     _local_addr(),
     _local_port(IPv4SocketAddress::AnyPort),
     _ttl(0),
     _tos(-1),
     _force_mc_local(false),
-    _sock(false, *tsp_)
+    _use_gso(false),
+    _sock(false, *tsp_),
+    _gso_buffer()
 {
     option(u"", 0, STRING, 1, 1);
     help(u"",
@@ -65,6 +67,13 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
          u"declared, this option may transport multicast IP packets in unicast Ethernet frames "
          u"to the gateway, preventing multicast reception on the local network (seen on Linux).");
 
+    option(u"gso");
+    help(u"gso",
+         u"Use the generic segmentation offload (GSO) on the UDP socket (Linux only). "
+         u"The datagrams of a batch (see option --batch) are passed to the system as one single large buffer "
+         u"which is split into datagrams by the kernel or the network interface. "
+         u"This option is useless without --batch.");
+
     option(u"local-address", 'l', STRING);
     help(u"local-address",
          u"When the destination is a multicast address, specify the IP address "
@@ -122,6 +131,10 @@ bool ts::IPOutputPlugin::getOptions()
     getIntValue(_ttl, u"ttl", 0);
     getIntValue(_tos, u"tos", -1);
     _force_mc_local = present(u"force-local-multicast-outgoing");
+    _use_gso = present(u"gso");
+    if (_use_gso && !present(u"batch")) {
+        tsp->warning(u"--gso is useless without --batch");
+    }
     setRS204Format(present(u"rs204"));
 
     return success;
@@ -176,3 +189,53 @@ bool ts::IPOutputPlugin::sendDatagram(const void* address, size_t size)
 {
     return _sock.send(address, size, *tsp);
 }
+
+
+//----------------------------------------------------------------------------
+// Implementation of AbstractDatagramOutputPlugin: send several datagrams.
+//----------------------------------------------------------------------------
+
+bool ts::IPOutputPlugin::sendDatagrams(const void* const* addresses, const size_t* sizes, size_t count)
+{
+    if (!_use_gso) {
+        return _sock.sendBatch(addresses, sizes, count, *tsp);
+    }
+
+    // With segmentation offload, group consecutive datagrams of identical size.
+    // The last datagram in a group may be shorter.
+    bool ok = true;
+    size_t first = 0;
+    while (ok && first < count) {
+
+        // Locate the end of the group. Check if the datagrams are contiguous in memory.
+        const size_t segment_size = sizes[first];
+        size_t total_size = segment_size;
+        size_t end = first + 1;
+        bool contiguous = true;
+        while (end < count && end - first < UDPSocket::MAX_SEGMENTS && sizes[end - 1] == segment_size && sizes[end] <= segment_size) {
+            contiguous = contiguous && addresses[end] == reinterpret_cast<const uint8_t*>(addresses[end - 1]) + segment_size;
+            total_size += sizes[end++];
+        }
+
+        if (end == first + 1) {
+            // Only one datagram.
+            ok = _sock.send(addresses[first], segment_size, *tsp);
+        }
+        else if (contiguous) {
+            // Directly send the datagrams from their original memory.
+            ok = _sock.sendSegments(addresses[first], total_size, segment_size, *tsp);
+        }
+        else {
+            // Build a large buffer with all datagrams.
+            _gso_buffer.resize(total_size);
+            uint8_t* data = _gso_buffer.data();
+            for (size_t i = first; i < end; ++i) {
+                ::memcpy(data, addresses[i], sizes[i]);
+                data += sizes[i];
+            }
+            ok = _sock.sendSegments(_gso_buffer.data(), total_size, segment_size, *tsp);
+        }
+        first = end;
+    }
+    return ok;
+}
@@ -60,6 +60,7 @@ namespace ts {
     protected:
         // Implementation of AbstractDatagramOutputPlugin
         virtual bool sendDatagram(const void* address, size_t size) override;
+        virtual bool sendDatagrams(const void* const* addresses, const size_t* sizes, size_t count) override;
 
     private:
         IPv4SocketAddress _destination;     // Destination address/port.
@@ -68,6 +69,8 @@ namespace ts {
         int               _ttl;             // Time to live option.
         int               _tos;             // Type of service option.
         bool              _force_mc_local;  // Force multicast outgoing local interface
+        bool              _use_gso;         // Use generic segmentation offload
         UDPSocket         _sock;            // Outgoing socket
+        ByteBlock         _gso_buffer;      // Buffer to build non-contiguous datagrams for segmentation offload
     };
 }
@@ -78,6 +78,37 @@ ts::ProcessorPlugin::Status ts::ProcessorPlugin::processPacket(TSPacket& pkt, TS
     return TSP_OK;
 }
 
+bool ts::ProcessorPlugin::usePacketBatches()
+{
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Default implementation of packet batch processing interface.
+//----------------------------------------------------------------------------
+
+size_t ts::ProcessorPlugin::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    // The default implementation calls processPacket() for each packet.
+    // Same dirty hack as processPacketWindow() on the packet counters.
+    const PacketCounter saved_total_packets = tsp->_total_packets;
+    const PacketCounter saved_plugin_packets = tsp->_plugin_packets;
+
+    size_t processed_packets = 0;
+    while (processed_packets < count && SetPacketStatus(pkt_data[processed_packets], processPacket(pkt[processed_packets], pkt_data[processed_packets]))) {
+        tsp->_plugin_packets++;
+        tsp->_total_packets++;
+        processed_packets++;
+    }
+
+    // Restore hacked values.
+    tsp->_total_packets = saved_total_packets;
+    tsp->_plugin_packets = saved_plugin_packets;
+
+    return processed_packets;
+}
+
 
 //----------------------------------------------------------------------------
 // Default implementations of packet window processing interface.
@@ -93,6 +93,13 @@ namespace ts {
     //! sizes is larger than the size of the global buffer, the stream processing can enter a deadlock and
     //! stops. The global @c tsp command shall be carefully tuned to avoid that.
     //!
+    //! A variant of the "packet method" is the "packet batch method". Simple high-volume plugins can
+    //! override ProcessorPlugin::usePacketBatches() to return true and override ProcessorPlugin::processPackets().
+    //! The application then invokes processPackets() with contiguous ranges of packets, as they are
+    //! found in the global buffer, without the scatter / gather overhead of the "packet window method".
+    //! The plugin processes all packets in a tight loop, without one virtual call per packet. The
+    //! processing status of each packet is set in its metadata.
+    //!
     class TSDUCKDLL ProcessorPlugin : public Plugin
     {
         TS_NOBUILD_NOCOPY(ProcessorPlugin);
@@ -153,6 +160,46 @@ namespace ts {
         //!
         virtual size_t processPacketWindow(TSPacketWindow& win);
 
+        //!
+        //! Check if the plugin prefers to use the "packet batch" processing method.
+        //!
+        //! This method is called once by the application after start() but before processing any packet.
+        //! If the plugin returns a non-zero value from getPacketWindowSize(), the "packet window" method
+        //! is used and this method is ignored.
+        //!
+        //! @return True if the plugin prefers to process contiguous batches of packets using processPackets().
+        //! If this method is not overriden, the default implementation returns false.
+        //!
+        virtual bool usePacketBatches();
+
+        //!
+        //! Packet batch processing interface.
+        //!
+        //! The main application invokes processPackets() to let the plugin process a contiguous
+        //! batch of TS packets. All packets in the batch shall be processed by the plugin: the
+        //! packets which were previously dropped or which are excluded by -\-only-label are never
+        //! part of a batch.
+        //!
+        //! Dropping or nullifying a packet is achieved by calling setDropRequested() or
+        //! setNullRequested() on its metadata. The other metadata (flush, bitrate change, labels)
+        //! are set as in processPacket().
+        //!
+        //! During the processing of a batch, the value of @c tsp->pluginPackets() is the number
+        //! of packets which were processed before the first packet of the batch. The index of
+        //! packet @a i in the batch is consequently <code>tsp->pluginPackets() + i</code>.
+        //!
+        //! If this method is not overriden, the default implementation calls processPacket()
+        //! for each packet.
+        //!
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [in,out] pkt_data Address of the metadata of the first TS packet to process.
+        //! @param [in] count Number of packets to process.
+        //! @return Number of processed packets. When the returned value is less than @a count,
+        //! the packet processing is terminated after the specified number of packets. This is
+        //! the equivalent of processPacket() returning TSP_END on the next packet.
+        //!
+        virtual size_t processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count);
+
         //!
         //! Get the content of the --only-label options.
         //! The value of the option is fetched each time this method is called.
@@ -172,5 +219,20 @@ namespace ts {
         //! @param [in] syntax A short one-line syntax summary, eg. "[options] filename ...".
         //!
         ProcessorPlugin(TSP* tsp_, const UString& description = UString(), const UString& syntax = UString());
+
+        //!
+        //! Record the processing status of one packet in its metadata, in the "packet batch" method.
+        //! This is a helper for subclasses which implement processPackets().
+        //! @param [in,out] pkt_data TS packet metadata.
+        //! @param [in] status The processing status of the packet, as returned by processPacket().
+        //! @return False if @a status is TSP_END (the processing of the batch shall stop before
+        //! this packet), true otherwise.
+        //!
+        static bool SetPacketStatus(TSPacketMetadata& pkt_data, Status status)
+        {
+            pkt_data.setDropRequested(status == TSP_DROP);
+            pkt_data.setNullRequested(status == TSP_NULL);
+            return status != TSP_END;
+        }
     };
 }
@@ -56,8 +56,13 @@ ts::hls::InputPlugin::InputPlugin(TSP* tsp_) :
     _lowestRes(false),
     _highestRes(false),
     _maxSegmentCount(0),
+    _prefetchDepth(0),
+    _saveDirectory(),
     _segmentCount(0),
-    _playlist()
+    _playlist(),
+    _prefetcher(*tsp),
+    _segmentData(),
+    _segmentOffset(0)
 {
     option(u"", 0, STRING, 1, 1);
     help(u"",
@@ -118,6 +123,14 @@ ts::hls::InputPlugin::InputPlugin(TSP* tsp_) :
          u"When the URL is a master playlist, select a content the resolution of which has a "
          u"lower height than the specified maximum.");
 
+    option(u"prefetch", 0, POSITIVE);
+    help(u"prefetch", u"count",
+         u"Download up to the specified number of media segments concurrently, ahead of their use. "
+         u"The downloaded segments are kept in memory and passed to the next plugin in playlist order. "
+         u"Live playlists are reloaded in parallel with the downloads of segments. "
+         u"This can avoid input underruns when the server has a long latency for each request. "
+         u"By default, the media segments are sequentially downloaded and streamed, one at a time.");
+
     option(u"save-files", 0, DIRECTORY);
     help(u"save-files",
          u"Specify a directory where all downloaded files, media segments and playlists, are saved "
@@ -163,8 +176,9 @@ bool ts::hls::InputPlugin::isRealTime()
 bool ts::hls::InputPlugin::getOptions()
 {
     _url.setURL(value(u""));
-    const UString saveDirectory(value(u"save-files"));
+    getValue(_saveDirectory, u"save-files");
     getIntValue(_maxSegmentCount, u"segment-count");
+    getIntValue(_prefetchDepth, u"prefetch", 0);
     getValue(_minRate, u"min-bitrate");
     getValue(_maxRate, u"max-bitrate");
     getIntValue(_minWidth, u"min-width");
@@ -213,8 +227,8 @@ bool ts::hls::InputPlugin::getOptions()
     }
 
     // Automatically save media segments and playlists.
-    setAutoSaveDirectory(saveDirectory);
-    _playlist.setAutoSaveDirectory(saveDirectory);
+    setAutoSaveDirectory(_saveDirectory);
+    _playlist.setAutoSaveDirectory(_saveDirectory);
 
     return true;
 }
@@ -331,9 +345,16 @@ bool ts::hls::InputPlugin::start()
     }
 
     _segmentCount = 0;
+    _segmentData.clear();
+    _segmentOffset = 0;
 
-    // Invoke superclass.
-    return AbstractHTTPInputPlugin::start();
+    // With --prefetch, the segments are downloaded by the prefetcher. Otherwise, invoke superclass.
+    if (_prefetchDepth > 0) {
+        return _prefetcher.start(_playlist, webArgs, _prefetchDepth, _maxSegmentCount);
+    }
+    else {
+        return AbstractHTTPInputPlugin::start();
+    }
 }
 
 
@@ -343,11 +364,82 @@ bool ts::hls::InputPlugin::start()
 
 bool ts::hls::InputPlugin::stop()
 {
-    // Invoke superclass first.
-    const bool stopped = AbstractHTTPInputPlugin::stop();
+    if (_prefetchDepth > 0) {
+        // Stop all downloads first.
+        _prefetcher.stop();
+        _segmentData.clear();
+
+        const SegmentPrefetcher::Statistics stats(_prefetcher.statistics());
+        tsp->verbose(u"prefetch: %'d segments, %'d bytes, %'d failed, %'d playlist reloads, max concurrent downloads: %d/%d, max ready segments: %d",
+                     {stats.segments, stats.bytes, stats.failures, stats.reloads, stats.max_active, _prefetchDepth, stats.max_ready});
+        tsp->verbose(u"prefetch: %'d input stalls, total stall time: %'d ms, average download time: %'d ms",
+                     {stats.stalls, stats.stall_time / NanoSecPerMilliSec,
+                      stats.segments + stats.failures == 0 ? 0 : stats.download_time / NanoSecPerMilliSec / NanoSecond(stats.segments + stats.failures)});
+
+        // Then delete the cookie file, which was used by the prefetcher only.
+        return !FileExists(webArgs.cookiesFile) || DeleteFile(webArgs.cookiesFile, *tsp);
+    }
+    else {
+        // Invoke superclass first.
+        const bool stopped = AbstractHTTPInputPlugin::stop();
+
+        // Then delete the cookie file. Must be done after complete stop to avoid recreation.
+        return deleteCookiesFile() && stopped;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Abort the input operation currently in progress.
+//----------------------------------------------------------------------------
+
+bool ts::hls::InputPlugin::abortInput()
+{
+    if (_prefetchDepth > 0) {
+        _prefetcher.abort();
+        return true;
+    }
+    else {
+        return AbstractHTTPInputPlugin::abortInput();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Input method
+//----------------------------------------------------------------------------
+
+size_t ts::hls::InputPlugin::receive(TSPacket* buffer, TSPacketMetadata* metadata, size_t maxPackets)
+{
+    // Without --prefetch, the segments are streamed by the superclass.
+    if (_prefetchDepth == 0) {
+        return AbstractHTTPInputPlugin::receive(buffer, metadata, maxPackets);
+    }
+
+    // Get next segment from the prefetcher when the current one is exhausted.
+    // A trailing partial packet at end of segment is dropped, as in streaming mode.
+    while (_segmentOffset + PKT_SIZE > _segmentData.size()) {
+        UString url;
+        if (tsp->aborting() || !_prefetcher.getNextSegment(_segmentData, url)) {
+            return 0;
+        }
+        _segmentOffset = 0;
+        tsp->verbose(u"received segment %s, %'d bytes", {url, _segmentData.size()});
+
+        // Save the segment when required. Display errors but do not fail, this is just auto save.
+        UString name(BaseName(URL(url).getPath()));
+        if (!_saveDirectory.empty() && !name.empty()) {
+            name = _saveDirectory + PathSeparator + name;
+            tsp->verbose(u"saving input TS to %s", {name});
+            _segmentData.saveToFile(name, tsp);
+        }
+    }
 
-    // Then delete the cookie file. Must be done after complete stop to avoid recreation.
-    return deleteCookiesFile() && stopped;
+    // Copy as many packets as possible from the current segment.
+    const size_t count = std::min(maxPackets, (_segmentData.size() - _segmentOffset) / PKT_SIZE);
+    ::memcpy(buffer->b, _segmentData.data() + _segmentOffset, count * PKT_SIZE);
+    _segmentOffset += count * PKT_SIZE;
+    return count;
 }
 
 
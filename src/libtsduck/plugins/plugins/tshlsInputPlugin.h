@@ -35,6 +35,7 @@
 #pragma once
 #include "tsAbstractHTTPInputPlugin.h"
 #include "tshlsPlayList.h"
+#include "tshlsSegmentPrefetcher.h"
 #include "tsURL.h"
 
 namespace ts {
@@ -61,6 +62,8 @@ namespace ts {
             virtual bool start() override;
             virtual bool stop() override;
             virtual bool isRealTime() override;
+            virtual bool abortInput() override;
+            virtual size_t receive(TSPacket*, TSPacketMetadata*, size_t) override;
 
         protected:
             // Implementation of AbstractHTTPInputPlugin
@@ -82,10 +85,17 @@ namespace ts {
             bool     _lowestRes;
             bool     _highestRes;
             size_t   _maxSegmentCount;
+            size_t   _prefetchDepth;
+            UString  _saveDirectory;
 
             // Working data:
             size_t   _segmentCount;
             PlayList _playlist;
+
+            // Working data with --prefetch:
+            SegmentPrefetcher _prefetcher;     // Concurrent download of segments.
+            ByteBlock         _segmentData;    // Content of current segment.
+            size_t            _segmentOffset;  // Offset of next packet in current segment.
         };
     }
 }
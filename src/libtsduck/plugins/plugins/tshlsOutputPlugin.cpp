@@ -34,6 +34,11 @@
 #include "tsPESPacket.h"
 #include "tsPAT.h"
 #include "tsPMT.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuardCondition.h"
+#include "tsMonotonic.h"
 
 TS_REGISTER_OUTPUT_PLUGIN(u"hls", ts::hls::OutputPlugin);
 
@@ -42,10 +47,159 @@ TS_REGISTER_OUTPUT_PLUGIN(u"hls", ts::hls::OutputPlugin);
 #define DEFAULT_EXTRA_DURATION     2  // Default segment extra duration when intra image is not found.
 
 
+//----------------------------------------------------------------------------
+// Background writer of completed segments.
+//----------------------------------------------------------------------------
+
+//! @cond nodoxygen
+class ts::hls::OutputPlugin::Writer: public Thread
+{
+    TS_NOBUILD_NOCOPY(Writer);
+public:
+    Writer(OutputPlugin& plugin, size_t depth);
+    virtual ~Writer() override;
+
+    // Queue a completed segment. Wait when the queue is full.
+    // Return false if a previous segment could not be published.
+    bool push(const CompletedSegment& seg);
+
+    // Publish all queued segments and terminate the thread.
+    bool stop();
+
+private:
+    OutputPlugin&                _plugin;
+    const size_t                 _depth;           // Maximum number of queued segments.
+    Mutex                        _mutex;           // Protect the fields below.
+    Condition                    _queued;          // Signaled when a segment is queued or on termination.
+    Condition                    _published;       // Signaled when a segment is published.
+    std::deque<CompletedSegment> _queue;           // Queued segments.
+    bool                         _terminate;       // Terminate after publishing all queued segments.
+    bool                         _error;           // A segment could not be published.
+    uint64_t                     _segments;        // Number of published segments.
+    uint64_t                     _stalls;          // Number of times the output waited for a free slot in the queue.
+    size_t                       _maxQueued;       // Maximum number of queued segments.
+    NanoSecond                   _publishTime;     // Total time to publish segments.
+    NanoSecond                   _maxPublishTime;  // Maximum time to publish one segment.
+    NanoSecond                   _stallTime;       // Total time the output waited for a free slot in the queue.
+
+    virtual void main() override;
+};
+//! @endcond
+
+ts::hls::OutputPlugin::Writer::Writer(OutputPlugin& plugin, size_t depth) :
+    Thread(),
+    _plugin(plugin),
+    _depth(std::max<size_t>(depth, 1)),
+    _mutex(),
+    _queued(),
+    _published(),
+    _queue(),
+    _terminate(false),
+    _error(false),
+    _segments(0),
+    _stalls(0),
+    _maxQueued(0),
+    _publishTime(0),
+    _maxPublishTime(0),
+    _stallTime(0)
+{
+}
+
+ts::hls::OutputPlugin::Writer::~Writer()
+{
+    stop();
+}
+
+bool ts::hls::OutputPlugin::Writer::push(const CompletedSegment& seg)
+{
+    GuardCondition lock(_mutex, _published);
+
+    // Wait for a free slot in the queue.
+    if (_queue.size() >= _depth && !_error) {
+        const Monotonic start(true);
+        while (_queue.size() >= _depth && !_error) {
+            lock.waitCondition();
+        }
+        _stallTime += Monotonic(true) - start;
+        _stalls++;
+    }
+    if (_error) {
+        return false;
+    }
+
+    _queue.push_back(seg);
+    _maxQueued = std::max(_maxQueued, _queue.size());
+    _queued.signal();
+    return true;
+}
+
+bool ts::hls::OutputPlugin::Writer::stop()
+{
+    {
+        GuardCondition lock(_mutex, _queued);
+        if (_terminate) {
+            return !_error;
+        }
+        _terminate = true;
+        lock.signal();
+    }
+    waitForTermination();
+
+    const NanoSecond ms = NanoSecPerMilliSec;
+    _plugin.tsp->verbose(u"background writer: %'d segments, average publish time: %'d ms, max: %'d ms",
+                         {_segments, _segments == 0 ? 0 : _publishTime / NanoSecond(_segments) / ms, _maxPublishTime / ms});
+    _plugin.tsp->verbose(u"background writer: max queued segments: %d/%d, %'d stalls, total stall time: %'d ms",
+                         {_maxQueued, _depth, _stalls, _stallTime / ms});
+    return !_error;
+}
+
+void ts::hls::OutputPlugin::Writer::main()
+{
+    for (;;) {
+        CompletedSegment seg;
+
+        // Wait for a segment to publish or termination.
+        {
+            GuardCondition lock(_mutex, _queued);
+            while (_queue.empty() && !_terminate) {
+                lock.waitCondition();
+            }
+            if (_queue.empty()) {
+                break; // terminated, nothing left to publish
+            }
+            seg = _queue.front();
+            _queue.pop_front();
+        }
+
+        // Publish the segment without holding the mutex.
+        const Monotonic start(true);
+        const bool ok = _plugin.publishSegment(seg);
+        const NanoSecond duration = Monotonic(true) - start;
+
+        GuardCondition lock(_mutex, _published);
+        _segments++;
+        _publishTime += duration;
+        _maxPublishTime = std::max(_maxPublishTime, duration);
+        _error = _error || !ok;
+        lock.signal();
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Output constructor
 //----------------------------------------------------------------------------
 
+ts::hls::OutputPlugin::CompletedSegment::CompletedSegment() :
+    name(),
+    data(),
+    packets(0),
+    bitrate(0),
+    duration(0),
+    endOfStream(false)
+{
+}
+
 ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
     ts::OutputPlugin(tsp_, u"Generate HTTP Live Streaming (HLS) media", u"[options] filename"),
     _segmentTemplate(),
@@ -60,6 +214,8 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
     _fixedSegmentSize(0),
     _initialMediaSeq(0),
     _closeLabels(),
+    _asyncDepth(0),
+    _httpServer(),
     _nameGenerator(),
     _demux(duck, this),
     _patPackets(),
@@ -70,11 +226,17 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
     _segStarted(false),
     _segClosePending(false),
     _segmentFile(),
+    _inMemory(false),
+    _segmentName(),
+    _segmentData(),
+    _previousSegmentSize(0),
     _liveSegmentFiles(),
     _playlist(),
     _pcrAnalyzer(1, 4),  // Minimum required: 1 PID, 4 PCR
     _previousBitrate(0),
-    _ccFixer(NoPID, tsp)
+    _ccFixer(NoPID, tsp),
+    _store(),
+    _writer(nullptr)
 {
     option(u"", 0, FILENAME, 1, 1);
     help(u"",
@@ -96,6 +258,16 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
          u"Using this option, all packets before all starting conditions are dropped. "
          u"Note that subsequent output segments always start with a copy of the last PAT and PMT.");
 
+    option(u"async-depth", 0, POSITIVE);
+    help(u"async-depth", u"count",
+         u"Write the completed media segments, purge the obsolete ones and regenerate the playlist "
+         u"in a separate thread, so that a slow storage does not block the output at each segment boundary. "
+         u"The media segments are built in memory and written in one operation, then flushed to the storage "
+         u"device before being referenced in the playlist. "
+         u"The specified value is the maximum number of completed segments which are queued for write. "
+         u"When the queue is full, the output waits for the writer thread. "
+         u"By default, all operations are performed in the output thread.");
+
     option(u"duration", 'd', POSITIVE);
     help(u"duration",
          u"Specify the target duration in seconds of media segments. "
@@ -113,6 +285,16 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
          u"When --fixed-segment-size is specified, the --duration parameter is only "
          u"used as a hint in the playlist file.");
 
+    option(u"http-server", 0, STRING);
+    help(u"http-server", u"[address:]port",
+         u"Keep the playlist and the media segments in memory, without writing any file, "
+         u"and serve them using an embedded minimal HTTP server on the specified local TCP port. "
+         u"If an optional address is specified, it must be a local IP address of the system. "
+         u"Each file is served at URL path \"/name\" where \"name\" is the file name part "
+         u"of the playlist or segment. The option --playlist is required. "
+         u"With VoD and event playlists, all segments remain in memory until the end of the session, "
+         u"use --live to limit the memory usage.");
+
     option(u"intra-close", 'i');
     help(u"intra-close",
          u"Start new segments on the start of an intra-coded image (I-Frame) of the reference video PID. "
@@ -164,6 +346,15 @@ ts::hls::OutputPlugin::OutputPlugin(TSP* tsp_) :
 }
 
 
+ts::hls::OutputPlugin::~OutputPlugin()
+{
+    if (_writer != nullptr) {
+        delete _writer;
+        _writer = nullptr;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Simple virtual methods.
 //----------------------------------------------------------------------------
@@ -191,6 +382,23 @@ bool ts::hls::OutputPlugin::getOptions()
     _fixedSegmentSize = intValue<PacketCounter>(u"fixed-segment-size") / PKT_SIZE;
     getIntValue(_initialMediaSeq, u"start-media-sequence", 0);
     getIntValues(_closeLabels, u"label-close");
+    getIntValue(_asyncDepth, u"async-depth", 0);
+
+    const UString serverName(value(u"http-server"));
+    _httpServer.clear();
+    if (!serverName.empty()) {
+        if (!_httpServer.resolve(serverName, *tsp)) {
+            return false;
+        }
+        if (!_httpServer.hasPort()) {
+            tsp->error(u"missing port number in --http-server");
+            return false;
+        }
+        if (_playlistFile.empty()) {
+            tsp->error(u"option --http-server requires --playlist");
+            return false;
+        }
+    }
 
     if (present(u"event")) {
         _playlistType = hls::PlayListType::EVENT;
@@ -249,11 +457,31 @@ bool ts::hls::OutputPlugin::start()
     if (_segmentFile.isOpen()) {
         _segmentFile.close(*tsp);
     }
+    _inMemory = _asyncDepth > 0 || _httpServer.hasPort();
+    _segmentName.clear();
+    _segmentData.clear();
+    _previousSegmentSize = 0;
     if (!_playlistFile.empty()) {
-        _playlist.reset(_playlistType, _playlistFile);
+        // With --http-server, the playlist and all segments are served from the same URL path.
+        _playlist.reset(_playlistType, _httpServer.hasPort() ? BaseName(_playlistFile) : _playlistFile);
         _playlist.setTargetDuration(_targetDuration, *tsp);
         _playlist.setMediaSequence(_initialMediaSeq, *tsp);
     }
+
+    // Start the HTTP server on the in-memory store.
+    _store.clear();
+    if (_httpServer.hasPort()) {
+        if (!_store.startServer(_httpServer, *tsp)) {
+            return false;
+        }
+        tsp->verbose(u"serving HLS playlist on http://%s/%s", {_httpServer, BaseName(_playlistFile)});
+    }
+
+    // Start the background writer.
+    if (_asyncDepth > 0) {
+        _writer = new Writer(*this, _asyncDepth);
+        _writer->start();
+    }
     return true;
 }
 
@@ -264,8 +492,33 @@ bool ts::hls::OutputPlugin::start()
 
 bool ts::hls::OutputPlugin::stop()
 {
-    // Simply close the current segmetn (and generate the corresponding playlist).
-    return closeCurrentSegment(true);
+    // Close the current segment (and generate the corresponding playlist).
+    bool ok = closeCurrentSegment(true);
+
+    // Wait for the background writer to publish all segments.
+    if (_writer != nullptr) {
+        ok = _writer->stop() && ok;
+        delete _writer;
+        _writer = nullptr;
+    }
+
+    _store.stopServer();
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Get the number of packets in the current segment.
+//----------------------------------------------------------------------------
+
+ts::PacketCounter ts::hls::OutputPlugin::segmentPacketCount() const
+{
+    if (_inMemory) {
+        return _segmentData.isNull() ? 0 : _segmentData->size() / PKT_SIZE;
+    }
+    else {
+        return _segmentFile.writePacketsCount();
+    }
 }
 
 
@@ -283,9 +536,14 @@ bool ts::hls::OutputPlugin::createNextSegment()
     // Generate a new segment file name.
     const UString fileName(_nameGenerator.newFileName());
 
-    // Create the segment file.
+    // Create the segment file, or the segment buffer when segments are built in memory.
     tsp->verbose(u"creating media segment %s", {fileName});
-    if (!_segmentFile.open(fileName, TSFile::WRITE | TSFile::SHARED, *tsp)) {
+    if (_inMemory) {
+        _segmentName = fileName;
+        _segmentData = new ByteBlock;
+        _segmentData->reserve(_previousSegmentSize);
+    }
+    else if (!_segmentFile.open(fileName, TSFile::WRITE | TSFile::SHARED, *tsp)) {
         return false;
     }
 
@@ -308,17 +566,86 @@ bool ts::hls::OutputPlugin::createNextSegment()
 bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
 {
     // If no segment file is open, there is nothing to do.
-    if (!_segmentFile.isOpen()) {
+    if (!segmentIsOpen()) {
         return true;
     }
 
     // Get the segment file name and size (to be inserted in the playlist).
-    const UString segName(_segmentFile.getFileName());
-    const PacketCounter segPackets = _segmentFile.writePacketsCount();
+    CompletedSegment seg;
+    seg.endOfStream = endOfStream;
+    seg.packets = segmentPacketCount();
+
+    if (_inMemory) {
+        // Pass the segment content to the publication.
+        seg.name = _segmentName;
+        seg.data = _segmentData;
+        _previousSegmentSize = _segmentData->size();
+        _segmentData.clear();
+    }
+    else {
+        // Close the TS file.
+        seg.name = _segmentFile.getFileName();
+        if (!_segmentFile.close(*tsp)) {
+            return false;
+        }
+    }
 
-    // Close the TS file.
-    if (!_segmentFile.close(*tsp)) {
-        return false;
+    // Estimate duration and bitrate of the segment. We use PCR's from the
+    // segment to compute the average bitrate. Then we compute the duration
+    // from the bitrate and segment file size. If we cannot get the bitrate
+    // of a segment but got one from previous segment, assume that bitrate
+    // did not change and reuse previous one.
+    if (_pcrAnalyzer.bitrateIsValid()) {
+        // We have an estimation of the bitrate of the segment file.
+        _previousBitrate = _pcrAnalyzer.bitrate188();
+    }
+    if (_previousBitrate > 0) {
+        // Compute duration based on segment bitrate (or previous one).
+        seg.bitrate = _useBitrateTag ? _previousBitrate : 0;
+        seg.duration = PacketInterval(seg.bitrate, seg.packets);
+    }
+    else {
+        // Completely unknown bitrate, we build a fake one based on the target duration.
+        seg.duration = _targetDuration * MilliSecPerSec;
+        seg.bitrate = _useBitrateTag ? PacketBitRate(seg.packets, seg.duration) : 0;
+    }
+
+    // Publish the segment now or in the background writer.
+    return _writer != nullptr ? _writer->push(seg) : publishSegment(seg);
+}
+
+
+//----------------------------------------------------------------------------
+// Write a completed segment, purge obsolete segments and regenerate playlist.
+// Invoked from the output thread or the background writer thread.
+//----------------------------------------------------------------------------
+
+bool ts::hls::OutputPlugin::publishSegment(const CompletedSegment& seg)
+{
+    // With --http-server, the files are identified by their name part only.
+    const bool useStore = _httpServer.hasPort();
+    const UString segName(useStore ? BaseName(seg.name) : seg.name);
+
+    // Store or write the segment when it was built in memory.
+    if (!seg.data.isNull()) {
+        if (useStore) {
+            _store.store(segName, seg.data);
+        }
+        else {
+            // Flush the segment to the storage device before referencing it in the playlist.
+            tsp->debug(u"writing media segment %s", {segName});
+            TSFile file;
+            const bool ok =
+                file.open(segName, TSFile::WRITE | TSFile::SHARED, *tsp) &&
+                file.writePackets(reinterpret_cast<const TSPacket*>(seg.data->data()), nullptr, seg.packets, *tsp) &&
+                file.flush(*tsp);
+            if (file.isOpen() && !file.close(*tsp)) {
+                return false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
     }
 
     // On live streams, we need to maintain a list of active segments.
@@ -330,40 +657,29 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
     if (!_playlistFile.empty()) {
 
         // Set end of stream indicator in the playlist.
-        _playlist.setEndList(endOfStream, *tsp);
+        _playlist.setEndList(seg.endOfStream, *tsp);
 
         // Declare a new segment.
-        hls::MediaSegment seg;
-        _playlist.buildURL(seg, segName);
-
-        // Estimate duration and bitrate of the segment. We use PCR's from the
-        // segment to compute the average bitrate. Then we compute the duration
-        // from the bitrate and segment file size. If we cannot get the bitrate
-        // of a segment but got one from previous segment, assume that bitrate
-        // did not change and reuse previous one.
-        if (_pcrAnalyzer.bitrateIsValid()) {
-            // We have an estimation of the bitrate of the segment file.
-            _previousBitrate = _pcrAnalyzer.bitrate188();
-        }
-        if (_previousBitrate > 0) {
-            // Compute duration based on segment bitrate (or previous one).
-            seg.bitrate = _useBitrateTag ? _previousBitrate : 0;
-            seg.duration = PacketInterval(seg.bitrate, segPackets);
-        }
-        else {
-            // Completely unknown bitrate, we build a fake one based on the target duration.
-            seg.duration = _targetDuration * MilliSecPerSec;
-            seg.bitrate = _useBitrateTag ? PacketBitRate(segPackets, seg.duration) : 0;
-        }
-        _playlist.addSegment(seg, *tsp);
+        hls::MediaSegment mseg;
+        _playlist.buildURL(mseg, segName);
+        mseg.bitrate = seg.bitrate;
+        mseg.duration = seg.duration;
+        _playlist.addSegment(mseg, *tsp);
 
         // With live playlists, remove obsolete segments from the playlist.
         while (_liveDepth > 0 && _playlist.segmentCount() > _liveDepth) {
             _playlist.popFirstSegment();
         }
 
-        // Write the playlist file.
-        if (!_playlist.saveFile(UString(), *tsp)) {
+        // Write the playlist file or store it in memory.
+        if (useStore) {
+            const std::string text(_playlist.textContent(*tsp).toUTF8());
+            if (text.empty()) {
+                return false;
+            }
+            _store.store(BaseName(_playlistFile), ByteBlockPtrMT(new ByteBlock(text.data(), text.size())));
+        }
+        else if (!_playlist.saveFile(UString(), *tsp)) {
             return false;
         }
 
@@ -382,9 +698,15 @@ bool ts::hls::OutputPlugin::closeCurrentSegment(bool endOfStream)
         const UString name(_liveSegmentFiles.front());
         _liveSegmentFiles.pop_front();
 
-        // Delete the segment file.
-        tsp->verbose(u"deleting obsolete segment file %s", {name});
-        DeleteFile(name, *tsp);
+        // Delete the segment file or remove it from memory.
+        if (useStore) {
+            tsp->debug(u"removing obsolete segment %s", {name});
+            _store.remove(name);
+        }
+        else {
+            tsp->verbose(u"deleting obsolete segment file %s", {name});
+            DeleteFile(name, *tsp);
+        }
 
         // WARNING: several improvements are possible here.
         // - It could be better to delay the purge of obsolete segments. Clients may have loaded
@@ -484,8 +806,11 @@ bool ts::hls::OutputPlugin::writePackets(const TSPacket* pkt, size_t packetCount
             p = &tmp;
         }
 
-        // Write the packet in the segment file.
-        if (!_segmentFile.writePackets(p, nullptr, 1, *tsp)) {
+        // Write the packet in the segment file or buffer.
+        if (_inMemory) {
+            _segmentData->append(p->b, PKT_SIZE);
+        }
+        else if (!_segmentFile.writePackets(p, nullptr, 1, *tsp)) {
             return false;
         }
     }
@@ -536,7 +861,7 @@ bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pk
             bool renewOnPUSI = false;
             if (_fixedSegmentSize > 0) {
                 // Each segment shall have a fixed size.
-                renewNow = _segmentFile.writePacketsCount() >= _fixedSegmentSize;
+                renewNow = segmentPacketCount() >= _fixedSegmentSize;
             }
             else if (!_segClosePending) {
                 if (pktData->hasAnyLabel(_closeLabels)) {
@@ -545,7 +870,7 @@ bool ts::hls::OutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pk
                 }
                 else if (_pcrAnalyzer.bitrateIsValid()) {
                     // The segment file shall be closed when the estimated duration exceeds the target duration.
-                    const MilliSecond segDuration = PacketInterval(_pcrAnalyzer.bitrate188(), _segmentFile.writePacketsCount());
+                    const MilliSecond segDuration = PacketInterval(_pcrAnalyzer.bitrate188(), segmentPacketCount());
                     _segClosePending = segDuration >= _targetDuration * MilliSecPerSec;
                     // With --intra-close, force renew on next PES packet if extra duration is exceeded.
                     renewOnPUSI = segDuration >= (_targetDuration + _maxExtraDuration) * MilliSecPerSec;
@@ -40,6 +40,8 @@
 #include "tsContinuityAnalyzer.h"
 #include "tsFileNameGenerator.h"
 #include "tshlsPlayList.h"
+#include "tshlsSegmentStore.h"
+#include "tsIPv4SocketAddress.h"
 
 namespace ts {
     namespace hls {
@@ -47,10 +49,16 @@ namespace ts {
         //! HTTP Live Streaming (HLS) output plugin for tsp.
         //! @ingroup plugin
         //!
-        //! The output plugin generates playlists and media segments on local files
-        //! only. It can also purge obsolete media segments and regenerate live
-        //! playlists. To setup a complete HLS server, it is necessary to setup an
-        //! external HTTP server such as Apache which simply serves these files.
+        //! The output plugin generates playlists and media segments on local files.
+        //! It can also purge obsolete media segments and regenerate live playlists.
+        //! To setup a complete HLS server, it is necessary to setup an external HTTP
+        //! server such as Apache which simply serves these files. Alternatively, the
+        //! playlists and media segments can be kept in memory and served by an
+        //! embedded minimal HTTP server.
+        //!
+        //! Completed media segments can be written and published by a background
+        //! thread, so that slow storage does not block the output at each segment
+        //! boundary.
         //!
         class TSDUCKDLL OutputPlugin: public ts::OutputPlugin, private TableHandlerInterface
         {
@@ -62,6 +70,11 @@ namespace ts {
             //!
             OutputPlugin(TSP* tsp);
 
+            //!
+            //! Destructor.
+            //!
+            virtual ~OutputPlugin() override;
+
             // Implementation of plugin API
             virtual bool getOptions() override;
             virtual bool start() override;
@@ -83,6 +96,8 @@ namespace ts {
             PacketCounter      _fixedSegmentSize;      // Optional fixed segment size in packets.
             size_t             _initialMediaSeq;       // Initial media sequence value.
             TSPacketMetadata::LabelSet _closeLabels;   // Close segment on packets with any of these labels.
+            size_t             _asyncDepth;            // Max number of completed segments queued for the background writer.
+            IPv4SocketAddress  _httpServer;            // Serve the playlist and segments from memory on this address.
 
             // Working data.
             FileNameGenerator  _nameGenerator;         // Generate the segment file names.
@@ -95,11 +110,36 @@ namespace ts {
             bool               _segStarted;            // Generation of output segments has started.
             bool               _segClosePending;       // Close the current segment when possible.
             TSFile             _segmentFile;           // Output segment file.
+            bool               _inMemory;              // Build segments in memory instead of writing a file.
+            UString            _segmentName;           // Name of current segment, when built in memory.
+            ByteBlockPtrMT     _segmentData;           // Content of current segment, when built in memory.
+            size_t             _previousSegmentSize;   // Size of previous segment, to preallocate the next one.
             UStringList        _liveSegmentFiles;      // List of current segments in a live stream.
             hls::PlayList      _playlist;              // Generated playlist.
             PCRAnalyzer        _pcrAnalyzer;           // PCR analyzer to compute bitrates.
             BitRate            _previousBitrate;       // Bitrate of previous segment.
             ContinuityAnalyzer _ccFixer;               // To fix continuity counters in PAT and PMT PID's.
+            SegmentStore       _store;                 // In-memory playlist and segments, with --http-server.
+
+            // Description of a completed segment, to publish.
+            struct CompletedSegment
+            {
+                CompletedSegment();
+                UString        name;         // Segment file name.
+                ByteBlockPtrMT data;         // Segment content, null if already written in the file.
+                PacketCounter  packets;      // Number of TS packets in the segment.
+                BitRate        bitrate;      // Estimated bitrate for the playlist.
+                MilliSecond    duration;     // Estimated duration for the playlist.
+                bool           endOfStream;  // This is the last segment.
+            };
+
+            // Background writer of completed segments, with --async-depth.
+            class Writer;
+            Writer* _writer;
+
+            // Check if a segment is open and get its number of packets.
+            bool segmentIsOpen() const { return _inMemory ? !_segmentData.isNull() : _segmentFile.isOpen(); }
+            PacketCounter segmentPacketCount() const;
 
             // Create the next segment file (also close the previous one if necessary).
             bool createNextSegment();
@@ -107,6 +147,10 @@ namespace ts {
             // Close current segment file (also purge obsolete segment files and regenerate playlist).
             bool closeCurrentSegment(bool endOfStream);
 
+            // Write a completed segment, purge obsolete segments and regenerate the playlist.
+            // Invoked from the output thread or the background writer thread.
+            bool publishSegment(const CompletedSegment& seg);
+
             // Implementation of TableHandlerInterface.
             virtual void handleTable(SectionDemux&, const BinaryTable&) override;
 
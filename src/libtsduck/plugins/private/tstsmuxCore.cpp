@@ -66,7 +66,8 @@ ts::tsmux::Core::Core(const MuxerArgs& opt, const PluginEventHandlerRegistry& ha
     _max_eits(128), // hard-coded for now
     _eits(),
     _pid_origin(),
-    _service_origin()
+    _service_origin(),
+    _input_tables()
 {
     // Preset common default options.
     _duck.restoreArgs(_opt.duckArgs);
@@ -261,6 +262,9 @@ void ts::tsmux::Core::main()
         // End of next time interval.
         clock += cadence;
 
+        // Merge the PSI/SI which were collected by the input threads since the previous period.
+        processInputTables();
+
         // Number of packets which should have been sent by the end of the time interval.
         const PacketCounter expected_packets = (((clock - start) * _bitrate) / (NanoSecPerSec * PKT_SIZE_BITS)).toInt();
 
@@ -360,44 +364,17 @@ bool ts::tsmux::Core::getInputPacket(size_t& input_index, TSPacket& pkt, TSPacke
 
 
 //----------------------------------------------------------------------------
-// Try to extract a UTC time from a TDT or TOT in one TS packet.
+// Merge all tables which were received from the input threads.
 //----------------------------------------------------------------------------
 
-bool ts::tsmux::Core::getUTC(Time& utc, const TSPacket& pkt)
+void ts::tsmux::Core::processInputTables()
 {
-    if (pkt.getPUSI()) {
-        // This packet contains the start of a section.
-        const uint8_t* pl = pkt.getPayload();
-        size_t pl_size = pkt.getPayloadSize();
-        if (pl_size > 0) {
-            // Get the pointer field.
-            const uint8_t pf = pl[0];
-            if (pl_size >= 1 + pf + MIN_SHORT_SECTION_SIZE) {
-                // A section can fit. Get address and remaining size.
-                pl += 1 + pf;
-                pl_size -= 1 + pf;
-                // Get section size.
-                const size_t sect_size = 3 + (GetUInt16(pl + 1) & 0x0FFF);
-                if (pl_size >= sect_size) {
-                    // A complete section is here, make it a binary table.
-                    BinaryTable table;
-                    table.addSection(SectionPtr(new Section(pl, sect_size)));
-                    // Try to interpret it as a TDT or TOT.
-                    TDT tdt(_duck, table);
-                    if (tdt.isValid()) {
-                        utc = tdt.utc_time;
-                        return true;
-                    }
-                    TOT tot(_duck, table);
-                    if (tot.isValid()) {
-                        utc = tot.utc_time;
-                        return true;
-                    }
-                }
-            }
-        }
+    // Non-blocking dequeue, the input threads never wait for the core thread.
+    LockFreeMessageQueue<InputTable>::MessagePtr msg;
+    while (!_terminate && _input_tables.dequeue(msg, 0)) {
+        assert(msg->plugin_index < _inputs.size());
+        _inputs[msg->plugin_index]->mergeTable(*msg);
     }
-    return false; // no time found
 }
 
 
@@ -432,19 +409,23 @@ void ts::tsmux::Core::provideSection(SectionCounter counter, SectionPtr& section
 ts::tsmux::Core::Input::Input(Core& core, size_t index) :
     _core(core),
     _plugin_index(index),
-    _terminated(false),
+    _duck(&_core._log),
     _got_ts_id(false),
     _ts_id(0),
-    _input(_core._opt, core._handlers, index, _core._log),
-    _demux(_core._duck, this, nullptr),
-    _eit_demux(_core._duck, nullptr, this),
-    _pcr_merger(_core._duck),
+    _demux(_duck, this, nullptr),
+    _eit_demux(_duck, nullptr, this),
     _nit(),
+    _terminated(false),
+    _pcr_merger(_core._duck),
     _next_insertion(0),
     _next_packet(),
     _next_metadata(),
-    _pid_clocks()
+    _pid_clocks(),
+    _input(_core._opt, core._handlers, index, _core._log, this)
 {
+    // The input thread uses its own context to deserialize tables.
+    _duck.restoreArgs(_core._opt.duckArgs);
+
     // Filter all global PSI/SI for merging in output PSI.
     _demux.addPID(PID_PAT);
     _demux.addPID(PID_CAT);
@@ -462,9 +443,6 @@ ts::tsmux::Core::Input::Input(Core& core, size_t index) :
 
     // Always reset PCR progression when moving ahead of PTS or DTS.
     _pcr_merger.setResetBackwards(true);
-
-    // The NIT is valid only when waiting to be merged.
-    _nit.invalidate();
 }
 
 
@@ -499,21 +477,6 @@ bool ts::tsmux::Core::Input::getPacket(TSPacket& pkt, TSPacketMetadata& pkt_data
     }
     const PID pid = pkt.getPID();
 
-    // Feed the two PSI/SI demux.
-    _demux.feedPacket(pkt);
-    _eit_demux.feedPacket(pkt);
-
-    // If this is TDT/TOT PID, check if we need to pass it.
-    if (pid == PID_TDT && _core._time_input_index == NPOS) {
-        // Time PID not yet selected. If we find a time here, we will use that plugin.
-        Time utc;
-        if (_core.getUTC(utc, pkt)) {
-            // From now on, we will use that input plugin as time reference.
-            _core._time_input_index = _plugin_index;
-            _core._log.verbose(u"using input #%d as TDT/TOT reference", {_plugin_index});
-        }
-    }
-
     // If the packet contains a PCR, check if it is time to insert it in the output.
     // PCR packets are inserted at the same (or similar) PCR interval as in the orginal stream.
     if (pkt.hasPCR()) {
@@ -551,9 +514,88 @@ bool ts::tsmux::Core::Input::getPacket(TSPacket& pkt, TSPacketMetadata& pkt_data
 
     // Adjust and remember PCR values and position.
     adjustPCR(pkt);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Analyze input packets in the context of the input thread.
+//----------------------------------------------------------------------------
+
+size_t ts::tsmux::Core::Input::analyzeInputPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t count)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const PID pid = pkt[i].getPID();
+
+        // Feed the two PSI/SI demux.
+        _demux.feedPacket(pkt[i]);
+        _eit_demux.feedPacket(pkt[i]);
+
+        // If this is TDT/TOT PID, check if we need to pass it.
+        if (pid == PID_TDT && _core._time_input_index == NPOS) {
+            // Time PID not yet selected. If we find a time here, we will use that plugin.
+            // Several input threads may find a time at the same time, the first one wins.
+            Time utc;
+            size_t no_index = NPOS;
+            if (getUTC(utc, pkt[i]) && _core._time_input_index.compare_exchange_strong(no_index, _plugin_index)) {
+                // From now on, we will use that input plugin as time reference.
+                _core._log.verbose(u"using input #%d as TDT/TOT reference", {_plugin_index});
+            }
+        }
+
+        // Don't keep packets from predefined PID's, they are separately regenerated.
+        if (pid > PID_DVB_LAST || (pid == PID_TDT && _core._time_input_index == _plugin_index)) {
+            if (kept < i) {
+                pkt[kept] = pkt[i];
+                mdata[kept] = mdata[i];
+            }
+            kept++;
+        }
+    }
+    return kept;
+}
+
+
+//----------------------------------------------------------------------------
+// Try to extract a UTC time from a TDT or TOT in one TS packet.
+//----------------------------------------------------------------------------
 
-    // Don't return packets from predefined PID's, they are separately regenerated.
-    return pid > PID_DVB_LAST || (pid == PID_TDT && _core._time_input_index == _plugin_index);
+bool ts::tsmux::Core::Input::getUTC(Time& utc, const TSPacket& pkt)
+{
+    if (pkt.getPUSI()) {
+        // This packet contains the start of a section.
+        const uint8_t* pl = pkt.getPayload();
+        size_t pl_size = pkt.getPayloadSize();
+        if (pl_size > 0) {
+            // Get the pointer field.
+            const uint8_t pf = pl[0];
+            if (pl_size >= 1 + pf + MIN_SHORT_SECTION_SIZE) {
+                // A section can fit. Get address and remaining size.
+                pl += 1 + pf;
+                pl_size -= 1 + pf;
+                // Get section size.
+                const size_t sect_size = 3 + (GetUInt16(pl + 1) & 0x0FFF);
+                if (pl_size >= sect_size) {
+                    // A complete section is here, make it a binary table.
+                    BinaryTable table;
+                    table.addSection(SectionPtr(new Section(pl, sect_size)));
+                    // Try to interpret it as a TDT or TOT.
+                    TDT tdt(_duck, table);
+                    if (tdt.isValid()) {
+                        utc = tdt.utc_time;
+                        return true;
+                    }
+                    TOT tot(_duck, table);
+                    if (tot.isValid()) {
+                        utc = tot.utc_time;
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false; // no time found
 }
 
 
@@ -576,33 +618,72 @@ void ts::tsmux::Core::Input::adjustPCR(TSPacket& pkt)
 
 
 //----------------------------------------------------------------------------
-// Receive a PSI/SI table from an input stream.
+// Send a table or a section to the core thread.
+//----------------------------------------------------------------------------
+
+void ts::tsmux::Core::Input::sendTable(InputTable* msg)
+{
+    msg->ts_id = _ts_id;
+
+    // The message queue is lock-free. Never block the input thread when the queue is full.
+    _core._input_tables.forceEnqueue(msg);
+}
+
+
+//----------------------------------------------------------------------------
+// Receive a PSI/SI table from an input stream, in the input thread.
 //----------------------------------------------------------------------------
 
 void ts::tsmux::Core::Input::handleTable(SectionDemux& demux, const BinaryTable& table)
 {
     switch (table.tableId()) {
         case TID_PAT: {
-            const PAT pat(_core._duck, table);
-            if (pat.isValid() && table.sourcePID() == PID_PAT) {
-                handlePAT(pat);
+            if (table.sourcePID() == PID_PAT) {
+                InputTable* msg = new InputTable(_plugin_index);
+                PAT* pat = new PAT(_duck, table);
+                msg->table.reset(pat);
+                if (pat->isValid()) {
+                    // Input TS id is now known.
+                    _ts_id = pat->ts_id;
+                    _got_ts_id = true;
+                    sendTable(msg);
+                    // Now that the TS id is known, we can process a waiting NIT.
+                    if (!_nit.isNull()) {
+                        msg = new InputTable(_plugin_index);
+                        msg->table.reset(_nit.release());
+                        sendTable(msg);
+                    }
+                }
+                else {
+                    delete msg;
+                }
             }
             break;
         }
         case TID_CAT: {
-            const CAT cat(_core._duck, table);
-            if (cat.isValid() && table.sourcePID() == PID_CAT) {
-                handleCAT(cat);
+            if (table.sourcePID() == PID_CAT) {
+                InputTable* msg = new InputTable(_plugin_index);
+                msg->table.reset(new CAT(_duck, table));
+                if (msg->table->isValid()) {
+                    sendTable(msg);
+                }
+                else {
+                    delete msg;
+                }
             }
             break;
         }
         case TID_NIT_ACT: {
             if (_core._opt.nitScope != TableScope::NONE && table.sourcePID() == PID_NIT) {
                 // Process the NIT only when the current TS id is known.
-                _nit.deserialize(_core._duck, table);
-                if (_nit.isValid() && _got_ts_id) {
-                    handleNIT(_nit);
-                    _nit.invalidate();
+                _nit.reset(new NIT(_duck, table));
+                if (!_nit->isValid()) {
+                    _nit.clear();
+                }
+                else if (_got_ts_id) {
+                    InputTable* msg = new InputTable(_plugin_index);
+                    msg->table.reset(_nit.release());
+                    sendTable(msg);
                 }
             }
             break;
@@ -610,16 +691,22 @@ void ts::tsmux::Core::Input::handleTable(SectionDemux& demux, const BinaryTable&
         case TID_NIT_OTH: {
             if (_core._opt.nitScope == TableScope::ALL && table.sourcePID() == PID_NIT) {
                 // This is a NIT-Other. It must be reinserted without modification in the NIT PID.
-                _core._nit_pzer.removeSections(table.tableId(), table.tableIdExtension());
-                _core._nit_pzer.addTable(table);
+                // The table is copied, not shared with the demux, since it is passed to another thread.
+                InputTable* msg = new InputTable(_plugin_index);
+                msg->binary.reset(new BinaryTable(table, ShareMode::COPY));
+                sendTable(msg);
             }
             break;
         }
         case TID_SDT_ACT: {
             if (_core._opt.sdtScope != TableScope::NONE && table.sourcePID() == PID_SDT) {
-                const SDT sdt(_core._duck, table);
-                if (sdt.isValid()) {
-                    handleSDT(sdt);
+                InputTable* msg = new InputTable(_plugin_index);
+                msg->table.reset(new SDT(_duck, table));
+                if (msg->table->isValid()) {
+                    sendTable(msg);
+                }
+                else {
+                    delete msg;
                 }
             }
             break;
@@ -627,8 +714,9 @@ void ts::tsmux::Core::Input::handleTable(SectionDemux& demux, const BinaryTable&
         case TID_SDT_OTH: {
             if (_core._opt.sdtScope == TableScope::ALL && table.sourcePID() == PID_SDT) {
                 // This is an SDT-Other. It must be reinserted without modification in the SDT/BAT PID.
-                _core._sdt_bat_pzer.removeSections(table.tableId(), table.tableIdExtension());
-                _core._sdt_bat_pzer.addTable(table);
+                InputTable* msg = new InputTable(_plugin_index);
+                msg->binary.reset(new BinaryTable(table, ShareMode::COPY));
+                sendTable(msg);
             }
             break;
         }
@@ -640,22 +728,73 @@ void ts::tsmux::Core::Input::handleTable(SectionDemux& demux, const BinaryTable&
 
 
 //----------------------------------------------------------------------------
-// Receive a PAT from an input stream.
+// Receive an EIT section from an input stream, in the input thread.
 //----------------------------------------------------------------------------
 
-void ts::tsmux::Core::Input::handlePAT(const PAT& pat)
+void ts::tsmux::Core::Input::handleSection(SectionDemux& demux, const Section& section)
 {
-    bool modified = false;
+    const TID tid = section.tableId();
+    const bool is_eit = EIT::IsEIT(tid) && section.sourcePID() == PID_EIT;
+    const bool is_actual = EIT::IsActual(tid);
+
+    if (is_eit && _core._opt.eitScope != TableScope::NONE && (is_actual || _core._opt.eitScope == TableScope::ALL)) {
 
-    // Input TS id is now known.
-    _ts_id = pat.ts_id;
-    _got_ts_id = true;
+        // Create a copy of the EIT section object, not shared with the demux, since it is passed to another thread.
+        Section* sp = new Section(section, ShareMode::COPY);
+        CheckNonNull(sp);
 
-    // Now that the TS id is known, we can process a waiting NIT.
-    if (_nit.isValid()) {
-        handleNIT(_nit);
-        _nit.invalidate();
+        // If this is an EIT-Actual, patch the EIT with output TS id.
+        if (is_actual && sp->payloadSize() >= 4) {
+            sp->setUInt16(0, _core._opt.outputTSId, false);
+            sp->setUInt16(2, _core._opt.outputNetwId, true);
+        }
+
+        // Send the EIT section to the core thread.
+        InputTable* msg = new InputTable(_plugin_index);
+        msg->eit.reset(sp);
+        sendTable(msg);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Merge a table from this input into the output PSI/SI, in the core thread.
+//----------------------------------------------------------------------------
+
+void ts::tsmux::Core::Input::mergeTable(const InputTable& msg)
+{
+    if (!msg.eit.isNull()) {
+        handleEIT(msg.eit);
+    }
+    else if (!msg.binary.isNull()) {
+        // NIT-Other or SDT-Other, reinserted without modification.
+        const BinaryTable& table(*msg.binary);
+        CyclingPacketizer& pzer(table.tableId() == TID_NIT_OTH ? _core._nit_pzer : _core._sdt_bat_pzer);
+        pzer.removeSections(table.tableId(), table.tableIdExtension());
+        pzer.addTable(table);
     }
+    else if (const PAT* pat = dynamic_cast<const PAT*>(msg.table.pointer())) {
+        handlePAT(*pat);
+    }
+    else if (const CAT* cat = dynamic_cast<const CAT*>(msg.table.pointer())) {
+        handleCAT(*cat);
+    }
+    else if (const NIT* nit = dynamic_cast<const NIT*>(msg.table.pointer())) {
+        handleNIT(*nit, msg.ts_id);
+    }
+    else if (const SDT* sdt = dynamic_cast<const SDT*>(msg.table.pointer())) {
+        handleSDT(*sdt);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Receive a PAT from an input stream.
+//----------------------------------------------------------------------------
+
+void ts::tsmux::Core::Input::handlePAT(const PAT& pat)
+{
+    bool modified = false;
 
     // Add all services from input PAT into output PAT.
     for (auto it = pat.pmts.begin(); it != pat.pmts.end(); ++it) {
@@ -773,7 +912,7 @@ void ts::tsmux::Core::Input::handleCAT(const CAT& cat)
 // Receive a NIT from an input stream.
 //----------------------------------------------------------------------------
 
-void ts::tsmux::Core::Input::handleNIT(const NIT& nit)
+void ts::tsmux::Core::Input::handleNIT(const NIT& nit, uint16_t ts_id)
 {
     bool modified = false;
 
@@ -783,7 +922,7 @@ void ts::tsmux::Core::Input::handleNIT(const NIT& nit)
     // Loop on all transport streams in the input NIT.
     for (auto it = nit.transports.begin(); it != nit.transports.end(); ++it) {
         const uint16_t tsid = it->first.transport_stream_id;
-        if (tsid == _ts_id) {
+        if (tsid == ts_id) {
             // This is the description of the input transport stream.
             // Map it to the description of the output transport stream.
             NIT::Transport& ts(_core._output_nit.transports[TransportStreamId(_core._opt.outputTSId, _core._opt.outputNetwId)]);
@@ -872,37 +1011,20 @@ void ts::tsmux::Core::Input::handleSDT(const SDT& sdt)
 
 
 //----------------------------------------------------------------------------
-// Receive an EIT section from an input stream.
+// Merge an EIT section from an input stream, in the core thread.
 //----------------------------------------------------------------------------
 
-void ts::tsmux::Core::Input::handleSection(SectionDemux& demux, const Section& section)
+void ts::tsmux::Core::Input::handleEIT(const SectionPtr& eit)
 {
-    const TID tid = section.tableId();
-    const bool is_eit = EIT::IsEIT(tid) && section.sourcePID() == PID_EIT;
-    const bool is_actual = EIT::IsActual(tid);
-
-    if (is_eit && _core._opt.eitScope != TableScope::NONE && (is_actual || _core._opt.eitScope == TableScope::ALL)) {
-
-        // Create a copy of the EIT section object (shared section data).
-        const SectionPtr sp(new Section(section, ShareMode::SHARE));
-        CheckNonNull(sp.pointer());
-
-        // If this is an EIT-Actual, patch the EIT with output TS id.
-        if (is_actual && sp->payloadSize() >= 4) {
-            sp->setUInt16(0, _core._opt.outputTSId, false);
-            sp->setUInt16(2, _core._opt.outputNetwId, true);
-        }
-
-        // Enqueue the EIT section.
-        _core._eits.push_back(sp);
-
-        // Check that there is no accumulation of late EIT's.
-        if (_core._eits.size() > _core._max_eits) {
-            _core._log.warning(u"too many input EIT, not enough space in output EIT PID, dropping some EIT sections");
-            // Drop oldest EIT's.
-            while (_core._eits.size() > _core._max_eits) {
-                _core._eits.pop_front();
-            }
+    // Enqueue the EIT section.
+    _core._eits.push_back(eit);
+
+    // Check that there is no accumulation of late EIT's.
+    if (_core._eits.size() > _core._max_eits) {
+        _core._log.warning(u"too many input EIT, not enough space in output EIT PID, dropping some EIT sections");
+        // Drop oldest EIT's.
+        while (_core._eits.size() > _core._max_eits) {
+            _core._eits.pop_front();
         }
     }
 }
@@ -37,6 +37,8 @@
 #include "tsMuxerArgs.h"
 #include "tstsmuxInputExecutor.h"
 #include "tstsmuxOutputExecutor.h"
+#include "tstsmuxInputAnalyzerInterface.h"
+#include "tsLockFreeMessageQueue.h"
 #include "tsTime.h"
 #include "tsSectionDemux.h"
 #include "tsCyclingPacketizer.h"
@@ -51,6 +53,11 @@ namespace ts {
     namespace tsmux {
         //!
         //! Multiplexer (tsmux) core engine.
+        //!
+        //! The PSI/SI of each input stream are demuxed and deserialized in the thread of the
+        //! input plugin. The resulting tables are passed to the core thread through a lock-free
+        //! message queue. The core thread only merges the tables and schedules output packets.
+        //!
         //! @ingroup plugin
         //!
         class Core: private Thread, private SectionProviderInterface
@@ -108,6 +115,19 @@ namespace ts {
                 PIDClock(uint64_t value = INVALID_PCR, PacketCounter packet = 0) : pcr_value(value), pcr_packet(packet) {}
             };
 
+            // PSI/SI table or EIT section, sent by an input thread to the core thread.
+            // The input thread keeps no reference to the table or section once the message is sent.
+            class InputTable
+            {
+            public:
+                size_t           plugin_index;  // Input plugin index.
+                uint16_t         ts_id;         // Input transport stream id (NIT Actual only).
+                AbstractTablePtr table;         // Deserialized PAT, CAT, NIT Actual or SDT Actual.
+                BinaryTablePtr   binary;        // NIT Other or SDT Other, to reinsert without modification.
+                SectionPtr       eit;           // EIT section, to reinsert without modification.
+                InputTable(size_t index) : plugin_index(index), ts_id(0), table(), binary(), eit() {}
+            };
+
             // Core private members.
             const PluginEventHandlerRegistry& _handlers;
             Report&             _log;               // Asynchronous log report.
@@ -116,7 +136,7 @@ namespace ts {
             volatile bool       _terminate;         // Termination request.
             BitRate             _bitrate;           // Constant output bitrate.
             PacketCounter       _output_packets;    // Count of output packets which were sent.
-            size_t              _time_input_index;  // Input plugin index containing time reference (TDT/TOT).
+            std::atomic<size_t> _time_input_index;  // Input plugin index containing time reference (TDT/TOT).
             std::vector<Input*> _inputs;            // Input plugins threads.
             OutputExecutor      _output;            // Output plugin thread.
             std::set<size_t>    _terminated_inputs; // Set of terminated input plugins.
@@ -133,6 +153,7 @@ namespace ts {
             std::list<SectionPtr>     _eits;            // List of EIT sections to insert.
             std::map<PID,Origin>      _pid_origin;      // Map of PID's to original input stream.
             std::map<uint16_t,Origin> _service_origin;  // Map of service ids to original input stream.
+            LockFreeMessageQueue<InputTable> _input_tables; // Tables from all input threads.
 
             // Implementation of Thread.
             virtual void main() override;
@@ -141,8 +162,8 @@ namespace ts {
             // Update the plugin index. Return false if all input plugins were tried without success.
             bool getInputPacket(size_t& input_index, TSPacket& pkt, TSPacketMetadata& pkt_data);
 
-            // Try to extract a UTC time from a TDT or TOT in one TS packet.
-            bool getUTC(Time& utc, const TSPacket& pkt);
+            // Merge all tables which were received from the input threads.
+            void processInputTables();
 
             // Implementation of SectionProviderInterface (for output EIT provision).
             virtual void provideSection(SectionCounter counter, SectionPtr& section) override;
@@ -152,7 +173,7 @@ namespace ts {
             // Description of an input stream.
             //----------------------------------------------------------------
 
-            class Input : private TableHandlerInterface, SectionHandlerInterface
+            class Input : private TableHandlerInterface, SectionHandlerInterface, InputAnalyzerInterface
             {
                 TS_NOBUILD_NOCOPY(Input);
             public:
@@ -180,34 +201,54 @@ namespace ts {
                 // Get one input packet. Return false when none is immediately available.
                 bool getPacket(TSPacket& pkt, TSPacketMetadata& pkt_data);
 
+                // Merge a table from this input into the output PSI/SI, in the context of the core thread.
+                void mergeTable(const InputTable& table);
+
             private:
+                // Fields which are used in the context of the input thread only.
                 Core&            _core;           // Reference to the parent Core.
                 const size_t     _plugin_index;   // Input plugin index.
-                bool             _terminated;     // Detected that the executor thread has terminated.
+                DuckContext      _duck;           // TSDuck execution context for the input thread.
                 bool             _got_ts_id;      // Input transport stream id is known.
                 uint16_t         _ts_id;          // Input transport stream id (when _got_ts_id is true).
-                InputExecutor    _input;          // Input plugin thread.
                 SectionDemux     _demux;          // Demux for PSI/SI (except PMT's and EIT's).
                 SectionDemux     _eit_demux;      // Demux for EIT's.
+                AbstractTablePtr _nit;            // NIT waiting for the input transport stream id.
+                // Fields which are used in the context of the core thread only.
+                bool             _terminated;     // Detected that the executor thread has terminated.
                 PCRMerger        _pcr_merger;     // Adjust PCR in input packets to be synchronized with the output stream.
-                NIT              _nit;            // NIT waiting to be merged.
                 PacketCounter    _next_insertion; // Insertion point of next packet.
                 TSPacket         _next_packet;    // Next packet to insert if already received but not yet inserted.
                 TSPacketMetadata _next_metadata;  // Associated metadata.
                 std::map<PID,PIDClock> _pid_clocks;  // Output clock of each input PID.
+                // Input plugin thread, declared last to be stopped before the analysis fields are destroyed.
+                InputExecutor    _input;
 
                 // Adjust the PCR of a packet before insertion.
                 void adjustPCR(TSPacket& pkt);
 
-                // Receive a PSI/SI table.
+                // Try to extract a UTC time from a TDT or TOT in one TS packet.
+                bool getUTC(Time& utc, const TSPacket& pkt);
+
+                // Send a table or a section to the core thread. The smart pointers are not thread-safe:
+                // the message must hold the only references to its table or section.
+                void sendTable(InputTable* msg);
+
+                // Implementation of InputAnalyzerInterface, in the context of the input thread.
+                virtual size_t analyzeInputPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t count) override;
+
+                // Receive a PSI/SI table, in the context of the input thread.
                 virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
+
+                // Receive an EIT section, in the context of the input thread.
+                virtual void handleSection(SectionDemux& demux, const Section& section) override;
+
+                // Merge PSI/SI into the output tables, in the context of the core thread.
                 void handlePAT(const PAT&);
                 void handleCAT(const CAT&);
-                void handleNIT(const NIT&);
+                void handleNIT(const NIT&, uint16_t ts_id);
                 void handleSDT(const SDT&);
-
-                // Receive an EIT section.
-                virtual void handleSection(SectionDemux& demux, const Section& section) override;
+                void handleEIT(const SectionPtr&);
             };
         };
     }
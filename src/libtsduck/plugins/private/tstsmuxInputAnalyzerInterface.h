@@ -0,0 +1,67 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Multiplexer (tsmux) analysis of input packets in the input threads.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
+
+namespace ts {
+    namespace tsmux {
+        //!
+        //! Abstract interface to analyze input packets in the context of a tsmux input thread.
+        //! This is used to move per-packet work such as PSI/SI demux out of the core thread.
+        //! @ingroup plugin
+        //!
+        class InputAnalyzerInterface
+        {
+        public:
+            //!
+            //! Analyze packets which were just received by an input plugin.
+            //! This hook is invoked in the context of the input executor thread, before
+            //! the packets are made available to the core thread.
+            //! @param [in,out] pkt Address of the received packets. Packets may be removed
+            //! from the area by moving the next ones toward the start of the area.
+            //! @param [in,out] mdata Address of the associated packet metadata.
+            //! @param [in] count Number of received packets.
+            //! @return Number of packets to keep at the start of the area (@a count or less).
+            //!
+            virtual size_t analyzeInputPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t count) = 0;
+
+            //!
+            //! Virtual destructor.
+            //!
+            virtual ~InputAnalyzerInterface() = default;
+        };
+    }
+}
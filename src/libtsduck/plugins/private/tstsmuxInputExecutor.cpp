@@ -36,11 +36,16 @@
 // Constructor and destructor.
 //----------------------------------------------------------------------------
 
-ts::tsmux::InputExecutor::InputExecutor(const MuxerArgs& opt, const PluginEventHandlerRegistry& handlers, size_t index, Report& log) :
+ts::tsmux::InputExecutor::InputExecutor(const MuxerArgs& opt, const PluginEventHandlerRegistry& handlers, size_t index, Report& log, InputAnalyzerInterface* analyzer) :
     // Input threads have a high priority to be always ready to load incoming packets in the buffer.
     PluginExecutor(opt, handlers, PluginType::INPUT, opt.inputs[index], ThreadAttributes().setPriority(ThreadAttributes::GetHighPriority()), log),
     _input(dynamic_cast<InputPlugin*>(PluginThread::plugin())),
-    _pluginIndex(index)
+    _pluginIndex(index),
+    _analyzer(analyzer),
+    _packets_next(0),
+    _input_end(false),
+    _input_waiting(false),
+    _consumer_waiting(false)
 {
     // Make sure that the input plugins display their index.
     setLogName(UString::Format(u"%s[%d]", {pluginName(), _pluginIndex}));
@@ -76,43 +81,81 @@ void ts::tsmux::InputExecutor::terminate()
 }
 
 
+//----------------------------------------------------------------------------
+// Signal a condition to the other thread if it is waiting on it.
+//----------------------------------------------------------------------------
+
+void ts::tsmux::InputExecutor::signalIfWaiting(const std::atomic<bool>& waiting, Condition& condition)
+{
+    // The waiting thread sets its flag under the mutex before checking the packet count.
+    // Since the packet count was updated before checking the flag, the waiting thread
+    // either sees the new count or is already waiting when we lock the mutex.
+    if (waiting) {
+        GuardMutex lock(_mutex);
+        condition.signal();
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Copy packets from the input buffer.
 //----------------------------------------------------------------------------
 
 bool ts::tsmux::InputExecutor::getPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t max_count, size_t& ret_count, bool blocking)
 {
-    // In blocking mode, loop until there is some packet in the buffer.
-    GuardCondition lock(_mutex, _got_packets);
-    while (!_terminate && blocking && _packets_count == 0) {
-        lock.waitCondition();
+    ret_count = 0;
+
+    // In blocking mode, wait until there is some packet in the buffer.
+    if (blocking && !_terminate && !_input_end && _packets_count == 0) {
+        GuardCondition lock(_mutex, _got_packets);
+        _consumer_waiting = true;
+        while (!_terminate && !_input_end && _packets_count == 0) {
+            lock.waitCondition();
+        }
+        _consumer_waiting = false;
     }
 
     // Return error if the input is terminated _and_ there is no more packet to read.
-    if (_terminate && _packets_count == 0) {
-        ret_count = 0;
-        return false;
+    // The end of input flag is read before the packet count: when the input thread has
+    // set the flag, its last packets are already counted.
+    const bool input_end = _input_end;
+    if (_packets_count == 0) {
+        return !input_end && !_terminate;
+    }
+
+    // With a lossy input, the input thread may drop the oldest packets at any time.
+    // In that case, it updates the first packet under the mutex and so do we.
+    if (_opt.lossyInput) {
+        GuardMutex lock(_mutex);
+        copyPackets(pkt, mdata, max_count, ret_count);
+    }
+    else {
+        copyPackets(pkt, mdata, max_count, ret_count);
+        // Signal that there are some free space.
+        if (ret_count > 0) {
+            signalIfWaiting(_input_waiting, _got_freespace);
+        }
     }
+    return true;
+}
 
-    // Fill what can be filled from the buffer. We are still under the mutex protection.
-    assert(_packets_count <= _buffer_size);
 
-    // Number of packets to copy from the buffer:
-    ret_count = std::min(std::min(max_count, _packets_count), _buffer_size - _packets_first);
+//----------------------------------------------------------------------------
+// Copy packets from a contiguous area at the beginning of the input buffer.
+//----------------------------------------------------------------------------
 
-    // Copy packets if there are some.
+void ts::tsmux::InputExecutor::copyPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t max_count, size_t& ret_count)
+{
+    // Only the input thread writes packets in the buffer but never in the area which is already counted.
+    const size_t available = _packets_count;
+    assert(available <= _buffer_size);
+    ret_count = std::min(std::min(max_count, available), _buffer_size - _packets_first);
     if (ret_count > 0) {
         TSPacket::Copy(pkt, &_packets[_packets_first], ret_count);
         TSPacketMetadata::Copy(mdata, &_metadata[_packets_first], ret_count);
         _packets_first = (_packets_first + ret_count) % _buffer_size;
         _packets_count -= ret_count;
-
-        // Signal that there are some free space.
-        // The mutex was initially locked for the _got_packets condition because we needed to wait
-        // for that condition but we can also use it to signal the _got_freespace condition.
-        _got_freespace.signal();
     }
-    return true;
 }
 
 
@@ -123,43 +166,53 @@ bool ts::tsmux::InputExecutor::getPackets(TSPacket* pkt, TSPacketMetadata* mdata
 void ts::tsmux::InputExecutor::main()
 {
     debug(u"input thread started");
-
-    // Loop until we are instructed to stop.
-    while (!_terminate) {
+    _packets_next = (_packets_first + _packets_count) % _buffer_size;
+    _input_end = false;
+
+    // Loop until we are instructed to stop or the input plugin terminates.
+    while (!_terminate && !_input_end) {
+
+        // In case of lossy input, drop oldest packets when the buffer is full. Never wait for the consumer.
+        if (_opt.lossyInput && _packets_count >= _buffer_size) {
+            GuardMutex lock(_mutex);
+            const size_t dropped = std::min<size_t>(_opt.lossyReclaim, _packets_count);
+            _packets_first = (_packets_first + dropped) % _buffer_size;
+            _packets_count -= dropped;
+        }
 
         // Wait for free space to be available in the input buffer.
-        size_t first = 0;
-        size_t count = 0;
-        {
+        if (!_opt.lossyInput && _packets_count >= _buffer_size) {
             GuardCondition lock(_mutex, _got_freespace);
-            // In case of lossy input, drop oldest packets when the buffer is full.
-            if (_opt.lossyInput && _packets_count >= _buffer_size) {
-                const size_t dropped = std::min(_opt.lossyReclaim, _buffer_size);
-                _packets_first = (_packets_first + dropped) % _buffer_size;
-                _packets_count -= dropped;
-            }
-            // Wait for free space in the buffer.
+            _input_waiting = true;
             while (!_terminate && _packets_count >= _buffer_size) {
                 lock.waitCondition();
             }
-            // We can use this contiguous free area at the end of already received packets.
-            first = (_packets_first + _packets_count) % _buffer_size;
-            count = std::min(_buffer_size - _packets_count, _buffer_size - first);
+            _input_waiting = false;
         }
 
+        // We can use this contiguous free area at the end of already received packets.
+        const size_t first = _packets_next;
+        size_t count = std::min(_buffer_size - _packets_count, _buffer_size - first);
+
         // Read some packets.
         if (!_terminate) {
             count = _input->receive(&_packets[first], &_metadata[first], std::min(count, _opt.maxInputPackets));
             if (count > 0) {
-                // Packets successfully received.
-                GuardCondition lock(_mutex, _got_packets);
-                _packets_count += count;
-                // Signal that there are some new packets in the buffer.
-                lock.signal();
+                // Packets successfully received. Analyze them before releasing them to the consumer.
+                if (_analyzer != nullptr) {
+                    count = _analyzer->analyzeInputPackets(&_packets[first], &_metadata[first], count);
+                }
+                if (count > 0) {
+                    _packets_next = (first + count) % _buffer_size;
+                    _packets_count += count;
+                    // Signal that there are some new packets in the buffer.
+                    signalIfWaiting(_consumer_waiting, _got_packets);
+                }
             }
             else if (_opt.inputOnce) {
                 // Terminates when the input plugin terminates or fails.
-                _terminate = true;
+                _input_end = true;
+                signalIfWaiting(_consumer_waiting, _got_packets);
             }
             else {
                 // Restart when the plugin terminates or fails.
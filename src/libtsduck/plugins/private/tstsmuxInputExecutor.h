@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tstsmuxPluginExecutor.h"
+#include "tstsmuxInputAnalyzerInterface.h"
 #include "tsMuxerArgs.h"
 #include "tsInputPlugin.h"
 
@@ -41,6 +42,13 @@ namespace ts {
     namespace tsmux {
         //!
         //! Execution context of a tsmux input plugin.
+        //!
+        //! The input buffer has one single producer, the input thread, and one single consumer,
+        //! the core thread. The packets are exchanged without locking the mutex. The mutex and
+        //! conditions are used only when one of the two threads must wait for the other one.
+        //! With a lossy input, the input thread never waits and drops the oldest packets when
+        //! the buffer is full. The first packet index is then updated under the mutex only.
+        //!
         //! @ingroup plugin
         //!
         class InputExecutor : public PluginExecutor
@@ -53,8 +61,9 @@ namespace ts {
             //! @param [in] handlers Registry of event handlers.
             //! @param [in] index Input plugin index.
             //! @param [in,out] log Log report.
+            //! @param [in] analyzer Optional analyzer of input packets, invoked in the context of the input thread.
             //!
-            InputExecutor(const MuxerArgs& opt, const PluginEventHandlerRegistry& handlers, size_t index, Report& log);
+            InputExecutor(const MuxerArgs& opt, const PluginEventHandlerRegistry& handlers, size_t index, Report& log, InputAnalyzerInterface* analyzer = nullptr);
 
             //!
             //! Virtual destructor.
@@ -63,6 +72,7 @@ namespace ts {
 
             //!
             //! Copy packets from the input buffer.
+            //! Must be called from one single consumer thread.
             //! @param [out] pkt Address of packet buffer.
             //! @param [out] mdata Address of packet metadata buffer.
             //! @param [in] max_count Buffer size in number of packets.
@@ -80,8 +90,19 @@ namespace ts {
             virtual void terminate() override;
 
         private:
-            InputPlugin* _input;         // Plugin API.
-            const size_t _pluginIndex;   // Index of this input plugin.
+            InputPlugin*            _input;            // Plugin API.
+            const size_t            _pluginIndex;      // Index of this input plugin.
+            InputAnalyzerInterface* _analyzer;         // Analysis of input packets in the input thread (may be null).
+            size_t                  _packets_next;     // Index in the buffer of the next received packet (input thread only).
+            std::atomic<bool>       _input_end;        // End of input, no more packet after the ones in the buffer.
+            std::atomic<bool>       _input_waiting;    // The input thread waits on _got_freespace.
+            std::atomic<bool>       _consumer_waiting; // The consumer thread waits on _got_packets.
+
+            // Copy packets from the beginning of the buffer, in the consumer thread.
+            void copyPackets(TSPacket* pkt, TSPacketMetadata* mdata, size_t max_count, size_t& ret_count);
+
+            // Signal a condition to the other thread if it is waiting on it.
+            void signalIfWaiting(const std::atomic<bool>& waiting, Condition& condition);
 
             // Implementation of Thread.
             virtual void main() override;
@@ -93,7 +93,7 @@ namespace ts {
             Condition              _got_freespace;  //!< Wake-up condition: there are more free packets in the buffer.
             volatile bool          _terminate;      //!< Termination request, sometimes accessed outside mutex, goes from false to true only once.
             size_t                 _packets_first;  //!< Index in the buffer of the first packet.
-            size_t                 _packets_count;  //!< Number of packets to output.
+            std::atomic<size_t>    _packets_count;  //!< Number of packets in the buffer (lock-free access in input executors).
             const size_t           _buffer_size;    //!< Size of the packet buffer.
             TSPacketVector         _packets;        //!< Input or output packet circular buffer.
             TSPacketMetadataVector _metadata;       //!< Input or output metadata circular buffer.
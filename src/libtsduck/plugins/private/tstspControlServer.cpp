@@ -35,6 +35,7 @@
 #include "tsTelnetConnection.h"
 #include "tsGuardMutex.h"
 #include "tsSysUtils.h"
+#include "tsTextFormatter.h"
 
 
 //----------------------------------------------------------------------------
@@ -75,6 +76,7 @@ ts::tsp::ControlServer::ControlServer(TSProcessorArgs& options, Report& log, Mut
     _reference.setCommandLineHandler(this, &ControlServer::executeExit, u"exit");
     _reference.setCommandLineHandler(this, &ControlServer::executeSetLog, u"set-log");
     _reference.setCommandLineHandler(this, &ControlServer::executeList, u"list");
+    _reference.setCommandLineHandler(this, &ControlServer::executeStats, u"stats");
     _reference.setCommandLineHandler(this, &ControlServer::executeSuspend, u"suspend");
     _reference.setCommandLineHandler(this, &ControlServer::executeResume, u"resume");
     _reference.setCommandLineHandler(this, &ControlServer::executeRestart, u"restart");
@@ -269,6 +271,46 @@ void ts::tsp::ControlServer::listOnePlugin(size_t index, UChar type, PluginExecu
 }
 
 
+//----------------------------------------------------------------------------
+// Stats command.
+//----------------------------------------------------------------------------
+
+ts::CommandStatus ts::tsp::ControlServer::executeStats(const UString& command, Args& args)
+{
+    if (args.present(u"json")) {
+        // Same JSON format as tsp --statistics-interval.
+        json::Object root;
+        PluginExecutor::GetStatistics(root, _input);
+        TextFormatter text(args);
+        text.setString();
+        text.setEndOfLineMode(TextFormatter::EndOfLineMode::SPACING);
+        root.print(text);
+        args.info(text.toString());
+    }
+    else {
+        statsOnePlugin(0, u'I', _input, args);
+        size_t index = 1;
+        for (size_t i = 0; i < _plugins.size(); ++i) {
+            statsOnePlugin(index++, u'P', _plugins[i], args);
+        }
+        statsOnePlugin(index, u'O', _output, args);
+    }
+    return CommandStatus::SUCCESS;
+}
+
+void ts::tsp::ControlServer::statsOnePlugin(size_t index, UChar type, PluginExecutor* plugin, Report& report)
+{
+    PluginExecutor::Statistics stats;
+    plugin->getStatistics(stats);
+    const NanoSecond elapsed = std::max<NanoSecond>(1, stats.elapsed);
+    report.info(u"%2d: %c-%s: %'d packets, %'d packets/s, processing: %d%%, cpu: %s, waiting: %d%%, queued: %'d, max: %'d",
+                {index, type, plugin->pluginName(), stats.total_packets, stats.packetsPerSecond(),
+                 (100 * std::max<NanoSecond>(0, stats.elapsed - stats.wait_time)) / elapsed,
+                 stats.cpu_time < 0 ? UString(u"unknown") : UString::Format(u"%d%%", {(100 * stats.cpu_time) / elapsed}),
+                 (100 * stats.wait_time) / elapsed, stats.queued, stats.max_queued});
+}
+
+
 //----------------------------------------------------------------------------
 // Suspend/resume commands.
 //----------------------------------------------------------------------------
@@ -99,6 +99,8 @@ namespace ts {
             CommandStatus executeSetLog(const UString&, Args&);
             CommandStatus executeList(const UString&, Args&);
             void listOnePlugin(size_t index, UChar type, PluginExecutor* plugin, Report& report);
+            CommandStatus executeStats(const UString&, Args&);
+            void statsOnePlugin(size_t index, UChar type, PluginExecutor* plugin, Report& report);
             CommandStatus executeSuspend(const UString&, Args&);
             CommandStatus executeResume(const UString&, Args&);
             CommandStatus executeSuspendResume(bool state, Args&);
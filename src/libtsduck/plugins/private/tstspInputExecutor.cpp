@@ -115,19 +115,17 @@ bool ts::tsp::InputExecutor::initAllBuffers(PacketBuffer* buffer, PacketMetadata
         verbose(u"initial input bitrate is %'d b/s", {init_bitrate});
     }
 
-    // Indicate that the loaded packets are now available to the next packet processor.
-    PluginExecutor* next = ringNext<PluginExecutor>();
-    next->initBuffer(buffer, metadata, 0, pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
-
-    // The rest of the buffer belongs to this input processor for reading additional packets.
-    initBuffer(buffer, metadata, pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
-
+    // Indicate that the loaded packets are now available to the next packet processor
+    // (or to all members of a monitor group when the first processors are in a group).
     // All other processors have an implicit empty buffer (_pkt_first and _pkt_cnt are zero).
     // Propagate initial input bitrate to all processors
-    while ((next = next->ringNext<PluginExecutor>()) != this) {
-        next->initBuffer(buffer, metadata, 0, 0, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
+    for (PluginExecutor* next = ringNext<PluginExecutor>(); next != this; next = next->ringNext<PluginExecutor>()) {
+        next->initBuffer(buffer, metadata, 0, isNextExecutor(next) ? pkt_read : 0, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
     }
 
+    // The rest of the buffer belongs to this input processor for reading additional packets.
+    initBuffer(buffer, metadata, pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate, init_confidence);
+
     return true;
 }
 
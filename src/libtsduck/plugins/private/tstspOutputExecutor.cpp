@@ -90,7 +90,7 @@ void ts::tsp::OutputExecutor::main()
         // We ignore the returned "aborted" which comes from the "next"
         // processor in the chain, here the input thread. For the
         // output thread, aborted means was interrupted by user.
-        aborted = _tsp_aborting;
+        aborted = _tsp_aborting.load(std::memory_order_acquire);
 
         // Process restart requests.
         if (!processPendingRestart(restarted)) {
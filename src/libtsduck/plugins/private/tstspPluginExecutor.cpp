@@ -31,6 +31,13 @@
 #include "tsPluginRepository.h"
 #include "tsGuardCondition.h"
 #include "tsGuardMutex.h"
+#include "tsSysUtils.h"
+#include "tsjson.h"
+#include "tsjsonArray.h"
+#include "tsTime.h"
+
+// Minimum interval between two samples of the CPU time of a plugin thread.
+#define CPU_TIME_INTERVAL (100 * ts::NanoSecPerMilliSec)
 
 
 //----------------------------------------------------------------------------
@@ -58,7 +65,31 @@ ts::tsp::PluginExecutor::PluginExecutor(const TSProcessorArgs& options,
     _bitrate(0),
     _br_confidence(BitRateConfidence::LOW),
     _restart(false),
-    _restart_data()
+    _restart_data(),
+    _next_list(),
+    _prev_list(),
+    _group(),
+    _group_passed(0),
+    _group_released(0),
+    _group_ended(false),
+    _stat_start(true),
+    _stat_cpu_last(0),
+    _stat_elapsed(0),
+    _stat_wait(0),
+    _stat_cpu(-1),
+    _stat_plugin_pkt(0),
+    _stat_total_pkt(0),
+    _stat_queued(0),
+    _stat_max_queued(0),
+    _lock_free(options.lock_free_handoff),
+    _wait_mutex(),
+    _sleeping(false),
+    _bitrate_seq(0),
+    _bitrate_seen(0),
+    _seen_bitrate(0),
+    _seen_br_conf(BitRateConfidence::LOW),
+    _passed_bitrate(0),
+    _passed_br_conf(BitRateConfidence::LOW)
 {
     // Preset common default options.
     if (plugin() != nullptr) {
@@ -100,9 +131,90 @@ void ts::tsp::PluginExecutor::signalPluginEvent(uint32_t event_code, Object* plu
 
 void ts::tsp::PluginExecutor::setAbort()
 {
-    GuardMutex lock(_global_mutex);
-    _tsp_aborting = true;
-    ringPrevious<PluginExecutor>()->_to_do.signal();
+    if (_lock_free) {
+        _tsp_aborting.store(true, std::memory_order_release);
+        ringPrevious<PluginExecutor>()->wakeUpLockFree();
+    }
+    else {
+        GuardMutex lock(_global_mutex);
+        _tsp_aborting = true;
+        signalPrevious();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Declare a group of plugin executors which run in parallel as monitors.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::SetMonitorGroup(const std::vector<PluginExecutor*>& members)
+{
+    if (!members.empty()) {
+        PluginExecutor* const prev = members.front()->ringPrevious<PluginExecutor>();
+        PluginExecutor* const next = members.back()->ringNext<PluginExecutor>();
+        prev->_next_list = members;
+        next->_prev_list = members;
+        for (auto it : members) {
+            it->_group = members;
+            it->_prev_list.assign(1, prev);
+            it->_next_list.assign(1, next);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Data flow between plugins.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::isNextExecutor(const PluginExecutor* exec) const
+{
+    return std::find(_next_list.begin(), _next_list.end(), exec) != _next_list.end();
+}
+
+bool ts::tsp::PluginExecutor::nextAborting() const
+{
+    for (auto it : _next_list) {
+        if (it->_tsp_aborting.load(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    // When another member of a monitor group aborts, the whole group aborts.
+    for (auto it : _group) {
+        if (it != this && it->_tsp_aborting.load(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ts::tsp::PluginExecutor::signalPrevious()
+{
+    for (auto it : _prev_list) {
+        it->_to_do.signal();
+    }
+    for (auto it : _group) {
+        if (it != this) {
+            it->_to_do.signal();
+        }
+    }
+}
+
+size_t ts::tsp::PluginExecutor::groupRelease(bool& all_ended)
+{
+    // Packets are released when all members of the group have passed them.
+    PacketCounter passed = _group_passed;
+    all_ended = true;
+    for (auto it : _group) {
+        passed = std::min(passed, it->_group_passed);
+        all_ended = all_ended && it->_group_ended;
+    }
+
+    // The total number of released packets is stored in the first member.
+    PluginExecutor* const first = _group.front();
+    const size_t count = size_t(passed - first->_group_released);
+    first->_group_released = passed;
+    return count;
 }
 
 
@@ -142,6 +254,30 @@ void ts::tsp::PluginExecutor::initBuffer(PacketBuffer*         buffer,
     _br_confidence = br_confidence;
     _tsp_bitrate = bitrate;
     _tsp_bitrate_confidence = br_confidence;
+    _sleeping = false;
+    _bitrate_seq = 0;
+    _bitrate_seen = 0;
+    _seen_bitrate = bitrate;
+    _seen_br_conf = br_confidence;
+    _passed_bitrate = bitrate;
+    _passed_br_conf = br_confidence;
+    _group_passed = 0;
+    _group_released = 0;
+    _group_ended = false;
+    _stat_start.getSystemTime();
+    _stat_cpu_last = 0;
+    _stat_elapsed = 0;
+    _stat_wait = 0;
+    _stat_cpu = -1;
+    _stat_queued = _stat_max_queued = pkt_cnt;
+
+    // Default data flow: from previous to next plugin in the ring (see SetMonitorGroup()).
+    if (_next_list.empty()) {
+        _next_list.push_back(ringNext<PluginExecutor>());
+    }
+    if (_prev_list.empty()) {
+        _prev_list.push_back(ringPrevious<PluginExecutor>());
+    }
 }
 
 
@@ -155,6 +291,15 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, const BitRate& bitrate,
 
     log(10, u"passPackets(count = %'d, bitrate = %'d, input_end = %s, aborted = %s)", {count, bitrate, input_end, aborted});
 
+    // Last packets from this plugin, record the final statistics.
+    if (input_end || aborted) {
+        updateStatistics(Monotonic(true), true);
+    }
+
+    if (_lock_free) {
+        return passPacketsLockFree(count, bitrate, br_confidence, input_end, aborted);
+    }
+
     // We access data under the protection of the global mutex.
     GuardMutex lock(_global_mutex);
 
@@ -162,30 +307,44 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, const BitRate& bitrate,
     _pkt_first = (_pkt_first + count) % _buffer->count();
     _pkt_cnt -= count;
 
-    // Update next processor's buffer: add 'count' packets at the end of its slice of the buffer.
-    PluginExecutor* next = ringNext<PluginExecutor>();
-    next->_pkt_cnt += count;
-
-    // Propagate bitrate and end of input flag to next processor.
-    next->_bitrate = bitrate;
-    next->_br_confidence = br_confidence;
-    next->_input_end = next->_input_end || input_end;
+    // In a monitor group, the next processor gets the packets which were passed by all members of the group
+    // and the end of input when all members have terminated.
+    size_t release = count;
+    bool release_end = input_end;
+    if (!_group.empty()) {
+        _group_passed += count;
+        _group_ended = _group_ended || input_end || aborted;
+        release = groupRelease(release_end);
+    }
 
-    // Wake the next processor when there is some new input data or end of input.
-    if (count > 0 || input_end) {
-        next->_to_do.signal();
+    for (auto next : _next_list) {
+        // Update next processor's buffer: add 'release' packets at the end of its slice of the buffer.
+        TS_PUSH_WARNING()
+        TS_GCC_NOWARNING(stringop-overflow) // workaround for a bug in GCC 12 with atomic operations
+        next->_pkt_cnt += release;
+        TS_POP_WARNING()
+
+        // Propagate bitrate and end of input flag to next processor.
+        next->_bitrate = bitrate;
+        next->_br_confidence = br_confidence;
+        next->_input_end = next->_input_end || release_end;
+
+        // Wake the next processor when there is some new input data or end of input.
+        if (release > 0 || release_end) {
+            next->_to_do.signal();
+        }
     }
 
     // Force to abort our processor when the next one is aborting. Already done in waitWork() but force immediately.
     // Don't do that if current is output and next is input because there is no propagation of packets from output back to input.
     if (plugin()->type() != PluginType::OUTPUT) {
-        aborted = aborted || next->_tsp_aborting;
+        aborted = aborted || nextAborting();
     }
 
     // Wake the previous processor when we abort (propagate abort conditions backward).
     if (aborted) {
-        _tsp_aborting = true; // volatile bool in TSP superclass
-        ringPrevious<PluginExecutor>()->_to_do.signal();
+        _tsp_aborting = true; // atomic bool in TSP superclass
+        signalPrevious();
     }
 
     // Return false when the current processor shall stop.
@@ -203,20 +362,28 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
 {
     log(10, u"waitWork(min_pkt_cnt = %'d, ...)", {min_pkt_cnt});
 
+    // The time in this method is accounted as waiting time (including the contention on the global mutex).
+    const Monotonic start(true);
+
     // Cannot allocate more than the buffer size.
     if (min_pkt_cnt > _buffer->count()) {
         debug(u"requests too many packets at a time: %'d, larger than buffer size: %'d", {min_pkt_cnt, _buffer->count()});
         min_pkt_cnt = _buffer->count();
     }
 
+    if (_lock_free) {
+        waitWorkLockFree(min_pkt_cnt, pkt_first, pkt_cnt, bitrate, br_confidence, input_end, aborted, timeout);
+        updateStatistics(start, input_end || aborted || timeout);
+        return;
+    }
+
     // We access data under the protection of the global mutex.
     GuardCondition lock(_global_mutex, _to_do);
 
-    PluginExecutor* next = ringNext<PluginExecutor>();
     timeout = false;
 
     // Loop until enough packets are available (or some error condition).
-    while (_pkt_cnt < min_pkt_cnt && !_input_end && !timeout && !next->_tsp_aborting) {
+    while (_pkt_cnt < min_pkt_cnt && !_input_end && !timeout && !nextAborting()) {
         // If packet area for this processor is empty, wait for some packet.
         // The mutex is implicitely released, we wait for the condition
         // '_to_do' and, once we get it, implicitely relock the mutex.
@@ -233,7 +400,7 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
     }
     else if (_pkt_first + min_pkt_cnt <= _buffer->count()) {
         // Return up to the wrap-up point. This will satisfy the requested minimum.
-        pkt_cnt = std::min(_pkt_cnt, _buffer->count() - _pkt_first);
+        pkt_cnt = std::min(_pkt_cnt.load(), _buffer->count() - _pkt_first);
     }
     else {
         // The requested minimum does not fit into a contiguous area.
@@ -248,7 +415,257 @@ void ts::tsp::PluginExecutor::waitWork(size_t min_pkt_cnt, size_t& pkt_first, si
     // Force to abort our processor when the next one is aborting.
     // Don't do that if current is output and next is input because
     // there is no propagation of packets from output back to input.
-    aborted = plugin()->type() != PluginType::OUTPUT && next->_tsp_aborting;
+    aborted = plugin()->type() != PluginType::OUTPUT && nextAborting();
+    updateStatistics(start, input_end || aborted || timeout);
+
+    log(10, u"waitWork(min_pkt_cnt = %'d, pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
+        {min_pkt_cnt, pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout});
+}
+
+
+//----------------------------------------------------------------------------
+// Instrumentation counters.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginExecutor::Statistics::Statistics() :
+    plugin_packets(0),
+    total_packets(0),
+    elapsed(0),
+    wait_time(0),
+    cpu_time(-1),
+    queued(0),
+    max_queued(0),
+    buffer_size(0)
+{
+}
+
+ts::PacketCounter ts::tsp::PluginExecutor::Statistics::packetsPerSecond() const
+{
+    return elapsed <= 0 ? 0 : PacketCounter((double(total_packets) * NanoSecPerSec) / double(elapsed));
+}
+
+// Executed in the plugin thread at the end of waitWork().
+void ts::tsp::PluginExecutor::updateStatistics(const Monotonic& start, bool final)
+{
+    const Monotonic now(true);
+    const NanoSecond elapsed = now - _stat_start;
+    const size_t queued = _pkt_cnt;
+
+    _stat_wait += now - start;
+    _stat_plugin_pkt = pluginPackets();
+    _stat_total_pkt = totalPacketsInThread();
+    _stat_queued = queued;
+    if (queued > _stat_max_queued) {
+        _stat_max_queued = queued;
+    }
+
+    // Getting the CPU time of the thread may be a system call, don't do it too often.
+    if (final || elapsed - _stat_cpu_last >= CPU_TIME_INTERVAL) {
+        _stat_cpu = GetThreadCPUTime();
+        _stat_cpu_last = elapsed;
+    }
+
+    // Updated last, it marks a consistent set of counters.
+    _stat_elapsed = elapsed;
+}
+
+void ts::tsp::PluginExecutor::getStatistics(Statistics& stats) const
+{
+    stats.elapsed = _stat_elapsed;
+    stats.wait_time = _stat_wait;
+    stats.cpu_time = _stat_cpu;
+    stats.plugin_packets = _stat_plugin_pkt;
+    stats.total_packets = _stat_total_pkt;
+    stats.queued = _stat_queued;
+    stats.max_queued = _stat_max_queued;
+    stats.buffer_size = _buffer == nullptr ? 0 : _buffer->count();
+}
+
+void ts::tsp::PluginExecutor::getStatistics(json::Object& obj) const
+{
+    Statistics stats;
+    getStatistics(stats);
+
+    // The input plugin waits for free space in the buffer, which is released by the output plugin.
+    // All other plugins wait for packets from the previous plugin.
+    const bool input = plugin() != nullptr && plugin()->type() == PluginType::INPUT;
+
+    obj.add(u"index", int64_t(pluginIndex()));
+    obj.add(u"type", plugin() == nullptr ? UString() : PluginTypeNames.name(plugin()->type()));
+    obj.add(u"name", pluginName());
+    obj.add(u"suspended", json::Bool(getSuspended()));
+    obj.add(u"packets", int64_t(stats.total_packets));
+    obj.add(u"plugin-packets", int64_t(stats.plugin_packets));
+    obj.add(u"packets-per-second", int64_t(stats.packetsPerSecond()));
+    obj.add(u"elapsed-us", stats.elapsed / NanoSecPerMicroSec);
+    obj.add(u"processing-us", std::max<NanoSecond>(0, stats.elapsed - stats.wait_time) / NanoSecPerMicroSec);
+    obj.add(u"blocked-on-previous-us", input ? 0 : stats.wait_time / NanoSecPerMicroSec);
+    obj.add(u"blocked-on-next-us", input ? stats.wait_time / NanoSecPerMicroSec : 0);
+    if (stats.cpu_time >= 0) {
+        obj.add(u"cpu-us", stats.cpu_time / NanoSecPerMicroSec);
+    }
+    obj.add(u"queued-packets", int64_t(stats.queued));
+    obj.add(u"max-queued-packets", int64_t(stats.max_queued));
+    obj.add(u"buffer-packets", int64_t(stats.buffer_size));
+}
+
+void ts::tsp::PluginExecutor::GetStatistics(json::Object& root, PluginExecutor* input)
+{
+    root.add(u"time", Time::CurrentLocalTime().format(Time::DATETIME | Time::MILLISECOND));
+    json::ValuePtr plugins(new json::Array);
+    if (input != nullptr) {
+        PluginExecutor* proc = input;
+        do {
+            json::ValuePtr obj(new json::Object);
+            proc->getStatistics(*static_cast<json::Object*>(obj.pointer()));
+            plugins->set(obj);
+        } while ((proc = proc->ringNext<PluginExecutor>()) != input);
+    }
+    root.add(u"plugins", plugins);
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free handoff mode: wake up this plugin thread if it is sleeping.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::wakeUpLockFree()
+{
+    // The caller has just updated some shared state of this plugin executor
+    // (packet count, end of input, abort). The fence guarantees that either
+    // this thread sees _sleeping set or the waiting thread sees the new state
+    // when it rechecks its wait condition after setting _sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_sleeping.load()) {
+        GuardMutex lock(_wait_mutex);
+        _to_do.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free handoff mode: pass processed packets to the next plugin.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::passPacketsLockFree(size_t count, const BitRate& bitrate, BitRateConfidence br_confidence, bool input_end, bool aborted)
+{
+    PluginExecutor* next = ringNext<PluginExecutor>();
+
+    // Update our buffer: we remove the first 'count' packets from the beginning of our slice of the buffer.
+    // The start of the area is only used by this thread. Our packet count is concurrently incremented
+    // by the previous plugin thread.
+    _pkt_first = (_pkt_first + count) % _buffer->count();
+    _pkt_cnt.fetch_sub(count);
+
+    // Propagate bitrate to next processor, only when modified (bitrates do not change often).
+    // The bitrate must be visible in the next processor before the corresponding packets.
+    if (bitrate != _passed_bitrate || br_confidence != _passed_br_conf) {
+        GuardMutex lock(next->_wait_mutex);
+        next->_bitrate = _passed_bitrate = bitrate;
+        next->_br_confidence = _passed_br_conf = br_confidence;
+        next->_bitrate_seq.fetch_add(1);
+    }
+
+    // Update next processor's buffer: add 'count' packets at the end of its slice of the buffer.
+    // The atomic operation is a release operation which publishes the content of the packets.
+    if (count > 0) {
+        next->_pkt_cnt.fetch_add(count);
+    }
+    if (input_end) {
+        next->_input_end = true;
+    }
+
+    // Wake the next processor when there is some new input data or end of input.
+    if (count > 0 || input_end) {
+        next->wakeUpLockFree();
+    }
+
+    // Force to abort our processor when the next one is aborting.
+    // Don't do that if current is output and next is input because there is no propagation of packets from output back to input.
+    if (plugin()->type() != PluginType::OUTPUT) {
+        aborted = aborted || next->_tsp_aborting.load(std::memory_order_acquire);
+    }
+
+    // Wake the previous processor when we abort (propagate abort conditions backward).
+    if (aborted) {
+        _tsp_aborting.store(true, std::memory_order_release);
+        ringPrevious<PluginExecutor>()->wakeUpLockFree();
+    }
+
+    // Return false when the current processor shall stop.
+    return !input_end && !aborted;
+}
+
+
+//----------------------------------------------------------------------------
+// Lock-free handoff mode: wait for packets to process or some error condition.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitWorkLockFree(size_t min_pkt_cnt, size_t& pkt_first, size_t& pkt_cnt,
+                                               BitRate& bitrate, BitRateConfidence& br_confidence,
+                                               bool& input_end, bool& aborted, bool &timeout)
+{
+    PluginExecutor* next = ringNext<PluginExecutor>();
+    timeout = false;
+
+    // Fast path: enough packets are already there, no need to lock anything.
+    if (_pkt_cnt.load() < min_pkt_cnt && !_input_end && !next->_tsp_aborting.load(std::memory_order_acquire)) {
+
+        // Need to wait. The per-plugin mutex is used only to sleep on our condition.
+        GuardCondition lock(_wait_mutex, _to_do);
+
+        while (!timeout) {
+            // Declare that we are about to sleep, then check again the wait condition.
+            // The previous and next threads check _sleeping after updating the shared state.
+            _sleeping = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_pkt_cnt.load() >= min_pkt_cnt || _input_end || next->_tsp_aborting.load(std::memory_order_acquire)) {
+                break;
+            }
+            // The mutex is implicitely released while waiting, so that other threads can signal us.
+            // If there is a timeout in the packet reception, call the plugin handler.
+            timeout = !lock.waitCondition(_tsp_timeout) && !plugin()->handlePacketTimeout();
+        }
+        _sleeping = false;
+    }
+
+    // Get a new bitrate if the previous plugin has set one.
+    if (_bitrate_seq.load() != _bitrate_seen) {
+        GuardMutex lock(_wait_mutex);
+        _bitrate_seen = _bitrate_seq.load();
+        _seen_bitrate = _bitrate;
+        _seen_br_conf = _br_confidence;
+    }
+    bitrate = _seen_bitrate;
+    br_confidence = _seen_br_conf;
+
+    // Read the end of input before the packet count: when end of input is set, the
+    // previous plugin has already added its last packets.
+    const bool end = _input_end;
+    const size_t avail = _pkt_cnt.load();
+
+    // The number of returned packets is limited up to the wrap-up point of the circular buffer,
+    // if allowed by the requested minimum number of packets.
+    if (timeout) {
+        // Nothing returned.
+        pkt_cnt = 0;
+    }
+    else if (_pkt_first + min_pkt_cnt <= _buffer->count()) {
+        // Return up to the wrap-up point. This will satisfy the requested minimum.
+        pkt_cnt = std::min(avail, _buffer->count() - _pkt_first);
+    }
+    else {
+        // The requested minimum does not fit into a contiguous area.
+        pkt_cnt = avail;
+    }
+
+    pkt_first = _pkt_first;
+    input_end = end && pkt_cnt == avail;
+
+    // Force to abort our processor when the next one is aborting.
+    // Don't do that if current is output and next is input because
+    // there is no propagation of packets from output back to input.
+    aborted = plugin()->type() != PluginType::OUTPUT && next->_tsp_aborting.load(std::memory_order_acquire);
 
     log(10, u"waitWork(min_pkt_cnt = %'d, pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
         {min_pkt_cnt, pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout});
@@ -39,6 +39,8 @@
 #include "tsPluginEventHandlerRegistry.h"
 #include "tsPlugin.h"
 #include "tsUserInterrupt.h"
+#include "tsjsonObject.h"
+#include "tsMonotonic.h"
 #include "tsCondition.h"
 #include "tsMutex.h"
 #include "tsThread.h"
@@ -97,6 +99,22 @@ namespace ts {
                             const BitRate&        bitrate,
                             BitRateConfidence     br_confidence);
 
+            //!
+            //! Declare a group of plugin executors which run in parallel as read-only monitors.
+            //! Must be executed in synchronous environment, after building the ring of executors
+            //! and before initializing the buffers. All members of the group receive the same
+            //! packets from the plugin before the group. The plugin after the group receives
+            //! the packets when all members of the group have released them.
+            //! @param [in] members Plugin executors in the group, consecutive in the ring.
+            //!
+            static void SetMonitorGroup(const std::vector<PluginExecutor*>& members);
+
+            //!
+            //! Check if the plugin is a member of a monitor group.
+            //! @return True if the plugin is a member of a monitor group.
+            //!
+            bool inMonitorGroup() const { return !_group.empty(); }
+
             //!
             //! Inform if all plugins should use defaults for real-time.
             //! @param [in] on True if all plugins should use defaults for real-time.
@@ -145,6 +163,57 @@ namespace ts {
             //!
             void restart(Report& report);
 
+            //!
+            //! Instrumentation counters of a plugin executor.
+            //! The time which is not spent waiting is the processing time of the plugin.
+            //!
+            class Statistics
+            {
+            public:
+                PacketCounter plugin_packets;  //!< Number of packets which were submitted to the plugin.
+                PacketCounter total_packets;   //!< Number of packets in the plugin thread, including dropped or excluded packets.
+                NanoSecond    elapsed;         //!< Elapsed time since the start of the processing.
+                NanoSecond    wait_time;       //!< Time waiting for packets from the previous plugin (or for free buffer in the input plugin).
+                NanoSecond    cpu_time;        //!< CPU time of the plugin thread, negative if unavailable.
+                size_t        queued;          //!< Current number of packets in the area of the plugin in the global buffer.
+                size_t        max_queued;      //!< High-water mark of the number of packets in the area of the plugin.
+                size_t        buffer_size;     //!< Size in packets of the global buffer.
+
+                //!
+                //! Default constructor.
+                //!
+                Statistics();
+
+                //!
+                //! Get the number of packets per second, based on the elapsed time.
+                //! @return The number of packets per second, zero if unknown.
+                //!
+                PacketCounter packetsPerSecond() const;
+            };
+
+            //!
+            //! Get the instrumentation counters of the plugin executor.
+            //! Can be called from any thread. The counters are updated by the
+            //! plugin thread each time it gets new packets to process.
+            //! @param [out] stats Receive the counters.
+            //!
+            void getStatistics(Statistics& stats) const;
+
+            //!
+            //! Get the instrumentation counters of the plugin executor as a JSON object.
+            //! Can be called from any thread.
+            //! @param [out] obj Receive the index, type and name of the plugin and its counters.
+            //!
+            void getStatistics(json::Object& obj) const;
+
+            //!
+            //! Get the instrumentation counters of all plugins in a chain as a JSON object.
+            //! Can be called from any thread.
+            //! @param [out] root Receive the current time and an array named "plugins", one object per plugin.
+            //! @param [in] input Input plugin executor, start of the chain.
+            //!
+            static void GetStatistics(json::Object& root, PluginExecutor* input);
+
             // Implementation of TSP virtual methods.
             virtual size_t pluginCount() const override;
             virtual void signalPluginEvent(uint32_t event_code, Object* plugin_data = nullptr) const override;
@@ -154,6 +223,14 @@ namespace ts {
             PacketMetadataBuffer* _metadata;  //!< Description of shared packet metadata buffer.
             volatile bool         _suspended; //!< The plugin is suspended / resumed.
 
+            //!
+            //! Check if a plugin executor receives the packets which are passed by this one.
+            //! There are several next plugins when this one is just before a monitor group.
+            //! @param [in] exec A plugin executor.
+            //! @return True if @a exec is a next plugin executor of this one.
+            //!
+            bool isNextExecutor(const PluginExecutor* exec) const;
+
             //!
             //! Pass processed packets to the next packet processor.
             //!
@@ -228,14 +305,71 @@ namespace ts {
             // The following private data must be accessed exclusively under the protection of the global mutex.
             // Implementation details: see the file src/docs/developing-plugins.dox.
             // [*] After initialization, these fields are read/written only in passPackets() and waitWork().
-            Condition         _to_do;          // Notify processor to do something.
-            size_t            _pkt_first;      // Starting index of packets area [*]
-            size_t            _pkt_cnt;        // Size of packets area [*]
-            bool              _input_end;      // No more packet after current ones [*]
-            BitRate           _bitrate;        // Input bitrate (set by previous plugin) [*]
-            BitRateConfidence _br_confidence;  // Input bitrate confidence (set by previous plugin) [*]
-            bool              _restart;        // Restart the plugin asap using _restart_data
-            RestartDataPtr    _restart_data;   // How to restart the plugin
+            // [LF] In lock-free handoff mode, these fields are not protected by the global mutex (see below).
+            Condition           _to_do;          // Notify processor to do something.
+            size_t              _pkt_first;      // Starting index of packets area [*] [LF: owned by this plugin thread]
+            std::atomic<size_t> _pkt_cnt;        // Size of packets area [*] [LF: incremented by previous, decremented by this]
+            std::atomic<bool>   _input_end;      // No more packet after current ones [*] [LF: set by previous]
+            BitRate             _bitrate;        // Input bitrate (set by previous plugin) [*] [LF: under _wait_mutex]
+            BitRateConfidence   _br_confidence;  // Input bitrate confidence (set by previous plugin) [*] [LF: under _wait_mutex]
+            bool                _restart;        // Restart the plugin asap using _restart_data
+            RestartDataPtr      _restart_data;   // How to restart the plugin
+
+            // Data flow between plugins. By default, a plugin passes packets to the next plugin in the ring
+            // and receives packets from the previous one. Before and after a monitor group (tsp option
+            // --monitor-group), there are several next or previous plugins, the members of the group.
+            std::vector<PluginExecutor*> _next_list;  // Next plugins, receive the packets we pass.
+            std::vector<PluginExecutor*> _prev_list;  // Previous plugins, signaled when we abort.
+            std::vector<PluginExecutor*> _group;      // All members of our monitor group, including us, empty if none.
+            PacketCounter       _group_passed;   // Total packets passed by this member of a monitor group [*]
+            PacketCounter       _group_released; // Total packets released to the next plugin, in first member of the group [*]
+            bool                _group_ended;    // This member of a monitor group has terminated [*]
+
+            // Instrumentation counters, updated by this plugin thread in waitWork(), read by any thread.
+            Monotonic                  _stat_start;      // Start time of the processing.
+            NanoSecond                 _stat_cpu_last;   // Time of last CPU time sample, from _stat_start.
+            std::atomic<NanoSecond>    _stat_elapsed;    // Elapsed time at last update.
+            std::atomic<NanoSecond>    _stat_wait;       // Total time in waitWork().
+            std::atomic<NanoSecond>    _stat_cpu;        // CPU time of the plugin thread.
+            std::atomic<PacketCounter> _stat_plugin_pkt; // Value of pluginPackets() at last update.
+            std::atomic<PacketCounter> _stat_total_pkt;  // Value of totalPacketsInThread() at last update.
+            std::atomic<size_t>        _stat_queued;     // Packets in our area of the buffer at last update.
+            std::atomic<size_t>        _stat_max_queued; // High-water mark of _stat_queued.
+
+            // Lock-free handoff mode (tsp option --lock-free-handoff). Each pair of adjacent plugins
+            // synchronizes independently. Packet counts and end of input are passed using atomic
+            // variables. The per-plugin _wait_mutex is used with _to_do only when the plugin thread
+            // actually needs to sleep and to pass a new bitrate, which rarely changes.
+            const bool             _lock_free;      // Use lock-free handoff instead of the global mutex.
+            Mutex                  _wait_mutex;     // Per-plugin mutex for _to_do and bitrate in lock-free mode.
+            std::atomic<bool>      _sleeping;       // This plugin thread is waiting (or about to wait) on _to_do.
+            std::atomic<uint32_t>  _bitrate_seq;    // Incremented by previous plugin each time _bitrate is updated.
+            uint32_t               _bitrate_seen;   // Last value of _bitrate_seq which was read by this plugin thread.
+            BitRate                _seen_bitrate;   // Copy of _bitrate, as read by this plugin thread.
+            BitRateConfidence      _seen_br_conf;   // Copy of _br_confidence, as read by this plugin thread.
+            BitRate                _passed_bitrate; // Last bitrate which was passed to next plugin (by this plugin thread).
+            BitRateConfidence      _passed_br_conf; // Last bitrate confidence which was passed to next plugin.
+
+            // Check if a next plugin or another member of our monitor group is aborting.
+            bool nextAborting() const;
+
+            // Signal all previous plugins and other members of our monitor group (when we abort).
+            void signalPrevious();
+
+            // In a monitor group, compute the number of packets which were passed by all members and are not yet released.
+            size_t groupRelease(bool& all_ended);
+
+            // Update the instrumentation counters at the end of waitWork().
+            void updateStatistics(const Monotonic& start, bool final);
+
+            // Implementation of passPackets() and waitWork() in lock-free handoff mode.
+            bool passPacketsLockFree(size_t count, const BitRate& bitrate, BitRateConfidence br_confidence, bool input_end, bool aborted);
+            void waitWorkLockFree(size_t min_pkt_cnt, size_t& pkt_first, size_t& pkt_cnt,
+                                  BitRate& bitrate, BitRateConfidence& br_confidence,
+                                  bool& input_end, bool& aborted, bool &timeout);
+
+            // In lock-free handoff mode, wake up this plugin thread if it is waiting for something to do.
+            void wakeUpLockFree();
 
             // Description of a restart operation.
             class RestartData
@@ -90,7 +90,18 @@ void ts::tsp::ProcessorExecutor::main()
     }
 
     // Perform the complete packet processing in individual-packet or packet-window mode.
-    if (window_size == 0) {
+    // In a monitor group, the plugin shares the packets with the other members of the group
+    // and only reads them. Packet windows are not supported in this case.
+    if (inMonitorGroup()) {
+        if (_processor->getPacketWindowSize() == 0) {
+            processMonitorPackets();
+        }
+        else {
+            error(u"plugin %s uses packet windows, cannot be used in a monitor group", {pluginName()});
+            passPackets(0, _tsp_bitrate, _tsp_bitrate_confidence, true, true);
+        }
+    }
+    else if (window_size == 0) {
         processIndividualPackets();
     }
     else {
@@ -104,12 +115,14 @@ void ts::tsp::ProcessorExecutor::main()
 
 
 //----------------------------------------------------------------------------
-// Process packets one by one.
+// Process packets one by one or by contiguous batches.
 //----------------------------------------------------------------------------
 
 void ts::tsp::ProcessorExecutor::processIndividualPackets()
 {
     TSPacketMetadata::LabelSet only_labels(_processor->getOnlyLabelOption());
+    bool use_batches = _processor->usePacketBatches();
+    std::vector<bool> batch_was_null; // In packet batch mode, the packet was a null packet before processing.
     PacketCounter passed_packets = 0;
     PacketCounter dropped_packets = 0;
     PacketCounter nullified_packets = 0;
@@ -139,8 +152,9 @@ void ts::tsp::ProcessorExecutor::processIndividualPackets()
             timeout = true; // restart error
         }
         else if (restarted) {
-            // Plugin was restarted, need to recheck --only-label
+            // Plugin was restarted, need to recheck --only-label and batch mode.
             only_labels = _processor->getOnlyLabelOption();
+            use_batches = _processor->usePacketBatches();
         }
 
         // In case of abort on timeout, notify previous and next plugin, then exit.
@@ -173,6 +187,81 @@ void ts::tsp::ProcessorExecutor::processIndividualPackets()
             TSPacketMetadata* const pkt_data = _metadata->base() + pkt_first + pkt_done;
             bool got_new_bitrate = false;
 
+            // In packet batch mode, process the longest possible sequence of packets to submit to the plugin.
+            if (use_batches && !_suspended) {
+                // Do not exceed the periodic flush.
+                const size_t max_batch = _options.max_flush_pkt == 0 ? pkt_cnt - pkt_done : std::min(pkt_cnt - pkt_done, std::max<size_t>(1, _options.max_flush_pkt - std::min(pkt_flush, _options.max_flush_pkt)));
+                size_t batch = 0;
+                batch_was_null.clear();
+                while (batch < max_batch && pkt[batch].b[0] != 0 && (only_labels.none() || pkt_data[batch].hasAnyLabel(only_labels))) {
+                    batch_was_null.push_back(pkt[batch].getPID() == PID_NULL);
+                    pkt_data[batch].setFlush(false);
+                    pkt_data[batch].setBitrateChanged(false);
+                    pkt_data[batch].setDropRequested(false);
+                    pkt_data[batch].setNullRequested(false);
+                    batch++;
+                }
+                if (batch > 0) {
+                    // Let the plugin process the batch. All packets are submitted to the plugin.
+                    const size_t processed = std::min(batch, _processor->processPackets(pkt, pkt_data, batch));
+                    addPluginPackets(processed);
+
+                    // Apply the individual packet status, same as the statuses of processPacket().
+                    bool flush = false;
+                    bool bitrate_changed = false;
+                    for (size_t i = 0; i < processed; ++i) {
+                        if (pkt_data[i].getDropRequested()) {
+                            pkt[i].b[0] = 0;
+                            dropped_packets++;
+                        }
+                        else {
+                            if (pkt_data[i].getNullRequested()) {
+                                pkt[i] = NullPacket;
+                            }
+                            else {
+                                passed_packets++;
+                            }
+                            // Detect if the packet was nullified by the plugin, either on request or by overwriting the packet.
+                            if (!batch_was_null[i] && pkt[i].getPID() == PID_NULL) {
+                                pkt_data[i].setNullified(true);
+                                nullified_packets++;
+                            }
+                        }
+                        flush = flush || pkt_data[i].getFlush();
+                        bitrate_changed = bitrate_changed || pkt_data[i].getBitrateChanged();
+                    }
+
+                    // If the packet processor has signaled a new bitrate, get it.
+                    if (bitrate_changed) {
+                        const BitRate new_bitrate = _processor->getBitrate();
+                        if (new_bitrate != 0) {
+                            bitrate_never_modified = false;
+                            got_new_bitrate = new_bitrate != output_bitrate;
+                            output_bitrate = new_bitrate;
+                            br_confidence = _processor->getBitrateConfidence();
+                        }
+                    }
+
+                    pkt_done += processed;
+                    pkt_flush += processed;
+
+                    // Not all packets processed: signal end of input to successors and abort to predecessors.
+                    if (processed < batch) {
+                        debug(u"plugin requests termination");
+                        input_end = aborted = true;
+                        pkt_cnt = pkt_done;
+                    }
+
+                    // Same flush conditions as individual packets.
+                    if (flush || got_new_bitrate || pkt_done == pkt_cnt || (_options.max_flush_pkt > 0 && pkt_flush >= _options.max_flush_pkt)) {
+                        aborted = !passPackets(pkt_flush, output_bitrate, br_confidence, pkt_done == pkt_cnt && input_end, aborted);
+                        pkt_flush = 0;
+                    }
+                    continue;
+                }
+                // Otherwise, the first packet is not submitted to the plugin, use the individual packet processing.
+            }
+
             pkt_done++;
             pkt_flush++;
 
@@ -260,6 +349,208 @@ void ts::tsp::ProcessorExecutor::processIndividualPackets()
 }
 
 
+//----------------------------------------------------------------------------
+// Process packets as a member of a monitor group.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ProcessorExecutor::processMonitorPackets()
+{
+    TSPacketMetadata::LabelSet only_labels(_processor->getOnlyLabelOption());
+    bool use_batches = _processor->usePacketBatches();
+    BitRate output_bitrate = _tsp_bitrate;
+    BitRateConfidence br_confidence = _tsp_bitrate_confidence;
+    bool bitrate_never_modified = true;
+    bool input_end = false;
+    bool aborted = false;
+    bool restarted = false;
+    bool status_warning = false;
+
+    // Packets are concurrently read by all members of the group. The plugin
+    // processes a private copy of each packet and its metadata. In packet batch
+    // mode, the plugin may keep the addresses of the packets until the end of
+    // processPackets(), the private copy is a buffer of packets.
+    TSPacket pkt;
+    TSPacketMetadata pkt_data;
+    TSPacketVector batch_pkt;
+    TSPacketMetadataVector batch_data;
+
+    do {
+        // Wait for packets to process
+        size_t pkt_first = 0;
+        size_t pkt_cnt = 0;
+        bool timeout = false;
+        waitWork(1, pkt_first, pkt_cnt, _tsp_bitrate, _tsp_bitrate_confidence, input_end, aborted, timeout);
+
+        // If bitrate was never modified by the plugin, always copy the input bitrate as output bitrate.
+        if (bitrate_never_modified) {
+            output_bitrate = _tsp_bitrate;
+            br_confidence = _tsp_bitrate_confidence;
+        }
+
+        // Process restart requests.
+        if (!processPendingRestart(restarted)) {
+            timeout = true; // restart error
+        }
+        else if (restarted) {
+            only_labels = _processor->getOnlyLabelOption();
+            use_batches = _processor->usePacketBatches();
+        }
+
+        // Same termination conditions as individual packets.
+        if (timeout || (aborted && !input_end)) {
+            passPackets(0, output_bitrate, br_confidence, true, true);
+            break;
+        }
+        if (pkt_cnt == 0 && input_end) {
+            passPackets(0, output_bitrate, br_confidence, true, false);
+            break;
+        }
+
+        // Now process the packets.
+        size_t pkt_done = 0;
+        size_t pkt_flush = 0;
+
+        while (pkt_done < pkt_cnt && !aborted) {
+
+            const TSPacket* const buf_pkt = _buffer->base() + pkt_first + pkt_done;
+            const TSPacketMetadata* const buf_data = _metadata->base() + pkt_first + pkt_done;
+            bool got_new_bitrate = false;
+            bool flush = false;
+
+            // In packet batch mode, submit a private copy of the longest possible sequence of packets.
+            if (use_batches && !_suspended) {
+                // Do not exceed the periodic flush.
+                const size_t max_batch = _options.max_flush_pkt == 0 ? pkt_cnt - pkt_done : std::min(pkt_cnt - pkt_done, std::max<size_t>(1, _options.max_flush_pkt - std::min(pkt_flush, _options.max_flush_pkt)));
+                size_t batch = 0;
+                while (batch < max_batch && buf_pkt[batch].b[0] != 0 && (only_labels.none() || buf_data[batch].hasAnyLabel(only_labels))) {
+                    batch++;
+                }
+                if (batch > 0) {
+                    if (batch_pkt.size() < batch) {
+                        batch_pkt.resize(batch);
+                        batch_data.resize(batch);
+                    }
+                    std::copy(buf_pkt, buf_pkt + batch, batch_pkt.begin());
+                    std::copy(buf_data, buf_data + batch, batch_data.begin());
+                    for (size_t i = 0; i < batch; ++i) {
+                        batch_data[i].setFlush(false);
+                        batch_data[i].setBitrateChanged(false);
+                        batch_data[i].setDropRequested(false);
+                        batch_data[i].setNullRequested(false);
+                    }
+
+                    // Let the plugin process the batch.
+                    const size_t processed = std::min(batch, _processor->processPackets(batch_pkt.data(), batch_data.data(), batch));
+                    addPluginPackets(processed);
+
+                    // A monitor cannot modify the stream, drop and nullify requests are ignored.
+                    bool bitrate_changed = false;
+                    for (size_t i = 0; i < processed; ++i) {
+                        if ((batch_data[i].getDropRequested() || batch_data[i].getNullRequested()) && !status_warning) {
+                            warning(u"plugin in a monitor group cannot drop or nullify packets, ignored");
+                            status_warning = true;
+                        }
+                        flush = flush || batch_data[i].getFlush();
+                        bitrate_changed = bitrate_changed || batch_data[i].getBitrateChanged();
+                    }
+
+                    // If the packet processor has signaled a new bitrate, get it.
+                    if (bitrate_changed) {
+                        const BitRate new_bitrate = _processor->getBitrate();
+                        if (new_bitrate != 0) {
+                            bitrate_never_modified = false;
+                            got_new_bitrate = new_bitrate != output_bitrate;
+                            output_bitrate = new_bitrate;
+                            br_confidence = _processor->getBitrateConfidence();
+                        }
+                    }
+
+                    pkt_done += processed;
+                    pkt_flush += processed;
+
+                    // Not all packets processed: signal end of input to successors and abort to predecessors.
+                    if (processed < batch) {
+                        debug(u"plugin requests termination");
+                        input_end = aborted = true;
+                        pkt_cnt = pkt_done;
+                    }
+
+                    // Same flush conditions as individual packets.
+                    if (flush || got_new_bitrate || pkt_done == pkt_cnt || (_options.max_flush_pkt > 0 && pkt_flush >= _options.max_flush_pkt)) {
+                        aborted = !passPackets(pkt_flush, output_bitrate, br_confidence, pkt_done == pkt_cnt && input_end, aborted);
+                        pkt_flush = 0;
+                    }
+                    continue;
+                }
+                // Otherwise, the first packet is not submitted to the plugin, use the individual packet processing.
+            }
+
+            pkt_done++;
+            pkt_flush++;
+
+            if (buf_pkt->b[0] == 0 || _suspended || (only_labels.any() && !buf_data->hasAnyLabel(only_labels))) {
+                // Dropped packet, suspended plugin or packet without any of the --only-label labels.
+                addNonPluginPackets(1);
+            }
+            else {
+                pkt = *buf_pkt;
+                pkt_data = *buf_data;
+                pkt_data.setFlush(false);
+                pkt_data.setBitrateChanged(false);
+                const ProcessorPlugin::Status status = _processor->processPacket(pkt, pkt_data);
+                addPluginPackets(1);
+
+                switch (status) {
+                    case ProcessorPlugin::TSP_OK:
+                        break;
+                    case ProcessorPlugin::TSP_NULL:
+                    case ProcessorPlugin::TSP_DROP:
+                        // A monitor cannot modify the stream, the packet is passed unmodified.
+                        if (!status_warning) {
+                            warning(u"plugin in a monitor group cannot drop or nullify packets, ignored");
+                            status_warning = true;
+                        }
+                        break;
+                    case ProcessorPlugin::TSP_END:
+                        // Signal end of input to successors and abort to predecessors
+                        debug(u"plugin requests termination");
+                        input_end = aborted = true;
+                        pkt_done--;
+                        pkt_flush--;
+                        pkt_cnt = pkt_done;
+                        break;
+                    default:
+                        // Invalid status, report error and accept packet.
+                        error(u"invalid packet processing status %d", {status});
+                        break;
+                }
+
+                // If the packet processor has signaled a new bitrate, get it.
+                flush = pkt_data.getFlush();
+                if (pkt_data.getBitrateChanged()) {
+                    const BitRate new_bitrate = _processor->getBitrate();
+                    if (new_bitrate != 0) {
+                        bitrate_never_modified = false;
+                        got_new_bitrate = new_bitrate != output_bitrate;
+                        output_bitrate = new_bitrate;
+                        br_confidence = _processor->getBitrateConfidence();
+                    }
+                }
+            }
+
+            // Release the packets to the next processor, same conditions as individual packets.
+            if (flush || got_new_bitrate || pkt_done == pkt_cnt || (_options.max_flush_pkt > 0 && pkt_flush >= _options.max_flush_pkt)) {
+                aborted = !passPackets(pkt_flush, output_bitrate, br_confidence, pkt_done == pkt_cnt && input_end, aborted);
+                pkt_flush = 0;
+            }
+        }
+
+    } while (!input_end && !aborted);
+
+    debug(u"monitor processing thread %s after %'d packets", {input_end ? u"terminated" : u"aborted", pluginPackets()});
+}
+
+
 //----------------------------------------------------------------------------
 // Process packets using packet windows.
 //----------------------------------------------------------------------------
@@ -78,9 +78,10 @@ namespace ts {
             // Inherited from Thread
             virtual void main() override;
 
-            // Process packets one by one or using packet windows.
+            // Process packets one by one (or by contiguous batches), using packet windows, or as a member of a monitor group.
             void processIndividualPackets();
             void processPacketWindows(size_t window_size);
+            void processMonitorPackets();
         };
     }
 }
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tstspStatisticsReporter.h"
+#include "tsGuardCondition.h"
+#include "tsTextFormatter.h"
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::tsp::StatisticsReporter::StatisticsReporter(const TSProcessorArgs& options, Report& log, PluginExecutor* input) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetLowPriority())),
+    _options(options),
+    _log(log),
+    _input(input),
+    _doc(log),
+    _mutex(),
+    _wake_up(),
+    _is_open(false),
+    _terminate(false)
+{
+}
+
+ts::tsp::StatisticsReporter::~StatisticsReporter()
+{
+    close();
+    waitForTermination();
+}
+
+
+//----------------------------------------------------------------------------
+// Start/stop the periodic reports.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::StatisticsReporter::open()
+{
+    if (_options.stats_interval <= 0 || _input == nullptr) {
+        // No statistics report, do nothing.
+        return true;
+    }
+    else if (_is_open) {
+        _log.error(u"statistics report already started");
+        return false;
+    }
+    else if (!_options.stats_file.empty() && !_doc.open(json::ValuePtr(), _options.stats_file, std::cerr)) {
+        return false;
+    }
+    else {
+        _is_open = true;
+        _terminate = false;
+        return start();
+    }
+}
+
+void ts::tsp::StatisticsReporter::close()
+{
+    if (_is_open) {
+        // Notify the thread to terminate and wait for it.
+        {
+            GuardCondition lock(_mutex, _wake_up);
+            _terminate = true;
+            lock.signal();
+        }
+        waitForTermination();
+
+        // Final report, after termination of all plugins.
+        report();
+        if (!_options.stats_file.empty()) {
+            _doc.close();
+        }
+        _is_open = false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Issue one report.
+//----------------------------------------------------------------------------
+
+void ts::tsp::StatisticsReporter::report()
+{
+    json::Object root;
+    PluginExecutor::GetStatistics(root, _input);
+
+    if (!_options.stats_file.empty()) {
+        _doc.add(root);
+    }
+    else {
+        // Without output file, log the JSON text as one single line.
+        TextFormatter text(_log);
+        text.setString();
+        text.setEndOfLineMode(TextFormatter::EndOfLineMode::SPACING);
+        root.print(text);
+        _log.info(text.toString());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Invoked in the context of the report thread.
+//----------------------------------------------------------------------------
+
+void ts::tsp::StatisticsReporter::main()
+{
+    _log.debug(u"statistics report thread started");
+
+    GuardCondition lock(_mutex, _wake_up);
+    while (!_terminate) {
+        // A timeout means that it is time for a new report.
+        if (!lock.waitCondition(_options.stats_interval) && !_terminate) {
+            report();
+        }
+    }
+
+    _log.debug(u"statistics report thread completed");
+}
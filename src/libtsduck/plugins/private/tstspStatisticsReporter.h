@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Transport stream processor: periodic report of plugin statistics.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSProcessorArgs.h"
+#include "tstspPluginExecutor.h"
+#include "tsjsonRunningDocument.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+
+namespace ts {
+    namespace tsp {
+        //!
+        //! Periodic report of the instrumentation counters of all plugins in JSON format.
+        //! This class is internal to the TSDuck library and cannot be called by applications.
+        //! @ingroup plugin
+        //!
+        class StatisticsReporter : private Thread
+        {
+            TS_NOBUILD_NOCOPY(StatisticsReporter);
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] options Command line options for tsp.
+            //! @param [in,out] log Log report.
+            //! @param [in] input Input plugin executor (start of plugin chain).
+            //!
+            StatisticsReporter(const TSProcessorArgs& options, Report& log, PluginExecutor* input);
+
+            //!
+            //! Destructor.
+            //!
+            virtual ~StatisticsReporter() override;
+
+            //!
+            //! Open the output file and start the periodic reports.
+            //! Do nothing if no statistics interval is specified in the options.
+            //! @return True on success, false on error.
+            //!
+            bool open();
+
+            //!
+            //! Issue a final report and stop the periodic reports.
+            //!
+            void close();
+
+        private:
+            const TSProcessorArgs& _options;
+            Report&                _log;
+            PluginExecutor*        _input;
+            json::RunningDocument  _doc;
+            Mutex                  _mutex;
+            Condition              _wake_up;
+            bool                   _is_open;
+            bool                   _terminate;
+
+            // Issue one report.
+            void report();
+
+            // Implementation of Thread.
+            virtual void main() override;
+        };
+    }
+}
@@ -49,6 +49,8 @@ ts::tsswitch::Core::Core(const InputSwitcherArgs& opt, const PluginEventHandlerR
     _gotInput(),
     _curPlugin(_opt.firstInput),
     _curCycle(0),
+    _switchPending(false),
+    _switchTime(),
     _terminate(false),
     _actions(),
     _events()
@@ -411,6 +413,8 @@ void ts::tsswitch::Core::execute(const Action& event)
             case SET_CURRENT: {
                 _eventDispatcher.signalNewInput(_curPlugin, action.index);
                 _curPlugin = action.index;
+                _switchTime.getSystemTime();
+                _switchPending = true;
                 break;
             }
             case WAIT_STARTED:
@@ -462,6 +466,11 @@ bool ts::tsswitch::Core::getOutputArea(size_t& pluginIndex, TSPacket*& first, TS
         if (count > 0 || _terminate) {
             // Tell the output plugin which input plugin is used.
             pluginIndex = _curPlugin;
+            // Report the switch latency on the first output from the new input plugin.
+            if (_switchPending && count > 0) {
+                _switchPending = false;
+                _log.verbose(u"switched to input %d, latency: %'d microseconds", {_curPlugin, (Monotonic(true) - _switchTime) / NanoSecPerMicroSec});
+            }
             // Return false when the application terminates.
             return !_terminate;
         }
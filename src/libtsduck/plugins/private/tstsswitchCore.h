@@ -40,6 +40,7 @@
 #include "tsMutex.h"
 #include "tsCondition.h"
 #include "tsWatchDog.h"
+#include "tsMonotonic.h"
 
 namespace ts {
     //!
@@ -201,6 +202,8 @@ namespace ts {
             Condition       _gotInput;         // Signaled each time an input plugin reports new packets.
             size_t          _curPlugin;        // Index of current input plugin.
             size_t          _curCycle;         // Current input cycle number.
+            bool            _switchPending;    // A switch occurred, no packet output yet from the new input.
+            Monotonic       _switchTime;       // Time of last switch.
             volatile bool   _terminate;        // Terminate complete processing.
             ActionQueue     _actions;          // Sequential queue list of actions to execute.
             ActionSet       _events;           // Pending events, waiting to be cleared.
@@ -31,6 +31,7 @@
 #include "tstsswitchCore.h"
 #include "tsGuardMutex.h"
 #include "tsGuardCondition.h"
+#include "tsSysUtils.h"
 
 
 //----------------------------------------------------------------------------
@@ -58,7 +59,14 @@ ts::tsswitch::InputExecutor::InputExecutor(const InputSwitcherArgs& opt,
     _terminated(false),
     _outFirst(0),
     _outCount(0),
-    _start_time(true) // initialized with current system time
+    _received(0),
+    _cleanBoundary(INVALID_PACKET_COUNTER),
+    _ccErrors(0),
+    _gotPCR(false),
+    _lastPCR(),
+    _start_time(true), // initialized with current system time
+    _ccReset(false),
+    _ccState(opt.cleanSwitch ? PID_MAX : 0, 0xFF)
 {
     // Make sure that the input plugins display their index.
     setLogName(UString::Format(u"%s[%d]", {pluginName(), _pluginIndex}));
@@ -128,10 +136,87 @@ bool ts::tsswitch::InputExecutor::abortInput()
 void ts::tsswitch::InputExecutor::setCurrent(bool isCurrent)
 {
     GuardMutex lock(_mutex);
+    if (isCurrent && !_isCurrent && _opt.cleanSwitch) {
+        skipToCleanBoundary();
+    }
+    else if (!isCurrent && _isCurrent && _opt.cleanSwitch) {
+        // Back to standby: restart the health check from scratch, the previous
+        // continuity state is obsolete. The input thread resets its own _ccState.
+        _cleanBoundary = INVALID_PACKET_COUNTER;
+        _ccErrors = 0;
+        _gotPCR = false;
+        _ccReset = true;
+    }
     _isCurrent = isCurrent;
 }
 
 
+//----------------------------------------------------------------------------
+// Move the start of the output area to the latest clean switch boundary.
+// Must be called with the mutex held.
+//----------------------------------------------------------------------------
+
+void ts::tsswitch::InputExecutor::skipToCleanBoundary()
+{
+    // Index in session of the first buffered packet.
+    const PacketCounter bufferStart = _received - _outCount;
+
+    if (_outputInUse) {
+        // Should not happen since the output plugin only uses the current input.
+        debug(u"output buffer in use, cannot skip to clean switch boundary");
+    }
+    else if (_cleanBoundary == INVALID_PACKET_COUNTER || _cleanBoundary < bufferStart) {
+        warning(u"no clean switch boundary in buffer, %'d continuity errors, switching on next packet", {_ccErrors});
+    }
+    else {
+        const size_t skip = size_t(_cleanBoundary - bufferStart);
+        assert(skip < _outCount);
+        _outFirst = (_outFirst + skip) % _buffer.size();
+        _outCount -= skip;
+        verbose(u"clean switch: skipped %'d packets, %'d continuity errors, last PCR %'d ms ago",
+                {skip, _ccErrors, _gotPCR ? (Monotonic(true) - _lastPCR) / NanoSecPerMilliSec : -1});
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check the health of received packets of a standby input plugin.
+// Executed in the input thread, without mutex.
+//----------------------------------------------------------------------------
+
+size_t ts::tsswitch::InputExecutor::checkStandbyPackets(size_t first, size_t count, size_t& ccErrors, size_t& pcrCount)
+{
+    size_t boundary = NPOS;
+    ccErrors = pcrCount = 0;
+
+    for (size_t n = first; n < first + count; ++n) {
+        const TSPacket& pkt(_buffer[n]);
+        const PID pid = pkt.getPID();
+        if (pid == PID_NULL) {
+            continue;
+        }
+
+        // Check continuity. Duplicate packets are allowed. A discontinuity indicator resets the state.
+        const uint8_t cc = pkt.getCC();
+        const uint8_t last = _ccState[pid];
+        _ccState[pid] = cc;
+        if (last != 0xFF && !pkt.getDiscontinuityIndicator() && cc != last && (!pkt.hasPayload() || cc != ((last + 1) & CC_MASK))) {
+            ccErrors++;
+            boundary = NPOS;
+        }
+
+        // A clean switch boundary carries a PCR and starts a random access point or a payload unit.
+        if (pkt.hasPCR()) {
+            pcrCount++;
+            if (pkt.getRandomAccessIndicator() || pkt.getPUSI()) {
+                boundary = n - first;
+            }
+        }
+    }
+    return boundary;
+}
+
+
 //----------------------------------------------------------------------------
 // Terminate input.
 //----------------------------------------------------------------------------
@@ -207,8 +292,17 @@ void ts::tsswitch::InputExecutor::main()
             _stopRequest = false;
             // Inform the TSP layer to reset plugin session accounting.
             restartPluginSession();
+            // Reset standby health check.
+            _received = 0;
+            _cleanBoundary = INVALID_PACKET_COUNTER;
+            _ccErrors = 0;
+            _gotPCR = false;
+            _ccReset = true;
         }
 
+        // CPU time of the input thread at start of session.
+        const NanoSecond startCPU = GetThreadCPUTime();
+
         // Here, we need to start an input session.
         debug(u"starting input plugin");
         const bool started = _input->start();
@@ -228,6 +322,8 @@ void ts::tsswitch::InputExecutor::main()
             // Input area (first packet index and packet count).
             size_t inFirst = 0;
             size_t inCount = 0;
+            bool checkStandby = false;
+            bool resetCC = false;
 
             // Initial sequence under mutex protection.
             {
@@ -258,6 +354,15 @@ void ts::tsswitch::InputExecutor::main()
                 // The receive area is limited by end of buffer and max input size.
                 inFirst = (_outFirst + _outCount) % _buffer.size();
                 inCount = std::min(_opt.maxInputPackets, std::min(_buffer.size() - _outCount, _buffer.size() - inFirst));
+                // With --clean-switch, check the health of packets while not current.
+                checkStandby = _opt.cleanSwitch && !_isCurrent;
+                resetCC = _ccReset;
+                _ccReset = false;
+            }
+
+            // Forget the continuity counters of a previous session or of a previous standby period.
+            if (resetCC) {
+                std::fill(_ccState.begin(), _ccState.end(), 0xFF);
             }
 
             assert(inFirst < _buffer.size());
@@ -285,9 +390,29 @@ void ts::tsswitch::InputExecutor::main()
                 }
             }
 
+            // Check the health of the standby input plugin.
+            size_t boundary = NPOS;
+            size_t ccErrors = 0;
+            size_t pcrCount = 0;
+            if (checkStandby) {
+                boundary = checkStandbyPackets(inFirst, inCount, ccErrors, pcrCount);
+            }
+
             // Signal the presence of received packets.
             {
                 GuardMutex lock(_mutex);
+                if (boundary != NPOS) {
+                    _cleanBoundary = _received + boundary;
+                }
+                else if (ccErrors > 0) {
+                    _cleanBoundary = INVALID_PACKET_COUNTER;
+                }
+                if (pcrCount > 0) {
+                    _gotPCR = true;
+                    _lastPCR.getSystemTime();
+                }
+                _ccErrors += ccErrors;
+                _received += inCount;
                 _outCount += inCount;
             }
             _core.inputReceived(_pluginIndex);
@@ -307,6 +432,12 @@ void ts::tsswitch::InputExecutor::main()
             _outCount = 0;
         }
 
+        // Report the CPU load of the input session.
+        if (startCPU >= 0) {
+            const NanoSecond cpu = GetThreadCPUTime() - startCPU;
+            verbose(u"input session terminated, %'d packets, CPU time: %'d ms", {pluginPackets(), cpu / NanoSecPerMilliSec});
+        }
+
         // End of input session.
         debug(u"stopping input plugin");
         _core.inputStopped(_pluginIndex, _input->stop());
@@ -39,6 +39,7 @@
 #include "tsMutex.h"
 #include "tsCondition.h"
 #include "tsMonotonic.h"
+#include "tsByteBlock.h"
 
 namespace ts {
     namespace tsswitch {
@@ -137,10 +138,27 @@ namespace ts {
             bool                     _terminated;    // Terminate thread.
             size_t                   _outFirst;      // Index of first packet to output in _buffer.
             size_t                   _outCount;      // Number of packets to output, not always contiguous, may wrap up.
+            PacketCounter            _received;      // Number of received packets in the session, including dropped ones.
+            PacketCounter            _cleanBoundary; // Index in session of latest clean switch boundary, INVALID_PACKET_COUNTER if none.
+            PacketCounter            _ccErrors;      // Number of continuity errors while not current (--clean-switch).
+            bool                     _gotPCR;        // At least one PCR was received while not current (--clean-switch).
+            Monotonic                _lastPCR;       // Time of last PCR reception while not current (--clean-switch).
             Monotonic                _start_time;    // Creation time in a monotonic clock.
+            bool                     _ccReset;       // The input thread must reset _ccState (--clean-switch).
+            ByteBlock                _ccState;       // Last continuity counter per PID, 0xFF if unknown, used in input thread only (--clean-switch).
 
             // Implementation of Thread.
             virtual void main() override;
+
+            // Check the health of received packets of a standby input plugin (--clean-switch).
+            // Executed in the input thread, without mutex. Return the index in the area of the last
+            // clean switch boundary after the last continuity error, or NPOS if there is none.
+            // Also return the number of continuity errors and PCR's in the area.
+            size_t checkStandbyPackets(size_t first, size_t count, size_t& ccErrors, size_t& pcrCount);
+
+            // Move the start of the output area to the latest clean switch boundary (--clean-switch).
+            // Must be called with the mutex held.
+            void skipToCleanBoundary();
         };
 
         //!
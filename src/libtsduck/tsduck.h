@@ -332,6 +332,8 @@
 #include "tshlsMediaSegment.h"
 #include "tshlsOutputPlugin.h"
 #include "tshlsPlayList.h"
+#include "tshlsSegmentPrefetcher.h"
+#include "tshlsSegmentStore.h"
 #include "tshlsTagAttributes.h"
 #include "tsHTTPInputPlugin.h"
 #include "tsHybridInformationDescriptor.h"
@@ -386,6 +388,8 @@
 #include "tsLIT.h"
 #include "tsLNB.h"
 #include "tsLocalTimeOffsetDescriptor.h"
+#include "tsLockFreeMessagePriorityQueue.h"
+#include "tsLockFreeMessageQueue.h"
 #include "tsLogicalChannelNumbers.h"
 #include "tsLogoTransmissionDescriptor.h"
 #include "tsMACAddress.h"
@@ -394,6 +398,7 @@
 #include "tsMemory.h"
 #include "tsMemoryInputPlugin.h"
 #include "tsMemoryOutputPlugin.h"
+#include "tsMemoryPool.h"
 #include "tsMessageDescriptor.h"
 #include "tsMessagePriorityQueue.h"
 #include "tsMessageQueue.h"
@@ -493,6 +498,7 @@
 #include "tsPolledFile.h"
 #include "tsPollFiles.h"
 #include "tsPollFilesListener.h"
+#include "tsPoolAllocated.h"
 #include "tsPrefetchDescriptor.h"
 #include "tsPrivateDataIndicatorDescriptor.h"
 #include "tsPrivateDataSpecifierDescriptor.h"
@@ -692,6 +698,7 @@
 #include "tsTSAnalyzerReport.h"
 #include "tsTSDT.h"
 #include "tsTSFile.h"
+#include "tsTSFileIndex.h"
 #include "tsTSFileInputBuffered.h"
 #include "tsTSFileOutputResync.h"
 #include "tsTSForkPipe.h"
@@ -709,6 +716,7 @@
 #include "tsTSScanner.h"
 #include "tsTSScrambling.h"
 #include "tsTSSpeedMetrics.h"
+#include "tsTSSyncScanner.h"
 #include "tsTuner.h"
 #include "tsTunerArgs.h"
 #include "tsTunerBase.h"
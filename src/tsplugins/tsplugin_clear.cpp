@@ -55,6 +55,8 @@ namespace ts {
         ClearPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool usePacketBatches() override;
+        virtual size_t processPackets(TSPacket*, TSPacketMetadata*, size_t) override;
 
     private:
         bool          _abort;           // Error (service not found, etc)
@@ -369,3 +371,22 @@ ts::ProcessorPlugin::Status ts::ClearPlugin::processPacket(TSPacket& pkt, TSPack
 
     return _pass_packets ? TSP_OK : _drop_status;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::ClearPlugin::usePacketBatches()
+{
+    return true;
+}
+
+size_t ts::ClearPlugin::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    size_t i = 0;
+    while (i < count && SetPacketStatus(pkt_data[i], ClearPlugin::processPacket(pkt[i], pkt_data[i]))) {
+        i++;
+    }
+    return i;
+}
@@ -50,6 +50,8 @@ namespace ts {
         virtual bool getOptions() override;
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool usePacketBatches() override;
+        virtual size_t processPackets(TSPacket*, TSPacketMetadata*, size_t) override;
 
     private:
         UString            _tag;          // Message tag
@@ -155,3 +157,21 @@ ts::ProcessorPlugin::Status ts::ContinuityPlugin::processPacket(TSPacket& pkt, T
     _cc_analyzer.feedPacket(pkt);
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::ContinuityPlugin::usePacketBatches()
+{
+    return true;
+}
+
+size_t ts::ContinuityPlugin::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        _cc_analyzer.feedPacket(pkt[i]);
+    }
+    return count;
+}
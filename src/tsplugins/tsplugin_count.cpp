@@ -52,6 +52,8 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool usePacketBatches() override;
+        virtual size_t processPackets(TSPacket*, TSPacketMetadata*, size_t) override;
 
     private:
         // This structure is used at each --interval.
@@ -82,6 +84,9 @@ namespace ts {
 
         // Report a line
         void report(const UChar* fmt, const std::initializer_list<ArgMixIn> args);
+
+        // Process one packet, index is the packet index in the plugin.
+        Status countPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index);
     };
 }
 
@@ -263,6 +268,11 @@ void ts::CountPlugin::report(const UChar* fmt, const std::initializer_list<ArgMi
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    return countPacket(pkt, pkt_data, tsp->pluginPackets());
+}
+
+ts::ProcessorPlugin::Status ts::CountPlugin::countPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index)
 {
     // Check if the packet must be counted
     const PID pid = pkt.getPID();
@@ -273,18 +283,18 @@ ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, TSPack
 
     // Process reporting intervals.
     if (_report_interval > 0) {
-        if (tsp->pluginPackets() == 0) {
+        if (index == 0) {
             // Set initial interval
             _last_report.start = Time::CurrentUTC();
             _last_report.counted_packets = 0;
             _last_report.total_packets = 0;
         }
-        else if (tsp->pluginPackets() % _report_interval == 0) {
+        else if (index % _report_interval == 0) {
             // It is time to produce a report.
             // Get current state.
             IntervalReport now;
             now.start = Time::CurrentUTC();
-            now.total_packets = tsp->pluginPackets();
+            now.total_packets = index;
             now.counted_packets = 0;
             for (size_t p = 0; p < PID_MAX; p++) {
                 now.counted_packets += _counters[p];
@@ -310,10 +320,10 @@ ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, TSPack
     if (ok) {
         if (_report_all) {
             if (_brief_report) {
-                report(u"%d %d", {tsp->pluginPackets(), pid});
+                report(u"%d %d", {index, pid});
             }
             else {
-                report(u"%spacket: %10'd, PID: %4d (0x%04X)", {_tag, tsp->pluginPackets(), pid, pid});
+                report(u"%spacket: %10'd, PID: %4d (0x%04X)", {_tag, index, pid, pid});
             }
         }
         _counters[pid]++;
@@ -321,3 +331,23 @@ ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, TSPack
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::CountPlugin::usePacketBatches()
+{
+    return true;
+}
+
+size_t ts::CountPlugin::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    const PacketCounter first_index = tsp->pluginPackets();
+    size_t i = 0;
+    while (i < count && SetPacketStatus(pkt_data[i], countPacket(pkt[i], pkt_data[i], first_index + i))) {
+        i++;
+    }
+    return i;
+}
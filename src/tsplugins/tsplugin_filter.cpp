@@ -54,6 +54,8 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool usePacketBatches() override;
+        virtual size_t processPackets(TSPacket*, TSPacketMetadata*, size_t) override;
 
     private:
         // Packet intervals and list of them.
@@ -114,6 +116,9 @@ namespace ts {
 
         // Implementation of SignalizationHandlerInterface
         virtual void handleService(uint16_t ts_id, const Service& service, const PMT& pmt, bool removed) override;
+
+        // Process one packet, index is the packet index in the plugin.
+        Status filterPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index);
     };
 }
 
@@ -530,6 +535,11 @@ bool ts::FilterPlugin::stop()
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    return filterPacket(pkt, pkt_data, tsp->pluginPackets());
+}
+
+ts::ProcessorPlugin::Status ts::FilterPlugin::filterPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index)
 {
     const PID pid = pkt.getPID();
 
@@ -539,8 +549,7 @@ ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPac
     }
 
     // Pass initial packets without filtering.
-    const PacketCounter packetIndex = tsp->pluginPackets();
-    if (packetIndex < _after_packets) {
+    if (index < _after_packets) {
         return TSP_OK;
     }
 
@@ -582,7 +591,7 @@ ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPac
         (int(pkt.getPayloadSize()) <= _max_payload) ||
         (_min_af >= 0 && int(pkt.getAFSize()) >= _min_af) ||
         (int(pkt.getAFSize()) <= _max_af) ||
-        (_every_packets > 0 && (tsp->pluginPackets() - _after_packets) % _every_packets == 0) ||
+        (_every_packets > 0 && (index - _after_packets) % _every_packets == 0) ||
         (_with_pes && pkt.startPES());
 
     // Search binary patterns in packets.
@@ -600,7 +609,7 @@ ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPac
 
     // Search if packet is in one selected range.
     for (auto it = _ranges.begin(); !ok && it != _ranges.end(); ++it) {
-        ok = packetIndex >= it->first && packetIndex <= it->second;
+        ok = index >= it->first && index <= it->second;
     }
 
     // Reverse selection criteria with --negate.
@@ -642,3 +651,23 @@ void ts::FilterPlugin::handleService(uint16_t ts_id, const Service& service, con
         }
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::FilterPlugin::usePacketBatches()
+{
+    return true;
+}
+
+size_t ts::FilterPlugin::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    const PacketCounter first_index = tsp->pluginPackets();
+    size_t i = 0;
+    while (i < count && SetPacketStatus(pkt_data[i], filterPacket(pkt[i], pkt_data[i], first_index + i))) {
+        i++;
+    }
+    return i;
+}
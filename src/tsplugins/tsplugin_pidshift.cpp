@@ -54,6 +54,8 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool usePacketBatches() override;
+        virtual size_t processPackets(TSPacket*, TSPacketMetadata*, size_t) override;
 
     private:
         // Command line options:
@@ -67,6 +69,9 @@ namespace ts {
         bool            _pass_all;       // Pass all packets after an error.
         PacketCounter   _init_packets;   // Count packets in PID's to shift during initial evaluation phase.
         TimeShiftBuffer _buffer;         // The timeshift buffer logic.
+
+        // Process one packet, index is the packet index in the plugin.
+        Status shiftPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index);
     };
 }
 
@@ -205,6 +210,11 @@ bool ts::PIDShiftPlugin::stop()
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::PIDShiftPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    return shiftPacket(pkt, pkt_data, tsp->pluginPackets());
+}
+
+ts::ProcessorPlugin::Status ts::PIDShiftPlugin::shiftPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index)
 {
     const PID pid = pkt.getPID();
 
@@ -223,7 +233,7 @@ ts::ProcessorPlugin::Status ts::PIDShiftPlugin::processPacket(TSPacket& pkt, TSP
 
         // Evaluate the duration from the beginning of the TS (zero if bitrate is unknown).
         const BitRate ts_bitrate = tsp->bitrate();
-        const PacketCounter ts_packets = tsp->pluginPackets() + 1;
+        const PacketCounter ts_packets = index + 1;
         const MilliSecond ms = PacketInterval(ts_bitrate, ts_packets);
 
         if (ms >= _eval_ms) {
@@ -268,3 +278,23 @@ ts::ProcessorPlugin::Status ts::PIDShiftPlugin::processPacket(TSPacket& pkt, TSP
     }
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::PIDShiftPlugin::usePacketBatches()
+{
+    return true;
+}
+
+size_t ts::PIDShiftPlugin::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    const PacketCounter first_index = tsp->pluginPackets();
+    size_t i = 0;
+    while (i < count && SetPacketStatus(pkt_data[i], shiftPacket(pkt[i], pkt_data[i], first_index + i))) {
+        i++;
+    }
+    return i;
+}
@@ -103,6 +103,8 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool usePacketBatches() override;
+        virtual size_t processPackets(TSPacket*, TSPacketMetadata*, size_t) override;
 
     private:
         // Description of a crypto-period.
@@ -426,6 +428,8 @@ bool ts::ScramblerPlugin::start()
     _current_ecm = 0;
 
     // Initialize the scrambling engine.
+    // DVB-CSA2 payloads are scrambled in one pass at the end of each batch of packets.
+    _scrambling.setBatchMode(true);
     if (!_scrambling.start()) {
         return false;
     }
@@ -852,6 +856,27 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
 }
 
 
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::ScramblerPlugin::usePacketBatches()
+{
+    return true;
+}
+
+size_t ts::ScramblerPlugin::processPackets(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count)
+{
+    size_t i = 0;
+    while (i < count && SetPacketStatus(pkt_data[i], ScramblerPlugin::processPacket(pkt[i], pkt_data[i]))) {
+        i++;
+    }
+
+    // Scramble the payloads of all packets in the batch.
+    return _scrambling.flushBatch() ? i : 0;
+}
+
+
 //----------------------------------------------------------------------------
 // CryptoPeriod default constructor.
 //----------------------------------------------------------------------------
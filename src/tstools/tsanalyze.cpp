@@ -37,6 +37,9 @@
 #include "tsTSFile.h"
 #include "tsPagerArgs.h"
 #include "tsDuckContext.h"
+#include "tsFileUtils.h"
+#include "tsThread.h"
+#include "tsGuardMutex.h"
 TS_MAIN(MainCode);
 
 
@@ -55,6 +58,8 @@ namespace {
         ts::BitRate           bitrate;   // Expected bitrate (188-byte packets)
         ts::UString           infile;    // Input file name
         ts::TSPacketFormat    format;    // Input file format.
+        bool                  mmap;      // Use memory-mapped input.
+        size_t                threads;   // Number of threads for parallel analysis.
         ts::TSAnalyzerOptions analysis;  // Analysis options.
         ts::PagerArgs         pager;     // Output paging options.
     };
@@ -66,6 +71,8 @@ Options::Options(int argc, char *argv[]) :
     bitrate(0),
     infile(),
     format(ts::TSPacketFormat::AUTODETECT),
+    mmap(false),
+    threads(1),
     analysis(),
     pager(true, true)
 {
@@ -87,6 +94,23 @@ Options::Options(int argc, char *argv[]) :
          u"(based on 188-byte packets). By default, the bitrate is "
          u"evaluated using the PCR in the transport stream.");
 
+    option(u"memory-map");
+    help(u"memory-map",
+         u"Read the input file using memory mapping instead of read operations. "
+         u"This is usually faster on large capture files. Ignored when the input "
+         u"is not a regular file. Do not use this option on files which may be "
+         u"truncated while being analyzed.");
+
+    option(u"threads", 0, POSITIVE);
+    help(u"threads",
+         u"Analyze the input file in parallel using the specified number of threads. "
+         u"The file is split in contiguous chunks which are analyzed independently and "
+         u"the results are merged into one single report. Each chunk is preceded by a "
+         u"short warm-up area to resynchronize the analysis of tables and continuity counters. "
+         u"The results are identical to a sequential analysis, except the crypto-periods which "
+         u"are approximated. Ignored when the input is not a regular file. "
+         u"By default, the analysis is sequential.");
+
     analyze(argc, argv);
 
     // Define all standard analysis options.
@@ -96,12 +120,224 @@ Options::Options(int argc, char *argv[]) :
 
     getValue(infile, u"");
     getValue(bitrate, u"bitrate");
+    mmap = present(u"memory-map");
+    getIntValue(threads, u"threads", 1);
     format = ts::LoadTSPacketFormatInputOption(*this);
 
     exitOnError();
 }
 
 
+//----------------------------------------------------------------------------
+//  Feed an analyzer with packets from a file.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Number of TS packets per read operation.
+    constexpr size_t READ_PACKETS = 1024;
+
+    // Size in TS packets of the warm-up area before each chunk in a parallel analysis.
+    // It must be large enough to contain the PSI/SI and the packets of all PID's.
+    constexpr ts::PacketCounter WARMUP_PACKETS = 50000;
+
+    // Minimum size in TS packets of a chunk in a parallel analysis.
+    constexpr ts::PacketCounter MIN_CHUNK_PACKETS = 2 * WARMUP_PACKETS;
+
+    // Analyze up to max_packets packets. Return the number of analyzed packets.
+    ts::PacketCounter AnalyzePackets(ts::TSFile& file, ts::TSAnalyzer& analyzer, ts::PacketCounter max_packets, ts::Report& report)
+    {
+        ts::TSPacketVector buffer(READ_PACKETS);
+        ts::PacketCounter total = 0;
+        size_t count = 0;
+        while (total < max_packets && (count = file.readPackets(buffer.data(), nullptr, size_t(std::min<ts::PacketCounter>(buffer.size(), max_packets - total)), report)) > 0) {
+            for (size_t i = 0; i < count; ++i) {
+                analyzer.feedPacket(buffer[i]);
+            }
+            total += count;
+        }
+        return total;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//  The report of an analysis thread. The options are not thread-safe,
+//  the messages are forwarded to the options one thread at a time.
+//----------------------------------------------------------------------------
+
+namespace {
+    class ChunkReport: public ts::Report
+    {
+        TS_NOBUILD_NOCOPY(ChunkReport);
+    public:
+        ChunkReport(ts::Report& report, ts::Mutex& mutex) : ts::Report(report.maxSeverity()), _report(report), _mutex(mutex) {}
+
+    protected:
+        virtual void writeLog(int severity, const ts::UString& msg) override
+        {
+            ts::GuardMutex lock(_mutex);
+            _report.log(severity, msg);
+        }
+
+    private:
+        ts::Report& _report;
+        ts::Mutex&  _mutex;
+    };
+}
+
+
+//----------------------------------------------------------------------------
+//  A thread which analyzes one chunk of the input file.
+//----------------------------------------------------------------------------
+
+namespace {
+    class ChunkAnalyzer: public ts::Thread
+    {
+        TS_NOBUILD_NOCOPY(ChunkAnalyzer);
+    public:
+        // Constructor. Packets are counted from the beginning of the file.
+        // The analysis starts at warmup, the statistics start at start and stop at end.
+        // The thread uses a private TSDuck context, restored from duck_args, and
+        // reports its messages to the options, serialized with log_mutex.
+        ChunkAnalyzer(Options& opt, ts::Mutex& log_mutex, const ts::DuckContext::SavedArgs& duck_args, ts::TSPacketFormat format,
+                      size_t packet_size, ts::PacketCounter warmup, ts::PacketCounter start, ts::PacketCounter end);
+
+        // Destructor.
+        virtual ~ChunkAnalyzer() override;
+
+        // Get the results of the analysis.
+        bool success() const { return _success; }
+        ts::TSAnalyzerReport& analyzer() { return _analyzer; }
+        ts::DuckContext& duck() { return _duck; }
+
+    private:
+        const Options&       _opt;
+        ChunkReport          _report;
+        ts::DuckContext      _duck;
+        ts::TSAnalyzerReport _analyzer;
+        ts::TSPacketFormat   _format;
+        size_t               _packet_size;
+        ts::PacketCounter    _warmup;
+        ts::PacketCounter    _start;
+        ts::PacketCounter    _end;
+        bool                 _success;
+
+        // Main code of the thread.
+        virtual void main() override;
+    };
+}
+
+ChunkAnalyzer::ChunkAnalyzer(Options& opt, ts::Mutex& log_mutex, const ts::DuckContext::SavedArgs& duck_args, ts::TSPacketFormat format,
+                             size_t packet_size, ts::PacketCounter warmup, ts::PacketCounter start, ts::PacketCounter end) :
+    ts::Thread(),
+    _opt(opt),
+    _report(opt, log_mutex),
+    _duck(&_report),
+    _analyzer(_duck, opt.bitrate, ts::BitRateConfidence::OVERRIDE),
+    _format(format),
+    _packet_size(packet_size),
+    _warmup(warmup),
+    _start(start),
+    _end(end),
+    _success(false)
+{
+    _duck.restoreArgs(duck_args);
+    _analyzer.setAnalysisOptions(opt.analysis);
+}
+
+ChunkAnalyzer::~ChunkAnalyzer()
+{
+    waitForTermination();
+}
+
+void ChunkAnalyzer::main()
+{
+    ts::TSFile file;
+    file.setMemoryMapped(_opt.mmap);
+    if (file.openRead(_opt.infile, 1, _warmup * _packet_size, _report, _format)) {
+        // Analyze the warm-up area to learn the stream structure, then forget its statistics.
+        _analyzer.setPacketIndex(_warmup);
+        if (_start > _warmup) {
+            AnalyzePackets(file, _analyzer, _start - _warmup, _report);
+            _analyzer.resetStatistics();
+        }
+        AnalyzePackets(file, _analyzer, _end - _start, _report);
+        _success = file.close(_report);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//  Analyze the input file in parallel. Return false if not possible.
+//----------------------------------------------------------------------------
+
+namespace {
+    bool ParallelAnalysis(Options& opt)
+    {
+        // Parallel analysis needs random access in a regular file.
+        if (opt.threads < 2 || opt.infile.empty() || opt.infile == u"-" || !ts::FileExists(opt.infile) || ts::IsDirectory(opt.infile)) {
+            return false;
+        }
+
+        // Read the first packet to get the actual packet format and size.
+        ts::TSFile file;
+        ts::TSPacket pkt;
+        if (!file.openRead(opt.infile, 1, 0, opt, opt.format) || file.readPackets(&pkt, nullptr, 1, opt) == 0) {
+            return false;
+        }
+        const ts::TSPacketFormat format = file.packetFormat();
+        const size_t packet_size = file.packetHeaderSize() + ts::PKT_SIZE + file.packetTrailerSize();
+        file.close(opt);
+
+        // Compute the number of chunks, none of them shall be too small.
+        const ts::PacketCounter total = ts::PacketCounter(std::max<int64_t>(0, ts::GetFileSize(opt.infile))) / packet_size;
+        const size_t chunks = size_t(std::min<ts::PacketCounter>(opt.threads, total / MIN_CHUNK_PACKETS));
+        if (chunks < 2) {
+            return false;
+        }
+        opt.verbose(u"analyzing %'d packets in %d chunks", {total, chunks});
+
+        // Each thread uses a private copy of the TSDuck context, the options are not used while the threads run.
+        ts::DuckContext::SavedArgs duck_args;
+        opt.duck.saveArgs(duck_args);
+        ts::Mutex log_mutex;
+
+        // Start one thread per chunk. The last chunk extends to the end of file, in case the file grows.
+        std::vector<ts::SafePtr<ChunkAnalyzer>> threads(chunks);
+        for (size_t i = 0; i < chunks; ++i) {
+            const ts::PacketCounter start = (total * i) / chunks;
+            const ts::PacketCounter end = i + 1 < chunks ? (total * (i + 1)) / chunks : std::numeric_limits<ts::PacketCounter>::max();
+            const ts::PacketCounter warmup = i == 0 ? 0 : std::max((total * (i - 1)) / chunks, start - std::min(start, WARMUP_PACKETS));
+            threads[i] = new ChunkAnalyzer(opt, log_mutex, duck_args, format, packet_size, warmup, start, end);
+        }
+        for (const auto& th : threads) {
+            th->start();
+        }
+
+        // Wait for all threads and merge the results into the first one.
+        bool success = true;
+        for (size_t i = 0; i < chunks; ++i) {
+            threads[i]->waitForTermination();
+            success = success && threads[i]->success();
+            if (i > 0) {
+                threads[0]->analyzer().merge(threads[i]->analyzer());
+            }
+            opt.duck.addStandards(threads[i]->duck().standards());
+        }
+        threads[0]->duck().addStandards(opt.duck.standards());
+
+        // Display analysis results.
+        if (success) {
+            threads[0]->analyzer().report(opt.pager.output(opt), opt.analysis, opt);
+        }
+        else {
+            opt.error(u"parallel analysis of %s failed", {opt.infile});
+        }
+        return true;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -111,21 +347,24 @@ int MainCode(int argc, char *argv[])
     // Decode command line options.
     Options opt(argc, argv);
 
+    // Try a parallel analysis first, when requested.
+    if (ParallelAnalysis(opt)) {
+        return opt.valid() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     // Configure the TS analyzer.
     ts::TSAnalyzerReport analyzer(opt.duck, opt.bitrate, ts::BitRateConfidence::OVERRIDE);
     analyzer.setAnalysisOptions(opt.analysis);
 
     // Open the TS file.
     ts::TSFile file;
+    file.setMemoryMapped(opt.mmap);
     if (!file.openRead(opt.infile, 1, 0, opt, opt.format)) {
         return EXIT_FAILURE;
     }
 
     // Analyze all packets in the file.
-    ts::TSPacket pkt;
-    while (file.readPackets(&pkt, nullptr, 1, opt) > 0) {
-        analyzer.feedPacket(pkt);
-    }
+    AnalyzePackets(file, analyzer, std::numeric_limits<ts::PacketCounter>::max(), opt);
     file.close(opt);
 
     // Display analysis results.
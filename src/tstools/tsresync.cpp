@@ -37,6 +37,7 @@
 #include "tsByteBlock.h"
 #include "tsFatal.h"
 #include "tsTS.h"
+#include "tsTSSyncScanner.h"
 TS_MAIN(MainCode);
 
 #define MIN_SYNC_SIZE       (1024)              // 1 kB
@@ -158,12 +159,11 @@ public:
         _in_header_size = 0;
     }
 
-    // Look for MPEG packets in a buffer, according to an assumed packet size.
-    // If the complete buffer matches the packet size, set input and output packet
-    // sizes and return true. Return false otherwise.
-    bool checkSync(const uint8_t* buf, size_t buf_size, size_t pkt_size, size_t header_size);
+    // Set the input packet size, as found by the synchronization scanner.
+    // Also set the output packet size, depending on the options.
+    void setPacketSize(size_t pkt_size, size_t header_size);
 
-    // Get packet sizes, as determined by checkSync(). Size is zero if no valid packet size found.
+    // Get packet sizes, as determined by setPacketSize(). Size is zero if no valid packet size found.
     size_t inputPacketSize() const {return _in_pkt_size;}
     size_t inputHeaderSize() const {return _in_header_size;}
     size_t outputPacketSize() const {return _out_pkt_size;}
@@ -251,28 +251,16 @@ bool Resynchronizer::writePacket(const uint8_t* input_packet)
 
 
 //----------------------------------------------------------------------------
-//  Look for MPEG packets in a buffer, according to an assumed packet size.
+//  Set the input and output packet sizes.
 //----------------------------------------------------------------------------
 
-bool Resynchronizer::checkSync(const uint8_t* buf, size_t buf_size, size_t pkt_size, size_t header_size)
+void Resynchronizer::setPacketSize(size_t pkt_size, size_t header_size)
 {
     assert(pkt_size >= header_size + ts::PKT_SIZE);
-    const uint8_t* end = buf + buf_size - pkt_size + 1;
-
-    // Check if the buffer contains packets with the appropriate size
-    while (buf < end) {
-        if (buf[header_size] != ts::SYNC_BYTE) {
-            return false; // not found
-        }
-        buf += pkt_size;
-    }
-
-    // Packets found all along the buffer
     _in_pkt_size = pkt_size;
     _in_header_size = header_size;
     _out_pkt_size = _keep_packet_size ? pkt_size : ts::PKT_SIZE;
     _out_header_size = _keep_packet_size ? header_size : 0;
-    return true;
 }
 
 
@@ -287,6 +275,12 @@ int MainCode(int argc, char *argv[])
     ts::OutputRedirector output(opt.outfile, opt);
     Resynchronizer resync(opt.keep);
 
+    // Packet synchronization scanner, using the user-specified or standard packet sizes.
+    ts::TSSyncScanner scanner;
+    if (opt.packet_size > 0) {
+        scanner.setFormats(ts::TSSyncScanner::FormatVector{ts::TSSyncScanner::Format(opt.packet_size, opt.header_size)});
+    }
+
     // Synchronization buffer
     ts::ByteBlock sync_buf_bb(opt.sync_size + opt.contig_size);
     uint8_t* const sync_buf = sync_buf_bb.data();
@@ -314,30 +308,18 @@ int MainCode(int argc, char *argv[])
         // Look for a range of packets for at least --min-contiguous bytes
         size_t const search_size = std::min(opt.contig_size, sync_size);
         uint8_t* const end_search = sync_end - search_size + 1;
-
-        // Search a range of valid packets. Try all expected packet sizes.
-        const uint8_t* start;
-        for (start = sync_buf; start < end_search; start++) {
-            if (opt.packet_size > 0) {
-                if (resync.checkSync(start, search_size, opt.packet_size, opt.header_size)) {
-                    // Found user-specified encapsulation of TS packets
-                    break;
-                }
-            }
-            else {
-                if (resync.checkSync(start, search_size, ts::PKT_SIZE, 0)) {
-                    // Found standard TS packets
-                    break;
-                }
-                if (resync.checkSync(start, search_size, ts::PKT_RS_SIZE, 0)) {
-                    // Found TS packets with trailing Reed-Solomon outer FEC
-                    break;
-                }
-                if (resync.checkSync(start, search_size, ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE)) {
-                    // Found TS packets with leading 4-byte timestamp (M2TS format, blu-ray discs)
-                    break;
-                }
-            }
+        scanner.setMinimum(1, search_size);
+
+        // Search a range of valid packets. Try all expected packet sizes: standard TS packets,
+        // TS packets with trailing Reed-Solomon outer FEC, TS packets with leading 4-byte timestamp
+        // (M2TS format, blu-ray discs) or user-specified encapsulation of TS packets.
+        const uint8_t* start = sync_buf;
+        size_t offset = 0;
+        size_t index = 0;
+        if (scanner.find(sync_buf, sync_size, offset, index) && offset < size_t(end_search - sync_buf)) {
+            const ts::TSSyncScanner::Format& format(scanner.formats()[index]);
+            start = sync_buf + offset;
+            resync.setPacketSize(format.packet_size, format.header_size);
         }
         if (resync.inputPacketSize() == 0) {
             std::cerr << "* Cannot find MPEG TS packets after " << ts::UString::Decimal(search_size) << " bytes" << std::endl;
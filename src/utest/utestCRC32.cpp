@@ -0,0 +1,198 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//
+//  TSUnit test suite for CRC32.
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32.h"
+#include "tsByteBlock.h"
+#include "tsSystemRandomGenerator.h"
+#include "tsTime.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class CRC32Test: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testKnownValues();
+    void testEngines();
+    void testPerformance();
+
+    TSUNIT_TEST_BEGIN(CRC32Test);
+    TSUNIT_TEST(testKnownValues);
+    TSUNIT_TEST(testEngines);
+    TSUNIT_TEST(testPerformance);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(CRC32Test);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void CRC32Test::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void CRC32Test::afterTest()
+{
+}
+
+namespace {
+    const ts::CRC32::Engine engines[] = {
+        ts::CRC32::ENGINE_BYTEWISE,
+        ts::CRC32::ENGINE_SLICING8,
+        ts::CRC32::ENGINE_CLMUL,
+        ts::CRC32::ENGINE_AUTO,
+    };
+
+    const char* EngineName(ts::CRC32::Engine engine)
+    {
+        switch (engine) {
+            case ts::CRC32::ENGINE_AUTO: return "auto";
+            case ts::CRC32::ENGINE_BYTEWISE: return "bytewise";
+            case ts::CRC32::ENGINE_SLICING8: return "slicing-by-8";
+            case ts::CRC32::ENGINE_CLMUL: return "carry-less multiplication";
+            default: return "unknown";
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void CRC32Test::testKnownValues()
+{
+    // Standard check value for CRC-32/MPEG-2.
+    static const char check[] = "123456789";
+    TSUNIT_EQUAL(uint32_t(0xFFFFFFFF), ts::CRC32().value());
+    TSUNIT_EQUAL(uint32_t(0x0376E6E7), ts::CRC32(check, 9).value());
+
+    // The CRC32 of data followed by their CRC32 is zero.
+    ts::ByteBlock data(check, 9);
+    data.appendUInt32(ts::CRC32(check, 9));
+    TSUNIT_EQUAL(uint32_t(0), ts::CRC32(data.data(), data.size()).value());
+
+    // Same check on a large area, larger than the minimum size for all engines.
+    data.resize(1000);
+    for (size_t i = 0; i < 996; ++i) {
+        data[i] = uint8_t(i * 7);
+    }
+    ts::PutUInt32(data.data() + 996, ts::CRC32(data.data(), 996));
+    for (size_t ei = 0; ei < sizeof(engines) / sizeof(engines[0]); ++ei) {
+        ts::CRC32 crc;
+        crc.add(data.data(), data.size(), engines[ei]);
+        TSUNIT_EQUAL(uint32_t(0), crc.value());
+    }
+}
+
+void CRC32Test::testEngines()
+{
+    debug() << "CRC32Test::testEngines: carry-less multiplication supported: "
+            << ts::UString::YesNo(ts::CRC32::IsEngineSupported(ts::CRC32::ENGINE_CLMUL)) << std::endl;
+
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock data(5000);
+    TSUNIT_ASSERT(prng.read(data.data(), data.size()));
+
+    // All engines must be bit-exact with the bytewise reference, for all sizes
+    // and alignments, and when the computation is split in several parts.
+    for (size_t size = 0; size <= 300; ++size) {
+        for (size_t offset = 0; offset < 4; ++offset) {
+            const uint8_t* const start = data.data() + offset;
+            ts::CRC32 ref;
+            ref.add(start, size, ts::CRC32::ENGINE_BYTEWISE);
+            for (size_t ei = 0; ei < sizeof(engines) / sizeof(engines[0]); ++ei) {
+                ts::CRC32 crc;
+                crc.add(start, size, engines[ei]);
+                TSUNIT_EQUAL(ref.value(), crc.value());
+                const size_t split = size / 3;
+                ts::CRC32 crc2;
+                crc2.add(start, split, engines[ei]);
+                crc2.add(start + split, size - split, engines[ei]);
+                TSUNIT_EQUAL(ref.value(), crc2.value());
+            }
+        }
+    }
+
+    ts::CRC32 ref;
+    ref.add(data.data(), data.size(), ts::CRC32::ENGINE_BYTEWISE);
+    for (size_t ei = 0; ei < sizeof(engines) / sizeof(engines[0]); ++ei) {
+        ts::CRC32 crc;
+        crc.add(data.data(), data.size(), engines[ei]);
+        TSUNIT_EQUAL(ref.value(), crc.value());
+    }
+}
+
+void CRC32Test::testPerformance()
+{
+    if (debugMode()) {
+        // Compare the throughput of the engines on typical section sizes and on a large area.
+        static const size_t sizes[] = {188, 1024, 4096, 1024 * 1024};
+        const size_t total = 32 * 1024 * 1024;
+        ts::ByteBlock data(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = uint8_t(i);
+        }
+
+        for (size_t ei = 0; ei < sizeof(engines) / sizeof(engines[0]); ++ei) {
+            const ts::CRC32::Engine engine = engines[ei];
+            if (ts::CRC32::IsEngineSupported(engine)) {
+                for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+                    const size_t size = sizes[si];
+                    const size_t count = total / size;
+                    uint32_t dummy = 0;
+                    const ts::Time start(ts::Time::CurrentUTC());
+                    for (size_t i = 0; i < count; ++i) {
+                        ts::CRC32 crc;
+                        crc.add(data.data(), size, engine);
+                        dummy += crc.value();
+                    }
+                    const ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+                    debug() << "CRC32Test::testPerformance: " << EngineName(engine) << ", " << size << " bytes: "
+                            << (count * size * ts::MilliSecPerSec / duration / (1024 * 1024)) << " MB/s"
+                            << " (" << ts::UString::Hexa(dummy) << ")" << std::endl;
+                }
+            }
+        }
+    }
+}
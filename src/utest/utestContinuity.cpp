@@ -33,6 +33,7 @@
 
 #include "tsContinuityAnalyzer.h"
 #include "tsReportBuffer.h"
+#include "tsMonotonic.h"
 #include "tsunit.h"
 
 
@@ -48,10 +49,14 @@ public:
 
     void testAnalyze();
     void testFix();
+    void testPIDFilter();
+    void testThroughput();
 
     TSUNIT_TEST_BEGIN(ContinuityTest);
     TSUNIT_TEST(testAnalyze);
     TSUNIT_TEST(testFix);
+    TSUNIT_TEST(testPIDFilter);
+    TSUNIT_TEST(testThroughput);
     TSUNIT_TEST_END();
 };
 
@@ -235,3 +240,100 @@ void ContinuityTest::testFix()
     TSUNIT_EQUAL(2, fixer.errorCount());
     TSUNIT_EQUAL(5, fixer.fixCount());
 }
+
+void ContinuityTest::testPIDFilter()
+{
+    ts::ContinuityAnalyzer fixer(ts::NoPID);
+    ts::TSPacket pkt(ts::NullPacket);
+
+    fixer.addPID(100);
+    fixer.addPID(200);
+    fixer.addPID(300);
+    TSUNIT_EQUAL(3, fixer.pidCount());
+
+    pkt.setPID(100); pkt.setCC(1);
+    TSUNIT_ASSERT(fixer.feedPacket(pkt));
+    pkt.setPID(200); pkt.setCC(2);
+    TSUNIT_ASSERT(fixer.feedPacket(pkt));
+    pkt.setPID(300); pkt.setCC(3);
+    TSUNIT_ASSERT(fixer.feedPacket(pkt));
+    pkt.setPID(400); pkt.setCC(4);
+    TSUNIT_ASSERT(fixer.feedPacket(pkt));
+
+    TSUNIT_EQUAL(4, fixer.totalPackets());
+    TSUNIT_EQUAL(3, fixer.processedPackets());
+    TSUNIT_EQUAL(1, fixer.firstCC(100));
+    TSUNIT_EQUAL(2, fixer.lastCC(200));
+    TSUNIT_EQUAL(3, fixer.lastCC(300));
+    TSUNIT_EQUAL(ts::INVALID_CC, fixer.firstCC(400));
+    TSUNIT_EQUAL(0, fixer.dupCount(300));
+    TSUNIT_EQUAL(ts::NPOS, fixer.dupCount(400));
+    TSUNIT_EQUAL(300, fixer.lastPacket(300).getPID());
+    TSUNIT_ASSERT(fixer.lastPacket(400) == ts::NullPacket);
+
+    // Removing a PID forgets its state, other PID's are preserved.
+    fixer.removePID(100);
+    TSUNIT_EQUAL(2, fixer.pidCount());
+    TSUNIT_EQUAL(ts::INVALID_CC, fixer.firstCC(100));
+    TSUNIT_EQUAL(2, fixer.lastCC(200));
+    TSUNIT_EQUAL(3, fixer.lastCC(300));
+
+    pkt.setPID(300); pkt.setCC(4);
+    TSUNIT_ASSERT(fixer.feedPacket(pkt));
+    pkt.setPID(300); pkt.setCC(6);
+    TSUNIT_ASSERT(!fixer.feedPacket(pkt));
+    TSUNIT_EQUAL(1, fixer.errorCount());
+
+    fixer.setPIDFilter(ts::PIDSet().set(100).set(300));
+    TSUNIT_EQUAL(2, fixer.pidCount());
+    TSUNIT_EQUAL(ts::INVALID_CC, fixer.firstCC(200));
+    TSUNIT_EQUAL(3, fixer.firstCC(300));
+    TSUNIT_EQUAL(6, fixer.lastCC(300));
+
+    pkt.setPID(100); pkt.setCC(9);
+    TSUNIT_ASSERT(fixer.feedPacket(pkt));
+    TSUNIT_EQUAL(9, fixer.firstCC(100));
+
+    // A copy is independent from the original.
+    ts::ContinuityAnalyzer copy(fixer);
+    pkt.setPID(300); pkt.setCC(7);
+    TSUNIT_ASSERT(copy.feedPacket(pkt));
+    TSUNIT_EQUAL(7, copy.lastCC(300));
+    TSUNIT_EQUAL(6, fixer.lastCC(300));
+
+    fixer.reset();
+    TSUNIT_EQUAL(0, fixer.totalPackets());
+    TSUNIT_EQUAL(ts::INVALID_CC, fixer.firstCC(300));
+    TSUNIT_EQUAL(9, copy.firstCC(100));
+}
+
+// Benchmark: packets per second on a multi-program stream, analysis and fix.
+void ContinuityTest::testThroughput()
+{
+    // 10 programs with 4 PID's each, PID's are interleaved.
+    constexpr size_t pid_count = 40;
+    constexpr size_t packet_count = 100000;
+    constexpr size_t repeat = 20;
+
+    ts::TSPacketVector packets(packet_count);
+    uint8_t cc[pid_count] = {0};
+    for (size_t n = 0; n < packets.size(); ++n) {
+        const size_t index = (n * 7) % pid_count;
+        packets[n].init(ts::PID(0x100 + 0x10 * (index / 4) + index % 4), cc[index]++ & ts::CC_MASK, uint8_t(n));
+    }
+
+    for (int fix = 0; fix <= 1; ++fix) {
+        ts::ContinuityAnalyzer fixer(ts::AllPIDs);
+        fixer.setFix(fix != 0);
+        const ts::Monotonic start(true);
+        for (size_t r = 0; r < repeat; ++r) {
+            for (auto& pkt : packets) {
+                fixer.feedPacket(pkt);
+            }
+        }
+        const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+        TSUNIT_EQUAL(repeat * packet_count, fixer.processedPackets());
+        debug() << "ContinuityTest: " << (fix != 0 ? "fix" : "analysis") << ", packets per second: "
+                << ts::UString::Decimal(int64_t((ts::NanoSecPerSec * repeat * packet_count) / duration)) << std::endl;
+    }
+}
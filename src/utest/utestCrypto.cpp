@@ -44,12 +44,14 @@
 #include "tsCTS2.h"
 #include "tsCTS3.h"
 #include "tsCTS4.h"
+#include "tsDVS042.h"
 #include "tsSCTE52.h"
 #include "tsDVBCSA2.h"
 #include "tsDVBCISSA.h"
 #include "tsIDSA.h"
 #include "tsTSPacket.h"
 #include "tsSystemRandomGenerator.h"
+#include "tsTime.h"
 #include "tsunit.h"
 
 #include "crypto/tv_aes.h"
@@ -85,10 +87,13 @@ public:
     void testAES_CTS3();
     void testAES_CTS4();
     void testAES_DVS042();
+    void testAES_Blocks();
     void testDES();
     void testTDES();
     void testTDES_CBC();
     void testDVBCSA2();
+    void testDVBCSA2Batch();
+    void testDVBCSA2BatchPerf();
     void testDVBCISSA();
     void testIDSA();
     void testSCTE52_2003();
@@ -107,10 +112,13 @@ public:
     TSUNIT_TEST(testAES_CTS3);
     TSUNIT_TEST(testAES_CTS4);
     TSUNIT_TEST(testAES_DVS042);
+    TSUNIT_TEST(testAES_Blocks);
     TSUNIT_TEST(testDES);
     TSUNIT_TEST(testTDES);
     TSUNIT_TEST(testTDES_CBC);
     TSUNIT_TEST(testDVBCSA2);
+    TSUNIT_TEST(testDVBCSA2Batch);
+    TSUNIT_TEST(testDVBCSA2BatchPerf);
     TSUNIT_TEST(testDVBCISSA);
     TSUNIT_TEST(testIDSA);
     TSUNIT_TEST(testSCTE52_2003);
@@ -412,6 +420,103 @@ void CryptoTest::testAES_DVS042()
     testChainingSizes(dvs042_aes, 16, 17, 23, 31, 32, 33, 45, 64, 67, 184, 12345, 0);
 }
 
+void CryptoTest::testAES_Blocks()
+{
+    // Multi-block processing (hardware-accelerated when available) must be
+    // bit-exact with the single-block processing.
+    debug() << "CryptoTest::testAES_Blocks: hardware acceleration: " << ts::UString::YesNo(ts::AES::IsAccelerated()) << std::endl;
+
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock key(32);
+    TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+
+    ts::AES aes;
+    TSUNIT_ASSERT(aes.setKey(key.data(), key.size()));
+
+    for (size_t count = 0; count <= 37; ++count) {
+        const size_t size = count * ts::AES::BLOCK_SIZE;
+        ts::ByteBlock plain(size);
+        TSUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+
+        // Reference: one block at a time.
+        ts::ByteBlock ecb(size);
+        for (size_t i = 0; i < size; i += ts::AES::BLOCK_SIZE) {
+            TSUNIT_ASSERT(aes.encrypt(plain.data() + i, ts::AES::BLOCK_SIZE, ecb.data() + i, ts::AES::BLOCK_SIZE));
+        }
+
+        // Multi-block, out of place and in place.
+        ts::ByteBlock cipher(size);
+        TSUNIT_ASSERT(aes.encryptBlocks(plain.data(), cipher.data(), count));
+        TSUNIT_ASSERT(cipher == ecb);
+        ts::ByteBlock decipher(size);
+        TSUNIT_ASSERT(aes.decryptBlocks(cipher.data(), decipher.data(), count));
+        TSUNIT_ASSERT(decipher == plain);
+        TSUNIT_ASSERT(aes.decryptBlocks(cipher.data(), cipher.data(), count));
+        TSUNIT_ASSERT(cipher == plain);
+        TSUNIT_ASSERT(aes.encryptBlocks(cipher.data(), cipher.data(), count));
+        TSUNIT_ASSERT(cipher == ecb);
+
+        if (count == 0) {
+            continue;
+        }
+
+        // CBC: pipelined decryption, compared with a manual single-block computation.
+        ts::CBC<ts::AES> cbc;
+        ts::ByteBlock iv(ts::AES::BLOCK_SIZE);
+        TSUNIT_ASSERT(prng.read(iv.data(), iv.size()));
+        TSUNIT_ASSERT(cbc.setKey(key.data(), key.size()));
+        TSUNIT_ASSERT(cbc.setIV(iv.data(), iv.size()));
+        ts::ByteBlock expected(size);
+        ts::ByteBlock block(ts::AES::BLOCK_SIZE);
+        const uint8_t* previous = iv.data();
+        for (size_t i = 0; i < size; i += ts::AES::BLOCK_SIZE) {
+            for (size_t j = 0; j < ts::AES::BLOCK_SIZE; ++j) {
+                block[j] = plain[i + j] ^ previous[j];
+            }
+            TSUNIT_ASSERT(aes.encrypt(block.data(), block.size(), expected.data() + i, ts::AES::BLOCK_SIZE));
+            previous = expected.data() + i;
+        }
+        TSUNIT_ASSERT(cbc.encrypt(plain.data(), size, cipher.data(), size));
+        TSUNIT_ASSERT(cipher == expected);
+        TSUNIT_ASSERT(cbc.decrypt(cipher.data(), size, decipher.data(), size));
+        TSUNIT_ASSERT(decipher == plain);
+        TSUNIT_ASSERT(cbc.decryptInPlace(cipher.data(), size));
+        TSUNIT_ASSERT(cipher == plain);
+
+        // CTR: pipelined key stream, compared with a manual single-block computation.
+        ts::CTR<ts::AES> ctr;
+        TSUNIT_ASSERT(ctr.setKey(key.data(), key.size()));
+        TSUNIT_ASSERT(ctr.setIV(iv.data(), iv.size()));
+        ts::ByteBlock counter(iv);
+        for (size_t i = 0; i < size; i += ts::AES::BLOCK_SIZE) {
+            TSUNIT_ASSERT(aes.encrypt(counter.data(), counter.size(), block.data(), block.size()));
+            for (size_t j = 0; j < ts::AES::BLOCK_SIZE; ++j) {
+                expected[i + j] = plain[i + j] ^ block[j];
+            }
+            // Default CTR counter: 64 least significant bits, big endian.
+            for (size_t j = counter.size(); j > counter.size() - 8 && ++counter[j - 1] == 0; --j) {
+            }
+        }
+        TSUNIT_ASSERT(ctr.encrypt(plain.data(), size, cipher.data(), size));
+        TSUNIT_ASSERT(cipher == expected);
+        TSUNIT_ASSERT(ctr.decryptInPlace(cipher.data(), size));
+        TSUNIT_ASSERT(cipher == plain);
+
+        // DVS042 with a residue: pipelined decryption of the full blocks.
+        ts::DVS042<ts::AES> dvs042;
+        TSUNIT_ASSERT(dvs042.setKey(key.data(), key.size()));
+        TSUNIT_ASSERT(dvs042.setIV(iv.data(), iv.size()));
+        const size_t dsize = size - 5;
+        ts::ByteBlock dcipher(dsize);
+        ts::ByteBlock ddecipher(dsize);
+        if (dsize >= ts::AES::BLOCK_SIZE) {
+            TSUNIT_ASSERT(dvs042.encrypt(plain.data(), dsize, dcipher.data(), dsize));
+            TSUNIT_ASSERT(dvs042.decrypt(dcipher.data(), dsize, ddecipher.data(), dsize));
+            TSUNIT_ASSERT(ts::ByteBlock(plain.data(), dsize) == ddecipher);
+        }
+    }
+}
+
 void CryptoTest::testDES()
 {
     ts::DES des;
@@ -488,6 +593,122 @@ void CryptoTest::testDVBCSA2()
     }
 }
 
+namespace {
+    // List of DVB-CSA2 batch engines to test.
+    const ts::DVBCSA2::BatchEngine csa_engines[] = {ts::DVBCSA2::BATCH_PORTABLE, ts::DVBCSA2::BATCH_SSE2, ts::DVBCSA2::BATCH_AVX2};
+
+    const ts::UChar* CSAEngineName(ts::DVBCSA2::BatchEngine engine)
+    {
+        switch (engine) {
+            case ts::DVBCSA2::BATCH_PORTABLE: return u"portable";
+            case ts::DVBCSA2::BATCH_SSE2: return u"SSE2";
+            case ts::DVBCSA2::BATCH_AVX2: return u"AVX2";
+            case ts::DVBCSA2::BATCH_AUTO: return u"auto";
+            default: return u"unknown";
+        }
+    }
+}
+
+void CryptoTest::testDVBCSA2Batch()
+{
+    ts::SystemRandomGenerator prng;
+    const size_t counts[] = {1, 3, 5, 64, 300};
+
+    for (size_t ei = 0; ei < sizeof(csa_engines) / sizeof(csa_engines[0]); ++ei) {
+        const ts::DVBCSA2::BatchEngine engine = csa_engines[ei];
+        if (!ts::DVBCSA2::IsBatchEngineSupported(engine)) {
+            debug() << "CryptoTest::testDVBCSA2Batch: " << CSAEngineName(engine) << " engine not supported" << std::endl;
+            continue;
+        }
+        debug() << "CryptoTest::testDVBCSA2Batch: testing " << CSAEngineName(engine) << " engine" << std::endl;
+
+        for (size_t ci = 0; ci < sizeof(counts) / sizeof(counts[0]); ++ci) {
+            const size_t count = counts[ci];
+
+            // Random key and random messages of random sizes, including less than 8 bytes.
+            ts::ByteBlock key(ts::DVBCSA2::KEY_SIZE);
+            TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+            std::vector<ts::ByteBlock> plain(count);
+            std::vector<ts::ByteBlock> cipher(count);
+            std::vector<uint8_t*> data(count);
+            std::vector<size_t> sizes(count);
+            for (size_t i = 0; i < count; ++i) {
+                uint8_t rnd = 0;
+                TSUNIT_ASSERT(prng.read(&rnd, 1));
+                const size_t size = i == 0 ? 184 : (i == 1 ? 7 : rnd % 185);
+                plain[i].resize(size);
+                TSUNIT_ASSERT(prng.read(plain[i].data(), size));
+                cipher[i] = plain[i];
+                data[i] = cipher[i].data();
+                sizes[i] = size;
+            }
+
+            // Reference implementation, one message at a time.
+            ts::DVBCSA2 ref;
+            TSUNIT_ASSERT(ref.setKey(key.data(), key.size()));
+            std::vector<ts::ByteBlock> expected(plain);
+            for (size_t i = 0; i < count; ++i) {
+                TSUNIT_ASSERT(expected[i].empty() || ref.encryptInPlace(expected[i].data(), expected[i].size()));
+            }
+
+            // Batch encryption must be bit-exact with the reference.
+            ts::DVBCSA2 csa;
+            TSUNIT_ASSERT(csa.setBatchEngine(engine));
+            TSUNIT_EQUAL(engine, csa.batchEngine());
+            TSUNIT_ASSERT(!csa.encryptPackets(data.data(), sizes.data(), count));
+            TSUNIT_ASSERT(csa.setKey(key.data(), key.size()));
+            TSUNIT_ASSERT(csa.encryptPackets(data.data(), sizes.data(), count));
+            for (size_t i = 0; i < count; ++i) {
+                TSUNIT_ASSERT(expected[i] == cipher[i]);
+            }
+
+            // Batch decryption must restore the plain messages.
+            TSUNIT_ASSERT(csa.decryptPackets(data.data(), sizes.data(), count));
+            for (size_t i = 0; i < count; ++i) {
+                TSUNIT_ASSERT(plain[i] == cipher[i]);
+            }
+        }
+    }
+}
+
+void CryptoTest::testDVBCSA2BatchPerf()
+{
+    if (debugMode()) {
+        // Compare the throughput of the reference implementation and the batch engines.
+        const size_t pkt_count = 20000;
+        const size_t batch_count = 500;
+        std::vector<ts::TSPacket> packets(pkt_count, ts::NullPacket);
+        std::vector<uint8_t*> data(pkt_count);
+        std::vector<size_t> sizes(pkt_count, 184);
+        for (size_t i = 0; i < pkt_count; ++i) {
+            data[i] = packets[i].b + 4;
+        }
+
+        ts::DVBCSA2 csa;
+        const uint8_t key[ts::DVBCSA2::KEY_SIZE] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+        TSUNIT_ASSERT(csa.setKey(key, sizeof(key)));
+
+        ts::Time start(ts::Time::CurrentUTC());
+        for (size_t i = 0; i < pkt_count; ++i) {
+            TSUNIT_ASSERT(csa.encryptInPlace(data[i], sizes[i]));
+        }
+        ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+        debug() << "CryptoTest::testDVBCSA2BatchPerf: reference: " << (pkt_count * ts::MilliSecPerSec / duration) << " packets/s" << std::endl;
+
+        for (size_t ei = 0; ei < sizeof(csa_engines) / sizeof(csa_engines[0]); ++ei) {
+            const ts::DVBCSA2::BatchEngine engine = csa_engines[ei];
+            if (csa.setBatchEngine(engine)) {
+                start = ts::Time::CurrentUTC();
+                for (size_t i = 0; i < pkt_count; i += batch_count) {
+                    TSUNIT_ASSERT(csa.encryptPackets(&data[i], &sizes[i], std::min(batch_count, pkt_count - i)));
+                }
+                duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+                debug() << "CryptoTest::testDVBCSA2BatchPerf: " << CSAEngineName(engine) << " engine: " << (pkt_count * ts::MilliSecPerSec / duration) << " packets/s" << std::endl;
+            }
+        }
+    }
+}
+
 void CryptoTest::testDVBCISSA()
 {
     ts::DVBCISSA cissa;
@@ -44,6 +44,9 @@
 #include "tsBAT.h"
 #include "tsTOT.h"
 #include "tsTDT.h"
+#include "tsEIT.h"
+#include "tsShortEventDescriptor.h"
+#include "tsTime.h"
 #include "tsNames.h"
 #include "tsunit.h"
 
@@ -92,6 +95,7 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testEITPerformance();
 
     TSUNIT_TEST_BEGIN(DemuxTest);
     TSUNIT_TEST(testPAT);
@@ -105,6 +109,7 @@ public:
     TSUNIT_TEST(testTDT);
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testHEVC);
+    TSUNIT_TEST(testEITPerformance);
     TSUNIT_TEST_END();
 
 private:
@@ -489,3 +494,95 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+// Demux handler which checks demuxed sections against reference sections.
+namespace {
+    class EITHandler: public ts::TableHandlerInterface, public ts::SectionHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(EITHandler);
+    public:
+        EITHandler(const ts::SectionPtrVector& ref) : tables(0), sections(0), errors(0), _ref(ref) {}
+        size_t tables;
+        size_t sections;
+        size_t errors;
+        virtual void handleTable(ts::SectionDemux&, const ts::BinaryTable& table) override
+        {
+            tables++;
+            if (!table.isValid()) {
+                errors++;
+            }
+        }
+        virtual void handleSection(ts::SectionDemux&, const ts::Section& section) override
+        {
+            // Demuxed sections come in the same order as reference sections.
+            if (!section.isValid() || !(section == *_ref[sections++ % _ref.size()])) {
+                errors++;
+            }
+        }
+    private:
+        const ts::SectionPtrVector& _ref;
+    };
+}
+
+void DemuxTest::testEITPerformance()
+{
+    // Build an EIT-heavy stream: EIT p/f and two EIT schedule tables per service.
+    ts::DuckContext duck;
+    ts::OneShotPacketizer pzer(duck, ts::PID_EIT);
+    ts::SectionPtrVector ref;
+    size_t ref_tables = 0;
+    const ts::Time base(2023, 1, 1, 0, 0);
+
+    for (uint16_t srv = 1; srv <= 32; ++srv) {
+        for (int index = -1; index < 2; ++index) {
+            ts::EIT eit(true, index < 0, uint8_t(std::max(index, 0)), uint8_t(srv % 32), true, srv, 1, 1);
+            const size_t count = index < 0 ? 2 : 64;
+            for (size_t ev = 0; ev < count; ++ev) {
+                ts::EIT::Event& event(eit.events.newEntry());
+                event.event_id = uint16_t(1000 + ev);
+                event.start_time = base + ts::MilliSecond(ev) * 30 * ts::MilliSecPerMin;
+                event.duration = 30 * 60;
+                event.descs.add(duck, ts::ShortEventDescriptor(u"eng", ts::UString::Format(u"Event %d of service %d", {ev, srv}), u"A typical event description in the EPG."));
+            }
+            ts::BinaryTable bin;
+            eit.serialize(duck, bin);
+            TSUNIT_ASSERT(bin.isValid());
+            pzer.addTable(bin);
+            for (size_t i = 0; i < bin.sectionCount(); ++i) {
+                ref.push_back(bin.sectionAt(i));
+            }
+            ref_tables++;
+        }
+    }
+    ts::TSPacketVector packets;
+    pzer.getPackets(packets);
+    debug() << "DemuxTest::testEITPerformance: " << ref_tables << " tables, " << ref.size() << " sections, " << packets.size() << " packets" << std::endl;
+
+    // Check that all sections and tables are correctly demuxed, once.
+    EITHandler handler(ref);
+    ts::SectionDemux demux(duck, &handler, &handler, ts::AllPIDs);
+    for (const auto& pkt : packets) {
+        demux.feedPacket(pkt);
+    }
+    TSUNIT_EQUAL(ref_tables, handler.tables);
+    TSUNIT_EQUAL(ref.size(), handler.sections);
+    TSUNIT_EQUAL(0, handler.errors);
+
+    // Measure the demux throughput with the same tables, repeatedly broadcast.
+    // Only informational, displayed in debug mode. Otherwise, only check one repetition.
+    const size_t repeat = debugMode() ? 100 : 2;
+    const ts::Time start(ts::Time::CurrentUTC());
+    for (size_t iter = 1; iter < repeat; ++iter) {
+        for (auto& pkt : packets) {
+            // Keep the continuity counters contiguous.
+            pkt.setCC(uint8_t((pkt.getCC() + packets.size()) & ts::CC_MASK));
+            demux.feedPacket(pkt);
+        }
+    }
+    const ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+    TSUNIT_EQUAL(ref_tables, handler.tables);
+    TSUNIT_EQUAL(repeat * ref.size(), handler.sections);
+    TSUNIT_EQUAL(0, handler.errors);
+    debug() << "DemuxTest::testEITPerformance: " << ((repeat - 1) * ref.size() * ts::MilliSecPerSec / duration) << " sections/s, "
+            << ((repeat - 1) * packets.size() * ts::MilliSecPerSec / duration) << " packets/s" << std::endl;
+}
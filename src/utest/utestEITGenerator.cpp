@@ -0,0 +1,269 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::EITGenerator
+//
+//----------------------------------------------------------------------------
+
+#include "tsEITGenerator.h"
+#include "tsDuckContext.h"
+#include "tsEIT.h"
+#include "tsMJD.h"
+#include "tsBCD.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class EITGeneratorTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testPresentFollowing();
+    void testIncremental();
+    void testRegenerationTime();
+
+    TSUNIT_TEST_BEGIN(EITGeneratorTest);
+    TSUNIT_TEST(testPresentFollowing);
+    TSUNIT_TEST(testIncremental);
+    TSUNIT_TEST(testRegenerationTime);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(EITGeneratorTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void EITGeneratorTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void EITGeneratorTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Helper functions.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Reference time in all tests.
+    const ts::Time base_time(2023, 6, 1, 0, 0);
+
+    // Append a binary event, as in an EIT section, with a short event descriptor.
+    void AddEvent(ts::ByteBlock& data, uint16_t event_id, const ts::Time& start, ts::MilliSecond duration)
+    {
+        const std::string name(ts::UString::Format(u"Event %d", {event_id}).toUTF8());
+        const size_t base = data.size();
+        data.resize(base + ts::EIT::EIT_EVENT_FIXED_SIZE);
+        uint8_t* ev = data.data() + base;
+        ts::PutUInt16(ev, event_id);
+        ts::EncodeMJD(start, ev + 2, ts::MJD_SIZE);
+        const ts::Second secs = duration / ts::MilliSecPerSec;
+        ev[7] = ts::EncodeBCD(int(secs / 3600));
+        ev[8] = ts::EncodeBCD(int(secs / 60 % 60));
+        ev[9] = ts::EncodeBCD(int(secs % 60));
+        // Short event descriptor, ASCII name is valid in the default DVB character set.
+        data.appendUInt8(ts::DID_SHORT_EVENT);
+        data.appendUInt8(uint8_t(5 + name.size()));
+        data.append("eng", 3);
+        data.appendUInt8(uint8_t(name.size()));
+        data.append(name);
+        data.appendUInt8(0);
+        ts::PutUInt16(data.data() + base + 10, uint16_t(data.size() - base - ts::EIT::EIT_EVENT_FIXED_SIZE));
+    }
+
+    // Load one-hour events for a set of services over some days, starting at base time plus an offset.
+    // Stop after max_events events. Return the number of loaded events.
+    size_t LoadEvents(ts::EITGenerator& gen, uint16_t first_service, uint16_t service_count, int days, ts::MilliSecond offset, uint16_t first_event_id, size_t max_events = ts::NPOS)
+    {
+        size_t count = 0;
+        for (uint16_t srv = first_service; count < max_events && srv < first_service + service_count; ++srv) {
+            ts::ByteBlock data;
+            uint16_t event_id = first_event_id;
+            for (int hour = 0; count < max_events && hour < 24 * days; ++hour, ++count) {
+                AddEvent(data, event_id++, base_time + hour * ts::MilliSecPerHour + offset, ts::MilliSecPerHour);
+            }
+            gen.loadEvents(ts::ServiceIdTriplet(srv, 1, 1), data.data(), data.size());
+        }
+        return count;
+    }
+
+    // Get the event id in an EIT p/f for a service, 0xFFFF if there is none.
+    uint16_t PresentFollowingEvent(ts::EITGenerator& gen, uint16_t service_id, uint8_t section_number)
+    {
+        ts::SectionPtrVector sections;
+        gen.saveEITs(sections);
+        for (const auto& sec : sections) {
+            if (sec->tableId() == ts::TID_EIT_PF_ACT && sec->tableIdExtension() == service_id && sec->sectionNumber() == section_number) {
+                return sec->payloadSize() > ts::EIT::EIT_PAYLOAD_FIXED_SIZE ? ts::GetUInt16(sec->payload() + ts::EIT::EIT_PAYLOAD_FIXED_SIZE) : 0xFFFF;
+            }
+        }
+        return 0xFFFF;
+    }
+
+    // Get a description of all EIT sections, indexed by table id, service and section number, without version and CRC.
+    std::map<uint32_t, ts::ByteBlock> SectionsContent(ts::EITGenerator& gen)
+    {
+        ts::SectionPtrVector sections;
+        gen.saveEITs(sections);
+        std::map<uint32_t, ts::ByteBlock> content;
+        for (const auto& sec : sections) {
+            ts::ByteBlock& bb(content[(uint32_t(sec->tableId()) << 24) | (uint32_t(sec->tableIdExtension()) << 8) | sec->sectionNumber()]);
+            bb.copy(sec->content(), sec->size() - ts::SECTION_CRC32_SIZE);
+            bb[5] &= 0xC1; // remove version
+        }
+        return content;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// EIT p/f update when the time increases.
+//----------------------------------------------------------------------------
+
+void EITGeneratorTest::testPresentFollowing()
+{
+    ts::DuckContext duck;
+    ts::EITGenerator gen(duck, ts::PID_EIT, ts::EITOption::GEN_ACTUAL | ts::EITOption::GEN_PF);
+    gen.setTransportStreamId(1);
+    gen.setCurrentTime(base_time);
+
+    // Events 100, 101, 102, starting at 01:00.
+    ts::ByteBlock data;
+    AddEvent(data, 100, base_time + ts::MilliSecPerHour, ts::MilliSecPerHour);
+    AddEvent(data, 101, base_time + 2 * ts::MilliSecPerHour, ts::MilliSecPerHour);
+    AddEvent(data, 102, base_time + 3 * ts::MilliSecPerHour, ts::MilliSecPerHour);
+    TSUNIT_ASSERT(gen.loadEvents(ts::ServiceIdTriplet(10, 1, 1), data.data(), data.size()));
+
+    TSUNIT_EQUAL(0xFFFF, PresentFollowingEvent(gen, 10, 0));
+    TSUNIT_EQUAL(100, PresentFollowingEvent(gen, 10, 1));
+
+    gen.setCurrentTime(base_time + 30 * ts::MilliSecPerMin);
+    TSUNIT_EQUAL(0xFFFF, PresentFollowingEvent(gen, 10, 0));
+    TSUNIT_EQUAL(100, PresentFollowingEvent(gen, 10, 1));
+
+    gen.setCurrentTime(base_time + 90 * ts::MilliSecPerMin);
+    TSUNIT_EQUAL(100, PresentFollowingEvent(gen, 10, 0));
+    TSUNIT_EQUAL(101, PresentFollowingEvent(gen, 10, 1));
+
+    gen.setCurrentTime(base_time + 150 * ts::MilliSecPerMin);
+    TSUNIT_EQUAL(101, PresentFollowingEvent(gen, 10, 0));
+    TSUNIT_EQUAL(102, PresentFollowingEvent(gen, 10, 1));
+
+    // Back in time, the events which were removed are not restored.
+    gen.setCurrentTime(base_time + 30 * ts::MilliSecPerMin);
+    TSUNIT_EQUAL(0xFFFF, PresentFollowingEvent(gen, 10, 0));
+    TSUNIT_EQUAL(101, PresentFollowingEvent(gen, 10, 1));
+
+    gen.setCurrentTime(base_time + 210 * ts::MilliSecPerMin);
+    TSUNIT_EQUAL(102, PresentFollowingEvent(gen, 10, 0));
+    TSUNIT_EQUAL(0xFFFF, PresentFollowingEvent(gen, 10, 1));
+}
+
+
+//----------------------------------------------------------------------------
+// Incremental regeneration produces the same EIT's as a complete generation.
+//----------------------------------------------------------------------------
+
+void EITGeneratorTest::testIncremental()
+{
+    ts::DuckContext duck;
+    const ts::Time now(base_time + 10 * ts::MilliSecPerMin);
+
+    // Initial EPG, then update with events at half hours.
+    ts::EITGenerator gen1(duck, ts::PID_EIT, ts::EITOption::GEN_ALL);
+    gen1.setTransportStreamId(1);
+    gen1.setCurrentTime(now);
+    LoadEvents(gen1, 1, 10, 2, 0, 0);
+    const std::map<uint32_t, ts::ByteBlock> initial(SectionsContent(gen1));
+    LoadEvents(gen1, 5, 10, 3, 30 * ts::MilliSecPerMin, 1000);
+    const std::map<uint32_t, ts::ByteBlock> updated(SectionsContent(gen1));
+
+    // Same complete EPG in one shot.
+    ts::EITGenerator gen2(duck, ts::PID_EIT, ts::EITOption::GEN_ALL);
+    gen2.setTransportStreamId(1);
+    gen2.setCurrentTime(now);
+    LoadEvents(gen2, 1, 10, 2, 0, 0);
+    LoadEvents(gen2, 5, 10, 3, 30 * ts::MilliSecPerMin, 1000);
+    const std::map<uint32_t, ts::ByteBlock> complete(SectionsContent(gen2));
+
+    debug() << "EITGeneratorTest::testIncremental: initial: " << initial.size() << " sections, updated: " << updated.size() << " sections" << std::endl;
+    TSUNIT_ASSERT(updated.size() > initial.size());
+    TSUNIT_EQUAL(complete.size(), updated.size());
+    TSUNIT_ASSERT(complete == updated);
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: time to regenerate the EIT's after a 10k-event update.
+//----------------------------------------------------------------------------
+
+void EITGeneratorTest::testRegenerationTime()
+{
+    if (debugMode()) {
+        ts::DuckContext duck;
+        ts::EITGenerator gen(duck, ts::PID_EIT, ts::EITOption::GEN_ALL);
+        gen.setTransportStreamId(1);
+        gen.setCurrentTime(base_time + 10 * ts::MilliSecPerMin);
+
+        // Initial EPG: 100 services over 8 days.
+        const ts::Monotonic start(true);
+        const size_t initial_count = LoadEvents(gen, 1, 100, 8, 0, 0);
+        ts::SectionPtrVector initial;
+        gen.saveEITs(initial);
+        const ts::NanoSecond initial_time = ts::Monotonic(true) - start;
+
+        // Update with 10,000 events at half hours.
+        const ts::Monotonic update_start(true);
+        const size_t update_count = LoadEvents(gen, 1, 100, 8, 30 * ts::MilliSecPerMin, 10000, 10000);
+        ts::SectionPtrVector updated;
+        gen.saveEITs(updated);
+        const ts::NanoSecond update_time = ts::Monotonic(true) - update_start;
+
+        debug() << "EITGeneratorTest::testRegenerationTime: initial: " << initial_count << " events, " << initial.size() << " sections, "
+                << (initial_time / ts::NanoSecPerMicroSec) << " us" << std::endl
+                << "EITGeneratorTest::testRegenerationTime: update: " << update_count << " events, " << updated.size() << " sections, "
+                << (update_time / ts::NanoSecPerMicroSec) << " us" << std::endl;
+
+        TSUNIT_EQUAL(10000, update_count);
+        TSUNIT_ASSERT(updated.size() >= initial.size());
+    }
+}
@@ -32,6 +32,16 @@
 //----------------------------------------------------------------------------
 
 #include "tshlsPlayList.h"
+#include "tshlsSegmentPrefetcher.h"
+#include "tshlsSegmentStore.h"
+#include "tsTSProcessor.h"
+#include "tsPluginRepository.h"
+#include "tsProcessorPlugin.h"
+#include "tsFileUtils.h"
+#include "tsSysUtils.h"
+#include "tsTCPServer.h"
+#include "tsTCPConnection.h"
+#include "utestTSUnitThread.h"
 #include "tsunit.h"
 
 
@@ -51,12 +61,26 @@ public:
     void testMediaPlaylist();
     void testBuildMasterPlaylist();
     void testBuildMediaPlaylist();
+    void testPrefetch();
+    void testPrefetchLive();
+    void testPrefetchNoStall();
+    void testPrefetchHTTP();
+    void testSegmentStore();
+    void testOutputAsync();
+    void testOutputHTTP();
 
     TSUNIT_TEST_BEGIN(HLSTest);
     TSUNIT_TEST(testMasterPlaylist);
     TSUNIT_TEST(testMediaPlaylist);
     TSUNIT_TEST(testBuildMasterPlaylist);
     TSUNIT_TEST(testBuildMediaPlaylist);
+    TSUNIT_TEST(testPrefetch);
+    TSUNIT_TEST(testPrefetchLive);
+    TSUNIT_TEST(testPrefetchNoStall);
+    TSUNIT_TEST(testPrefetchHTTP);
+    TSUNIT_TEST(testSegmentStore);
+    TSUNIT_TEST(testOutputAsync);
+    TSUNIT_TEST(testOutputHTTP);
     TSUNIT_TEST_END();
 
 private:
@@ -333,3 +357,543 @@ void HLSTest::testBuildMediaPlaylist()
 
     TSUNIT_EQUAL(refContent2, pl.textContent());
 }
+
+// A segment prefetcher which simulates the downloads and the reloads of a live playlist.
+namespace {
+    class TestPrefetcher: public ts::hls::SegmentPrefetcher
+    {
+        TS_NOBUILD_NOCOPY(TestPrefetcher);
+    public:
+        // Segments are named "<index>.ts". Their download time is latency * (1 + index % 3).
+        // The live playlist ends after live_end segments.
+        TestPrefetcher(ts::MilliSecond latency, size_t live_end = 0) :
+            ts::hls::SegmentPrefetcher(CERR),
+            _latency(latency),
+            _live_end(live_end),
+            _next(0),
+            _active(0),
+            _max_active(0)
+        {
+        }
+
+        virtual ~TestPrefetcher() override
+        {
+            stop();
+        }
+
+        // Build a playlist with the first segments.
+        static ts::UString PlayListText(size_t count, bool live)
+        {
+            ts::UString text(u"#EXTM3U\n#EXT-X-VERSION:3\n#EXT-X-TARGETDURATION:1\n#EXT-X-MEDIA-SEQUENCE:0\n");
+            if (!live) {
+                text += u"#EXT-X-PLAYLIST-TYPE:VOD\n";
+            }
+            for (size_t i = 0; i < count; ++i) {
+                text += ts::UString::Format(u"#EXTINF:1,\n%d.ts\n", {i});
+            }
+            if (!live) {
+                text += u"#EXT-X-ENDLIST\n";
+            }
+            return text;
+        }
+
+        // Index of a segment, from its URL or content.
+        static size_t SegmentIndex(const ts::UString& url)
+        {
+            size_t index = ts::NPOS;
+            ts::BaseName(url, u".ts").toInteger(index);
+            return index;
+        }
+
+        size_t maxActive() const { return _max_active; }
+        void setNext(size_t next) { _next = next; }
+
+    protected:
+        virtual bool downloadSegment(ts::WebRequest&, const ts::UString& url, ts::ByteBlock& data) override
+        {
+            const size_t active = ++_active;
+            for (size_t max = _max_active; active > max && !_max_active.compare_exchange_weak(max, active); ) {
+            }
+            // Variable latency, the downloads complete out of order.
+            const size_t index = SegmentIndex(url);
+            ts::SleepThread(_latency * ts::MilliSecond(1 + index % 3));
+            data.clear();
+            data.appendUInt32(uint32_t(index));
+            data.append(url.toUTF8());
+            --_active;
+            return index != ts::NPOS;
+        }
+
+        virtual bool reloadPlayList(ts::hls::PlayList& playlist, const ts::WebRequestArgs&) override
+        {
+            // Simulate a live server which produces two new segments per reload.
+            for (size_t i = 0; i < 2 && _next < _live_end; ++i) {
+                ts::hls::MediaSegment seg;
+                seg.relativeURI = ts::UString::Format(u"%d.ts", {_next++});
+                playlist.buildURL(seg, seg.relativeURI);
+                playlist.addSegment(seg, CERR);
+            }
+            if (_next >= _live_end) {
+                playlist.setEndList(true, CERR);
+            }
+            return true;
+        }
+
+    private:
+        const ts::MilliSecond _latency;
+        const size_t          _live_end;
+        size_t                _next;
+        std::atomic<size_t>   _active;
+        std::atomic<size_t>   _max_active;
+    };
+}
+
+void HLSTest::testPrefetch()
+{
+    const size_t count = 12;
+    const size_t depth = 4;
+
+    ts::hls::PlayList pl;
+    TSUNIT_ASSERT(pl.loadText(TestPrefetcher::PlayListText(count, false), true));
+    TSUNIT_EQUAL(count, pl.segmentCount());
+    TSUNIT_ASSERT(!pl.isUpdatable());
+
+    TestPrefetcher prefetcher(10);
+    TSUNIT_ASSERT(prefetcher.start(pl, ts::WebRequestArgs(), depth));
+
+    // Segments are returned in playlist order, whatever the download completion order.
+    ts::ByteBlock data;
+    ts::UString url;
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(prefetcher.getNextSegment(data, url));
+        TSUNIT_EQUAL(i, TestPrefetcher::SegmentIndex(url));
+        TSUNIT_ASSERT(data.size() >= 4);
+        TSUNIT_EQUAL(i, ts::GetUInt32(data.data()));
+    }
+    TSUNIT_ASSERT(!prefetcher.getNextSegment(data, url));
+    prefetcher.stop();
+
+    // The downloads were concurrent but bounded by the depth.
+    const ts::hls::SegmentPrefetcher::Statistics stats(prefetcher.statistics());
+    debug() << "HLSTest::testPrefetch: max active: " << stats.max_active << ", max ready: " << stats.max_ready
+            << ", stalls: " << stats.stalls << ", stall time: " << stats.stall_time / ts::NanoSecPerMilliSec << " ms" << std::endl;
+    TSUNIT_EQUAL(count, stats.segments);
+    TSUNIT_EQUAL(0, stats.failures);
+    TSUNIT_EQUAL(0, stats.reloads);
+    TSUNIT_ASSERT(stats.max_active > 1);
+    TSUNIT_ASSERT(stats.max_active <= depth);
+    TSUNIT_ASSERT(prefetcher.maxActive() <= depth);
+    TSUNIT_ASSERT(stats.max_ready <= depth);
+
+    // The application consumes faster than the downloads: underruns.
+    TSUNIT_ASSERT(stats.stalls > 0);
+    TSUNIT_ASSERT(stats.stall_time > 0);
+}
+
+void HLSTest::testPrefetchLive()
+{
+    const size_t count = 15;
+    const size_t depth = 3;
+
+    ts::hls::PlayList pl;
+    TSUNIT_ASSERT(pl.loadText(TestPrefetcher::PlayListText(3, true), true));
+    TSUNIT_ASSERT(pl.isUpdatable());
+
+    TestPrefetcher prefetcher(5, count);
+    prefetcher.setNext(3);
+    TSUNIT_ASSERT(prefetcher.start(pl, ts::WebRequestArgs(), depth));
+
+    ts::ByteBlock data;
+    ts::UString url;
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(prefetcher.getNextSegment(data, url));
+        TSUNIT_EQUAL(i, TestPrefetcher::SegmentIndex(url));
+    }
+    TSUNIT_ASSERT(!prefetcher.getNextSegment(data, url));
+    prefetcher.stop();
+
+    const ts::hls::SegmentPrefetcher::Statistics stats(prefetcher.statistics());
+    debug() << "HLSTest::testPrefetchLive: reloads: " << stats.reloads << ", max active: " << stats.max_active << std::endl;
+    TSUNIT_EQUAL(count, stats.segments);
+    TSUNIT_ASSERT(stats.reloads >= (count - 3) / 2);
+    TSUNIT_ASSERT(stats.max_active <= depth);
+}
+
+void HLSTest::testPrefetchNoStall()
+{
+    const size_t count = 8;
+
+    ts::hls::PlayList pl;
+    TSUNIT_ASSERT(pl.loadText(TestPrefetcher::PlayListText(count, false), true));
+
+    // Downloads are much faster than the application, up to 3 segments are prefetched.
+    TestPrefetcher prefetcher(2);
+    TSUNIT_ASSERT(prefetcher.start(pl, ts::WebRequestArgs(), 3, count - 2));
+
+    ts::ByteBlock data;
+    ts::UString url;
+    for (size_t i = 0; i < count - 2; ++i) {
+        TSUNIT_ASSERT(prefetcher.getNextSegment(data, url));
+        TSUNIT_EQUAL(i, TestPrefetcher::SegmentIndex(url));
+        ts::SleepThread(100);
+    }
+    // Maximum number of segments reached.
+    TSUNIT_ASSERT(!prefetcher.getNextSegment(data, url));
+    prefetcher.stop();
+
+    const ts::hls::SegmentPrefetcher::Statistics stats(prefetcher.statistics());
+    TSUNIT_EQUAL(count - 2, stats.segments);
+    TSUNIT_EQUAL(0, stats.stalls);
+    TSUNIT_EQUAL(3, stats.max_ready);
+
+    // After abort, no more segment is returned.
+    TestPrefetcher aborted(50);
+    TSUNIT_ASSERT(aborted.start(pl, ts::WebRequestArgs(), 2));
+    TSUNIT_ASSERT(aborted.getNextSegment(data, url));
+    aborted.abort();
+    TSUNIT_ASSERT(!aborted.getNextSegment(data, url));
+    aborted.stop();
+}
+
+
+// A minimal HTTP server, a local stand-in for an HLS server.
+// It serves a fixed number of requests, one at a time, and closes each connection.
+namespace {
+    class HTTPServer: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(HTTPServer);
+    public:
+        HTTPServer(ts::TCPServer& server, size_t segment_count, size_t request_count) :
+            utest::TSUnitThread(),
+            _server(server),
+            _segment_count(segment_count),
+            _request_count(request_count)
+        {
+        }
+
+        virtual ~HTTPServer() override
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            for (size_t req = 0; req < _request_count; ++req) {
+                ts::TCPConnection session;
+                ts::IPv4SocketAddress client;
+                TSUNIT_ASSERT(_server.accept(session, client, CERR));
+
+                // Read the request headers.
+                std::string request;
+                char buffer[1024];
+                size_t size = 0;
+                while (request.find("\r\n\r\n") == std::string::npos && session.receive(buffer, sizeof(buffer), size, nullptr, CERR)) {
+                    request.append(buffer, size);
+                }
+
+                // Get the requested path: "GET /path HTTP/1.1".
+                ts::UStringVector fields;
+                ts::UString::FromUTF8(request.substr(0, request.find("\r\n"))).split(fields, u' ', true, true);
+                const ts::UString path(fields.size() >= 2 ? fields[1] : ts::UString());
+                CERR.debug(u"HTTPServer: request %s", {path});
+
+                // Build the response.
+                std::string body;
+                if (path == u"/live.m3u8") {
+                    body = TestPrefetcher::PlayListText(_segment_count, false).toUTF8();
+                }
+                else {
+                    const size_t index = TestPrefetcher::SegmentIndex(path);
+                    body.assign(ts::PKT_SIZE * (index + 1), char(index));
+                }
+                const std::string header(ts::UString::Format(u"HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %d\r\nConnection: close\r\n\r\n",
+                                                             {path.endWith(u".m3u8") ? u"application/vnd.apple.mpegurl" : u"video/mp2t", body.size()}).toUTF8());
+                TSUNIT_ASSERT(session.send(header.data(), header.size(), CERR));
+                TSUNIT_ASSERT(session.send(body.data(), body.size(), CERR));
+                session.closeWriter(CERR);
+                session.disconnect(CERR);
+                session.close(CERR);
+            }
+        }
+
+    private:
+        ts::TCPServer& _server;
+        const size_t   _segment_count;
+        const size_t   _request_count;
+    };
+}
+
+void HLSTest::testPrefetchHTTP()
+{
+    const size_t count = 6;
+    const uint16_t portNumber = 12346;
+
+    // The library can be compiled without Web support.
+    if (ts::WebRequest::GetLibraryVersion().empty()) {
+        debug() << "HLSTest::testPrefetchHTTP: no Web support, skipped" << std::endl;
+        return;
+    }
+
+    TSUNIT_ASSERT(ts::IPInitialize());
+    ts::TCPServer server;
+    TSUNIT_ASSERT(server.open(CERR));
+    TSUNIT_ASSERT(server.reusePort(true, CERR));
+    TSUNIT_ASSERT(server.bind(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, portNumber), CERR));
+    TSUNIT_ASSERT(server.listen(5, CERR));
+
+    // One request for the playlist, one per segment.
+    HTTPServer http(server, count, count + 1);
+    http.start();
+
+    ts::hls::PlayList pl;
+    TSUNIT_ASSERT(pl.loadURL(ts::UString::Format(u"http://127.0.0.1:%d/live.m3u8", {portNumber}), true));
+    TSUNIT_EQUAL(count, pl.segmentCount());
+
+    ts::hls::SegmentPrefetcher prefetcher(CERR);
+    TSUNIT_ASSERT(prefetcher.start(pl, ts::WebRequestArgs(), 3));
+
+    ts::ByteBlock data;
+    ts::UString url;
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(prefetcher.getNextSegment(data, url));
+        TSUNIT_EQUAL(ts::UString::Format(u"http://127.0.0.1:%d/%d.ts", {portNumber, i}), url);
+        TSUNIT_EQUAL(ts::PKT_SIZE * (i + 1), data.size());
+        TSUNIT_EQUAL(uint8_t(i), data[0]);
+    }
+    TSUNIT_ASSERT(!prefetcher.getNextSegment(data, url));
+    prefetcher.stop();
+    http.waitForTermination();
+    server.close(CERR);
+
+    const ts::hls::SegmentPrefetcher::Statistics stats(prefetcher.statistics());
+    TSUNIT_EQUAL(count, stats.segments);
+    TSUNIT_EQUAL(0, stats.failures);
+}
+
+// Send an HTTP GET request on the local host, get the status line and the body of the response.
+namespace {
+    bool HTTPGet(uint16_t port, const ts::UString& path, ts::UString& status, ts::ByteBlock& body)
+    {
+        status.clear();
+        body.clear();
+        ts::TCPConnection session;
+        if (!session.open(CERR) || !session.connect(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, port), CERR)) {
+            return false;
+        }
+        const std::string request(ts::UString::Format(u"GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", {path}).toUTF8());
+        bool ok = session.send(request.data(), request.size(), CERR);
+
+        // Read the complete response, the server closes the connection.
+        std::string response;
+        char buffer[4096];
+        size_t size = 0;
+        while (ok && session.receive(buffer, sizeof(buffer), size, nullptr, NULLREP)) {
+            response.append(buffer, size);
+        }
+        session.close(NULLREP);
+
+        const size_t eol = response.find("\r\n");
+        const size_t eoh = response.find("\r\n\r\n");
+        if (!ok || eol == std::string::npos || eoh == std::string::npos) {
+            return false;
+        }
+        status.assignFromUTF8(response.substr(0, eol));
+        body.copy(response.data() + eoh + 4, response.size() - eoh - 4);
+        return true;
+    }
+}
+
+void HLSTest::testSegmentStore()
+{
+    const uint16_t portNumber = 12347;
+
+    TSUNIT_EQUAL(u"application/vnd.apple.mpegurl", ts::hls::SegmentStore::MimeType(u"foo.m3u8"));
+    TSUNIT_EQUAL(u"video/mp2t", ts::hls::SegmentStore::MimeType(u"foo-000012.ts"));
+
+    ts::hls::SegmentStore store;
+    TSUNIT_EQUAL(0, store.fileCount());
+    store.store(u"a.ts", ts::ByteBlockPtrMT(new ts::ByteBlock(3 * ts::PKT_SIZE, 0x47)));
+    store.store(u"pl.m3u8", ts::ByteBlockPtrMT(new ts::ByteBlock("#EXTM3U\n")));
+    TSUNIT_EQUAL(2, store.fileCount());
+    TSUNIT_ASSERT(!store.get(u"a.ts").isNull());
+    TSUNIT_EQUAL(3 * ts::PKT_SIZE, store.get(u"a.ts")->size());
+    TSUNIT_ASSERT(store.get(u"b.ts").isNull());
+
+    TSUNIT_ASSERT(ts::IPInitialize());
+    TSUNIT_ASSERT(store.startServer(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, portNumber), CERR));
+
+    ts::UString status;
+    ts::ByteBlock body;
+    TSUNIT_ASSERT(HTTPGet(portNumber, u"/pl.m3u8", status, body));
+    TSUNIT_EQUAL(u"HTTP/1.1 200 OK", status);
+    TSUNIT_EQUAL(8, body.size());
+    TSUNIT_EQUAL(0, ::memcmp(body.data(), "#EXTM3U\n", 8));
+
+    TSUNIT_ASSERT(HTTPGet(portNumber, u"/a.ts?foo=bar", status, body));
+    TSUNIT_EQUAL(u"HTTP/1.1 200 OK", status);
+    TSUNIT_ASSERT(body == ts::ByteBlock(3 * ts::PKT_SIZE, 0x47));
+
+    TSUNIT_ASSERT(store.remove(u"a.ts"));
+    TSUNIT_ASSERT(!store.remove(u"a.ts"));
+    TSUNIT_ASSERT(HTTPGet(portNumber, u"/a.ts", status, body));
+    TSUNIT_EQUAL(u"HTTP/1.1 404 Not Found", status);
+    TSUNIT_EQUAL(0, body.size());
+
+    store.stopServer();
+    TSUNIT_EQUAL(1, store.fileCount());
+}
+
+// Run a tsp session with 2050 null packets and the hls output plugin, segments of 100 packets.
+namespace {
+    void RunHLSOutput(const ts::UString& dir, const ts::UStringVector& options)
+    {
+        ts::TSProcessorArgs opt;
+        opt.app_name = u"HLSTest";
+        opt.input = {u"null", {u"2050"}};
+        opt.output = {u"hls", {dir + ts::PathSeparator + u"seg.ts", u"--fixed-segment-size", u"18800", u"--playlist", dir + ts::PathSeparator + u"pl.m3u8"}};
+        opt.output.args.insert(opt.output.args.end(), options.begin(), options.end());
+
+        ts::TSProcessor tsproc(CERR);
+        TSUNIT_ASSERT(tsproc.start(opt));
+        tsproc.waitForTermination();
+    }
+
+    void CleanupDirectory(const ts::UString& dir)
+    {
+        ts::UStringVector files;
+        ts::ExpandWildcard(files, dir + ts::PathSeparator + u"*");
+        for (const auto& name : files) {
+            ts::DeleteFile(name, NULLREP);
+        }
+        ts::DeleteFile(dir, NULLREP);
+    }
+}
+
+void HLSTest::testOutputAsync()
+{
+    const ts::UString syncDir(ts::TempFile(u".sync"));
+    const ts::UString asyncDir(ts::TempFile(u".async"));
+    const ts::UString liveDir(ts::TempFile(u".live"));
+    TSUNIT_ASSERT(ts::CreateDirectory(syncDir));
+    TSUNIT_ASSERT(ts::CreateDirectory(asyncDir));
+    TSUNIT_ASSERT(ts::CreateDirectory(liveDir));
+
+    // Same output, with and without background writer: 21 segments of 100 packets, the last one is shorter.
+    RunHLSOutput(syncDir, {});
+    RunHLSOutput(asyncDir, {u"--async-depth", u"2"});
+    RunHLSOutput(liveDir, {u"--async-depth", u"1", u"--live", u"3"});
+
+    ts::UStringVector syncFiles;
+    ts::UStringVector asyncFiles;
+    ts::UStringVector liveFiles;
+    ts::ExpandWildcard(syncFiles, syncDir + ts::PathSeparator + u"*");
+    ts::ExpandWildcard(asyncFiles, asyncDir + ts::PathSeparator + u"*");
+    ts::ExpandWildcard(liveFiles, liveDir + ts::PathSeparator + u"*");
+    std::sort(syncFiles.begin(), syncFiles.end());
+    std::sort(asyncFiles.begin(), asyncFiles.end());
+    debug() << "HLSTest::testOutputAsync: " << syncFiles.size() << " files, live: " << liveFiles.size() << " files" << std::endl;
+
+    TSUNIT_EQUAL(22, syncFiles.size());
+    TSUNIT_EQUAL(syncFiles.size(), asyncFiles.size());
+    for (size_t i = 0; i < syncFiles.size() && i < asyncFiles.size(); ++i) {
+        TSUNIT_EQUAL(ts::BaseName(syncFiles[i]), ts::BaseName(asyncFiles[i]));
+        ts::ByteBlock syncData;
+        ts::ByteBlock asyncData;
+        TSUNIT_ASSERT(syncData.loadFromFile(syncFiles[i]));
+        TSUNIT_ASSERT(asyncData.loadFromFile(asyncFiles[i]));
+        TSUNIT_ASSERT(syncData == asyncData);
+    }
+
+    // Live playlist with 3 segments, obsolete segment files are deleted.
+    TSUNIT_EQUAL(4, liveFiles.size());
+    ts::hls::PlayList pl;
+    TSUNIT_ASSERT(pl.loadFile(liveDir + ts::PathSeparator + u"pl.m3u8", true));
+    TSUNIT_EQUAL(3, pl.segmentCount());
+    TSUNIT_EQUAL(u"seg-000020.ts", pl.segment(2).relativeURI);
+
+    CleanupDirectory(syncDir);
+    CleanupDirectory(asyncDir);
+    CleanupDirectory(liveDir);
+}
+
+// A packet processor plugin which slows down the stream: one pause of 50 ms every 100 packets.
+// Without it, the null input is so fast that live segments are purged before the test can get them.
+namespace {
+    class ThrottlePlugin : public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(ThrottlePlugin);
+    public:
+        ThrottlePlugin(ts::TSP* t) : ts::ProcessorPlugin(t, u"Test throttle plugin", u"[options]"), _count(0) {}
+        virtual Status processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata& pkt_data) override
+        {
+            if (++_count % 100 == 0) {
+                ts::SleepThread(50);
+            }
+            return TSP_OK;
+        }
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new ThrottlePlugin(t); }
+    private:
+        size_t _count;
+    };
+
+    // Abort a TS processor when leaving a test, even on assertion failure.
+    class TSProcessorAborter
+    {
+        TS_NOBUILD_NOCOPY(TSProcessorAborter);
+    public:
+        TSProcessorAborter(ts::TSProcessor& tsproc) : _tsproc(tsproc) {}
+        ~TSProcessorAborter()
+        {
+            _tsproc.abort();
+            _tsproc.waitForTermination();
+        }
+    private:
+        ts::TSProcessor& _tsproc;
+    };
+}
+
+void HLSTest::testOutputHTTP()
+{
+    const uint16_t portNumber = 12348;
+    TSUNIT_ASSERT(ts::IPInitialize());
+    ts::PluginRepository::Instance()->registerProcessor(u"test_throttle", ThrottlePlugin::CreateInstance);
+
+    // Endless stream of null packets, segments of 100 packets, served from memory.
+    ts::TSProcessorArgs opt;
+    opt.app_name = u"HLSTest";
+    opt.input = {u"null", {}};
+    opt.plugins = {{u"test_throttle", {}}};
+    opt.output = {u"hls", {u"nowhere/seg.ts", u"--fixed-segment-size", u"18800", u"--playlist", u"nowhere/pl.m3u8",
+                           u"--live", u"3", u"--async-depth", u"2", u"--http-server", ts::UString::Format(u"127.0.0.1:%d", {portNumber})}};
+
+    ts::TSProcessor tsproc(CERR);
+    TSUNIT_ASSERT(tsproc.start(opt));
+    TSProcessorAborter aborter(tsproc);
+
+    // Wait for the playlist to be published.
+    ts::UString status;
+    ts::ByteBlock body;
+    ts::hls::PlayList pl;
+    for (int retry = 0; retry < 50 && pl.segmentCount() < 3; ++retry) {
+        ts::SleepThread(100);
+        if (HTTPGet(portNumber, u"/pl.m3u8", status, body) && status == u"HTTP/1.1 200 OK") {
+            pl.clear();
+            pl.loadText(ts::UString::FromUTF8(reinterpret_cast<const char*>(body.data()), body.size()), true);
+        }
+    }
+    TSUNIT_EQUAL(3, pl.segmentCount());
+    TSUNIT_ASSERT(pl.isUpdatable());
+
+    // Get the last segment of the playlist.
+    const ts::UString segName(pl.segment(2).relativeURI);
+    debug() << "HLSTest::testOutputHTTP: last segment: " << segName << std::endl;
+    TSUNIT_ASSERT(segName.startWith(u"seg-"));
+    TSUNIT_ASSERT(HTTPGet(portNumber, u"/" + segName, status, body));
+    TSUNIT_EQUAL(u"HTTP/1.1 200 OK", status);
+    TSUNIT_EQUAL(100 * ts::PKT_SIZE, body.size());
+    TSUNIT_EQUAL(ts::SYNC_BYTE, body[0]);
+    TSUNIT_EQUAL(ts::PID_NULL, ts::GetUInt16(body.data() + 1) & 0x1FFF);
+
+    // Nothing was written on disk.
+    TSUNIT_ASSERT(!ts::FileExists(u"nowhere"));
+}
@@ -0,0 +1,205 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::InputSwitcher
+//
+//----------------------------------------------------------------------------
+
+#include "tsInputSwitcher.h"
+#include "tsPluginRepository.h"
+#include "tsInputPlugin.h"
+#include "tsOutputPlugin.h"
+#include "tsCerrReport.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class InputSwitcherTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testCleanSwitch();
+
+    TSUNIT_TEST_BEGIN(InputSwitcherTest);
+    TSUNIT_TEST(testCleanSwitch);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(InputSwitcherTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void InputSwitcherTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void InputSwitcherTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Internal input and output plugins.
+//----------------------------------------------------------------------------
+
+namespace {
+    // One packet out of BOUNDARY_INTERVAL is a clean switch boundary (PCR and random access point).
+    constexpr size_t BOUNDARY_INTERVAL = 10;
+
+    // Input plugin: endless stream of packets on one PID, with continuous CC, slowly received.
+    class InputPlugin : public ts::InputPlugin
+    {
+        TS_NOBUILD_NOCOPY(InputPlugin);
+    public:
+        InputPlugin(ts::TSP* t) :
+            ts::InputPlugin(t, u"Test input plugin", u"[options]"),
+            _pid(ts::PID_NULL),
+            _packets(0)
+        {
+            option(u"pid", 0, PIDVAL);
+        }
+
+        virtual bool getOptions() override
+        {
+            getIntValue(_pid, u"pid", ts::PID(0x100));
+            return true;
+        }
+
+        virtual bool start() override
+        {
+            _packets = 0;
+            return true;
+        }
+
+        virtual size_t receive(ts::TSPacket* buffer, ts::TSPacketMetadata* pkt_data, size_t max_packets) override
+        {
+            // Not a multiple of BOUNDARY_INTERVAL, boundaries are found anywhere in the receive area.
+            ts::SleepThread(1);
+            max_packets = std::min<size_t>(max_packets, 7);
+            for (size_t i = 0; i < max_packets; ++i) {
+                buffer[i].init(_pid, uint8_t(_packets & ts::CC_MASK));
+                if (_packets % BOUNDARY_INTERVAL == 0) {
+                    buffer[i].setPUSI();
+                    buffer[i].setRandomAccessIndicator(true);
+                    buffer[i].setPCR(_packets * 1000, true);
+                }
+                _packets++;
+            }
+            return max_packets;
+        }
+
+        static ts::InputPlugin* CreateInstance(ts::TSP* t) { return new InputPlugin(t); }
+
+    private:
+        ts::PID           _pid;      // PID of all generated packets.
+        ts::PacketCounter _packets;  // Number of generated packets.
+    };
+
+    // Results of the output plugin, checked after the termination of the switcher.
+    ts::PID           output_last_pid = ts::PID_NULL;
+    ts::PacketCounter output_switches = 0;
+    ts::PacketCounter output_clean_switches = 0;
+
+    // Output plugin: check the first packet after each PID change.
+    class OutputPlugin : public ts::OutputPlugin
+    {
+        TS_NOBUILD_NOCOPY(OutputPlugin);
+    public:
+        OutputPlugin(ts::TSP* t) : ts::OutputPlugin(t, u"Test output plugin", u"[options]") {}
+        virtual bool send(const ts::TSPacket* buffer, const ts::TSPacketMetadata* pkt_data, size_t packet_count) override
+        {
+            for (size_t i = 0; i < packet_count; ++i) {
+                const ts::PID pid = buffer[i].getPID();
+                if (output_last_pid != ts::PID_NULL && pid != output_last_pid) {
+                    output_switches++;
+                    if (buffer[i].hasPCR() && buffer[i].getRandomAccessIndicator()) {
+                        output_clean_switches++;
+                    }
+                }
+                output_last_pid = pid;
+            }
+            return true;
+        }
+        static ts::OutputPlugin* CreateInstance(ts::TSP* t) { return new OutputPlugin(t); }
+    };
+
+    void RegisterPlugins()
+    {
+        ts::PluginRepository::Instance()->registerInput(u"test_switch_input", InputPlugin::CreateInstance);
+        ts::PluginRepository::Instance()->registerOutput(u"test_switch_output", OutputPlugin::CreateInstance);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Fast switch on clean boundaries of the standby input.
+//----------------------------------------------------------------------------
+
+void InputSwitcherTest::testCleanSwitch()
+{
+    RegisterPlugins();
+    output_last_pid = ts::PID_NULL;
+    output_switches = output_clean_switches = 0;
+
+    ts::InputSwitcherArgs opt;
+    opt.appName = u"InputSwitcherTest";
+    opt.fastSwitch = true;
+    opt.cleanSwitch = true;
+    opt.inputs.push_back(ts::PluginOptions(u"test_switch_input", {u"--pid", u"0x100"}));
+    opt.inputs.push_back(ts::PluginOptions(u"test_switch_input", {u"--pid", u"0x200"}));
+    opt.output.set(u"test_switch_output");
+    opt.bufferedPackets = ts::InputSwitcherArgs::DEFAULT_BUFFERED_PACKETS;
+    opt.maxInputPackets = ts::InputSwitcherArgs::DEFAULT_MAX_INPUT_PACKETS;
+    opt.maxOutputPackets = ts::InputSwitcherArgs::DEFAULT_MAX_OUTPUT_PACKETS;
+    opt.enforceDefaults();
+
+    ts::InputSwitcher switcher(CERR);
+    TSUNIT_ASSERT(switcher.start(opt));
+    ts::SleepThread(200);
+    switcher.setInput(1);
+    ts::SleepThread(200);
+    switcher.setInput(0);
+    ts::SleepThread(200);
+    switcher.stop();
+    switcher.waitForTermination();
+
+    debug() << "InputSwitcherTest::testCleanSwitch: switches: " << output_switches << ", clean: " << output_clean_switches << std::endl;
+    TSUNIT_EQUAL(2, output_switches);
+    TSUNIT_EQUAL(2, output_clean_switches);
+}
@@ -0,0 +1,290 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for classes ts::MemoryPool and ts::PoolAllocated
+//
+//----------------------------------------------------------------------------
+
+#include "tsMemoryPool.h"
+#include "tsPoolAllocated.h"
+#include "tsSection.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+#include "utestTSUnitThread.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class MemoryPoolTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testAllocate();
+    void testPoolAllocated();
+    void testThreads();
+    void testSections();
+    void testThroughput();
+
+    TSUNIT_TEST_BEGIN(MemoryPoolTest);
+    TSUNIT_TEST(testAllocate);
+    TSUNIT_TEST(testPoolAllocated);
+    TSUNIT_TEST(testThreads);
+    TSUNIT_TEST(testSections);
+    TSUNIT_TEST(testThroughput);
+    TSUNIT_TEST_END();
+
+private:
+    // Allocate and deallocate objects, return the number of allocations per second.
+    template <class T>
+    static double allocationThroughput();
+
+    // Display the statistics of the memory pool.
+    static void displayStatistics(const char* title, const ts::MemoryPool::Statistics& stats);
+};
+
+TSUNIT_REGISTER(MemoryPoolTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void MemoryPoolTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void MemoryPoolTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Helpers.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Objects of the same size, in the heap and in the memory pool.
+    class HeapObject
+    {
+    public:
+        uint8_t data[48];
+    };
+    class PoolObject: public ts::PoolAllocated
+    {
+    public:
+        uint8_t data[48];
+    };
+}
+
+void MemoryPoolTest::displayStatistics(const char* title, const ts::MemoryPool::Statistics& stats)
+{
+    debug() << "MemoryPoolTest: " << title << ": allocations: " << stats.allocations
+            << ", deallocations: " << stats.deallocations
+            << ", heap allocations: " << stats.heap_allocations
+            << ", depot transfers: " << stats.depot_transfers
+            << ", slab bytes: " << stats.slab_bytes << std::endl;
+}
+
+template <class T>
+double MemoryPoolTest::allocationThroughput()
+{
+    // Allocate and deallocate objects in groups, like sections in a demux.
+    constexpr size_t group_size = 100;
+    constexpr size_t group_count = 20000;
+    T* objects[group_size];
+
+    const ts::Monotonic start(true);
+    for (size_t group = 0; group < group_count; ++group) {
+        for (size_t i = 0; i < group_size; ++i) {
+            objects[i] = new T;
+            objects[i]->data[0] = uint8_t(i);
+        }
+        for (size_t i = 0; i < group_size; ++i) {
+            delete objects[i];
+        }
+    }
+    const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+
+    return (double(group_size * group_count) * ts::NanoSecPerSec) / double(duration);
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void MemoryPoolTest::testAllocate()
+{
+    const ts::MemoryPool::Statistics before(ts::MemoryPool::GetStatistics());
+
+    // Allocate blocks of all sizes, inside and outside the pool.
+    std::vector<void*> blocks;
+    for (size_t size = 1; size <= ts::MemoryPool::MAX_BLOCK_SIZE + 100; ++size) {
+        void* ptr = ts::MemoryPool::Allocate(size);
+        TSUNIT_ASSERT(ptr != nullptr);
+        TSUNIT_EQUAL(0, reinterpret_cast<uintptr_t>(ptr) % 8);
+        ::memset(ptr, int(size & 0xFF), size);
+        blocks.push_back(ptr);
+    }
+
+    // Check that blocks were not overwritten by others.
+    for (size_t size = 1; size <= blocks.size(); ++size) {
+        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(blocks[size - 1]);
+        TSUNIT_EQUAL(size & 0xFF, ptr[0]);
+        TSUNIT_EQUAL(size & 0xFF, ptr[size - 1]);
+    }
+    for (size_t size = 1; size <= blocks.size(); ++size) {
+        ts::MemoryPool::Deallocate(blocks[size - 1], size);
+    }
+    ts::MemoryPool::Deallocate(nullptr, 10);
+
+    const ts::MemoryPool::Statistics after(ts::MemoryPool::GetStatistics());
+    displayStatistics("testAllocate", after);
+
+#if !defined(TS_NO_MEMORY_POOL)
+    TSUNIT_ASSERT(after.allocations >= before.allocations + ts::MemoryPool::MAX_BLOCK_SIZE);
+    TSUNIT_ASSERT(after.deallocations >= before.deallocations + ts::MemoryPool::MAX_BLOCK_SIZE);
+    TSUNIT_ASSERT(after.heap_allocations >= before.heap_allocations + 100);
+    TSUNIT_ASSERT(after.slab_bytes > 0);
+#endif
+}
+
+void MemoryPoolTest::testPoolAllocated()
+{
+    // The memory layout is not modified.
+    TSUNIT_EQUAL(sizeof(HeapObject), sizeof(PoolObject));
+
+    const ts::MemoryPool::Statistics before(ts::MemoryPool::GetStatistics());
+    PoolObject* obj = new PoolObject;
+    obj->data[47] = 0x47;
+    const ts::MemoryPool::Statistics middle(ts::MemoryPool::GetStatistics());
+    delete obj;
+    const ts::MemoryPool::Statistics after(ts::MemoryPool::GetStatistics());
+
+#if !defined(TS_NO_MEMORY_POOL)
+    TSUNIT_EQUAL(before.allocations + 1, middle.allocations);
+    TSUNIT_EQUAL(middle.deallocations + 1, after.deallocations);
+#endif
+
+    // Arrays use the heap.
+    PoolObject* array = new PoolObject[10];
+    array[9].data[0] = 0;
+    delete[] array;
+    TSUNIT_EQUAL(after.allocations, ts::MemoryPool::GetStatistics().allocations);
+}
+
+// Thread for testThreads(): deallocate objects which were allocated in the main thread.
+namespace {
+    class MemoryPoolTestThread: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(MemoryPoolTestThread);
+    private:
+        std::vector<PoolObject*>& _objects;
+    public:
+        explicit MemoryPoolTestThread(std::vector<PoolObject*>& objects) :
+            utest::TSUnitThread(),
+            _objects(objects)
+        {
+        }
+
+        virtual ~MemoryPoolTestThread() override
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            for (size_t i = 0; i < _objects.size(); ++i) {
+                TSUNIT_EQUAL(i & 0xFF, _objects[i]->data[0]);
+                delete _objects[i];
+                // Reuse the blocks in this thread.
+                _objects[i] = new PoolObject;
+                _objects[i]->data[0] = uint8_t(i + 1);
+            }
+        }
+    };
+}
+
+void MemoryPoolTest::testThreads()
+{
+    std::vector<PoolObject*> objects(1000);
+    for (size_t i = 0; i < objects.size(); ++i) {
+        objects[i] = new PoolObject;
+        objects[i]->data[0] = uint8_t(i);
+    }
+    {
+        MemoryPoolTestThread thread(objects);
+        TSUNIT_ASSERT(thread.start());
+    }
+    // The thread is terminated, its cache returned to the depot.
+    for (size_t i = 0; i < objects.size(); ++i) {
+        TSUNIT_EQUAL((i + 1) & 0xFF, objects[i]->data[0]);
+        delete objects[i];
+    }
+    displayStatistics("testThreads", ts::MemoryPool::GetStatistics());
+}
+
+void MemoryPoolTest::testSections()
+{
+    const ts::MemoryPool::Statistics before(ts::MemoryPool::GetStatistics());
+
+    // Each section allocates the section object, its byte block and two safe pointer control blocks.
+    for (size_t i = 0; i < 1000; ++i) {
+        ts::SectionPtr section(new ts::Section(ts::TID_PAT, false, uint16_t(i), 0, true, 0, 0, nullptr, 0, ts::PID_PAT));
+        TSUNIT_ASSERT(section->isValid());
+    }
+
+    const ts::MemoryPool::Statistics after(ts::MemoryPool::GetStatistics());
+    displayStatistics("testSections", after);
+
+#if !defined(TS_NO_MEMORY_POOL)
+    TSUNIT_ASSERT(after.allocations >= before.allocations + 4000);
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: allocations per second in the heap and in the memory pool.
+//----------------------------------------------------------------------------
+
+void MemoryPoolTest::testThroughput()
+{
+    if (debugMode()) {
+        const double heap = allocationThroughput<HeapObject>();
+        const double pool = allocationThroughput<PoolObject>();
+        debug() << "MemoryPoolTest: allocations per second, heap: " << ts::UString::Decimal(int64_t(heap))
+                << ", memory pool: " << ts::UString::Decimal(int64_t(pool)) << std::endl;
+    }
+}
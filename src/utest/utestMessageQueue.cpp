@@ -33,6 +33,8 @@
 
 #include "tsMessageQueue.h"
 #include "tsMessagePriorityQueue.h"
+#include "tsLockFreeMessageQueue.h"
+#include "tsLockFreeMessagePriorityQueue.h"
 #include "tsMonotonic.h"
 #include "tsSysUtils.h"
 #include "tsunit.h"
@@ -54,15 +56,32 @@ public:
     void testConstructor();
     void testQueue();
     void testPriorityQueue();
+    void testLockFreeConstructor();
+    void testLockFreeQueue();
+    void testLockFreePriorityQueue();
+    void testLockFreeOverflow();
+    void testContention();
 
     TSUNIT_TEST_BEGIN(MessageQueueTest);
     TSUNIT_TEST(testConstructor);
     TSUNIT_TEST(testQueue);
     TSUNIT_TEST(testPriorityQueue);
+    TSUNIT_TEST(testLockFreeConstructor);
+    TSUNIT_TEST(testLockFreeQueue);
+    TSUNIT_TEST(testLockFreePriorityQueue);
+    TSUNIT_TEST(testLockFreeOverflow);
+    TSUNIT_TEST(testContention);
     TSUNIT_TEST_END();
 private:
     ts::NanoSecond  _nsPrecision;
     ts::MilliSecond _msPrecision;
+
+    // Common tests for all types of queues.
+    template <class QUEUE> void queueTest();
+    template <class QUEUE> void priorityQueueTest();
+
+    // Send messages from several producer threads to one consumer, return the number of messages per second.
+    template <class QUEUE> static double contention(size_t producer_count, size_t message_count);
 };
 
 TSUNIT_REGISTER(MessageQueueTest);
@@ -100,6 +119,7 @@ void MessageQueueTest::afterTest()
 //----------------------------------------------------------------------------
 
 typedef ts::MessageQueue<int> TestQueue;
+typedef ts::LockFreeMessageQueue<int> TestLockFreeQueue;
 
 // Test case: Constructor
 void MessageQueueTest::testConstructor()
@@ -116,12 +136,13 @@ void MessageQueueTest::testConstructor()
 
 // Thread for testQueue()
 namespace {
+    template <class QUEUE>
     class MessageQueueTestThread: public utest::TSUnitThread
     {
     private:
-        TestQueue& _queue;
+        QUEUE& _queue;
     public:
-        explicit MessageQueueTestThread(TestQueue& queue) :
+        explicit MessageQueueTestThread(QUEUE& queue) :
             utest::TSUnitThread(),
             _queue(queue)
         {
@@ -141,7 +162,7 @@ namespace {
 
             // Read messages. Expect consecutive values until negative value.
             int expected = 0;
-            TestQueue::MessagePtr message;
+            typename QUEUE::MessagePtr message;
             do {
                 TSUNIT_ASSERT(_queue.dequeue(message, 10000));
                 TSUNIT_ASSERT(!message.isNull());
@@ -161,8 +182,14 @@ namespace {
 
 void MessageQueueTest::testQueue()
 {
-    TestQueue queue(10);
-    MessageQueueTestThread thread(queue);
+    queueTest<TestQueue>();
+}
+
+template <class QUEUE>
+void MessageQueueTest::queueTest()
+{
+    QUEUE queue(10);
+    MessageQueueTestThread<QUEUE> thread(queue);
     int message = 0;
 
     debug() << "MessageQueueTest: main thread: starting test" << std::endl;
@@ -202,18 +229,27 @@ void MessageQueueTest::testQueue()
     debug() << "MessageQueueTest: main thread: end of test" << std::endl;
 }
 
-void MessageQueueTest::testPriorityQueue()
-{
-    struct Message
+namespace {
+    struct PriorityMessage
     {
         int a;
         int b;
-        Message(int a1 = 0, int b1 = 0) : a(a1), b(b1) {}
-        bool operator<(const Message& other) const { return a < other.a; }
+        PriorityMessage(int a1 = 0, int b1 = 0) : a(a1), b(b1) {}
+        bool operator<(const PriorityMessage& other) const { return a < other.a; }
     };
+}
 
-    ts::MessagePriorityQueue<Message> queue;
-    ts::MessagePriorityQueue<Message>::MessagePtr msg;
+void MessageQueueTest::testPriorityQueue()
+{
+    priorityQueueTest<ts::MessagePriorityQueue<PriorityMessage>>();
+}
+
+template <class QUEUE>
+void MessageQueueTest::priorityQueueTest()
+{
+    typedef PriorityMessage Message;
+    QUEUE queue;
+    typename QUEUE::MessagePtr msg;
 
     TSUNIT_ASSERT(queue.enqueue(new Message(1, 1), 0));
     TSUNIT_ASSERT(queue.enqueue(new Message(5, 2), 0));
@@ -271,3 +307,177 @@ void MessageQueueTest::testPriorityQueue()
 
     TSUNIT_ASSERT(!queue.dequeue(msg, 0));
 }
+
+// Test case: Constructor of lock-free queues
+void MessageQueueTest::testLockFreeConstructor()
+{
+    TestLockFreeQueue queue1;
+    TestLockFreeQueue queue2(10);
+    TestLockFreeQueue queue3(0);
+
+    TSUNIT_EQUAL(TestLockFreeQueue::DEFAULT_MAX_MESSAGES, queue1.getMaxMessages());
+    TSUNIT_EQUAL(10, queue2.getMaxMessages());
+    TSUNIT_EQUAL(TestLockFreeQueue::DEFAULT_MAX_MESSAGES, queue3.getMaxMessages());
+}
+
+void MessageQueueTest::testLockFreeQueue()
+{
+    queueTest<TestLockFreeQueue>();
+}
+
+void MessageQueueTest::testLockFreePriorityQueue()
+{
+    priorityQueueTest<ts::LockFreeMessagePriorityQueue<PriorityMessage>>();
+}
+
+// Test case: forced messages in a full lock-free queue
+void MessageQueueTest::testLockFreeOverflow()
+{
+    TestLockFreeQueue queue(4);
+    TestLockFreeQueue::MessagePtr msg;
+
+    // Fill the queue, then force two more messages.
+    for (int i = 0; i < 4; ++i) {
+        TSUNIT_ASSERT(queue.enqueue(new int(i), 0));
+    }
+    TSUNIT_ASSERT(!queue.enqueue(new int(100), 0));
+    queue.forceEnqueue(new int(4));
+    queue.forceEnqueue(new int(5));
+
+    // Peek does not remove the message.
+    msg = queue.peek();
+    TSUNIT_ASSERT(!msg.isNull());
+    TSUNIT_EQUAL(0, *msg);
+
+    // Forced messages come after the messages which were already in the queue.
+    for (int i = 0; i < 4; ++i) {
+        TSUNIT_ASSERT(queue.dequeue(msg, 0));
+        TSUNIT_ASSERT(!msg.isNull());
+        TSUNIT_EQUAL(i, *msg);
+    }
+
+    // The queue remains full until the forced messages are dequeued.
+    TSUNIT_ASSERT(!queue.enqueue(new int(100), 0));
+    TSUNIT_ASSERT(queue.dequeue(msg, 0));
+    TSUNIT_EQUAL(4, *msg);
+    TSUNIT_ASSERT(!queue.enqueue(new int(100), 0));
+    queue.forceEnqueue(new int(6));
+    for (int i = 5; i < 7; ++i) {
+        TSUNIT_ASSERT(queue.dequeue(msg, 0));
+        TSUNIT_ASSERT(!msg.isNull());
+        TSUNIT_EQUAL(i, *msg);
+    }
+    TSUNIT_ASSERT(!queue.dequeue(msg, 0));
+    TSUNIT_ASSERT(queue.peek().isNull());
+
+    // Fill the queue several rounds in the circular buffer.
+    for (int i = 0; i < 10; ++i) {
+        TSUNIT_ASSERT(queue.enqueue(new int(i), 0));
+        TSUNIT_ASSERT(queue.enqueue(new int(i + 100), 0));
+        TSUNIT_ASSERT(queue.dequeue(msg, 0));
+        TSUNIT_EQUAL(i, *msg);
+        TSUNIT_ASSERT(queue.dequeue(msg, 0));
+        TSUNIT_EQUAL(i + 100, *msg);
+    }
+
+    // Clear a full queue.
+    for (int i = 0; i < 4; ++i) {
+        TSUNIT_ASSERT(queue.enqueue(new int(i), 0));
+    }
+    queue.forceEnqueue(new int(4));
+    queue.clear();
+    TSUNIT_ASSERT(!queue.dequeue(msg, 0));
+    TSUNIT_ASSERT(queue.enqueue(new int(10), 0));
+    TSUNIT_ASSERT(queue.dequeue(msg, 0));
+    TSUNIT_EQUAL(10, *msg);
+}
+
+
+//----------------------------------------------------------------------------
+// Contention: several producers, one consumer.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Message from a producer thread.
+    struct ProducerMessage
+    {
+        size_t producer;
+        size_t sequence;
+        ProducerMessage(size_t p, size_t s) : producer(p), sequence(s) {}
+    };
+
+    // Producer thread.
+    template <class QUEUE>
+    class ProducerThread: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(ProducerThread);
+    private:
+        QUEUE& _queue;
+        size_t _producer;
+        size_t _message_count;
+    public:
+        ProducerThread(QUEUE& queue, size_t producer, size_t message_count) :
+            utest::TSUnitThread(),
+            _queue(queue),
+            _producer(producer),
+            _message_count(message_count)
+        {
+        }
+
+        virtual ~ProducerThread() override
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            for (size_t i = 0; i < _message_count; ++i) {
+                TSUNIT_ASSERT(_queue.enqueue(new ProducerMessage(_producer, i), 10000));
+            }
+        }
+    };
+}
+
+template <class QUEUE>
+double MessageQueueTest::contention(size_t producer_count, size_t message_count)
+{
+    QUEUE queue(256);
+    std::vector<ProducerThread<QUEUE>*> threads(producer_count);
+    std::vector<size_t> expected(producer_count, 0);
+
+    const ts::Monotonic start(true);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i] = new ProducerThread<QUEUE>(queue, i, message_count);
+        TSUNIT_ASSERT(threads[i]->start());
+    }
+
+    // Messages from each producer are received in order.
+    typename QUEUE::MessagePtr msg;
+    for (size_t count = 0; count < producer_count * message_count; ++count) {
+        TSUNIT_ASSERT(queue.dequeue(msg, 10000));
+        TSUNIT_ASSERT(!msg.isNull());
+        TSUNIT_ASSERT(msg->producer < producer_count);
+        TSUNIT_EQUAL(expected[msg->producer], msg->sequence);
+        expected[msg->producer]++;
+    }
+    TSUNIT_ASSERT(!queue.dequeue(msg, 0));
+
+    for (size_t i = 0; i < threads.size(); ++i) {
+        delete threads[i];
+    }
+    const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+    return (double(producer_count * message_count) * ts::NanoSecPerSec) / double(duration);
+}
+
+// Benchmark: mutex-based and lock-free queues with concurrent producers
+void MessageQueueTest::testContention()
+{
+    if (debugMode()) {
+        for (size_t producers = 1; producers <= 8; producers *= 2) {
+            const double locked = contention<ts::MessageQueue<ProducerMessage>>(producers, 100000 / producers);
+            const double lockfree = contention<ts::LockFreeMessageQueue<ProducerMessage>>(producers, 100000 / producers);
+            debug() << "MessageQueueTest: " << producers << " producers, messages per second, mutex: " << ts::UString::Decimal(int64_t(locked))
+                    << ", lock-free: " << ts::UString::Decimal(int64_t(lockfree)) << std::endl;
+        }
+    }
+}
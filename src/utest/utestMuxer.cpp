@@ -0,0 +1,429 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::Muxer
+//
+//----------------------------------------------------------------------------
+
+#include "tsMuxer.h"
+#include "tsPluginRepository.h"
+#include "tsInputPlugin.h"
+#include "tsOutputPlugin.h"
+#include "tsOneShotPacketizer.h"
+#include "tsSectionDemux.h"
+#include "tsPAT.h"
+#include "tsSDT.h"
+#include "tsEIT.h"
+#include "tsShortEventDescriptor.h"
+#include "tsMonotonic.h"
+#include "tsNullReport.h"
+#include "tsCerrReport.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class MuxerTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testMerge();
+    void testLossyInput();
+    void testMaxInputs();
+
+    TSUNIT_TEST_BEGIN(MuxerTest);
+    TSUNIT_TEST(testMerge);
+    TSUNIT_TEST(testLossyInput);
+    TSUNIT_TEST(testMaxInputs);
+    TSUNIT_TEST_END();
+
+private:
+    // Multiplex endless inputs during some time, return the ratio of output packets versus the target bitrate.
+    double outputRatio(size_t input_count, const ts::BitRate& bitrate, ts::MilliSecond duration);
+};
+
+TSUNIT_REGISTER(MuxerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void MuxerTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void MuxerTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Internal input and output plugins.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Each input stream contains one service with PAT, SDT, EIT p/f and data packets.
+    constexpr ts::PID DATA_PID_BASE = 0x1000;
+    constexpr size_t  CYCLE_PACKETS = 100;
+
+    // Total number of packets which were generated by all input plugins.
+    std::atomic<ts::PacketCounter> input_packets(0);
+
+    // Input plugin: repeat a cycle of packets for one service, endless or up to a number of packets.
+    class InputPlugin : public ts::InputPlugin
+    {
+        TS_NOBUILD_NOCOPY(InputPlugin);
+    public:
+        InputPlugin(ts::TSP* t) :
+            ts::InputPlugin(t, u"Test input plugin", u"[options]"),
+            _service_id(0),
+            _max_packets(0),
+            _burst(0),
+            _packets(0),
+            _cycle()
+        {
+            option(u"service", 0, UINT16);
+            option(u"packets", 0, UNSIGNED);
+            option(u"burst", 0, UNSIGNED);
+        }
+
+        virtual bool getOptions() override
+        {
+            getIntValue(_service_id, u"service", 1);
+            getIntValue(_max_packets, u"packets", 0);
+            getIntValue(_burst, u"burst", 0);
+            return true;
+        }
+
+        virtual bool start() override;
+        virtual size_t receive(ts::TSPacket* buffer, ts::TSPacketMetadata* pkt_data, size_t max_packets) override;
+        static ts::InputPlugin* CreateInstance(ts::TSP* t) { return new InputPlugin(t); }
+
+    private:
+        uint16_t           _service_id;   // Service id, also used as TS id.
+        ts::PacketCounter  _max_packets;  // Number of packets to generate, zero means endless.
+        size_t             _burst;        // Maximum number of packets per receive, with a pause of 1 ms, zero means unlimited.
+        ts::PacketCounter  _packets;      // Number of generated packets.
+        ts::TSPacketVector _cycle;        // Cycle of packets to repeat.
+    };
+
+    bool InputPlugin::start()
+    {
+        ts::PAT pat(0, true, _service_id);
+        pat.pmts[_service_id] = ts::PID(0x100 + (_service_id & 0xFF));
+
+        ts::SDT sdt(true, 0, true, _service_id, 1);
+        sdt.services[_service_id].setName(duck, ts::UString::Format(u"Service %d", {_service_id}));
+
+        ts::EIT eit(true, true, 0, 0, true, _service_id, _service_id, 1);
+        for (uint16_t ev = 0; ev < 2; ++ev) {
+            ts::EIT::Event& event(eit.events.newEntry());
+            event.event_id = ev;
+            event.start_time = ts::Time(2023, 1, 1, ev, 0);
+            event.duration = 60 * 60;
+            event.descs.add(duck, ts::ShortEventDescriptor(u"eng", ts::UString::Format(u"Event %d", {ev}), u"A typical event description in the EPG."));
+        }
+
+        ts::OneShotPacketizer pat_pzer(duck, ts::PID_PAT);
+        ts::OneShotPacketizer sdt_pzer(duck, ts::PID_SDT);
+        ts::OneShotPacketizer eit_pzer(duck, ts::PID_EIT);
+        pat_pzer.addTable(duck, pat);
+        sdt_pzer.addTable(duck, sdt);
+        eit_pzer.addTable(duck, eit);
+
+        ts::TSPacketVector packets;
+        _cycle.clear();
+        pat_pzer.getPackets(packets);
+        _cycle.insert(_cycle.end(), packets.begin(), packets.end());
+        sdt_pzer.getPackets(packets);
+        _cycle.insert(_cycle.end(), packets.begin(), packets.end());
+        eit_pzer.getPackets(packets);
+        _cycle.insert(_cycle.end(), packets.begin(), packets.end());
+
+        // Complete the cycle with data packets.
+        const size_t psi_count = _cycle.size();
+        _cycle.resize(CYCLE_PACKETS);
+        for (size_t i = psi_count; i < CYCLE_PACKETS; ++i) {
+            _cycle[i].init(ts::PID(DATA_PID_BASE + _service_id), uint8_t(i & 0x0F));
+        }
+        _packets = 0;
+        return true;
+    }
+
+    size_t InputPlugin::receive(ts::TSPacket* buffer, ts::TSPacketMetadata* pkt_data, size_t max_packets)
+    {
+        if (_burst > 0) {
+            ts::SleepThread(1);
+            max_packets = std::min(max_packets, _burst);
+        }
+        if (_max_packets > 0) {
+            max_packets = size_t(std::min<ts::PacketCounter>(max_packets, _max_packets - _packets));
+        }
+        for (size_t i = 0; i < max_packets; ++i) {
+            buffer[i] = _cycle[(_packets++) % CYCLE_PACKETS];
+        }
+        input_packets += max_packets;
+        return max_packets;
+    }
+
+    // Results of the output plugin, checked after the termination of the muxer.
+    class OutputResults : private ts::TableHandlerInterface
+    {
+        TS_NOCOPY(OutputResults);
+    public:
+        std::atomic<ts::PacketCounter> packets;
+        std::map<ts::PID, size_t>      pid_packets;
+        ts::PAT                        pat;
+        ts::SDT                        sdt;
+        size_t                         eit_count;
+        uint16_t                       eit_ts_id;
+
+        OutputResults() : packets(0), pid_packets(), pat(), sdt(), eit_count(0), eit_ts_id(0), _duck(), _demux(_duck, this) {}
+
+        void reset(bool analyze)
+        {
+            packets = 0;
+            pid_packets.clear();
+            pat.invalidate();
+            sdt.invalidate();
+            eit_count = 0;
+            eit_ts_id = 0;
+            _demux.reset();
+            if (analyze) {
+                _demux.setPIDFilter(ts::NoPID);
+                _demux.addPID(ts::PID_PAT);
+                _demux.addPID(ts::PID_SDT);
+                _demux.addPID(ts::PID_EIT);
+            }
+        }
+
+        void analyze(const ts::TSPacket& pkt)
+        {
+            pid_packets[pkt.getPID()]++;
+            _demux.feedPacket(pkt);
+        }
+
+    private:
+        ts::DuckContext  _duck;
+        ts::SectionDemux _demux;
+
+        virtual void handleTable(ts::SectionDemux& demux, const ts::BinaryTable& table) override
+        {
+            switch (table.tableId()) {
+                case ts::TID_PAT:
+                    pat.deserialize(_duck, table);
+                    break;
+                case ts::TID_SDT_ACT:
+                    sdt.deserialize(_duck, table);
+                    break;
+                case ts::TID_EIT_PF_ACT:
+                    eit_count++;
+                    // The payload of an EIT section starts with the transport stream id.
+                    eit_ts_id = ts::GetUInt16(table.sectionAt(0)->payload());
+                    break;
+                default:
+                    break;
+            }
+        }
+    };
+
+    OutputResults output_results;
+    bool output_analyze = false;
+
+    // Output plugin: count the packets and optionally analyze them.
+    class OutputPlugin : public ts::OutputPlugin
+    {
+        TS_NOBUILD_NOCOPY(OutputPlugin);
+    public:
+        OutputPlugin(ts::TSP* t) : ts::OutputPlugin(t, u"Test output plugin", u"[options]") {}
+        virtual bool send(const ts::TSPacket* buffer, const ts::TSPacketMetadata* pkt_data, size_t packet_count) override
+        {
+            if (output_analyze) {
+                for (size_t i = 0; i < packet_count; ++i) {
+                    output_results.analyze(buffer[i]);
+                }
+            }
+            output_results.packets += packet_count;
+            return true;
+        }
+        static ts::OutputPlugin* CreateInstance(ts::TSP* t) { return new OutputPlugin(t); }
+    };
+
+    void RegisterPlugins()
+    {
+        ts::PluginRepository::Instance()->registerInput(u"test_service", InputPlugin::CreateInstance);
+        ts::PluginRepository::Instance()->registerOutput(u"test_output", OutputPlugin::CreateInstance);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Merge of PSI/SI from several inputs, as collected by the input threads.
+//----------------------------------------------------------------------------
+
+void MuxerTest::testMerge()
+{
+    RegisterPlugins();
+    output_analyze = true;
+    output_results.reset(true);
+
+    const size_t input_count = 3;
+    const size_t packet_count = 20 * CYCLE_PACKETS;
+
+    // Slow inputs, the output has free space for the EIT's.
+    ts::MuxerArgs opt;
+    opt.appName = u"MuxerTest";
+    for (size_t i = 1; i <= input_count; ++i) {
+        opt.inputs.push_back(ts::PluginOptions(u"test_service", {u"--service", ts::UString::Decimal(i, 0, true, u""), u"--packets", ts::UString::Decimal(packet_count, 0, true, u""), u"--burst", u"20"}));
+    }
+    opt.output.set(u"test_output");
+    opt.outputBitRate = 150000000;
+    opt.patBitRate = opt.sdtBitRate = 1000000;
+    opt.outputTSId = 100;
+    opt.outputNetwId = 1;
+    opt.inputOnce = true;
+    opt.enforceDefaults();
+
+    ts::Muxer mux(CERR);
+    TSUNIT_ASSERT(mux.start(opt));
+    mux.waitForTermination();
+    output_analyze = false;
+
+    debug() << "MuxerTest::testMerge: output packets: " << output_results.packets << ", EIT: " << output_results.eit_count << std::endl;
+
+    // Data packets from all inputs. The last packets in the output buffer are
+    // lost when the multiplexer terminates at the end of the inputs.
+    for (size_t i = 1; i <= input_count; ++i) {
+        const ts::PID pid = ts::PID(DATA_PID_BASE + i);
+        TSUNIT_ASSERT(output_results.pid_packets[pid] > 0);
+        TSUNIT_ASSERT(output_results.pid_packets[pid] < packet_count);
+    }
+
+    // Merged PAT and SDT.
+    TSUNIT_ASSERT(output_results.pat.isValid());
+    TSUNIT_EQUAL(100, output_results.pat.ts_id);
+    TSUNIT_EQUAL(input_count, output_results.pat.pmts.size());
+    TSUNIT_ASSERT(output_results.sdt.isValid());
+    TSUNIT_EQUAL(100, output_results.sdt.ts_id);
+    TSUNIT_EQUAL(input_count, output_results.sdt.services.size());
+    ts::DuckContext duck;
+    TSUNIT_EQUAL(u"Service 2", output_results.sdt.services[2].serviceName(duck));
+
+    // EIT's with patched TS id.
+    TSUNIT_ASSERT(output_results.eit_count > 0);
+    TSUNIT_EQUAL(100, output_results.eit_ts_id);
+}
+
+
+//----------------------------------------------------------------------------
+// A lossy input is never blocked by a slow output, the oldest packets are dropped.
+//----------------------------------------------------------------------------
+
+void MuxerTest::testLossyInput()
+{
+    RegisterPlugins();
+    output_results.reset(false);
+    input_packets = 0;
+
+    ts::MuxerArgs opt;
+    opt.appName = u"MuxerTest";
+    opt.inputs.push_back(ts::PluginOptions(u"test_service", {u"--burst", u"100"}));
+    opt.output.set(u"test_output");
+    opt.outputBitRate = 1000000;
+    opt.inBufferPackets = opt.outBufferPackets = 1000;
+    opt.lossyInput = true;
+    opt.enforceDefaults();
+
+    ts::Muxer mux(NULLREP);
+    TSUNIT_ASSERT(mux.start(opt));
+    ts::SleepThread(300);
+    mux.stop();
+    mux.waitForTermination();
+
+    debug() << "MuxerTest::testLossyInput: input packets: " << input_packets << ", output packets: " << output_results.packets << std::endl;
+
+    // The input continued to read packets after its buffer was full.
+    TSUNIT_ASSERT(input_packets > output_results.packets + opt.inBufferPackets + opt.outBufferPackets);
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: maximum number of inputs at a given output bitrate.
+//----------------------------------------------------------------------------
+
+double MuxerTest::outputRatio(size_t input_count, const ts::BitRate& bitrate, ts::MilliSecond duration)
+{
+    RegisterPlugins();
+    output_results.reset(false);
+
+    ts::MuxerArgs opt;
+    opt.appName = u"MuxerTest";
+    for (size_t i = 1; i <= input_count; ++i) {
+        opt.inputs.push_back(ts::PluginOptions(u"test_service", {u"--service", ts::UString::Decimal(i, 0, true, u"")}));
+    }
+    opt.output.set(u"test_output");
+    opt.outputBitRate = bitrate;
+    opt.enforceDefaults();
+
+    // Endless inputs always fill the output, late EIT's are dropped with a warning.
+    ts::Muxer mux(NULLREP);
+    const ts::Monotonic start(true);
+    TSUNIT_ASSERT(mux.start(opt));
+    ts::SleepThread(duration);
+    mux.stop();
+    const ts::NanoSecond elapsed = ts::Monotonic(true) - start;
+    mux.waitForTermination();
+
+    const double expected = (double(elapsed) * bitrate.toDouble()) / double(ts::NanoSecPerSec * ts::PKT_SIZE_BITS);
+    return double(output_results.packets) / expected;
+}
+
+void MuxerTest::testMaxInputs()
+{
+    if (debugMode()) {
+        const ts::BitRate bitrate(500000000);
+        size_t max_inputs = 0;
+
+        for (size_t count = 1; count <= 32; count *= 2) {
+            const double ratio = outputRatio(count, bitrate, 200);
+            debug() << "MuxerTest::testMaxInputs: " << count << " inputs at " << bitrate << " b/s, output: " << int(ratio * 100) << "% of target" << std::endl;
+            if (ratio >= 0.95) {
+                max_inputs = count;
+            }
+        }
+        debug() << "MuxerTest::testMaxInputs: max inputs at " << bitrate << " b/s: " << max_inputs << std::endl;
+    }
+}
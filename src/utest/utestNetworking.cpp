@@ -40,6 +40,10 @@
 #include "tsTCPConnection.h"
 #include "tsTCPServer.h"
 #include "tsUDPSocket.h"
+#include "tsUDPReceiver.h"
+#include "tsDuckContext.h"
+#include "tsArgs.h"
+#include "tsTime.h"
 #include "tsThread.h"
 #include "tsSysUtils.h"
 #include "tsIPUtils.h"
@@ -70,6 +74,8 @@ public:
     void testIPv6SocketAddress();
     void testTCPSocket();
     void testUDPSocket();
+    void testUDPBatch();
+    void testUDPOffload();
     void testIPHeader();
     void testIPProtocol();
     void testTCPPacket();
@@ -86,6 +92,8 @@ public:
     TSUNIT_TEST(testIPv6SocketAddress);
     TSUNIT_TEST(testTCPSocket);
     TSUNIT_TEST(testUDPSocket);
+    TSUNIT_TEST(testUDPBatch);
+    TSUNIT_TEST(testUDPOffload);
     TSUNIT_TEST(testIPHeader);
     TSUNIT_TEST(testIPProtocol);
     TSUNIT_TEST(testTCPPacket);
@@ -746,6 +754,163 @@ void NetworkingTest::testUDPSocket()
     CERR.debug(u"UDPSocketTest: main thread: reply sent");
 }
 
+void NetworkingTest::testUDPBatch()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t portNumber = 12346;
+    const size_t msgCount = 20;
+    const size_t msgSize = 100;
+
+    // Create receiver socket.
+    ts::UDPSocket receiver;
+    TSUNIT_ASSERT(receiver.open(CERR));
+    TSUNIT_ASSERT(receiver.reusePort(true, CERR));
+    TSUNIT_ASSERT(receiver.setReceiveTimestamps(true, CERR));
+    TSUNIT_ASSERT(receiver.setReceiveTimeout(5000, CERR));
+    TSUNIT_ASSERT(receiver.bind(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, portNumber), CERR));
+
+    // Create sender socket.
+    ts::UDPSocket sender;
+    TSUNIT_ASSERT(sender.open(CERR));
+    TSUNIT_ASSERT(sender.setDefaultDestination(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, portNumber), CERR));
+
+    // Send all messages in one batch. Each message is filled with its index.
+    ts::ByteBlock out(msgCount * msgSize);
+    std::vector<const void*> addresses(msgCount);
+    std::vector<size_t> sizes(msgCount);
+    for (size_t i = 0; i < msgCount; ++i) {
+        ::memset(&out[i * msgSize], int(i), msgSize);
+        addresses[i] = &out[i * msgSize];
+        sizes[i] = msgSize;
+    }
+    TSUNIT_ASSERT(sender.sendBatch(addresses.data(), sizes.data(), msgCount, CERR));
+
+    // Receive all messages, in as many batches as necessary.
+    ts::ByteBlock in(msgCount * 2 * msgSize);
+    std::vector<ts::UDPSocket::ReceiveBuffer> buffers;
+    for (size_t i = 0; i < msgCount; ++i) {
+        buffers.push_back(ts::UDPSocket::ReceiveBuffer(&in[2 * i * msgSize], 2 * msgSize));
+    }
+    size_t received = 0;
+    while (received < msgCount) {
+        size_t count = 0;
+        TSUNIT_ASSERT(receiver.receiveBatch(buffers.data(), buffers.size(), count, nullptr, CERR));
+        TSUNIT_ASSERT(count > 0);
+        TSUNIT_ASSERT(received + count <= msgCount);
+        debug() << "NetworkingTest::testUDPBatch: received " << count << " messages" << std::endl;
+        for (size_t i = 0; i < count; ++i) {
+            const ts::UDPSocket::ReceiveBuffer& buf(buffers[i]);
+            TSUNIT_EQUAL(msgSize, buf.size);
+            TSUNIT_ASSERT(ts::IPv4Address(buf.sender) == ts::IPv4Address::LocalHost);
+            TSUNIT_EQUAL(received + i, *reinterpret_cast<const uint8_t*>(buf.data));
+#if defined(TS_LINUX)
+            TSUNIT_ASSERT(buf.timestamp >= 0);
+#endif
+        }
+        received += count;
+    }
+}
+
+// Send datagrams on the loopback interface using one method and check reception.
+// Return the number of transmitted datagrams per second.
+namespace {
+    enum class UDPSendMode {SINGLE, BATCH, SEGMENTS};
+
+    int64_t UDPThroughput(ts::UDPSocket& sender, ts::UDPReceiver& receiver, UDPSendMode mode)
+    {
+        const size_t dgSize = 1316;
+        const size_t dgGroup = 32;
+        const size_t groupCount = 500;
+
+        // Prepare a group of contiguous datagrams.
+        ts::ByteBlock out(dgGroup * dgSize);
+        std::vector<const void*> addresses(dgGroup);
+        std::vector<size_t> sizes(dgGroup, dgSize);
+        for (size_t i = 0; i < dgGroup; ++i) {
+            addresses[i] = &out[i * dgSize];
+        }
+
+        // Reception buffers.
+        ts::ByteBlock in(dgGroup * ts::IP_MAX_PACKET_SIZE);
+        std::vector<ts::UDPSocket::ReceiveBuffer> buffers;
+        for (size_t i = 0; i < dgGroup; ++i) {
+            buffers.push_back(ts::UDPSocket::ReceiveBuffer(&in[i * ts::IP_MAX_PACKET_SIZE], ts::IP_MAX_PACKET_SIZE));
+        }
+
+        const ts::Time start(ts::Time::CurrentUTC());
+        for (size_t group = 0; group < groupCount; ++group) {
+
+            // Mark each datagram with its index in the group.
+            for (size_t i = 0; i < dgGroup; ++i) {
+                out[i * dgSize] = uint8_t(group);
+                out[i * dgSize + 1] = uint8_t(i);
+            }
+
+            // Send the group of datagrams.
+            switch (mode) {
+                case UDPSendMode::SINGLE:
+                    for (size_t i = 0; i < dgGroup; ++i) {
+                        TSUNIT_ASSERT(sender.send(addresses[i], dgSize, CERR));
+                    }
+                    break;
+                case UDPSendMode::BATCH:
+                    TSUNIT_ASSERT(sender.sendBatch(addresses.data(), sizes.data(), dgGroup, CERR));
+                    break;
+                case UDPSendMode::SEGMENTS:
+                default:
+                    TSUNIT_ASSERT(sender.sendSegments(out.data(), out.size(), dgSize, CERR));
+                    break;
+            }
+
+            // Receive all datagrams, split if coalesced.
+            size_t received = 0;
+            while (received < dgGroup) {
+                size_t count = 0;
+                TSUNIT_ASSERT(receiver.receiveBatch(buffers.data(), dgGroup - received, count, nullptr, CERR));
+                for (size_t i = 0; i < count; ++i) {
+                    TSUNIT_EQUAL(dgSize, buffers[i].size);
+                    TSUNIT_EQUAL(uint8_t(group), reinterpret_cast<const uint8_t*>(buffers[i].data)[0]);
+                    TSUNIT_EQUAL(uint8_t(received + i), reinterpret_cast<const uint8_t*>(buffers[i].data)[1]);
+                }
+                received += count;
+            }
+        }
+        const ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+        return int64_t(groupCount * dgGroup * ts::MilliSecPerSec) / duration;
+    }
+}
+
+void NetworkingTest::testUDPOffload()
+{
+    if (debugMode()) {
+        TSUNIT_ASSERT(ts::IPInitialize());
+
+        // Create a receiver on the loopback interface using receive offload.
+        ts::DuckContext duck;
+        ts::Args args;
+        ts::UDPReceiver receiver(CERR);
+        receiver.defineArgs(args);
+        TSUNIT_ASSERT(args.analyze(u"utest", {u"--gro", u"--local-address", u"127.0.0.1", u"--buffer-size", u"4000000", u"12347"}, false));
+        TSUNIT_ASSERT(receiver.loadArgs(duck, args));
+        receiver.setReceiveTimeoutArg(5000);
+        TSUNIT_ASSERT(receiver.open(CERR));
+
+        // Create sender socket.
+        ts::UDPSocket sender;
+        TSUNIT_ASSERT(sender.open(CERR));
+        TSUNIT_ASSERT(sender.setDefaultDestination(ts::IPv4SocketAddress(ts::IPv4Address::LocalHost, 12347), CERR));
+
+        // Compare the throughput of the various send methods.
+        const int64_t single = UDPThroughput(sender, receiver, UDPSendMode::SINGLE);
+        const int64_t batch = UDPThroughput(sender, receiver, UDPSendMode::BATCH);
+        const int64_t segments = UDPThroughput(sender, receiver, UDPSendMode::SEGMENTS);
+
+        debug() << "NetworkingTest::testUDPOffload: datagrams/second, single: " << single
+                << ", batch: " << batch << ", segments: " << segments << std::endl;
+    }
+}
+
 void NetworkingTest::testIPHeader()
 {
     static const uint8_t reference_header[] = {
@@ -32,6 +32,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsResidentBuffer.h"
+#include "tsMonotonic.h"
 #include "tsunit.h"
 
 
@@ -46,10 +47,20 @@ public:
     virtual void afterTest() override;
 
     void testResidentBuffer();
+    void testHugePages();
+    void testNumaNode();
+    void testHugePagesThroughput();
 
     TSUNIT_TEST_BEGIN(ResidentBufferTest);
     TSUNIT_TEST(testResidentBuffer);
+    TSUNIT_TEST(testHugePages);
+    TSUNIT_TEST(testNumaNode);
+    TSUNIT_TEST(testHugePagesThroughput);
     TSUNIT_TEST_END();
+
+private:
+    // Random accesses in a large buffer, return the number of accesses per second.
+    static double accessThroughput(bool huge_pages);
 };
 
 TSUNIT_REGISTER(ResidentBufferTest);
@@ -86,3 +97,78 @@ void ResidentBufferTest::testResidentBuffer()
     TSUNIT_ASSERT(buf.isLocked());
     TSUNIT_ASSERT(buf.count() >= buf_size);
 }
+
+void ResidentBufferTest::testHugePages()
+{
+    const size_t buf_size = 3 * 1024 * 1024 + 100;
+
+    ts::ResidentBuffer<uint32_t> buf(buf_size, true);
+
+    debug() << "ResidentBufferTest: huge page size = " << ts::SysInfo::Instance()->hugePageSize()
+            << ", isHugePages() = " << buf.isHugePages() << ", isLocked() = " << buf.isLocked() << std::endl;
+
+    TSUNIT_ASSERT(buf.base() != nullptr);
+    TSUNIT_ASSERT(buf.count() >= buf_size);
+    TSUNIT_ASSERT(buf.numaNode() < 0);
+    for (size_t i = 0; i < buf.count(); ++i) {
+        buf.base()[i] = uint32_t(i);
+    }
+    TSUNIT_EQUAL(buf_size - 1, buf.base()[buf_size - 1]);
+#if !defined(TS_LINUX)
+    TSUNIT_ASSERT(!buf.isHugePages());
+#endif
+}
+
+void ResidentBufferTest::testNumaNode()
+{
+    const size_t buf_size = 100000;
+    const int node = ts::GetCPUNumaNode(0);
+
+    ts::ResidentBuffer<uint8_t> buf(buf_size, false, std::max(0, node));
+
+    debug() << "ResidentBufferTest: NUMA node of CPU 0 = " << node << ", numaNode() = " << buf.numaNode() << std::endl;
+
+    TSUNIT_ASSERT(buf.base() != nullptr);
+    TSUNIT_ASSERT(buf.count() >= buf_size);
+    TSUNIT_ASSERT(!buf.isHugePages());
+    if (node >= 0) {
+        TSUNIT_EQUAL(node, buf.numaNode());
+    }
+    ::memset(buf.base(), 0x47, buf.count());
+    TSUNIT_EQUAL(0x47, buf.base()[buf_size - 1]);
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: random accesses in a large buffer with or without huge pages.
+//----------------------------------------------------------------------------
+
+double ResidentBufferTest::accessThroughput(bool huge_pages)
+{
+    const size_t buf_size = 64 * 1024 * 1024;
+    const size_t access_count = 4000000;
+
+    ts::ResidentBuffer<uint8_t> buf(buf_size, huge_pages);
+    ::memset(buf.base(), 0, buf.count());
+
+    // Linear congruential generator, each access is likely to hit a different page.
+    uint32_t index = 1;
+    const ts::Monotonic start(true);
+    for (size_t i = 0; i < access_count; ++i) {
+        index = index * 1664525 + 1013904223;
+        buf.base()[index % buf_size]++;
+    }
+    const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+
+    return (double(access_count) * ts::NanoSecPerSec) / double(duration);
+}
+
+void ResidentBufferTest::testHugePagesThroughput()
+{
+    if (debugMode()) {
+        const double normal = accessThroughput(false);
+        const double huge = accessThroughput(true);
+        debug() << "ResidentBufferTest: random accesses per second, normal pages: " << ts::UString::Decimal(int64_t(normal))
+                << ", huge pages: " << ts::UString::Decimal(int64_t(huge)) << std::endl;
+    }
+}
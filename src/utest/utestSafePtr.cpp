@@ -33,7 +33,9 @@
 
 #include "tsSafePtr.h"
 #include "tsMutex.h"
+#include "tsMonotonic.h"
 #include "tsunit.h"
+#include "utestTSUnitThread.h"
 
 
 //----------------------------------------------------------------------------
@@ -50,13 +52,22 @@ public:
     void testDowncast();
     void testUpcast();
     void testChangeMutex();
+    void testConcurrentCopies();
+    void testContendedThroughput();
 
     TSUNIT_TEST_BEGIN(SafePtrTest);
     TSUNIT_TEST(testSafePtr);
     TSUNIT_TEST(testDowncast);
     TSUNIT_TEST(testUpcast);
     TSUNIT_TEST(testChangeMutex);
+    TSUNIT_TEST(testConcurrentCopies);
+    TSUNIT_TEST(testContendedThroughput);
     TSUNIT_TEST_END();
+
+private:
+    // Copy and destroy one shared safe pointer in several threads, return the number of copies per second.
+    template <class MUTEX>
+    static double concurrentCopies(size_t thread_count, size_t copy_count);
 };
 
 TSUNIT_REGISTER(SafePtrTest);
@@ -386,3 +397,90 @@ void SafePtrTest::testChangeMutex()
     pt.clear();
     TSUNIT_ASSERT(TestData::InstanceCount() == 0);
 }
+
+
+//----------------------------------------------------------------------------
+// Thread-safe safe pointers: concurrent copies of the same pointer.
+//----------------------------------------------------------------------------
+
+namespace {
+    // A mutex class which is not ts::Mutex: the safe pointer state is protected by the mutex.
+    class LockingMutex: public ts::Mutex
+    {
+    };
+
+    // Thread which repeatedly copies and destroys a shared safe pointer.
+    template <class MUTEX>
+    class CopyThread: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(CopyThread);
+    private:
+        const ts::SafePtr<TestData,MUTEX>& _ptr;
+        size_t _copy_count;
+    public:
+        CopyThread(const ts::SafePtr<TestData,MUTEX>& ptr, size_t copy_count) :
+            utest::TSUnitThread(),
+            _ptr(ptr),
+            _copy_count(copy_count)
+        {
+        }
+
+        virtual ~CopyThread() override
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            for (size_t i = 0; i < _copy_count; ++i) {
+                const ts::SafePtr<TestData,MUTEX> copy(_ptr);
+                TSUNIT_EQUAL(999, copy->value());
+            }
+        }
+    };
+}
+
+template <class MUTEX>
+double SafePtrTest::concurrentCopies(size_t thread_count, size_t copy_count)
+{
+    const ts::SafePtr<TestData,MUTEX> ptr(new TestData(999));
+    std::vector<CopyThread<MUTEX>*> threads(thread_count);
+
+    const ts::Monotonic start(true);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i] = new CopyThread<MUTEX>(ptr, copy_count);
+        TSUNIT_ASSERT(threads[i]->start());
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        delete threads[i];
+    }
+    const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+
+    // All copies are destroyed, the object is still referenced once.
+    TSUNIT_EQUAL(1, ptr.count());
+    TSUNIT_EQUAL(999, ptr->value());
+    return (double(thread_count * copy_count) * ts::NanoSecPerSec) / double(duration);
+}
+
+// Test case: concurrent copies with atomic and mutex-protected reference counts
+void SafePtrTest::testConcurrentCopies()
+{
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+    concurrentCopies<ts::Mutex>(4, 10000);
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+    concurrentCopies<LockingMutex>(4, 10000);
+    TSUNIT_ASSERT(TestData::InstanceCount() == 0);
+}
+
+// Benchmark: contended copies with atomic and mutex-protected reference counts
+void SafePtrTest::testContendedThroughput()
+{
+    if (debugMode()) {
+        for (size_t threads = 1; threads <= 4; threads *= 2) {
+            const double atomic = concurrentCopies<ts::Mutex>(threads, 1000000);
+            const double locked = concurrentCopies<LockingMutex>(threads, 1000000);
+            debug() << "SafePtrTest: " << threads << " threads, copies per second, atomic: " << ts::UString::Decimal(int64_t(atomic))
+                    << ", mutex: " << ts::UString::Decimal(int64_t(locked)) << std::endl;
+        }
+    }
+}
@@ -75,6 +75,7 @@ public:
     void testSearchWildcard();
     void testHomeDirectory();
     void testProcessMetrics();
+    void testThreadCPUTime();
     void testIsTerminal();
     void testSysInfo();
     void testSymLinks();
@@ -103,6 +104,7 @@ public:
     TSUNIT_TEST(testSearchWildcard);
     TSUNIT_TEST(testHomeDirectory);
     TSUNIT_TEST(testProcessMetrics);
+    TSUNIT_TEST(testThreadCPUTime);
     TSUNIT_TEST(testIsTerminal);
     TSUNIT_TEST(testSysInfo);
     TSUNIT_TEST(testSymLinks);
@@ -695,6 +697,23 @@ void SysUtilsTest::testProcessMetrics()
     TSUNIT_ASSERT(pm2.vmem_size > 0);
 }
 
+void SysUtilsTest::testThreadCPUTime()
+{
+    const ts::NanoSecond cpu1 = ts::GetThreadCPUTime();
+    debug() << "SysUtilsTest: thread CPU time (1) = " << cpu1 << " ns" << std::endl;
+    TSUNIT_ASSERT(cpu1 >= 0);
+
+    // Consume some milliseconds of CPU time
+    volatile uint64_t counter = 7;
+    for (uint64_t i = 0; i < 10000000L; ++i) {
+        counter = counter * counter;
+    }
+
+    const ts::NanoSecond cpu2 = ts::GetThreadCPUTime();
+    debug() << "SysUtilsTest: thread CPU time (2) = " << cpu2 << " ns" << std::endl;
+    TSUNIT_ASSERT(cpu2 > cpu1);
+}
+
 void SysUtilsTest::testIsTerminal()
 {
 #if defined(TS_WINDOWS)
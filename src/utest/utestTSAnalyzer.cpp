@@ -0,0 +1,350 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for TSAnalyzer.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSAnalyzerReport.h"
+#include "tsTSAnalyzerOptions.h"
+#include "tsOneShotPacketizer.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsTDT.h"
+#include "tsDuckContext.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSAnalyzerTest: public tsunit::Test
+{
+public:
+    TSAnalyzerTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testSequential();
+    void testParallel();
+    void testThroughput();
+
+    TSUNIT_TEST_BEGIN(TSAnalyzerTest);
+    TSUNIT_TEST(testSequential);
+    TSUNIT_TEST(testParallel);
+    TSUNIT_TEST(testThroughput);
+    TSUNIT_TEST_END();
+
+private:
+    ts::TSPacketVector _packets;
+
+    // Build the test stream.
+    void createStream();
+
+    // Get a normalized report.
+    static ts::UString NormalizedReport(ts::TSAnalyzerReport& analyzer);
+
+    // Characteristics of the test stream: one millisecond per packet.
+    static constexpr size_t STREAM_PACKETS = 60000;
+    static constexpr size_t CRYPTO_PERIOD = 3000;
+    static constexpr size_t WARMUP_PACKETS = 5000;
+    static constexpr uint64_t PCR_PER_PACKET = ts::SYSTEM_CLOCK_FREQ / 1000;
+};
+
+TSUNIT_REGISTER(TSAnalyzerTest);
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t TSAnalyzerTest::STREAM_PACKETS;
+constexpr size_t TSAnalyzerTest::CRYPTO_PERIOD;
+constexpr size_t TSAnalyzerTest::WARMUP_PACKETS;
+constexpr uint64_t TSAnalyzerTest::PCR_PER_PACKET;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSAnalyzerTest::TSAnalyzerTest() :
+    _packets()
+{
+}
+
+// Test suite initialization method.
+void TSAnalyzerTest::beforeTest()
+{
+    if (_packets.empty()) {
+        createStream();
+    }
+}
+
+// Test suite cleanup method.
+void TSAnalyzerTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Create a test stream:
+// - PID 0x00: PAT every 500 packets (offset 0).
+// - PID 0x11: SDT every 2000 packets (offset 2).
+// - PID 0x14: TDT every 5000 packets (offset 3).
+// - PID 0x100: PMT every 500 packets (offset 1), service 0x0001.
+// - PID 0x101: video, PCR every 10 packets, PES start every 250 packets, one discontinuity.
+// - PID 0x102: audio, one packet out of 3, scrambled, new crypto-period every CRYPTO_PERIOD packets, one duplicated packet.
+// - PID 0x1FFF: other packets.
+//----------------------------------------------------------------------------
+
+void TSAnalyzerTest::createStream()
+{
+    ts::DuckContext duck;
+
+    ts::PAT pat(0, true, 0x1234);
+    pat.pmts[0x0001] = 0x0100;
+
+    ts::PMT pmt(0, true, 0x0001, 0x0101);
+    pmt.streams[0x0101].stream_type = ts::ST_AVC_VIDEO;
+    pmt.streams[0x0102].stream_type = ts::ST_MPEG2_AUDIO;
+
+    ts::SDT sdt(true, 0, true, 0x1234, 0x5678);
+    sdt.services[0x0001].setName(duck, u"Test Service");
+    sdt.services[0x0001].setProvider(duck, u"Test Provider");
+
+    // Packetize one table and get its packets.
+    auto packetize = [&duck](ts::PID pid, const ts::AbstractTable& table) {
+        ts::OneShotPacketizer pzer(duck, pid);
+        ts::TSPacketVector packets;
+        pzer.addTable(duck, table);
+        pzer.getPackets(packets);
+        TSUNIT_EQUAL(1, packets.size());
+        return packets[0];
+    };
+    const ts::TSPacket pat_pkt(packetize(ts::PID_PAT, pat));
+    const ts::TSPacket pmt_pkt(packetize(0x0100, pmt));
+    const ts::TSPacket sdt_pkt(packetize(ts::PID_SDT, sdt));
+
+    uint8_t cc_pat = 0, cc_pmt = 0, cc_sdt = 0, cc_tdt = 0, cc_video = 0, cc_audio = 0;
+    _packets.resize(STREAM_PACKETS);
+
+    for (size_t n = 0; n < _packets.size(); ++n) {
+        ts::TSPacket& pkt(_packets[n]);
+        if (n % 500 == 0) {
+            pkt = pat_pkt;
+            pkt.setCC(cc_pat++ & ts::CC_MASK);
+        }
+        else if (n % 500 == 1) {
+            pkt = pmt_pkt;
+            pkt.setCC(cc_pmt++ & ts::CC_MASK);
+        }
+        else if (n % 2000 == 2) {
+            pkt = sdt_pkt;
+            pkt.setCC(cc_sdt++ & ts::CC_MASK);
+        }
+        else if (n % 5000 == 3) {
+            pkt = packetize(ts::PID_TDT, ts::TDT(ts::Time(2023, 6, 1, 12, 0, 0) + ts::MilliSecond(n)));
+            pkt.setCC(cc_tdt++ & ts::CC_MASK);
+        }
+        else if (n % 10 == 4) {
+            pkt.init(0x0101, cc_video++ & ts::CC_MASK);
+            TSUNIT_ASSERT(pkt.setPCR(1000000000 + n * PCR_PER_PACKET, true));
+        }
+        else if (n % 250 == 5) {
+            static const uint8_t pes_header[] = {0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0x00, 0x00};
+            pkt.init(0x0101, cc_video++ & ts::CC_MASK);
+            pkt.setPUSI();
+            ::memcpy(pkt.b + 4, pes_header, sizeof(pes_header));
+        }
+        else if (n % 3 == 0) {
+            if (n == 31002) {
+                // Duplicated packet.
+                cc_audio--;
+            }
+            pkt.init(0x0102, cc_audio++ & ts::CC_MASK, uint8_t(n));
+            pkt.setScrambling((n / CRYPTO_PERIOD) % 2 == 0 ? ts::SC_EVEN_KEY : ts::SC_ODD_KEY);
+        }
+        else {
+            pkt.init(ts::PID_NULL, 0, uint8_t(n));
+        }
+        if (n == 27204) {
+            // Discontinuity on video PID.
+            cc_video++;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get a normalized report.
+//----------------------------------------------------------------------------
+
+ts::UString TSAnalyzerTest::NormalizedReport(ts::TSAnalyzerReport& analyzer)
+{
+    ts::TSAnalyzerOptions opt;
+    opt.normalized = true;
+    opt.deterministic = true;
+    std::ostringstream strm;
+    analyzer.report(strm, opt);
+    return ts::UString::FromUTF8(strm.str());
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSAnalyzerTest::testSequential()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzerReport analyzer(duck);
+    for (const auto& pkt : _packets) {
+        analyzer.feedPacket(pkt);
+    }
+
+    const ts::UString report(NormalizedReport(analyzer));
+    debug() << "TSAnalyzerTest::testSequential: " << std::endl << report << std::endl;
+
+    TSUNIT_ASSERT(report.contain(u"ts:id=4660:services=1:"));
+    TSUNIT_ASSERT(report.contain(u":packets=60000:"));
+    TSUNIT_ASSERT(report.contain(u":pcrbitrate=1504000:"));
+    TSUNIT_ASSERT(report.contain(u":duration=60:"));
+    TSUNIT_ASSERT(!report.contain(u":chunks="));
+    TSUNIT_ASSERT(report.contain(u"pid:pid=257:"));
+    TSUNIT_ASSERT(report.contain(u":discontinuities=1:"));
+    TSUNIT_ASSERT(report.contain(u":duplicated=1:"));
+    TSUNIT_ASSERT(report.contain(u":cryptoperiod=3:"));
+}
+
+void TSAnalyzerTest::testParallel()
+{
+    // Sequential analysis as reference.
+    ts::DuckContext duck;
+    ts::TSAnalyzerReport reference(duck);
+    for (const auto& pkt : _packets) {
+        reference.feedPacket(pkt);
+    }
+
+    // Analyze 4 chunks, boundaries in the middle of tables, PES packets and crypto-periods.
+    static const size_t bounds[] = {0, 13003, 29000, 44567, STREAM_PACKETS};
+    constexpr size_t chunks = sizeof(bounds) / sizeof(bounds[0]) - 1;
+    std::vector<ts::SafePtr<ts::TSAnalyzerReport>> analyzers(chunks);
+
+    for (size_t i = 0; i < chunks; ++i) {
+        analyzers[i] = new ts::TSAnalyzerReport(duck);
+        const size_t warmup = i == 0 ? 0 : std::max(bounds[i - 1], bounds[i] - WARMUP_PACKETS);
+        analyzers[i]->setPacketIndex(warmup);
+        for (size_t n = warmup; n < bounds[i]; ++n) {
+            analyzers[i]->feedPacket(_packets[n]);
+        }
+        if (i > 0) {
+            analyzers[i]->resetStatistics();
+        }
+        for (size_t n = bounds[i]; n < bounds[i + 1]; ++n) {
+            analyzers[i]->feedPacket(_packets[n]);
+        }
+    }
+    for (size_t i = 1; i < chunks; ++i) {
+        analyzers[0]->merge(*analyzers[i]);
+    }
+
+    const ts::UString ref_report(NormalizedReport(reference));
+    ts::UString report(NormalizedReport(*analyzers[0]));
+    debug() << "TSAnalyzerTest::testParallel: " << std::endl << report << std::endl;
+
+    // Same results, except the number of chunks.
+    TSUNIT_ASSERT(report.contain(u":chunks=4:"));
+    report.substitute(u"chunks=4:", u"");
+    TSUNIT_EQUAL(ref_report, report);
+}
+
+// Benchmark: packets per second on a multi-program stream.
+void TSAnalyzerTest::testThroughput()
+{
+    // 10 programs with one video PID, two audio PID's and one PMT PID each.
+    constexpr size_t program_count = 10;
+    constexpr size_t packet_count = 100000;
+    constexpr size_t repeat = 10;
+
+    ts::DuckContext duck;
+    ts::PAT pat(0, true, 1);
+    ts::TSPacketVector psi;
+    for (uint16_t srv = 1; srv <= program_count; ++srv) {
+        const ts::PID base = ts::PID(0x100 * srv);
+        pat.pmts[srv] = base;
+        ts::PMT pmt(0, true, srv, base + 1);
+        pmt.streams[base + 1].stream_type = ts::ST_AVC_VIDEO;
+        pmt.streams[base + 2].stream_type = ts::ST_MPEG2_AUDIO;
+        pmt.streams[base + 3].stream_type = ts::ST_MPEG2_AUDIO;
+        ts::OneShotPacketizer pzer(duck, base);
+        pzer.addTable(duck, pmt);
+        ts::TSPacketVector pmt_packets;
+        pzer.getPackets(pmt_packets);
+        psi.insert(psi.end(), pmt_packets.begin(), pmt_packets.end());
+    }
+    ts::OneShotPacketizer pat_pzer(duck, ts::PID_PAT);
+    pat_pzer.addTable(duck, pat);
+    ts::TSPacketVector pat_packets;
+    pat_pzer.getPackets(pat_packets);
+    psi.insert(psi.begin(), pat_packets.begin(), pat_packets.end());
+
+    std::map<ts::PID, uint8_t> cc;
+    ts::TSPacketVector packets(packet_count);
+    for (size_t n = 0; n < packets.size(); ++n) {
+        ts::TSPacket& pkt(packets[n]);
+        if (n % 100 < psi.size()) {
+            pkt = psi[n % 100];
+        }
+        else {
+            // 8 video packets for 1 packet of each audio, all programs interleaved.
+            const size_t index = n % 10;
+            const ts::PID pid = ts::PID(0x100 * (1 + (n / 10) % program_count) + (index < 8 ? 1 : index - 6));
+            pkt.init(pid, 0, uint8_t(n));
+            if (n % 50 == 0) {
+                pkt.setPCR(n * 27000, true);
+            }
+        }
+        pkt.setCC(cc[pkt.getPID()]++ & ts::CC_MASK);
+    }
+
+    ts::TSAnalyzerReport analyzer(duck);
+    const ts::Monotonic start(true);
+    for (size_t r = 0; r < repeat; ++r) {
+        for (const auto& pkt : packets) {
+            analyzer.feedPacket(pkt);
+        }
+    }
+    const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+    TSUNIT_ASSERT(NormalizedReport(analyzer).contain(u"ts:id=1:services=10:"));
+    debug() << "TSAnalyzerTest: packets per second: "
+            << ts::UString::Decimal(int64_t((ts::NanoSecPerSec * repeat * packet_count) / duration)) << std::endl;
+}
@@ -37,6 +37,7 @@
 #include "tsCerrReport.h"
 #include "tsNullReport.h"
 #include "tsFileUtils.h"
+#include "tsTime.h"
 #include "tsunit.h"
 
 
@@ -57,6 +58,11 @@ public:
     void testDuck();
     void testStuffingRead();
     void testStuffingWrite();
+    void testMemoryMapped();
+    void testMemoryMappedM2TS();
+    void testReadPerformance();
+    void testAsyncWrite();
+    void testAsyncWriteM2TS();
 
     TSUNIT_TEST_BEGIN(TSFileTest);
     TSUNIT_TEST(testTS);
@@ -64,6 +70,11 @@ public:
     TSUNIT_TEST(testDuck);
     TSUNIT_TEST(testStuffingRead);
     TSUNIT_TEST(testStuffingWrite);
+    TSUNIT_TEST(testMemoryMapped);
+    TSUNIT_TEST(testMemoryMappedM2TS);
+    TSUNIT_TEST(testReadPerformance);
+    TSUNIT_TEST(testAsyncWrite);
+    TSUNIT_TEST(testAsyncWriteM2TS);
     TSUNIT_TEST_END();
 
 private:
@@ -395,3 +406,215 @@ void TSFileTest::testStuffingWrite()
     TSUNIT_EQUAL(184, packets[5].getPayloadSize());
     TSUNIT_EQUAL(0xFF, packets[5].getPayload()[0]);
 }
+
+void TSFileTest::testMemoryMapped()
+{
+    ts::TSFile file;
+    ts::TSPacketVector packets(1000);
+
+    // Create a file with numbered packets.
+    for (size_t i = 0; i < packets.size(); ++i) {
+        packets[i].init(ts::PID(i % 0x1000), 0, uint8_t(i));
+    }
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE, CERR));
+    TSUNIT_ASSERT(!file.isMemoryMapped());
+    TSUNIT_ASSERT(file.writePackets(packets.data(), nullptr, packets.size(), CERR));
+    TSUNIT_ASSERT(file.close(CERR));
+
+    // Read it twice from packet 10 in memory-mapped mode, by odd chunks.
+    ts::TSFile file2;
+    file2.setMemoryMapped(true);
+    TSUNIT_ASSERT(file2.openRead(_tempFileName, 2, 10 * ts::PKT_SIZE, CERR));
+#if !defined(TS_WINDOWS)
+    TSUNIT_ASSERT(file2.isMemoryMapped());
+#endif
+    ts::TSPacketVector inpackets(7);
+    size_t index = 10;
+    size_t total = 0;
+    size_t count = 0;
+    while ((count = file2.readPackets(inpackets.data(), nullptr, inpackets.size(), CERR)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_EQUAL(packets[index].getPID(), inpackets[i].getPID());
+            TSUNIT_EQUAL(packets[index].getPayload()[0], inpackets[i].getPayload()[0]);
+            if (++index >= packets.size()) {
+                index = 10;
+            }
+        }
+        total += count;
+    }
+    TSUNIT_EQUAL(2 * 990, total);
+    TSUNIT_EQUAL(2 * 990, file2.readPacketsCount());
+    TSUNIT_ASSERT(file2.close(CERR));
+    TSUNIT_ASSERT(!file2.isMemoryMapped());
+
+    // Rewindable mode with seek.
+    TSUNIT_ASSERT(file2.open(_tempFileName, ts::TSFile::READ, CERR));
+    TSUNIT_EQUAL(inpackets.size(), file2.readPackets(inpackets.data(), nullptr, inpackets.size(), CERR));
+    TSUNIT_ASSERT(file2.seek(500, CERR));
+    TSUNIT_EQUAL(1, file2.readPackets(inpackets.data(), nullptr, 1, CERR));
+    TSUNIT_EQUAL(packets[500].getPID(), inpackets[0].getPID());
+    TSUNIT_ASSERT(file2.seek(999, CERR));
+    TSUNIT_EQUAL(1, file2.readPackets(inpackets.data(), nullptr, inpackets.size(), CERR));
+    TSUNIT_EQUAL(packets[999].getPID(), inpackets[0].getPID());
+    TSUNIT_EQUAL(0, file2.readPackets(inpackets.data(), nullptr, inpackets.size(), CERR));
+    TSUNIT_ASSERT(file2.rewind(CERR));
+    TSUNIT_EQUAL(inpackets.size(), file2.readPackets(inpackets.data(), nullptr, inpackets.size(), CERR));
+    TSUNIT_EQUAL(packets[0].getPID(), inpackets[0].getPID());
+    TSUNIT_ASSERT(file2.close(CERR));
+
+    // Write mode is never memory-mapped.
+    TSUNIT_ASSERT(file2.open(_tempFileName, ts::TSFile::READ | ts::TSFile::WRITE, CERR));
+    TSUNIT_ASSERT(!file2.isMemoryMapped());
+    TSUNIT_ASSERT(file2.close(CERR));
+}
+
+void TSFileTest::testMemoryMappedM2TS()
+{
+    ts::TSFile file;
+    ts::TSPacket packet(ts::NullPacket);
+    ts::TSPacketMetadata mdata;
+
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE, CERR, ts::TSPacketFormat::M2TS));
+    for (size_t i = 0; i < 100; ++i) {
+        packet.setPID(ts::PID(200 + i));
+        mdata.setInputTimeStamp(i, ts::SYSTEM_CLOCK_FREQ, ts::TimeSource::UNDEFINED);
+        TSUNIT_ASSERT(file.writePackets(&packet, &mdata, 1, CERR));
+    }
+    TSUNIT_ASSERT(file.close(CERR));
+
+    ts::TSFile file2;
+    file2.setMemoryMapped(true);
+    TSUNIT_ASSERT(file2.openRead(_tempFileName, 1, 0, CERR));
+    for (size_t i = 0; i < 100; ++i) {
+        TSUNIT_EQUAL(1, file2.readPackets(&packet, &mdata, 1, CERR));
+        TSUNIT_EQUAL(ts::TSPacketFormat::M2TS, file2.packetFormat());
+        TSUNIT_EQUAL(200 + i, packet.getPID());
+        TSUNIT_EQUAL(i, mdata.getInputTimeStamp());
+        TSUNIT_EQUAL(ts::TimeSource::M2TS, mdata.getInputTimeSource());
+    }
+    TSUNIT_EQUAL(0, file2.readPackets(&packet, &mdata, 1, CERR));
+    TSUNIT_ASSERT(file2.close(CERR));
+}
+
+void TSFileTest::testReadPerformance()
+{
+    // Compare the throughput of regular and memory-mapped reads, by large chunks
+    // (as tsp -I file) and one packet at a time (as tsanalyze).
+    // Only informational, displayed in debug mode. Otherwise, only check the reads on a small file.
+    const size_t file_packets = debugMode() ? 100000 : 2000;
+    ts::TSPacketVector packets(1000);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        packets[i].init(ts::PID(i), 0, uint8_t(i));
+    }
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE, CERR));
+    for (size_t i = 0; i < file_packets; i += packets.size()) {
+        TSUNIT_ASSERT(file.writePackets(packets.data(), nullptr, packets.size(), CERR));
+    }
+    TSUNIT_ASSERT(file.close(CERR));
+
+    for (int mapped = 0; mapped <= 1; ++mapped) {
+        for (size_t chunk = 1; chunk <= packets.size(); chunk += packets.size() - 1) {
+            ts::TSFile file2;
+            file2.setMemoryMapped(mapped != 0);
+            TSUNIT_ASSERT(file2.openRead(_tempFileName, 1, 0, CERR));
+            const ts::Time start(ts::Time::CurrentUTC());
+            size_t total = 0;
+            size_t count = 0;
+            while ((count = file2.readPackets(packets.data(), nullptr, chunk, CERR)) > 0) {
+                total += count;
+            }
+            const ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+            TSUNIT_EQUAL(file_packets, total);
+            TSUNIT_ASSERT(file2.close(CERR));
+            debug() << "TSFileTest::testReadPerformance: " << (mapped ? "memory-mapped" : "regular") << " read, "
+                    << chunk << " packets per read: " << (total * ts::PKT_SIZE / duration / 1000) << " MB/s" << std::endl;
+        }
+    }
+}
+
+void TSFileTest::testAsyncWrite()
+{
+    ts::TSPacketVector packets(1000);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        packets[i].init(ts::PID(i % 0x1000), 0, uint8_t(i));
+    }
+
+    // Small buffers, not a multiple of the packet size, to test packets across buffers.
+    // Try with and without direct I/O (which may not be supported by the file system).
+    for (int direct = 0; direct <= 1; ++direct) {
+        ts::TSFile file;
+        file.setStuffing(3, 5);
+        file.setAsyncWrite(3, 8192, direct != 0);
+        TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE, CERR));
+        for (size_t i = 0; i < packets.size(); i += 100) {
+            TSUNIT_ASSERT(file.writePackets(packets.data() + i, nullptr, 100, CERR));
+        }
+        TSUNIT_EQUAL(3 + packets.size(), file.writePacketsCount());
+        TSUNIT_ASSERT(!file.seek(0, NULLREP));
+        TSUNIT_ASSERT(file.close(CERR));
+
+        const ts::TSFile::AsyncStatistics& stats(file.asyncStatistics());
+        debug() << "TSFileTest::testAsyncWrite: direct I/O: " << direct << ", writes: " << stats.writes
+                << ", max queued: " << stats.max_queued << ", stalls: " << stats.stalls << std::endl;
+        TSUNIT_EQUAL((3 + packets.size() + 5) * ts::PKT_SIZE, stats.bytes);
+        TSUNIT_EQUAL(24, stats.writes); // 1008 packets = 189,504 bytes = 23 full buffers + 1 partial
+        TSUNIT_ASSERT(stats.max_queued >= 1);
+        TSUNIT_ASSERT(stats.max_queued <= 3);
+        TSUNIT_EQUAL((3 + packets.size() + 5) * ts::PKT_SIZE, ts::GetFileSize(_tempFileName));
+
+        // Read it back synchronously.
+        ts::TSFile file2;
+        ts::TSPacketVector inpackets(packets.size() + 8);
+        TSUNIT_ASSERT(file2.openRead(_tempFileName, 1, 0, CERR));
+        TSUNIT_EQUAL(inpackets.size(), file2.readPackets(inpackets.data(), nullptr, inpackets.size(), CERR));
+        TSUNIT_EQUAL(0, file2.readPackets(inpackets.data(), nullptr, 1, CERR));
+        TSUNIT_ASSERT(file2.close(CERR));
+        for (size_t i = 0; i < inpackets.size(); ++i) {
+            if (i < 3 || i >= 3 + packets.size()) {
+                TSUNIT_EQUAL(ts::PID_NULL, inpackets[i].getPID());
+            }
+            else {
+                TSUNIT_EQUAL(packets[i - 3].getPID(), inpackets[i].getPID());
+                TSUNIT_EQUAL(packets[i - 3].getPayload()[0], inpackets[i].getPayload()[0]);
+            }
+        }
+
+        // Append in asynchronous mode, the file size is no longer aligned.
+        file.setStuffing(0, 0);
+        TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::APPEND, CERR));
+        TSUNIT_ASSERT(file.writePackets(packets.data(), nullptr, 10, CERR));
+        TSUNIT_ASSERT(file.close(CERR));
+        TSUNIT_EQUAL((3 + packets.size() + 5 + 10) * ts::PKT_SIZE, ts::GetFileSize(_tempFileName));
+        TSUNIT_EQUAL((3 + packets.size() + 5 + 10) * ts::PKT_SIZE, file.asyncStatistics().bytes);
+        ts::DeleteFile(_tempFileName, NULLREP);
+    }
+}
+
+void TSFileTest::testAsyncWriteM2TS()
+{
+    ts::TSFile file;
+    ts::TSPacket packet(ts::NullPacket);
+    ts::TSPacketMetadata mdata;
+
+    file.setAsyncWrite(2, 4096);
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE, CERR, ts::TSPacketFormat::M2TS));
+    for (size_t i = 0; i < 100; ++i) {
+        packet.setPID(ts::PID(200 + i));
+        mdata.setInputTimeStamp(i, ts::SYSTEM_CLOCK_FREQ, ts::TimeSource::UNDEFINED);
+        TSUNIT_ASSERT(file.writePackets(&packet, &mdata, 1, CERR));
+    }
+    TSUNIT_ASSERT(file.close(CERR));
+    TSUNIT_EQUAL(100 * (4 + ts::PKT_SIZE), ts::GetFileSize(_tempFileName));
+
+    ts::TSFile file2;
+    TSUNIT_ASSERT(file2.openRead(_tempFileName, 1, 0, CERR));
+    for (size_t i = 0; i < 100; ++i) {
+        TSUNIT_EQUAL(1, file2.readPackets(&packet, &mdata, 1, CERR));
+        TSUNIT_EQUAL(ts::TSPacketFormat::M2TS, file2.packetFormat());
+        TSUNIT_EQUAL(200 + i, packet.getPID());
+        TSUNIT_EQUAL(i, mdata.getInputTimeStamp());
+    }
+    TSUNIT_EQUAL(0, file2.readPackets(&packet, &mdata, 1, CERR));
+    TSUNIT_ASSERT(file2.close(CERR));
+}
@@ -0,0 +1,355 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for TSFileIndex.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileIndex.h"
+#include "tsTSFile.h"
+#include "tsTSPacket.h"
+#include "tsOneShotPacketizer.h"
+#include "tsTDT.h"
+#include "tsDuckContext.h"
+#include "tsCerrReport.h"
+#include "tsNullReport.h"
+#include "tsFileUtils.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSFileIndexTest: public tsunit::Test
+{
+public:
+    TSFileIndexTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testBuild();
+    void testFind();
+    void testWrappedPCR();
+    void testSidecar();
+    void testM2TS();
+
+    TSUNIT_TEST_BEGIN(TSFileIndexTest);
+    TSUNIT_TEST(testBuild);
+    TSUNIT_TEST(testFind);
+    TSUNIT_TEST(testWrappedPCR);
+    TSUNIT_TEST(testSidecar);
+    TSUNIT_TEST(testM2TS);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _tempFileName;
+
+    // Create a test file.
+    void createFile(ts::TSPacketFormat format, size_t packet_count = FILE_PACKETS, uint64_t pcr_base = PCR_BASE);
+
+    // Characteristics of the test file: one millisecond per packet.
+    static constexpr size_t FILE_PACKETS = 20000;
+    static constexpr uint64_t PCR_BASE = 1000000000;
+    static constexpr uint64_t PCR_PER_PACKET = ts::SYSTEM_CLOCK_FREQ / 1000;
+    static uint64_t PCRAt(size_t packet, uint64_t pcr_base = PCR_BASE) { return (pcr_base + packet * PCR_PER_PACKET) % ts::PCR_SCALE; }
+    static uint64_t PTSAt(size_t packet) { return 2000000 + packet * 90; }
+    static ts::Time TimeAt(size_t packet) { return ts::Time(2023, 6, 1, 12, 0, 0) + ts::MilliSecond(packet) - 3000; }
+};
+
+TSUNIT_REGISTER(TSFileIndexTest);
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t TSFileIndexTest::FILE_PACKETS;
+constexpr uint64_t TSFileIndexTest::PCR_BASE;
+constexpr uint64_t TSFileIndexTest::PCR_PER_PACKET;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSFileIndexTest::TSFileIndexTest() :
+    _tempFileName()
+{
+}
+
+// Test suite initialization method.
+void TSFileIndexTest::beforeTest()
+{
+    if (_tempFileName.empty()) {
+        _tempFileName = ts::TempFile(u".ts");
+    }
+    ts::DeleteFile(_tempFileName, NULLREP);
+    ts::DeleteFile(ts::TSFileIndex::SidecarFileName(_tempFileName), NULLREP);
+}
+
+// Test suite cleanup method.
+void TSFileIndexTest::afterTest()
+{
+    ts::DeleteFile(_tempFileName, NULLREP);
+    ts::DeleteFile(ts::TSFileIndex::SidecarFileName(_tempFileName), NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Create a test file:
+// - PID 100: PCR every 10 packets, key frame every 250 packets (offset 5).
+// - PID 0x14: TDT every 5000 packets (offset 3003), TDT time is TimeAt(packet - 3).
+// - PID 200: other packets.
+//----------------------------------------------------------------------------
+
+void TSFileIndexTest::createFile(ts::TSPacketFormat format, size_t packet_count, uint64_t pcr_base)
+{
+    ts::DuckContext duck;
+    ts::TSPacketVector packets(packet_count);
+    uint8_t cc100 = 0;
+    uint8_t cc200 = 0;
+    uint8_t cc_tdt = 0;
+
+    for (size_t n = 0; n < packets.size(); ++n) {
+        ts::TSPacket& pkt(packets[n]);
+        if (n % 10 == 0) {
+            pkt.init(100, cc100++);
+            TSUNIT_ASSERT(pkt.setPCR(PCRAt(n, pcr_base), true));
+        }
+        else if (n % 250 == 5) {
+            static const uint8_t pes_header[] = {0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0x80, 0x05, 0x21, 0x00, 0x01, 0x00, 0x01};
+            pkt.init(100, cc100++);
+            pkt.setPUSI();
+            ::memcpy(pkt.b + 4, pes_header, sizeof(pes_header));
+            pkt.setPTS(PTSAt(n));
+            TSUNIT_ASSERT(pkt.setRandomAccessIndicator(true));
+            TSUNIT_ASSERT(pkt.hasPTS());
+        }
+        else if (n % 5000 == 3003) {
+            ts::OneShotPacketizer pzer(duck, ts::PID_TDT);
+            ts::TSPacketVector tdt_packets;
+            pzer.addTable(duck, ts::TDT(TimeAt(n - 3)));
+            pzer.getPackets(tdt_packets);
+            TSUNIT_EQUAL(1, tdt_packets.size());
+            pkt = tdt_packets[0];
+            pkt.setCC(cc_tdt++);
+        }
+        else {
+            pkt.init(200, cc200++, uint8_t(n));
+        }
+    }
+
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE | ts::TSFile::SHARED, CERR, format));
+    TSUNIT_ASSERT(file.writePackets(packets.data(), nullptr, packets.size(), CERR));
+    TSUNIT_ASSERT(file.close(CERR));
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSFileIndexTest::testBuild()
+{
+    createFile(ts::TSPacketFormat::TS);
+
+    ts::TSFileIndex index;
+    TSUNIT_ASSERT(index.build(_tempFileName, CERR));
+    TSUNIT_EQUAL(ts::PKT_SIZE, index.packetSize());
+    TSUNIT_ASSERT(index.matchFile(_tempFileName));
+
+    // First entry on first PCR, then one key frame per second.
+    const auto& entries(index.entries());
+    TSUNIT_EQUAL(20, entries.size());
+
+    TSUNIT_EQUAL(0, entries[0].packet);
+    TSUNIT_EQUAL(PCRAt(0), entries[0].pcr);
+    TSUNIT_ASSERT(!entries[0].isKeyFrame());
+    TSUNIT_ASSERT(entries[0].utc == TimeAt(0));
+
+    for (size_t i = 1; i < entries.size(); ++i) {
+        const size_t packet = 1000 * i + 5;
+        TSUNIT_EQUAL(packet, entries[i].packet);
+        TSUNIT_EQUAL(PCRAt(packet - 5), entries[i].pcr);
+        TSUNIT_ASSERT(entries[i].isKeyFrame());
+        TSUNIT_EQUAL(PTSAt(packet), entries[i].pts);
+        // Times before the first TDT are estimated from the PCR after the first TDT.
+        TSUNIT_ASSERT(entries[i].utc == TimeAt(packet - 5));
+        TSUNIT_EQUAL(packet * ts::PKT_SIZE, index.byteOffset(entries[i]));
+    }
+
+    // Without key frame during two intervals, entries are created on PCR's.
+    // With 100 ms intervals: 3 entries every 500 packets (PCR, PCR, key frame).
+    ts::TSFileIndex index2(100);
+    TSUNIT_ASSERT(index2.build(_tempFileName, CERR));
+    TSUNIT_EQUAL(120, index2.entries().size());
+    TSUNIT_EQUAL(200, index2.entries()[1].packet);
+    TSUNIT_ASSERT(!index2.entries()[1].isKeyFrame());
+    TSUNIT_EQUAL(400, index2.entries()[2].packet);
+    TSUNIT_ASSERT(!index2.entries()[2].isKeyFrame());
+    TSUNIT_EQUAL(505, index2.entries()[3].packet);
+    TSUNIT_ASSERT(index2.entries()[3].isKeyFrame());
+}
+
+void TSFileIndexTest::testFind()
+{
+    createFile(ts::TSPacketFormat::TS);
+
+    ts::TSFileIndex index;
+    ts::TSFileIndex::Entry entry;
+    TSUNIT_ASSERT(index.build(_tempFileName, CERR));
+
+    TSUNIT_ASSERT(index.findPCR(PCRAt(5500), entry));
+    TSUNIT_EQUAL(5005, entry.packet);
+    TSUNIT_ASSERT(index.findPCR(PCRAt(5000), entry));
+    TSUNIT_EQUAL(5005, entry.packet);
+    TSUNIT_ASSERT(index.findPCR(PCRAt(4999), entry));
+    TSUNIT_EQUAL(4005, entry.packet);
+    TSUNIT_ASSERT(index.findPCR(PCRAt(100000), entry));
+    TSUNIT_EQUAL(19005, entry.packet);
+    TSUNIT_ASSERT(!index.findPCR(PCRAt(0) - 1, entry));
+
+    TSUNIT_ASSERT(index.findTime(TimeAt(7200), entry));
+    TSUNIT_EQUAL(7005, entry.packet);
+    TSUNIT_ASSERT(index.findTime(TimeAt(500), entry));
+    TSUNIT_EQUAL(0, entry.packet);
+    TSUNIT_ASSERT(!index.findTime(TimeAt(0) - 1000, entry));
+}
+
+void TSFileIndexTest::testWrappedPCR()
+{
+    // The PCR wraps up in the middle of the file, at packet 10000.
+    const uint64_t pcr_base = ts::PCR_SCALE - 10000 * PCR_PER_PACKET;
+    createFile(ts::TSPacketFormat::TS, FILE_PACKETS, pcr_base);
+
+    ts::TSFileIndex index;
+    ts::TSFileIndex::Entry entry;
+    TSUNIT_ASSERT(index.build(_tempFileName, CERR));
+    TSUNIT_EQUAL(20, index.entries().size());
+    TSUNIT_EQUAL(0, PCRAt(10000, pcr_base));
+    TSUNIT_EQUAL(PCRAt(10000, pcr_base), index.entries()[10].pcr);
+
+    // Before the wrap-up.
+    TSUNIT_ASSERT(index.findPCR(PCRAt(5500, pcr_base), entry));
+    TSUNIT_EQUAL(5005, entry.packet);
+    TSUNIT_ASSERT(index.findPCR(PCRAt(9999, pcr_base), entry));
+    TSUNIT_EQUAL(9005, entry.packet);
+
+    // After the wrap-up.
+    TSUNIT_ASSERT(index.findPCR(PCRAt(10000, pcr_base), entry));
+    TSUNIT_EQUAL(10005, entry.packet);
+    TSUNIT_ASSERT(index.findPCR(PCRAt(12345, pcr_base), entry));
+    TSUNIT_EQUAL(12005, entry.packet);
+    TSUNIT_ASSERT(index.findPCR(PCRAt(19999, pcr_base), entry));
+    TSUNIT_EQUAL(19005, entry.packet);
+
+    // The UTC time does not wrap up.
+    TSUNIT_ASSERT(index.findTime(TimeAt(9999), entry));
+    TSUNIT_EQUAL(9005, entry.packet);
+    TSUNIT_ASSERT(index.findTime(TimeAt(12500), entry));
+    TSUNIT_EQUAL(12005, entry.packet);
+
+    // Same lookups after reloading the index from a sidecar file.
+    const ts::UString sidecar(ts::TSFileIndex::SidecarFileName(_tempFileName));
+    ts::TSFileIndex index2;
+    TSUNIT_ASSERT(index.save(sidecar, CERR));
+    TSUNIT_ASSERT(index2.load(sidecar, CERR));
+    TSUNIT_ASSERT(index2.findPCR(PCRAt(12345, pcr_base), entry));
+    TSUNIT_EQUAL(12005, entry.packet);
+    TSUNIT_ASSERT(index2.findPCR(PCRAt(5500, pcr_base), entry));
+    TSUNIT_EQUAL(5005, entry.packet);
+}
+
+void TSFileIndexTest::testSidecar()
+{
+    createFile(ts::TSPacketFormat::TS);
+    const ts::UString sidecar(ts::TSFileIndex::SidecarFileName(_tempFileName));
+    TSUNIT_ASSERT(!ts::FileExists(sidecar));
+
+    // The index is built and saved on first usage.
+    ts::TSFileIndex index1;
+    TSUNIT_ASSERT(index1.loadOrBuild(_tempFileName, CERR));
+    TSUNIT_ASSERT(ts::FileExists(sidecar));
+    TSUNIT_EQUAL(20, index1.entries().size());
+
+    // Reload the sidecar file.
+    ts::TSFileIndex index2;
+    TSUNIT_ASSERT(index2.load(sidecar, CERR));
+    TSUNIT_ASSERT(index2.matchFile(_tempFileName));
+    TSUNIT_EQUAL(index1.packetSize(), index2.packetSize());
+    TSUNIT_EQUAL(index1.entries().size(), index2.entries().size());
+    for (size_t i = 0; i < index1.entries().size(); ++i) {
+        TSUNIT_EQUAL(index1.entries()[i].packet, index2.entries()[i].packet);
+        TSUNIT_EQUAL(index1.entries()[i].pcr, index2.entries()[i].pcr);
+        TSUNIT_EQUAL(index1.entries()[i].pts, index2.entries()[i].pts);
+        TSUNIT_ASSERT(index1.entries()[i].utc == index2.entries()[i].utc);
+    }
+
+    // A modified file makes the sidecar file outdated.
+    createFile(ts::TSPacketFormat::TS, 10000);
+    TSUNIT_ASSERT(!index2.matchFile(_tempFileName));
+    ts::TSFileIndex index3;
+    TSUNIT_ASSERT(index3.loadOrBuild(_tempFileName, CERR));
+    TSUNIT_EQUAL(10, index3.entries().size());
+    TSUNIT_ASSERT(index2.load(sidecar, CERR));
+    TSUNIT_ASSERT(index2.matchFile(_tempFileName));
+    TSUNIT_EQUAL(10, index2.entries().size());
+
+    // Invalid sidecar file.
+    TSUNIT_ASSERT(ts::ByteBlock(100, 0x47).saveToFile(sidecar, nullptr));
+    TSUNIT_ASSERT(!index2.load(sidecar, NULLREP));
+    TSUNIT_ASSERT(index3.loadOrBuild(_tempFileName, CERR));
+    TSUNIT_EQUAL(10, index3.entries().size());
+}
+
+void TSFileIndexTest::testM2TS()
+{
+    createFile(ts::TSPacketFormat::M2TS);
+
+    ts::TSFileIndex index;
+    ts::TSFileIndex::Entry entry;
+    TSUNIT_ASSERT(index.build(_tempFileName, CERR));
+    TSUNIT_EQUAL(ts::PKT_M2TS_SIZE, index.packetSize());
+    TSUNIT_EQUAL(20, index.entries().size());
+
+    // Start reading on the key frame.
+    TSUNIT_ASSERT(index.findPCR(PCRAt(12345), entry));
+    TSUNIT_EQUAL(12005, entry.packet);
+    TSUNIT_EQUAL(12005 * ts::PKT_M2TS_SIZE, index.byteOffset(entry));
+
+    ts::TSFile file;
+    ts::TSPacket pkt;
+    TSUNIT_ASSERT(file.openRead(_tempFileName, index.byteOffset(entry), CERR, ts::TSPacketFormat::M2TS));
+    TSUNIT_EQUAL(1, file.readPackets(&pkt, nullptr, 1, CERR));
+    TSUNIT_EQUAL(100, pkt.getPID());
+    TSUNIT_ASSERT(pkt.getRandomAccessIndicator());
+    TSUNIT_EQUAL(PTSAt(12005), pkt.getPTS());
+    TSUNIT_ASSERT(file.close(CERR));
+}
@@ -33,7 +33,14 @@
 
 #include "tsTSProcessor.h"
 #include "tsPluginRepository.h"
+#include "tsPluginEventData.h"
 #include "tsCerrReport.h"
+#include "tsCRC32.h"
+#include "tsFileUtils.h"
+#include "tsjsonValue.h"
+#include "tsMonotonic.h"
+#include "tsNullReport.h"
+#include "tsTime.h"
 #include "tsunit.h"
 
 
@@ -48,10 +55,46 @@ public:
     virtual void afterTest() override;
 
     void testProcessing();
+    void testGlobalMutexChain();
+    void testLockFreeChain();
+    void testChainThroughput();
+    void testPacketBatches();
+    void testMonitorGroup();
+    void testMonitorGroupBatches();
+    void testMonitorGroupThroughput();
+    void testStatistics();
+    void testBufferPlacement();
+    void testBufferPlacementThroughput();
 
     TSUNIT_TEST_BEGIN(TSProcessorTest);
     TSUNIT_TEST(testProcessing);
+    TSUNIT_TEST(testGlobalMutexChain);
+    TSUNIT_TEST(testLockFreeChain);
+    TSUNIT_TEST(testChainThroughput);
+    TSUNIT_TEST(testPacketBatches);
+    TSUNIT_TEST(testMonitorGroup);
+    TSUNIT_TEST(testMonitorGroupBatches);
+    TSUNIT_TEST(testMonitorGroupThroughput);
+    TSUNIT_TEST(testStatistics);
+    TSUNIT_TEST(testBufferPlacement);
+    TSUNIT_TEST(testBufferPlacementThroughput);
     TSUNIT_TEST_END();
+
+private:
+    // Pass packets through a chain of processors and check the output.
+    void checkChain(bool lock_free, size_t chain_length, size_t packet_count);
+
+    // Run a chain of processors on null packets and return the number of packets per second.
+    double chainThroughput(bool lock_free, size_t chain_length, size_t packet_count);
+
+    // Run a chain of busy monitor plugins, in sequence or in parallel, and return the number of packets per second.
+    double monitorThroughput(bool parallel, size_t monitor_count, size_t packet_count);
+
+    // Pass null packets through a chain of plugins, return the number of packets per second.
+    double placementThroughput(bool huge_pages, bool pinned, size_t packet_count);
+
+    // Get the CPU of the current thread or zero if unknown.
+    static size_t CurrentCPU();
 };
 
 TSUNIT_REGISTER(TSProcessorTest);
@@ -324,3 +367,613 @@ void TSProcessorTest::testProcessing()
     TSUNIT_EQUAL(3,          handler2.logs[0].count);
     TSUNIT_EQUAL(26,         handler2.logs[0].packets);
 }
+
+
+//----------------------------------------------------------------------------
+// Plugin event handlers for memory input and output plugins.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Send as many packets as possible at a time.
+    class Input : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(Input);
+    public:
+        Input(const ts::TSPacketVector& packets) : _packets(packets), _next(0) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override
+        {
+            ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+            if (data != nullptr && _next < _packets.size()) {
+                const size_t count = std::min(_packets.size() - _next, data->remainingSize() / ts::PKT_SIZE);
+                data->append(&_packets[_next], count * ts::PKT_SIZE);
+                _next += count;
+            }
+        }
+    private:
+        const ts::TSPacketVector& _packets;
+        size_t _next;
+    };
+
+    // Accumulate all output packets.
+    class Output : public ts::PluginEventHandlerInterface
+    {
+        TS_NOBUILD_NOCOPY(Output);
+    public:
+        Output(ts::TSPacketVector& packets) : _packets(packets) {}
+        virtual void handlePluginEvent(const ts::PluginEventContext& context) override
+        {
+            ts::PluginEventData* data = dynamic_cast<ts::PluginEventData*>(context.pluginData());
+            if (data != nullptr) {
+                const size_t count = data->size() / ts::PKT_SIZE;
+                const size_t index = _packets.size();
+                _packets.resize(index + count);
+                ts::TSPacket::Copy(&_packets[index], data->data(), count);
+            }
+        }
+    private:
+        ts::TSPacketVector& _packets;
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// Packet handoff between plugins, global mutex and lock-free modes.
+//----------------------------------------------------------------------------
+
+void TSProcessorTest::checkChain(bool lock_free, size_t chain_length, size_t packet_count)
+{
+    // Build numbered packets with continuous CC.
+    ts::TSPacketVector input_packets(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        input_packets[i].init(100, uint8_t(i & 0x0F));
+        ts::PutUInt32(input_packets[i].b + 4, uint32_t(i));
+    }
+
+    ts::TSPacketVector output_packets;
+    Input input(input_packets);
+    Output output(output_packets);
+
+    ts::TSProcessorArgs opt;
+    opt.lock_free_handoff = lock_free;
+    opt.ts_buffer_size = 1000 * ts::PKT_SIZE; // small buffer to force many wrap-ups
+    opt.max_flush_pkt = 100;
+    opt.input = {u"memory", {}};
+    opt.output = {u"memory", {}};
+    opt.plugins.resize(chain_length, {u"skip", {u"0"}});
+
+    ts::TSProcessor tsp(CERR);
+    tsp.registerEventHandler(&input, ts::PluginType::INPUT);
+    tsp.registerEventHandler(&output, ts::PluginType::OUTPUT);
+
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+
+    TSUNIT_EQUAL(packet_count, output_packets.size());
+    TSUNIT_EQUAL(0, ::memcmp(output_packets.data(), input_packets.data(), ts::PKT_SIZE * std::min(packet_count, output_packets.size())));
+}
+
+void TSProcessorTest::testGlobalMutexChain()
+{
+    checkChain(false, 5, 20000);
+}
+
+void TSProcessorTest::testLockFreeChain()
+{
+    checkChain(true, 1, 20000);
+    checkChain(true, 5, 20000);
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: packets per second versus chain length.
+//----------------------------------------------------------------------------
+
+double TSProcessorTest::chainThroughput(bool lock_free, size_t chain_length, size_t packet_count)
+{
+    ts::TSProcessorArgs opt;
+    opt.lock_free_handoff = lock_free;
+    opt.input = {u"null", {ts::UString::Decimal(packet_count, 0, true, u"")}};
+    opt.output = {u"drop", {}};
+    opt.plugins.resize(chain_length, {u"skip", {u"0"}});
+
+    ts::TSProcessor tsp(CERR);
+
+    const ts::Time start(ts::Time::CurrentUTC());
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+    const ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+
+    return (double(packet_count) * ts::MilliSecPerSec) / double(duration);
+}
+
+void TSProcessorTest::testChainThroughput()
+{
+    if (debugMode()) {
+        const size_t packet_count = 100000;
+        const size_t lengths[] = {1, 4, 8, 16};
+
+        for (size_t len : lengths) {
+            const double pps_mutex = chainThroughput(false, len, packet_count);
+            const double pps_lock_free = chainThroughput(true, len, packet_count);
+            debug() << "TSProcessorTest: chain of " << len << " plugins, global mutex: "
+                    << ts::UString::Decimal(int64_t(pps_mutex)) << " packets/s, lock-free: "
+                    << ts::UString::Decimal(int64_t(pps_lock_free)) << " packets/s" << std::endl;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Internal packet processing plugin class using packet batches.
+// Drop one packet out of 3, nullify one packet out of 5 (among remaining ones).
+//----------------------------------------------------------------------------
+
+namespace {
+    class BatchPlugin : public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(BatchPlugin);
+    public:
+        BatchPlugin(ts::TSP* t) : ts::ProcessorPlugin(t, u"Test batch plugin", u"[options]") {}
+        virtual bool usePacketBatches() override { return true; }
+        virtual size_t processPackets(ts::TSPacket* pkt, ts::TSPacketMetadata* pkt_data, size_t count) override;
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new BatchPlugin(t); }
+    };
+
+    size_t BatchPlugin::processPackets(ts::TSPacket* pkt, ts::TSPacketMetadata* pkt_data, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t index = ts::GetUInt32(pkt[i].b + 4);
+            if (index % 3 == 0) {
+                pkt_data[i].setDropRequested(true);
+            }
+            else if (index % 5 == 0) {
+                pkt_data[i].setNullRequested(true);
+            }
+        }
+        return count;
+    }
+}
+
+void TSProcessorTest::testPacketBatches()
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"test_batch", BatchPlugin::CreateInstance);
+
+    const size_t packet_count = 10000;
+    ts::TSPacketVector input_packets(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        input_packets[i].init(100, uint8_t(i & 0x0F));
+        ts::PutUInt32(input_packets[i].b + 4, uint32_t(i));
+    }
+
+    ts::TSPacketVector output_packets;
+    Input input(input_packets);
+    Output output(output_packets);
+
+    ts::TSProcessorArgs opt;
+    opt.ts_buffer_size = 1000 * ts::PKT_SIZE;
+    opt.input = {u"memory", {}};
+    opt.output = {u"memory", {}};
+    opt.plugins = {
+        {u"test_batch", {}},
+        {u"skip", {u"0"}},
+    };
+
+    ts::TSProcessor tsp(CERR);
+    tsp.registerEventHandler(&input, ts::PluginType::INPUT);
+    tsp.registerEventHandler(&output, ts::PluginType::OUTPUT);
+
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+
+    size_t out = 0;
+    for (size_t i = 0; i < packet_count; ++i) {
+        if (i % 3 != 0) {
+            TSUNIT_ASSERT(out < output_packets.size());
+            if (i % 5 == 0) {
+                TSUNIT_EQUAL(ts::PID_NULL, output_packets[out].getPID());
+            }
+            else {
+                TSUNIT_EQUAL(0, ::memcmp(&output_packets[out], &input_packets[i], ts::PKT_SIZE));
+            }
+            out++;
+        }
+    }
+    TSUNIT_EQUAL(out, output_packets.size());
+}
+
+
+//----------------------------------------------------------------------------
+// Internal read-only packet processing plugin class for monitor groups.
+// Try to drop all packets, which shall be ignored in a monitor group.
+// With --work n, compute the CRC32 of each packet n times.
+//----------------------------------------------------------------------------
+
+namespace {
+    std::atomic<size_t> monitored_packets(0);
+
+    class MonitorPlugin : public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(MonitorPlugin);
+    public:
+        MonitorPlugin(ts::TSP* t) : ts::ProcessorPlugin(t, u"Test monitor plugin", u"[options]"), _work(0), _crc(0)
+        {
+            option(u"work", 0, UNSIGNED);
+        }
+        virtual bool getOptions() override
+        {
+            getIntValue(_work, u"work", 0);
+            return true;
+        }
+        virtual Status processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata& pkt_data) override
+        {
+            for (size_t i = 0; i < _work; ++i) {
+                _crc ^= ts::CRC32(pkt.b, ts::PKT_SIZE).value();
+            }
+            monitored_packets++;
+            return _work == 0 ? TSP_DROP : TSP_OK;
+        }
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new MonitorPlugin(t); }
+    private:
+        size_t   _work;
+        uint32_t _crc;
+    };
+}
+
+void TSProcessorTest::testMonitorGroup()
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"test_batch", BatchPlugin::CreateInstance);
+    ts::PluginRepository::Instance()->registerProcessor(u"test_monitor", MonitorPlugin::CreateInstance);
+
+    const size_t packet_count = 10000;
+    ts::TSPacketVector input_packets(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        input_packets[i].init(100, uint8_t(i & 0x0F));
+        ts::PutUInt32(input_packets[i].b + 4, uint32_t(i));
+    }
+
+    // Packets which are not dropped by test_batch.
+    size_t passed_count = 0;
+    for (size_t i = 0; i < packet_count; ++i) {
+        if (i % 3 != 0) {
+            passed_count++;
+        }
+    }
+
+    // Test several positions of monitor groups: in the middle of the chain, after input, before output.
+    for (int config = 0; config < 2; ++config) {
+
+        ts::TSPacketVector output_packets;
+        Input input(input_packets);
+        Output output(output_packets);
+
+        ts::TSProcessorArgs opt;
+        opt.ts_buffer_size = 1000 * ts::PKT_SIZE;
+        opt.max_flush_pkt = 100;
+        opt.input = {u"memory", {}};
+        opt.output = {u"memory", {}};
+        size_t monitor_passes = 0;
+        if (config == 0) {
+            opt.plugins = {
+                {u"test_batch", {}},
+                {u"test_monitor", {}},
+                {u"test_monitor", {}},
+                {u"test_monitor", {}},
+                {u"skip", {u"0"}},
+            };
+            opt.monitor_groups = {{1, 3}};
+            monitor_passes = 3 * passed_count;
+        }
+        else {
+            opt.plugins = {
+                {u"test_monitor", {}},
+                {u"test_monitor", {}},
+                {u"test_batch", {}},
+                {u"test_monitor", {}},
+                {u"test_monitor", {}},
+            };
+            opt.monitor_groups = {{0, 1}, {3, 4}};
+            monitor_passes = 2 * packet_count + 2 * passed_count;
+        }
+
+        // The monitor plugins try to drop packets, ignore the resulting warnings.
+        monitored_packets = 0;
+        ts::TSProcessor tsp(NULLREP);
+        tsp.registerEventHandler(&input, ts::PluginType::INPUT);
+        tsp.registerEventHandler(&output, ts::PluginType::OUTPUT);
+
+        TSUNIT_ASSERT(tsp.start(opt));
+        tsp.waitForTermination();
+
+        // All monitors have seen all packets and did not modify the stream.
+        TSUNIT_EQUAL(monitor_passes, monitored_packets.load());
+        size_t out = 0;
+        for (size_t i = 0; i < packet_count; ++i) {
+            if (i % 3 != 0) {
+                TSUNIT_ASSERT(out < output_packets.size());
+                if (i % 5 == 0) {
+                    TSUNIT_EQUAL(ts::PID_NULL, output_packets[out].getPID());
+                }
+                else {
+                    TSUNIT_EQUAL(0, ::memcmp(&output_packets[out], &input_packets[i], ts::PKT_SIZE));
+                }
+                out++;
+            }
+        }
+        TSUNIT_EQUAL(out, output_packets.size());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Internal read-only plugin class using packet batches for monitor groups.
+// Like the scrambler in batch mode, keep the addresses of the packets and
+// modify them at the end of the batch. Try to drop all packets.
+//----------------------------------------------------------------------------
+
+namespace {
+    std::atomic<size_t> batch_monitored_packets(0);
+    std::atomic<size_t> batch_monitor_errors(0);
+
+    class MonitorBatchPlugin : public ts::ProcessorPlugin
+    {
+        TS_NOBUILD_NOCOPY(MonitorBatchPlugin);
+    public:
+        MonitorBatchPlugin(ts::TSP* t) : ts::ProcessorPlugin(t, u"Test monitor batch plugin", u"[options]"), _last_index(-1), _pending() {}
+        virtual bool usePacketBatches() override { return true; }
+        virtual size_t processPackets(ts::TSPacket* pkt, ts::TSPacketMetadata* pkt_data, size_t count) override
+        {
+            for (size_t i = 0; i < count; ++i) {
+                // The packets are received in increasing order, each one at its own address.
+                if (pkt[i].getPID() != ts::PID_NULL) {
+                    const int64_t index = ts::GetUInt32(pkt[i].b + 4);
+                    if (index <= _last_index) {
+                        batch_monitor_errors++;
+                    }
+                    _last_index = index;
+                }
+                _pending.push_back(&pkt[i]);
+                pkt_data[i].setDropRequested(true);
+            }
+            for (auto p : _pending) {
+                p->b[8] ^= 0xFF;
+            }
+            _pending.clear();
+            batch_monitored_packets += count;
+            return count;
+        }
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new MonitorBatchPlugin(t); }
+    private:
+        int64_t _last_index;
+        std::vector<ts::TSPacket*> _pending;
+    };
+}
+
+void TSProcessorTest::testMonitorGroupBatches()
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"test_batch", BatchPlugin::CreateInstance);
+    ts::PluginRepository::Instance()->registerProcessor(u"test_monitor", MonitorPlugin::CreateInstance);
+    ts::PluginRepository::Instance()->registerProcessor(u"test_monitor_batch", MonitorBatchPlugin::CreateInstance);
+
+    const size_t packet_count = 10000;
+    ts::TSPacketVector input_packets(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        input_packets[i].init(100, uint8_t(i & 0x0F));
+        ts::PutUInt32(input_packets[i].b + 4, uint32_t(i));
+    }
+
+    ts::TSPacketVector output_packets;
+    Input input(input_packets);
+    Output output(output_packets);
+
+    ts::TSProcessorArgs opt;
+    opt.ts_buffer_size = 1000 * ts::PKT_SIZE;
+    opt.max_flush_pkt = 100;
+    opt.input = {u"memory", {}};
+    opt.output = {u"memory", {}};
+    opt.plugins = {
+        {u"test_batch", {}},
+        {u"test_monitor_batch", {}},
+        {u"test_monitor", {}},
+        {u"skip", {u"0"}},
+    };
+    opt.monitor_groups = {{1, 2}};
+
+    // The monitor plugins try to drop packets, ignore the resulting warnings.
+    monitored_packets = 0;
+    batch_monitored_packets = 0;
+    batch_monitor_errors = 0;
+    ts::TSProcessor tsp(NULLREP);
+    tsp.registerEventHandler(&input, ts::PluginType::INPUT);
+    tsp.registerEventHandler(&output, ts::PluginType::OUTPUT);
+
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+
+    // The batch monitor has seen all packets in private copies, the stream is not modified.
+    size_t out = 0;
+    for (size_t i = 0; i < packet_count; ++i) {
+        if (i % 3 != 0) {
+            TSUNIT_ASSERT(out < output_packets.size());
+            if (i % 5 == 0) {
+                TSUNIT_EQUAL(ts::PID_NULL, output_packets[out].getPID());
+            }
+            else {
+                TSUNIT_EQUAL(0, ::memcmp(&output_packets[out], &input_packets[i], ts::PKT_SIZE));
+            }
+            out++;
+        }
+    }
+    TSUNIT_EQUAL(out, output_packets.size());
+    TSUNIT_EQUAL(out, batch_monitored_packets.load());
+    TSUNIT_EQUAL(out, monitored_packets.load());
+    TSUNIT_EQUAL(0, batch_monitor_errors.load());
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: busy monitor plugins in sequence or in a monitor group.
+//----------------------------------------------------------------------------
+
+double TSProcessorTest::monitorThroughput(bool parallel, size_t monitor_count, size_t packet_count)
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"test_monitor", MonitorPlugin::CreateInstance);
+
+    ts::TSProcessorArgs opt;
+    opt.input = {u"null", {ts::UString::Decimal(packet_count, 0, true, u"")}};
+    opt.output = {u"drop", {}};
+    opt.plugins.resize(monitor_count, {u"test_monitor", {u"--work", u"20"}});
+    if (parallel) {
+        opt.monitor_groups = {{0, monitor_count - 1}};
+    }
+
+    ts::TSProcessor tsp(CERR);
+
+    const ts::Time start(ts::Time::CurrentUTC());
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+    const ts::MilliSecond duration = std::max<ts::MilliSecond>(1, ts::Time::CurrentUTC() - start);
+
+    return (double(packet_count) * ts::MilliSecPerSec) / double(duration);
+}
+
+void TSProcessorTest::testMonitorGroupThroughput()
+{
+    if (debugMode()) {
+        const size_t packet_count = 50000;
+        const size_t monitor_count = 4;
+
+        const double pps_sequence = monitorThroughput(false, monitor_count, packet_count);
+        const double pps_parallel = monitorThroughput(true, monitor_count, packet_count);
+        debug() << "TSProcessorTest: " << monitor_count << " busy monitor plugins, in sequence: "
+                << ts::UString::Decimal(int64_t(pps_sequence)) << " packets/s, in a monitor group: "
+                << ts::UString::Decimal(int64_t(pps_parallel)) << " packets/s" << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Per-plugin statistics, as reported in a JSON file.
+//----------------------------------------------------------------------------
+
+void TSProcessorTest::testStatistics()
+{
+    const size_t packet_count = 20000;
+    const ts::UString file_name(ts::TempFile(u".json"));
+
+    ts::TSProcessorArgs opt;
+    opt.input = {u"null", {ts::UString::Decimal(packet_count, 0, true, u"")}};
+    opt.output = {u"drop", {}};
+    opt.plugins = {{u"count", {u"--pid", u"0x1FFF"}}};
+    opt.stats_interval = 100;
+    opt.stats_file = file_name;
+
+    ts::TSProcessor tsp(CERR);
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+
+    ts::json::ValuePtr root;
+    TSUNIT_ASSERT(ts::json::LoadFile(root, file_name, CERR));
+    TSUNIT_ASSERT(root != nullptr);
+    TSUNIT_ASSERT(root->isArray());
+    TSUNIT_ASSERT(root->size() > 0);
+    debug() << "TSProcessorTest::testStatistics: " << root->size() << " reports" << std::endl;
+
+    // The last report is issued after termination and contains the final counters.
+    const ts::json::Value& last(root->at(root->size() - 1));
+    const ts::json::Value& plugins(last.value(u"plugins"));
+    TSUNIT_ASSERT(plugins.isArray());
+    TSUNIT_EQUAL(3, plugins.size());
+    TSUNIT_EQUAL(u"null", plugins.at(0).value(u"name").toString());
+    TSUNIT_EQUAL(u"count", plugins.at(1).value(u"name").toString());
+    TSUNIT_EQUAL(u"drop", plugins.at(2).value(u"name").toString());
+    for (size_t i = 0; i < plugins.size(); ++i) {
+        TSUNIT_EQUAL(int64_t(i), plugins.at(i).value(u"index").toInteger());
+        TSUNIT_EQUAL(int64_t(packet_count), plugins.at(i).value(u"packets").toInteger());
+        TSUNIT_ASSERT(plugins.at(i).value(u"max-queued-packets").toInteger() <= plugins.at(i).value(u"buffer-packets").toInteger());
+    }
+
+    TSUNIT_ASSERT(ts::DeleteFile(file_name));
+}
+
+
+//----------------------------------------------------------------------------
+// Global buffer placement: huge pages, NUMA node, pinned plugin threads.
+//----------------------------------------------------------------------------
+
+size_t TSProcessorTest::CurrentCPU()
+{
+#if defined(TS_LINUX) && !defined(__ANDROID__)
+    return size_t(std::max(0, ::sched_getcpu()));
+#else
+    return 0;
+#endif
+}
+
+void TSProcessorTest::testBufferPlacement()
+{
+    const size_t packet_count = 10000;
+
+    ts::TSPacketVector input_packets(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        input_packets[i].init(100, uint8_t(i & 0x0F));
+        ts::PutUInt32(input_packets[i].b + 4, uint32_t(i));
+    }
+
+    ts::TSPacketVector output_packets;
+    Input input(input_packets);
+    Output output(output_packets);
+
+    // All plugin threads on the current CPU, always available to this process.
+    ts::TSProcessorArgs opt;
+    opt.huge_pages = true;
+    opt.cpu_list = {CurrentCPU()};
+    opt.input = {u"memory", {}};
+    opt.output = {u"memory", {}};
+    opt.plugins.resize(3, {u"skip", {u"0"}});
+
+    ts::TSProcessor tsp(CERR);
+    tsp.registerEventHandler(&input, ts::PluginType::INPUT);
+    tsp.registerEventHandler(&output, ts::PluginType::OUTPUT);
+
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+
+    TSUNIT_EQUAL(packet_count, output_packets.size());
+    TSUNIT_EQUAL(0, ::memcmp(output_packets.data(), input_packets.data(), ts::PKT_SIZE * std::min(packet_count, output_packets.size())));
+}
+
+double TSProcessorTest::placementThroughput(bool huge_pages, bool pinned, size_t packet_count)
+{
+    ts::TSProcessorArgs opt;
+    opt.huge_pages = huge_pages;
+    if (pinned) {
+        opt.cpu_list = {CurrentCPU()};
+    }
+    opt.input = {u"null", {ts::UString::Decimal(packet_count, 0, true, u"")}};
+    opt.output = {u"drop", {}};
+    opt.plugins.resize(4, {u"skip", {u"0"}});
+
+    ts::TSProcessor tsp(NULLREP);
+
+    const ts::Monotonic start(true);
+    TSUNIT_ASSERT(tsp.start(opt));
+    tsp.waitForTermination();
+    const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+
+    return (double(packet_count) * ts::NanoSecPerSec) / double(duration);
+}
+
+void TSProcessorTest::testBufferPlacementThroughput()
+{
+    if (debugMode()) {
+        const size_t packet_count = 500000;
+
+        const double pps_default = placementThroughput(false, false, packet_count);
+        const double pps_huge = placementThroughput(true, false, packet_count);
+        const double pps_pinned = placementThroughput(true, true, packet_count);
+        debug() << "TSProcessorTest: default buffer: " << ts::UString::Decimal(int64_t(pps_default))
+                << " packets/s, huge pages: " << ts::UString::Decimal(int64_t(pps_huge))
+                << " packets/s, huge pages and all threads on one CPU: " << ts::UString::Decimal(int64_t(pps_pinned))
+                << " packets/s" << std::endl;
+    }
+}
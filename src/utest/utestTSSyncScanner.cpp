@@ -0,0 +1,354 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2022, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSSyncScanner
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSSyncScanner.h"
+#include "tsTSPacket.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSSyncScannerTest: public tsunit::Test
+{
+public:
+    TSSyncScannerTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testStandardFormats();
+    void testCountPackets();
+    void testFind();
+    void testDamaged();
+    void testMinimum();
+    void testLocate();
+    void testThroughput();
+
+    TSUNIT_TEST_BEGIN(TSSyncScannerTest);
+    TSUNIT_TEST(testStandardFormats);
+    TSUNIT_TEST(testCountPackets);
+    TSUNIT_TEST(testFind);
+    TSUNIT_TEST(testDamaged);
+    TSUNIT_TEST(testMinimum);
+    TSUNIT_TEST(testLocate);
+    TSUNIT_TEST(testThroughput);
+    TSUNIT_TEST_END();
+
+private:
+    uint32_t _seed;
+
+    // Fill a buffer with pseudo-random data (reproducible).
+    void random(uint8_t* data, size_t size);
+
+    // Insert packets with the specified format in a buffer.
+    static void insertPackets(uint8_t* data, size_t count, const ts::TSSyncScanner::Format& format);
+
+    // Reference byte-by-byte implementation of TSSyncScanner::find().
+    static bool referenceFind(const uint8_t* data, size_t size, size_t& offset, size_t& format, const ts::TSSyncScanner::FormatVector& formats, size_t min_packets, size_t min_bytes);
+
+    // Check that all engines produce the same result as the reference implementation.
+    void checkAllEngines(const uint8_t* data, size_t size, size_t min_packets, size_t min_bytes, const ts::TSSyncScanner::FormatVector& formats = ts::TSSyncScanner::StandardFormats());
+};
+
+TSUNIT_REGISTER(TSSyncScannerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSSyncScannerTest::TSSyncScannerTest() :
+    _seed(1)
+{
+}
+
+// Test suite initialization method.
+void TSSyncScannerTest::beforeTest()
+{
+    _seed = 1;
+}
+
+// Test suite cleanup method.
+void TSSyncScannerTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Helpers.
+//----------------------------------------------------------------------------
+
+void TSSyncScannerTest::random(uint8_t* data, size_t size)
+{
+    // Linear congruential generator, reproducible from one run to another.
+    for (size_t i = 0; i < size; ++i) {
+        _seed = _seed * 1664525 + 1013904223;
+        data[i] = uint8_t(_seed >> 24);
+    }
+}
+
+void TSSyncScannerTest::insertPackets(uint8_t* data, size_t count, const ts::TSSyncScanner::Format& format)
+{
+    for (size_t i = 0; i < count; ++i) {
+        data[i * format.packet_size + format.header_size] = ts::SYNC_BYTE;
+    }
+}
+
+bool TSSyncScannerTest::referenceFind(const uint8_t* data, size_t size, size_t& offset, size_t& format, const ts::TSSyncScanner::FormatVector& formats, size_t min_packets, size_t min_bytes)
+{
+    for (offset = 0; offset < size; ++offset) {
+        for (format = 0; format < formats.size(); ++format) {
+            const size_t psize = formats[format].packet_size;
+            const size_t count = std::max<size_t>(1, std::max(min_packets, min_bytes / psize));
+            if (offset + count * psize <= size) {
+                size_t i = 0;
+                while (i < count && data[offset + i * psize + formats[format].header_size] == ts::SYNC_BYTE) {
+                    ++i;
+                }
+                if (i == count) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void TSSyncScannerTest::checkAllEngines(const uint8_t* data, size_t size, size_t min_packets, size_t min_bytes, const ts::TSSyncScanner::FormatVector& formats)
+{
+    size_t ref_offset = 0;
+    size_t ref_format = 0;
+    const bool ref_found = referenceFind(data, size, ref_offset, ref_format, formats, min_packets, min_bytes);
+
+    for (auto engine : {ts::TSSyncScanner::ENGINE_AUTO, ts::TSSyncScanner::ENGINE_PORTABLE, ts::TSSyncScanner::ENGINE_SSE2, ts::TSSyncScanner::ENGINE_AVX2, ts::TSSyncScanner::ENGINE_NEON}) {
+        if (ts::TSSyncScanner::IsEngineSupported(engine)) {
+            ts::TSSyncScanner scanner(formats, engine);
+            scanner.setMinimum(min_packets, min_bytes);
+            size_t offset = 0;
+            size_t format = 0;
+            const bool found = scanner.find(data, size, offset, format);
+            TSUNIT_EQUAL(ref_found, found);
+            if (ref_found) {
+                TSUNIT_EQUAL(ref_offset, offset);
+                TSUNIT_EQUAL(ref_format, format);
+            }
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSSyncScannerTest::testStandardFormats()
+{
+    const ts::TSSyncScanner::FormatVector& formats(ts::TSSyncScanner::StandardFormats());
+    TSUNIT_EQUAL(3, formats.size());
+    TSUNIT_EQUAL(ts::PKT_SIZE, formats[0].packet_size);
+    TSUNIT_EQUAL(0, formats[0].header_size);
+    TSUNIT_EQUAL(ts::PKT_RS_SIZE, formats[1].packet_size);
+    TSUNIT_EQUAL(0, formats[1].header_size);
+    TSUNIT_EQUAL(ts::PKT_M2TS_SIZE, formats[2].packet_size);
+    TSUNIT_EQUAL(ts::M2TS_HEADER_SIZE, formats[2].header_size);
+
+    TSUNIT_ASSERT(ts::TSSyncScanner::IsEngineSupported(ts::TSSyncScanner::ENGINE_AUTO));
+    TSUNIT_ASSERT(ts::TSSyncScanner::IsEngineSupported(ts::TSSyncScanner::ENGINE_PORTABLE));
+    debug() << "TSSyncScannerTest: SSE2: " << ts::UString::YesNo(ts::TSSyncScanner::IsEngineSupported(ts::TSSyncScanner::ENGINE_SSE2))
+            << ", AVX2: " << ts::UString::YesNo(ts::TSSyncScanner::IsEngineSupported(ts::TSSyncScanner::ENGINE_AVX2))
+            << ", Neon: " << ts::UString::YesNo(ts::TSSyncScanner::IsEngineSupported(ts::TSSyncScanner::ENGINE_NEON))
+            << std::endl;
+}
+
+void TSSyncScannerTest::testCountPackets()
+{
+    const ts::TSSyncScanner::Format m2ts(ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE);
+    ts::ByteBlock data(10 * ts::PKT_M2TS_SIZE + 100, 0);
+    insertPackets(data.data(), 10, m2ts);
+
+    TSUNIT_EQUAL(10, ts::TSSyncScanner::CountPackets(data.data(), data.size(), m2ts));
+    TSUNIT_EQUAL(9, ts::TSSyncScanner::CountPackets(data.data(), 10 * ts::PKT_M2TS_SIZE - 1, m2ts));
+    TSUNIT_EQUAL(0, ts::TSSyncScanner::CountPackets(data.data(), data.size(), ts::TSSyncScanner::Format()));
+    TSUNIT_EQUAL(0, ts::TSSyncScanner::CountPackets(data.data() + 1, data.size() - 1, m2ts));
+
+    data[5 * ts::PKT_M2TS_SIZE + ts::M2TS_HEADER_SIZE] = 0;
+    TSUNIT_EQUAL(5, ts::TSSyncScanner::CountPackets(data.data(), data.size(), m2ts));
+}
+
+void TSSyncScannerTest::testFind()
+{
+    // Random garbage, followed by packets in each standard format.
+    // The garbage sizes cover all alignments of the vector engines.
+    ts::ByteBlock data(4096 + 50 * ts::PKT_RS_SIZE);
+    for (const auto& format : ts::TSSyncScanner::StandardFormats()) {
+        for (size_t garbage = 0; garbage < 300; garbage += 7) {
+            random(data.data(), data.size());
+            insertPackets(data.data() + garbage, 20, format);
+
+            size_t ref_offset = 0;
+            size_t ref_format = 0;
+            TSUNIT_ASSERT(referenceFind(data.data(), garbage + 20 * format.packet_size, ref_offset, ref_format, ts::TSSyncScanner::StandardFormats(), 10, 0));
+            TSUNIT_ASSERT(ref_offset <= garbage);
+            checkAllEngines(data.data(), garbage + 20 * format.packet_size, 10, 0);
+            checkAllEngines(data.data(), data.size(), 5, 0);
+        }
+    }
+
+    // Random data only, no packets.
+    for (size_t size = 0; size < 1000; size += 13) {
+        random(data.data(), size);
+        checkAllEngines(data.data(), size, 1, 0);
+        checkAllEngines(data.data(), size, 3, 0);
+    }
+
+    // Only sync bytes: found at offset zero with the first format.
+    ::memset(data.data(), ts::SYNC_BYTE, data.size());
+    checkAllEngines(data.data(), data.size(), 5, 0);
+}
+
+void TSSyncScannerTest::testDamaged()
+{
+    // Sequences of packets where one sync byte out of N is corrupted.
+    const ts::TSSyncScanner::Format format;
+    ts::ByteBlock data(200 * ts::PKT_SIZE);
+    for (size_t period = 2; period < 12; ++period) {
+        random(data.data(), data.size());
+        insertPackets(data.data() + 33, 199, format);
+        for (size_t i = period; i < 199; i += period) {
+            data[33 + i * ts::PKT_SIZE] = 0;
+        }
+        // Sequences of period - 1 packets are valid, period packets are not.
+        checkAllEngines(data.data(), data.size(), period - 1, 0);
+        checkAllEngines(data.data(), data.size(), period, 0);
+        checkAllEngines(data.data(), data.size(), 1, 0);
+    }
+}
+
+void TSSyncScannerTest::testMinimum()
+{
+    const ts::TSSyncScanner::Format format;
+    ts::ByteBlock data(2000, 0);
+    insertPackets(data.data() + 100, 8, format);
+
+    ts::TSSyncScanner scanner;
+    size_t offset = 0;
+    size_t index = 0;
+
+    scanner.setMinimum(8);
+    TSUNIT_ASSERT(scanner.find(data.data(), data.size(), offset, index));
+    TSUNIT_EQUAL(100, offset);
+    TSUNIT_EQUAL(0, index);
+
+    scanner.setMinimum(9);
+    TSUNIT_ASSERT(!scanner.find(data.data(), data.size(), offset, index));
+
+    scanner.setMinimum(1, 8 * ts::PKT_SIZE);
+    TSUNIT_ASSERT(scanner.find(data.data(), data.size(), offset, index));
+    TSUNIT_EQUAL(100, offset);
+
+    scanner.setMinimum(1, 8 * ts::PKT_SIZE + 1);
+    TSUNIT_ASSERT(scanner.find(data.data(), data.size(), offset, index));
+    TSUNIT_EQUAL(100, offset);
+
+    scanner.setMinimum(1, 9 * ts::PKT_SIZE);
+    TSUNIT_ASSERT(!scanner.find(data.data(), data.size(), offset, index));
+
+    // User-specified format only.
+    scanner.setFormats(ts::TSSyncScanner::FormatVector{ts::TSSyncScanner::Format(ts::PKT_SIZE + 12, 8)});
+    scanner.setMinimum(3);
+    TSUNIT_ASSERT(!scanner.find(data.data(), data.size(), offset, index));
+    insertPackets(data.data() + 1000, 3, ts::TSSyncScanner::Format(ts::PKT_SIZE + 12, 8));
+    TSUNIT_ASSERT(scanner.find(data.data(), data.size(), offset, index));
+    TSUNIT_EQUAL(1000, offset);
+    TSUNIT_EQUAL(0, index);
+}
+
+void TSSyncScannerTest::testLocate()
+{
+    // A datagram with 3 bytes of garbage, 6 TS packets and 10 bytes of garbage at the end.
+    ts::ByteBlock data(3 + 6 * ts::PKT_SIZE + 10, 0);
+    insertPackets(data.data() + 3, 6, ts::TSSyncScanner::Format());
+
+    size_t start = 0;
+    size_t count = 0;
+    TSUNIT_ASSERT(ts::TSPacket::Locate(data.data(), data.size(), start, count));
+    TSUNIT_EQUAL(3, start);
+    TSUNIT_EQUAL(6, count);
+
+    // Packets aligned at end of datagram.
+    TSUNIT_ASSERT(ts::TSPacket::Locate(data.data(), data.size() - 10, start, count));
+    TSUNIT_EQUAL(3, start);
+    TSUNIT_EQUAL(6, count);
+
+    // No packet up to the end of the datagram.
+    data[3 + 5 * ts::PKT_SIZE] = 0;
+    TSUNIT_ASSERT(!ts::TSPacket::Locate(data.data(), data.size(), start, count));
+    TSUNIT_ASSERT(ts::TSPacket::Locate(data.data(), 3 + 5 * ts::PKT_SIZE, start, count));
+    TSUNIT_EQUAL(3, start);
+    TSUNIT_EQUAL(5, count);
+}
+
+
+//----------------------------------------------------------------------------
+// Benchmark: scan a large buffer without packets, using each engine.
+//----------------------------------------------------------------------------
+
+void TSSyncScannerTest::testThroughput()
+{
+    // Random data with some sync bytes but no valid sequence of packets.
+    ts::ByteBlock data(16 * 1024 * 1024);
+    random(data.data(), data.size());
+    for (size_t i = 0; i < data.size(); i += ts::PKT_SIZE) {
+        data[i] = (i / ts::PKT_SIZE) % 3 == 2 ? 0 : ts::SYNC_BYTE;
+    }
+
+    for (auto engine : {ts::TSSyncScanner::ENGINE_PORTABLE, ts::TSSyncScanner::ENGINE_SSE2, ts::TSSyncScanner::ENGINE_AVX2, ts::TSSyncScanner::ENGINE_NEON}) {
+        if (ts::TSSyncScanner::IsEngineSupported(engine)) {
+            ts::TSSyncScanner scanner(ts::TSSyncScanner::StandardFormats(), engine);
+            size_t offset = 0;
+            size_t format = 0;
+            const ts::Monotonic start(true);
+            const bool found = scanner.find(data.data(), data.size(), offset, format);
+            const ts::NanoSecond duration = std::max<ts::NanoSecond>(1, ts::Monotonic(true) - start);
+            TSUNIT_ASSERT(!found);
+            debug() << "TSSyncScannerTest: engine " << int(engine) << ": "
+                    << ts::UString::Decimal(int64_t((double(data.size()) * ts::NanoSecPerSec) / (double(duration) * 1024 * 1024)))
+                    << " MB/s" << std::endl;
+        }
+    }
+}
@@ -64,6 +64,7 @@ public:
     void testMutexRecursion();
     void testMutexTimeout();
     void testCondition();
+    void testCPUAffinity();
 
     TSUNIT_TEST_BEGIN(ThreadTest);
     TSUNIT_TEST(testAttributes);
@@ -72,6 +73,7 @@ public:
     TSUNIT_TEST(testMutexRecursion);
     TSUNIT_TEST(testMutexTimeout);
     TSUNIT_TEST(testCondition);
+    TSUNIT_TEST(testCPUAffinity);
     TSUNIT_TEST_END();
 private:
     ts::NanoSecond  _nsPrecision;
@@ -411,3 +413,56 @@ void ThreadTest::testCondition()
         }
     }
 }
+
+//
+// Test case: CPU affinity of a thread.
+//
+namespace {
+    class TestThreadCPUAffinity: public utest::TSUnitThread
+    {
+    private:
+        volatile bool& _report;
+        size_t         _cpu;
+    public:
+        TestThreadCPUAffinity(volatile bool& report, size_t cpu) :
+            utest::TSUnitThread(ts::ThreadAttributes().setCPUs({cpu})),
+            _report(report),
+            _cpu(cpu)
+        {
+        }
+        virtual ~TestThreadCPUAffinity() override
+        {
+            waitForTermination();
+        }
+        virtual void test() override
+        {
+            tsunit::Test::debug() << "ThreadTest::testCPUAffinity: thread pinned on CPU " << _cpu << std::endl;
+#if defined(TS_LINUX) && !defined(__ANDROID__)
+            TSUNIT_EQUAL(int(_cpu), ::sched_getcpu());
+#endif
+            _report = true;
+        }
+    };
+}
+
+void ThreadTest::testCPUAffinity()
+{
+    ts::ThreadAttributes attr;
+    TSUNIT_ASSERT(attr.getCPUs().empty());
+    attr.setCPUs({1, 3});
+    TSUNIT_EQUAL(2, attr.getCPUs().size());
+    TSUNIT_ASSERT(attr.getCPUs().count(3) == 1);
+
+    // Use the current CPU, always available to this process.
+#if defined(TS_LINUX) && !defined(__ANDROID__)
+    const size_t cpu = size_t(std::max(0, ::sched_getcpu()));
+#else
+    const size_t cpu = 0;
+#endif
+    volatile bool report = false;
+    {
+        TestThreadCPUAffinity thread(report, cpu);
+        TSUNIT_ASSERT(thread.start());
+    }
+    TSUNIT_ASSERT(report);
+}